@@ -0,0 +1,56 @@
+/* =========================================================================
+ * This file is part of jpeg-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * jpeg-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __JPEG_COLOR_SPACE_H__
+#define __JPEG_COLOR_SPACE_H__
+
+namespace jpeg
+{
+
+/**
+ *********************************************************************
+ * @class ColorSpace
+ * @brief The color spaces that samples are stored and delivered in.
+ *
+ * AUTOMATIC leaves the choice to libjpeg: a decoder trusts the JFIF
+ * and Adobe markers in the stream, and an encoder stores one
+ * component as GRAYSCALE and three as YCBCR.  UNKNOWN passes the
+ * components through with no color conversion at all, as TIFF does
+ * for RGB and multi-band images.
+ *********************************************************************/
+class ColorSpace
+{
+public:
+    enum Type
+    {
+        AUTOMATIC,
+        UNKNOWN,
+        GRAYSCALE,
+        RGB,
+        YCBCR
+    };
+};
+
+}
+
+#endif
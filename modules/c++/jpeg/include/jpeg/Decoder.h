@@ -0,0 +1,185 @@
+/* =========================================================================
+ * This file is part of jpeg-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * jpeg-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __JPEG_DECODER_H__
+#define __JPEG_DECODER_H__
+
+#include <memory>
+#include <import/sys.h>
+#include <import/io.h>
+#include <mem/BufferView.h>
+#include "jpeg/ColorSpace.h"
+
+namespace jpeg
+{
+
+/**
+ *********************************************************************
+ * @class Decoder
+ * @brief Decompresses baseline and progressive JPEG streams a few
+ * rows at a time.
+ *
+ * A decode runs start(), readRows() until every row is read, and
+ * finish().  Decoding options persist across images, as do any
+ * tables loaded with readTables(), so a single decoder can read a
+ * sequence of abbreviated streams such as the tiles of a TIFF.
+ *
+ * A decoder is not thread-safe, but separate decoders may be used
+ * on separate threads at once.
+ *********************************************************************/
+class Decoder
+{
+public:
+    //! Constructor
+    Decoder();
+
+    //! Destructor
+    ~Decoder();
+
+    /**
+     *****************************************************************
+     * Loads quantization and Huffman tables from a tables-only
+     * stream, for later abbreviated streams that omit them.
+     *
+     * @param tables
+     *   a complete tables-only stream, SOI through EOI
+     * @throw except::Exception
+     *   if the stream is corrupt or holds image data
+     *****************************************************************/
+    void readTables(const mem::BufferView<const sys::ubyte>& tables);
+
+    /**
+     *****************************************************************
+     * Sets how the stored components are interpreted.  AUTOMATIC,
+     * the default, relies on the markers in the stream.
+     *****************************************************************/
+    void setSourceColorSpace(ColorSpace::Type colorSpace)
+    {
+        mSourceColorSpace = colorSpace;
+    }
+
+    /**
+     *****************************************************************
+     * Sets the color space rows are delivered in.  AUTOMATIC, the
+     * default, delivers YCbCr images as RGB and everything else as
+     * it is stored.
+     *****************************************************************/
+    void setColorSpace(ColorSpace::Type colorSpace)
+    {
+        mColorSpace = colorSpace;
+    }
+
+    /**
+     *****************************************************************
+     * Decodes at a reduced resolution, scaling each dimension by
+     * 1 / 2^level.  The scaling happens in the inverse DCT, so a
+     * reduced decode does correspondingly less work.
+     *
+     * @param level
+     *   the reduction, 0 (full resolution) through 3
+     *****************************************************************/
+    void setReduction(size_t level);
+
+    /**
+     *****************************************************************
+     * Reads the header of a stream and prepares to decode it.  Any
+     * image in progress is abandoned.
+     *
+     * @param input
+     *   the stream to read from.  It must outlive the decode.
+     *****************************************************************/
+    void start(io::InputStream& input);
+
+    /**
+     *****************************************************************
+     * Reads the header of an in-memory stream and prepares to decode
+     * it.  The buffer must outlive the decode.
+     *****************************************************************/
+    void start(const mem::BufferView<const sys::ubyte>& input);
+
+    //! The number of rows in the decoded image
+    size_t getNumRows() const;
+
+    //! The number of columns in the decoded image
+    size_t getNumCols() const;
+
+    //! The number of interleaved components in each decoded pixel
+    size_t getNumComponents() const;
+
+    //! The size of a decoded row in bytes
+    size_t getRowSize() const
+    {
+        return getNumCols() * getNumComponents();
+    }
+
+    /**
+     *****************************************************************
+     * Decodes the next rows of the image.
+     *
+     * @param buffer
+     *   the buffer to decode into, with room for numRows rows
+     * @param numRows
+     *   the number of rows to decode
+     * @return
+     *   the number of rows decoded, fewer than requested only at the
+     *   end of the image
+     *****************************************************************/
+    size_t readRows(sys::ubyte *buffer, size_t numRows);
+
+    /**
+     *****************************************************************
+     * Finishes the image.  Rows that were never read are skipped.
+     *****************************************************************/
+    void finish();
+
+    /**
+     *****************************************************************
+     * Decodes a complete in-memory stream.
+     *
+     * @param input
+     *   the compressed stream
+     * @param output
+     *   the buffer to decode into.  Rows that do not fit are dropped.
+     * @return
+     *   the number of bytes decoded into output
+     *****************************************************************/
+    size_t decode(const mem::BufferView<const sys::ubyte>& input,
+                  const mem::BufferView<sys::ubyte>& output);
+
+private:
+    //! Noncopyable
+    Decoder(const Decoder&);
+    const Decoder& operator=(const Decoder&);
+
+    void readHeader();
+
+    struct Impl;
+    std::auto_ptr<Impl> mImpl;
+    ColorSpace::Type mSourceColorSpace;
+    ColorSpace::Type mColorSpace;
+    size_t mReduction;
+};
+
+}
+
+#endif
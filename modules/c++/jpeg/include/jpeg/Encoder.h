@@ -0,0 +1,175 @@
+/* =========================================================================
+ * This file is part of jpeg-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * jpeg-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __JPEG_ENCODER_H__
+#define __JPEG_ENCODER_H__
+
+#include <memory>
+#include <vector>
+#include <import/sys.h>
+#include <import/io.h>
+#include <mem/BufferView.h>
+#include "jpeg/ColorSpace.h"
+
+namespace jpeg
+{
+
+/**
+ *********************************************************************
+ * @class Encoder
+ * @brief Compresses 8-bit images to baseline JPEG streams a few rows
+ * at a time.
+ *
+ * An encode runs start(), writeRows() until every row is written,
+ * and finish().  Rows are given as interleaved gray or RGB samples,
+ * or as raw components when the stored color space is UNKNOWN.
+ *
+ * An encoder is not thread-safe, but separate encoders may be used
+ * on separate threads at once.
+ *********************************************************************/
+class Encoder
+{
+public:
+    //! Constructor
+    Encoder();
+
+    //! Destructor
+    ~Encoder();
+
+    /**
+     *****************************************************************
+     * Sets the quality, 1 (smallest) through 100 (best).  The default
+     * is 75.
+     *****************************************************************/
+    void setQuality(int quality);
+
+    //! The quality images are compressed with
+    int getQuality() const
+    {
+        return mQuality;
+    }
+
+    /**
+     *****************************************************************
+     * Sets the color space the image is stored in.  GRAYSCALE needs
+     * one component, RGB and YCBCR need three, and UNKNOWN accepts
+     * any number.  The default, AUTOMATIC, stores one component as
+     * GRAYSCALE, three as YCBCR and anything else as UNKNOWN.
+     *****************************************************************/
+    void setColorSpace(ColorSpace::Type colorSpace)
+    {
+        mColorSpace = colorSpace;
+    }
+
+    /**
+     *****************************************************************
+     * Omits the quantization and Huffman tables from each image, so
+     * that a sequence of images can share the tables written once by
+     * writeTables().  Off by default.
+     *****************************************************************/
+    void setAbbreviated(bool abbreviated)
+    {
+        mAbbreviated = abbreviated;
+    }
+
+    /**
+     *****************************************************************
+     * Writes a tables-only stream holding the tables that images
+     * with the current quality and color space are compressed with.
+     *
+     * @param output
+     *   the vector to append the stream to
+     * @param numComponents
+     *   the number of components the images will have
+     *****************************************************************/
+    void writeTables(std::vector<sys::ubyte>& output, size_t numComponents);
+
+    /**
+     *****************************************************************
+     * Writes the header of a new image.  Any image in progress is
+     * abandoned.
+     *
+     * @param output
+     *   the stream to write to.  It must outlive the encode.
+     * @param numRows
+     *   the number of rows in the image
+     * @param numCols
+     *   the number of columns in the image
+     * @param numComponents
+     *   the number of interleaved components in each pixel
+     *****************************************************************/
+    void start(io::OutputStream& output, size_t numRows, size_t numCols,
+               size_t numComponents);
+
+    /**
+     *****************************************************************
+     * Writes the header of a new image, appending the stream to a
+     * vector.  The vector must outlive the encode.
+     *****************************************************************/
+    void start(std::vector<sys::ubyte>& output, size_t numRows,
+               size_t numCols, size_t numComponents);
+
+    /**
+     *****************************************************************
+     * Compresses the next rows of the image.
+     *
+     * @param buffer
+     *   the rows, numCols * numComponents bytes apiece
+     * @param numRows
+     *   the number of rows, no more than remain in the image
+     *****************************************************************/
+    void writeRows(const sys::ubyte *buffer, size_t numRows);
+
+    /**
+     *****************************************************************
+     * Finishes the image once every row has been written.
+     *****************************************************************/
+    void finish();
+
+    /**
+     *****************************************************************
+     * Compresses a complete image, appending the stream to output.
+     *****************************************************************/
+    void encode(const mem::BufferView<const sys::ubyte>& input,
+                size_t numRows, size_t numCols, size_t numComponents,
+                std::vector<sys::ubyte>& output);
+
+private:
+    //! Noncopyable
+    Encoder(const Encoder&);
+    const Encoder& operator=(const Encoder&);
+
+    void checkComponents(size_t numComponents) const;
+    void configure(size_t numComponents);
+    void startImage(size_t numRows, size_t numCols, size_t numComponents);
+
+    struct Impl;
+    std::auto_ptr<Impl> mImpl;
+    int mQuality;
+    ColorSpace::Type mColorSpace;
+    bool mAbbreviated;
+};
+
+}
+
+#endif
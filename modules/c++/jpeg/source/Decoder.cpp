@@ -0,0 +1,362 @@
+/* =========================================================================
+ * This file is part of jpeg-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * jpeg-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "jpeg/Decoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <import/except.h>
+
+#include "LibJPEG.h"
+#include <jerror.h>
+
+namespace
+{
+const size_t ROW_BATCH = 16;
+const JOCTET EOI_MARKER[2] =
+{
+    static_cast<JOCTET>(0xFF), static_cast<JOCTET>(JPEG_EOI)
+};
+
+struct StreamSource
+{
+    jpeg_source_mgr pub;
+    io::InputStream* stream;
+    JOCTET buffer[4096];
+};
+
+struct MemorySource
+{
+    jpeg_source_mgr pub;
+    const JOCTET* data;
+    size_t size;
+};
+
+// A truncated stream is ended with a fake EOI marker, which leaves the
+// rest of the image gray rather than failing the decode.
+boolean insertEOI(j_decompress_ptr info)
+{
+    WARNMS(info, JWRN_JPEG_EOF);
+    info->src->next_input_byte = EOI_MARKER;
+    info->src->bytes_in_buffer = sizeof(EOI_MARKER);
+    return TRUE;
+}
+
+extern "C" void initSource(j_decompress_ptr)
+{
+}
+
+extern "C" void termSource(j_decompress_ptr)
+{
+}
+
+extern "C" void initMemorySource(j_decompress_ptr info)
+{
+    MemorySource* source = reinterpret_cast<MemorySource*>(info->src);
+    source->pub.next_input_byte = source->data;
+    source->pub.bytes_in_buffer = source->size;
+}
+
+extern "C" boolean fillMemoryBuffer(j_decompress_ptr info)
+{
+    return insertEOI(info);
+}
+
+extern "C" boolean fillStreamBuffer(j_decompress_ptr info)
+{
+    StreamSource* source = reinterpret_cast<StreamSource*>(info->src);
+    sys::SSize_T numRead = 0;
+    char message[JMSG_LENGTH_MAX] = "";
+    try
+    {
+        numRead = source->stream->read(source->buffer,
+                                       sizeof(source->buffer));
+    }
+    catch (const except::Throwable& ex)
+    {
+        ::strncpy(message, ex.getMessage().c_str(), sizeof(message) - 1);
+    }
+    catch (const std::exception& ex)
+    {
+        ::strncpy(message, ex.what(), sizeof(message) - 1);
+    }
+    if (message[0])
+        jpeg::detail::fail(reinterpret_cast<j_common_ptr>(info), message);
+
+    if (numRead <= 0)
+        return insertEOI(info);
+
+    source->pub.next_input_byte = source->buffer;
+    source->pub.bytes_in_buffer = static_cast<size_t>(numRead);
+    return TRUE;
+}
+
+extern "C" void skipInputData(j_decompress_ptr info, long numBytes)
+{
+    if (numBytes <= 0)
+        return;
+
+    jpeg_source_mgr* source = info->src;
+    while (numBytes > static_cast<long>(source->bytes_in_buffer))
+    {
+        numBytes -= static_cast<long>(source->bytes_in_buffer);
+        (*source->fill_input_buffer)(info);
+    }
+    source->next_input_byte += numBytes;
+    source->bytes_in_buffer -= static_cast<size_t>(numBytes);
+}
+}
+
+struct jpeg::Decoder::Impl
+{
+    Impl() :
+        created(false), started(false)
+    {
+        std::memset(&stream, 0, sizeof(stream));
+        stream.pub.init_source = initSource;
+        stream.pub.fill_input_buffer = fillStreamBuffer;
+        stream.pub.skip_input_data = skipInputData;
+        stream.pub.resync_to_restart = jpeg_resync_to_restart;
+        stream.pub.term_source = termSource;
+
+        std::memset(&memory, 0, sizeof(memory));
+        memory.pub.init_source = initMemorySource;
+        memory.pub.fill_input_buffer = fillMemoryBuffer;
+        memory.pub.skip_input_data = skipInputData;
+        memory.pub.resync_to_restart = jpeg_resync_to_restart;
+        memory.pub.term_source = termSource;
+    }
+
+    ~Impl()
+    {
+        if (created)
+            jpeg_destroy_decompress(&info);
+    }
+
+    void useSource(io::InputStream& input)
+    {
+        stream.stream = &input;
+        stream.pub.next_input_byte = NULL;
+        stream.pub.bytes_in_buffer = 0;
+        info.src = &stream.pub;
+    }
+
+    void useSource(const mem::BufferView<const sys::ubyte>& input)
+    {
+        memory.data = reinterpret_cast<const JOCTET*>(input.data);
+        memory.size = input.size;
+        info.src = &memory.pub;
+    }
+
+    //! Called after a longjmp to return to the idle state and throw
+    void throwError()
+    {
+        jpeg_abort_decompress(&info);
+        started = false;
+        throw except::Exception(Ctxt(FmtX("JPEG decoding failed: %s",
+                                          error.message)));
+    }
+
+    jpeg_decompress_struct info;
+    detail::ErrorManager error;
+    StreamSource stream;
+    MemorySource memory;
+    bool created;
+    bool started;
+};
+
+jpeg::Decoder::Decoder() :
+    mImpl(new Impl),
+    mSourceColorSpace(ColorSpace::AUTOMATIC),
+    mColorSpace(ColorSpace::AUTOMATIC),
+    mReduction(0)
+{
+    Impl& impl = *mImpl;
+    impl.info.err = detail::initErrorManager(impl.error);
+    if (setjmp(impl.error.jump))
+        throw except::Exception(Ctxt(FmtX(
+                "Unable to create a JPEG decoder: %s", impl.error.message)));
+
+    jpeg_create_decompress(&impl.info);
+    impl.created = true;
+}
+
+jpeg::Decoder::~Decoder()
+{
+}
+
+void jpeg::Decoder::readTables(const mem::BufferView<const sys::ubyte>& tables)
+{
+    Impl& impl = *mImpl;
+    if (setjmp(impl.error.jump))
+        impl.throwError();
+
+    jpeg_abort_decompress(&impl.info);
+    impl.started = false;
+    impl.useSource(tables);
+    if (jpeg_read_header(&impl.info, FALSE) != JPEG_HEADER_TABLES_ONLY)
+        detail::fail(reinterpret_cast<j_common_ptr>(&impl.info),
+                     "Expected a tables-only stream, but found an image");
+}
+
+void jpeg::Decoder::setReduction(size_t level)
+{
+    if (level > 3)
+    {
+        std::ostringstream message;
+        message << "JPEG reduction must be 0 through 3, not " << level;
+        throw except::Exception(Ctxt(message.str()));
+    }
+    mReduction = level;
+}
+
+void jpeg::Decoder::start(io::InputStream& input)
+{
+    Impl& impl = *mImpl;
+    if (setjmp(impl.error.jump))
+        impl.throwError();
+
+    jpeg_abort_decompress(&impl.info);
+    impl.started = false;
+    impl.useSource(input);
+    readHeader();
+}
+
+void jpeg::Decoder::start(const mem::BufferView<const sys::ubyte>& input)
+{
+    Impl& impl = *mImpl;
+    if (setjmp(impl.error.jump))
+        impl.throwError();
+
+    jpeg_abort_decompress(&impl.info);
+    impl.started = false;
+    impl.useSource(input);
+    readHeader();
+}
+
+// Only called beneath a setjmp, so it must not hold objects with
+// destructors.
+void jpeg::Decoder::readHeader()
+{
+    Impl& impl = *mImpl;
+    jpeg_read_header(&impl.info, TRUE);
+
+    const size_t numComponents =
+            static_cast<size_t>(impl.info.num_components);
+    if (mSourceColorSpace != ColorSpace::AUTOMATIC)
+        impl.info.jpeg_color_space =
+                detail::toJColorSpace(mSourceColorSpace, numComponents);
+
+    if (mColorSpace != ColorSpace::AUTOMATIC)
+    {
+        impl.info.out_color_space =
+                detail::toJColorSpace(mColorSpace, numComponents);
+    }
+    else
+    {
+        switch (impl.info.jpeg_color_space)
+        {
+        case JCS_YCbCr:
+            impl.info.out_color_space = JCS_RGB;
+            break;
+        case JCS_YCCK:
+            impl.info.out_color_space = JCS_CMYK;
+            break;
+        default:
+            impl.info.out_color_space = impl.info.jpeg_color_space;
+            break;
+        }
+    }
+
+    impl.info.scale_num = 1;
+    impl.info.scale_denom = 1u << mReduction;
+
+    jpeg_start_decompress(&impl.info);
+    impl.started = true;
+}
+
+size_t jpeg::Decoder::getNumRows() const
+{
+    return mImpl->info.output_height;
+}
+
+size_t jpeg::Decoder::getNumCols() const
+{
+    return mImpl->info.output_width;
+}
+
+size_t jpeg::Decoder::getNumComponents() const
+{
+    return static_cast<size_t>(mImpl->info.output_components);
+}
+
+size_t jpeg::Decoder::readRows(sys::ubyte *buffer, size_t numRows)
+{
+    Impl& impl = *mImpl;
+    if (!impl.started)
+        throw except::Exception(Ctxt("No JPEG image has been started"));
+    if (setjmp(impl.error.jump))
+        impl.throwError();
+
+    const size_t rowSize = getRowSize();
+    JSAMPROW rows[ROW_BATCH];
+    size_t numRead = 0;
+    while (numRead < numRows &&
+           impl.info.output_scanline < impl.info.output_height)
+    {
+        const size_t batch = std::min(numRows - numRead, ROW_BATCH);
+        for (size_t ii = 0; ii < batch; ++ii)
+            rows[ii] = reinterpret_cast<JSAMPROW>(
+                    buffer + (numRead + ii) * rowSize);
+        numRead += jpeg_read_scanlines(&impl.info, rows,
+                                       static_cast<JDIMENSION>(batch));
+    }
+    return numRead;
+}
+
+void jpeg::Decoder::finish()
+{
+    Impl& impl = *mImpl;
+    if (!impl.started)
+        return;
+    if (setjmp(impl.error.jump))
+        impl.throwError();
+
+    if (impl.info.output_scanline < impl.info.output_height)
+        jpeg_abort_decompress(&impl.info);
+    else
+        jpeg_finish_decompress(&impl.info);
+    impl.started = false;
+}
+
+size_t jpeg::Decoder::decode(const mem::BufferView<const sys::ubyte>& input,
+                             const mem::BufferView<sys::ubyte>& output)
+{
+    start(input);
+    const size_t rowSize = getRowSize();
+    const size_t numRows = std::min(getNumRows(), output.size / rowSize);
+    const size_t numRead = readRows(output.data, numRows);
+    finish();
+    return numRead * rowSize;
+}
@@ -0,0 +1,355 @@
+/* =========================================================================
+ * This file is part of jpeg-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * jpeg-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "jpeg/Encoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <import/except.h>
+
+#include "LibJPEG.h"
+
+namespace
+{
+const size_t ROW_BATCH = 16;
+const size_t BUFFER_SIZE = 4096;
+
+struct StreamDestination
+{
+    jpeg_destination_mgr pub;
+    io::OutputStream* stream;
+    JOCTET buffer[BUFFER_SIZE];
+};
+
+struct VectorDestination
+{
+    jpeg_destination_mgr pub;
+    std::vector<sys::ubyte>* output;
+};
+
+// Writes to the stream, failing the libjpeg call if the stream throws.
+void writeStream(j_compress_ptr info, const JOCTET* buffer, size_t size)
+{
+    StreamDestination* destination =
+            reinterpret_cast<StreamDestination*>(info->dest);
+    char message[JMSG_LENGTH_MAX] = "";
+    try
+    {
+        destination->stream->write(buffer, size);
+    }
+    catch (const except::Throwable& ex)
+    {
+        ::strncpy(message, ex.getMessage().c_str(), sizeof(message) - 1);
+    }
+    catch (const std::exception& ex)
+    {
+        ::strncpy(message, ex.what(), sizeof(message) - 1);
+    }
+    if (message[0])
+        jpeg::detail::fail(reinterpret_cast<j_common_ptr>(info), message);
+}
+
+extern "C" void initStreamDestination(j_compress_ptr info)
+{
+    StreamDestination* destination =
+            reinterpret_cast<StreamDestination*>(info->dest);
+    destination->pub.next_output_byte = destination->buffer;
+    destination->pub.free_in_buffer = BUFFER_SIZE;
+}
+
+extern "C" boolean emptyStreamBuffer(j_compress_ptr info)
+{
+    StreamDestination* destination =
+            reinterpret_cast<StreamDestination*>(info->dest);
+    writeStream(info, destination->buffer, BUFFER_SIZE);
+    destination->pub.next_output_byte = destination->buffer;
+    destination->pub.free_in_buffer = BUFFER_SIZE;
+    return TRUE;
+}
+
+extern "C" void termStreamDestination(j_compress_ptr info)
+{
+    StreamDestination* destination =
+            reinterpret_cast<StreamDestination*>(info->dest);
+    const size_t size = BUFFER_SIZE - destination->pub.free_in_buffer;
+    if (size)
+        writeStream(info, destination->buffer, size);
+}
+
+// The vector is grown in place, so the stream is written straight
+// into it.  Everything short of the free space at the end is data.
+void growVector(j_compress_ptr info, size_t newSize)
+{
+    VectorDestination* destination =
+            reinterpret_cast<VectorDestination*>(info->dest);
+    std::vector<sys::ubyte>& output = *destination->output;
+    const size_t used = output.size() - destination->pub.free_in_buffer;
+    bool failed = false;
+    try
+    {
+        output.resize(newSize);
+    }
+    catch (const std::bad_alloc&)
+    {
+        failed = true;
+    }
+    if (failed)
+        jpeg::detail::fail(reinterpret_cast<j_common_ptr>(info),
+                           "Out of memory for the JPEG stream");
+
+    destination->pub.next_output_byte =
+            reinterpret_cast<JOCTET*>(&output[0] + used);
+    destination->pub.free_in_buffer = newSize - used;
+}
+
+extern "C" void initVectorDestination(j_compress_ptr info)
+{
+    VectorDestination* destination =
+            reinterpret_cast<VectorDestination*>(info->dest);
+    destination->pub.free_in_buffer = 0;
+    growVector(info, destination->output->size() + BUFFER_SIZE);
+}
+
+extern "C" boolean emptyVectorBuffer(j_compress_ptr info)
+{
+    VectorDestination* destination =
+            reinterpret_cast<VectorDestination*>(info->dest);
+    growVector(info, destination->output->size() * 2);
+    return TRUE;
+}
+
+extern "C" void termVectorDestination(j_compress_ptr info)
+{
+    VectorDestination* destination =
+            reinterpret_cast<VectorDestination*>(info->dest);
+    destination->output->resize(destination->output->size() -
+                                destination->pub.free_in_buffer);
+    destination->pub.free_in_buffer = 0;
+}
+}
+
+struct jpeg::Encoder::Impl
+{
+    Impl() :
+        created(false), started(false)
+    {
+        std::memset(&stream, 0, sizeof(stream));
+        stream.pub.init_destination = initStreamDestination;
+        stream.pub.empty_output_buffer = emptyStreamBuffer;
+        stream.pub.term_destination = termStreamDestination;
+
+        std::memset(&vector, 0, sizeof(vector));
+        vector.pub.init_destination = initVectorDestination;
+        vector.pub.empty_output_buffer = emptyVectorBuffer;
+        vector.pub.term_destination = termVectorDestination;
+    }
+
+    ~Impl()
+    {
+        if (created)
+            jpeg_destroy_compress(&info);
+    }
+
+    //! Called after a longjmp to return to the idle state and throw
+    void throwError()
+    {
+        jpeg_abort_compress(&info);
+        started = false;
+        throw except::Exception(Ctxt(FmtX("JPEG encoding failed: %s",
+                                          error.message)));
+    }
+
+    jpeg_compress_struct info;
+    detail::ErrorManager error;
+    StreamDestination stream;
+    VectorDestination vector;
+    bool created;
+    bool started;
+};
+
+jpeg::Encoder::Encoder() :
+    mImpl(new Impl),
+    mQuality(75),
+    mColorSpace(ColorSpace::AUTOMATIC),
+    mAbbreviated(false)
+{
+    Impl& impl = *mImpl;
+    impl.info.err = detail::initErrorManager(impl.error);
+    if (setjmp(impl.error.jump))
+        throw except::Exception(Ctxt(FmtX(
+                "Unable to create a JPEG encoder: %s", impl.error.message)));
+
+    jpeg_create_compress(&impl.info);
+    impl.created = true;
+}
+
+jpeg::Encoder::~Encoder()
+{
+}
+
+void jpeg::Encoder::setQuality(int quality)
+{
+    if (quality < 1 || quality > 100)
+        throw except::Exception(Ctxt(FmtX(
+                "JPEG quality must be 1 through 100, not %d", quality)));
+    mQuality = quality;
+}
+
+void jpeg::Encoder::start(io::OutputStream& output, size_t numRows,
+                          size_t numCols, size_t numComponents)
+{
+    Impl& impl = *mImpl;
+    impl.stream.stream = &output;
+    impl.info.dest = &impl.stream.pub;
+    startImage(numRows, numCols, numComponents);
+}
+
+void jpeg::Encoder::start(std::vector<sys::ubyte>& output, size_t numRows,
+                          size_t numCols, size_t numComponents)
+{
+    Impl& impl = *mImpl;
+    impl.vector.output = &output;
+    impl.info.dest = &impl.vector.pub;
+    startImage(numRows, numCols, numComponents);
+}
+
+void jpeg::Encoder::checkComponents(size_t numComponents) const
+{
+    if (numComponents == 0 ||
+        (mColorSpace == ColorSpace::GRAYSCALE && numComponents != 1) ||
+        ((mColorSpace == ColorSpace::RGB || mColorSpace == ColorSpace::YCBCR)
+         && numComponents != 3))
+    {
+        std::ostringstream message;
+        message << "Cannot store " << numComponents
+                << " components in the requested JPEG color space";
+        throw except::Exception(Ctxt(message.str()));
+    }
+}
+
+// Only called beneath a setjmp, so it must not hold objects with
+// destructors.
+void jpeg::Encoder::configure(size_t numComponents)
+{
+    Impl& impl = *mImpl;
+    jpeg_abort_compress(&impl.info);
+    impl.started = false;
+
+    const J_COLOR_SPACE stored =
+            detail::toJColorSpace(mColorSpace, numComponents);
+    impl.info.input_components = static_cast<int>(numComponents);
+    impl.info.in_color_space = (stored == JCS_UNKNOWN) ? JCS_UNKNOWN
+            : (numComponents == 1) ? JCS_GRAYSCALE : JCS_RGB;
+
+    jpeg_set_defaults(&impl.info);
+    jpeg_set_colorspace(&impl.info, stored);
+    jpeg_set_quality(&impl.info, mQuality, TRUE);
+}
+
+void jpeg::Encoder::writeTables(std::vector<sys::ubyte>& output,
+                                size_t numComponents)
+{
+    checkComponents(numComponents);
+
+    Impl& impl = *mImpl;
+    if (setjmp(impl.error.jump))
+        impl.throwError();
+
+    configure(numComponents);
+    impl.vector.output = &output;
+    impl.info.dest = &impl.vector.pub;
+    jpeg_write_tables(&impl.info);
+}
+
+void jpeg::Encoder::startImage(size_t numRows, size_t numCols,
+                               size_t numComponents)
+{
+    checkComponents(numComponents);
+
+    Impl& impl = *mImpl;
+    if (setjmp(impl.error.jump))
+        impl.throwError();
+
+    configure(numComponents);
+    impl.info.image_width = static_cast<JDIMENSION>(numCols);
+    impl.info.image_height = static_cast<JDIMENSION>(numRows);
+    if (mAbbreviated)
+        jpeg_suppress_tables(&impl.info, TRUE);
+    jpeg_start_compress(&impl.info, mAbbreviated ? FALSE : TRUE);
+    impl.started = true;
+}
+
+void jpeg::Encoder::writeRows(const sys::ubyte *buffer, size_t numRows)
+{
+    Impl& impl = *mImpl;
+    if (!impl.started)
+        throw except::Exception(Ctxt("No JPEG image has been started"));
+    if (setjmp(impl.error.jump))
+        impl.throwError();
+
+    const size_t rowSize = impl.info.image_width *
+            static_cast<size_t>(impl.info.input_components);
+    JSAMPROW rows[ROW_BATCH];
+    size_t numWritten = 0;
+    while (numWritten < numRows)
+    {
+        const size_t batch = std::min(numRows - numWritten, ROW_BATCH);
+        for (size_t ii = 0; ii < batch; ++ii)
+            rows[ii] = reinterpret_cast<JSAMPROW>(const_cast<sys::ubyte*>(
+                    buffer + (numWritten + ii) * rowSize));
+        jpeg_write_scanlines(&impl.info, rows,
+                             static_cast<JDIMENSION>(batch));
+        numWritten += batch;
+    }
+}
+
+void jpeg::Encoder::finish()
+{
+    Impl& impl = *mImpl;
+    if (!impl.started)
+        throw except::Exception(Ctxt("No JPEG image has been started"));
+    if (setjmp(impl.error.jump))
+        impl.throwError();
+
+    jpeg_finish_compress(&impl.info);
+    impl.started = false;
+}
+
+void jpeg::Encoder::encode(const mem::BufferView<const sys::ubyte>& input,
+                           size_t numRows, size_t numCols,
+                           size_t numComponents,
+                           std::vector<sys::ubyte>& output)
+{
+    if (input.size < numRows * numCols * numComponents)
+    {
+        std::ostringstream message;
+        message << "Expected " << numRows * numCols * numComponents
+                << " bytes of JPEG input, but got " << input.size;
+        throw except::Exception(Ctxt(message.str()));
+    }
+
+    start(output, numRows, numCols, numComponents);
+    writeRows(input.data, numRows);
+    finish();
+}
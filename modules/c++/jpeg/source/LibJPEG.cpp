@@ -0,0 +1,80 @@
+/* =========================================================================
+ * This file is part of jpeg-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * jpeg-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "LibJPEG.h"
+
+#include <cstring>
+
+namespace
+{
+extern "C" void errorExit(j_common_ptr info)
+{
+    jpeg::detail::ErrorManager* error =
+            reinterpret_cast<jpeg::detail::ErrorManager*>(info->err);
+    (*info->err->format_message)(info, error->message);
+    std::longjmp(error->jump, 1);
+}
+
+// Warnings, such as a truncated stream, are not fatal and are not
+// printed; the decoder fills in what is missing.
+extern "C" void outputMessage(j_common_ptr)
+{
+}
+}
+
+jpeg_error_mgr* jpeg::detail::initErrorManager(ErrorManager& error)
+{
+    jpeg_error_mgr* pub = jpeg_std_error(&error.pub);
+    pub->error_exit = errorExit;
+    pub->output_message = outputMessage;
+    error.message[0] = '\0';
+    return pub;
+}
+
+void jpeg::detail::fail(j_common_ptr info, const char* message)
+{
+    ErrorManager* error = reinterpret_cast<ErrorManager*>(info->err);
+    ::strncpy(error->message, message, JMSG_LENGTH_MAX - 1);
+    error->message[JMSG_LENGTH_MAX - 1] = '\0';
+    std::longjmp(error->jump, 1);
+}
+
+J_COLOR_SPACE jpeg::detail::toJColorSpace(ColorSpace::Type colorSpace,
+                                          size_t numComponents)
+{
+    switch (colorSpace)
+    {
+    case ColorSpace::GRAYSCALE:
+        return JCS_GRAYSCALE;
+    case ColorSpace::RGB:
+        return JCS_RGB;
+    case ColorSpace::YCBCR:
+        return JCS_YCbCr;
+    case ColorSpace::UNKNOWN:
+        return JCS_UNKNOWN;
+    case ColorSpace::AUTOMATIC:
+    default:
+        return numComponents == 1 ? JCS_GRAYSCALE
+                : numComponents == 3 ? JCS_YCbCr : JCS_UNKNOWN;
+    }
+}
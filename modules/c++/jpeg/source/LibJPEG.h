@@ -0,0 +1,66 @@
+/* =========================================================================
+ * This file is part of jpeg-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * jpeg-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __JPEG_LIB_JPEG_H__
+#define __JPEG_LIB_JPEG_H__
+
+// Glue shared by the encoder and decoder.  This header is private to
+// the module so that jpeglib.h and its macros stay out of client code.
+
+#include <cstddef>
+#include <cstdio>
+#include <csetjmp>
+#include <jpeglib.h>
+#include "jpeg/ColorSpace.h"
+
+namespace jpeg
+{
+namespace detail
+{
+/*!
+ * libjpeg reports fatal errors through error_exit, which must not
+ * return.  It longjmps back to the setjmp() at the top of the public
+ * call that failed, and that call throws the saved message.  Stream
+ * callbacks catch their own exceptions and fail the same way, so no
+ * C++ exception ever unwinds through libjpeg.
+ */
+struct ErrorManager
+{
+    jpeg_error_mgr pub;
+    std::jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+//! Installs the longjmp handler, returning the struct to point err at
+jpeg_error_mgr* initErrorManager(ErrorManager& error);
+
+//! Fails the current libjpeg call with a message of our own
+void fail(j_common_ptr info, const char* message);
+
+//! The libjpeg color space for a type, for a given component count
+J_COLOR_SPACE toJColorSpace(ColorSpace::Type colorSpace,
+                            size_t numComponents);
+}
+}
+
+#endif
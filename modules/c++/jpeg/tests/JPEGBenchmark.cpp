@@ -0,0 +1,198 @@
+/* =========================================================================
+ * This file is part of jpeg-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * jpeg-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+/* Users guide
+
+    Measures JPEG tile decode throughput, serially and spread across
+    threads, to show how decoding scales per core.
+
+    usage: JPEGBenchmark [rows] [cols] [components] [tile] [threads]
+        rows, cols: image size (default 4096 x 4096)
+        components: 1 for gray or 3 for color (default 3)
+        tile:       tile size in pixels (default 256)
+        threads:    most threads to decode with (default: all CPUs)
+
+    The image is compressed as independent tiles, as in a tiled TIFF,
+    and each tile is decoded into its own buffer.  Throughput is
+    reported in MB/s of decoded data, in total and per thread, for one
+    thread and each power of two up to the thread count.  Reduced
+    resolution decodes are reported for one thread.
+*/
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <import/except.h>
+#include <import/jpeg.h>
+#include <import/mt.h>
+#include <import/sys.h>
+#include <str/Convert.h>
+
+namespace
+{
+typedef std::vector<std::vector<sys::ubyte> > Tiles;
+
+std::vector<sys::ubyte> makeTile(size_t tile, size_t numComponents,
+                                 sys::Uint32_T& state)
+{
+    // Smooth gradients with some noise, loosely like imagery.
+    std::vector<sys::ubyte> pixels(tile * tile * numComponents);
+    for (size_t ii = 0; ii < pixels.size(); ++ii)
+    {
+        state = state * 1103515245 + 12345;
+        const size_t pixel = ii / numComponents;
+        pixels[ii] = static_cast<sys::ubyte>(
+                (pixel / tile + pixel % tile) / 2 + ((state >> 16) & 0x1F));
+    }
+    return pixels;
+}
+
+// Each thread works on its own copy, so each gets its own decoder.
+class DecodeTiles
+{
+public:
+    DecodeTiles(const Tiles& tiles, size_t outputSize, size_t reduction) :
+        mTiles(tiles), mOutput(outputSize), mReduction(reduction),
+        mDecoder(new jpeg::Decoder)
+    {
+        mDecoder->setReduction(mReduction);
+    }
+
+    DecodeTiles(const DecodeTiles& other) :
+        mTiles(other.mTiles), mOutput(other.mOutput.size()),
+        mReduction(other.mReduction), mDecoder(new jpeg::Decoder)
+    {
+        mDecoder->setReduction(mReduction);
+    }
+
+    void operator()(size_t index) const
+    {
+        const std::vector<sys::ubyte>& tile = mTiles[index];
+        mDecoder->decode(
+                mem::BufferView<const sys::ubyte>(&tile[0], tile.size()),
+                mem::BufferView<sys::ubyte>(&mOutput[0], mOutput.size()));
+    }
+
+private:
+    const DecodeTiles& operator=(const DecodeTiles&);
+
+    const Tiles& mTiles;
+    mutable std::vector<sys::ubyte> mOutput;
+    const size_t mReduction;
+    std::auto_ptr<jpeg::Decoder> mDecoder;
+};
+
+double decodeAll(const Tiles& tiles, size_t tileSize, size_t reduction,
+                 size_t numThreads)
+{
+    sys::RealTimeStopWatch watch;
+    watch.start();
+    mt::runBalanced1DWithCopies(tiles.size(), numThreads,
+                                DecodeTiles(tiles, tileSize, reduction));
+    return watch.stop();
+}
+
+double megabytesPerSecond(size_t numBytes, double millis)
+{
+    return (numBytes / 1048576.0) / (millis / 1000.0);
+}
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const size_t rows = (argc > 1) ? str::toType<size_t>(argv[1]) : 4096;
+        const size_t cols = (argc > 2) ? str::toType<size_t>(argv[2]) : 4096;
+        const size_t numComponents = (argc > 3) ?
+                str::toType<size_t>(argv[3]) : 3;
+        const size_t tile = (argc > 4) ? str::toType<size_t>(argv[4]) : 256;
+        const size_t maxThreads = (argc > 5) ? str::toType<size_t>(argv[5])
+                : sys::OS().getNumCPUs();
+
+        const size_t numTiles = ((rows + tile - 1) / tile) *
+                ((cols + tile - 1) / tile);
+        const size_t tileSize = tile * tile * numComponents;
+
+        sys::Uint32_T state = 1;
+        jpeg::Encoder encoder;
+        Tiles tiles(numTiles);
+        size_t encodedSize = 0;
+        for (size_t ii = 0; ii < numTiles; ++ii)
+        {
+            const std::vector<sys::ubyte> pixels =
+                    makeTile(tile, numComponents, state);
+            encoder.encode(mem::BufferView<const sys::ubyte>(
+                                   &pixels[0], pixels.size()),
+                           tile, tile, numComponents, tiles[ii]);
+            encodedSize += tiles[ii].size();
+        }
+
+        const size_t numBytes = numTiles * tileSize;
+        std::cout << numTiles << " tiles of " << tile << " x " << tile
+                  << " x " << numComponents << ", ratio "
+                  << std::setprecision(3)
+                  << static_cast<double>(numBytes) / encodedSize
+                  << " (MB/s)\n\n"
+                  << std::setw(10) << "threads"
+                  << std::setw(12) << "total"
+                  << std::setw(12) << "per thread" << "\n";
+
+        for (size_t numThreads = 1; numThreads <= maxThreads;
+             numThreads *= 2)
+        {
+            const double rate = megabytesPerSecond(
+                    numBytes, decodeAll(tiles, tileSize, 0, numThreads));
+            std::cout << std::setw(10) << numThreads
+                      << std::setw(12) << std::setprecision(4) << rate
+                      << std::setw(12) << rate / numThreads << "\n";
+        }
+
+        std::cout << "\n" << std::setw(10) << "reduction"
+                  << std::setw(12) << "full MB/s" << "\n";
+        for (size_t reduction = 1; reduction <= 3; ++reduction)
+        {
+            // Rates are in full resolution MB, to show the savings.
+            const double rate = megabytesPerSecond(
+                    numBytes, decodeAll(tiles, tileSize, reduction, 1));
+            std::cout << std::setw(10) << reduction
+                      << std::setw(12) << std::setprecision(4) << rate
+                      << "\n";
+        }
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (...)
+    {
+        std::cerr << "Caught unnamed exception" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
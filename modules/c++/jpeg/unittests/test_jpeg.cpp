@@ -0,0 +1,263 @@
+/* =========================================================================
+ * This file is part of jpeg-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * jpeg-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <cstdlib>
+#include <vector>
+
+#include <import/io.h>
+#include <import/jpeg.h>
+#include <TestCase.h>
+
+namespace
+{
+const size_t ROWS = 45;
+const size_t COLS = 71;
+
+// Smooth ramps, which JPEG reproduces closely at high quality.
+std::vector<sys::ubyte> makeImage(size_t rows, size_t cols,
+                                  size_t numComponents)
+{
+    std::vector<sys::ubyte> image(rows * cols * numComponents);
+    for (size_t row = 0; row < rows; ++row)
+        for (size_t col = 0; col < cols; ++col)
+            for (size_t comp = 0; comp < numComponents; ++comp)
+                image[(row * cols + col) * numComponents + comp] =
+                        static_cast<sys::ubyte>(
+                                row * 2 + col + comp * 40);
+    return image;
+}
+
+int maxDifference(const std::vector<sys::ubyte>& lhs,
+                  const std::vector<sys::ubyte>& rhs)
+{
+    int difference = 0;
+    for (size_t ii = 0; ii < lhs.size() && ii < rhs.size(); ++ii)
+        difference = std::max(difference, std::abs(lhs[ii] - rhs[ii]));
+    return difference;
+}
+
+mem::BufferView<const sys::ubyte> view(const std::vector<sys::ubyte>& bytes)
+{
+    return mem::BufferView<const sys::ubyte>(&bytes[0], bytes.size());
+}
+
+std::vector<sys::ubyte> decode(jpeg::Decoder& decoder,
+                               const std::vector<sys::ubyte>& encoded,
+                               size_t size)
+{
+    std::vector<sys::ubyte> decoded(size);
+    decoder.decode(view(encoded),
+                   mem::BufferView<sys::ubyte>(&decoded[0], size));
+    return decoded;
+}
+
+TEST_CASE(testGrayRoundTrip)
+{
+    const std::vector<sys::ubyte> image = makeImage(ROWS, COLS, 1);
+    jpeg::Encoder encoder;
+    encoder.setQuality(95);
+    std::vector<sys::ubyte> encoded;
+    encoder.encode(view(image), ROWS, COLS, 1, encoded);
+    TEST_ASSERT(encoded.size() < image.size());
+
+    jpeg::Decoder decoder;
+    decoder.start(view(encoded));
+    TEST_ASSERT_EQ(decoder.getNumRows(), ROWS);
+    TEST_ASSERT_EQ(decoder.getNumCols(), COLS);
+    TEST_ASSERT_EQ(decoder.getNumComponents(), static_cast<size_t>(1));
+    decoder.finish();
+
+    TEST_ASSERT(maxDifference(decode(decoder, encoded, image.size()),
+                              image) <= 4);
+}
+
+TEST_CASE(testColorRoundTrips)
+{
+    const std::vector<sys::ubyte> image = makeImage(ROWS, COLS, 3);
+    const jpeg::ColorSpace::Type colorSpaces[] =
+    {
+        jpeg::ColorSpace::AUTOMATIC,
+        jpeg::ColorSpace::YCBCR,
+        jpeg::ColorSpace::RGB,
+        jpeg::ColorSpace::UNKNOWN
+    };
+
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        jpeg::Encoder encoder;
+        encoder.setQuality(95);
+        encoder.setColorSpace(colorSpaces[ii]);
+        std::vector<sys::ubyte> encoded;
+        encoder.encode(view(image), ROWS, COLS, 3, encoded);
+
+        // Raw components carry no marker saying so, so the decoder has
+        // to be told, as a TIFF reader is by the photometric tag.
+        jpeg::Decoder decoder;
+        if (colorSpaces[ii] == jpeg::ColorSpace::UNKNOWN)
+            decoder.setSourceColorSpace(jpeg::ColorSpace::UNKNOWN);
+        TEST_ASSERT(maxDifference(decode(decoder, encoded, image.size()),
+                                  image) <= 8);
+    }
+}
+
+TEST_CASE(testRawComponents)
+{
+    // Two components can only be stored raw.
+    const std::vector<sys::ubyte> image = makeImage(ROWS, COLS, 2);
+    jpeg::Encoder encoder;
+    encoder.setQuality(95);
+    std::vector<sys::ubyte> encoded;
+    encoder.encode(view(image), ROWS, COLS, 2, encoded);
+
+    jpeg::Decoder decoder;
+    TEST_ASSERT(maxDifference(decode(decoder, encoded, image.size()),
+                              image) <= 4);
+
+    encoder.setColorSpace(jpeg::ColorSpace::RGB);
+    TEST_EXCEPTION(encoder.encode(view(image), ROWS, COLS, 2, encoded));
+}
+
+TEST_CASE(testStreaming)
+{
+    const std::vector<sys::ubyte> image = makeImage(ROWS, COLS, 3);
+    const size_t rowSize = COLS * 3;
+
+    // Write a few rows at a time to a stream...
+    io::ByteStream stream;
+    jpeg::Encoder encoder;
+    encoder.start(stream, ROWS, COLS, 3);
+    for (size_t row = 0; row < ROWS; row += 7)
+        encoder.writeRows(&image[row * rowSize],
+                          std::min<size_t>(7, ROWS - row));
+    encoder.finish();
+
+    std::vector<sys::ubyte> encoded;
+    encoder.encode(view(image), ROWS, COLS, 3, encoded);
+    stream.seek(0, io::Seekable::START);
+    TEST_ASSERT_EQ(static_cast<size_t>(stream.available()), encoded.size());
+
+    // ... and read them back a few rows at a time.
+    jpeg::Decoder decoder;
+    decoder.start(stream);
+    std::vector<sys::ubyte> decoded(image.size());
+    size_t numRead = 0;
+    while (numRead < ROWS)
+    {
+        const size_t rows = decoder.readRows(&decoded[numRead * rowSize], 10);
+        TEST_ASSERT(rows > 0);
+        numRead += rows;
+    }
+    TEST_ASSERT_EQ(decoder.readRows(&decoded[0], 1), static_cast<size_t>(0));
+    decoder.finish();
+
+    TEST_ASSERT(decoded == decode(decoder, encoded, image.size()));
+}
+
+TEST_CASE(testReduction)
+{
+    const size_t size = 64;
+    const std::vector<sys::ubyte> image(size * size, 100);
+    jpeg::Encoder encoder;
+    std::vector<sys::ubyte> encoded;
+    encoder.encode(view(image), size, size, 1, encoded);
+
+    jpeg::Decoder decoder;
+    for (size_t level = 0; level <= 3; ++level)
+    {
+        decoder.setReduction(level);
+        decoder.start(view(encoded));
+        const size_t reduced = size >> level;
+        TEST_ASSERT_EQ(decoder.getNumRows(), reduced);
+        TEST_ASSERT_EQ(decoder.getNumCols(), reduced);
+
+        std::vector<sys::ubyte> decoded(reduced * reduced);
+        TEST_ASSERT_EQ(decoder.readRows(&decoded[0], reduced), reduced);
+        decoder.finish();
+        TEST_ASSERT(maxDifference(decoded,
+                std::vector<sys::ubyte>(decoded.size(), 100)) <= 1);
+    }
+    TEST_EXCEPTION(decoder.setReduction(4));
+}
+
+TEST_CASE(testAbbreviatedStreams)
+{
+    const std::vector<sys::ubyte> image = makeImage(ROWS, COLS, 1);
+    jpeg::Encoder encoder;
+    std::vector<sys::ubyte> full;
+    encoder.encode(view(image), ROWS, COLS, 1, full);
+
+    std::vector<sys::ubyte> tables;
+    encoder.writeTables(tables, 1);
+    encoder.setAbbreviated(true);
+    std::vector<sys::ubyte> abbreviated;
+    encoder.encode(view(image), ROWS, COLS, 1, abbreviated);
+    TEST_ASSERT(abbreviated.size() < full.size());
+
+    // Without the tables the image cannot be decoded.
+    jpeg::Decoder decoder;
+    TEST_EXCEPTION(decode(decoder, abbreviated, image.size()));
+
+    decoder.readTables(view(tables));
+    TEST_ASSERT(decode(decoder, abbreviated, image.size()) ==
+                decode(decoder, full, image.size()));
+
+    TEST_EXCEPTION(decoder.readTables(view(full)));
+}
+
+TEST_CASE(testTruncatedStream)
+{
+    const std::vector<sys::ubyte> image = makeImage(256, 256, 1);
+    jpeg::Encoder encoder;
+    std::vector<sys::ubyte> encoded;
+    encoder.encode(view(image), 256, 256, 1, encoded);
+
+    // A truncated stream decodes what it can, but garbage fails.  Keep
+    // enough that the headers are intact.
+    encoded.resize(encoded.size() / 2);
+    jpeg::Decoder decoder;
+    decode(decoder, encoded, image.size());
+
+    std::vector<sys::ubyte> garbage(100, 0x55);
+    TEST_EXCEPTION(decode(decoder, garbage, image.size()));
+
+    // The decoder is still usable after a failure.
+    encoded.clear();
+    encoder.encode(view(image), 256, 256, 1, encoded);
+    jpeg::Decoder fresh;
+    TEST_ASSERT(decode(decoder, encoded, image.size()) ==
+                decode(fresh, encoded, image.size()));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testGrayRoundTrip);
+    TEST_CHECK(testColorRoundTrips);
+    TEST_CHECK(testRawComponents);
+    TEST_CHECK(testStreaming);
+    TEST_CHECK(testReduction);
+    TEST_CHECK(testAbbreviatedStreams);
+    TEST_CHECK(testTruncatedStream);
+    return 0;
+}
@@ -0,0 +1,769 @@
+/* =========================================================================
+ * This file is part of math.complex-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.complex-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_COMPLEX_COMPLEX_ARRAY_H__
+#define __MATH_COMPLEX_COMPLEX_ARRAY_H__
+
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <sstream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <mt/BalancedRunnable1D.h>
+
+/*!
+ *  \file ComplexArray.h
+ *  \brief Kernels for arrays of complex values
+ *
+ *  Every kernel comes in two layouts.  Interleaved arrays are plain
+ *  arrays of std::complex (real, imaginary, real, ...).  Split arrays
+ *  are a SplitComplexArray, which keeps the real and imaginary parts in
+ *  separate arrays.  Both layouts are written as simple loops over the
+ *  parts, without std::complex arithmetic, so the compiler vectorizes
+ *  them.  Split arrays need no shuffles and are faster while they fit in
+ *  L1 cache, but beyond that streaming twice as many arrays can make
+ *  them slower; tests/test_complex_array_benchmark compares the two.
+ *
+ *  Every kernel also takes an optional number of threads.  Arrays are
+ *  divided into detail::BLOCK_SIZE blocks which are shared out with
+ *  mt::runBalanced1D().
+ */
+
+namespace math
+{
+namespace complex
+{
+namespace detail
+{
+//! Number of elements each thread works on at a time
+const size_t BLOCK_SIZE = 16384;
+
+// The real and imaginary parts of an interleaved array
+template<typename _T>
+struct Interleaved
+{
+    typedef _T Value;
+
+    explicit Interleaved(_T* data) :
+        mData(data)
+    {
+    }
+
+    _T& real(size_t k) const
+    {
+        return mData[2 * k];
+    }
+
+    _T& imag(size_t k) const
+    {
+        return mData[2 * k + 1];
+    }
+
+    _T* const mData;
+};
+
+// The real and imaginary parts of a split array
+template<typename _T>
+struct Split
+{
+    typedef _T Value;
+
+    Split(_T* real, _T* imag) :
+        mReal(real), mImag(imag)
+    {
+    }
+
+    _T& real(size_t k) const
+    {
+        return mReal[k];
+    }
+
+    _T& imag(size_t k) const
+    {
+        return mImag[k];
+    }
+
+    _T* const mReal;
+    _T* const mImag;
+};
+
+template<typename _T>
+Interleaved<_T> interleaved(std::complex<_T>* data)
+{
+    return Interleaved<_T>(reinterpret_cast<_T*>(data));
+}
+
+template<typename _T>
+Interleaved<const _T> interleaved(const std::complex<_T>* data)
+{
+    return Interleaved<const _T>(reinterpret_cast<const _T*>(data));
+}
+
+/*
+ * std::atan2() is a library call, which can't be vectorized, and the
+ * branches in the usual polynomial approximation keep compilers from
+ * vectorizing it inline.  So phase() builds its masks from sign bits
+ * and blends with them arithmetically.
+ */
+
+// 1 where value's sign bit is set, 0 otherwise
+inline double isNegative(double value)
+{
+    sys::Uint64_T bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = (0 - (bits >> 63)) & 0x3FF0000000000000ULL;
+    double mask;
+    memcpy(&mask, &bits, sizeof(mask));
+    return mask;
+}
+
+inline float isNegative(float value)
+{
+    sys::Uint32_T bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = (0 - (bits >> 31)) & 0x3F800000U;
+    float mask;
+    memcpy(&mask, &bits, sizeof(mask));
+    return mask;
+}
+
+// Picks 'ifTrue' where 'mask' is 1 and 'ifFalse' where it is 0.  Both must
+// be finite.
+template<typename _T>
+_T blend(_T mask, _T ifTrue, _T ifFalse)
+{
+    return ifTrue * mask + ifFalse * (1 - mask);
+}
+
+// atan(t) for |t| <= tan(pi/8), from Cephes
+inline double atanReduced(double t)
+{
+    const double z = t * t;
+    const double p = (((-8.750608600031904122785E-1 * z -
+                        1.615753718733365076637E1) * z -
+                       7.500855792314704667340E1) * z -
+                      1.228866684490136173410E2) * z -
+                     6.485021904942025371773E1;
+    const double q = ((((z + 2.485846490142306297962E1) * z +
+                        1.650270098316988542046E2) * z +
+                       4.328810604912902668951E2) * z +
+                      4.853903996359136964868E2) * z +
+                     1.945506571482613964425E2;
+    return t + t * z * p / q;
+}
+
+inline float atanReduced(float t)
+{
+    const float z = t * t;
+    return t + t * z * (((8.05374449538E-2f * z - 1.38776856032E-1f) * z +
+                         1.99777106478E-1f) * z - 3.33329491539E-1f);
+}
+
+/*
+ * atan2(y, x) for finite x and y, within a few ulp
+ *
+ * atan(min(|x|, |y|) / max(|x|, |y|)) is reduced to |t| <= tan(pi/8)
+ * and then mapped back to the right octant.  Signed zeros are handled
+ * as std::atan2() handles them, including atan2(0, 0) == 0.
+ */
+template<typename _T>
+_T phase(_T y, _T x)
+{
+    const _T pi = static_cast<_T>(3.14159265358979323846);
+    const _T tanPiOver8 = static_cast<_T>(0.41421356237309504880);
+
+    const _T ax = std::abs(x);
+    const _T ay = std::abs(y);
+    const _T swap = isNegative(ax - ay);
+    const _T lo = blend(swap, ax, ay);
+    const _T hi = blend(swap, ay, ax);
+
+    // atan(lo / hi) = pi/4 + atan((lo - hi) / (lo + hi)).  hi is only 0
+    // when lo is, and then the ratio is 0.
+    const _T shift = isNegative(tanPiOver8 * hi - lo);
+    const _T isZero = 1 - isNegative(0 - hi);
+    _T angle = shift * (pi / 4) +
+            atanReduced((lo - shift * hi) / (hi + shift * lo + isZero));
+
+    angle = blend(swap, pi / 2 - angle, angle);
+    angle = blend(isNegative(x), pi - angle, angle);
+    return std::copysign(angle, y);
+}
+
+
+// out = a * b
+template<typename InT, typename OutT>
+struct Multiply
+{
+    Multiply(const InT& a, const InT& b, const OutT& out) :
+        mA(a), mB(b), mOut(out)
+    {
+    }
+
+    void operator()(size_t start, size_t end) const
+    {
+        for (size_t k = start; k < end; ++k)
+        {
+            const typename OutT::Value ar = mA.real(k);
+            const typename OutT::Value ai = mA.imag(k);
+            const typename OutT::Value br = mB.real(k);
+            const typename OutT::Value bi = mB.imag(k);
+            mOut.real(k) = ar * br - ai * bi;
+            mOut.imag(k) = ar * bi + ai * br;
+        }
+    }
+
+    const InT mA;
+    const InT mB;
+    const OutT mOut;
+};
+
+// out = a * conj(b)
+template<typename InT, typename OutT>
+struct MultiplyConjugate
+{
+    MultiplyConjugate(const InT& a, const InT& b, const OutT& out) :
+        mA(a), mB(b), mOut(out)
+    {
+    }
+
+    void operator()(size_t start, size_t end) const
+    {
+        for (size_t k = start; k < end; ++k)
+        {
+            const typename OutT::Value ar = mA.real(k);
+            const typename OutT::Value ai = mA.imag(k);
+            const typename OutT::Value br = mB.real(k);
+            const typename OutT::Value bi = mB.imag(k);
+            mOut.real(k) = ar * br + ai * bi;
+            mOut.imag(k) = ai * br - ar * bi;
+        }
+    }
+
+    const InT mA;
+    const InT mB;
+    const OutT mOut;
+};
+
+// out = a * factor
+template<typename InT, typename OutT>
+struct Scale
+{
+    Scale(const InT& a, typename OutT::Value factor, const OutT& out) :
+        mA(a), mFactor(factor), mOut(out)
+    {
+    }
+
+    void operator()(size_t start, size_t end) const
+    {
+        for (size_t k = start; k < end; ++k)
+        {
+            mOut.real(k) = mA.real(k) * mFactor;
+            mOut.imag(k) = mA.imag(k) * mFactor;
+        }
+    }
+
+    const InT mA;
+    const typename OutT::Value mFactor;
+    const OutT mOut;
+};
+
+// Copies a into out, for converting between layouts
+template<typename InT, typename OutT>
+struct Copy
+{
+    Copy(const InT& a, const OutT& out) :
+        mA(a), mOut(out)
+    {
+    }
+
+    void operator()(size_t start, size_t end) const
+    {
+        for (size_t k = start; k < end; ++k)
+        {
+            mOut.real(k) = mA.real(k);
+            mOut.imag(k) = mA.imag(k);
+        }
+    }
+
+    const InT mA;
+    const OutT mOut;
+};
+
+// out = |a|
+template<typename InT, typename _T>
+struct Magnitude
+{
+    Magnitude(const InT& a, _T* out) :
+        mA(a), mOut(out)
+    {
+    }
+
+    void operator()(size_t start, size_t end) const
+    {
+        for (size_t k = start; k < end; ++k)
+        {
+            const _T ar = mA.real(k);
+            const _T ai = mA.imag(k);
+            mOut[k] = ar * ar + ai * ai;
+        }
+        // A separate pass, so that only this loop is held back by
+        // std::sqrt() setting errno
+        for (size_t k = start; k < end; ++k)
+        {
+            mOut[k] = std::sqrt(mOut[k]);
+        }
+    }
+
+    const InT mA;
+    _T* const mOut;
+};
+
+// out = arg(a)
+template<typename InT, typename _T>
+struct Phase
+{
+    Phase(const InT& a, _T* out) :
+        mA(a), mOut(out)
+    {
+    }
+
+    void operator()(size_t start, size_t end) const
+    {
+        for (size_t k = start; k < end; ++k)
+        {
+            mOut[k] = phase<_T>(mA.imag(k), mA.real(k));
+        }
+    }
+
+    const InT mA;
+    _T* const mOut;
+};
+
+// Runs a kernel over one BLOCK_SIZE block
+template<typename KernelT>
+struct Block
+{
+    Block(const KernelT& kernel, size_t size) :
+        mKernel(kernel), mSize(size)
+    {
+    }
+
+    void operator()(size_t block) const
+    {
+        const size_t start = block * BLOCK_SIZE;
+        mKernel(start, std::min(start + BLOCK_SIZE, mSize));
+    }
+
+    const KernelT& mKernel;
+    const size_t mSize;
+};
+
+template<typename KernelT>
+void run(const KernelT& kernel, size_t size, size_t numThreads)
+{
+    const size_t numBlocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (numThreads > 1 && numBlocks > 1)
+    {
+        mt::runBalanced1D(numBlocks,
+                          std::min(numThreads, numBlocks),
+                          Block<KernelT>(kernel, size));
+    }
+    else
+    {
+        kernel(0, size);
+    }
+}
+}
+
+/*!
+ *  Interleave split real and imaginary parts
+ *
+ *  \param real The real parts
+ *  \param imag The imaginary parts
+ *  \param size The number of values
+ *  \param[out] out size complex values
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void interleave(const _T* real, const _T* imag, size_t size,
+                std::complex<_T>* out, size_t numThreads = 1)
+{
+    detail::run(detail::Copy<detail::Split<const _T>,
+                             detail::Interleaved<_T> >(
+                        detail::Split<const _T>(real, imag),
+                        detail::interleaved(out)),
+                size, numThreads);
+}
+
+/*!
+ *  Split complex values into real and imaginary parts
+ *
+ *  \param in The complex values
+ *  \param size The number of values
+ *  \param[out] real size real parts
+ *  \param[out] imag size imaginary parts
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void deinterleave(const std::complex<_T>* in, size_t size,
+                  _T* real, _T* imag, size_t numThreads = 1)
+{
+    detail::run(detail::Copy<detail::Interleaved<const _T>,
+                             detail::Split<_T> >(
+                        detail::interleaved(in),
+                        detail::Split<_T>(real, imag)),
+                size, numThreads);
+}
+
+/*!
+ *  \class SplitComplexArray
+ *  \brief An array of complex values stored as separate arrays of real
+ *  and imaginary parts
+ *
+ *  Use assign() and copyTo() to convert from and to interleaved arrays
+ *  of std::complex.
+ *
+ *  \code
+    SplitComplexArray<float> signal(samples, numSamples);
+    multiplyConjugate(signal, reference, signal);
+    magnitude(signal, &amplitude[0]);
+ *  \endcode
+ */
+template<typename _T>
+class SplitComplexArray
+{
+public:
+    //! Construct an array of size values (initialized to 0)
+    explicit SplitComplexArray(size_t size = 0) :
+        mReal(size),
+        mImag(size)
+    {
+    }
+
+    //! Construct from an interleaved array of size values
+    SplitComplexArray(const std::complex<_T>* values, size_t size,
+                      size_t numThreads = 1)
+    {
+        assign(values, size, numThreads);
+    }
+
+    size_t size() const
+    {
+        return mReal.size();
+    }
+
+    void resize(size_t size)
+    {
+        mReal.resize(size);
+        mImag.resize(size);
+    }
+
+    //! The array of real parts
+    _T* real()
+    {
+        return mReal.empty() ? NULL : &mReal[0];
+    }
+
+    const _T* real() const
+    {
+        return mReal.empty() ? NULL : &mReal[0];
+    }
+
+    //! The array of imaginary parts
+    _T* imag()
+    {
+        return mImag.empty() ? NULL : &mImag[0];
+    }
+
+    const _T* imag() const
+    {
+        return mImag.empty() ? NULL : &mImag[0];
+    }
+
+    //! Value k
+    std::complex<_T> operator[](size_t k) const
+    {
+        return std::complex<_T>(mReal[k], mImag[k]);
+    }
+
+    //! Resize and copy from an interleaved array of size values
+    void assign(const std::complex<_T>* values, size_t size,
+                size_t numThreads = 1)
+    {
+        resize(size);
+        deinterleave(values, size, real(), imag(), numThreads);
+    }
+
+    //! Copy to an interleaved array of size() values
+    void copyTo(std::complex<_T>* values, size_t numThreads = 1) const
+    {
+        interleave(real(), imag(), size(), values, numThreads);
+    }
+
+private:
+    std::vector<_T> mReal;
+    std::vector<_T> mImag;
+};
+
+namespace detail
+{
+template<typename _T>
+Split<_T> split(SplitComplexArray<_T>& array)
+{
+    return Split<_T>(array.real(), array.imag());
+}
+
+template<typename _T>
+Split<const _T> split(const SplitComplexArray<_T>& array)
+{
+    return Split<const _T>(array.real(), array.imag());
+}
+
+template<typename _T>
+void checkSizes(const SplitComplexArray<_T>& a,
+                const SplitComplexArray<_T>& b)
+{
+    if (a.size() != b.size())
+    {
+        std::ostringstream ostr;
+        ostr << "Arrays of " << a.size() << " and " << b.size()
+             << " values";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+}
+}
+
+/*!
+ *  Multiply two arrays, out[k] = a[k] * b[k]
+ *
+ *  Unlike std::complex multiplication this does not try to recover
+ *  infinite results from NaN parts, which is why it can be vectorized.
+ *
+ *  \param a The first array
+ *  \param b The second array
+ *  \param size The number of values
+ *  \param[out] out size values.  May be a or b.
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void multiply(const std::complex<_T>* a, const std::complex<_T>* b,
+              size_t size, std::complex<_T>* out, size_t numThreads = 1)
+{
+    detail::run(detail::Multiply<detail::Interleaved<const _T>,
+                                 detail::Interleaved<_T> >(
+                        detail::interleaved(a), detail::interleaved(b),
+                        detail::interleaved(out)),
+                size, numThreads);
+}
+
+/*!
+ *  Multiply two arrays, out[k] = a[k] * b[k]
+ *
+ *  \param a The first array
+ *  \param b The second array, of a.size() values
+ *  \param[out] out The products, resized to match a.  May be a or b.
+ *  \param numThreads The number of threads to use
+ *  \throw except::Exception if a and b are different sizes
+ */
+template<typename _T>
+void multiply(const SplitComplexArray<_T>& a,
+              const SplitComplexArray<_T>& b,
+              SplitComplexArray<_T>& out,
+              size_t numThreads = 1)
+{
+    detail::checkSizes(a, b);
+    out.resize(a.size());
+    detail::run(detail::Multiply<detail::Split<const _T>,
+                                 detail::Split<_T> >(
+                        detail::split(a), detail::split(b),
+                        detail::split(out)),
+                a.size(), numThreads);
+}
+
+/*!
+ *  Multiply one array by the conjugate of another,
+ *  out[k] = a[k] * conj(b[k]), as in correlation and interferometry
+ *
+ *  \param a The first array
+ *  \param b The array to conjugate
+ *  \param size The number of values
+ *  \param[out] out size values.  May be a or b.
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void multiplyConjugate(const std::complex<_T>* a,
+                       const std::complex<_T>* b,
+                       size_t size,
+                       std::complex<_T>* out,
+                       size_t numThreads = 1)
+{
+    detail::run(detail::MultiplyConjugate<detail::Interleaved<const _T>,
+                                          detail::Interleaved<_T> >(
+                        detail::interleaved(a), detail::interleaved(b),
+                        detail::interleaved(out)),
+                size, numThreads);
+}
+
+/*!
+ *  Multiply one array by the conjugate of another,
+ *  out[k] = a[k] * conj(b[k])
+ *
+ *  \param a The first array
+ *  \param b The array to conjugate, of a.size() values
+ *  \param[out] out The products, resized to match a.  May be a or b.
+ *  \param numThreads The number of threads to use
+ *  \throw except::Exception if a and b are different sizes
+ */
+template<typename _T>
+void multiplyConjugate(const SplitComplexArray<_T>& a,
+                       const SplitComplexArray<_T>& b,
+                       SplitComplexArray<_T>& out,
+                       size_t numThreads = 1)
+{
+    detail::checkSizes(a, b);
+    out.resize(a.size());
+    detail::run(detail::MultiplyConjugate<detail::Split<const _T>,
+                                          detail::Split<_T> >(
+                        detail::split(a), detail::split(b),
+                        detail::split(out)),
+                a.size(), numThreads);
+}
+
+/*!
+ *  Scale an array, out[k] = a[k] * factor
+ *
+ *  \param a The array
+ *  \param factor The real scale factor
+ *  \param size The number of values
+ *  \param[out] out size values.  May be a.
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void scale(const std::complex<_T>* a, _T factor, size_t size,
+           std::complex<_T>* out, size_t numThreads = 1)
+{
+    detail::run(detail::Scale<detail::Interleaved<const _T>,
+                              detail::Interleaved<_T> >(
+                        detail::interleaved(a), factor,
+                        detail::interleaved(out)),
+                size, numThreads);
+}
+
+/*!
+ *  Scale an array, out[k] = a[k] * factor
+ *
+ *  \param a The array
+ *  \param factor The real scale factor
+ *  \param[out] out The scaled values, resized to match a.  May be a.
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void scale(const SplitComplexArray<_T>& a, _T factor,
+           SplitComplexArray<_T>& out, size_t numThreads = 1)
+{
+    out.resize(a.size());
+    detail::run(detail::Scale<detail::Split<const _T>, detail::Split<_T> >(
+                        detail::split(a), factor, detail::split(out)),
+                a.size(), numThreads);
+}
+
+/*!
+ *  Magnitudes of an array, out[k] = abs(a[k])
+ *
+ *  This is sqrt(real^2 + imag^2).  Unlike std::abs() it does not guard
+ *  against the squares overflowing or underflowing, so magnitudes must
+ *  be between about 1e-19 and 1e19 for float, and 1e-154 and 1e154 for
+ *  double, to be accurate.
+ *
+ *  \param a The array
+ *  \param size The number of values
+ *  \param[out] out size magnitudes
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void magnitude(const std::complex<_T>* a, size_t size, _T* out,
+               size_t numThreads = 1)
+{
+    detail::run(detail::Magnitude<detail::Interleaved<const _T>, _T>(
+                        detail::interleaved(a), out),
+                size, numThreads);
+}
+
+/*!
+ *  Magnitudes of an array, out[k] = abs(a[k])
+ *
+ *  \param a The array
+ *  \param[out] out a.size() magnitudes
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void magnitude(const SplitComplexArray<_T>& a, _T* out,
+               size_t numThreads = 1)
+{
+    detail::run(detail::Magnitude<detail::Split<const _T>, _T>(
+                        detail::split(a), out),
+                a.size(), numThreads);
+}
+
+/*!
+ *  Phases of an array in radians, out[k] = arg(a[k])
+ *
+ *  This matches std::arg() to within a few ulp for finite values.
+ *  Values with an infinite part give NaN.
+ *
+ *  \param a The array
+ *  \param size The number of values
+ *  \param[out] out size phases in [-pi, pi]
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void phase(const std::complex<_T>* a, size_t size, _T* out,
+           size_t numThreads = 1)
+{
+    detail::run(detail::Phase<detail::Interleaved<const _T>, _T>(
+                        detail::interleaved(a), out),
+                size, numThreads);
+}
+
+/*!
+ *  Phases of an array in radians, out[k] = arg(a[k])
+ *
+ *  \param a The array
+ *  \param[out] out a.size() phases in [-pi, pi]
+ *  \param numThreads The number of threads to use
+ */
+template<typename _T>
+void phase(const SplitComplexArray<_T>& a, _T* out, size_t numThreads = 1)
+{
+    detail::run(detail::Phase<detail::Split<const _T>, _T>(
+                        detail::split(a), out),
+                a.size(), numThreads);
+}
+}
+}
+
+#endif
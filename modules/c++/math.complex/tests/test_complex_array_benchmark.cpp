@@ -0,0 +1,205 @@
+/* =========================================================================
+ * This file is part of math.complex-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.complex-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Compares the complex array kernels, on interleaved and split arrays,
+    against looping over arrays of std::complex.  This replaces the
+    std::complex vs. interleaved float comparisons in
+    math/tests/complexBenchmark.cpp and complexMultiplyBenchmark.cpp.
+
+    usage: test_complex_array_benchmark [size] [numThreads]
+        size: number of complex values (default 4000000)
+        numThreads: threads for the kernels (default 1)
+
+    Throughput is reported in millions of values per second.
+*/
+
+#include <stdlib.h>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <math/complex/ComplexArray.h>
+#include <str/Convert.h>
+
+namespace
+{
+void report(const std::string& name, size_t size, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(1) << size / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+
+template<typename _T>
+void benchmark(const std::string& typeName, size_t size, size_t numThreads)
+{
+    namespace cx = math::complex;
+
+    std::vector<std::complex<_T> > a(size);
+    std::vector<std::complex<_T> > b(size);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        a[ii] = std::complex<_T>(static_cast<_T>(2.0 * rand() / RAND_MAX - 1),
+                                 static_cast<_T>(2.0 * rand() / RAND_MAX - 1));
+        b[ii] = std::complex<_T>(static_cast<_T>(2.0 * rand() / RAND_MAX - 1),
+                                 static_cast<_T>(2.0 * rand() / RAND_MAX - 1));
+    }
+    std::vector<std::complex<_T> > out(size);
+    std::vector<_T> realOut(size);
+    const _T factor = static_cast<_T>(1.23486);
+
+    std::cout << typeName << "\n";
+
+    sys::RealTimeStopWatch watch;
+    watch.start();
+    const cx::SplitComplexArray<_T> splitA(&a[0], size, numThreads);
+    report("deinterleave", size, watch.stop());
+
+    const cx::SplitComplexArray<_T> splitB(&b[0], size, numThreads);
+    cx::SplitComplexArray<_T> splitOut(size);
+
+    watch.clear();
+    watch.start();
+    splitA.copyTo(&out[0], numThreads);
+    report("interleave", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        out[ii] = a[ii] * b[ii];
+    }
+    report("std::complex multiply", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::multiply(&a[0], &b[0], size, &out[0], numThreads);
+    report("interleaved multiply", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::multiply(splitA, splitB, splitOut, numThreads);
+    report("split multiply", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        out[ii] = a[ii] * std::conj(b[ii]);
+    }
+    report("std::complex conj multiply", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::multiplyConjugate(&a[0], &b[0], size, &out[0], numThreads);
+    report("interleaved conj multiply", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::multiplyConjugate(splitA, splitB, splitOut, numThreads);
+    report("split conj multiply", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        out[ii] = a[ii] * factor;
+    }
+    report("std::complex scale", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::scale(&a[0], factor, size, &out[0], numThreads);
+    report("interleaved scale", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::scale(splitA, factor, splitOut, numThreads);
+    report("split scale", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        realOut[ii] = std::abs(a[ii]);
+    }
+    report("std::abs", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::magnitude(&a[0], size, &realOut[0], numThreads);
+    report("interleaved magnitude", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::magnitude(splitA, &realOut[0], numThreads);
+    report("split magnitude", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        realOut[ii] = std::arg(a[ii]);
+    }
+    report("std::arg", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::phase(&a[0], size, &realOut[0], numThreads);
+    report("interleaved phase", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    cx::phase(splitA, &realOut[0], numThreads);
+    report("split phase", size, watch.stop());
+
+    std::cout << std::endl;
+}
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const size_t size =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 4000000;
+        const size_t numThreads =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 1;
+
+        std::cout << size << " values, " << numThreads
+                  << " thread(s) (million values/s)\n\n";
+
+        benchmark<float>("float", size, numThreads);
+        benchmark<double>("double", size, numThreads);
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+/* =========================================================================
+ * This file is part of math.complex-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.complex-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TestCase.h"
+#include <stdlib.h>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <vector>
+
+#include <math/complex/ComplexArray.h>
+
+namespace
+{
+// More than one detail::BLOCK_SIZE block, and not a multiple of it
+const size_t SIZE = 40000;
+
+template<typename _T>
+std::vector<std::complex<_T> > randomValues(size_t size)
+{
+    std::vector<std::complex<_T> > values(size);
+    for (size_t k = 0; k < size; ++k)
+    {
+        values[k] = std::complex<_T>(
+                static_cast<_T>(200.0 * rand() / RAND_MAX - 100.0),
+                static_cast<_T>(200.0 * rand() / RAND_MAX - 100.0));
+    }
+    return values;
+}
+
+template<typename _T>
+void checkEqual(const std::string& testName,
+                const std::complex<_T>& value,
+                const std::complex<_T>& expected,
+                double eps)
+{
+    const double scale = std::max(std::abs(expected), _T(1));
+    TEST_ASSERT_ALMOST_EQ_EPS(value.real() / scale,
+                              expected.real() / scale, eps);
+    TEST_ASSERT_ALMOST_EQ_EPS(value.imag() / scale,
+                              expected.imag() / scale, eps);
+}
+
+template<typename _T>
+void checkArithmetic(const std::string& testName, double eps)
+{
+    namespace cx = math::complex;
+    const std::vector<std::complex<_T> > a = randomValues<_T>(SIZE);
+    const std::vector<std::complex<_T> > b = randomValues<_T>(SIZE);
+    const cx::SplitComplexArray<_T> splitA(&a[0], SIZE);
+    const cx::SplitComplexArray<_T> splitB(&b[0], SIZE);
+    const _T factor = static_cast<_T>(-1.25);
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        std::vector<std::complex<_T> > products(SIZE);
+        std::vector<std::complex<_T> > conjugates(SIZE);
+        std::vector<std::complex<_T> > scaled(SIZE);
+        cx::multiply(&a[0], &b[0], SIZE, &products[0], numThreads);
+        cx::multiplyConjugate(&a[0], &b[0], SIZE, &conjugates[0],
+                              numThreads);
+        cx::scale(&a[0], factor, SIZE, &scaled[0], numThreads);
+
+        cx::SplitComplexArray<_T> splitProducts;
+        cx::SplitComplexArray<_T> splitConjugates;
+        cx::SplitComplexArray<_T> splitScaled;
+        cx::multiply(splitA, splitB, splitProducts, numThreads);
+        cx::multiplyConjugate(splitA, splitB, splitConjugates, numThreads);
+        cx::scale(splitA, factor, splitScaled, numThreads);
+        TEST_ASSERT_EQ(splitProducts.size(), SIZE);
+        TEST_ASSERT_EQ(splitConjugates.size(), SIZE);
+        TEST_ASSERT_EQ(splitScaled.size(), SIZE);
+
+        for (size_t k = 0; k < SIZE; ++k)
+        {
+            checkEqual(testName, products[k], a[k] * b[k], eps);
+            checkEqual(testName, conjugates[k], a[k] * std::conj(b[k]), eps);
+            checkEqual(testName, scaled[k], a[k] * factor, eps);
+            checkEqual(testName, splitProducts[k], a[k] * b[k], eps);
+            checkEqual(testName, splitConjugates[k], a[k] * std::conj(b[k]),
+                       eps);
+            checkEqual(testName, splitScaled[k], a[k] * factor, eps);
+        }
+    }
+
+    // In place
+    std::vector<std::complex<_T> > inPlace(a);
+    cx::multiply(&inPlace[0], &b[0], SIZE, &inPlace[0]);
+    cx::multiplyConjugate(&inPlace[0], &b[0], SIZE, &inPlace[0], 4);
+    cx::SplitComplexArray<_T> splitInPlace(splitA);
+    cx::multiply(splitInPlace, splitB, splitInPlace);
+    cx::multiplyConjugate(splitInPlace, splitB, splitInPlace, 4);
+    for (size_t k = 0; k < SIZE; ++k)
+    {
+        const std::complex<_T> expected = a[k] * std::norm(b[k]);
+        checkEqual(testName, inPlace[k], expected, eps);
+        checkEqual(testName, splitInPlace[k], expected, eps);
+    }
+}
+
+template<typename _T>
+void checkMagnitudeAndPhase(const std::string& testName, double eps)
+{
+    namespace cx = math::complex;
+    std::vector<std::complex<_T> > values = randomValues<_T>(SIZE);
+
+    // Axes, diagonals, signed zeros and tiny values
+    const _T zero(0);
+    const _T tiny = std::numeric_limits<_T>::min();
+    const _T specials[] = { zero, -zero, 1, -1, 3, -3, tiny, -tiny };
+    const size_t numSpecials = sizeof(specials) / sizeof(specials[0]);
+    for (size_t ii = 0; ii < numSpecials; ++ii)
+    {
+        for (size_t jj = 0; jj < numSpecials; ++jj)
+        {
+            values.push_back(std::complex<_T>(specials[ii], specials[jj]));
+        }
+    }
+    const size_t size = values.size();
+    const cx::SplitComplexArray<_T> split(&values[0], size);
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        std::vector<_T> magnitudes(size);
+        std::vector<_T> phases(size);
+        std::vector<_T> splitMagnitudes(size);
+        std::vector<_T> splitPhases(size);
+        cx::magnitude(&values[0], size, &magnitudes[0], numThreads);
+        cx::phase(&values[0], size, &phases[0], numThreads);
+        cx::magnitude(split, &splitMagnitudes[0], numThreads);
+        cx::phase(split, &splitPhases[0], numThreads);
+
+        for (size_t k = 0; k < size; ++k)
+        {
+            const _T expectedMagnitude = std::abs(values[k]);
+            const _T expectedPhase = std::arg(values[k]);
+            // Squaring the tiny parts underflows
+            if (expectedMagnitude == 0 ||
+                expectedMagnitude > std::sqrt(tiny))
+            {
+                TEST_ASSERT_ALMOST_EQ_EPS(magnitudes[k], expectedMagnitude,
+                                          eps * expectedMagnitude);
+            }
+            TEST_ASSERT_ALMOST_EQ_EPS(phases[k], expectedPhase, eps);
+            TEST_ASSERT_EQ(splitMagnitudes[k], magnitudes[k]);
+            TEST_ASSERT_EQ(splitPhases[k], phases[k]);
+
+            // Including the sign of a zero phase
+            TEST_ASSERT_EQ(std::signbit(phases[k]),
+                           std::signbit(expectedPhase));
+        }
+    }
+}
+
+TEST_CASE(testArithmetic)
+{
+    srand(1);
+    checkArithmetic<float>(testName, 1e-6);
+    checkArithmetic<double>(testName, 1e-15);
+}
+
+TEST_CASE(testMagnitudeAndPhase)
+{
+    srand(2);
+    checkMagnitudeAndPhase<float>(testName, 1e-6);
+    checkMagnitudeAndPhase<double>(testName, 1e-15);
+}
+
+TEST_CASE(testConversion)
+{
+    const std::vector<std::complex<double> > values =
+            randomValues<double>(SIZE);
+    std::vector<double> real(SIZE);
+    std::vector<double> imag(SIZE);
+    math::complex::deinterleave(&values[0], SIZE, &real[0], &imag[0], 4);
+    for (size_t k = 0; k < SIZE; ++k)
+    {
+        TEST_ASSERT_EQ(real[k], values[k].real());
+        TEST_ASSERT_EQ(imag[k], values[k].imag());
+    }
+
+    std::vector<std::complex<double> > interleaved(SIZE);
+    math::complex::interleave(&real[0], &imag[0], SIZE, &interleaved[0]);
+    TEST_ASSERT_TRUE(interleaved == values);
+
+    const math::complex::SplitComplexArray<double> split(&values[0], SIZE);
+    TEST_ASSERT_EQ(split.size(), SIZE);
+    TEST_ASSERT_EQ(split[7], values[7]);
+    std::vector<std::complex<double> > copy(SIZE);
+    split.copyTo(&copy[0], 4);
+    TEST_ASSERT_TRUE(copy == values);
+
+    // Nothing to do
+    math::complex::SplitComplexArray<double> empty;
+    TEST_ASSERT_TRUE(empty.real() == NULL);
+    math::complex::multiply(empty, empty, empty);
+    TEST_ASSERT_EQ(empty.size(), static_cast<size_t>(0));
+
+    math::complex::SplitComplexArray<double> product;
+    TEST_EXCEPTION(math::complex::multiply(split, empty, product));
+    TEST_EXCEPTION(math::complex::multiplyConjugate(empty, split, product));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testArithmetic);
+    TEST_CHECK(testMagnitudeAndPhase);
+    TEST_CHECK(testConversion);
+    return 0;
+}
@@ -22,9 +22,15 @@
 #ifndef __MATH_LINEAR_H__
 #define __MATH_LINEAR_H__
 
+#include "math/linear/Cholesky.h"
 #include "math/linear/Eigenvalue.h"
+#include "math/linear/GEMM.h"
 #include "math/linear/MatrixMxN.h"
+#include "math/linear/MatrixMxNBatch.h"
+#include "math/linear/QR.h"
+#include "math/linear/SymmetricEigen.h"
 #include "math/linear/VectorN.h"
+#include "math/linear/VectorNBatch.h"
 #include "math/linear/Matrix2D.h"
 #include "math/linear/Vector.h"
 
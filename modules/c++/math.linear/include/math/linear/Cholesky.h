@@ -0,0 +1,220 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __MATH_LINEAR_CHOLESKY_H__
+#define __MATH_LINEAR_CHOLESKY_H__
+
+#include <cmath>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <math/linear/Matrix2D.h>
+
+namespace math
+{
+namespace linear
+{
+/*!
+ *   \class Cholesky
+ *   \brief Cholesky decomposition of a symmetric, positive definite matrix
+ *
+ *   For a symmetric, positive definite matrix A, the Cholesky
+ *   decomposition is a lower triangular matrix L so that A = L*L'.
+ *   Only the lower triangle of A is read, so A is assumed to be
+ *   symmetric.
+ *
+ *   If A is not positive definite, the decomposition stops early and
+ *   isSPD() returns false; the solvers then throw.
+ *
+ *   A decomposition can be reused for another matrix of the same size
+ *   through decompose(), and the solvers work in place, so repeated
+ *   solves do not allocate.
+ *
+ *   This is based on the Cholesky class from JAMA, a Java Matrix
+ *   Library, developed jointly by the Mathworks and NIST
+ *   (see http://math.nist.gov/javanumerics/jama).
+ *
+ *   RealT must be a real (non-complex) type
+ */
+template<typename RealT>
+class Cholesky
+{
+public:
+    //! An empty decomposition; call decompose() before solving
+    Cholesky() :
+        mSPD(false)
+    {
+    }
+
+    /*
+     * Construct the Cholesky decomposition
+     * \param A Square, symmetric matrix
+     */
+    explicit Cholesky(const Matrix2D<RealT>& A) :
+        mSPD(false)
+    {
+        decompose(A);
+    }
+
+    /*
+     * Decompose A, reusing the storage of the previous decomposition
+     * when A is the same size.
+     * \param A Square, symmetric matrix
+     */
+    void decompose(const Matrix2D<RealT>& A)
+    {
+        const size_t n = A.rows();
+        if (A.cols() != n)
+        {
+            throw except::Exception(Ctxt(
+                "Expected square matrix but got rows = " +
+                str::toString(A.rows()) + ", cols = " +
+                str::toString(A.cols())));
+        }
+        if (mL.rows() != n || mL.cols() != n)
+        {
+            mL = Matrix2D<RealT>(n, n);
+        }
+
+        mSPD = true;
+        for (size_t j = 0; j < n && mSPD; ++j)
+        {
+            RealT* const lj = mL[j];
+            const RealT* const aj = A[j];
+            RealT d(0);
+            for (size_t k = 0; k < j; ++k)
+            {
+                const RealT* const lk = mL[k];
+                RealT s(0);
+                for (size_t i = 0; i < k; ++i)
+                {
+                    s += lk[i] * lj[i];
+                }
+                s = (aj[k] - s) / lk[k];
+                lj[k] = s;
+                d += s * s;
+            }
+            d = aj[j] - d;
+            mSPD = d > 0;
+            lj[j] = mSPD ? static_cast<RealT>(std::sqrt(d)) : RealT(0);
+            for (size_t k = j + 1; k < n; ++k)
+            {
+                lj[k] = 0;
+            }
+        }
+    }
+
+    //! Is the matrix symmetric and positive definite?
+    bool isSPD() const
+    {
+        return mSPD;
+    }
+
+    //! Return the lower triangular factor, L
+    const Matrix2D<RealT>& getL() const
+    {
+        return mL;
+    }
+
+    /*
+     * Solve A*X = B in place
+     * \param B A matrix with as many rows as A, which is
+     *  overwritten with X
+     * \throws if A was not symmetric, positive definite
+     */
+    void solveInPlace(Matrix2D<RealT>& B) const
+    {
+        const size_t n = mL.rows();
+        if (B.rows() != n)
+        {
+            throw except::Exception(Ctxt(
+                "Matrix row dimensions must agree"));
+        }
+        if (!mSPD)
+        {
+            throw except::Exception(Ctxt(
+                "Matrix is not symmetric positive definite"));
+        }
+
+        const size_t nx = B.cols();
+
+        // Solve L*Y = B
+        for (size_t k = 0; k < n; ++k)
+        {
+            RealT* const bk = B[k];
+            const RealT* const lk = mL[k];
+            for (size_t i = 0; i < k; ++i)
+            {
+                const RealT* const bi = B[i];
+                for (size_t j = 0; j < nx; ++j)
+                {
+                    bk[j] -= bi[j] * lk[i];
+                }
+            }
+            for (size_t j = 0; j < nx; ++j)
+            {
+                bk[j] /= lk[k];
+            }
+        }
+
+        // Solve L'*X = Y
+        for (size_t k = n; k-- > 0; )
+        {
+            RealT* const bk = B[k];
+            for (size_t i = k + 1; i < n; ++i)
+            {
+                const RealT* const bi = B[i];
+                const RealT lik = mL(i, k);
+                for (size_t j = 0; j < nx; ++j)
+                {
+                    bk[j] -= bi[j] * lik;
+                }
+            }
+            for (size_t j = 0; j < nx; ++j)
+            {
+                bk[j] /= mL(k, k);
+            }
+        }
+    }
+
+    /*
+     * Solve A*X = B
+     * \param B A matrix with as many rows as A
+     * \return X so that L*L'*X = B
+     */
+    Matrix2D<RealT> solve(const Matrix2D<RealT>& B) const
+    {
+        Matrix2D<RealT> X(B);
+        solveInPlace(X);
+        return X;
+    }
+
+private:
+    // The lower triangular factor
+    Matrix2D<RealT> mL;
+
+    // Whether the matrix was symmetric, positive definite
+    bool mSPD;
+};
+}
+}
+
+#endif
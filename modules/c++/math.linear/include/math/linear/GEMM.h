@@ -0,0 +1,323 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __MATH_LINEAR_GEMM_H__
+#define __MATH_LINEAR_GEMM_H__
+
+#include <algorithm>
+#include <vector>
+
+#include <mt/BalancedRunnable1D.h>
+
+namespace math
+{
+namespace linear
+{
+/*!
+ *  \struct GEMMBlocking
+ *  \brief Block sizes used by gemm() for element type _T
+ *
+ *  The product is computed MC x KC blocks of A against KC x NC
+ *  blocks of B, which are copied ("packed") into contiguous panels
+ *  sized to stay in cache.  Each MR x NR tile of C is accumulated in
+ *  registers by a fixed-size kernel that the compiler vectorizes, so
+ *  NR is picked to fill a 64-byte vector register row.
+ */
+template <typename _T>
+struct GEMMBlocking
+{
+    static const size_t MR = 4;
+    static const size_t NR = sizeof(_T) >= 16 ? 4 : (sizeof(_T) >= 8 ? 8 : 16);
+    static const size_t MC = 64;
+    static const size_t KC = 256;
+    static const size_t NC = 1024;
+
+    //! Products with fewer multiply-adds than this skip the packing
+    static const size_t SMALL_SIZE = 32 * 32 * 32;
+};
+
+namespace detail
+{
+/*
+ *  Copies an mc x kc block of A into panels of MR rows, each stored
+ *  column by column, and zero-pads the last panel.
+ */
+template <typename _T>
+void packA(size_t mc, size_t kc,
+           const _T* a, size_t rowStride, size_t colStride,
+           _T* packed)
+{
+    const size_t MR = GEMMBlocking<_T>::MR;
+    for (size_t i0 = 0; i0 < mc; i0 += MR)
+    {
+        const size_t rows = std::min(MR, mc - i0);
+        for (size_t p = 0; p < kc; ++p)
+        {
+            const _T* const col = a + i0 * rowStride + p * colStride;
+            size_t i = 0;
+            for (; i < rows; ++i)
+                *packed++ = col[i * rowStride];
+            for (; i < MR; ++i)
+                *packed++ = _T(0);
+        }
+    }
+}
+
+/*
+ *  Copies a kc x nc block of B into panels of NR columns, each stored
+ *  row by row, and zero-pads the last panel.
+ */
+template <typename _T>
+void packB(size_t kc, size_t nc,
+           const _T* b, size_t rowStride, size_t colStride,
+           _T* packed)
+{
+    const size_t NR = GEMMBlocking<_T>::NR;
+    for (size_t j0 = 0; j0 < nc; j0 += NR)
+    {
+        const size_t cols = std::min(NR, nc - j0);
+        for (size_t p = 0; p < kc; ++p)
+        {
+            const _T* const row = b + p * rowStride + j0 * colStride;
+            size_t j = 0;
+            for (; j < cols; ++j)
+                *packed++ = row[j * colStride];
+            for (; j < NR; ++j)
+                *packed++ = _T(0);
+        }
+    }
+}
+
+/*
+ *  Multiplies an MR-row panel of A by an NR-column panel of B into
+ *  a register tile, then merges the tile into C.  On the first KC
+ *  block C is scaled by beta (or overwritten when beta is zero, so
+ *  that uninitialized output is never read).
+ */
+template <typename _T>
+void multiplyPanels(size_t kc, const _T* a, const _T* b,
+                    size_t rows, size_t cols,
+                    _T alpha, _T beta, bool first,
+                    _T* c, size_t cRowStride)
+{
+    const size_t MR = GEMMBlocking<_T>::MR;
+    const size_t NR = GEMMBlocking<_T>::NR;
+
+    _T acc[MR][NR];
+    for (size_t i = 0; i < MR; ++i)
+        for (size_t j = 0; j < NR; ++j)
+            acc[i][j] = _T(0);
+
+    for (size_t p = 0; p < kc; ++p, a += MR, b += NR)
+    {
+        for (size_t i = 0; i < MR; ++i)
+        {
+            const _T ai = a[i];
+            for (size_t j = 0; j < NR; ++j)
+                acc[i][j] += ai * b[j];
+        }
+    }
+
+    for (size_t i = 0; i < rows; ++i)
+    {
+        _T* const row = c + i * cRowStride;
+        if (!first)
+        {
+            for (size_t j = 0; j < cols; ++j)
+                row[j] += alpha * acc[i][j];
+        }
+        else if (beta == _T(0))
+        {
+            for (size_t j = 0; j < cols; ++j)
+                row[j] = alpha * acc[i][j];
+        }
+        else
+        {
+            for (size_t j = 0; j < cols; ++j)
+                row[j] = beta * row[j] + alpha * acc[i][j];
+        }
+    }
+}
+
+/*
+ *  Computes one MC-row block of C against a packed block of B.  Each
+ *  copy of this functor (one per thread) owns its packing buffer.
+ */
+template <typename _T>
+struct MultiplyRowBlock
+{
+    MultiplyRowBlock(size_t m, size_t kc, size_t nc,
+                     const _T* a, size_t aRowStride, size_t aColStride,
+                     const _T* packedB, _T alpha, _T beta, bool first,
+                     _T* c, size_t cRowStride) :
+        mM(m), mKC(kc), mNC(nc),
+        mA(a), mARowStride(aRowStride), mAColStride(aColStride),
+        mPackedB(packedB), mAlpha(alpha), mBeta(beta), mFirst(first),
+        mC(c), mCRowStride(cRowStride)
+    {
+    }
+
+    void operator()(size_t block) const
+    {
+        const size_t MR = GEMMBlocking<_T>::MR;
+        const size_t NR = GEMMBlocking<_T>::NR;
+        const size_t MC = GEMMBlocking<_T>::MC;
+
+        const size_t i0 = block * MC;
+        const size_t mc = std::min(MC, mM - i0);
+        mPackedA.resize(MC * mKC);
+        packA(mc, mKC, mA + i0 * mARowStride, mARowStride, mAColStride,
+              &mPackedA[0]);
+
+        for (size_t jr = 0; jr < mNC; jr += NR)
+        {
+            const _T* const b = mPackedB + jr * mKC;
+            for (size_t ir = 0; ir < mc; ir += MR)
+            {
+                multiplyPanels(mKC, &mPackedA[ir * mKC], b,
+                               std::min(MR, mc - ir), std::min(NR, mNC - jr),
+                               mAlpha, mBeta, mFirst,
+                               mC + (i0 + ir) * mCRowStride + jr,
+                               mCRowStride);
+            }
+        }
+    }
+
+    size_t mM;
+    size_t mKC;
+    size_t mNC;
+    const _T* mA;
+    size_t mARowStride;
+    size_t mAColStride;
+    const _T* mPackedB;
+    _T mAlpha;
+    _T mBeta;
+    bool mFirst;
+    _T* mC;
+    size_t mCRowStride;
+    mutable std::vector<_T> mPackedA;
+};
+
+/*
+ *  The unpacked product, for sizes where packing costs more than it
+ *  saves.  The k loop is hoisted out of the j loop so that rows of B
+ *  and C are walked contiguously.
+ */
+template <typename _T>
+void multiplySmall(size_t m, size_t n, size_t k, _T alpha,
+                   const _T* a, size_t aRowStride, size_t aColStride,
+                   const _T* b, size_t bRowStride, size_t bColStride,
+                   _T beta, _T* c, size_t cRowStride)
+{
+    for (size_t i = 0; i < m; ++i)
+    {
+        _T* const row = c + i * cRowStride;
+        for (size_t j = 0; j < n; ++j)
+            row[j] = (beta == _T(0)) ? _T(0) : beta * row[j];
+
+        for (size_t p = 0; p < k; ++p)
+        {
+            const _T aip = alpha * a[i * aRowStride + p * aColStride];
+            const _T* const brow = b + p * bRowStride;
+            for (size_t j = 0; j < n; ++j)
+                row[j] += aip * brow[j * bColStride];
+        }
+    }
+}
+}
+
+/*!
+ *  General matrix multiply, C = alpha * A * B + beta * C, where A is
+ *  m x k, B is k x n and C is m x n.
+ *
+ *  A and B are addressed through separate row and column strides, so
+ *  a transposed operand is described by swapping its strides rather
+ *  than by copying it.  C is row-major.  When beta is zero C is not
+ *  read, so it does not need to be initialized.
+ *
+ *  Large products are cache-blocked and may be split across threads
+ *  by rows of C.  The result does not depend on the number of
+ *  threads.  C must not overlap A or B.
+ *
+ *  \code
+        // C = A' * B, with A stored as k x m
+        gemm(m, n, k, 1.0, a, 1, m, b, n, 1, 0.0, c, n);
+ *  \endcode
+ *
+ *  \param numThreads The number of threads to use
+ */
+template <typename _T>
+void gemm(size_t m, size_t n, size_t k, _T alpha,
+          const _T* a, size_t aRowStride, size_t aColStride,
+          const _T* b, size_t bRowStride, size_t bColStride,
+          _T beta, _T* c, size_t cRowStride,
+          size_t numThreads = 1)
+{
+    const size_t MC = GEMMBlocking<_T>::MC;
+    const size_t KC = GEMMBlocking<_T>::KC;
+    const size_t NC = GEMMBlocking<_T>::NC;
+    const size_t NR = GEMMBlocking<_T>::NR;
+
+    if (m == 0 || n == 0)
+        return;
+
+    if (k == 0 || m * n * k <= GEMMBlocking<_T>::SMALL_SIZE)
+    {
+        detail::multiplySmall(m, n, k, alpha, a, aRowStride, aColStride,
+                              b, bRowStride, bColStride, beta, c, cRowStride);
+        return;
+    }
+
+    const size_t numBlocks = (m + MC - 1) / MC;
+    numThreads = std::max<size_t>(std::min(numThreads, numBlocks), 1);
+
+    std::vector<_T> packedB(
+            std::min(KC, k) * ((std::min(NC, n) + NR - 1) / NR * NR));
+
+    for (size_t jc = 0; jc < n; jc += NC)
+    {
+        const size_t nc = std::min(NC, n - jc);
+        for (size_t pc = 0; pc < k; pc += KC)
+        {
+            const size_t kc = std::min(KC, k - pc);
+            detail::packB(kc, nc, b + pc * bRowStride + jc * bColStride,
+                          bRowStride, bColStride, &packedB[0]);
+
+            const detail::MultiplyRowBlock<_T> op(
+                    m, kc, nc, a + pc * aColStride, aRowStride, aColStride,
+                    &packedB[0], alpha, beta, pc == 0,
+                    c + jc, cRowStride);
+            if (numThreads > 1)
+            {
+                mt::runBalanced1DWithCopies(numBlocks, numThreads, op);
+            }
+            else
+            {
+                for (size_t block = 0; block < numBlocks; ++block)
+                    op(block);
+            }
+        }
+    }
+}
+}
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include <functional>
 #include <import/sys.h>
 #include <mem/ScopedArray.h>
+#include <math/linear/GEMM.h>
 #include <math/linear/MatrixMxN.h>
 
 namespace math
@@ -600,8 +601,9 @@ public:
      *  Multiply an NxP matrix to a MxN matrix (this) to
      *  produce an MxP matrix output.
      *
-     *  This function accesses the inner arrays for
-     *  (potential, though slight) performance reasons.
+     *  This is the same as multiplyInto(mx, out), except that out
+     *  may also be this or mx, in which case the product is formed
+     *  in a temporary and copied into out.
      *
      *  \param mx An NxP matrix
      *  \param out An MxP matrix
@@ -617,35 +619,125 @@ public:
     void
     multiply(const Matrix2D& mx, Matrix2D &out) const
     {
-        size_t M(mM);
-        size_t N(mN);
-        size_t P(mx.mN);
+        if (&out != this && &out != &mx)
+        {
+            multiplyInto(mx, out);
+            return;
+        }
 
-        if (mN != mx.mM)
-            throw except::Exception(Ctxt(
-                "Invalid inner dimension sizes for multiply"));
-        if (out.mM != M)
-            throw except::Exception(Ctxt(
-                "Invalid output row size for multiply"));
-        if (out.mN != P)
-            throw except::Exception(Ctxt(
-                "Invalid output column size for multiply"));
+        Matrix2D product(out.mM, out.mN);
+        multiplyInto(mx, product);
+        std::copy(product.mRaw, product.mRaw + product.mMN, out.mRaw);
+    }
 
-        size_t i, j, k;
-        for (i = 0; i < M; i++)
-        {
-            for (j = 0; j < P; j++)
-            {
-                out(i, j) = 0;
+    /*!
+     *  Multiply an NxP matrix to a MxN matrix (this), writing the
+     *  MxP product into out without allocating.  Large products
+     *  are cache-blocked (see gemm()) and can be split across
+     *  threads.
+     *
+     *  \param mx An NxP matrix
+     *  \param out An MxP matrix, which must not be this or mx
+     *  \param numThreads The number of threads to use
+     *
+     *  \code
+           Matrix2D<> C(A.rows(), B.cols());
+           A.multiplyInto(B, C, 4);
+     *  \endcode
+     *
+     */
+    void multiplyInto(const Matrix2D& mx, Matrix2D& out,
+                      size_t numThreads = 1) const
+    {
+        multiplyInto(false, mx, false, 1, 0, out, numThreads);
+    }
 
-                for (k = 0; k < N; k++)
-                {
-                    out(i, j) += mRaw[i * N + k] * mx(k, j);
-                }
-            }
-        }
+    /*!
+     *  Accumulate a scaled product into out, out += alpha * this * mx,
+     *  without forming the product.
+     *
+     *  \param mx An NxP matrix
+     *  \param alpha The scale applied to the product
+     *  \param out An MxP matrix, which must not be this or mx
+     *  \param numThreads The number of threads to use
+     *
+     *  \code
+           // C -= A * B
+           A.addScaledInto(B, -1.0, C);
+     *  \endcode
+     *
+     */
+    void addScaledInto(const Matrix2D& mx, _T alpha, Matrix2D& out,
+                       size_t numThreads = 1) const
+    {
+        multiplyInto(false, mx, false, alpha, 1, out, numThreads);
     }
 
+    /*!
+     *  Multiply an MxP matrix by the transpose of this MxN matrix,
+     *  writing the NxP product into out.  The transpose is never
+     *  formed.
+     *
+     *  \param mx An MxP matrix
+     *  \param out An NxP matrix, which must not be this or mx
+     *  \param numThreads The number of threads to use
+     *
+     *  \code
+           // The normal equations matrix, A' * A
+           Matrix2D<> AtA(A.cols(), A.cols());
+           A.transposeMultiplyInto(A, AtA);
+     *  \endcode
+     *
+     */
+    void transposeMultiplyInto(const Matrix2D& mx, Matrix2D& out,
+                               size_t numThreads = 1) const
+    {
+        multiplyInto(true, mx, false, 1, 0, out, numThreads);
+    }
+
+    /*!
+     *  Multiply the transpose of a PxN matrix to this MxN matrix,
+     *  writing the MxP product into out.  The transpose is never
+     *  formed.
+     *
+     *  \param mx A PxN matrix
+     *  \param out An MxP matrix, which must not be this or mx
+     *  \param numThreads The number of threads to use
+     *
+     */
+    void multiplyTransposeInto(const Matrix2D& mx, Matrix2D& out,
+                               size_t numThreads = 1) const
+    {
+        multiplyInto(false, mx, true, 1, 0, out, numThreads);
+    }
+
+    /*!
+     *  Same as transposeMultiplyInto(), but returns the NxP
+     *  product.
+     *
+     *  \code
+           Matrix2D<> AtB = A.transposeMultiply(B);
+     *  \endcode
+     *
+     */
+    Matrix2D transposeMultiply(const Matrix2D& mx) const
+    {
+        Matrix2D newM(mN, mx.mN);
+        transposeMultiplyInto(mx, newM);
+        return newM;
+    }
+
+    /*!
+     *  Same as multiplyTransposeInto(), but returns the MxP
+     *  product.
+     *
+     */
+    Matrix2D multiplyTranspose(const Matrix2D& mx) const
+    {
+        Matrix2D newM(mM, mx.mM);
+        multiplyTransposeInto(mx, newM);
+        return newM;
+    }
 
     /*!
      *  Take in a matrix that is NxN and apply each diagonal
@@ -1119,6 +1211,39 @@ public:
             ar & mRaw[ii];
         }
     }
+
+private:
+    /*
+     *  out = alpha * op(this) * op(mx) + beta * out, where op()
+     *  optionally transposes its operand by swapping its strides.
+     */
+    void multiplyInto(bool transposeThis, const Matrix2D& mx,
+                      bool transposeMx, _T alpha, _T beta,
+                      Matrix2D& out, size_t numThreads) const
+    {
+        const size_t M = transposeThis ? mN : mM;
+        const size_t N = transposeThis ? mM : mN;
+        const size_t mxRows = transposeMx ? mx.mN : mx.mM;
+        const size_t P = transposeMx ? mx.mM : mx.mN;
+
+        if (N != mxRows)
+            throw except::Exception(Ctxt(
+                "Invalid inner dimension sizes for multiply"));
+        if (out.mM != M)
+            throw except::Exception(Ctxt(
+                "Invalid output row size for multiply"));
+        if (out.mN != P)
+            throw except::Exception(Ctxt(
+                "Invalid output column size for multiply"));
+        if (&out == this || &out == &mx)
+            throw except::Exception(Ctxt(
+                "Output of multiply cannot be one of its inputs"));
+
+        gemm(M, P, N, alpha,
+             mRaw, transposeThis ? 1 : mN, transposeThis ? mN : 1,
+             mx.mRaw, transposeMx ? 1 : mx.mN, transposeMx ? mx.mN : 1,
+             beta, out.mRaw, out.mN, numThreads);
+    }
 };
 
 /*!
@@ -1341,7 +1466,7 @@ template<typename _T> inline
 template<typename _T> inline
     Matrix2D<_T> leftInverse(const Matrix2D<_T>& mx)
 {
-    return inverse(mx.transpose() * mx) * mx.transpose();
+    return inverse(mx.transposeMultiply(mx)).multiplyTranspose(mx);
 }
 
 /*!
@@ -1354,7 +1479,7 @@ template<typename _T> inline
 template<typename _T> inline
     Matrix2D<_T> rightInverse(const Matrix2D<_T>& mx)
 {
-    return mx.transpose() * inverse(mx * mx.transpose());
+    return mx.transposeMultiply(inverse(mx.multiplyTranspose(mx)));
 }
 
 template<typename _T> Matrix2D<_T>
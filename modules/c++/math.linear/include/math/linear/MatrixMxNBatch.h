@@ -0,0 +1,362 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __MATH_LINEAR_MATRIX_M_X_N_BATCH_H__
+#define __MATH_LINEAR_MATRIX_M_X_N_BATCH_H__
+
+#include <algorithm>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <math/linear/MatrixMxN.h>
+
+namespace math
+{
+namespace linear
+{
+namespace detail
+{
+/*
+ *  The batch kernels work through this many elements at a time.  Each
+ *  block's results go to arrays on the stack before being copied out,
+ *  so the compiler can see that they don't alias the inputs and
+ *  vectorize across the block, and so outputs may alias inputs.
+ */
+const size_t BATCH_BLOCK = 256;
+
+/*
+ *  _NC arrays of one value per batch element, one after another in a
+ *  single allocation ("structure of arrays")
+ */
+template<size_t _NC, typename _T>
+class BatchStorage
+{
+public:
+    explicit BatchStorage(size_t size = 0) :
+        mSize(size),
+        mData(_NC * size)
+    {
+    }
+
+    size_t size() const
+    {
+        return mSize;
+    }
+
+    //! Resizes every component, keeping the first min(size, size()) values
+    void resize(size_t size)
+    {
+        if (size == mSize)
+        {
+            return;
+        }
+
+        std::vector<_T> data(_NC * size);
+        const size_t numKeep = std::min(size, mSize);
+        for (size_t c = 0; c < _NC && numKeep; ++c)
+        {
+            std::copy(&mData[c * mSize], &mData[c * mSize] + numKeep,
+                      &data[c * size]);
+        }
+        mData.swap(data);
+        mSize = size;
+    }
+
+    _T* component(size_t c)
+    {
+#if defined(MATH_LINEAR_BOUNDS)
+        assert(c < _NC);
+#endif
+        return mData.empty() ? NULL : &mData[c * mSize];
+    }
+
+    const _T* component(size_t c) const
+    {
+#if defined(MATH_LINEAR_BOUNDS)
+        assert(c < _NC);
+#endif
+        return mData.empty() ? NULL : &mData[c * mSize];
+    }
+
+private:
+    size_t mSize;
+    std::vector<_T> mData;
+};
+
+// The index of the first almostZero() value
+template<typename _T>
+size_t findAlmostZero(const _T* values, size_t count)
+{
+    size_t index = 0;
+    while (index < count && !almostZero(values[index]))
+    {
+        ++index;
+    }
+    return index;
+}
+}
+
+/*!
+ *  \class MatrixMxNBatch
+ *  \brief A batch of MatrixMxN stored as structure of arrays
+ *
+ *  Element (i, j) of every matrix in the batch is kept in one
+ *  contiguous array, component(i, j).  Kernels over the batch then run
+ *  the same arithmetic across many matrices at once, which the
+ *  compiler turns into SIMD code; operating on an array of MatrixMxN,
+ *  one at a time, it can't.
+ *
+ *  Use assign() and copyTo() to convert from and to arrays of
+ *  MatrixMxN.
+ */
+template<size_t _MD, size_t _ND, typename _T=double>
+class MatrixMxNBatch
+{
+public:
+    //! Construct a batch of size matrices (no initialization)
+    explicit MatrixMxNBatch(size_t size = 0) :
+        mStorage(size)
+    {
+    }
+
+    //! Construct from an array of size matrices
+    MatrixMxNBatch(const MatrixMxN<_MD, _ND, _T>* matrices, size_t size) :
+        mStorage(size)
+    {
+        assign(matrices, size);
+    }
+
+    size_t size() const
+    {
+        return mStorage.size();
+    }
+
+    void resize(size_t size)
+    {
+        mStorage.resize(size);
+    }
+
+    //! The array of element (i, j) of every matrix
+    _T* component(size_t i, size_t j)
+    {
+        return mStorage.component(i * _ND + j);
+    }
+
+    const _T* component(size_t i, size_t j) const
+    {
+        return mStorage.component(i * _ND + j);
+    }
+
+    //! Gather the matrix at index
+    MatrixMxN<_MD, _ND, _T> operator[](size_t index) const
+    {
+        MatrixMxN<_MD, _ND, _T> mx;
+        for (size_t i = 0; i < _MD; ++i)
+        {
+            for (size_t j = 0; j < _ND; ++j)
+            {
+                mx(i, j) = component(i, j)[index];
+            }
+        }
+        return mx;
+    }
+
+    //! Scatter mx into index
+    void set(size_t index, const MatrixMxN<_MD, _ND, _T>& mx)
+    {
+        for (size_t i = 0; i < _MD; ++i)
+        {
+            for (size_t j = 0; j < _ND; ++j)
+            {
+                component(i, j)[index] = mx(i, j);
+            }
+        }
+    }
+
+    //! Replace the contents with an array of size matrices
+    void assign(const MatrixMxN<_MD, _ND, _T>* matrices, size_t size)
+    {
+        if (size != this->size())
+        {
+            mStorage = detail::BatchStorage<_MD * _ND, _T>(size);
+        }
+        for (size_t i = 0; i < _MD; ++i)
+        {
+            for (size_t j = 0; j < _ND; ++j)
+            {
+                _T* const values = component(i, j);
+                for (size_t k = 0; k < size; ++k)
+                {
+                    values[k] = matrices[k](i, j);
+                }
+            }
+        }
+    }
+
+    //! Copy the batch to an array of size() matrices
+    void copyTo(MatrixMxN<_MD, _ND, _T>* matrices) const
+    {
+        for (size_t i = 0; i < _MD; ++i)
+        {
+            for (size_t j = 0; j < _ND; ++j)
+            {
+                const _T* const values = component(i, j);
+                for (size_t k = 0, n = size(); k < n; ++k)
+                {
+                    matrices[k](i, j) = values[k];
+                }
+            }
+        }
+    }
+
+private:
+    detail::BatchStorage<_MD * _ND, _T> mStorage;
+};
+
+/*!
+ *  Invert every matrix in a batch of 2x2s, as inverse() does for one.
+ *  out may be in.
+ *
+ *  \param in The matrices to invert
+ *  \param[out] out The inverses, resized to match in
+ *
+ *  \throw except::Exception if any matrix is not invertible.  The
+ *         message gives the index of the first one; out is left
+ *         partially written.
+ */
+template<typename _T>
+void inverse(const MatrixMxNBatch<2, 2, _T>& in, MatrixMxNBatch<2, 2, _T>& out)
+{
+    const size_t size = in.size();
+    out.resize(size);
+
+    const size_t blockSize = detail::BATCH_BLOCK;
+    for (size_t start = 0; start < size; start += blockSize)
+    {
+        const size_t count = std::min(blockSize, size - start);
+        const _T* const a = in.component(0, 0) + start;
+        const _T* const b = in.component(0, 1) + start;
+        const _T* const c = in.component(1, 0) + start;
+        const _T* const d = in.component(1, 1) + start;
+
+        _T inv[4][detail::BATCH_BLOCK];
+        _T determinant[detail::BATCH_BLOCK];
+        size_t numSingular = 0;
+        for (size_t k = 0; k < count; ++k)
+        {
+            determinant[k] = d[k] * a[k] - c[k] * b[k];
+            numSingular += almostZero(determinant[k]) ? 1 : 0;
+
+            const _T scale = _T(1) / determinant[k];
+            inv[0][k] =  d[k] * scale;
+            inv[1][k] = -b[k] * scale;
+            inv[2][k] = -c[k] * scale;
+            inv[3][k] =  a[k] * scale;
+        }
+
+        if (numSingular)
+        {
+            const size_t index = detail::findAlmostZero(determinant, count);
+            throw except::Exception(Ctxt(FmtX(
+                    "Non-invertible matrix at index %d", start + index)));
+        }
+
+        for (size_t n = 0; n < 4; ++n)
+        {
+            std::copy(inv[n], inv[n] + count,
+                      out.component(n / 2, n % 2) + start);
+        }
+    }
+}
+
+/*!
+ *  Invert every matrix in a batch of 3x3s by the adjugate, as inverse()
+ *  does for one.  out may be in.
+ *
+ *  \param in The matrices to invert
+ *  \param[out] out The inverses, resized to match in
+ *
+ *  \throw except::Exception if any matrix is not invertible.  The
+ *         message gives the index of the first one; out is left
+ *         partially written.
+ */
+template<typename _T>
+void inverse(const MatrixMxNBatch<3, 3, _T>& in, MatrixMxNBatch<3, 3, _T>& out)
+{
+    const size_t size = in.size();
+    out.resize(size);
+
+    const size_t blockSize = detail::BATCH_BLOCK;
+    for (size_t start = 0; start < size; start += blockSize)
+    {
+        const size_t count = std::min(blockSize, size - start);
+        const _T* const a = in.component(0, 0) + start;
+        const _T* const b = in.component(0, 1) + start;
+        const _T* const c = in.component(0, 2) + start;
+        const _T* const d = in.component(1, 0) + start;
+        const _T* const e = in.component(1, 1) + start;
+        const _T* const f = in.component(1, 2) + start;
+        const _T* const g = in.component(2, 0) + start;
+        const _T* const h = in.component(2, 1) + start;
+        const _T* const i = in.component(2, 2) + start;
+
+        _T inv[9][detail::BATCH_BLOCK];
+        _T determinant[detail::BATCH_BLOCK];
+        size_t numSingular = 0;
+        for (size_t k = 0; k < count; ++k)
+        {
+            const _T g1 = e[k] * i[k] - f[k] * h[k];
+            const _T g2 = d[k] * i[k] - f[k] * g[k];
+            const _T g3 = d[k] * h[k] - e[k] * g[k];
+            determinant[k] = a[k] * g1 - b[k] * g2 + c[k] * g3;
+            numSingular += almostZero(determinant[k]) ? 1 : 0;
+
+            const _T scale = _T(1) / determinant[k];
+            inv[0][k] = g1 * scale;
+            inv[1][k] = (c[k] * h[k] - b[k] * i[k]) * scale;
+            inv[2][k] = (b[k] * f[k] - c[k] * e[k]) * scale;
+            inv[3][k] = -g2 * scale;
+            inv[4][k] = (a[k] * i[k] - c[k] * g[k]) * scale;
+            inv[5][k] = (c[k] * d[k] - a[k] * f[k]) * scale;
+            inv[6][k] = g3 * scale;
+            inv[7][k] = (b[k] * g[k] - a[k] * h[k]) * scale;
+            inv[8][k] = (a[k] * e[k] - b[k] * d[k]) * scale;
+        }
+
+        if (numSingular)
+        {
+            const size_t index = detail::findAlmostZero(determinant, count);
+            throw except::Exception(Ctxt(FmtX(
+                    "Non-invertible matrix at index %d", start + index)));
+        }
+
+        for (size_t n = 0; n < 9; ++n)
+        {
+            std::copy(inv[n], inv[n] + count,
+                      out.component(n / 3, n % 3) + start);
+        }
+    }
+}
+}
+}
+
+#endif
@@ -0,0 +1,323 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __MATH_LINEAR_QR_H__
+#define __MATH_LINEAR_QR_H__
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <except/Exception.h>
+#include <math/linear/Matrix2D.h>
+
+namespace math
+{
+namespace linear
+{
+/*!
+ *   \class QR
+ *   \brief Householder QR decomposition of a rectangular matrix
+ *
+ *   For an m-by-n matrix A with m >= n, the QR decomposition is an
+ *   m-by-n orthogonal matrix Q and an n-by-n upper triangular matrix R
+ *   so that A = Q*R.  Q is kept implicitly as the Householder vectors,
+ *   stored below the diagonal of the decomposed matrix.
+ *
+ *   The decomposition solves the least squares problem min |A*X - B|
+ *   without forming A'*A, so unlike the normal equations it does not
+ *   square the condition number of A.
+ *
+ *   decomposeInPlace() overwrites A rather than copying it, which
+ *   matters for tall matrices, and solveInPlace() does not allocate.
+ *
+ *   This is based on the QR class from JAMA, a Java Matrix Library,
+ *   developed jointly by the Mathworks and NIST
+ *   (see http://math.nist.gov/javanumerics/jama).  The loops walk
+ *   rows rather than columns to suit the row-major Matrix2D.
+ *
+ *   RealT must be a real (non-complex) type
+ */
+template<typename RealT>
+class QR
+{
+public:
+    //! An empty decomposition; call decompose() before solving
+    QR() :
+        mQR(&mOwnQR)
+    {
+    }
+
+    /*
+     * Construct the QR decomposition of a copy of A
+     * \param A Rectangular matrix with at least as many rows as columns
+     */
+    explicit QR(const Matrix2D<RealT>& A) :
+        mQR(&mOwnQR)
+    {
+        decompose(A);
+    }
+
+    /*
+     * Decompose a copy of A, reusing the storage of the previous
+     * decomposition when A is the same size.
+     * \param A Rectangular matrix with at least as many rows as columns
+     */
+    void decompose(const Matrix2D<RealT>& A)
+    {
+        if (mOwnQR.rows() != A.rows() || mOwnQR.cols() != A.cols())
+        {
+            mOwnQR = Matrix2D<RealT>(A.rows(), A.cols());
+        }
+        std::copy(A.get(), A.get() + A.size(), mOwnQR[0]);
+        mQR = &mOwnQR;
+        factor();
+    }
+
+    /*
+     * Decompose A in place.  A is overwritten with the decomposition
+     * and must outlive this object, or the next call to decompose().
+     * \param A Rectangular matrix with at least as many rows as columns
+     */
+    void decomposeInPlace(Matrix2D<RealT>& A)
+    {
+        mQR = &A;
+        factor();
+    }
+
+    /*
+     * Is the matrix full rank?  A diagonal element of R counts as
+     * zero when it is within rounding error of the largest one.
+     */
+    bool isFullRank() const
+    {
+        RealT largest(0);
+        for (size_t j = 0; j < mRDiag.size(); ++j)
+        {
+            largest = std::max<RealT>(largest, std::abs(mRDiag[j]));
+        }
+        const RealT tolerance = largest *
+                std::numeric_limits<RealT>::epsilon() *
+                std::max(mQR->rows(), mQR->cols());
+        for (size_t j = 0; j < mRDiag.size(); ++j)
+        {
+            if (std::abs(mRDiag[j]) <= tolerance)
+            {
+                return false;
+            }
+        }
+        return !mRDiag.empty();
+    }
+
+    //! Return the upper triangular factor, R
+    Matrix2D<RealT> getR() const
+    {
+        const size_t n = mQR->cols();
+        Matrix2D<RealT> R(n, n, static_cast<RealT>(0));
+        for (size_t i = 0; i < n; ++i)
+        {
+            R(i, i) = mRDiag[i];
+            for (size_t j = i + 1; j < n; ++j)
+            {
+                R(i, j) = (*mQR)(i, j);
+            }
+        }
+        return R;
+    }
+
+    /*
+     * Solve the least squares problem min |A*X - B| in place
+     * \param B A matrix with as many rows as A.  On return, its first
+     *  n rows hold X, and the remaining rows the (rotated) residual.
+     * \throws if A is rank deficient
+     */
+    void solveInPlace(Matrix2D<RealT>& B) const
+    {
+        const Matrix2D<RealT>& qr = *mQR;
+        const size_t m = qr.rows();
+        const size_t n = qr.cols();
+        if (B.rows() != m)
+        {
+            throw except::Exception(Ctxt(
+                "Matrix row dimensions must agree"));
+        }
+        if (!isFullRank())
+        {
+            throw except::Exception(Ctxt("Matrix is rank deficient"));
+        }
+
+        const size_t nx = B.cols();
+
+        // Compute Y = Q'*B
+        for (size_t k = 0; k < n; ++k)
+        {
+            for (size_t j = 0; j < nx; ++j)
+            {
+                RealT s(0);
+                for (size_t i = k; i < m; ++i)
+                {
+                    s += qr(i, k) * B(i, j);
+                }
+                s = -s / qr(k, k);
+                for (size_t i = k; i < m; ++i)
+                {
+                    B(i, j) += s * qr(i, k);
+                }
+            }
+        }
+
+        // Solve R*X = Y
+        for (size_t k = n; k-- > 0; )
+        {
+            RealT* const bk = B[k];
+            for (size_t j = 0; j < nx; ++j)
+            {
+                bk[j] /= mRDiag[k];
+            }
+            for (size_t i = 0; i < k; ++i)
+            {
+                RealT* const bi = B[i];
+                const RealT rik = qr(i, k);
+                for (size_t j = 0; j < nx; ++j)
+                {
+                    bi[j] -= bk[j] * rik;
+                }
+            }
+        }
+    }
+
+    /*
+     * Solve the least squares problem min |A*X - B|
+     * \param B A matrix with as many rows as A
+     * \return X, with as many rows as A has columns
+     */
+    Matrix2D<RealT> solve(const Matrix2D<RealT>& B) const
+    {
+        Matrix2D<RealT> Y(B);
+        solveInPlace(Y);
+
+        const size_t n = mQR->cols();
+        Matrix2D<RealT> X(n, B.cols());
+        std::copy(Y.get(), Y.get() + X.size(), X[0]);
+        return X;
+    }
+
+private:
+    // Noncopyable, as mQR may point into this object
+    QR(const QR& );
+    QR& operator=(const QR& );
+
+    // Householder reduction of *mQR
+    void factor()
+    {
+        Matrix2D<RealT>& qr = *mQR;
+        const size_t m = qr.rows();
+        const size_t n = qr.cols();
+        if (m < n)
+        {
+            throw except::Exception(Ctxt(
+                "QR decomposition requires at least as many rows "
+                "as columns"));
+        }
+
+        mRDiag.resize(n);
+        mWork.resize(n);
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            // Compute 2-norm of k-th column without under/overflow,
+            // by scaling it by its largest element.
+            RealT scale(0);
+            for (size_t i = k; i < m; ++i)
+            {
+                scale = std::max<RealT>(scale, std::abs(qr(i, k)));
+            }
+            RealT nrm(0);
+            if (scale != 0)
+            {
+                for (size_t i = k; i < m; ++i)
+                {
+                    const RealT x = qr(i, k) / scale;
+                    nrm += x * x;
+                }
+                nrm = scale * static_cast<RealT>(std::sqrt(nrm));
+            }
+
+            if (nrm != 0)
+            {
+                // Form k-th Householder vector.
+                if (qr(k, k) < 0)
+                {
+                    nrm = -nrm;
+                }
+                for (size_t i = k; i < m; ++i)
+                {
+                    qr(i, k) /= nrm;
+                }
+                qr(k, k) += 1;
+
+                // Apply transformation to remaining columns, a whole
+                // row at a time.
+                std::fill(mWork.begin() + k + 1, mWork.end(), RealT(0));
+                for (size_t i = k; i < m; ++i)
+                {
+                    const RealT* const row = qr[i];
+                    const RealT vik = row[k];
+                    for (size_t j = k + 1; j < n; ++j)
+                    {
+                        mWork[j] += vik * row[j];
+                    }
+                }
+                for (size_t j = k + 1; j < n; ++j)
+                {
+                    mWork[j] = -mWork[j] / qr(k, k);
+                }
+                for (size_t i = k; i < m; ++i)
+                {
+                    RealT* const row = qr[i];
+                    const RealT vik = row[k];
+                    for (size_t j = k + 1; j < n; ++j)
+                    {
+                        row[j] += mWork[j] * vik;
+                    }
+                }
+            }
+            mRDiag[k] = -nrm;
+        }
+    }
+
+    // Storage for a copied matrix; see decompose()
+    Matrix2D<RealT> mOwnQR;
+
+    // The decomposed matrix: R above the diagonal, and the
+    // Householder vectors on and below it
+    Matrix2D<RealT>* mQR;
+
+    // The diagonal of R
+    std::vector<RealT> mRDiag;
+
+    // Working storage for the Householder updates
+    std::vector<RealT> mWork;
+};
+}
+}
+
+#endif
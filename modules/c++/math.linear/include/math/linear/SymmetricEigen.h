@@ -0,0 +1,315 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __MATH_LINEAR_SYMMETRIC_EIGEN_H__
+#define __MATH_LINEAR_SYMMETRIC_EIGEN_H__
+
+#include <algorithm>
+#include <cmath>
+
+#include <import/except.h>
+#include <str/Convert.h>
+#include <mt/BalancedRunnable1D.h>
+#include <math/linear/MatrixMxN.h>
+#include <math/linear/MatrixMxNBatch.h>
+#include <math/linear/VectorN.h>
+#include <math/linear/VectorNBatch.h>
+
+namespace math
+{
+namespace linear
+{
+namespace detail
+{
+// Cyclic Jacobi converges quadratically; small matrices take 4 - 6 sweeps
+const size_t MAX_JACOBI_SWEEPS = 50;
+
+/*
+ *  Diagonalize the symmetric matrix a in place by cyclic Jacobi
+ *  rotations, accumulating them into v.  On success, the diagonal of a
+ *  holds the eigenvalues in ascending order, the columns of v the
+ *  corresponding eigenvectors, and the function returns true.  Only
+ *  the stack is used, so this is safe to call from many threads.
+ *
+ *  A 2x2 matrix takes exactly one rotation, i.e. this is the closed
+ *  form solution.
+ */
+template<size_t _N, typename _T>
+bool jacobi(_T a[_N][_N], _T v[_N][_N])
+{
+    for (size_t i = 0; i < _N; ++i)
+    {
+        for (size_t j = 0; j < _N; ++j)
+        {
+            v[i][j] = (i == j) ? _T(1) : _T(0);
+        }
+    }
+
+    bool converged = false;
+    for (size_t sweep = 0; sweep < MAX_JACOBI_SWEEPS && !converged; ++sweep)
+    {
+        _T off(0);
+        for (size_t p = 0; p + 1 < _N; ++p)
+        {
+            for (size_t q = p + 1; q < _N; ++q)
+            {
+                off += std::abs(a[p][q]);
+            }
+        }
+        if (off == _T(0))
+        {
+            converged = true;
+            break;
+        }
+
+        for (size_t p = 0; p + 1 < _N; ++p)
+        {
+            for (size_t q = p + 1; q < _N; ++q)
+            {
+                const _T apq = a[p][q];
+                const _T app = a[p][p];
+                const _T aqq = a[q][q];
+
+                // Once a[p][q] no longer changes either diagonal
+                // element, rotating it away changes nothing but it
+                const _T g = _T(100) * std::abs(apq);
+                if (std::abs(app) + g == std::abs(app) &&
+                    std::abs(aqq) + g == std::abs(aqq))
+                {
+                    a[p][q] = a[q][p] = _T(0);
+                    continue;
+                }
+                if (apq == _T(0))
+                {
+                    continue;
+                }
+
+                // t = tan of the rotation angle, taking the smaller root
+                const _T theta = (aqq - app) / (_T(2) * apq);
+                _T t = _T(1) / (std::abs(theta) +
+                                std::sqrt(theta * theta + _T(1)));
+                if (theta < _T(0))
+                {
+                    t = -t;
+                }
+                const _T c = _T(1) / std::sqrt(t * t + _T(1));
+                const _T s = t * c;
+
+                a[p][p] = app - t * apq;
+                a[q][q] = aqq + t * apq;
+                a[p][q] = a[q][p] = _T(0);
+                for (size_t k = 0; k < _N; ++k)
+                {
+                    if (k != p && k != q)
+                    {
+                        const _T akp = a[k][p];
+                        const _T akq = a[k][q];
+                        a[k][p] = a[p][k] = c * akp - s * akq;
+                        a[k][q] = a[q][k] = s * akp + c * akq;
+                    }
+                }
+                for (size_t k = 0; k < _N; ++k)
+                {
+                    const _T vkp = v[k][p];
+                    const _T vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    // Sort ascending, as Eigenvalue does
+    for (size_t i = 0; i + 1 < _N; ++i)
+    {
+        size_t k = i;
+        for (size_t j = i + 1; j < _N; ++j)
+        {
+            if (a[j][j] < a[k][k])
+            {
+                k = j;
+            }
+        }
+        if (k != i)
+        {
+            std::swap(a[i][i], a[k][k]);
+            for (size_t j = 0; j < _N; ++j)
+            {
+                std::swap(v[j][i], v[j][k]);
+            }
+        }
+    }
+    return converged;
+}
+
+// Decomposes the matrices [start, end) of a batch
+template<size_t _N, typename _T>
+void symmetricEigen(const MatrixMxNBatch<_N, _N, _T>& matrices,
+                    size_t start, size_t end,
+                    VectorNBatch<_N, _T>& values,
+                    MatrixMxNBatch<_N, _N, _T>& vectors)
+{
+    _T a[_N][_N];
+    _T v[_N][_N];
+    for (size_t k = start; k < end; ++k)
+    {
+        for (size_t i = 0; i < _N; ++i)
+        {
+            for (size_t j = 0; j < _N; ++j)
+            {
+                a[i][j] = matrices.component(i, j)[k];
+            }
+        }
+
+        if (!jacobi<_N, _T>(a, v))
+        {
+            throw except::Exception(Ctxt(
+                    "Eigen decomposition did not converge at index " +
+                    str::toString(k)));
+        }
+
+        for (size_t i = 0; i < _N; ++i)
+        {
+            values.component(i)[k] = a[i][i];
+            for (size_t j = 0; j < _N; ++j)
+            {
+                vectors.component(i, j)[k] = v[i][j];
+            }
+        }
+    }
+}
+
+// Decomposes one BATCH_BLOCK of matrices
+template<size_t _N, typename _T>
+struct SymmetricEigenBlock
+{
+    SymmetricEigenBlock(const MatrixMxNBatch<_N, _N, _T>& matrices,
+                        VectorNBatch<_N, _T>& values,
+                        MatrixMxNBatch<_N, _N, _T>& vectors) :
+        mMatrices(matrices), mValues(values), mVectors(vectors)
+    {
+    }
+
+    void operator()(size_t block) const
+    {
+        const size_t start = block * BATCH_BLOCK;
+        symmetricEigen(mMatrices, start,
+                       std::min(start + BATCH_BLOCK, mMatrices.size()),
+                       mValues, mVectors);
+    }
+
+    const MatrixMxNBatch<_N, _N, _T>& mMatrices;
+    VectorNBatch<_N, _T>& mValues;
+    MatrixMxNBatch<_N, _N, _T>& mVectors;
+};
+}
+
+/*!
+ *  Eigen decomposition of a small symmetric matrix, A = V*D*V', by
+ *  cyclic Jacobi rotations.  This gives the same answer as the
+ *  symmetric case of Eigenvalue, to rounding, but works on the stack
+ *  rather than copying A into a Matrix2D and allocating working
+ *  vectors, so it is much faster for the 2x2 - 6x6 matrices (e.g.
+ *  covariances) it is meant for.  Only the upper and lower triangles
+ *  must agree; symmetry isn't checked.
+ *
+ *  \param A Symmetric matrix
+ *  \param[out] values The eigenvalues, in ascending order
+ *  \param[out] vectors The eigenvectors, one per column, in the same
+ *              order.  These are orthonormal, but their signs may
+ *              differ from Eigenvalue's.  vectors may be A.
+ *
+ *  \throw except::Exception if the iteration didn't converge, which
+ *         only happens for non-finite input
+ */
+template<size_t _N, typename _T>
+void symmetricEigen(const MatrixMxN<_N, _N, _T>& A,
+                    VectorN<_N, _T>& values,
+                    MatrixMxN<_N, _N, _T>& vectors)
+{
+    _T a[_N][_N];
+    _T v[_N][_N];
+    for (size_t i = 0; i < _N; ++i)
+    {
+        for (size_t j = 0; j < _N; ++j)
+        {
+            a[i][j] = A(i, j);
+        }
+    }
+
+    if (!detail::jacobi<_N, _T>(a, v))
+    {
+        throw except::Exception(Ctxt("Eigen decomposition did not converge"));
+    }
+
+    for (size_t i = 0; i < _N; ++i)
+    {
+        values[i] = a[i][i];
+        for (size_t j = 0; j < _N; ++j)
+        {
+            vectors(i, j) = v[i][j];
+        }
+    }
+}
+
+/*!
+ *  symmetricEigen() of every matrix in a batch.  The outputs are only
+ *  reallocated when their size changes, so reusing them across calls
+ *  avoids all allocation.  vectors may be matrices.
+ *
+ *  \param matrices Symmetric matrices
+ *  \param[out] values The eigenvalues of each, in ascending order,
+ *              resized to match matrices
+ *  \param[out] vectors The eigenvectors of each, one per column,
+ *              resized to match matrices
+ *  \param numThreads Number of threads to spread the batch over
+ *
+ *  \throw except::Exception if the iteration didn't converge for a
+ *         matrix.  The message gives its index.
+ */
+template<size_t _N, typename _T>
+void symmetricEigen(const MatrixMxNBatch<_N, _N, _T>& matrices,
+                    VectorNBatch<_N, _T>& values,
+                    MatrixMxNBatch<_N, _N, _T>& vectors,
+                    size_t numThreads = 1)
+{
+    const size_t size = matrices.size();
+    values.resize(size);
+    vectors.resize(size);
+
+    const size_t numBlocks =
+            (size + detail::BATCH_BLOCK - 1) / detail::BATCH_BLOCK;
+    if (numThreads > 1 && numBlocks > 1)
+    {
+        mt::runBalanced1D(numBlocks,
+                          std::min(numThreads, numBlocks),
+                          detail::SymmetricEigenBlock<_N, _T>(
+                                  matrices, values, vectors));
+    }
+    else
+    {
+        detail::symmetricEigen(matrices, 0, size, values, vectors);
+    }
+}
+}
+}
+
+#endif
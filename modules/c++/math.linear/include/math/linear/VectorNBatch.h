@@ -0,0 +1,547 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __MATH_LINEAR_VECTOR_N_BATCH_H__
+#define __MATH_LINEAR_VECTOR_N_BATCH_H__
+
+#include <algorithm>
+#include <cmath>
+
+#include <math/linear/MatrixMxNBatch.h>
+#include <math/linear/VectorN.h>
+
+namespace math
+{
+namespace linear
+{
+/*!
+ *  \class VectorNBatch
+ *  \brief A batch of VectorN stored as structure of arrays
+ *
+ *  Component i of every vector in the batch is kept in one contiguous
+ *  array, component(i), so that the kernels below vectorize across
+ *  the batch.  Use assign() and copyTo() to convert from and to arrays
+ *  of VectorN, and assignInterleaved() and copyToInterleaved() for
+ *  raw x0, y0, z0, x1, ... buffers.
+ *
+ *  \code
+    VectorNBatch<3> ecef(points, numPoints);
+    VectorNBatch<3> enu;
+    multiply(ecefToENU, ecef, enu);
+ *  \endcode
+ */
+template<size_t _ND, typename _T=double>
+class VectorNBatch
+{
+public:
+    //! Construct a batch of size vectors (no initialization)
+    explicit VectorNBatch(size_t size = 0) :
+        mStorage(size)
+    {
+    }
+
+    //! Construct from an array of size vectors
+    VectorNBatch(const VectorN<_ND, _T>* vectors, size_t size) :
+        mStorage(size)
+    {
+        assign(vectors, size);
+    }
+
+    size_t size() const
+    {
+        return mStorage.size();
+    }
+
+    void resize(size_t size)
+    {
+        mStorage.resize(size);
+    }
+
+    //! The array of component i of every vector
+    _T* component(size_t i)
+    {
+        return mStorage.component(i);
+    }
+
+    const _T* component(size_t i) const
+    {
+        return mStorage.component(i);
+    }
+
+    //! Gather the vector at index
+    VectorN<_ND, _T> operator[](size_t index) const
+    {
+        VectorN<_ND, _T> vec;
+        for (size_t i = 0; i < _ND; ++i)
+        {
+            vec[i] = component(i)[index];
+        }
+        return vec;
+    }
+
+    //! Scatter vec into index
+    void set(size_t index, const VectorN<_ND, _T>& vec)
+    {
+        for (size_t i = 0; i < _ND; ++i)
+        {
+            component(i)[index] = vec[i];
+        }
+    }
+
+    //! Replace the contents with an array of size vectors
+    void assign(const VectorN<_ND, _T>* vectors, size_t size)
+    {
+        resize(size);
+        for (size_t i = 0; i < _ND; ++i)
+        {
+            _T* const values = component(i);
+            for (size_t k = 0; k < size; ++k)
+            {
+                values[k] = vectors[k][i];
+            }
+        }
+    }
+
+    //! Replace the contents with size vectors of _ND values each
+    void assignInterleaved(const _T* raw, size_t size)
+    {
+        resize(size);
+        for (size_t i = 0; i < _ND; ++i)
+        {
+            _T* const values = component(i);
+            for (size_t k = 0; k < size; ++k)
+            {
+                values[k] = raw[k * _ND + i];
+            }
+        }
+    }
+
+    //! Copy the batch to an array of size() vectors
+    void copyTo(VectorN<_ND, _T>* vectors) const
+    {
+        for (size_t i = 0; i < _ND; ++i)
+        {
+            const _T* const values = component(i);
+            for (size_t k = 0, n = size(); k < n; ++k)
+            {
+                vectors[k][i] = values[k];
+            }
+        }
+    }
+
+    //! Copy the batch to size() * _ND values, one vector after another
+    void copyToInterleaved(_T* raw) const
+    {
+        for (size_t i = 0; i < _ND; ++i)
+        {
+            const _T* const values = component(i);
+            for (size_t k = 0, n = size(); k < n; ++k)
+            {
+                raw[k * _ND + i] = values[k];
+            }
+        }
+    }
+
+private:
+    detail::BatchStorage<_ND, _T> mStorage;
+};
+
+/*!
+ *  Apply one matrix to every vector in a batch, out[k] = mx * in[k].
+ *  out may be in when _MD == _ND.
+ *
+ *  \param mx The matrix to apply
+ *  \param in The vectors to transform
+ *  \param[out] out The transformed vectors, resized to match in
+ */
+template<size_t _MD, size_t _ND, typename _T>
+void multiply(const MatrixMxN<_MD, _ND, _T>& mx,
+              const VectorNBatch<_ND, _T>& in,
+              VectorNBatch<_MD, _T>& out)
+{
+    const size_t size = in.size();
+    out.resize(size);
+
+    const size_t blockSize = detail::BATCH_BLOCK;
+    _T result[_MD][detail::BATCH_BLOCK];
+    for (size_t start = 0; start < size; start += blockSize)
+    {
+        const size_t count = std::min(blockSize, size - start);
+        for (size_t i = 0; i < _MD; ++i)
+        {
+            const _T m0 = mx(i, 0);
+            const _T* const x0 = in.component(0) + start;
+            for (size_t k = 0; k < count; ++k)
+            {
+                result[i][k] = m0 * x0[k];
+            }
+            for (size_t j = 1; j < _ND; ++j)
+            {
+                const _T mj = mx(i, j);
+                const _T* const xj = in.component(j) + start;
+                for (size_t k = 0; k < count; ++k)
+                {
+                    result[i][k] += mj * xj[k];
+                }
+            }
+        }
+        for (size_t i = 0; i < _MD; ++i)
+        {
+            std::copy(result[i], result[i] + count,
+                      out.component(i) + start);
+        }
+    }
+}
+
+/*!
+ *  Apply each matrix of a batch to the matching vector,
+ *  out[k] = mx[k] * in[k].  out may be in when _MD == _ND.
+ *
+ *  \param mx The matrices to apply, one per vector
+ *  \param in The vectors to transform
+ *  \param[out] out The transformed vectors, resized to match in
+ */
+template<size_t _MD, size_t _ND, typename _T>
+void multiply(const MatrixMxNBatch<_MD, _ND, _T>& mx,
+              const VectorNBatch<_ND, _T>& in,
+              VectorNBatch<_MD, _T>& out)
+{
+    const size_t size = in.size();
+    if (mx.size() != size)
+    {
+        throw except::Exception(Ctxt(FmtX(
+                "Batch sizes differ: %d matrices, %d vectors",
+                mx.size(), size)));
+    }
+    out.resize(size);
+
+    const size_t blockSize = detail::BATCH_BLOCK;
+    _T result[_MD][detail::BATCH_BLOCK];
+    for (size_t start = 0; start < size; start += blockSize)
+    {
+        const size_t count = std::min(blockSize, size - start);
+        for (size_t i = 0; i < _MD; ++i)
+        {
+            const _T* const m0 = mx.component(i, 0) + start;
+            const _T* const x0 = in.component(0) + start;
+            for (size_t k = 0; k < count; ++k)
+            {
+                result[i][k] = m0[k] * x0[k];
+            }
+            for (size_t j = 1; j < _ND; ++j)
+            {
+                const _T* const mj = mx.component(i, j) + start;
+                const _T* const xj = in.component(j) + start;
+                for (size_t k = 0; k < count; ++k)
+                {
+                    result[i][k] += mj[k] * xj[k];
+                }
+            }
+        }
+        for (size_t i = 0; i < _MD; ++i)
+        {
+            std::copy(result[i], result[i] + count,
+                      out.component(i) + start);
+        }
+    }
+}
+
+/*!
+ *  Dot products of matching vectors, out[k] = a[k] . b[k]
+ *
+ *  \param a The first vectors
+ *  \param b The second vectors, as many as a
+ *  \param[out] out a.size() values
+ */
+template<size_t _ND, typename _T>
+void dot(const VectorNBatch<_ND, _T>& a, const VectorNBatch<_ND, _T>& b,
+         _T* out)
+{
+    const size_t size = a.size();
+    if (b.size() != size)
+    {
+        throw except::Exception(Ctxt(FmtX(
+                "Batch sizes differ: %d and %d", size, b.size())));
+    }
+
+    const size_t blockSize = detail::BATCH_BLOCK;
+    _T result[detail::BATCH_BLOCK];
+    for (size_t start = 0; start < size; start += blockSize)
+    {
+        const size_t count = std::min(blockSize, size - start);
+        std::fill(result, result + count, _T(0));
+        for (size_t i = 0; i < _ND; ++i)
+        {
+            const _T* const ai = a.component(i) + start;
+            const _T* const bi = b.component(i) + start;
+            for (size_t k = 0; k < count; ++k)
+            {
+                result[k] += ai[k] * bi[k];
+            }
+        }
+        std::copy(result, result + count, out + start);
+    }
+}
+
+/*!
+ *  Euclidean norms of every vector
+ *
+ *  \param vectors The vectors
+ *  \param[out] out vectors.size() values
+ */
+template<size_t _ND, typename _T>
+void norm(const VectorNBatch<_ND, _T>& vectors, _T* out)
+{
+    dot(vectors, vectors, out);
+    for (size_t k = 0, size = vectors.size(); k < size; ++k)
+    {
+        out[k] = std::sqrt(out[k]);
+    }
+}
+
+/*!
+ *  Scale every vector in place to unit length.  As with
+ *  VectorN::normalize(), a zero vector becomes NaN.
+ */
+template<size_t _ND, typename _T>
+void normalize(VectorNBatch<_ND, _T>& vectors)
+{
+    const size_t size = vectors.size();
+    const size_t blockSize = detail::BATCH_BLOCK;
+    _T scale[detail::BATCH_BLOCK];
+    for (size_t start = 0; start < size; start += blockSize)
+    {
+        const size_t count = std::min(blockSize, size - start);
+        std::fill(scale, scale + count, _T(0));
+        for (size_t i = 0; i < _ND; ++i)
+        {
+            const _T* const values = vectors.component(i) + start;
+            for (size_t k = 0; k < count; ++k)
+            {
+                scale[k] += values[k] * values[k];
+            }
+        }
+        for (size_t k = 0; k < count; ++k)
+        {
+            scale[k] = _T(1) / std::sqrt(scale[k]);
+        }
+        for (size_t i = 0; i < _ND; ++i)
+        {
+            _T* const values = vectors.component(i) + start;
+            for (size_t k = 0; k < count; ++k)
+            {
+                values[k] *= scale[k];
+            }
+        }
+    }
+}
+
+/*!
+ *  Cross products of matching vectors, out[k] = a[k] x b[k].  out may
+ *  be a or b.
+ *
+ *  \param a The first vectors
+ *  \param b The second vectors, as many as a
+ *  \param[out] out The cross products, resized to match a
+ */
+template<typename _T>
+void cross(const VectorNBatch<3, _T>& a, const VectorNBatch<3, _T>& b,
+           VectorNBatch<3, _T>& out)
+{
+    const size_t size = a.size();
+    if (b.size() != size)
+    {
+        throw except::Exception(Ctxt(FmtX(
+                "Batch sizes differ: %d and %d", size, b.size())));
+    }
+    out.resize(size);
+
+    const size_t blockSize = detail::BATCH_BLOCK;
+    _T result[3][detail::BATCH_BLOCK];
+    for (size_t start = 0; start < size; start += blockSize)
+    {
+        const size_t count = std::min(blockSize, size - start);
+        const _T* const u0 = a.component(0) + start;
+        const _T* const u1 = a.component(1) + start;
+        const _T* const u2 = a.component(2) + start;
+        const _T* const v0 = b.component(0) + start;
+        const _T* const v1 = b.component(1) + start;
+        const _T* const v2 = b.component(2) + start;
+        for (size_t k = 0; k < count; ++k)
+        {
+            result[0][k] = u1[k] * v2[k] - u2[k] * v1[k];
+            result[1][k] = u2[k] * v0[k] - u0[k] * v2[k];
+            result[2][k] = u0[k] * v1[k] - u1[k] * v0[k];
+        }
+        for (size_t i = 0; i < 3; ++i)
+        {
+            std::copy(result[i], result[i] + count,
+                      out.component(i) + start);
+        }
+    }
+}
+
+/*!
+ *  Solve mx[k] * x[k] = rhs[k] for every 2x2 system in a batch, by
+ *  Cramer's rule.  x may be rhs.
+ *
+ *  \param mx The matrices
+ *  \param rhs The right hand sides, one per matrix
+ *  \param[out] x The solutions, resized to match rhs
+ *
+ *  \throw except::Exception if any matrix is not invertible
+ */
+template<typename _T>
+void solve(const MatrixMxNBatch<2, 2, _T>& mx,
+           const VectorNBatch<2, _T>& rhs,
+           VectorNBatch<2, _T>& x)
+{
+    const size_t size = rhs.size();
+    if (mx.size() != size)
+    {
+        throw except::Exception(Ctxt(FmtX(
+                "Batch sizes differ: %d matrices, %d vectors",
+                mx.size(), size)));
+    }
+    x.resize(size);
+
+    const size_t blockSize = detail::BATCH_BLOCK;
+    _T result[2][detail::BATCH_BLOCK];
+    _T determinant[detail::BATCH_BLOCK];
+    for (size_t start = 0; start < size; start += blockSize)
+    {
+        const size_t count = std::min(blockSize, size - start);
+        const _T* const m00 = mx.component(0, 0) + start;
+        const _T* const m01 = mx.component(0, 1) + start;
+        const _T* const m10 = mx.component(1, 0) + start;
+        const _T* const m11 = mx.component(1, 1) + start;
+        const _T* const r0 = rhs.component(0) + start;
+        const _T* const r1 = rhs.component(1) + start;
+
+        size_t numSingular = 0;
+        for (size_t k = 0; k < count; ++k)
+        {
+            determinant[k] = m00[k] * m11[k] - m01[k] * m10[k];
+            numSingular += almostZero(determinant[k]) ? 1 : 0;
+
+            const _T scale = _T(1) / determinant[k];
+            result[0][k] = (m11[k] * r0[k] - m01[k] * r1[k]) * scale;
+            result[1][k] = (m00[k] * r1[k] - m10[k] * r0[k]) * scale;
+        }
+
+        if (numSingular)
+        {
+            const size_t index = detail::findAlmostZero(determinant, count);
+            throw except::Exception(Ctxt(FmtX(
+                    "Non-invertible matrix at index %d", start + index)));
+        }
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            std::copy(result[i], result[i] + count,
+                      x.component(i) + start);
+        }
+    }
+}
+
+/*!
+ *  Solve mx[k] * x[k] = rhs[k] for every 3x3 system in a batch, by
+ *  Cramer's rule.  x may be rhs.
+ *
+ *  \param mx The matrices
+ *  \param rhs The right hand sides, one per matrix
+ *  \param[out] x The solutions, resized to match rhs
+ *
+ *  \throw except::Exception if any matrix is not invertible
+ */
+template<typename _T>
+void solve(const MatrixMxNBatch<3, 3, _T>& mx,
+           const VectorNBatch<3, _T>& rhs,
+           VectorNBatch<3, _T>& x)
+{
+    const size_t size = rhs.size();
+    if (mx.size() != size)
+    {
+        throw except::Exception(Ctxt(FmtX(
+                "Batch sizes differ: %d matrices, %d vectors",
+                mx.size(), size)));
+    }
+    x.resize(size);
+
+    const size_t blockSize = detail::BATCH_BLOCK;
+    _T result[3][detail::BATCH_BLOCK];
+    _T determinant[detail::BATCH_BLOCK];
+    for (size_t start = 0; start < size; start += blockSize)
+    {
+        const size_t count = std::min(blockSize, size - start);
+        const _T* const a = mx.component(0, 0) + start;
+        const _T* const b = mx.component(0, 1) + start;
+        const _T* const c = mx.component(0, 2) + start;
+        const _T* const d = mx.component(1, 0) + start;
+        const _T* const e = mx.component(1, 1) + start;
+        const _T* const f = mx.component(1, 2) + start;
+        const _T* const g = mx.component(2, 0) + start;
+        const _T* const h = mx.component(2, 1) + start;
+        const _T* const i = mx.component(2, 2) + start;
+        const _T* const r0 = rhs.component(0) + start;
+        const _T* const r1 = rhs.component(1) + start;
+        const _T* const r2 = rhs.component(2) + start;
+
+        size_t numSingular = 0;
+        for (size_t k = 0; k < count; ++k)
+        {
+            // The rows of the adjugate, as in inverse()
+            const _T g1 = e[k] * i[k] - f[k] * h[k];
+            const _T g2 = d[k] * i[k] - f[k] * g[k];
+            const _T g3 = d[k] * h[k] - e[k] * g[k];
+            determinant[k] = a[k] * g1 - b[k] * g2 + c[k] * g3;
+            numSingular += almostZero(determinant[k]) ? 1 : 0;
+
+            const _T scale = _T(1) / determinant[k];
+            result[0][k] = (g1 * r0[k] +
+                            (c[k] * h[k] - b[k] * i[k]) * r1[k] +
+                            (b[k] * f[k] - c[k] * e[k]) * r2[k]) * scale;
+            result[1][k] = (-g2 * r0[k] +
+                            (a[k] * i[k] - c[k] * g[k]) * r1[k] +
+                            (c[k] * d[k] - a[k] * f[k]) * r2[k]) * scale;
+            result[2][k] = (g3 * r0[k] +
+                            (b[k] * g[k] - a[k] * h[k]) * r1[k] +
+                            (a[k] * e[k] - b[k] * d[k]) * r2[k]) * scale;
+        }
+
+        if (numSingular)
+        {
+            const size_t index = detail::findAlmostZero(determinant, count);
+            throw except::Exception(Ctxt(FmtX(
+                    "Non-invertible matrix at index %d", start + index)));
+        }
+
+        for (size_t n = 0; n < 3; ++n)
+        {
+            std::copy(result[n], result[n] + count,
+                      x.component(n) + start);
+        }
+    }
+}
+}
+}
+
+#endif
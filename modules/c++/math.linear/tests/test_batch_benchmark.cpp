@@ -0,0 +1,159 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Compares the structure of arrays batch kernels against looping over
+    arrays of VectorN and MatrixMxN.
+
+    usage: test_batch_benchmark [size]
+        size: number of vectors and matrices (default 1000000)
+
+    Throughput is reported in millions of elements per second.
+*/
+
+#include <stdlib.h>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <math/linear/VectorNBatch.h>
+#include <str/Convert.h>
+
+namespace
+{
+typedef math::linear::VectorN<3, double> Vector3;
+typedef math::linear::MatrixMxN<3, 3, double> Matrix3x3;
+
+void report(const std::string& name, size_t size, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(1) << size / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const size_t size =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 1000000;
+
+        std::vector<Vector3> vectors(size);
+        std::vector<Matrix3x3> matrices(size);
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            for (size_t jj = 0; jj < 3; ++jj)
+            {
+                vectors[ii][jj] = 2.0 * rand() / RAND_MAX - 1.0;
+                for (size_t kk = 0; kk < 3; ++kk)
+                {
+                    matrices[ii](jj, kk) = 2.0 * rand() / RAND_MAX - 1.0 +
+                            (jj == kk ? 4.0 : 0.0);
+                }
+            }
+        }
+        const Matrix3x3 rotation = matrices[0];
+
+        math::linear::VectorNBatch<3, double> batch(&vectors[0], size);
+        math::linear::MatrixMxNBatch<3, 3, double> matrixBatch(&matrices[0],
+                                                               size);
+        std::vector<Vector3> outVectors(size);
+        std::vector<Matrix3x3> outMatrices(size);
+        math::linear::VectorNBatch<3, double> outBatch(size);
+        math::linear::MatrixMxNBatch<3, 3, double> outMatrixBatch(size);
+
+        std::cout << size << " elements (million elements/s)\n\n";
+
+        sys::RealTimeStopWatch watch;
+        watch.start();
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            outVectors[ii] = rotation * vectors[ii];
+        }
+        report("VectorN rotate", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::linear::multiply(rotation, batch, outBatch);
+        report("VectorNBatch rotate", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            outVectors[ii] = math::linear::cross(vectors[ii], outVectors[ii]);
+        }
+        report("VectorN cross", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::linear::cross(batch, outBatch, outBatch);
+        report("VectorNBatch cross", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            outVectors[ii].normalize();
+        }
+        report("VectorN normalize", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::linear::normalize(outBatch);
+        report("VectorNBatch normalize", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            outMatrices[ii] = math::linear::inverse(matrices[ii]);
+        }
+        report("MatrixMxN inverse", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::linear::inverse(matrixBatch, outMatrixBatch);
+        report("MatrixMxNBatch inverse", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::linear::solve(matrixBatch, batch, outBatch);
+        report("MatrixMxNBatch solve", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        batch.assign(&vectors[0], size);
+        batch.copyTo(&outVectors[0]);
+        report("VectorNBatch to/from AoS", size, watch.stop());
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+/* Users guide
+
+    Compares Eigenvalue against symmetricEigen() on random symmetric
+    3x3 and 4x4 matrices, one at a time and as a batch.
+
+    usage: test_eigen_benchmark [size [threads]]
+        size: number of matrices (default 100000)
+        threads: number of threads for the batch (default 1)
+
+    Throughput is reported in millions of matrices per second.
+*/
+
+#include <stdlib.h>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <math/linear/Eigenvalue.h>
+#include <math/linear/SymmetricEigen.h>
+#include <str/Convert.h>
+
+namespace
+{
+void report(const std::string& name, size_t size, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(3) << size / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+
+template<size_t _N>
+void benchmark(size_t size, size_t numThreads)
+{
+    std::vector<math::linear::MatrixMxN<_N, _N> > matrices(size);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        for (size_t jj = 0; jj < _N; ++jj)
+        {
+            for (size_t kk = jj; kk < _N; ++kk)
+            {
+                matrices[ii](jj, kk) = matrices[ii](kk, jj) =
+                        2.0 * rand() / RAND_MAX - 1.0;
+            }
+        }
+    }
+    const std::string suffix = " " + str::toString(_N) + "x" +
+            str::toString(_N);
+
+    double checksum = 0.0;
+    sys::RealTimeStopWatch watch;
+    watch.start();
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        math::linear::Matrix2D<double> A(_N, _N);
+        for (size_t jj = 0; jj < _N; ++jj)
+        {
+            for (size_t kk = 0; kk < _N; ++kk)
+            {
+                A[jj][kk] = matrices[ii](jj, kk);
+            }
+        }
+        const math::linear::Eigenvalue<double> eig(A);
+        checksum += eig.getRealEigenvalues()[0];
+    }
+    report("Eigenvalue" + suffix, size, watch.stop());
+
+    math::linear::VectorN<_N> values;
+    math::linear::MatrixMxN<_N, _N> vectors;
+    watch.clear();
+    watch.start();
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        math::linear::symmetricEigen(matrices[ii], values, vectors);
+        checksum -= values[0];
+    }
+    report("symmetricEigen" + suffix, size, watch.stop());
+
+    const math::linear::MatrixMxNBatch<_N, _N> batch(&matrices[0], size);
+    math::linear::VectorNBatch<_N> batchValues(size);
+    math::linear::MatrixMxNBatch<_N, _N> batchVectors(size);
+    watch.clear();
+    watch.start();
+    math::linear::symmetricEigen(batch, batchValues, batchVectors,
+                                 numThreads);
+    report("symmetricEigen batch" + suffix, size, watch.stop());
+
+    // Both sums are of the smallest eigenvalues, so this is ~0
+    std::cout << std::setw(28) << "(checksum)" << std::setw(12)
+              << std::scientific << std::setprecision(1) << checksum
+              << std::endl;
+}
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const size_t size =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 100000;
+        const size_t numThreads =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 1;
+
+        std::cout << size << " matrices (million matrices/s)\n\n";
+        benchmark<3>(size, numThreads);
+        benchmark<4>(size, numThreads);
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Compares the blocked matrix multiply against the triple loop
+    Matrix2D::multiply() used before it, for square double matrices.
+
+    usage: test_gemm_benchmark [threads] [sizes...]
+        threads: threads for the parallel run (default: all CPUs)
+        sizes:   matrix dimensions (default 100 250 500 1000 2000)
+
+    Throughput is reported in GFLOP/s.  The triple loop is skipped
+    above 1000, where it takes minutes.
+*/
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/math/linear.h>
+#include <import/sys.h>
+#include <str/Convert.h>
+
+namespace
+{
+typedef math::linear::Matrix2D<double> Matrix;
+
+void fill(Matrix& mx, sys::Uint32_T state)
+{
+    for (size_t ii = 0; ii < mx.size(); ++ii)
+    {
+        state = state * 1664525 + 1013904223;
+        mx[0][ii] = static_cast<double>(state >> 8) / (1 << 23) - 1.0;
+    }
+}
+
+// The loop Matrix2D::multiply() used to run.
+void tripleLoop(const Matrix& a, const Matrix& b, Matrix& out)
+{
+    const size_t M = a.rows();
+    const size_t N = a.cols();
+    const size_t P = b.cols();
+    for (size_t i = 0; i < M; i++)
+    {
+        for (size_t j = 0; j < P; j++)
+        {
+            out(i, j) = 0;
+            for (size_t k = 0; k < N; k++)
+            {
+                out(i, j) += a(i, k) * b(k, j);
+            }
+        }
+    }
+}
+
+double gigaflops(size_t n, double millis)
+{
+    return 2.0 * n * n * n / (millis / 1000.0) / 1e9;
+}
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const size_t numThreads = (argc > 1) ? str::toType<size_t>(argv[1])
+                : sys::OS().getNumCPUs();
+        std::vector<size_t> sizes;
+        for (int ii = 2; ii < argc; ++ii)
+            sizes.push_back(str::toType<size_t>(argv[ii]));
+        if (sizes.empty())
+        {
+            const size_t defaults[] = { 100, 250, 500, 1000, 2000 };
+            sizes.assign(defaults, defaults + 5);
+        }
+
+        std::cout << "double, " << numThreads << " threads (GFLOP/s)\n\n"
+                  << std::setw(8) << "size"
+                  << std::setw(12) << "loop"
+                  << std::setw(12) << "blocked x1"
+                  << std::setw(12) << "blocked xN" << "\n";
+
+        for (size_t ii = 0; ii < sizes.size(); ++ii)
+        {
+            const size_t n = sizes[ii];
+            Matrix a(n, n);
+            Matrix b(n, n);
+            Matrix out(n, n);
+            fill(a, 1);
+            fill(b, 2);
+
+            sys::RealTimeStopWatch watch;
+            std::cout << std::setw(8) << n << std::fixed
+                      << std::setprecision(2);
+
+            if (n <= 1000)
+            {
+                watch.start();
+                tripleLoop(a, b, out);
+                std::cout << std::setw(12) << gigaflops(n, watch.stop());
+            }
+            else
+            {
+                std::cout << std::setw(12) << "-";
+            }
+
+            watch.clear();
+            watch.start();
+            a.multiplyInto(b, out);
+            std::cout << std::setw(12) << gigaflops(n, watch.stop());
+
+            watch.clear();
+            watch.start();
+            a.multiplyInto(b, out, numThreads);
+            std::cout << std::setw(12) << gigaflops(n, watch.stop())
+                      << std::endl;
+        }
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,267 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <vector>
+
+#include "TestCase.h"
+#include <math/linear/VectorNBatch.h>
+
+namespace
+{
+typedef math::linear::VectorN<3, double> Vector3;
+typedef math::linear::MatrixMxN<3, 3, double> Matrix3x3;
+typedef math::linear::MatrixMxN<2, 2, double> Matrix2x2;
+typedef math::linear::VectorNBatch<3, double> Vector3Batch;
+typedef math::linear::MatrixMxNBatch<3, 3, double> Matrix3x3Batch;
+
+// Spans several blocks, with a partial last one
+const size_t SIZE = 1000;
+
+double getRand()
+{
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+std::vector<Vector3> getRandVectors()
+{
+    std::vector<Vector3> vectors(SIZE);
+    for (size_t ii = 0; ii < SIZE; ++ii)
+    {
+        for (size_t jj = 0; jj < 3; ++jj)
+        {
+            vectors[ii][jj] = getRand();
+        }
+    }
+    return vectors;
+}
+
+template<size_t _ND>
+std::vector<math::linear::MatrixMxN<_ND, _ND, double> > getRandMatrices()
+{
+    // Diagonally dominant, so comfortably invertible
+    std::vector<math::linear::MatrixMxN<_ND, _ND, double> > matrices(SIZE);
+    for (size_t ii = 0; ii < SIZE; ++ii)
+    {
+        for (size_t jj = 0; jj < _ND; ++jj)
+        {
+            for (size_t kk = 0; kk < _ND; ++kk)
+            {
+                matrices[ii](jj, kk) = getRand() + (jj == kk ? 4.0 : 0.0);
+            }
+        }
+    }
+    return matrices;
+}
+
+template<typename Matrix_T>
+void assertMatricesEqual(const Matrix_T& lhs, const Matrix_T& rhs,
+                         size_t rows, size_t cols,
+                         const std::string& testName)
+{
+    for (size_t ii = 0; ii < rows; ++ii)
+    {
+        for (size_t jj = 0; jj < cols; ++jj)
+        {
+            TEST_ASSERT_ALMOST_EQ_EPS(lhs(ii, jj), rhs(ii, jj), 1e-12);
+        }
+    }
+}
+
+TEST_CASE(testConversions)
+{
+    const std::vector<Vector3> vectors(getRandVectors());
+    Vector3Batch batch(&vectors[0], SIZE);
+    TEST_ASSERT_EQ(batch.size(), SIZE);
+    TEST_ASSERT_EQ(batch[17][1], vectors[17][1]);
+    TEST_ASSERT_EQ(batch.component(2)[17], vectors[17][2]);
+
+    std::vector<Vector3> copied(SIZE);
+    batch.copyTo(&copied[0]);
+    std::vector<double> interleaved(3 * SIZE);
+    batch.copyToInterleaved(&interleaved[0]);
+    for (size_t ii = 0; ii < SIZE; ++ii)
+    {
+        TEST_ASSERT_EQ(copied[ii], vectors[ii]);
+        for (size_t jj = 0; jj < 3; ++jj)
+        {
+            TEST_ASSERT_EQ(interleaved[ii * 3 + jj], vectors[ii][jj]);
+        }
+    }
+
+    Vector3Batch fromInterleaved;
+    fromInterleaved.assignInterleaved(&interleaved[0], SIZE);
+    TEST_ASSERT_EQ(fromInterleaved[SIZE - 1], vectors[SIZE - 1]);
+
+    // Resizing keeps the leading vectors
+    batch.resize(10);
+    TEST_ASSERT_EQ(batch[9], vectors[9]);
+    batch.resize(20);
+    TEST_ASSERT_EQ(batch[9], vectors[9]);
+
+    const std::vector<Matrix3x3> matrices(getRandMatrices<3>());
+    const Matrix3x3Batch matrixBatch(&matrices[0], SIZE);
+    std::vector<Matrix3x3> copiedMatrices(SIZE);
+    matrixBatch.copyTo(&copiedMatrices[0]);
+    TEST_ASSERT_EQ(copiedMatrices[123], matrices[123]);
+    TEST_ASSERT_EQ(matrixBatch[123], matrices[123]);
+}
+
+TEST_CASE(testMultiply)
+{
+    const std::vector<Vector3> vectors(getRandVectors());
+    const std::vector<Matrix3x3> matrices(getRandMatrices<3>());
+    const Vector3Batch batch(&vectors[0], SIZE);
+    const Matrix3x3Batch matrixBatch(&matrices[0], SIZE);
+
+    Vector3Batch out;
+    math::linear::multiply(matrices[0], batch, out);
+    Vector3Batch perMatrix;
+    math::linear::multiply(matrixBatch, batch, perMatrix);
+
+    math::linear::MatrixMxN<2, 3, double> projection;
+    projection = matrices[1].row(0);
+    math::linear::VectorNBatch<2, double> projected;
+    math::linear::multiply(projection, batch, projected);
+
+    for (size_t ii = 0; ii < SIZE; ++ii)
+    {
+        const Vector3 expected = matrices[0] * vectors[ii];
+        const Vector3 expectedPerMatrix = matrices[ii] * vectors[ii];
+        const math::linear::VectorN<2, double> expectedProjected =
+                projection * vectors[ii];
+        for (size_t jj = 0; jj < 3; ++jj)
+        {
+            TEST_ASSERT_ALMOST_EQ_EPS(out[ii][jj], expected[jj], 1e-12);
+            TEST_ASSERT_ALMOST_EQ_EPS(perMatrix[ii][jj],
+                                      expectedPerMatrix[jj], 1e-12);
+        }
+        for (size_t jj = 0; jj < 2; ++jj)
+        {
+            TEST_ASSERT_ALMOST_EQ_EPS(projected[ii][jj],
+                                      expectedProjected[jj], 1e-12);
+        }
+    }
+
+    // In place
+    Vector3Batch inPlace(batch);
+    math::linear::multiply(matrices[0], inPlace, inPlace);
+    TEST_ASSERT_EQ(inPlace[SIZE - 1], out[SIZE - 1]);
+}
+
+TEST_CASE(testVectorKernels)
+{
+    const std::vector<Vector3> u(getRandVectors());
+    const std::vector<Vector3> v(getRandVectors());
+    const Vector3Batch uBatch(&u[0], SIZE);
+    const Vector3Batch vBatch(&v[0], SIZE);
+
+    std::vector<double> dots(SIZE);
+    math::linear::dot(uBatch, vBatch, &dots[0]);
+    std::vector<double> norms(SIZE);
+    math::linear::norm(uBatch, &norms[0]);
+    Vector3Batch crosses;
+    math::linear::cross(uBatch, vBatch, crosses);
+    Vector3Batch units(uBatch);
+    math::linear::normalize(units);
+
+    for (size_t ii = 0; ii < SIZE; ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(dots[ii], u[ii].dot(v[ii]), 1e-12);
+        TEST_ASSERT_ALMOST_EQ_EPS(norms[ii], u[ii].norm(), 1e-12);
+
+        const Vector3 expectedCross = math::linear::cross(u[ii], v[ii]);
+        const Vector3 expectedUnit = u[ii].unit();
+        for (size_t jj = 0; jj < 3; ++jj)
+        {
+            TEST_ASSERT_ALMOST_EQ_EPS(crosses[ii][jj], expectedCross[jj],
+                                      1e-12);
+            TEST_ASSERT_ALMOST_EQ_EPS(units[ii][jj], expectedUnit[jj],
+                                      1e-12);
+        }
+    }
+}
+
+TEST_CASE(testInverseAndSolve)
+{
+    const std::vector<Matrix3x3> matrices(getRandMatrices<3>());
+    const std::vector<Matrix2x2> matrices2(getRandMatrices<2>());
+    const std::vector<Vector3> rhs(getRandVectors());
+
+    const Matrix3x3Batch batch(&matrices[0], SIZE);
+    Matrix3x3Batch inverses;
+    math::linear::inverse(batch, inverses);
+
+    const math::linear::MatrixMxNBatch<2, 2, double> batch2(&matrices2[0],
+                                                            SIZE);
+    math::linear::MatrixMxNBatch<2, 2, double> inverses2;
+    math::linear::inverse(batch2, inverses2);
+
+    const Vector3Batch rhsBatch(&rhs[0], SIZE);
+    Vector3Batch solutions;
+    math::linear::solve(batch, rhsBatch, solutions);
+
+    math::linear::VectorNBatch<2, double> rhs2(SIZE);
+    std::copy(rhsBatch.component(0), rhsBatch.component(0) + SIZE,
+              rhs2.component(0));
+    std::copy(rhsBatch.component(1), rhsBatch.component(1) + SIZE,
+              rhs2.component(1));
+    math::linear::VectorNBatch<2, double> solutions2;
+    math::linear::solve(batch2, rhs2, solutions2);
+
+    for (size_t ii = 0; ii < SIZE; ++ii)
+    {
+        assertMatricesEqual(inverses[ii],
+                            math::linear::inverse(matrices[ii]), 3, 3,
+                            testName);
+        assertMatricesEqual(inverses2[ii],
+                            math::linear::inverse(matrices2[ii]), 2, 2,
+                            testName);
+
+        const Vector3 residual = matrices[ii] * solutions[ii] - rhs[ii];
+        TEST_ASSERT_LESSER_EQ(residual.norm(), 1e-12);
+
+        const math::linear::VectorN<2, double> residual2 =
+                matrices2[ii] * solutions2[ii] - rhs2[ii];
+        TEST_ASSERT_LESSER_EQ(residual2.norm(), 1e-12);
+    }
+
+    // A matrix with a zero row can't be inverted
+    Matrix3x3Batch singular(batch);
+    for (size_t jj = 0; jj < 3; ++jj)
+    {
+        singular.component(1, jj)[300] = 0.0;
+    }
+    TEST_EXCEPTION(math::linear::inverse(singular, inverses));
+    TEST_EXCEPTION(math::linear::solve(singular, rhsBatch, solutions));
+}
+}
+
+int main(int, char**)
+{
+    srand(2016);
+    TEST_CHECK(testConversions);
+    TEST_CHECK(testMultiply);
+    TEST_CHECK(testVectorKernels);
+    TEST_CHECK(testInverseAndSolve);
+    return 0;
+}
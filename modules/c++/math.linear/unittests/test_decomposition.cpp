@@ -0,0 +1,174 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TestCase.h"
+#include <math/linear/Cholesky.h>
+#include <math/linear/QR.h>
+
+namespace
+{
+typedef math::linear::Matrix2D<double> Matrix;
+typedef math::linear::Cholesky<double> Cholesky;
+typedef math::linear::QR<double> QR;
+
+Matrix makeSPD()
+{
+    Matrix A(4, 4);
+    A[0][0] = 28;  A[0][1] = 9;   A[0][2] = 4;   A[0][3] = 2;
+    A[1][0] = 9;   A[1][1] = 32;  A[1][2] = 8;   A[1][3] = 4;
+    A[2][0] = 4;   A[2][1] = 8;   A[2][2] = 77;  A[2][3] = 5;
+    A[3][0] = 2;   A[3][1] = 4;   A[3][2] = 5;   A[3][3] = 65;
+    return A;
+}
+
+// An overdetermined system whose least squares solution is (1, -2, 3)
+void makeLeastSquares(Matrix& A, Matrix& b)
+{
+    A = Matrix(6, 3);
+    b = Matrix(6, 1);
+    for (size_t i = 0; i < 6; ++i)
+    {
+        const double t = static_cast<double>(i) - 2.5;
+        A[i][0] = 1;
+        A[i][1] = t;
+        A[i][2] = t * t;
+        b[i][0] = 1 - 2 * t + 3 * t * t;
+    }
+}
+
+TEST_CASE(testCholesky)
+{
+    const Matrix A = makeSPD();
+    const Cholesky cholesky(A);
+    TEST_ASSERT_TRUE(cholesky.isSPD());
+
+    // It should be the case that L*L' == A
+    const Matrix& L = cholesky.getL();
+    const Matrix LLt = L.multiplyTranspose(L);
+    for (size_t row = 0; row < A.rows(); ++row)
+    {
+        for (size_t col = 0; col < A.cols(); ++col)
+        {
+            TEST_ASSERT_ALMOST_EQ_EPS(LLt[row][col], A[row][col], 1e-12);
+            if (col > row)
+            {
+                TEST_ASSERT_EQ(L[row][col], 0.0);
+            }
+        }
+    }
+
+    // And A*X == B
+    Matrix B(4, 2);
+    for (size_t row = 0; row < 4; ++row)
+    {
+        B[row][0] = static_cast<double>(row);
+        B[row][1] = 1;
+    }
+    const Matrix X = cholesky.solve(B);
+    const Matrix AX = A * X;
+    for (size_t row = 0; row < 4; ++row)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(AX[row][0], B[row][0], 1e-12);
+        TEST_ASSERT_ALMOST_EQ_EPS(AX[row][1], B[row][1], 1e-12);
+    }
+}
+
+TEST_CASE(testCholeskyNotSPD)
+{
+    Matrix A = makeSPD();
+    A[3][3] = -1;
+
+    Cholesky cholesky(A);
+    TEST_ASSERT_TRUE(!cholesky.isSPD());
+    Matrix B(4, 1, 1.0);
+    TEST_EXCEPTION(cholesky.solveInPlace(B));
+
+    // The decomposition can be reused.
+    cholesky.decompose(makeSPD());
+    TEST_ASSERT_TRUE(cholesky.isSPD());
+    cholesky.solveInPlace(B);
+
+    TEST_EXCEPTION(cholesky.decompose(Matrix(3, 4)));
+}
+
+TEST_CASE(testQR)
+{
+    Matrix A;
+    Matrix b;
+    makeLeastSquares(A, b);
+
+    const QR qr(A);
+    TEST_ASSERT_TRUE(qr.isFullRank());
+
+    const Matrix x = qr.solve(b);
+    TEST_ASSERT_EQ(x.rows(), static_cast<size_t>(3));
+    TEST_ASSERT_ALMOST_EQ_EPS(x[0][0], 1.0, 1e-12);
+    TEST_ASSERT_ALMOST_EQ_EPS(x[1][0], -2.0, 1e-12);
+    TEST_ASSERT_ALMOST_EQ_EPS(x[2][0], 3.0, 1e-12);
+
+    // R'*R == A'*A, as Q is orthogonal
+    const Matrix R = qr.getR();
+    const Matrix RtR = R.transposeMultiply(R);
+    const Matrix AtA = A.transposeMultiply(A);
+    for (size_t row = 0; row < 3; ++row)
+    {
+        for (size_t col = 0; col < 3; ++col)
+        {
+            TEST_ASSERT_ALMOST_EQ_EPS(RtR[row][col], AtA[row][col], 1e-10);
+        }
+    }
+
+    // Decomposing in place gives the same solution, in b's first rows.
+    QR inPlace;
+    inPlace.decomposeInPlace(A);
+    inPlace.solveInPlace(b);
+    TEST_ASSERT_ALMOST_EQ_EPS(b[0][0], 1.0, 1e-12);
+    TEST_ASSERT_ALMOST_EQ_EPS(b[1][0], -2.0, 1e-12);
+    TEST_ASSERT_ALMOST_EQ_EPS(b[2][0], 3.0, 1e-12);
+}
+
+TEST_CASE(testQRRankDeficient)
+{
+    Matrix A;
+    Matrix b;
+    makeLeastSquares(A, b);
+    for (size_t i = 0; i < A.rows(); ++i)
+    {
+        A[i][2] = 2 * A[i][1];
+    }
+
+    const QR qr(A);
+    TEST_ASSERT_TRUE(!qr.isFullRank());
+    TEST_EXCEPTION(qr.solve(b));
+
+    TEST_EXCEPTION(QR(Matrix(2, 3)));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testCholesky);
+    TEST_CHECK(testCholeskyNotSPD);
+    TEST_CHECK(testQR);
+    TEST_CHECK(testQRRankDeficient);
+    return 0;
+}
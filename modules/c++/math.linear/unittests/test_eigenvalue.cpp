@@ -21,7 +21,11 @@
  */
 
 #include "TestCase.h"
+#include <limits>
+#include <vector>
+
 #include <math/linear/Eigenvalue.h>
+#include <math/linear/SymmetricEigen.h>
 
 namespace
 {
@@ -29,6 +33,64 @@ typedef math::linear::Matrix2D<double> Matrix;
 typedef math::linear::Vector<double> Vector;
 typedef math::linear::Eigenvalue<double> Eigenvalue;
 
+// A symmetric _N x _N matrix with entries in [-10, 10)
+template<size_t _N>
+math::linear::MatrixMxN<_N, _N> randomSymmetric()
+{
+    math::linear::MatrixMxN<_N, _N> A;
+    for (size_t i = 0; i < _N; ++i)
+    {
+        for (size_t j = i; j < _N; ++j)
+        {
+            A(i, j) = A(j, i) = 20.0 * rand() / RAND_MAX - 10.0;
+        }
+    }
+    return A;
+}
+
+// Checks symmetricEigen() against Eigenvalue
+template<size_t _N>
+void checkSymmetricEigen(const std::string& testName,
+                         const math::linear::MatrixMxN<_N, _N>& A)
+{
+    math::linear::VectorN<_N> values;
+    math::linear::MatrixMxN<_N, _N> vectors;
+    math::linear::symmetricEigen(A, values, vectors);
+
+    Matrix A2D(_N, _N);
+    for (size_t i = 0; i < _N; ++i)
+    {
+        for (size_t j = 0; j < _N; ++j)
+        {
+            A2D[i][j] = A(i, j);
+        }
+    }
+    const Eigenvalue eig(A2D);
+
+    for (size_t i = 0; i < _N; ++i)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(values[i], eig.getRealEigenvalues()[i],
+                                  1e-10);
+    }
+
+    // A*V == V*D and V'*V == I
+    for (size_t i = 0; i < _N; ++i)
+    {
+        for (size_t j = 0; j < _N; ++j)
+        {
+            double av = 0.0;
+            double vtv = 0.0;
+            for (size_t k = 0; k < _N; ++k)
+            {
+                av += A(i, k) * vectors(k, j);
+                vtv += vectors(k, i) * vectors(k, j);
+            }
+            TEST_ASSERT_ALMOST_EQ_EPS(av, vectors(i, j) * values[j], 1e-10);
+            TEST_ASSERT_ALMOST_EQ_EPS(vtv, (i == j) ? 1.0 : 0.0, 1e-12);
+        }
+    }
+}
+
 TEST_CASE(testNonSymmetric)
 {
     Matrix A(4, 4);
@@ -88,11 +150,92 @@ TEST_CASE(testSymmetric)
         }
     }
 }
+
+TEST_CASE(testSymmetricEigen)
+{
+    const double A[] = { 28, 69, 44, 82,
+                         69, 32, 38, 49,
+                         44, 38, 77, 45,
+                         82, 49, 45, 65 };
+    checkSymmetricEigen(testName, math::linear::MatrixMxN<4, 4>(A));
+
+    srand(1);
+    for (size_t trial = 0; trial < 20; ++trial)
+    {
+        checkSymmetricEigen(testName, randomSymmetric<2>());
+        checkSymmetricEigen(testName, randomSymmetric<3>());
+        checkSymmetricEigen(testName, randomSymmetric<4>());
+        checkSymmetricEigen(testName, randomSymmetric<6>());
+    }
+
+    // Already diagonal, with a repeated eigenvalue
+    math::linear::MatrixMxN<3, 3> D(0.0);
+    D(0, 0) = 2.0;
+    D(1, 1) = -1.0;
+    D(2, 2) = 2.0;
+    checkSymmetricEigen(testName, D);
+
+    math::linear::MatrixMxN<3, 3> bad = randomSymmetric<3>();
+    bad(0, 1) = bad(1, 0) = std::numeric_limits<double>::quiet_NaN();
+    math::linear::VectorN<3> values;
+    math::linear::MatrixMxN<3, 3> vectors;
+    TEST_EXCEPTION(math::linear::symmetricEigen(bad, values, vectors));
+}
+
+TEST_CASE(testSymmetricEigenBatch)
+{
+    typedef math::linear::MatrixMxN<3, 3> Matrix3;
+    typedef math::linear::VectorN<3> Vector3;
+
+    srand(2);
+    std::vector<Matrix3> matrices(1000);
+    for (size_t k = 0; k < matrices.size(); ++k)
+    {
+        matrices[k] = randomSymmetric<3>();
+    }
+    const math::linear::MatrixMxNBatch<3, 3> batch(&matrices[0],
+                                                   matrices.size());
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        math::linear::VectorNBatch<3> values;
+        math::linear::MatrixMxNBatch<3, 3> vectors;
+        math::linear::symmetricEigen(batch, values, vectors, numThreads);
+        TEST_ASSERT_EQ(values.size(), matrices.size());
+        TEST_ASSERT_EQ(vectors.size(), matrices.size());
+
+        for (size_t k = 0; k < matrices.size(); ++k)
+        {
+            Vector3 expectedValues;
+            Matrix3 expectedVectors;
+            math::linear::symmetricEigen(matrices[k], expectedValues,
+                                         expectedVectors);
+            TEST_ASSERT_TRUE(values[k] == expectedValues);
+            TEST_ASSERT_TRUE(vectors[k] == expectedVectors);
+        }
+    }
+
+    // In place
+    math::linear::MatrixMxNBatch<3, 3> inPlace(batch);
+    math::linear::VectorNBatch<3> values;
+    math::linear::symmetricEigen(inPlace, values, inPlace);
+    Vector3 expectedValues;
+    Matrix3 expectedVectors;
+    math::linear::symmetricEigen(matrices[7], expectedValues,
+                                 expectedVectors);
+    TEST_ASSERT_TRUE(inPlace[7] == expectedVectors);
+
+    math::linear::MatrixMxNBatch<3, 3> bad(batch);
+    bad.component(0, 1)[600] = std::numeric_limits<double>::quiet_NaN();
+    TEST_EXCEPTION(math::linear::symmetricEigen(bad, values, inPlace, 4));
+}
 }
 
 int main(int, char**)
 {
     TEST_CHECK(testNonSymmetric);
     TEST_CHECK(testSymmetric);
+    TEST_CHECK(testSymmetricEigen);
+    TEST_CHECK(testSymmetricEigenBatch);
     return 0;
 }
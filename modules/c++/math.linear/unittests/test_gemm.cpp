@@ -0,0 +1,208 @@
+/* =========================================================================
+ * This file is part of math.linear-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.linear-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <complex>
+#include <import/math/linear.h>
+#include "TestCase.h"
+
+using namespace math::linear;
+
+namespace
+{
+// A small linear congruential generator keeps the inputs repeatable.
+double nextValue(sys::Uint32_T& state)
+{
+    state = state * 1664525 + 1013904223;
+    return static_cast<double>(state >> 8) / (1 << 23) - 1.0;
+}
+
+void fill(Matrix2D<double>& mx, sys::Uint32_T seed)
+{
+    for (size_t i = 0; i < mx.size(); ++i)
+        mx[0][i] = nextValue(seed);
+}
+
+void fill(Matrix2D<float>& mx, sys::Uint32_T seed)
+{
+    for (size_t i = 0; i < mx.size(); ++i)
+        mx[0][i] = static_cast<float>(nextValue(seed));
+}
+
+void fill(Matrix2D<std::complex<double> >& mx, sys::Uint32_T seed)
+{
+    for (size_t i = 0; i < mx.size(); ++i)
+    {
+        const double re = nextValue(seed);
+        mx[0][i] = std::complex<double>(re, nextValue(seed));
+    }
+}
+
+// The plain triple loop the blocked product replaces.
+template <typename _T>
+Matrix2D<_T> reference(const Matrix2D<_T>& a, const Matrix2D<_T>& b)
+{
+    Matrix2D<_T> c(a.rows(), b.cols(), _T(0));
+    for (size_t i = 0; i < a.rows(); ++i)
+        for (size_t j = 0; j < b.cols(); ++j)
+            for (size_t k = 0; k < a.cols(); ++k)
+                c(i, j) += a(i, k) * b(k, j);
+    return c;
+}
+
+template <typename _T>
+double maxDifference(const Matrix2D<_T>& a, const Matrix2D<_T>& b)
+{
+    double diff = 0;
+    for (size_t i = 0; i < a.rows(); ++i)
+        for (size_t j = 0; j < a.cols(); ++j)
+            diff = std::max<double>(diff, std::abs(a(i, j) - b(i, j)));
+    return diff;
+}
+
+// Sizes that straddle the small-product cutoff and every block size,
+// with ragged edges.
+const size_t SIZES[][3] =
+{
+    { 1, 1, 1 },
+    { 3, 5, 7 },
+    { 33, 31, 35 },
+    { 67, 13, 301 },
+    { 130, 1030, 9 },
+    { 65, 257, 260 }
+};
+
+template <typename _T>
+void checkSizes(const std::string& testName, double tolerance)
+{
+    for (size_t ii = 0; ii < sizeof(SIZES) / sizeof(SIZES[0]); ++ii)
+    {
+        Matrix2D<_T> a(SIZES[ii][0], SIZES[ii][2]);
+        Matrix2D<_T> b(SIZES[ii][2], SIZES[ii][1]);
+        fill(a, 1 + ii);
+        fill(b, 100 + ii);
+
+        const Matrix2D<_T> expected = reference(a, b);
+        TEST_ASSERT_LESSER_EQ(maxDifference(a * b, expected),
+                              tolerance * SIZES[ii][2]);
+
+        // Threads split the rows, so the sums are the same.
+        Matrix2D<_T> threaded(a.rows(), b.cols());
+        a.multiplyInto(b, threaded, 3);
+        TEST_ASSERT_EQ(maxDifference(threaded, a * b), 0.0);
+    }
+}
+
+TEST_CASE(testMultiplyDouble)
+{
+    checkSizes<double>(testName, 1e-15);
+}
+
+TEST_CASE(testMultiplyFloat)
+{
+    checkSizes<float>(testName, 1e-6);
+}
+
+TEST_CASE(testMultiplyComplex)
+{
+    checkSizes<std::complex<double> >(testName, 1e-15);
+}
+
+TEST_CASE(testTransposeMultiply)
+{
+    Matrix2D<double> a(300, 70);
+    Matrix2D<double> b(300, 45);
+    fill(a, 7);
+    fill(b, 8);
+
+    const Matrix2D<double> expected = reference(a.transpose(), b);
+    TEST_ASSERT_LESSER_EQ(maxDifference(a.transposeMultiply(b), expected),
+                          1e-12);
+
+    Matrix2D<double> out(45, 70);
+    b.transposeMultiplyInto(a, out, 2);
+    TEST_ASSERT_LESSER_EQ(maxDifference(out, expected.transpose()), 1e-12);
+
+    Matrix2D<double> c(70, 45);
+    fill(c, 9);
+    const Matrix2D<double> expectedT = reference(c, b.transpose());
+    TEST_ASSERT_LESSER_EQ(maxDifference(c.multiplyTranspose(b), expectedT),
+                          1e-12);
+}
+
+TEST_CASE(testAddScaledInto)
+{
+    Matrix2D<double> a(90, 80);
+    Matrix2D<double> b(80, 70);
+    Matrix2D<double> c(90, 70);
+    fill(a, 11);
+    fill(b, 12);
+    fill(c, 13);
+
+    const Matrix2D<double> expected = c - reference(a, b) * 2.0;
+    a.addScaledInto(b, -2.0, c);
+    TEST_ASSERT_LESSER_EQ(maxDifference(c, expected), 1e-12);
+}
+
+TEST_CASE(testMultiplyAliased)
+{
+    Matrix2D<double> a(40, 40);
+    Matrix2D<double> b(40, 40);
+    fill(a, 14);
+    fill(b, 15);
+    const Matrix2D<double> expected = reference(a, b);
+
+    // Unlike multiplyInto(), multiply() may write over its inputs
+    Matrix2D<double> c(a);
+    c.multiply(b, c);
+    TEST_ASSERT_LESSER_EQ(maxDifference(c, expected), 1e-12);
+
+    Matrix2D<double> d(b);
+    a.multiply(d, d);
+    TEST_ASSERT_LESSER_EQ(maxDifference(d, expected), 1e-12);
+
+    Matrix2D<double> e(40, 30);
+    TEST_EXCEPTION(e.multiply(e, e));
+}
+
+TEST_CASE(testMultiplyErrors)
+{
+    Matrix2D<double> a(4, 4, 1.0);
+    Matrix2D<double> b(3, 4, 1.0);
+    Matrix2D<double> out(4, 4);
+
+    TEST_EXCEPTION(a.multiplyInto(b, out));
+    TEST_EXCEPTION(b.multiplyInto(a, out));
+    TEST_EXCEPTION(a.multiplyInto(a, a));
+    TEST_EXCEPTION(a.addScaledInto(out, 1.0, out));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testMultiplyDouble);
+    TEST_CHECK(testMultiplyFloat);
+    TEST_CHECK(testMultiplyComplex);
+    TEST_CHECK(testTransposeMultiply);
+    TEST_CHECK(testAddScaledInto);
+    TEST_CHECK(testMultiplyAliased);
+    TEST_CHECK(testMultiplyErrors);
+    return 0;
+}
@@ -27,6 +27,7 @@
 #include "math/poly/TwoD.h"
 #include "math/poly/Fixed1D.h"
 #include "math/poly/Fixed2D.h"
+#include "math/poly/FixedKernel.h"
 #include "math/poly/Fit.h"
 
 #endif  // __MATH_POLY_H__
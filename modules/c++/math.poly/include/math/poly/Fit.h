@@ -3,58 +3,99 @@
 
 #include <math/poly/OneD.h>
 #include <math/poly/TwoD.h>
+#include <math/linear/Cholesky.h>
 #include <math/linear/Matrix2D.h>
+#include <math/linear/QR.h>
 #include <math/linear/VectorN.h>
 #include <sys/Conf.h>
 #include <except/Exception.h>
 
+#include <algorithm>
 #include <numeric>
 #include <sstream>
+#include <vector>
 
 namespace math
 {
 namespace poly
 {
 
+namespace detail
+{
 /*!
- *  Templated function to perform a linear least squares fit for the data.
- *  This algorithm is fairly straightforward.
- *
- *  To fit an order N polynomial, we need to solve
- *  Ax=b, for x.
+ *  Solves the least squares problem min |A*X - B| for X.
  *
- *  A is a system of polynomials, e.g.
+ *  The normal equations, A' * A * X = A' * B, are solved first by
+ *  Cholesky decomposition, which is fast for many observations.
+ *  When A' * A is not positive definite, or its Cholesky factor shows
+ *  A to be poorly conditioned, the normal equations would lose too
+ *  much precision, so A is decomposed by QR instead.
  *
- *  f(x) = c0 + c1*x + c2*x^2 + c3*x^3 = y
- *  
- *  Each observed point in the data sets is computed
- *  for our A matrix.
- *
- *  e.g.: f(1) = 3, f(-1) = 13, f(2) 1, f(-2) = 33
- *
- *  | 1  1  1  1 || c0 |   |  3 |
- *  | 1 -1  1 -1 || c1 | = | 13 |
- *  | 1  2  4  8 || c2 |   |  1 |
- *  | 1 -2  4 -8 || c3 |   | 33 |
- *
- *  
- *  Linear least squares solution for system where
- *  ker(A) = {0} (IOW, there are free variables)
- *
- *  x = inv(A' * A) * A' * b
+ *  \param A The system matrix, one row per observation.  A may be
+ *  overwritten.
+ *  \param B The observations, one column per right hand side
+ *  \throw Exception if A is rank deficient
+ *  \return X, with a row per column of A
+ */
+inline math::linear::Matrix2D<double>
+solveLeastSquares(math::linear::Matrix2D<double>& A,
+                  const math::linear::Matrix2D<double>& B)
+{
+    // Past this ratio between the largest and smallest diagonal of
+    // the Cholesky factor, the condition number of A' * A is at
+    // least 1e8, and the normal equations lose about half of the
+    // available digits.
+    const double MAX_CHOLESKY_RATIO = 1e4;
+
+    const size_t n = A.cols();
+    math::linear::Matrix2D<double> AtA(n, n);
+    A.transposeMultiplyInto(A, AtA);
+
+    const math::linear::Cholesky<double> cholesky(AtA);
+    if (cholesky.isSPD())
+    {
+        const math::linear::Matrix2D<double>& L = cholesky.getL();
+        double minDiag = L(0, 0);
+        double maxDiag = L(0, 0);
+        for (size_t i = 1; i < n; ++i)
+        {
+            minDiag = std::min(minDiag, L(i, i));
+            maxDiag = std::max(maxDiag, L(i, i));
+        }
+
+        if (maxDiag <= minDiag * MAX_CHOLESKY_RATIO)
+        {
+            math::linear::Matrix2D<double> X(n, B.cols());
+            A.transposeMultiplyInto(B, X);
+            cholesky.solveInPlace(X);
+            return X;
+        }
+    }
+
+    math::linear::QR<double> qr;
+    qr.decomposeInPlace(A);
+    if (!qr.isFullRank())
+    {
+        throw except::Exception(Ctxt("Non-invertible matrix!"));
+    }
+    return qr.solve(B);
+}
+
+/*!
+ *  Fits one order N polynomial per column of y to the observed x
+ *  values.  The fits share one system matrix, so it is only built and
+ *  decomposed once.
  *
- *  \param x The observable x points
- *  \param y The observable y solutions
- *  \param order The desired order of the polynomial fit
- *  \return A one dimensional polynomial that fits the curve
+ *  \param vx The observable x points
+ *  \param y The observable y solutions, one column per fit
+ *  \param order The desired order of the polynomial fits
+ *  \param[out] polys The fitted polynomials, one per column of y
  */
- 
-template<typename Vector_T> OneD<double> fit(const Vector_T& x,
-                                             const Vector_T& y,
-                                             size_t order)
+inline void fit(const math::linear::Vector<double>& vx,
+                const math::linear::Matrix2D<double>& y,
+                size_t order,
+                std::vector<OneD<double> >& polys)
 {
-    math::linear::Vector<double> vx(x);
-    math::linear::Vector<double> vy(y);
     // n is polynomial order
     size_t sizeX = vx.size();
 
@@ -67,7 +108,7 @@ template<typename Vector_T> OneD<double> fit(const Vector_T& x,
               << (order+1) << " points for this to do what you expect.";
         throw except::Exception(Ctxt(excSS.str()));
     }
-    
+
     // Compute mean value
     double mean = std::accumulate(vx.get(), vx.get() + sizeX, 0.0) / sizeX;
 
@@ -84,37 +125,87 @@ template<typename Vector_T> OneD<double> fit(const Vector_T& x,
     for (size_t i = 0; i < sizeX; i++)
     {
         // The c0 coefficient is a freebie
-        A(i, 0) = 1;
-        double v = xp[i];
-        A(i, 1) = v;
-        for (size_t j = 2; j <= order; j++)
+        double* const row = A[i];
+        const double v = xp[i];
+        double xacc = 1;
+        for (size_t j = 0; j <= order; j++)
         {
-            A(i, j) = std::pow(v, (double)j);
+            row[j] = xacc;
+            xacc *= v;
         }
     }
-    
-    math::linear::Matrix2D<double> At = A.transpose();
-    math::linear::Matrix2D<double> inv = inverse(At * A);
-    math::linear::Matrix2D<double> B = inv * At;
-    math::linear::Vector<double> c(B * vy.matrix());
 
-    // Now we need the order+1 components out for our poly
-    math::poly::OneD<double> poly(c.size());
-
-    // Remove the normalization scaling
-    double xacc = 1;
-    for (size_t i = 0; i < c.size(); i++)
-    {
-        poly[i] = c[i] * xacc;
-        xacc *= rxrms;
-    }
+    const math::linear::Matrix2D<double> c = solveLeastSquares(A, y);
 
-    // Shift the polynomial back from its centered offset
+    // Shift the polynomials back from their centered offset
     math::poly::OneD<double> shift(1);
     shift[0] = -mean;
     shift[1] = 1;
 
-    return poly.transformInput(shift);
+    polys.resize(y.cols());
+    for (size_t p = 0; p < y.cols(); ++p)
+    {
+        // Now we need the order+1 components out for our poly
+        math::poly::OneD<double> poly(order);
+
+        // Remove the normalization scaling
+        double xacc = 1;
+        for (size_t i = 0; i <= order; i++)
+        {
+            poly[i] = c(i, p) * xacc;
+            xacc *= rxrms;
+        }
+        polys[p] = poly.transformInput(shift);
+    }
+}
+}
+
+/*!
+ *  Templated function to perform a linear least squares fit for the data.
+ *  This algorithm is fairly straightforward.
+ *
+ *  To fit an order N polynomial, we need to solve
+ *  Ax=b, for x.
+ *
+ *  A is a system of polynomials, e.g.
+ *
+ *  f(x) = c0 + c1*x + c2*x^2 + c3*x^3 = y
+ *  
+ *  Each observed point in the data sets is computed
+ *  for our A matrix.
+ *
+ *  e.g.: f(1) = 3, f(-1) = 13, f(2) 1, f(-2) = 33
+ *
+ *  | 1  1  1  1 || c0 |   |  3 |
+ *  | 1 -1  1 -1 || c1 | = | 13 |
+ *  | 1  2  4  8 || c2 |   |  1 |
+ *  | 1 -2  4 -8 || c3 |   | 33 |
+ *
+ *  
+ *  Linear least squares solution for system where
+ *  ker(A) = {0} (IOW, there are free variables)
+ *
+ *  x = inv(A' * A) * A' * b
+ *
+ *  which is solved without forming the inverse (see
+ *  detail::solveLeastSquares()).
+ *
+ *  \param x The observable x points
+ *  \param y The observable y solutions
+ *  \param order The desired order of the polynomial fit
+ *  \return A one dimensional polynomial that fits the curve
+ */
+ 
+template<typename Vector_T> OneD<double> fit(const Vector_T& x,
+                                             const Vector_T& y,
+                                             size_t order)
+{
+    math::linear::Vector<double> vx(x);
+    math::linear::Vector<double> vy(y);
+
+    std::vector<OneD<double> > polys;
+    detail::fit(vx, vy.matrix(), order, polys);
+    return polys[0];
 }
 
 
@@ -242,19 +333,9 @@ inline math::poly::TwoD<double> fit(const math::linear::Matrix2D<double>& x,
         }
     }
     
-    math::linear::Matrix2D<double> At = A.transpose();
-
-    //       T
-    // size(A  A) = (P x R) (R x P) = (P x P)
-    // size(inv) = (P x P)
-    math::linear::Matrix2D<double> inv = math::linear::inverse<double>(At * A);
-
-    // size(C) = ((P x P) (P x R))(R x 1)
-    //         =   (P x R)(R x 1)
-    //         =   (P x 1)
-    //         =   (NX+1xNY+1 x 1)
-
-    math::linear::Matrix2D<double> C = inv * At * tmp;
+    // size(C) = (P x 1)
+    //         = (NX+1xNY+1 x 1)
+    math::linear::Matrix2D<double> C = detail::solveLeastSquares(A, tmp);
 
     // Now we need the NX+1 components out for our x coeffs
     // and NY+1 components out for our y coeffs
@@ -327,9 +408,20 @@ inline math::poly::OneD< math::linear::VectorN< 3, double > > fit(
         throw except::Exception(Ctxt("Must have the same number of observed y values as observed x values"));
     }
 
-    const math::poly::OneD<double> fit0 = fit(xObs, yObs0, order);
-    const math::poly::OneD<double> fit1 = fit(xObs, yObs1, order);
-    const math::poly::OneD<double> fit2 = fit(xObs, yObs2, order);
+    // The three fits share their x values, so they are solved together.
+    math::linear::Matrix2D<double> yObs(numObs, 3);
+    for (size_t ii = 0; ii < numObs; ++ii)
+    {
+        yObs(ii, 0) = yObs0[ii];
+        yObs(ii, 1) = yObs1[ii];
+        yObs(ii, 2) = yObs2[ii];
+    }
+
+    std::vector<OneD<double> > fits;
+    detail::fit(xObs, yObs, order, fits);
+    const math::poly::OneD<double>& fit0 = fits[0];
+    const math::poly::OneD<double>& fit1 = fits[1];
+    const math::poly::OneD<double>& fit2 = fits[2];
 
     // There is a non-zero chance that one or more of the resulting polynomials
     // are of a lower order than the requested order -- this results when the
@@ -25,6 +25,7 @@
 
 #include <import/except.h>
 #include <import/sys.h>
+#include <math/poly/Kernels.h>
 #include <math/poly/OneD.h>
 #include <math/poly/Utils.h>
 
@@ -50,6 +51,8 @@ namespace poly
  */
 template <size_t _Order, typename _T=double> class Fixed1D
 {
+    template <size_t _OtherOrder, typename _OtherT> friend class Fixed1D;
+
 protected:
     _T mCoef[_Order+1];
 public:
@@ -73,6 +76,7 @@ public:
      */
     Fixed1D(const OneD<_T>& coeff)
     {
+        std::fill(mCoef, mCoef + _Order + 1, _T(0));
         size_t sizeC = coeff.order();
         sizeC = std::min<size_t>(sizeC, _Order);
         for (size_t i = 0; i <= sizeC; i++)
@@ -92,6 +96,7 @@ public:
      */
     template<size_t _OtherOrder> Fixed1D(const Fixed1D<_OtherOrder, _T>& coeff)
     {
+        std::fill(mCoef, mCoef + _Order + 1, _T(0));
 
         size_t sizeC = std::min<size_t>(_OtherOrder, _Order);
         for (size_t i = 0; i <= sizeC; i++)
@@ -133,20 +138,23 @@ public:
 
 
     /*!
-     *  Evaluate our polynomial at 'at'
+     *  Evaluate our polynomial at 'at'.  Since the order is known at
+     *  compile time, Horner's rule unrolls into straight-line code.
      *
      */
     _T operator() (double at) const
     {
-        double rv(0);
-        double atPower = 1;
+        return detail::FixedHorner<0, _Order, _T>::evaluate(mCoef, at);
+    }
 
-        for (size_t i = 0; i <= _Order; i++)
-        {
-            rv += mCoef[i]*atPower;
-            atPower *= at;
-        }
-        return rv;
+    /*!
+     *  Evaluate our polynomial at each of the n points in x, writing
+     *  the results to out
+     *
+     */
+    void evaluate(const double* x, size_t n, _T* out) const
+    {
+        detail::evaluateFixedBatch<_Order, _T>(mCoef, _Order, x, n, out);
     }
 
     /*!
@@ -155,23 +163,9 @@ public:
      */
     _T integrate(double start, double end) const
     {
-        _T rv(0);
-        double div;
-        double newCoef;
-        double endAtPower = end;
-        double startAtPower = start;
-
-        for (size_t i = 0; i <= _Order; i++)
-        {
-            div = 1.0/(i + 1);
-            newCoef = mCoef[i] * div;
-            rv += newCoef * endAtPower;
-            rv -= newCoef * startAtPower;
-            endAtPower *= end;
-            startAtPower *= start;
-
-        }
-        return rv;
+        typedef detail::FixedHorner<0, _Order, _T> Horner;
+        return Horner::antiderivative(mCoef, end) * end -
+                Horner::antiderivative(mCoef, start) * start;
     }
 
     /*!
@@ -181,13 +175,7 @@ public:
     Fixed1D<_Order-1, _T> derivative() const
     {
         Fixed1D<_Order-1, _T> dv;
-        if (_Order)
-        {
-            for (size_t i = 0; i <= _Order-1; i++)
-            {
-                dv[i] = mCoef[i+1] * (i+1);
-            }
-        }
+        detail::FixedDerivative<1, _Order, _T>::apply(mCoef, dv.mCoef);
         return dv;
     }
     /*!
@@ -94,37 +94,44 @@ public:
     size_t orderX() const { return _OrderX; }
     size_t orderY() const { return _OrderY; }
 
+    /*!
+     *  Evaluate the polynomial at (atX, atY), by Horner's rule in x over
+     *  the value of each row at atY.  Both orders are known at compile
+     *  time, so this unrolls into straight-line code.
+     */
     inline _T operator()(double atX, double atY) const
     {
-        _T rv(0);
-        double atXPower(1);
-
+        _T atYValues[_OrderX + 1];
         for (size_t i = 0; i <= _OrderX; i++)
         {
-            rv += mCoef[i](atY)*atXPower;
-            atXPower *= atX;
+            atYValues[i] = mCoef[i](atY);
+        }
+        return detail::FixedHorner<0, _OrderX, _T>::evaluate(atYValues, atX);
+    }
 
+    /*!
+     *  Evaluate the polynomial at each of the n points (x[i], y[i]),
+     *  writing the results to out
+     */
+    void evaluate(const double* x, const double* y, size_t n, _T* out) const
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            out[j] = (*this)(x[j], y[j]);
         }
-        return rv;
     }
+
     _T integrate(double startX, double endX, double startY, double endY) const
     {
-        _T rv(0);
-        double div(0);
-        double endAtPower = endX;
-        double startAtPower = startX;
-        double newCoef;
+        _T rowIntegrals[_OrderX + 1];
         for (size_t i = 0; i <= _OrderX; i++)
         {
-            div = 1.0/(i+1);
-            newCoef = mCoef[i].integrate(startY, endY) * div;
-            rv += newCoef * endAtPower;
-            rv -= newCoef * startAtPower;
-            endAtPower *= endX;
-            startAtPower *= startX;
-
+            rowIntegrals[i] = mCoef[i].integrate(startY, endY);
         }
-        return rv;
+
+        typedef detail::FixedHorner<0, _OrderX, _T> Horner;
+        return Horner::antiderivative(rowIntegrals, endX) * endX -
+                Horner::antiderivative(rowIntegrals, startX) * startX;
     }
 
     Fixed2D<_OrderX, _OrderY, _T> flipXY() const
@@ -0,0 +1,202 @@
+/* =========================================================================
+ * This file is part of math.poly-c++ 
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.poly-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_POLY_FIXED_KERNEL_H__
+#define __MATH_POLY_FIXED_KERNEL_H__
+
+#include <vector>
+
+#include <math/poly/Kernels.h>
+#include <math/poly/OneD.h>
+#include <math/poly/TwoD.h>
+
+namespace math
+{
+namespace poly
+{
+
+/*!
+ *  \class FixedKernel1D
+ *  \brief A OneD bound to the unrolled evaluation kernel for its order
+ *
+ *  The order of a OneD is only known at runtime, so each evaluation
+ *  must either loop over the coefficients or choose an unrolled kernel.
+ *  This class makes that choice once, on construction, and keeps its
+ *  own copy of the coefficients.  Orders up to
+ *  detail::MAX_FIXED_ORDER get straight-line code, as if the
+ *  polynomial were a Fixed1D; higher orders fall back to loops.
+ *
+ *  \code
+ *  const FixedKernel1D<> kernel(poly);
+ *  for (size_t ii = 0; ii < n; ++ii)
+ *  {
+ *      values[ii] = kernel(times[ii]);
+ *  }
+ *  \endcode
+ */
+template<typename _T=double> class FixedKernel1D
+{
+public:
+    explicit FixedKernel1D(const OneD<_T>& poly) :
+        mCoef(poly.coeffs())
+    {
+        if (mCoef.empty())
+        {
+            mCoef.resize(1, _T(0.0));
+        }
+        mOrder = mCoef.size() - 1;
+        mEvaluate =
+            detail::SelectHorner<detail::MAX_FIXED_ORDER, _T>::evaluate(
+                    mOrder);
+        mEvaluateBatch =
+            detail::SelectHorner<detail::MAX_FIXED_ORDER, _T>::evaluateBatch(
+                    mOrder);
+    }
+
+    size_t order() const
+    {
+        return mOrder;
+    }
+
+    //! \return True if evaluation uses an unrolled kernel
+    bool isUnrolled() const
+    {
+        return mOrder <= detail::MAX_FIXED_ORDER;
+    }
+
+    _T operator()(double at) const
+    {
+        return mEvaluate(&mCoef[0], mOrder, at);
+    }
+
+    /*!
+     *  Evaluate the polynomial at each of the n points in x
+     *
+     *  \param x The points to evaluate at
+     *  \param n The number of points
+     *  \param out Output buffer of at least n values
+     */
+    void evaluate(const double* x, size_t n, _T* out) const
+    {
+        mEvaluateBatch(&mCoef[0], mOrder, x, n, out);
+    }
+
+private:
+    std::vector<_T> mCoef;
+    size_t mOrder;
+    typename detail::HornerFunctions<_T>::Evaluate mEvaluate;
+    typename detail::HornerFunctions<_T>::EvaluateBatch mEvaluateBatch;
+};
+
+/*!
+ *  \class FixedKernel2D
+ *  \brief A TwoD bound to the unrolled evaluation kernel for its orders
+ *
+ *  The two dimensional counterpart of FixedKernel1D.  The coefficients
+ *  are copied into one dense array, with rows shorter than the longest
+ *  padded with zeros, and the kernel is chosen from both orders.
+ */
+template<typename _T=double> class FixedKernel2D
+{
+public:
+    explicit FixedKernel2D(const TwoD<_T>& poly) :
+        mOrderX(0),
+        mOrderY(0)
+    {
+        std::vector<OneD<_T> > rows;
+        if (!poly.empty())
+        {
+            mOrderX = poly.orderX();
+            rows.reserve(mOrderX + 1);
+            for (size_t i = 0; i <= mOrderX; ++i)
+            {
+                rows.push_back(poly[i]);
+                if (!rows[i].empty())
+                {
+                    mOrderY = std::max(mOrderY, rows[i].order());
+                }
+            }
+        }
+
+        const size_t stride = mOrderY + 1;
+        mCoef.resize((mOrderX + 1) * stride, _T(0.0));
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+            const std::vector<_T>& row = rows[i].coeffs();
+            std::copy(row.begin(), row.end(), mCoef.begin() + i * stride);
+        }
+
+        mEvaluate = detail::SelectHorner2D<detail::MAX_FIXED_ORDER,
+                                           detail::MAX_FIXED_ORDER,
+                                           _T>::evaluate(mOrderX, mOrderY);
+        mEvaluateBatch = detail::SelectHorner2D<detail::MAX_FIXED_ORDER,
+                                                detail::MAX_FIXED_ORDER,
+                                                _T>::evaluateBatch(mOrderX,
+                                                                   mOrderY);
+    }
+
+    size_t orderX() const
+    {
+        return mOrderX;
+    }
+
+    size_t orderY() const
+    {
+        return mOrderY;
+    }
+
+    //! \return True if evaluation uses an unrolled kernel
+    bool isUnrolled() const
+    {
+        return mOrderX <= detail::MAX_FIXED_ORDER &&
+                mOrderY <= detail::MAX_FIXED_ORDER;
+    }
+
+    _T operator()(double atX, double atY) const
+    {
+        return mEvaluate(&mCoef[0], mOrderX, mOrderY, atX, atY);
+    }
+
+    /*!
+     *  Evaluate the polynomial at each of the n points (x[i], y[i])
+     *
+     *  \param x The x coordinates to evaluate at
+     *  \param y The y coordinates to evaluate at
+     *  \param n The number of points
+     *  \param out Output buffer of at least n values
+     */
+    void evaluate(const double* x, const double* y, size_t n, _T* out) const
+    {
+        mEvaluateBatch(&mCoef[0], mOrderX, mOrderY, x, y, n, out);
+    }
+
+private:
+    size_t mOrderX;
+    size_t mOrderY;
+    std::vector<_T> mCoef;
+    typename detail::HornerFunctions<_T>::Evaluate2D mEvaluate;
+    typename detail::HornerFunctions<_T>::EvaluateBatch2D mEvaluateBatch;
+};
+}
+}
+
+#endif
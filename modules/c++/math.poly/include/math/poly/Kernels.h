@@ -0,0 +1,448 @@
+/* =========================================================================
+ * This file is part of math.poly-c++ 
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.poly-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_POLY_KERNELS_H__
+#define __MATH_POLY_KERNELS_H__
+
+#include <algorithm>
+#include <cstddef>
+
+namespace math
+{
+namespace poly
+{
+namespace detail
+{
+/*!
+ *  The highest order, in each dimension, for which an unrolled kernel
+ *  is instantiated.  Polynomials of higher order fall back to loops.
+ */
+const size_t MAX_FIXED_ORDER = 8;
+
+/*!
+ *  Points are evaluated this many at a time by the loop-based kernels,
+ *  so that the partial results stay in cache between Horner steps.
+ */
+const size_t EVALUATE_BLOCK = 256;
+
+/*!
+ *  Horner's rule for the terms _I through _Order of a polynomial whose
+ *  order is known at compile time.  The recursion unrolls into
+ *  straight-line multiply-adds.
+ */
+template<size_t _I, size_t _Order, typename _T>
+struct FixedHorner
+{
+    //! Returns sum(coef[i] * at^(i - _I)) for i in [_I, _Order]
+    static _T evaluate(const _T* coef, double at)
+    {
+        return FixedHorner<_I + 1, _Order, _T>::evaluate(coef, at) * at +
+                coef[_I];
+    }
+
+    //! Returns sum(coef[i] / (i + 1) * at^(i - _I)) for i in [_I, _Order]
+    static _T antiderivative(const _T* coef, double at)
+    {
+        return FixedHorner<_I + 1, _Order, _T>::antiderivative(coef, at) * at +
+                coef[_I] * (1.0 / (_I + 1));
+    }
+};
+
+template<size_t _Order, typename _T>
+struct FixedHorner<_Order, _Order, _T>
+{
+    static _T evaluate(const _T* coef, double )
+    {
+        return coef[_Order];
+    }
+
+    static _T antiderivative(const _T* coef, double )
+    {
+        return coef[_Order] * (1.0 / (_Order + 1));
+    }
+};
+
+/*!
+ *  Sums coef[i] * at^i in ascending order of i for a polynomial whose
+ *  order is known at compile time.  The operations are those of the
+ *  loop in OneD::operator(), so the unrolled form gives the same
+ *  result to the bit.
+ */
+template<size_t _I, size_t _Order, typename _T>
+struct FixedPowers
+{
+    static void accumulate(const _T* coef, double at, double atPower, _T& ret)
+    {
+        ret += coef[_I] * atPower;
+        FixedPowers<_I + 1, _Order, _T>::accumulate(coef, at, atPower * at,
+                                                    ret);
+    }
+};
+
+template<size_t _Order, typename _T>
+struct FixedPowers<_Order, _Order, _T>
+{
+    static void accumulate(const _T* coef, double , double atPower, _T& ret)
+    {
+        ret += coef[_Order] * atPower;
+    }
+};
+
+/*!
+ *  Writes the coefficients of the derivative of a fixed order
+ *  polynomial, starting from term _I, into derivative.
+ */
+template<size_t _I, size_t _Order, typename _T, bool _Done = (_I > _Order)>
+struct FixedDerivative
+{
+    static void apply(const _T* coef, _T* derivative)
+    {
+        derivative[_I - 1] = coef[_I] * static_cast<double>(_I);
+        FixedDerivative<_I + 1, _Order, _T>::apply(coef, derivative);
+    }
+};
+
+template<size_t _I, size_t _Order, typename _T>
+struct FixedDerivative<_I, _Order, _T, true>
+{
+    static void apply(const _T* , _T* )
+    {
+    }
+};
+
+/*!
+ *  Horner's rule in x over the rows of a dense, row-major
+ *  (_OrderX + 1) x (_OrderY + 1) coefficient array, where
+ *  coef[i * (_OrderY + 1) + j] multiplies x^i * y^j.
+ */
+template<size_t _I, size_t _OrderX, size_t _OrderY, typename _T>
+struct FixedHorner2D
+{
+    static _T evaluate(const _T* coef, double atX, double atY)
+    {
+        return FixedHorner2D<_I + 1, _OrderX, _OrderY, _T>::evaluate(
+                        coef, atX, atY) * atX +
+                FixedHorner<0, _OrderY, _T>::evaluate(
+                        coef + _I * (_OrderY + 1), atY);
+    }
+};
+
+template<size_t _OrderX, size_t _OrderY, typename _T>
+struct FixedHorner2D<_OrderX, _OrderX, _OrderY, _T>
+{
+    static _T evaluate(const _T* coef, double , double atY)
+    {
+        return FixedHorner<0, _OrderY, _T>::evaluate(
+                coef + _OrderX * (_OrderY + 1), atY);
+    }
+};
+
+/*!
+ *  Signatures shared by the fixed order kernels and their runtime
+ *  order fallbacks, so that a kernel can be chosen once and called
+ *  through a pointer.  The fixed order kernels ignore the order
+ *  arguments.
+ */
+template<typename _T>
+struct HornerFunctions
+{
+    typedef _T (*Evaluate)(const _T* coef, size_t order, double at);
+
+    typedef void (*EvaluateBatch)(const _T* coef, size_t order,
+                                  const double* x, size_t n, _T* out);
+
+    typedef _T (*Evaluate2D)(const _T* coef, size_t orderX, size_t orderY,
+                             double atX, double atY);
+
+    typedef void (*EvaluateBatch2D)(const _T* coef,
+                                    size_t orderX, size_t orderY,
+                                    const double* x, const double* y,
+                                    size_t n, _T* out);
+};
+
+//! Horner's rule for a polynomial of any order
+template<typename _T>
+_T evaluateHorner(const _T* coef, size_t order, double at)
+{
+    _T ret(coef[order]);
+    for (size_t i = order; i-- > 0; )
+    {
+        ret = ret * at + coef[i];
+    }
+    return ret;
+}
+
+/*!
+ *  Horner's rule for a polynomial of any order over many points.  The
+ *  points are taken a block at a time, and each Horner step is applied
+ *  across the whole block, so that the inner loop vectorizes.
+ */
+template<typename _T>
+void evaluateHornerBatch(const _T* coef, size_t order,
+                         const double* x, size_t n, _T* out)
+{
+    for (size_t start = 0; start < n; start += EVALUATE_BLOCK)
+    {
+        const size_t end = std::min(n, start + EVALUATE_BLOCK);
+        std::fill(out + start, out + end, coef[order]);
+        for (size_t i = order; i-- > 0; )
+        {
+            const _T c = coef[i];
+            for (size_t j = start; j < end; ++j)
+            {
+                out[j] = out[j] * x[j] + c;
+            }
+        }
+    }
+}
+
+//! Horner's rule in both dimensions for a dense polynomial of any order
+template<typename _T>
+_T evaluateHorner2D(const _T* coef, size_t orderX, size_t orderY,
+                    double atX, double atY)
+{
+    const size_t stride = orderY + 1;
+    _T ret(evaluateHorner(coef + orderX * stride, orderY, atY));
+    for (size_t i = orderX; i-- > 0; )
+    {
+        ret = ret * atX + evaluateHorner(coef + i * stride, orderY, atY);
+    }
+    return ret;
+}
+
+template<typename _T>
+void evaluateHornerBatch2D(const _T* coef, size_t orderX, size_t orderY,
+                           const double* x, const double* y,
+                           size_t n, _T* out)
+{
+    for (size_t j = 0; j < n; ++j)
+    {
+        out[j] = evaluateHorner2D(coef, orderX, orderY, x[j], y[j]);
+    }
+}
+
+template<size_t _Order, typename _T>
+_T evaluateFixed(const _T* coef, size_t , double at)
+{
+    return FixedHorner<0, _Order, _T>::evaluate(coef, at);
+}
+
+template<size_t _Order, typename _T>
+void evaluateFixedBatch(const _T* coef, size_t ,
+                        const double* x, size_t n, _T* out)
+{
+    // A local copy can't alias the output, so the coefficients stay in
+    // registers across the loop
+    _T local[_Order + 1];
+    std::copy(coef, coef + _Order + 1, local);
+    for (size_t j = 0; j < n; ++j)
+    {
+        out[j] = FixedHorner<0, _Order, _T>::evaluate(local, x[j]);
+    }
+}
+
+template<size_t _OrderX, size_t _OrderY, typename _T>
+_T evaluateFixed2D(const _T* coef, size_t , size_t , double atX, double atY)
+{
+    return FixedHorner2D<0, _OrderX, _OrderY, _T>::evaluate(coef, atX, atY);
+}
+
+template<size_t _OrderX, size_t _OrderY, typename _T>
+void evaluateFixedBatch2D(const _T* coef, size_t , size_t ,
+                          const double* x, const double* y,
+                          size_t n, _T* out)
+{
+    _T local[(_OrderX + 1) * (_OrderY + 1)];
+    std::copy(coef, coef + (_OrderX + 1) * (_OrderY + 1), local);
+    for (size_t j = 0; j < n; ++j)
+    {
+        out[j] = FixedHorner2D<0, _OrderX, _OrderY, _T>::evaluate(
+                local, x[j], y[j]);
+    }
+}
+
+//! Sums coef[i] * at^i in ascending order for a polynomial of any order
+template<typename _T>
+_T evaluatePowers(const _T* coef, size_t order, double at)
+{
+    _T ret(0.0);
+    double atPower = 1.0;
+    for (size_t i = 0; i <= order; ++i)
+    {
+        ret += coef[i] * atPower;
+        atPower *= at;
+    }
+    return ret;
+}
+
+template<size_t _Order, typename _T>
+_T evaluateFixedPowers(const _T* coef, double at)
+{
+    _T ret(0.0);
+    FixedPowers<0, _Order, _T>::accumulate(coef, at, 1.0, ret);
+    return ret;
+}
+
+/*!
+ *  Evaluates a polynomial at a single point, switching to the unrolled
+ *  power sum for its order.  This is for call sites that see a
+ *  different polynomial each time; otherwise choose a kernel once
+ *  through SelectHorner.
+ */
+template<typename _T>
+_T evaluateDispatched(const _T* coef, size_t order, double at)
+{
+    switch (order)
+    {
+    case 0:
+        return evaluateFixedPowers<0>(coef, at);
+    case 1:
+        return evaluateFixedPowers<1>(coef, at);
+    case 2:
+        return evaluateFixedPowers<2>(coef, at);
+    case 3:
+        return evaluateFixedPowers<3>(coef, at);
+    case 4:
+        return evaluateFixedPowers<4>(coef, at);
+    case 5:
+        return evaluateFixedPowers<5>(coef, at);
+    case 6:
+        return evaluateFixedPowers<6>(coef, at);
+    case 7:
+        return evaluateFixedPowers<7>(coef, at);
+    case 8:
+        return evaluateFixedPowers<8>(coef, at);
+    default:
+        return evaluatePowers(coef, order, at);
+    }
+}
+
+/*!
+ *  Chooses the kernel for a runtime order, counting down from _Order.
+ *  Orders above MAX_FIXED_ORDER get the loop-based fallback.
+ */
+template<size_t _Order, typename _T>
+struct SelectHorner
+{
+    static typename HornerFunctions<_T>::Evaluate evaluate(size_t order)
+    {
+        return order == _Order ?
+                &evaluateFixed<_Order, _T> :
+                SelectHorner<_Order - 1, _T>::evaluate(order);
+    }
+
+    static typename HornerFunctions<_T>::EvaluateBatch
+    evaluateBatch(size_t order)
+    {
+        return order == _Order ?
+                &evaluateFixedBatch<_Order, _T> :
+                SelectHorner<_Order - 1, _T>::evaluateBatch(order);
+    }
+};
+
+template<typename _T>
+struct SelectHorner<0, _T>
+{
+    static typename HornerFunctions<_T>::Evaluate evaluate(size_t order)
+    {
+        return order == 0 ?
+                &evaluateFixed<0, _T> : &evaluateHorner<_T>;
+    }
+
+    static typename HornerFunctions<_T>::EvaluateBatch
+    evaluateBatch(size_t order)
+    {
+        return order == 0 ?
+                &evaluateFixedBatch<0, _T> : &evaluateHornerBatch<_T>;
+    }
+};
+
+/*!
+ *  The two dimensional counterpart of SelectHorner, counting down
+ *  through _OrderY and then _OrderX.
+ */
+template<size_t _OrderX, size_t _OrderY, typename _T>
+struct SelectHorner2D
+{
+    static typename HornerFunctions<_T>::Evaluate2D
+    evaluate(size_t orderX, size_t orderY)
+    {
+        return (orderX == _OrderX && orderY == _OrderY) ?
+                &evaluateFixed2D<_OrderX, _OrderY, _T> :
+                SelectHorner2D<_OrderX, _OrderY - 1, _T>::evaluate(
+                        orderX, orderY);
+    }
+
+    static typename HornerFunctions<_T>::EvaluateBatch2D
+    evaluateBatch(size_t orderX, size_t orderY)
+    {
+        return (orderX == _OrderX && orderY == _OrderY) ?
+                &evaluateFixedBatch2D<_OrderX, _OrderY, _T> :
+                SelectHorner2D<_OrderX, _OrderY - 1, _T>::evaluateBatch(
+                        orderX, orderY);
+    }
+};
+
+template<size_t _OrderX, typename _T>
+struct SelectHorner2D<_OrderX, 0, _T>
+{
+    static typename HornerFunctions<_T>::Evaluate2D
+    evaluate(size_t orderX, size_t orderY)
+    {
+        return (orderX == _OrderX && orderY == 0) ?
+                &evaluateFixed2D<_OrderX, 0, _T> :
+                SelectHorner2D<_OrderX - 1, MAX_FIXED_ORDER, _T>::evaluate(
+                        orderX, orderY);
+    }
+
+    static typename HornerFunctions<_T>::EvaluateBatch2D
+    evaluateBatch(size_t orderX, size_t orderY)
+    {
+        return (orderX == _OrderX && orderY == 0) ?
+                &evaluateFixedBatch2D<_OrderX, 0, _T> :
+                SelectHorner2D<_OrderX - 1, MAX_FIXED_ORDER, _T>::
+                        evaluateBatch(orderX, orderY);
+    }
+};
+
+template<typename _T>
+struct SelectHorner2D<0, 0, _T>
+{
+    static typename HornerFunctions<_T>::Evaluate2D
+    evaluate(size_t orderX, size_t orderY)
+    {
+        return (orderX == 0 && orderY == 0) ?
+                &evaluateFixed2D<0, 0, _T> : &evaluateHorner2D<_T>;
+    }
+
+    static typename HornerFunctions<_T>::EvaluateBatch2D
+    evaluateBatch(size_t orderX, size_t orderY)
+    {
+        return (orderX == 0 && orderY == 0) ?
+                &evaluateFixedBatch2D<0, 0, _T> : &evaluateHornerBatch2D<_T>;
+    }
+};
+}
+}
+}
+
+#endif
@@ -188,6 +188,32 @@ public:
      */
     OneD<_T> transformInput(const OneD<_T>& gx,
                             double zeroEpsilon = 0.0) const;
+
+    /*!
+     * Composes this polynomial with q, so that
+     * P'(x) = P(q(x)).
+     *
+     * This is Horner's rule with polynomials in place of numbers, worked
+     * in preallocated buffers, so it costs order() products with q and
+     * a fixed handful of allocations.
+     *
+     * \param q The polynomial to substitute for x
+     *
+     * \return P(q(x)), of order order() * q.order()
+     */
+    OneD<_T> compose(const OneD<_T>& q) const;
+
+    /*!
+     * As above, but dropping all terms above maxOrder as it goes.  This
+     * is much cheaper than truncating afterwards when only the low
+     * order terms are wanted.
+     *
+     * \param q The polynomial to substitute for x
+     * \param maxOrder The highest order to keep
+     *
+     * \return P(q(x)), truncated to maxOrder
+     */
+    OneD<_T> compose(const OneD<_T>& q, size_t maxOrder) const;
     /*!
      * Copies all valid data from p into the coefficients.
      * This is used in situations where we want to assign a OneD but do
@@ -201,6 +227,23 @@ public:
     void copyFrom(const OneD<_T>& p);
 
     _T operator ()(double at) const;
+
+    /*!
+     * Evaluates the polynomial at many points, out[i] = P(x[i]).
+     *
+     * This is much faster than calling operator() in a loop: Horner's
+     * rule is applied to a block of points at a time, which the
+     * compiler vectorizes across the points.  The results may differ
+     * from operator() in the last bits.
+     *
+     * \param x The points to evaluate at
+     * \param n The number of points
+     * \param[out] out The n values, which must not overlap x
+     * \param numThreads The number of threads to split the points across
+     */
+    void evaluate(const double* x, size_t n, _T* out,
+                  size_t numThreads = 1) const;
+
     _T integrate(double start, double end) const;
     OneD<_T>derivative() const;
     _T velocity(double x) const;
@@ -222,8 +265,26 @@ public:
     OneD<_T>& operator /=(double cv);
     OneD<_T>operator /(double cv) const;
 
+    /*!
+     * Raises the polynomial to a power by repeated squaring, which takes
+     * O(log(toThe)) products rather than toThe - 1.
+     *
+     * \param toThe The power
+     *
+     * \return The polynomial to the power toThe
+     */
     OneD<_T> power(size_t toThe) const;
 
+    /*!
+     * As above, but dropping all terms above maxOrder from every product.
+     *
+     * \param toThe The power
+     * \param maxOrder The highest order to keep
+     *
+     * \return The polynomial to the power toThe, truncated to maxOrder
+     */
+    OneD<_T> power(size_t toThe, size_t maxOrder) const;
+
     template<typename Vector_T> bool operator==(const Vector_T& p) const
     {
         return equalImpl(p);
@@ -20,29 +20,100 @@
  *
  */
 
+#include <algorithm>
 #include <cmath>
 #include <import/except.h>
 #include <import/sys.h>
+#include <math/poly/Kernels.h>
 #include <math/poly/Utils.h>
 #include <math/linear/VectorN.h>
+#include <mt/BalancedRunnable1D.h>
 
 namespace math
 {
 namespace poly
 {
+namespace detail
+{
+// Points are handed to threads this many at a time
+const size_t PARALLEL_EVALUATE_BLOCK = 16 * EVALUATE_BLOCK;
+
+// Evaluates one PARALLEL_EVALUATE_BLOCK of points of a OneD
+template<typename _T>
+struct EvaluateOneD
+{
+    EvaluateOneD(const OneD<_T>& poly, const double* x, size_t n, _T* out) :
+        mPoly(poly), mX(x), mN(n), mOut(out)
+    {
+    }
+
+    void operator()(size_t block) const
+    {
+        const size_t start = block * PARALLEL_EVALUATE_BLOCK;
+        mPoly.evaluate(mX + start,
+                       std::min(PARALLEL_EVALUATE_BLOCK, mN - start),
+                       mOut + start);
+    }
+
+    const OneD<_T>& mPoly;
+    const double* mX;
+    size_t mN;
+    _T* mOut;
+};
+
+// Sets out to the product of the coefficients a and b, dropping terms
+// past maxSize.  out must not be a or b; its capacity is reused.
+template<typename _T>
+void multiplyTruncated(const std::vector<_T>& a, const std::vector<_T>& b,
+                       size_t maxSize, std::vector<_T>& out)
+{
+    const size_t size = std::min(a.size() + b.size() - 1, maxSize);
+    out.assign(size, _T(0.0));
+    for (size_t i = 0, aSize = std::min(a.size(), size); i < aSize; ++i)
+    {
+        const size_t bSize = std::min(b.size(), size - i);
+        for (size_t j = 0; j < bSize; ++j)
+        {
+            out[i + j] += a[i] * b[j];
+        }
+    }
+}
+}
 
 template<typename _T>
 _T
 OneD<_T>::operator () (double at) const
 {
-   _T ret(0.0);
-   double atPwr = 1.0;
-   for (size_t i = 0, sz = mCoef.size() ; i < sz; i++)
+   if (mCoef.empty())
    {
-      ret += mCoef[i]*atPwr;
-      atPwr *= at;
+      return _T(0.0);
    }
-   return ret;
+   return detail::evaluateDispatched(&mCoef[0], mCoef.size() - 1, at);
+}
+
+template<typename _T>
+void
+OneD<_T>::evaluate(const double* x, size_t n, _T* out,
+                   size_t numThreads) const
+{
+    if (numThreads > 1 && n > detail::PARALLEL_EVALUATE_BLOCK)
+    {
+        mt::runBalanced1D((n + detail::PARALLEL_EVALUATE_BLOCK - 1) /
+                                  detail::PARALLEL_EVALUATE_BLOCK,
+                          numThreads,
+                          detail::EvaluateOneD<_T>(*this, x, n, out));
+        return;
+    }
+
+    if (mCoef.empty())
+    {
+        std::fill(out, out + n, _T(0.0));
+        return;
+    }
+
+    const size_t order = mCoef.size() - 1;
+    detail::SelectHorner<detail::MAX_FIXED_ORDER, _T>::evaluateBatch(order)(
+            &mCoef[0], order, x, n, out);
 }
 
 template<typename _T>
@@ -337,28 +408,70 @@ OneD<_T>::operator / (double cv) const
 template<typename _T>
 OneD<_T> OneD<_T>::power(size_t toThe) const
 {
-    // If its 0, we have to give back a 1*x^0 poly, since
-    // we want a 2D poly out
-    if (toThe == 0)
+    return power(toThe, order() * toThe);
+}
+
+template<typename _T>
+OneD<_T> OneD<_T>::power(size_t toThe, size_t maxOrder) const
+{
+    const size_t maxSize = std::min(order() * toThe, maxOrder) + 1;
+
+    // result *= square for each set bit of toThe, squaring as we go.
+    // Swapping with the scratch buffer keeps the reserved capacity, so
+    // nothing is allocated inside the loop.
+    OneD<_T> result;
+    result.mCoef.reserve(maxSize);
+    result.mCoef.assign(1, _T(1));
+
+    std::vector<_T> square(mCoef.begin(),
+                           mCoef.begin() + std::min(mCoef.size(), maxSize));
+    square.reserve(maxSize);
+    std::vector<_T> scratch;
+    scratch.reserve(maxSize);
+
+    while (toThe)
     {
-        OneD<_T> zero(0);
-        zero[0] = _T(1);
-        return zero;
+        if (toThe & 1)
+        {
+            detail::multiplyTruncated(result.mCoef, square, maxSize, scratch);
+            result.mCoef.swap(scratch);
+        }
+        toThe >>= 1;
+        if (toThe)
+        {
+            detail::multiplyTruncated(square, square, maxSize, scratch);
+            square.swap(scratch);
+        }
     }
+    return result;
+}
+
+template<typename _T>
+OneD<_T> OneD<_T>::compose(const OneD<_T>& q) const
+{
+    return compose(q, order() * q.order());
+}
 
-    OneD<_T> rv = *this;
+template<typename _T>
+OneD<_T> OneD<_T>::compose(const OneD<_T>& q, size_t maxOrder) const
+{
+    const size_t maxSize = std::min(order() * q.order(), maxOrder) + 1;
 
-    // If its 1 give it back now
-    if (toThe == 1)
-        return rv;
+    // Horner's rule: result = (...(c[n] * q + c[n-1]) * q + ...) + c[0]
+    OneD<_T> result;
+    result.mCoef.reserve(maxSize);
+    result.mCoef.assign(1, mCoef.back());
 
+    std::vector<_T> scratch;
+    scratch.reserve(maxSize);
 
-    // Otherwise, we have to raise it
-    for (size_t i = 2; i <= toThe; i++)
+    for (size_t i = mCoef.size() - 1; i-- > 0; )
     {
-        rv *= *this;
+        detail::multiplyTruncated(result.mCoef, q.mCoef, maxSize, scratch);
+        result.mCoef.swap(scratch);
+        result.mCoef[0] += mCoef[i];
     }
-    return rv;
+    return result;
 }
 
 template<typename _T>
@@ -426,14 +539,7 @@ template<typename _T>
 OneD<_T> OneD<_T>::transformInput(const OneD<_T>& gx,
                                   double zeroEpsilon) const
 {
-    OneD<_T> newP(order());
-
-    for (size_t ii = 0; ii <= order(); ++ii)
-    {
-        newP += gx.power(ii) * (*this)[ii];
-    }
-
-    return newP.truncateToNonZeros(zeroEpsilon);
+    return compose(gx).truncateToNonZeros(zeroEpsilon);
 }
 
 template<typename _T>
@@ -101,6 +101,41 @@ public:
         return mCoef[0].order();
     }
     _T operator () (double atX, double atY) const;
+
+    /*!
+     * Evaluates the polynomial at many points, out[i] = P(x[i], y[i]).
+     * Horner's rule is vectorized across blocks of points, as in
+     * OneD::evaluate().
+     *
+     * \param x The x coordinates of the points
+     * \param y The y coordinates of the points
+     * \param n The number of points
+     * \param[out] out The n values, which must not overlap x or y
+     * \param numThreads The number of threads to split the points across
+     */
+    void evaluate(const double* x, const double* y, size_t n, _T* out,
+                  size_t numThreads = 1) const;
+
+    /*!
+     * Evaluates the polynomial over a grid, so that
+     * out[i * numY + j] = P(x[i], y[j]).
+     *
+     * For each x, the polynomial is first collapsed to a OneD in y
+     * (the counterpart of atY()), which is then evaluated across the
+     * whole row of y values at once.  Evaluating a grid this way costs
+     * about one multiply-add per output per orderY.
+     *
+     * \param x The x coordinates of the grid rows
+     * \param numX The number of rows
+     * \param y The y coordinates of the grid columns
+     * \param numY The number of columns
+     * \param[out] out The numX * numY values, in row-major order
+     * \param numThreads The number of threads to split the rows across
+     */
+    void evaluateGrid(const double* x, size_t numX,
+                      const double* y, size_t numY,
+                      _T* out, size_t numThreads = 1) const;
+
     _T integrate(double xStart, double xEnd, double yStart, double yEnd) const;
 
     //! Must check the size of the OneD coming in because
@@ -210,6 +245,36 @@ public:
     TwoD<_T> transformInput(const math::poly::TwoD<_T>& gx,
                             double zeroEpsilon = 0.0) const;
 
+    /*!
+     * Composes this polynomial with gx and gy, so that
+     * P'(x, y) = P(gx(x, y), gy(x, y)).
+     *
+     * This is Horner's rule with polynomials in place of numbers, in y
+     * for each row and then in x across the rows.  The work is done on
+     * dense coefficient arrays in preallocated buffers, so it makes a
+     * fixed handful of allocations however large the polynomials are.
+     *
+     * \param gx The polynomial to substitute for x
+     * \param gy The polynomial to substitute for y
+     *
+     * \return P(gx(x, y), gy(x, y))
+     */
+    TwoD<_T> compose(const TwoD<_T>& gx, const TwoD<_T>& gy) const;
+
+    /*!
+     * As above, but dropping all terms above maxOrderX in x or maxOrderY
+     * in y as it goes.
+     *
+     * \param gx The polynomial to substitute for x
+     * \param gy The polynomial to substitute for y
+     * \param maxOrderX The highest order in x to keep
+     * \param maxOrderY The highest order in y to keep
+     *
+     * \return P(gx(x, y), gy(x, y)), truncated to maxOrderX x maxOrderY
+     */
+    TwoD<_T> compose(const TwoD<_T>& gx, const TwoD<_T>& gy,
+                     size_t maxOrderX, size_t maxOrderY) const;
+
     /*!
      * This evaluates y in the 2D polynomial, leaving a 1D polynomial in x
      * That is, poly(x, y) == poly.atY(y)(x)
@@ -239,8 +304,29 @@ public:
     bool operator == (const TwoD<_T>& p) const;
     bool operator != (const TwoD<_T>& p) const;
 
+    /*!
+     * Raises the polynomial to a power by repeated squaring, which takes
+     * O(log(toThe)) products rather than toThe - 1.
+     *
+     * \param toThe The power
+     *
+     * \return The polynomial to the power toThe
+     */
     TwoD<_T> power(size_t toThe) const;
 
+    /*!
+     * As above, but dropping all terms above maxOrderX in x or maxOrderY
+     * in y from every product.
+     *
+     * \param toThe The power
+     * \param maxOrderX The highest order in x to keep
+     * \param maxOrderY The highest order in y to keep
+     *
+     * \return The polynomial to the power toThe, truncated to
+     *         maxOrderX x maxOrderY
+     */
+    TwoD<_T> power(size_t toThe, size_t maxOrderX, size_t maxOrderY) const;
+
     template<typename _TT>
         friend std::ostream& operator << (std::ostream& out, const TwoD<_TT> p);
 
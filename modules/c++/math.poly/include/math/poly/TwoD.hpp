@@ -20,18 +20,186 @@
  *
  */
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <vector>
 
 #include <import/except.h>
 #include <import/sys.h>
 #include <math/poly/OneD.h>
 #include <math/poly/Utils.h>
+#include <mt/BalancedRunnable1D.h>
 
 namespace math
 {
 namespace poly
 {
+namespace detail
+{
+// Evaluates one PARALLEL_EVALUATE_BLOCK of points of a TwoD
+template<typename _T>
+struct EvaluateTwoD
+{
+    EvaluateTwoD(const TwoD<_T>& poly, const double* x, const double* y,
+                 size_t n, _T* out) :
+        mPoly(poly), mX(x), mY(y), mN(n), mOut(out)
+    {
+    }
+
+    void operator()(size_t block) const
+    {
+        const size_t start = block * PARALLEL_EVALUATE_BLOCK;
+        mPoly.evaluate(mX + start, mY + start,
+                       std::min(PARALLEL_EVALUATE_BLOCK, mN - start),
+                       mOut + start);
+    }
+
+    const TwoD<_T>& mPoly;
+    const double* mX;
+    const double* mY;
+    size_t mN;
+    _T* mOut;
+};
+
+// Evaluates one row of a TwoD grid
+template<typename _T>
+struct EvaluateTwoDGrid
+{
+    EvaluateTwoDGrid(const TwoD<_T>& poly, const double* x,
+                     const double* y, size_t numY, _T* out) :
+        mPoly(poly), mX(x), mY(y), mNumY(numY), mOut(out)
+    {
+    }
+
+    void operator()(size_t row) const
+    {
+        mPoly.evaluateGrid(mX + row, 1, mY, mNumY, mOut + row * mNumY);
+    }
+
+    const TwoD<_T>& mPoly;
+    const double* mX;
+    const double* mY;
+    size_t mNumY;
+    _T* mOut;
+};
+
+// The coefficients of a TwoD in one row-major array, numX x numY, so
+// that products can be formed in reusable buffers rather than in a
+// OneD per row.
+template<typename _T>
+struct DenseTwoD
+{
+    DenseTwoD() :
+        numX(0),
+        numY(0)
+    {
+    }
+
+    // Copies the rows, dropping terms past maxNumX x maxNumY
+    void assign(const std::vector<OneD<_T> >& rows,
+                size_t maxNumX, size_t maxNumY)
+    {
+        numX = std::min(rows.size(), maxNumX);
+        numY = 1;
+        for (size_t i = 0; i < numX; ++i)
+        {
+            numY = std::max(numY, rows[i].size());
+        }
+        numY = std::min(numY, maxNumY);
+
+        coef.assign(numX * numY, _T(0.0));
+        for (size_t i = 0; i < numX; ++i)
+        {
+            for (size_t j = 0, n = std::min(rows[i].size(), numY); j < n; ++j)
+            {
+                coef[i * numY + j] = rows[i][j];
+            }
+        }
+    }
+
+    void assign(const _T& value)
+    {
+        numX = numY = 1;
+        coef.assign(1, value);
+    }
+
+    void swap(DenseTwoD& other)
+    {
+        std::swap(numX, other.numX);
+        std::swap(numY, other.numY);
+        coef.swap(other.coef);
+    }
+
+    TwoD<_T> toTwoD() const
+    {
+        TwoD<_T> poly(numX - 1, numY - 1);
+        for (size_t i = 0; i < numX; ++i)
+        {
+            std::copy(&coef[i * numY], &coef[i * numY] + numY, poly[i]);
+        }
+        return poly;
+    }
+
+    size_t numX;
+    size_t numY;
+    std::vector<_T> coef;
+};
+
+// Sets out to a * b, dropping terms past maxNumX x maxNumY.  out must
+// not be a or b; its capacity is reused.
+template<typename _T>
+void multiplyTruncated(const DenseTwoD<_T>& a, const DenseTwoD<_T>& b,
+                       size_t maxNumX, size_t maxNumY, DenseTwoD<_T>& out)
+{
+    out.numX = std::min(a.numX + b.numX - 1, maxNumX);
+    out.numY = std::min(a.numY + b.numY - 1, maxNumY);
+    out.coef.assign(out.numX * out.numY, _T(0.0));
+
+    const size_t aNumY = std::min(a.numY, out.numY);
+    for (size_t ai = 0, aNumX = std::min(a.numX, out.numX); ai < aNumX; ++ai)
+    {
+        const _T* const aRow = &a.coef[ai * a.numY];
+        for (size_t bi = 0, bNumX = std::min(b.numX, out.numX - ai);
+             bi < bNumX; ++bi)
+        {
+            const _T* const bRow = &b.coef[bi * b.numY];
+            _T* const outRow = &out.coef[(ai + bi) * out.numY];
+            for (size_t aj = 0; aj < aNumY; ++aj)
+            {
+                for (size_t bj = 0, bNumY = std::min(b.numY, out.numY - aj);
+                     bj < bNumY; ++bj)
+                {
+                    outRow[aj + bj] += aRow[aj] * bRow[bj];
+                }
+            }
+        }
+    }
+}
+
+// Sets out to a + b.  out must not be a or b; its capacity is reused.
+template<typename _T>
+void add(const DenseTwoD<_T>& a, const DenseTwoD<_T>& b, DenseTwoD<_T>& out)
+{
+    out.numX = std::max(a.numX, b.numX);
+    out.numY = std::max(a.numY, b.numY);
+    out.coef.assign(out.numX * out.numY, _T(0.0));
+    for (size_t i = 0; i < a.numX; ++i)
+    {
+        for (size_t j = 0; j < a.numY; ++j)
+        {
+            out.coef[i * out.numY + j] = a.coef[i * a.numY + j];
+        }
+    }
+    for (size_t i = 0; i < b.numX; ++i)
+    {
+        for (size_t j = 0; j < b.numY; ++j)
+        {
+            out.coef[i * out.numY + j] += b.coef[i * b.numY + j];
+        }
+    }
+}
+}
 
 template<typename _T>
 _T
@@ -47,6 +215,105 @@ TwoD<_T>::operator () (double atX, double atY) const
     return ret;
 }
 
+template<typename _T>
+void
+TwoD<_T>::evaluate(const double* x, const double* y, size_t n, _T* out,
+                   size_t numThreads) const
+{
+    if (numThreads > 1 && n > detail::PARALLEL_EVALUATE_BLOCK)
+    {
+        mt::runBalanced1D((n + detail::PARALLEL_EVALUATE_BLOCK - 1) /
+                                  detail::PARALLEL_EVALUATE_BLOCK,
+                          numThreads,
+                          detail::EvaluateTwoD<_T>(*this, x, y, n, out));
+        return;
+    }
+
+    if (mCoef.empty())
+    {
+        std::fill(out, out + n, _T(0.0));
+        return;
+    }
+
+    // Horner's rule in x, over the values of each OneD in y
+    std::vector<_T> rowValues(std::min(n, detail::EVALUATE_BLOCK));
+    for (size_t start = 0; start < n; start += detail::EVALUATE_BLOCK)
+    {
+        const size_t count = std::min(n - start, detail::EVALUATE_BLOCK);
+        for (size_t i = mCoef.size(); i-- > 0; )
+        {
+            mCoef[i].evaluate(y + start, count, &rowValues[0]);
+
+            _T* const values = out + start;
+            const double* const xs = x + start;
+            if (i == mCoef.size() - 1)
+            {
+                std::copy(rowValues.begin(), rowValues.begin() + count,
+                          values);
+            }
+            else
+            {
+                for (size_t j = 0; j < count; ++j)
+                {
+                    values[j] = values[j] * xs[j] + rowValues[j];
+                }
+            }
+        }
+    }
+}
+
+template<typename _T>
+void
+TwoD<_T>::evaluateGrid(const double* x, size_t numX,
+                       const double* y, size_t numY,
+                       _T* out, size_t numThreads) const
+{
+    if (numThreads > 1 && numX > 1)
+    {
+        mt::runBalanced1D(numX, numThreads,
+                          detail::EvaluateTwoDGrid<_T>(*this, x, y,
+                                                       numY, out));
+        return;
+    }
+
+    size_t numCoefY = 0;
+    for (size_t i = 0; i < mCoef.size(); ++i)
+    {
+        numCoefY = std::max(numCoefY, mCoef[i].size());
+    }
+    if (numCoefY == 0)
+    {
+        std::fill(out, out + numX * numY, _T(0.0));
+        return;
+    }
+
+    // Collapse x out of the polynomial for each row, by Horner's rule
+    // over the coefficients of y, and then evaluate the resulting
+    // OneD in y across the row.
+    OneD<_T> atX(numCoefY - 1);
+    for (size_t row = 0; row < numX; ++row)
+    {
+        const double xi = x[row];
+        for (size_t j = 0; j < numCoefY; ++j)
+        {
+            atX[j] = _T(0.0);
+        }
+        for (size_t i = mCoef.size(); i-- > 0; )
+        {
+            const std::vector<_T>& coef = mCoef[i].coeffs();
+            for (size_t j = 0; j < numCoefY; ++j)
+            {
+                atX[j] = atX[j] * xi;
+                if (j < coef.size())
+                {
+                    atX[j] += coef[j];
+                }
+            }
+        }
+        atX.evaluate(y, numY, out + row * numY);
+    }
+}
+
 template<typename _T>
 _T
 TwoD<_T>::integrate(double xStart, double xEnd,
@@ -122,6 +389,15 @@ TwoD<_T>::atY(double y) const
 template<typename _T>
 TwoD<_T>
 TwoD<_T>::power(size_t toThe) const
+{
+    return power(toThe,
+                 std::numeric_limits<size_t>::max(),
+                 std::numeric_limits<size_t>::max());
+}
+
+template<typename _T>
+TwoD<_T>
+TwoD<_T>::power(size_t toThe, size_t maxOrderX, size_t maxOrderY) const
 {
     // If its 0, we have to give back a 1*x^0*y^0 poly, since
     // we want a 2D poly out
@@ -132,22 +408,113 @@ TwoD<_T>::power(size_t toThe) const
         return zero;
     }
 
-    TwoD<double> rv = *this;
-
-    // If its 1 give it back now
-    if (toThe == 1)
-        return rv;
+    detail::DenseTwoD<_T> square;
+    square.assign(mCoef, orderX() + 1, std::numeric_limits<size_t>::max());
+    const size_t maxNumX =
+            std::min((square.numX - 1) * toThe, maxOrderX) + 1;
+    const size_t maxNumY =
+            std::min((square.numY - 1) * toThe, maxOrderY) + 1;
+
+    // result *= square for each set bit of toThe, squaring as we go.
+    // Swapping with the scratch buffer keeps the reserved capacity, so
+    // nothing is allocated inside the loop.
+    detail::DenseTwoD<_T> result;
+    detail::DenseTwoD<_T> scratch;
+    square.coef.reserve(maxNumX * maxNumY);
+    result.coef.reserve(maxNumX * maxNumY);
+    scratch.coef.reserve(maxNumX * maxNumY);
+    result.assign(_T(1));
+
+    while (toThe)
+    {
+        if (toThe & 1)
+        {
+            detail::multiplyTruncated(result, square, maxNumX, maxNumY,
+                                      scratch);
+            result.swap(scratch);
+        }
+        toThe >>= 1;
+        if (toThe)
+        {
+            detail::multiplyTruncated(square, square, maxNumX, maxNumY,
+                                      scratch);
+            square.swap(scratch);
+        }
+    }
+    return result.toTwoD();
+}
 
+template<typename _T>
+TwoD<_T>
+TwoD<_T>::compose(const TwoD<_T>& gx, const TwoD<_T>& gy) const
+{
+    return compose(gx, gy,
+                   std::numeric_limits<size_t>::max(),
+                   std::numeric_limits<size_t>::max());
+}
 
-    // Otherwise, we have to raise it
-    for (size_t i = 2; i <= toThe; i++)
+template<typename _T>
+TwoD<_T>
+TwoD<_T>::compose(const TwoD<_T>& gx, const TwoD<_T>& gy,
+                  size_t maxOrderX, size_t maxOrderY) const
+{
+    const size_t unlimited = std::numeric_limits<size_t>::max();
+    detail::DenseTwoD<_T> p;
+    detail::DenseTwoD<_T> denseGx;
+    detail::DenseTwoD<_T> denseGy;
+    p.assign(mCoef, orderX() + 1, unlimited);
+    denseGx.assign(gx.mCoef, gx.orderX() + 1, unlimited);
+    denseGy.assign(gy.mCoef, gy.orderX() + 1, unlimited);
+
+    // Bound the orders of the result, and so of every partial result
+    const size_t orderPX = p.numX - 1;
+    const size_t orderPY = p.numY - 1;
+    const size_t maxNumX = std::min(orderPX * (denseGx.numX - 1) +
+                                            orderPY * (denseGy.numX - 1),
+                                    maxOrderX) + 1;
+    const size_t maxNumY = std::min(orderPX * (denseGx.numY - 1) +
+                                            orderPY * (denseGy.numY - 1),
+                                    maxOrderY) + 1;
+    const size_t maxSize = maxNumX * maxNumY;
+
+    detail::DenseTwoD<_T> result;
+    detail::DenseTwoD<_T> row;
+    detail::DenseTwoD<_T> scratch;
+    detail::DenseTwoD<_T> sum;
+    result.coef.reserve(maxSize);
+    row.coef.reserve(maxSize);
+    scratch.coef.reserve(maxSize);
+    sum.coef.reserve(maxSize);
+
+    // Horner's rule in gx over the rows, each of which is Horner's rule
+    // in gy over its coefficients
+    for (size_t i = p.numX; i-- > 0; )
     {
-        rv *= *this;
+        const _T* const coef = &p.coef[i * p.numY];
+        row.assign(coef[orderPY]);
+        for (size_t j = orderPY; j-- > 0; )
+        {
+            detail::multiplyTruncated(row, denseGy, maxNumX, maxNumY,
+                                      scratch);
+            row.swap(scratch);
+            row.coef[0] += coef[j];
+        }
+
+        if (i == p.numX - 1)
+        {
+            result.swap(row);
+        }
+        else
+        {
+            detail::multiplyTruncated(result, denseGx, maxNumX, maxNumY,
+                                      scratch);
+            detail::add(scratch, row, sum);
+            result.swap(sum);
+        }
     }
-    return rv;
+    return result.toTwoD();
 }
 
-
 template<typename _T>
 TwoD<_T>
 TwoD<_T>::flipXY() const
@@ -489,17 +856,7 @@ TwoD<_T> TwoD<_T>::transformInput(
         const math::poly::TwoD<_T>& gy,
         double zeroEpsilon) const
 {
-    math::poly::TwoD<_T> newP(orderX(), orderY());
-
-    for (size_t ii = 0; ii <= orderX(); ++ii)
-    {
-        for (size_t jj = 0; jj <= orderY(); ++jj)
-        {
-            newP += gx.power(ii) * gy.power(jj) * (*this)[ii][jj];
-        }
-    }
-
-    return newP.truncateToNonZeros(zeroEpsilon);
+    return compose(gx, gy).truncateToNonZeros(zeroEpsilon);
 }
 
 template<typename _T>
@@ -0,0 +1,253 @@
+/* =========================================================================
+ * This file is part of math.poly-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.poly-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Compares composing and raising polynomials the way transformInput()
+    and power() used to, by summing repeated products, against
+    compose() and the repeated squaring in power().
+
+    usage: test_compose_benchmark [order] [repetitions]
+        order:       order of every polynomial, in x and in y (default 4)
+        repetitions: times to repeat each operation (default 100)
+
+    For each method, the time per call and the number of heap
+    allocations per call are reported.
+*/
+
+#include <stdlib.h>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+#include <import/except.h>
+#include <import/math/poly.h>
+#include <import/sys.h>
+#include <str/Convert.h>
+
+namespace
+{
+size_t numAllocations = 0;
+}
+
+void* operator new(size_t size)
+{
+    ++numAllocations;
+    void* const ptr = malloc(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) throw()
+{
+    free(ptr);
+}
+
+namespace
+{
+typedef math::poly::OneD<double> OneD;
+typedef math::poly::TwoD<double> TwoD;
+
+TwoD randomPoly(size_t orderX, size_t orderY)
+{
+    TwoD poly(orderX, orderY);
+    for (size_t ii = 0; ii <= orderX; ++ii)
+    {
+        for (size_t jj = 0; jj <= orderY; ++jj)
+        {
+            poly[ii][jj] = 2.0 * rand() / RAND_MAX - 1.0;
+        }
+    }
+    return poly;
+}
+
+// The power() this replaces
+template<typename PolyT>
+PolyT repeatedPower(const PolyT& poly, size_t toThe)
+{
+    PolyT rv = poly;
+    for (size_t ii = 2; ii <= toThe; ++ii)
+    {
+        rv *= poly;
+    }
+    return rv;
+}
+
+// The transformInput() this replaces
+OneD sumOfPowers(const OneD& poly, const OneD& gx)
+{
+    OneD newP(poly.order());
+    for (size_t ii = 0; ii <= poly.order(); ++ii)
+    {
+        newP += repeatedPower(gx, ii) * poly[ii];
+    }
+    return newP;
+}
+
+TwoD sumOfPowers(const TwoD& poly, const TwoD& gx, const TwoD& gy)
+{
+    TwoD newP(poly.orderX(), poly.orderY());
+    for (size_t ii = 0; ii <= poly.orderX(); ++ii)
+    {
+        for (size_t jj = 0; jj <= poly.orderY(); ++jj)
+        {
+            TwoD term(0, 0);
+            term[0][0] = poly[ii][jj];
+            if (ii)
+            {
+                term *= repeatedPower(gx, ii);
+            }
+            if (jj)
+            {
+                term *= repeatedPower(gy, jj);
+            }
+            newP += term;
+        }
+    }
+    return newP;
+}
+
+struct Timer
+{
+    Timer(const std::string& name, size_t repetitions) :
+        mName(name),
+        mRepetitions(repetitions),
+        mAllocations(numAllocations)
+    {
+        mWatch.start();
+    }
+
+    ~Timer()
+    {
+        const double millis = mWatch.stop();
+        const size_t allocations = numAllocations - mAllocations;
+        std::cout << std::setw(24) << mName
+                  << std::setw(14) << std::fixed << std::setprecision(2)
+                  << millis * 1000.0 / mRepetitions
+                  << std::setw(14) << allocations / mRepetitions
+                  << std::endl;
+    }
+
+    std::string mName;
+    size_t mRepetitions;
+    size_t mAllocations;
+    sys::RealTimeStopWatch mWatch;
+};
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const size_t order = (argc > 1) ? str::toType<size_t>(argv[1]) : 4;
+        const size_t repetitions =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 100;
+
+        srand(2016);
+        const TwoD poly = randomPoly(order, order);
+        const TwoD gx = randomPoly(order, order);
+        const TwoD gy = randomPoly(order, order);
+        const OneD poly1D = poly[1];
+        const OneD gx1D = gx[1];
+
+        std::cout << std::setw(24) << "order " + str::toString(order)
+                  << std::setw(14) << "us/call"
+                  << std::setw(14) << "allocs/call" << std::endl;
+
+        double check = 0;
+        {
+            Timer timer("OneD repeated power", repetitions);
+            for (size_t ii = 0; ii < repetitions; ++ii)
+            {
+                check += repeatedPower(gx1D, 3 * order)[0];
+            }
+        }
+        {
+            Timer timer("OneD power", repetitions);
+            for (size_t ii = 0; ii < repetitions; ++ii)
+            {
+                check -= gx1D.power(3 * order)[0];
+            }
+        }
+        {
+            Timer timer("OneD sum of powers", repetitions);
+            for (size_t ii = 0; ii < repetitions; ++ii)
+            {
+                check += sumOfPowers(poly1D, gx1D)[0];
+            }
+        }
+        {
+            Timer timer("OneD compose", repetitions);
+            for (size_t ii = 0; ii < repetitions; ++ii)
+            {
+                check -= poly1D.compose(gx1D)[0];
+            }
+        }
+        {
+            Timer timer("TwoD repeated power", repetitions);
+            for (size_t ii = 0; ii < repetitions; ++ii)
+            {
+                check += repeatedPower(gx, order)[0][0];
+            }
+        }
+        {
+            Timer timer("TwoD power", repetitions);
+            for (size_t ii = 0; ii < repetitions; ++ii)
+            {
+                check -= gx.power(order)[0][0];
+            }
+        }
+        {
+            Timer timer("TwoD sum of powers", repetitions);
+            for (size_t ii = 0; ii < repetitions; ++ii)
+            {
+                check += sumOfPowers(poly, gx, gy)[0][0];
+            }
+        }
+        {
+            Timer timer("TwoD compose", repetitions);
+            for (size_t ii = 0; ii < repetitions; ++ii)
+            {
+                check -= poly.compose(gx, gy)[0][0];
+            }
+        }
+        {
+            Timer timer("TwoD compose to order", repetitions);
+            for (size_t ii = 0; ii < repetitions; ++ii)
+            {
+                check -= poly.compose(gx, gy, order, order)[0][0];
+            }
+        }
+
+        // Guards against the work being optimized away
+        std::cout << "\nchecksum: " << check << std::endl;
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+/* =========================================================================
+ * This file is part of math.poly-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.poly-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Compares batched polynomial evaluation against calling operator()
+    in a loop.
+
+    usage: test_evaluate_benchmark [threads] [size] [order]
+        threads: threads for the parallel runs (default: all CPUs)
+        size:    the grid is size x size (default 2048)
+        order:   order of the polynomials, in x and in y (default 5)
+
+    Throughput is reported in millions of evaluations per second.
+*/
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/math/poly.h>
+#include <import/sys.h>
+#include <str/Convert.h>
+
+namespace
+{
+double rate(size_t count, double millis)
+{
+    return count / (millis / 1000.0) / 1e6;
+}
+
+void report(const std::string& name, size_t count, double millis)
+{
+    std::cout << std::setw(26) << name << std::setw(12) << std::fixed
+              << std::setprecision(1) << rate(count, millis) << std::endl;
+}
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const size_t numThreads = (argc > 1) ? str::toType<size_t>(argv[1])
+                : sys::OS().getNumCPUs();
+        const size_t size = (argc > 2) ? str::toType<size_t>(argv[2]) : 2048;
+        const size_t order = (argc > 3) ? str::toType<size_t>(argv[3]) : 5;
+        const size_t count = size * size;
+
+        math::poly::OneD<double> oneD(order);
+        math::poly::TwoD<double> twoD(order, order);
+        for (size_t ii = 0; ii <= order; ++ii)
+        {
+            oneD[ii] = 1.0 / (ii + 1);
+            for (size_t jj = 0; jj <= order; ++jj)
+            {
+                twoD[ii][jj] = 1.0 / (ii + jj + 1);
+            }
+        }
+
+        std::vector<double> axis(size);
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            axis[ii] = static_cast<double>(ii) / size;
+        }
+        std::vector<double> x(count);
+        std::vector<double> y(count);
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+            x[ii] = axis[ii / size];
+            y[ii] = axis[ii % size];
+        }
+        std::vector<double> out(count);
+
+        std::cout << count << " points, order " << order << ", "
+                  << numThreads << " threads (million points/s)\n\n";
+
+        sys::RealTimeStopWatch watch;
+        watch.start();
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+            out[ii] = oneD(x[ii]);
+        }
+        report("OneD operator()", count, watch.stop());
+
+        watch.clear();
+        watch.start();
+        oneD.evaluate(&x[0], count, &out[0]);
+        report("OneD evaluate x1", count, watch.stop());
+
+        watch.clear();
+        watch.start();
+        oneD.evaluate(&x[0], count, &out[0], numThreads);
+        report("OneD evaluate xN", count, watch.stop());
+
+        const math::poly::FixedKernel1D<double> kernel1D(oneD);
+        watch.clear();
+        watch.start();
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+            out[ii] = kernel1D(x[ii]);
+        }
+        report("FixedKernel1D operator()", count, watch.stop());
+
+        watch.clear();
+        watch.start();
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+            out[ii] = twoD(x[ii], y[ii]);
+        }
+        report("TwoD operator()", count, watch.stop());
+
+        watch.clear();
+        watch.start();
+        twoD.evaluate(&x[0], &y[0], count, &out[0]);
+        report("TwoD evaluate x1", count, watch.stop());
+
+        const math::poly::FixedKernel2D<double> kernel2D(twoD);
+        watch.clear();
+        watch.start();
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+            out[ii] = kernel2D(x[ii], y[ii]);
+        }
+        report("FixedKernel2D operator()", count, watch.stop());
+
+        watch.clear();
+        watch.start();
+        kernel2D.evaluate(&x[0], &y[0], count, &out[0]);
+        report("FixedKernel2D evaluate", count, watch.stop());
+
+        watch.clear();
+        watch.start();
+        twoD.evaluateGrid(&axis[0], size, &axis[0], size, &out[0]);
+        report("TwoD evaluateGrid x1", count, watch.stop());
+
+        watch.clear();
+        watch.start();
+        twoD.evaluateGrid(&axis[0], size, &axis[0], size, &out[0],
+                          numThreads);
+        report("TwoD evaluateGrid xN", count, watch.stop());
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
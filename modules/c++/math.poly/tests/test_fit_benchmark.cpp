@@ -0,0 +1,195 @@
+/* =========================================================================
+ * This file is part of math.poly-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.poly-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Times the least squares solve inside math::poly::fit() against the
+    normal-equation inverse it replaced, on large observation counts.
+
+    usage: test_fit_benchmark [observations] [order]
+        observations: number of observed points (default 1000000)
+        order:        1D order; the 2D fit uses order x order
+                      (default 5)
+
+    Times are in milliseconds.  The residual column is the RMS
+    difference between each solution and the true coefficients.
+*/
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/math/linear.h>
+#include <import/math/poly.h>
+#include <import/sys.h>
+#include <str/Convert.h>
+
+namespace
+{
+typedef math::linear::Matrix2D<double> Matrix;
+
+// Builds the normalized system matrix of a 2D fit on a square grid,
+// and observations of a polynomial with known coefficients.
+void makeSystem(size_t numObs, size_t order, Matrix& A, Matrix& b,
+                std::vector<double>& truth)
+{
+    const size_t side = static_cast<size_t>(std::sqrt(
+            static_cast<double>(numObs)));
+    const size_t numCoeffs = (order + 1) * (order + 1);
+    A = Matrix(side * side, numCoeffs);
+    b = Matrix(side * side, 1);
+
+    truth.resize(numCoeffs);
+    for (size_t ii = 0; ii < numCoeffs; ++ii)
+        truth[ii] = 1.0 / (ii + 1);
+
+    for (size_t row = 0, obs = 0; row < side; ++row)
+    {
+        const double x = 2.0 * row / (side - 1) - 1.0;
+        for (size_t col = 0; col < side; ++col, ++obs)
+        {
+            const double y = 2.0 * col / (side - 1) - 1.0;
+            double xacc = 1;
+            double value = 0;
+            for (size_t k = 0, p = 0; k <= order; ++k)
+            {
+                double yacc = 1;
+                for (size_t l = 0; l <= order; ++l, ++p)
+                {
+                    A(obs, p) = xacc * yacc;
+                    value += truth[p] * xacc * yacc;
+                    yacc *= y;
+                }
+                xacc *= x;
+            }
+            b(obs, 0) = value;
+        }
+    }
+}
+
+// What math::poly::fit() did before: x = inv(A' * A) * A' * b
+Matrix normalInverse(const Matrix& A, const Matrix& b)
+{
+    const Matrix At = A.transpose();
+    const Matrix inv = math::linear::inverse<double>(At * A);
+    return inv * At * b;
+}
+
+double rms(const Matrix& x, const std::vector<double>& truth)
+{
+    double sum = 0;
+    for (size_t ii = 0; ii < truth.size(); ++ii)
+        sum += (x(ii, 0) - truth[ii]) * (x(ii, 0) - truth[ii]);
+    return std::sqrt(sum / truth.size());
+}
+
+void report(const std::string& name, double millis, const Matrix& x,
+            const std::vector<double>& truth)
+{
+    std::cout << std::setw(22) << name
+              << std::setw(12) << std::fixed << std::setprecision(1) << millis
+              << std::setw(14) << std::scientific << std::setprecision(2)
+              << rms(x, truth) << std::endl;
+}
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const size_t numObs = (argc > 1) ? str::toType<size_t>(argv[1])
+                : 1000000;
+        const size_t order = (argc > 2) ? str::toType<size_t>(argv[2]) : 5;
+
+        Matrix A;
+        Matrix b;
+        std::vector<double> truth;
+        makeSystem(numObs, order, A, b, truth);
+
+        std::cout << A.rows() << " observations, " << A.cols()
+                  << " coefficients\n\n"
+                  << std::setw(22) << "solver"
+                  << std::setw(12) << "ms"
+                  << std::setw(14) << "residual" << "\n";
+
+        sys::RealTimeStopWatch watch;
+        watch.start();
+        const Matrix inverseX = normalInverse(A, b);
+        report("normal inverse", watch.stop(), inverseX, truth);
+
+        Matrix copy(A);
+        watch.clear();
+        watch.start();
+        const Matrix x = math::poly::detail::solveLeastSquares(copy, b);
+        report("cholesky (fit)", watch.stop(), x, truth);
+
+        copy = A;
+        watch.clear();
+        watch.start();
+        math::linear::QR<double> qr;
+        qr.decomposeInPlace(copy);
+        const Matrix qrX = qr.solve(b);
+        report("householder qr", watch.stop(), qrX, truth);
+
+        // The full 1D and 2D fits, including building the system
+        std::vector<double> xObs(A.rows());
+        std::vector<double> yObs(A.rows());
+        for (size_t ii = 0; ii < xObs.size(); ++ii)
+        {
+            xObs[ii] = static_cast<double>(ii) / xObs.size();
+            yObs[ii] = b(ii, 0);
+        }
+        watch.clear();
+        watch.start();
+        math::poly::fit(xObs.size(), &xObs[0], &yObs[0], order);
+        std::cout << std::setw(22) << "fit 1D" << std::setw(12)
+                  << std::fixed << std::setprecision(1) << watch.stop()
+                  << std::endl;
+
+        const size_t side = static_cast<size_t>(std::sqrt(
+                static_cast<double>(A.rows())));
+        Matrix gridX(side, side);
+        Matrix gridY(side, side);
+        Matrix gridZ(side, side);
+        for (size_t row = 0; row < side; ++row)
+        {
+            for (size_t col = 0; col < side; ++col)
+            {
+                gridX(row, col) = static_cast<double>(row);
+                gridY(row, col) = static_cast<double>(col);
+                gridZ(row, col) = b(row * side + col, 0);
+            }
+        }
+        watch.clear();
+        watch.start();
+        math::poly::fit(gridX, gridY, gridZ, order, order);
+        std::cout << std::setw(22) << "fit 2D" << std::setw(12)
+                  << watch.stop() << std::endl;
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -53,6 +53,53 @@ void getRandValues(std::vector<double>& values)
     }
 }
 
+// A bound on the rounding error of evaluating poly at x
+double errorBound(const math::poly::OneD<double>& poly, double x)
+{
+    double sum = 0;
+    double xPower = 1;
+    for (size_t ii = 0; ii < poly.size(); ++ii)
+    {
+        sum += std::abs(poly[ii]) * xPower;
+        xPower *= std::abs(x);
+    }
+    return 1e-13 * (sum + 1);
+}
+
+TEST_CASE(testEvaluate)
+{
+    const math::poly::OneD<double> poly(getRandPoly(6));
+
+    // Enough points to span several blocks, and a ragged last one
+    std::vector<double> values(10000);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        values[ii] = getRand() / 10;
+    }
+
+    std::vector<double> out(values.size());
+    poly.evaluate(&values[0], values.size(), &out[0]);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(out[ii], poly(values[ii]),
+                                  errorBound(poly, values[ii]));
+    }
+
+    // Threads split the points, so the results are identical
+    std::vector<double> threaded(values.size());
+    poly.evaluate(&values[0], values.size(), &threaded[0], 3);
+    TEST_ASSERT_TRUE(threaded == out);
+
+    // Constant and empty polynomials
+    const math::poly::OneD<double> constant(0);
+    constant.evaluate(&values[0], 5, &out[0]);
+    TEST_ASSERT_EQ(out[4], 0.0);
+    const math::poly::OneD<double> empty;
+    out[0] = 1;
+    empty.evaluate(&values[0], 1, &out[0]);
+    TEST_ASSERT_EQ(out[0], 0.0);
+}
+
 TEST_CASE(testScaleVariable)
 {
     std::vector<double> values;
@@ -142,6 +189,57 @@ TEST_CASE(testTransformInput)
                                   std::abs(.01 * expectedValue));
     }
 }
+
+TEST_CASE(testPower)
+{
+    const math::poly::OneD<double> poly(getRandPoly(3));
+
+    math::poly::OneD<double> expected(0);
+    expected[0] = 1.0;
+    for (size_t toThe = 0; toThe <= 7; ++toThe)
+    {
+        const math::poly::OneD<double> raised = poly.power(toThe);
+        TEST_ASSERT_EQ(raised.order(), 3 * toThe);
+        for (size_t ii = 0; ii <= raised.order(); ++ii)
+        {
+            TEST_ASSERT_ALMOST_EQ_EPS(raised[ii], expected[ii],
+                                      1e-12 * std::abs(expected[ii]) + 1e-12);
+        }
+
+        // Truncating as we go keeps exactly the low order terms
+        const math::poly::OneD<double> truncated = poly.power(toThe, 4);
+        TEST_ASSERT_EQ(truncated, raised.truncateTo(4));
+
+        expected *= poly;
+    }
+}
+
+TEST_CASE(testCompose)
+{
+    std::vector<double> values;
+    getRandValues(values);
+
+    const math::poly::OneD<double> poly(getRandPoly(4));
+    const math::poly::OneD<double> q(getRandPoly(3));
+
+    const math::poly::OneD<double> composed = poly.compose(q);
+    TEST_ASSERT_EQ(composed.order(), static_cast<size_t>(12));
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        const double expectedValue(poly(q(values[ii])));
+        TEST_ASSERT_ALMOST_EQ_EPS(composed(values[ii]),
+                                  expectedValue,
+                                  std::abs(1e-10 * expectedValue));
+    }
+
+    const math::poly::OneD<double> truncated = poly.compose(q, 5);
+    TEST_ASSERT_EQ(truncated, composed.truncateTo(5));
+
+    // Composing with x is the identity
+    math::poly::OneD<double> identity(1);
+    identity[1] = 1.0;
+    TEST_ASSERT_EQ(poly.compose(identity), poly);
+}
 }
 
 int main(int, char**)
@@ -151,4 +249,7 @@ int main(int, char**)
     TEST_CHECK(testTruncateTo);
     TEST_CHECK(testTruncateToNonZeros);
     TEST_CHECK(testTransformInput);
+    TEST_CHECK(testEvaluate);
+    TEST_CHECK(testPower);
+    TEST_CHECK(testCompose);
 }
@@ -58,6 +58,94 @@ void getRandValues(std::vector<double>& xValues,
     }
 }
 
+// A bound on the rounding error of evaluating poly at (x, y)
+double errorBound(const math::poly::TwoD<double>& poly, double x, double y)
+{
+    double sum = 0;
+    double xPower = 1;
+    for (size_t ii = 0; ii <= poly.orderX(); ++ii)
+    {
+        double yPower = 1;
+        for (size_t jj = 0; jj <= poly.orderY(); ++jj)
+        {
+            sum += std::abs(poly[ii][jj]) * xPower * yPower;
+            yPower *= std::abs(y);
+        }
+        xPower *= std::abs(x);
+    }
+    return 1e-13 * (sum + 1);
+}
+
+TEST_CASE(testEvaluate)
+{
+    const math::poly::TwoD<double> poly(getRandPoly(3, 4));
+
+    std::vector<double> xValues(5000);
+    std::vector<double> yValues(xValues.size());
+    for (size_t ii = 0; ii < xValues.size(); ++ii)
+    {
+        xValues[ii] = getRand() / 10;
+        yValues[ii] = getRand() / 10;
+    }
+
+    std::vector<double> out(xValues.size());
+    poly.evaluate(&xValues[0], &yValues[0], xValues.size(), &out[0]);
+    for (size_t ii = 0; ii < xValues.size(); ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(out[ii], poly(xValues[ii], yValues[ii]),
+                                  errorBound(poly, xValues[ii], yValues[ii]));
+    }
+
+    std::vector<double> threaded(xValues.size());
+    poly.evaluate(&xValues[0], &yValues[0], xValues.size(), &threaded[0], 2);
+    TEST_ASSERT_TRUE(threaded == out);
+}
+
+TEST_CASE(testEvaluateGrid)
+{
+    const math::poly::TwoD<double> poly(getRandPoly(4, 2));
+
+    std::vector<double> xValues(17);
+    std::vector<double> yValues(300);
+    for (size_t ii = 0; ii < xValues.size(); ++ii)
+    {
+        xValues[ii] = getRand() / 10;
+    }
+    for (size_t jj = 0; jj < yValues.size(); ++jj)
+    {
+        yValues[jj] = getRand() / 10;
+    }
+
+    std::vector<double> grid(xValues.size() * yValues.size());
+    poly.evaluateGrid(&xValues[0], xValues.size(),
+                      &yValues[0], yValues.size(), &grid[0]);
+    for (size_t ii = 0; ii < xValues.size(); ++ii)
+    {
+        for (size_t jj = 0; jj < yValues.size(); ++jj)
+        {
+            TEST_ASSERT_ALMOST_EQ_EPS(grid[ii * yValues.size() + jj],
+                                      poly(xValues[ii], yValues[jj]),
+                                      errorBound(poly, xValues[ii],
+                                                 yValues[jj]));
+        }
+    }
+
+    std::vector<double> threaded(grid.size());
+    poly.evaluateGrid(&xValues[0], xValues.size(),
+                      &yValues[0], yValues.size(), &threaded[0], 4);
+    TEST_ASSERT_TRUE(threaded == grid);
+
+    // Rows of a TwoD may be of different orders
+    std::vector<math::poly::OneD<double> > rows(2);
+    rows[0] = math::poly::OneD<double>(0);
+    rows[0][0] = 2;
+    rows[1] = math::poly::OneD<double>(1);
+    rows[1][1] = 3;
+    const math::poly::TwoD<double> ragged(rows);
+    ragged.evaluateGrid(&xValues[0], 1, &yValues[0], 1, &grid[0]);
+    TEST_ASSERT_ALMOST_EQ(grid[0], 2 + 3 * xValues[0] * yValues[0]);
+}
+
 TEST_CASE(testScaleVariable)
 {
     std::vector<double> xValues;
@@ -442,6 +530,69 @@ TEST_CASE(testIsScalar)
     p2[0][0] = 1;
     TEST_ASSERT(p2.isScalar());
 }
+
+TEST_CASE(testPower)
+{
+    const math::poly::TwoD<double> poly(getRandPoly(2, 3));
+
+    math::poly::TwoD<double> expected(0, 0);
+    expected[0][0] = 1.0;
+    for (size_t toThe = 0; toThe <= 5; ++toThe)
+    {
+        const math::poly::TwoD<double> raised = poly.power(toThe);
+        TEST_ASSERT_EQ(raised.orderX(), 2 * toThe);
+        TEST_ASSERT_EQ(raised.orderY(), 3 * toThe);
+        for (size_t ii = 0; ii <= raised.orderX(); ++ii)
+        {
+            for (size_t jj = 0; jj <= raised.orderY(); ++jj)
+            {
+                TEST_ASSERT_ALMOST_EQ_EPS(
+                        raised[ii][jj], expected[ii][jj],
+                        1e-12 * std::abs(expected[ii][jj]) + 1e-12);
+            }
+        }
+
+        // Truncating as we go keeps exactly the low order terms
+        const math::poly::TwoD<double> truncated = poly.power(toThe, 3, 2);
+        TEST_ASSERT_EQ(truncated, raised.truncateTo(3, 2));
+
+        expected *= poly;
+    }
+}
+
+TEST_CASE(testCompose)
+{
+    std::vector<double> xValues;
+    std::vector<double> yValues;
+    getRandValues(xValues, yValues);
+
+    const math::poly::TwoD<double> poly(getRandPoly(3, 2));
+    const math::poly::TwoD<double> gx(getRandPoly(2, 1));
+    const math::poly::TwoD<double> gy(getRandPoly(1, 2));
+
+    const math::poly::TwoD<double> composed = poly.compose(gx, gy);
+    TEST_ASSERT_EQ(composed.orderX(), static_cast<size_t>(3 * 2 + 2 * 1));
+    TEST_ASSERT_EQ(composed.orderY(), static_cast<size_t>(3 * 1 + 2 * 2));
+    for (size_t ii = 0; ii < xValues.size(); ++ii)
+    {
+        const double xx(xValues[ii]);
+        const double yy(yValues[ii]);
+        const double expectedValue(poly(gx(xx, yy), gy(xx, yy)));
+        TEST_ASSERT_ALMOST_EQ_EPS(composed(xx, yy),
+                                  expectedValue,
+                                  std::abs(1e-10 * expectedValue));
+    }
+
+    const math::poly::TwoD<double> truncated = poly.compose(gx, gy, 4, 3);
+    TEST_ASSERT_EQ(truncated, composed.truncateTo(4, 3));
+
+    // Composing with (x, y) is the identity
+    math::poly::TwoD<double> identityX(1, 0);
+    identityX[1][0] = 1.0;
+    math::poly::TwoD<double> identityY(0, 1);
+    identityY[0][1] = 1.0;
+    TEST_ASSERT_EQ(poly.compose(identityX, identityY), poly);
+}
 }
 
 int main(int, char**)
@@ -453,5 +604,9 @@ int main(int, char**)
     TEST_CHECK(testTransformInput);
     TEST_CHECK(testOperators);
     TEST_CHECK(testIsScalar);
+    TEST_CHECK(testEvaluate);
+    TEST_CHECK(testEvaluateGrid);
+    TEST_CHECK(testPower);
+    TEST_CHECK(testCompose);
 }
 
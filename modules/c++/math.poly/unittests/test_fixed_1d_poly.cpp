@@ -77,10 +77,93 @@ TEST_CASE(testScaleVariable)
                                   std::abs(.01 * expectedValue));
     }
 }
+
+// Sums the terms directly, rather than by Horner's rule
+double evaluatePowers(const TestFixed1D& poly, double at)
+{
+    double ret(0);
+    double atPower(1);
+    for (size_t ii = 0; ii <= ORDER; ++ii)
+    {
+        ret += poly[ii] * atPower;
+        atPower *= at;
+    }
+    return ret;
+}
+
+TEST_CASE(testEvaluate)
+{
+    std::vector<double> value;
+    getRandValues(value);
+
+    const TestFixed1D poly(getRandPoly());
+
+    std::vector<double> batch(value.size());
+    poly.evaluate(&value[0], value.size(), &batch[0]);
+
+    for (size_t ii = 0; ii < value.size(); ++ii)
+    {
+        const double expectedValue(evaluatePowers(poly, value[ii]));
+        TEST_ASSERT_ALMOST_EQ_EPS(poly(value[ii]),
+                                  expectedValue,
+                                  std::abs(1e-12 * expectedValue));
+        TEST_ASSERT_EQ(batch[ii], poly(value[ii]));
+    }
+}
+
+TEST_CASE(testDerivative)
+{
+    const TestFixed1D poly(getRandPoly());
+    const math::poly::Fixed1D<ORDER - 1, double> derivative =
+            poly.derivative();
+
+    for (size_t ii = 0; ii < ORDER; ++ii)
+    {
+        TEST_ASSERT_EQ(derivative[ii], poly[ii + 1] * (ii + 1));
+    }
+}
+
+TEST_CASE(testIntegrate)
+{
+    const TestFixed1D poly(getRandPoly());
+
+    // The antiderivative, with a zero constant term
+    math::poly::OneD<double> antiderivative(ORDER + 1);
+    for (size_t ii = 0; ii <= ORDER; ++ii)
+    {
+        antiderivative[ii + 1] = poly[ii] / (ii + 1);
+    }
+
+    const double start(-1.5);
+    const double end(2.25);
+    const double expectedValue(antiderivative(end) - antiderivative(start));
+    TEST_ASSERT_ALMOST_EQ_EPS(poly.integrate(start, end),
+                              expectedValue,
+                              std::abs(1e-12 * expectedValue));
+}
+
+TEST_CASE(testFromLowerOrder)
+{
+    // Terms the source doesn't have must be zero, not left uninitialized
+    math::poly::OneD<double> line(1);
+    line[0] = 3.0;
+    line[1] = 2.0;
+
+    const TestFixed1D poly(line);
+    for (size_t ii = 2; ii <= ORDER; ++ii)
+    {
+        TEST_ASSERT_EQ(poly[ii], 0.0);
+    }
+    TEST_ASSERT_EQ(poly(4.0), 11.0);
+}
 }
 
 int main()
 {
     srand(176);
     TEST_CHECK(testScaleVariable);
+    TEST_CHECK(testEvaluate);
+    TEST_CHECK(testDerivative);
+    TEST_CHECK(testIntegrate);
+    TEST_CHECK(testFromLowerOrder);
 }
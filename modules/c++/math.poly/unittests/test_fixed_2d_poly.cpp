@@ -101,10 +101,54 @@ TEST_CASE(testScaleVariable)
                                   std::abs(.01 * expectedValue));
     }
 }
+
+TEST_CASE(testEvaluate)
+{
+    std::vector<double> xValues;
+    std::vector<double> yValues;
+    getRandValues(xValues, yValues);
+
+    const TestFixed2D poly(getRandPoly());
+
+    std::vector<double> batch(xValues.size());
+    poly.evaluate(&xValues[0], &yValues[0], xValues.size(), &batch[0]);
+
+    for (size_t ii = 0; ii < xValues.size(); ++ii)
+    {
+        // Sum the terms directly, rather than by Horner's rule
+        double expectedValue(0);
+        double xPower(1);
+        for (size_t jj = 0; jj <= ORDER_X; ++jj)
+        {
+            double yPower(1);
+            for (size_t kk = 0; kk <= ORDER_Y; ++kk)
+            {
+                expectedValue += poly[jj][kk] * xPower * yPower;
+                yPower *= yValues[ii];
+            }
+            xPower *= xValues[ii];
+        }
+
+        const double value(poly(xValues[ii], yValues[ii]));
+        TEST_ASSERT_ALMOST_EQ_EPS(value, expectedValue,
+                                  std::abs(1e-12 * expectedValue));
+        TEST_ASSERT_EQ(batch[ii], value);
+    }
+}
+
+TEST_CASE(testIntegrate)
+{
+    // The integral of x * y^2 over [0, 2] x [0, 3] is 2 * 9
+    math::poly::Fixed2D<1, 2, double> poly;
+    poly[1][2] = 1.0;
+    TEST_ASSERT_ALMOST_EQ(poly.integrate(0.0, 2.0, 0.0, 3.0), 18.0);
+}
 }
 
 int main(int, char**)
 {
     srand(176);
     TEST_CHECK(testScaleVariable);
+    TEST_CHECK(testEvaluate);
+    TEST_CHECK(testIntegrate);
 }
@@ -0,0 +1,166 @@
+/* =========================================================================
+ * This file is part of math.poly-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.poly-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <cmath>
+#include <vector>
+
+#include <math/poly/FixedKernel.h>
+#include "TestCase.h"
+
+namespace
+{
+double getRand()
+{
+    return (2.0 * rand() / RAND_MAX - 1.0);
+}
+
+// Sums the terms directly, rather than by Horner's rule
+double evaluatePowers(const math::poly::OneD<double>& poly, double at)
+{
+    double ret(0);
+    double atPower(1);
+    for (size_t ii = 0; ii <= poly.order(); ++ii)
+    {
+        ret += poly[ii] * atPower;
+        atPower *= at;
+    }
+    return ret;
+}
+
+double evaluatePowers(const math::poly::TwoD<double>& poly,
+                      double atX, double atY)
+{
+    double ret(0);
+    double atXPower(1);
+    for (size_t ii = 0; ii <= poly.orderX(); ++ii)
+    {
+        ret += evaluatePowers(poly[ii], atY) * atXPower;
+        atXPower *= atX;
+    }
+    return ret;
+}
+
+TEST_CASE(testKernel1D)
+{
+    std::vector<double> x(37);
+    for (size_t ii = 0; ii < x.size(); ++ii)
+    {
+        x[ii] = 2.0 * getRand();
+    }
+    std::vector<double> out(x.size());
+
+    // Covers every unrolled order, and the fallback past them
+    for (size_t order = 0; order <= 11; ++order)
+    {
+        math::poly::OneD<double> poly(order);
+        for (size_t ii = 0; ii <= order; ++ii)
+        {
+            poly[ii] = getRand();
+        }
+
+        const math::poly::FixedKernel1D<double> kernel(poly);
+        TEST_ASSERT_EQ(kernel.order(), order);
+        TEST_ASSERT_EQ(kernel.isUnrolled(), order <= 8);
+
+        kernel.evaluate(&x[0], x.size(), &out[0]);
+        for (size_t ii = 0; ii < x.size(); ++ii)
+        {
+            const double expectedValue = evaluatePowers(poly, x[ii]);
+            TEST_ASSERT_ALMOST_EQ_EPS(kernel(x[ii]), expectedValue, 1e-10);
+            TEST_ASSERT_ALMOST_EQ_EPS(poly(x[ii]), expectedValue, 1e-10);
+            TEST_ASSERT_EQ(out[ii], kernel(x[ii]));
+        }
+    }
+}
+
+TEST_CASE(testKernel2D)
+{
+    std::vector<double> x(23);
+    std::vector<double> y(x.size());
+    for (size_t ii = 0; ii < x.size(); ++ii)
+    {
+        x[ii] = 2.0 * getRand();
+        y[ii] = 2.0 * getRand();
+    }
+    std::vector<double> out(x.size());
+
+    for (size_t orderX = 0; orderX <= 9; ++orderX)
+    {
+        for (size_t orderY = 0; orderY <= 9; ++orderY)
+        {
+            math::poly::TwoD<double> poly(orderX, orderY);
+            for (size_t ii = 0; ii <= orderX; ++ii)
+            {
+                for (size_t jj = 0; jj <= orderY; ++jj)
+                {
+                    poly[ii][jj] = getRand();
+                }
+            }
+
+            const math::poly::FixedKernel2D<double> kernel(poly);
+            TEST_ASSERT_EQ(kernel.orderX(), orderX);
+            TEST_ASSERT_EQ(kernel.orderY(), orderY);
+            TEST_ASSERT_EQ(kernel.isUnrolled(), orderX <= 8 && orderY <= 8);
+
+            kernel.evaluate(&x[0], &y[0], x.size(), &out[0]);
+            for (size_t ii = 0; ii < x.size(); ++ii)
+            {
+                const double expectedValue =
+                        evaluatePowers(poly, x[ii], y[ii]);
+                TEST_ASSERT_ALMOST_EQ_EPS(kernel(x[ii], y[ii]),
+                                          expectedValue, 1e-10);
+                TEST_ASSERT_ALMOST_EQ_EPS(poly(x[ii], y[ii]),
+                                          expectedValue, 1e-10);
+                TEST_ASSERT_EQ(out[ii], kernel(x[ii], y[ii]));
+            }
+        }
+    }
+}
+
+TEST_CASE(testRaggedTwoD)
+{
+    // 2 + 3xy + x^2, whose rows have orders 0, 1 and 0
+    std::vector<math::poly::OneD<double> > rows;
+    rows.push_back(math::poly::OneD<double>(0));
+    rows[0][0] = 2.0;
+    rows.push_back(math::poly::OneD<double>(1));
+    rows[1][1] = 3.0;
+    rows.push_back(math::poly::OneD<double>(0));
+    rows[2][0] = 1.0;
+    const math::poly::TwoD<double> poly(rows);
+
+    const math::poly::FixedKernel2D<double> kernel(poly);
+    TEST_ASSERT_EQ(kernel.orderX(), static_cast<size_t>(2));
+    TEST_ASSERT_EQ(kernel.orderY(), static_cast<size_t>(1));
+    TEST_ASSERT_ALMOST_EQ(kernel(2.0, 5.0), 2.0 + 30.0 + 4.0);
+}
+}
+
+int main(int, char**)
+{
+    srand(334);
+    TEST_CHECK(testKernel1D);
+    TEST_CHECK(testKernel2D);
+    TEST_CHECK(testRaggedTwoD);
+    return 0;
+}
@@ -126,6 +126,34 @@ TEST_CASE(test1DPolyfitLarge)
     TEST_ASSERT_ALMOST_EQ_EPS(meanResidualErrorShifted, 0.0, 2e-7);
 }
 
+TEST_CASE(test1DPolyfitHighOrder)
+{
+    // A high order fit is poorly conditioned enough that solving the
+    // normal equations directly loses most of the available digits.
+    static const size_t NUM_OBS = 200;
+    static const size_t POLY_ORDER = 14;
+    std::vector<double> coeffs(POLY_ORDER + 1);
+    for (size_t ii = 0; ii <= POLY_ORDER; ++ii)
+    {
+        coeffs[ii] = (ii % 2 ? -1.0 : 1.0) / (ii + 1);
+    }
+    const OneD<double> truth(coeffs);
+
+    std::vector<double> xObs(NUM_OBS);
+    std::vector<double> yObs(NUM_OBS);
+    for (size_t ii = 0; ii < NUM_OBS; ++ii)
+    {
+        xObs[ii] = 2.0 * ii / (NUM_OBS - 1);
+        yObs[ii] = truth(xObs[ii]);
+    }
+
+    const OneD<double> poly = fit(NUM_OBS, &xObs[0], &yObs[0], POLY_ORDER);
+    for (size_t ii = 0; ii < NUM_OBS; ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(poly(xObs[ii]), yObs[ii], 1e-8);
+    }
+}
+
 TEST_CASE(test2DPolyfit)
 {
     const double coeffs[] =
@@ -338,6 +366,7 @@ int main(int, char**)
 {
     TEST_CHECK(test1DPolyfit);
     TEST_CHECK(test1DPolyfitLarge);
+    TEST_CHECK(test1DPolyfitHighOrder);
     TEST_CHECK(test2DPolyfit);
     TEST_CHECK(test2DPolyfitLarge);
     TEST_CHECK(testVectorValuedOrderChange);
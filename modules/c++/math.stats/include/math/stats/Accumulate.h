@@ -0,0 +1,260 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_STATS_ACCUMULATE_H__
+#define __MATH_STATS_ACCUMULATE_H__
+
+#include <stddef.h>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include <except/Exception.h>
+#include <mem/BufferView.h>
+#include <mt/BalancedRunnable1D.h>
+#include <polygon/PolygonMask.h>
+#include <types/Range.h>
+#include <types/RowCol.h>
+
+/*!
+ *  \file Accumulate.h
+ *  \brief Feeds buffers to Statistics, Histogram or QuantileSketch
+ *
+ *  The functions here work with any accumulator with add(values, size),
+ *  merge() and clear() members.  With several threads each thread adds
+ *  to its own copy of the accumulator, cleared, and the copies are
+ *  merged into the accumulator at the end.
+ */
+
+namespace math
+{
+namespace stats
+{
+namespace detail
+{
+//! Number of values each thread takes at a time
+const size_t ACCUMULATE_CHUNK = 65536;
+
+// Adds one ACCUMULATE_CHUNK of a buffer to an accumulator
+template<typename AccumulatorT, typename T>
+struct AccumulateChunk
+{
+    AccumulateChunk(const T* values, size_t size,
+                    AccumulatorT& accumulator) :
+        mValues(values), mSize(size), mAccumulator(&accumulator)
+    {
+    }
+
+    void operator()(size_t chunk) const
+    {
+        const size_t start = chunk * ACCUMULATE_CHUNK;
+        mAccumulator->add(mValues + start,
+                          std::min(ACCUMULATE_CHUNK, mSize - start));
+    }
+
+    const T* mValues;
+    size_t mSize;
+    AccumulatorT* mAccumulator;
+};
+
+// Adds the masked part of a chunk of rows of an image to an accumulator
+template<typename AccumulatorT, typename T>
+struct AccumulateRows
+{
+    AccumulateRows(const T* image, const types::RowCol<size_t>& dims,
+                   const polygon::PolygonMask& mask, size_t rowsPerChunk,
+                   AccumulatorT& accumulator) :
+        mImage(image), mDims(dims), mMask(&mask),
+        mRowsPerChunk(rowsPerChunk), mAccumulator(&accumulator)
+    {
+    }
+
+    void operator()(size_t chunk) const
+    {
+        const size_t start = chunk * mRowsPerChunk;
+        const size_t end = std::min(start + mRowsPerChunk, mDims.row);
+        for (size_t row = start; row < end; ++row)
+        {
+            const types::Range range = mMask->getRange(row);
+            if (range.mNumElements > 0)
+            {
+                mAccumulator->add(
+                        mImage + row * mDims.col + range.mStartElement,
+                        range.mNumElements);
+            }
+        }
+    }
+
+    const T* mImage;
+    types::RowCol<size_t> mDims;
+    const polygon::PolygonMask* mMask;
+    size_t mRowsPerChunk;
+    AccumulatorT* mAccumulator;
+};
+
+/*!
+ *  Runs one OpT per thread over numChunks chunks, each with its own
+ *  partial accumulator, and merges the partials into 'accumulator'
+ *
+ *  \param makeOp Makes the functor for a partial, as makeOp(partial)
+ */
+template<typename AccumulatorT, typename MakeOpT>
+void accumulateChunks(size_t numChunks, size_t numThreads,
+                      const MakeOpT& makeOp, AccumulatorT& accumulator)
+{
+    numThreads = std::min(numThreads, numChunks);
+    if (numThreads <= 1)
+    {
+        for (size_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            makeOp(accumulator)(chunk);
+        }
+        return;
+    }
+
+    AccumulatorT empty(accumulator);
+    empty.clear();
+    std::vector<AccumulatorT> partials(numThreads, empty);
+    std::vector<typename MakeOpT::Op> ops;
+    ops.reserve(numThreads);
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        ops.push_back(makeOp(partials[ii]));
+    }
+    mt::runBalanced1D(numChunks, numThreads, ops);
+
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        accumulator.merge(partials[ii]);
+    }
+}
+
+template<typename AccumulatorT, typename T>
+struct MakeAccumulateChunk
+{
+    typedef AccumulateChunk<AccumulatorT, T> Op;
+
+    MakeAccumulateChunk(const T* values, size_t size) :
+        mValues(values), mSize(size)
+    {
+    }
+
+    Op operator()(AccumulatorT& accumulator) const
+    {
+        return Op(mValues, mSize, accumulator);
+    }
+
+    const T* mValues;
+    size_t mSize;
+};
+
+template<typename AccumulatorT, typename T>
+struct MakeAccumulateRows
+{
+    typedef AccumulateRows<AccumulatorT, T> Op;
+
+    MakeAccumulateRows(const T* image, const types::RowCol<size_t>& dims,
+                       const polygon::PolygonMask& mask,
+                       size_t rowsPerChunk) :
+        mImage(image), mDims(dims), mMask(mask),
+        mRowsPerChunk(rowsPerChunk)
+    {
+    }
+
+    Op operator()(AccumulatorT& accumulator) const
+    {
+        return Op(mImage, mDims, mMask, mRowsPerChunk, accumulator);
+    }
+
+    const T* mImage;
+    types::RowCol<size_t> mDims;
+    const polygon::PolygonMask& mMask;
+    size_t mRowsPerChunk;
+};
+}
+
+/*!
+ *  Add every value in a buffer to an accumulator
+ *
+ *  \param buffer The values
+ *  \param accumulator Statistics, Histogram or QuantileSketch to add to
+ *  \param numThreads Number of threads to use
+ */
+template<typename AccumulatorT, typename T>
+void accumulate(const mem::BufferView<T>& buffer,
+                AccumulatorT& accumulator,
+                size_t numThreads = 1)
+{
+    const size_t numChunks = (buffer.size + detail::ACCUMULATE_CHUNK - 1) /
+            detail::ACCUMULATE_CHUNK;
+    detail::accumulateChunks(
+            numChunks, numThreads,
+            detail::MakeAccumulateChunk<AccumulatorT, const T>(buffer.data,
+                                                               buffer.size),
+            accumulator);
+}
+
+/*!
+ *  Add the pixels of an image that are inside a polygon mask to an
+ *  accumulator
+ *
+ *  \param image Row-major pixels
+ *  \param dims Dimensions of the image
+ *  \param mask The pixels to include.  Its dimensions must match dims.
+ *  \param accumulator Statistics, Histogram or QuantileSketch to add to
+ *  \param numThreads Number of threads to use
+ *  \throw except::Exception if the image is smaller than dims, or the
+ *         mask's dimensions differ
+ */
+template<typename AccumulatorT, typename T>
+void accumulate(const mem::BufferView<T>& image,
+                const types::RowCol<size_t>& dims,
+                const polygon::PolygonMask& mask,
+                AccumulatorT& accumulator,
+                size_t numThreads = 1)
+{
+    if (image.size < dims.area())
+    {
+        std::ostringstream ostr;
+        ostr << "Image of " << image.size << " pixels is smaller than "
+             << dims.row << " x " << dims.col;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    if (mask.getDims() != dims)
+    {
+        throw except::Exception(Ctxt(
+                "Mask dimensions don't match the image"));
+    }
+
+    const size_t rowsPerChunk = std::max<size_t>(
+            detail::ACCUMULATE_CHUNK / std::max<size_t>(dims.col, 1), 1);
+    const size_t numChunks = (dims.row + rowsPerChunk - 1) / rowsPerChunk;
+    detail::accumulateChunks(
+            numChunks, numThreads,
+            detail::MakeAccumulateRows<AccumulatorT, const T>(
+                    image.data, dims, mask, rowsPerChunk),
+            accumulator);
+}
+}
+}
+
+#endif
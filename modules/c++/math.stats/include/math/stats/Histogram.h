@@ -0,0 +1,167 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_STATS_HISTOGRAM_H__
+#define __MATH_STATS_HISTOGRAM_H__
+
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <math/stats/Statistics.h>
+
+namespace math
+{
+namespace stats
+{
+/*!
+ *  \class Histogram
+ *  \brief Counts values in equal width bins over a fixed range
+ *
+ *  Bin k holds the values in [getBinStart(k), getBinStart(k + 1)).
+ *  Values below the range are counted as underflow, and values at or
+ *  above its end as overflow.  NaN values are counted separately and
+ *  are in no bin.
+ *
+ *  Histograms over the same bins can be combined with merge(), e.g. to
+ *  gather one per thread.
+ */
+class Histogram
+{
+public:
+    /*!
+     *  \param min Start of the first bin
+     *  \param max End of the last bin
+     *  \param numBins Number of bins, at most MAX_NUM_BINS
+     *  \throw except::Exception if min and max are not finite with
+     *         min < max, or numBins is 0 or too large
+     */
+    Histogram(double min, double max, size_t numBins);
+
+    static const size_t MAX_NUM_BINS = 1 << 24;
+
+    //! Add one value
+    void add(double value);
+
+    //! Add an array of values
+    template<typename T>
+    void add(const T* values, size_t size)
+    {
+        double valid[detail::STATS_BLOCK];
+        for (size_t start = 0; start < size; start += detail::STATS_BLOCK)
+        {
+            const size_t count = std::min(detail::STATS_BLOCK, size - start);
+            const size_t numValid =
+                    detail::copyValid(values + start, count, valid);
+            mNumNaN += count - numValid;
+            addValid(valid, numValid);
+        }
+    }
+
+    /*!
+     *  Add the counts of another histogram
+     *
+     *  \throw except::Exception if other has different bins
+     */
+    void merge(const Histogram& other);
+
+    //! Reset every count to 0
+    void clear();
+
+    size_t getNumBins() const
+    {
+        return mNumBins;
+    }
+
+    double getMin() const
+    {
+        return mMin;
+    }
+
+    double getMax() const
+    {
+        return mMax;
+    }
+
+    double getBinWidth() const
+    {
+        return (mMax - mMin) / mNumBins;
+    }
+
+    //! \return The start of bin 'bin', or getMax() for bin getNumBins()
+    double getBinStart(size_t bin) const;
+
+    /*!
+     *  \return The number of values in bin 'bin'
+     *  \throw except::Exception if there is no such bin
+     */
+    sys::Uint64_T getCount(size_t bin) const;
+
+    //! \return The number of values below getMin()
+    sys::Uint64_T getUnderflowCount() const
+    {
+        return mCounts.front();
+    }
+
+    //! \return The number of values at or above getMax()
+    sys::Uint64_T getOverflowCount() const
+    {
+        return mCounts.back();
+    }
+
+    //! \return The number of values, not counting NaN
+    sys::Uint64_T getTotalCount() const;
+
+    //! \return The number of NaN values
+    sys::Uint64_T getNumNaN() const
+    {
+        return mNumNaN;
+    }
+
+    /*!
+     *  Estimates a quantile, interpolating linearly within its bin.  A
+     *  quantile that falls among the underflow or overflow values is
+     *  reported as getMin() or getMax().
+     *
+     *  \param fraction In [0, 1], e.g. 0.5 for the median
+     *  \throw except::Exception if fraction is out of range or there are
+     *         no values
+     */
+    double getQuantile(double fraction) const;
+
+private:
+    // Adds values without NaN
+    void addValid(const double* values, size_t size);
+
+    double mMin;
+    double mMax;
+    size_t mNumBins;
+
+    // Underflow, the bins, then overflow
+    std::vector<sys::Uint64_T> mCounts;
+    sys::Uint64_T mNumNaN;
+};
+}
+}
+
+#endif
@@ -0,0 +1,132 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_STATS_QUANTILE_SKETCH_H__
+#define __MATH_STATS_QUANTILE_SKETCH_H__
+
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <math/stats/Statistics.h>
+
+namespace math
+{
+namespace stats
+{
+/*!
+ *  \class QuantileSketch
+ *  \brief Approximate quantiles of more values than can be kept
+ *
+ *  Values are kept in levels of at most 'capacity' values, where each
+ *  value at level k stands for 2^k of the inputs.  When a level fills
+ *  up it is sorted and every other value moves up a level, alternating
+ *  between the odd and even ones.  Memory therefore grows with the log
+ *  of the number of values, and the rank of a reported quantile is
+ *  typically off by well under 1% of the count for the default
+ *  capacity.  The minimum and maximum are exact.
+ *
+ *  Sketches can be combined with merge(), e.g. to gather one per
+ *  thread.  NaN values are counted but otherwise ignored.
+ */
+class QuantileSketch
+{
+public:
+    static const size_t DEFAULT_CAPACITY = 1024;
+
+    /*!
+     *  \param capacity Values kept per level.  Larger is more accurate.
+     *  \throw except::Exception if capacity is less than 2
+     */
+    explicit QuantileSketch(size_t capacity = DEFAULT_CAPACITY);
+
+    //! Add one value
+    void add(double value);
+
+    //! Add an array of values
+    template<typename T>
+    void add(const T* values, size_t size)
+    {
+        double valid[detail::STATS_BLOCK];
+        for (size_t start = 0; start < size; start += detail::STATS_BLOCK)
+        {
+            const size_t count = std::min(detail::STATS_BLOCK, size - start);
+            const size_t numValid =
+                    detail::copyValid(values + start, count, valid);
+            mNumNaN += count - numValid;
+            addValid(valid, numValid);
+        }
+    }
+
+    //! Combine with a sketch of other values
+    void merge(const QuantileSketch& other);
+
+    //! Forget every value
+    void clear();
+
+    //! \return The number of values, not counting NaN
+    sys::Uint64_T getCount() const
+    {
+        return mCount;
+    }
+
+    //! \return The number of NaN values
+    sys::Uint64_T getNumNaN() const
+    {
+        return mNumNaN;
+    }
+
+    //! \return The number of values held to represent the others
+    size_t getNumRetained() const;
+
+    /*!
+     *  Estimates a quantile, one of the values added
+     *
+     *  \param fraction In [0, 1], e.g. 0.5 for the median.  0 and 1 give
+     *         the exact minimum and maximum.
+     *  \throw except::Exception if fraction is out of range or there are
+     *         no values
+     */
+    double getQuantile(double fraction) const;
+
+private:
+    // Adds values without NaN
+    void addValid(const double* values, size_t size);
+
+    // Moves half of level 'level' up, and so on up while levels are full
+    void compact(size_t level);
+
+    size_t mCapacity;
+    std::vector<std::vector<double> > mLevels;
+
+    // Number of times each level has been compacted
+    std::vector<sys::Uint64_T> mNumCompactions;
+    sys::Uint64_T mCount;
+    sys::Uint64_T mNumNaN;
+    double mMin;
+    double mMax;
+};
+}
+}
+
+#endif
@@ -0,0 +1,175 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_STATS_STATISTICS_H__
+#define __MATH_STATS_STATISTICS_H__
+
+#include <stddef.h>
+#include <algorithm>
+
+#include <sys/Conf.h>
+
+namespace math
+{
+namespace stats
+{
+namespace detail
+{
+//! Number of values the accumulators work on at a time
+const size_t STATS_BLOCK = 1024;
+
+/*!
+ *  Copies the values that aren't NaN to 'out', as double
+ *
+ *  \param values Input values
+ *  \param size Number of input values, no more than STATS_BLOCK
+ *  \param[out] out Holds the values that aren't NaN
+ *  \return The number of values copied
+ */
+template<typename T>
+size_t copyValid(const T* values, size_t size, double* out)
+{
+    size_t numNaN = 0;
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        numNaN += (values[ii] != values[ii]);
+    }
+
+    if (numNaN == 0)
+    {
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            out[ii] = static_cast<double>(values[ii]);
+        }
+        return size;
+    }
+
+    size_t numValid = 0;
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        if (values[ii] == values[ii])
+        {
+            out[numValid++] = static_cast<double>(values[ii]);
+        }
+    }
+    return numValid;
+}
+}
+
+/*!
+ *  \class Statistics
+ *  \brief Count, minimum, maximum, mean and variance in one pass
+ *
+ *  Values are taken a block at a time.  Each block's mean and sum of
+ *  squared deviations are found in two vectorized passes over the block,
+ *  and blocks are combined with the pairwise update of Chan, Golub and
+ *  LeVeque, so the variance stays accurate when the mean is large
+ *  compared to the spread.  Partial results, e.g. from several threads,
+ *  are combined the same way with merge().
+ *
+ *  NaN values are counted but otherwise ignored.  Infinities are
+ *  included, so they make the mean and variance infinite or NaN.
+ *
+ *  \code
+    Statistics stats;
+    stats.add(image, numPixels);
+    std::cout << stats.getMean() << " +/- "
+              << stats.getStandardDeviation() << std::endl;
+ *  \endcode
+ */
+class Statistics
+{
+public:
+    Statistics();
+
+    //! Add one value
+    void add(double value);
+
+    //! Add an array of values
+    template<typename T>
+    void add(const T* values, size_t size)
+    {
+        double valid[detail::STATS_BLOCK];
+        for (size_t start = 0; start < size; start += detail::STATS_BLOCK)
+        {
+            const size_t count = std::min(detail::STATS_BLOCK, size - start);
+            const size_t numValid =
+                    detail::copyValid(values + start, count, valid);
+            mNumNaN += count - numValid;
+            addValid(valid, numValid);
+        }
+    }
+
+    //! Combine with the statistics of other values
+    void merge(const Statistics& other);
+
+    //! Forget every value
+    void clear();
+
+    //! \return The number of values, not counting NaN
+    sys::Uint64_T getCount() const
+    {
+        return mCount;
+    }
+
+    //! \return The number of NaN values
+    sys::Uint64_T getNumNaN() const
+    {
+        return mNumNaN;
+    }
+
+    //! \return The smallest value, or NaN if there are none
+    double getMin() const;
+
+    //! \return The largest value, or NaN if there are none
+    double getMax() const;
+
+    //! \return The mean, or NaN if there are no values
+    double getMean() const;
+
+    //! \return The population variance, or NaN if there are no values
+    double getVariance() const;
+
+    //! \return The sample variance, or NaN if there are fewer than two values
+    double getSampleVariance() const;
+
+    //! \return The square root of getVariance()
+    double getStandardDeviation() const;
+
+private:
+    // Adds values without NaN
+    void addValid(const double* values, size_t size);
+
+    void merge(sys::Uint64_T count, double mean, double sumSquares,
+               double min, double max);
+
+    sys::Uint64_T mCount;
+    sys::Uint64_T mNumNaN;
+    double mMean;
+    double mSumSquares;
+    double mMin;
+    double mMax;
+};
+}
+}
+
+#endif
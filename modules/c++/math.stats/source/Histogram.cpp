@@ -0,0 +1,183 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <math/stats/Histogram.h>
+
+namespace math
+{
+namespace stats
+{
+const size_t Histogram::MAX_NUM_BINS;
+
+Histogram::Histogram(double min, double max, size_t numBins) :
+    mMin(min),
+    mMax(max),
+    mNumBins(numBins),
+    mCounts(numBins + 2, 0),
+    mNumNaN(0)
+{
+    // Negated so that NaN fails too
+    if (!(min < max) || !(max - min < std::numeric_limits<double>::max()))
+    {
+        std::ostringstream ostr;
+        ostr << "Invalid histogram range [" << min << ", " << max << ")";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    if (numBins == 0 || numBins > MAX_NUM_BINS)
+    {
+        std::ostringstream ostr;
+        ostr << "Invalid number of histogram bins " << numBins;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+}
+
+void Histogram::add(double value)
+{
+    if (value != value)
+    {
+        ++mNumNaN;
+        return;
+    }
+    addValid(&value, 1);
+}
+
+void Histogram::addValid(const double* values, size_t size)
+{
+    // Clamping after the arithmetic, and converting to integers before
+    // anything more is done, keeps this loop free of branches so that it
+    // vectorizes.  Values below the range go to bin 0 here, and are moved
+    // to underflow afterwards.
+    const double scale = mNumBins / (mMax - mMin);
+    const double lastBin = static_cast<double>(mNumBins);
+
+    sys::Int32_T indices[detail::STATS_BLOCK];
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        const double bin = (values[ii] - mMin) * scale;
+        double clamped = (bin > 0.0) ? bin : 0.0;
+        clamped = (clamped < lastBin) ? clamped : lastBin;
+        indices[ii] = static_cast<sys::Int32_T>(clamped) + 1;
+    }
+
+    sys::Uint64_T* const counts = &mCounts[0];
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        ++counts[indices[ii]];
+    }
+
+    sys::Uint64_T numBelow = 0;
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        numBelow += (values[ii] < mMin);
+    }
+    counts[0] += numBelow;
+    counts[1] -= numBelow;
+}
+
+void Histogram::merge(const Histogram& other)
+{
+    if (other.mMin != mMin || other.mMax != mMax ||
+        other.mNumBins != mNumBins)
+    {
+        throw except::Exception(Ctxt(
+                "Can only merge histograms with the same bins"));
+    }
+
+    for (size_t ii = 0; ii < mCounts.size(); ++ii)
+    {
+        mCounts[ii] += other.mCounts[ii];
+    }
+    mNumNaN += other.mNumNaN;
+}
+
+void Histogram::clear()
+{
+    std::fill(mCounts.begin(), mCounts.end(), 0);
+    mNumNaN = 0;
+}
+
+double Histogram::getBinStart(size_t bin) const
+{
+    return (bin >= mNumBins) ? mMax : mMin + bin * getBinWidth();
+}
+
+sys::Uint64_T Histogram::getCount(size_t bin) const
+{
+    if (bin >= mNumBins)
+    {
+        std::ostringstream ostr;
+        ostr << "Bin " << bin << " is out of range for " << mNumBins
+             << " bins";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    return mCounts[bin + 1];
+}
+
+sys::Uint64_T Histogram::getTotalCount() const
+{
+    sys::Uint64_T total = 0;
+    for (size_t ii = 0; ii < mCounts.size(); ++ii)
+    {
+        total += mCounts[ii];
+    }
+    return total;
+}
+
+double Histogram::getQuantile(double fraction) const
+{
+    if (!(fraction >= 0.0 && fraction <= 1.0))
+    {
+        std::ostringstream ostr;
+        ostr << "Quantile " << fraction << " is not in [0, 1]";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    const sys::Uint64_T total = getTotalCount();
+    if (total == 0)
+    {
+        throw except::Exception(Ctxt("Histogram has no values"));
+    }
+
+    const double target = fraction * total;
+    double cumulative = static_cast<double>(getUnderflowCount());
+    if (target <= cumulative && cumulative > 0)
+    {
+        return mMin;
+    }
+    for (size_t bin = 0; bin < mNumBins; ++bin)
+    {
+        const double count = static_cast<double>(mCounts[bin + 1]);
+        if (count > 0 && target <= cumulative + count)
+        {
+            return getBinStart(bin) +
+                    (target - cumulative) / count * getBinWidth();
+        }
+        cumulative += count;
+    }
+    return mMax;
+}
+}
+}
@@ -0,0 +1,226 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+#include <except/Exception.h>
+#include <math/stats/QuantileSketch.h>
+
+namespace math
+{
+namespace stats
+{
+const size_t QuantileSketch::DEFAULT_CAPACITY;
+
+QuantileSketch::QuantileSketch(size_t capacity) :
+    mCapacity(capacity)
+{
+    if (capacity < 2)
+    {
+        std::ostringstream ostr;
+        ostr << "Invalid quantile sketch capacity " << capacity;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    clear();
+}
+
+void QuantileSketch::add(double value)
+{
+    if (value != value)
+    {
+        ++mNumNaN;
+        return;
+    }
+    addValid(&value, 1);
+}
+
+void QuantileSketch::addValid(const double* values, size_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    if (mCount == 0)
+    {
+        mMin = mMax = values[0];
+    }
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        mMin = std::min(mMin, values[ii]);
+        mMax = std::max(mMax, values[ii]);
+    }
+    mCount += size;
+
+    while (size > 0)
+    {
+        // Not held across compact(), which may add levels
+        std::vector<double>& bottom = mLevels[0];
+        const size_t count = std::min(size, mCapacity - bottom.size());
+        bottom.insert(bottom.end(), values, values + count);
+        values += count;
+        size -= count;
+        if (bottom.size() >= mCapacity)
+        {
+            compact(0);
+        }
+    }
+}
+
+void QuantileSketch::compact(size_t level)
+{
+    for (; level < mLevels.size() && mLevels[level].size() >= mCapacity;
+         ++level)
+    {
+        if (level + 1 == mLevels.size())
+        {
+            mLevels.push_back(std::vector<double>());
+            mLevels.back().reserve(mCapacity);
+            mNumCompactions.push_back(0);
+        }
+
+        std::vector<double>& values = mLevels[level];
+        std::vector<double>& next = mLevels[level + 1];
+        std::sort(values.begin(), values.end());
+
+        // With an odd number of values the largest stays behind
+        const size_t offset = mNumCompactions[level]++ % 2;
+        const size_t numPairs = values.size() / 2;
+        for (size_t ii = 0; ii < numPairs; ++ii)
+        {
+            next.push_back(values[2 * ii + offset]);
+        }
+        if (values.size() % 2 == 0)
+        {
+            values.clear();
+        }
+        else
+        {
+            values[0] = values.back();
+            values.resize(1);
+        }
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+    if (other.mCount == 0)
+    {
+        mNumNaN += other.mNumNaN;
+        return;
+    }
+
+    mMin = (mCount == 0) ? other.mMin : std::min(mMin, other.mMin);
+    mMax = (mCount == 0) ? other.mMax : std::max(mMax, other.mMax);
+    mCount += other.mCount;
+    mNumNaN += other.mNumNaN;
+
+    while (mLevels.size() < other.mLevels.size())
+    {
+        mLevels.push_back(std::vector<double>());
+        mNumCompactions.push_back(0);
+    }
+    for (size_t level = 0; level < other.mLevels.size(); ++level)
+    {
+        mLevels[level].insert(mLevels[level].end(),
+                              other.mLevels[level].begin(),
+                              other.mLevels[level].end());
+    }
+
+    // Compacting a level only adds to the ones above it
+    for (size_t level = 0; level < mLevels.size(); ++level)
+    {
+        compact(level);
+    }
+}
+
+void QuantileSketch::clear()
+{
+    mLevels.assign(1, std::vector<double>());
+    mLevels[0].reserve(mCapacity);
+    mNumCompactions.assign(1, 0);
+    mCount = 0;
+    mNumNaN = 0;
+    mMin = mMax = 0.0;
+}
+
+size_t QuantileSketch::getNumRetained() const
+{
+    size_t numRetained = 0;
+    for (size_t level = 0; level < mLevels.size(); ++level)
+    {
+        numRetained += mLevels[level].size();
+    }
+    return numRetained;
+}
+
+double QuantileSketch::getQuantile(double fraction) const
+{
+    if (!(fraction >= 0.0 && fraction <= 1.0))
+    {
+        std::ostringstream ostr;
+        ostr << "Quantile " << fraction << " is not in [0, 1]";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    if (mCount == 0)
+    {
+        throw except::Exception(Ctxt("Quantile sketch has no values"));
+    }
+    if (fraction == 0.0)
+    {
+        return mMin;
+    }
+    if (fraction == 1.0)
+    {
+        return mMax;
+    }
+
+    // Each value with the number of inputs it stands for
+    std::vector<std::pair<double, sys::Uint64_T> > weighted;
+    weighted.reserve(getNumRetained());
+    for (size_t level = 0; level < mLevels.size(); ++level)
+    {
+        const sys::Uint64_T weight = static_cast<sys::Uint64_T>(1) << level;
+        for (size_t ii = 0; ii < mLevels[level].size(); ++ii)
+        {
+            weighted.push_back(std::make_pair(mLevels[level][ii], weight));
+        }
+    }
+    std::sort(weighted.begin(), weighted.end());
+
+    // The value whose ranks include the target rank
+    const double target = fraction * (mCount - 1);
+    sys::Uint64_T cumulative = 0;
+    for (size_t ii = 0; ii < weighted.size(); ++ii)
+    {
+        cumulative += weighted[ii].second;
+        if (target < cumulative)
+        {
+            return weighted[ii].first;
+        }
+    }
+    return mMax;
+}
+}
+}
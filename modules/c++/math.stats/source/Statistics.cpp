@@ -0,0 +1,206 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <limits>
+
+#include <math/stats/Statistics.h>
+
+namespace
+{
+/*
+ * Sums, minima and maxima are kept in this many independent lanes.
+ * Floating point reductions can't be reordered into vector lanes by the
+ * compiler, but lanes written out like this are vectorized.  Fewer lanes
+ * tend to get fully unrolled instead.
+ */
+const size_t NUM_LANES = 32;
+
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+}
+
+namespace math
+{
+namespace stats
+{
+Statistics::Statistics()
+{
+    clear();
+}
+
+void Statistics::add(double value)
+{
+    if (value != value)
+    {
+        ++mNumNaN;
+        return;
+    }
+    addValid(&value, 1);
+}
+
+void Statistics::addValid(const double* values, size_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    const size_t laneSize = size - size % NUM_LANES;
+    double sum[NUM_LANES];
+    double min[NUM_LANES];
+    double max[NUM_LANES];
+    for (size_t jj = 0; jj < NUM_LANES; ++jj)
+    {
+        sum[jj] = 0.0;
+        min[jj] = max[jj] = values[0];
+    }
+    for (size_t ii = 0; ii < laneSize; ii += NUM_LANES)
+    {
+        for (size_t jj = 0; jj < NUM_LANES; ++jj)
+        {
+            const double value = values[ii + jj];
+            sum[jj] += value;
+            min[jj] = (value < min[jj]) ? value : min[jj];
+            max[jj] = (value > max[jj]) ? value : max[jj];
+        }
+    }
+    for (size_t ii = laneSize; ii < size; ++ii)
+    {
+        const double value = values[ii];
+        sum[0] += value;
+        min[0] = (value < min[0]) ? value : min[0];
+        max[0] = (value > max[0]) ? value : max[0];
+    }
+
+    double blockSum = 0.0;
+    double blockMin = min[0];
+    double blockMax = max[0];
+    for (size_t jj = 0; jj < NUM_LANES; ++jj)
+    {
+        blockSum += sum[jj];
+        blockMin = std::min(blockMin, min[jj]);
+        blockMax = std::max(blockMax, max[jj]);
+    }
+    const double blockMean = blockSum / size;
+
+    // Second pass, about the block's own mean
+    for (size_t jj = 0; jj < NUM_LANES; ++jj)
+    {
+        sum[jj] = 0.0;
+    }
+    for (size_t ii = 0; ii < laneSize; ii += NUM_LANES)
+    {
+        for (size_t jj = 0; jj < NUM_LANES; ++jj)
+        {
+            const double deviation = values[ii + jj] - blockMean;
+            sum[jj] += deviation * deviation;
+        }
+    }
+    for (size_t ii = laneSize; ii < size; ++ii)
+    {
+        const double deviation = values[ii] - blockMean;
+        sum[0] += deviation * deviation;
+    }
+    double blockSumSquares = 0.0;
+    for (size_t jj = 0; jj < NUM_LANES; ++jj)
+    {
+        blockSumSquares += sum[jj];
+    }
+
+    merge(size, blockMean, blockSumSquares, blockMin, blockMax);
+}
+
+void Statistics::merge(const Statistics& other)
+{
+    mNumNaN += other.mNumNaN;
+    merge(other.mCount, other.mMean, other.mSumSquares,
+          other.mMin, other.mMax);
+}
+
+void Statistics::merge(sys::Uint64_T count, double mean, double sumSquares,
+                       double min, double max)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (mCount == 0)
+    {
+        mCount = count;
+        mMean = mean;
+        mSumSquares = sumSquares;
+        mMin = min;
+        mMax = max;
+        return;
+    }
+
+    const double total = static_cast<double>(mCount + count);
+    const double weight = count / total;
+    const double delta = mean - mMean;
+    mMean += delta * weight;
+    mSumSquares += sumSquares + delta * delta * mCount * weight;
+    mCount += count;
+    mMin = std::min(mMin, min);
+    mMax = std::max(mMax, max);
+}
+
+void Statistics::clear()
+{
+    mCount = 0;
+    mNumNaN = 0;
+    mMean = 0.0;
+    mSumSquares = 0.0;
+    mMin = NaN;
+    mMax = NaN;
+}
+
+double Statistics::getMin() const
+{
+    return mMin;
+}
+
+double Statistics::getMax() const
+{
+    return mMax;
+}
+
+double Statistics::getMean() const
+{
+    return (mCount == 0) ? NaN : mMean;
+}
+
+double Statistics::getVariance() const
+{
+    return (mCount == 0) ? NaN : mSumSquares / mCount;
+}
+
+double Statistics::getSampleVariance() const
+{
+    return (mCount < 2) ? NaN : mSumSquares / (mCount - 1);
+}
+
+double Statistics::getStandardDeviation() const
+{
+    return std::sqrt(getVariance());
+}
+}
+}
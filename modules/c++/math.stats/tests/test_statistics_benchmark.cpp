@@ -0,0 +1,149 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Compares the accumulators against the separate passes tools tend to
+    write: one for the minimum and maximum, one for the mean, one for the
+    variance, and a sort for the median.
+
+    usage: test_statistics_benchmark [size] [numThreads]
+        size: number of float values (default 10000000)
+        numThreads: threads for math::stats::accumulate() (default 1)
+
+    Throughput is reported in millions of values per second.
+*/
+
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <math/stats/Accumulate.h>
+#include <math/stats/Histogram.h>
+#include <math/stats/QuantileSketch.h>
+#include <math/stats/Statistics.h>
+#include <str/Convert.h>
+
+namespace
+{
+void report(const std::string& name, size_t size, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(1) << size / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t size =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 10000000;
+        const size_t numThreads =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 1;
+
+        std::vector<float> values(size);
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            values[ii] = static_cast<float>(1000.0 * rand() / RAND_MAX);
+        }
+        const mem::BufferView<const float> buffer(&values[0], size);
+
+        std::cout << size << " values, " << numThreads
+                  << " thread(s) (million values/s)\n\n";
+
+        sys::RealTimeStopWatch watch;
+        watch.start();
+        const float min = *std::min_element(values.begin(), values.end());
+        const float max = *std::max_element(values.begin(), values.end());
+        double sum = 0.0;
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            sum += values[ii];
+        }
+        const double mean = sum / size;
+        double sumSquares = 0.0;
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            sumSquares += (values[ii] - mean) * (values[ii] - mean);
+        }
+        report("separate passes", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::stats::Statistics stats;
+        stats.add(&values[0], size);
+        report("Statistics", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::stats::Statistics threadedStats;
+        math::stats::accumulate(buffer, threadedStats, numThreads);
+        report("accumulate Statistics", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::stats::Histogram histogram(0.0, 1000.0, 1000);
+        histogram.add(&values[0], size);
+        report("Histogram", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        std::vector<float> sorted(values);
+        std::nth_element(sorted.begin(), sorted.begin() + size / 2,
+                         sorted.end());
+        const float median = sorted[size / 2];
+        report("nth_element median", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::stats::QuantileSketch sketch;
+        sketch.add(&values[0], size);
+        report("QuantileSketch", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::stats::QuantileSketch threadedSketch;
+        math::stats::accumulate(buffer, threadedSketch, numThreads);
+        report("accumulate QuantileSketch", size, watch.stop());
+
+        std::cout << "\nmin " << min << " / " << stats.getMin()
+                  << ", max " << max << " / " << stats.getMax()
+                  << "\nmean " << mean << " / " << stats.getMean()
+                  << ", variance " << sumSquares / size << " / "
+                  << stats.getVariance()
+                  << "\nmedian " << median << " / "
+                  << histogram.getQuantile(0.5) << " / "
+                  << sketch.getQuantile(0.5) << std::endl;
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TestCase.h"
+#include <stdlib.h>
+#include <limits>
+#include <vector>
+
+#include <math/stats/Histogram.h>
+
+namespace
+{
+TEST_CASE(testHistogram)
+{
+    math::stats::Histogram histogram(0.0, 10.0, 5);
+    TEST_ASSERT_EQ(histogram.getNumBins(), static_cast<size_t>(5));
+    TEST_ASSERT_ALMOST_EQ(histogram.getBinWidth(), 2.0);
+    TEST_ASSERT_ALMOST_EQ(histogram.getBinStart(3), 6.0);
+    TEST_ASSERT_EQ(histogram.getBinStart(5), 10.0);
+
+    const double inf = std::numeric_limits<double>::infinity();
+    const double values[] = {
+        -inf, -1.0, -1e-300, 0.0, 1.99, 2.0, 5.0, 9.99, 10.0, 1e300, inf,
+        std::numeric_limits<double>::quiet_NaN() };
+    histogram.add(values, sizeof(values) / sizeof(values[0]));
+
+    TEST_ASSERT_EQ(histogram.getUnderflowCount(),
+                   static_cast<sys::Uint64_T>(3));
+    TEST_ASSERT_EQ(histogram.getCount(0), static_cast<sys::Uint64_T>(2));
+    TEST_ASSERT_EQ(histogram.getCount(1), static_cast<sys::Uint64_T>(1));
+    TEST_ASSERT_EQ(histogram.getCount(2), static_cast<sys::Uint64_T>(1));
+    TEST_ASSERT_EQ(histogram.getCount(3), static_cast<sys::Uint64_T>(0));
+    TEST_ASSERT_EQ(histogram.getCount(4), static_cast<sys::Uint64_T>(1));
+    TEST_ASSERT_EQ(histogram.getOverflowCount(),
+                   static_cast<sys::Uint64_T>(3));
+    TEST_ASSERT_EQ(histogram.getNumNaN(), static_cast<sys::Uint64_T>(1));
+    TEST_ASSERT_EQ(histogram.getTotalCount(),
+                   static_cast<sys::Uint64_T>(11));
+    TEST_EXCEPTION(histogram.getCount(5));
+
+    // One at a time, merged
+    math::stats::Histogram single(0.0, 10.0, 5);
+    for (size_t ii = 0; ii < sizeof(values) / sizeof(values[0]); ++ii)
+    {
+        single.add(values[ii]);
+    }
+    histogram.merge(single);
+    TEST_ASSERT_EQ(histogram.getCount(0), static_cast<sys::Uint64_T>(4));
+    TEST_ASSERT_EQ(histogram.getOverflowCount(),
+                   static_cast<sys::Uint64_T>(6));
+    TEST_ASSERT_EQ(histogram.getNumNaN(), static_cast<sys::Uint64_T>(2));
+
+    TEST_EXCEPTION(histogram.merge(math::stats::Histogram(0.0, 10.0, 6)));
+
+    histogram.clear();
+    TEST_ASSERT_EQ(histogram.getTotalCount(), static_cast<sys::Uint64_T>(0));
+    TEST_EXCEPTION(histogram.getQuantile(0.5));
+
+    TEST_EXCEPTION(math::stats::Histogram(1.0, 1.0, 5));
+    TEST_EXCEPTION(math::stats::Histogram(0.0, inf, 5));
+    TEST_EXCEPTION(math::stats::Histogram(0.0, 1.0, 0));
+}
+
+TEST_CASE(testHistogramQuantile)
+{
+    // Uniform over [0, 100)
+    math::stats::Histogram histogram(0.0, 100.0, 1000);
+    std::vector<double> values(100000);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        values[ii] = ii * 0.001;
+    }
+    histogram.add(&values[0], values.size());
+
+    TEST_ASSERT_ALMOST_EQ_EPS(histogram.getQuantile(0.0), 0.0, 1e-9);
+    TEST_ASSERT_ALMOST_EQ_EPS(histogram.getQuantile(0.25), 25.0, 1e-9);
+    TEST_ASSERT_ALMOST_EQ_EPS(histogram.getQuantile(0.5), 50.0, 1e-9);
+    TEST_ASSERT_ALMOST_EQ_EPS(histogram.getQuantile(1.0), 100.0, 1e-9);
+    TEST_EXCEPTION(histogram.getQuantile(1.5));
+
+    // Quantiles among the underflow and overflow values are clamped
+    const double outside[] = { -5.0, -5.0, 200.0 };
+    math::stats::Histogram narrow(0.0, 1.0, 10);
+    narrow.add(outside, 3);
+    TEST_ASSERT_EQ(narrow.getQuantile(0.1), 0.0);
+    TEST_ASSERT_EQ(narrow.getQuantile(0.9), 1.0);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testHistogram);
+    TEST_CHECK(testHistogramQuantile);
+    return 0;
+}
@@ -0,0 +1,121 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TestCase.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <math/stats/QuantileSketch.h>
+
+namespace
+{
+// How far, as a fraction of the count, the rank of 'value' in the sorted
+// values is from 'fraction'
+double rankError(const std::vector<double>& sorted, double value,
+                 double fraction)
+{
+    const size_t below = std::lower_bound(sorted.begin(), sorted.end(),
+                                          value) - sorted.begin();
+    const size_t notAbove = std::upper_bound(sorted.begin(), sorted.end(),
+                                             value) - sorted.begin();
+    const double target = fraction * (sorted.size() - 1);
+    if (target >= below && target < notAbove)
+    {
+        return 0.0;
+    }
+    return std::min(std::abs(target - below),
+                    std::abs(target - (notAbove - 1))) / sorted.size();
+}
+
+TEST_CASE(testExact)
+{
+    // Below the capacity every value is kept
+    math::stats::QuantileSketch sketch(16);
+    const double values[] = { 5, 3, std::numeric_limits<double>::quiet_NaN(),
+                              9, 1, 7 };
+    sketch.add(values, 6);
+    TEST_ASSERT_EQ(sketch.getCount(), static_cast<sys::Uint64_T>(5));
+    TEST_ASSERT_EQ(sketch.getNumNaN(), static_cast<sys::Uint64_T>(1));
+    TEST_ASSERT_EQ(sketch.getNumRetained(), static_cast<size_t>(5));
+    TEST_ASSERT_EQ(sketch.getQuantile(0.0), 1.0);
+    TEST_ASSERT_EQ(sketch.getQuantile(0.5), 5.0);
+    TEST_ASSERT_EQ(sketch.getQuantile(0.75), 7.0);
+    TEST_ASSERT_EQ(sketch.getQuantile(1.0), 9.0);
+    TEST_EXCEPTION(sketch.getQuantile(-0.1));
+
+    sketch.clear();
+    TEST_EXCEPTION(sketch.getQuantile(0.5));
+    TEST_EXCEPTION(math::stats::QuantileSketch(1));
+}
+
+TEST_CASE(testApproximate)
+{
+    srand(1);
+    std::vector<double> values(1000000);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        // Skewed, so that quantiles aren't evenly spaced
+        const double uniform = static_cast<double>(rand()) / RAND_MAX;
+        values[ii] = uniform * uniform * 1000.0;
+    }
+
+    math::stats::QuantileSketch sketch;
+    sketch.add(&values[0], values.size());
+
+    // Split into pieces and merged
+    math::stats::QuantileSketch merged;
+    for (size_t start = 0; start < values.size(); start += 100000)
+    {
+        math::stats::QuantileSketch piece;
+        for (size_t ii = start; ii < start + 100000; ++ii)
+        {
+            piece.add(values[ii]);
+        }
+        merged.merge(piece);
+    }
+    TEST_ASSERT_EQ(sketch.getCount(), values.size());
+    TEST_ASSERT_EQ(merged.getCount(), values.size());
+    TEST_ASSERT_LESSER(sketch.getNumRetained(), static_cast<size_t>(20000));
+    TEST_ASSERT_LESSER(merged.getNumRetained(), static_cast<size_t>(20000));
+
+    std::vector<double> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    TEST_ASSERT_EQ(sketch.getQuantile(0.0), sorted.front());
+    TEST_ASSERT_EQ(sketch.getQuantile(1.0), sorted.back());
+    for (double fraction = 0.01; fraction < 1.0; fraction += 0.049)
+    {
+        TEST_ASSERT_LESSER(rankError(sorted, sketch.getQuantile(fraction),
+                                     fraction), 0.01);
+        TEST_ASSERT_LESSER(rankError(sorted, merged.getQuantile(fraction),
+                                     fraction), 0.01);
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testExact);
+    TEST_CHECK(testApproximate);
+    return 0;
+}
@@ -0,0 +1,216 @@
+/* =========================================================================
+ * This file is part of math.stats-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * math.stats-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TestCase.h"
+#include <stdlib.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <math/stats/Accumulate.h>
+#include <math/stats/Histogram.h>
+#include <math/stats/Statistics.h>
+
+namespace
+{
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+// Values around 'mean', with a NaN every 1000 values
+std::vector<float> randomValues(size_t size, double mean)
+{
+    std::vector<float> values(size);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        values[ii] = static_cast<float>(
+                mean + 20.0 * rand() / RAND_MAX - 10.0);
+    }
+    for (size_t ii = 500; ii < size; ii += 1000)
+    {
+        values[ii] = std::numeric_limits<float>::quiet_NaN();
+    }
+    return values;
+}
+
+// Two passes in long double
+void checkAgainstTwoPass(const std::string& testName,
+                         const math::stats::Statistics& stats,
+                         const std::vector<float>& values)
+{
+    long double sum = 0;
+    size_t count = 0;
+    double min = std::numeric_limits<double>::max();
+    double max = -min;
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        if (values[ii] == values[ii])
+        {
+            sum += values[ii];
+            ++count;
+            min = std::min<double>(min, values[ii]);
+            max = std::max<double>(max, values[ii]);
+        }
+    }
+    const long double mean = sum / count;
+    long double sumSquares = 0;
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        if (values[ii] == values[ii])
+        {
+            sumSquares += (values[ii] - mean) * (values[ii] - mean);
+        }
+    }
+
+    TEST_ASSERT_EQ(stats.getCount(), count);
+    TEST_ASSERT_EQ(stats.getNumNaN(), values.size() - count);
+    TEST_ASSERT_EQ(stats.getMin(), min);
+    TEST_ASSERT_EQ(stats.getMax(), max);
+    TEST_ASSERT_ALMOST_EQ_EPS(stats.getMean(), static_cast<double>(mean),
+                              1e-12 * std::abs(static_cast<double>(mean)));
+    const double variance = static_cast<double>(sumSquares / count);
+    TEST_ASSERT_ALMOST_EQ_EPS(stats.getVariance(), variance,
+                              1e-9 * variance);
+}
+
+TEST_CASE(testStatistics)
+{
+    math::stats::Statistics stats;
+    TEST_ASSERT_EQ(stats.getCount(), static_cast<sys::Uint64_T>(0));
+    TEST_ASSERT_TRUE(std::isnan(stats.getMin()));
+    TEST_ASSERT_TRUE(std::isnan(stats.getMean()));
+    TEST_ASSERT_TRUE(std::isnan(stats.getVariance()));
+
+    const double values[] = { 4, NaN, 1, 10, 7, 2, 3, 5, 6, 9, 8 };
+    stats.add(values, 11);
+    TEST_ASSERT_EQ(stats.getCount(), static_cast<sys::Uint64_T>(10));
+    TEST_ASSERT_EQ(stats.getNumNaN(), static_cast<sys::Uint64_T>(1));
+    TEST_ASSERT_EQ(stats.getMin(), 1.0);
+    TEST_ASSERT_EQ(stats.getMax(), 10.0);
+    TEST_ASSERT_ALMOST_EQ(stats.getMean(), 5.5);
+    TEST_ASSERT_ALMOST_EQ(stats.getVariance(), 8.25);
+    TEST_ASSERT_ALMOST_EQ(stats.getSampleVariance(), 82.5 / 9);
+    TEST_ASSERT_ALMOST_EQ(stats.getStandardDeviation(), std::sqrt(8.25));
+
+    // One at a time
+    math::stats::Statistics single;
+    for (size_t ii = 0; ii < 11; ++ii)
+    {
+        single.add(values[ii]);
+    }
+    TEST_ASSERT_EQ(single.getCount(), stats.getCount());
+    TEST_ASSERT_EQ(single.getNumNaN(), stats.getNumNaN());
+    TEST_ASSERT_ALMOST_EQ(single.getMean(), stats.getMean());
+    TEST_ASSERT_ALMOST_EQ(single.getVariance(), stats.getVariance());
+
+    stats.clear();
+    TEST_ASSERT_EQ(stats.getCount(), static_cast<sys::Uint64_T>(0));
+    TEST_ASSERT_EQ(stats.getNumNaN(), static_cast<sys::Uint64_T>(0));
+}
+
+TEST_CASE(testStability)
+{
+    // A large mean and a small spread, which defeats sum of squares
+    srand(1);
+    const std::vector<float> values = randomValues(100003, 1e6);
+    math::stats::Statistics stats;
+    stats.add(&values[0], values.size());
+    checkAgainstTwoPass(testName, stats, values);
+
+    // In pieces that don't line up with the blocks, merged
+    math::stats::Statistics merged;
+    for (size_t start = 0; start < values.size(); start += 777)
+    {
+        math::stats::Statistics piece;
+        piece.add(&values[start], std::min<size_t>(777,
+                                                   values.size() - start));
+        merged.merge(piece);
+    }
+    checkAgainstTwoPass(testName, merged, values);
+}
+
+TEST_CASE(testAccumulate)
+{
+    srand(2);
+    const types::RowCol<size_t> dims(700, 500);
+    const std::vector<float> image = randomValues(dims.area(), 100.0);
+    const mem::BufferView<const float> buffer(&image[0], image.size());
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        math::stats::Statistics stats;
+        math::stats::accumulate(buffer, stats, numThreads);
+        checkAgainstTwoPass(testName, stats, image);
+
+        math::stats::Histogram histogram(90.0, 110.0, 64);
+        math::stats::accumulate(buffer, histogram, numThreads);
+        math::stats::Histogram expected(90.0, 110.0, 64);
+        expected.add(&image[0], image.size());
+        for (size_t bin = 0; bin < 64; ++bin)
+        {
+            TEST_ASSERT_EQ(histogram.getCount(bin), expected.getCount(bin));
+        }
+        TEST_ASSERT_EQ(histogram.getNumNaN(), expected.getNumNaN());
+    }
+
+    // Only the pixels inside a triangle
+    std::vector<types::RowCol<double> > points;
+    points.push_back(types::RowCol<double>(10.0, 20.0));
+    points.push_back(types::RowCol<double>(650.0, 60.0));
+    points.push_back(types::RowCol<double>(300.0, 480.0));
+    const polygon::PolygonMask mask(points, dims);
+
+    std::vector<float> inside;
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            if (mask.isInPolygon(row, col))
+            {
+                inside.push_back(image[row * dims.col + col]);
+            }
+        }
+    }
+    TEST_ASSERT_GREATER(inside.size(), static_cast<size_t>(100000));
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        math::stats::Statistics stats;
+        math::stats::accumulate(buffer, dims, mask, stats, numThreads);
+        checkAgainstTwoPass(testName, stats, inside);
+    }
+
+    math::stats::Statistics stats;
+    const polygon::PolygonMask wrongSize(
+            polygon::PolygonMask::MARK_ALL_TRUE,
+            types::RowCol<size_t>(dims.row, dims.col + 1));
+    TEST_EXCEPTION(math::stats::accumulate(buffer, dims, wrongSize, stats));
+    const mem::BufferView<const float> tooSmall(&image[0], 100);
+    TEST_EXCEPTION(math::stats::accumulate(tooSmall, dims, mask, stats));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testStatistics);
+    TEST_CHECK(testStability);
+    TEST_CHECK(testAccumulate);
+    return 0;
+}
@@ -26,6 +26,8 @@
 #include <algorithm>
 #include <vector>
 #include <limits>
+#include <string>
+#include <exception>
 
 #include <sys/Conf.h>
 
@@ -35,6 +37,8 @@
 
 #include <types/RowCol.h>
 
+#include <math/detail/RunChunks.h>
+
 namespace math
 {
 /*!
@@ -55,6 +59,123 @@ struct MustBeSignedType<true>
     }
 };
 
+namespace detail
+{
+/*!
+ *  Fewest points worth handing to another thread when computing a hull
+ *  in parallel
+ */
+const size_t MIN_HULL_POINTS_PER_THREAD = 4096;
+
+/*!
+ *  \returns > 0 if 'point' is to the left of the line from 'start' to
+ *           'end', treating col as x and row as y, < 0 if it is to the
+ *           right, and 0 if it is on the line
+ */
+template <typename T>
+T cross(const types::RowCol<T>& start,
+        const types::RowCol<T>& end,
+        const types::RowCol<T>& point)
+{
+    return (end.col - start.col) * (point.row - start.row) -
+           (end.row - start.row) * (point.col - start.col);
+}
+
+/*!
+ *  Akl-Toussaint heuristic: appends to 'survivors' the points that are not
+ *  strictly inside the octagon formed by the points that are extreme in
+ *  col, row, col + row and col - row.  Points inside the octagon cannot be
+ *  hull vertices, and for most inputs that is nearly all of them.
+ *
+ *  \param points Input points
+ *  \param numPoints Number of input points
+ *  \param survivors [output] Points that may be on the hull are appended
+ */
+template <typename T>
+void cullInteriorPoints(const types::RowCol<T>* points,
+                        size_t numPoints,
+                        std::vector<types::RowCol<T> >& survivors)
+{
+    if (numPoints == 0)
+    {
+        return;
+    }
+
+    // Counterclockwise (for col right and row up) from the greatest col:
+    // col, col + row, row, row - col, -col, -(col + row), -row, col - row
+    size_t extremes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    T maxima[8];
+    maxima[0] = points[0].col;
+    maxima[1] = points[0].col + points[0].row;
+    maxima[2] = points[0].row;
+    maxima[3] = points[0].row - points[0].col;
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        maxima[ii + 4] = -maxima[ii];
+    }
+
+    for (size_t ii = 1; ii < numPoints; ++ii)
+    {
+        const T keys[4] = { points[ii].col,
+                            points[ii].col + points[ii].row,
+                            points[ii].row,
+                            points[ii].row - points[ii].col };
+        for (size_t jj = 0; jj < 4; ++jj)
+        {
+            if (keys[jj] > maxima[jj])
+            {
+                maxima[jj] = keys[jj];
+                extremes[jj] = ii;
+            }
+            else if (-keys[jj] > maxima[jj + 4])
+            {
+                maxima[jj + 4] = -keys[jj];
+                extremes[jj + 4] = ii;
+            }
+        }
+    }
+
+    // Drop repeated corners so that every edge has a direction
+    types::RowCol<T> octagon[8];
+    size_t numCorners = 0;
+    for (size_t ii = 0; ii < 8; ++ii)
+    {
+        const types::RowCol<T>& corner(points[extremes[ii]]);
+        if (numCorners == 0 || !(corner == octagon[numCorners - 1]))
+        {
+            octagon[numCorners++] = corner;
+        }
+    }
+    while (numCorners > 1 && octagon[numCorners - 1] == octagon[0])
+    {
+        --numCorners;
+    }
+
+    // Fewer than three corners enclose nothing.  Collinear corners don't
+    // either, since no point is strictly left of both directions along a
+    // line.
+    if (numCorners < 3)
+    {
+        survivors.insert(survivors.end(), points, points + numPoints);
+        return;
+    }
+
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        const types::RowCol<T>& point(points[ii]);
+        for (size_t jj = 0; jj < numCorners; ++jj)
+        {
+            const size_t next = (jj + 1 == numCorners) ? 0 : jj + 1;
+            if (cross(octagon[jj], octagon[next], point) <= 0)
+            {
+                survivors.push_back(point);
+                break;
+            }
+        }
+    }
+}
+}
+
 /*!
  *  \class ConvexHull
  *  \brief Uses the Graham scan algorithm to calculate the convex hull of
@@ -85,12 +206,14 @@ public:
      *  As per convention, the last point will always be the first point
      *  repeated.
      *
-     *  \param rawPoints Input points.  Destructive to input (sorts in
-     *                   place to avoid a copy).
+     *  Points that are inside the octagon of extreme points are culled
+     *  before sorting; see detail::cullInteriorPoints().
+     *
+     *  \param rawPoints Input points
      *  \param convexHull [output] Convex hull points
      *
      */
-    ConvexHull(std::vector<RowCol>& rawPoints,
+    ConvexHull(const std::vector<RowCol>& rawPoints,
                std::vector<RowCol>& convexHull)
     {
         if (rawPoints.size() < 2)
@@ -104,7 +227,10 @@ public:
         // Enforce (at compile time) that T is a signed type
         MustBeSignedType<std::numeric_limits<T>::is_signed>::confirm();
 
-        partitionPoints(rawPoints);
+        std::vector<RowCol> points;
+        detail::cullInteriorPoints(&rawPoints[0], rawPoints.size(), points);
+
+        partitionPoints(points);
         buildHull(convexHull);
     }
 
@@ -204,7 +330,7 @@ private:
      *
      * \param factor 1 for the lower hull, -1 for the upper hull
      * \param input Sorted list of points in one of the two halfs.
-     *              This vector will be destroyed.
+     *              The right point is appended to it.
      * \param output [output] The points in the corresponding convex hull
      *
      */
@@ -222,14 +348,13 @@ private:
         output.push_back(mLeft);
 
         // The construction loop runs until the input is exhausted
-        while (!input.empty())
+        for (size_t ii = 0; ii < input.size(); ++ii)
         {
             // Repeatedly add the leftmost point to the hull, then test to
             // see if a convexity violation has occurred.  If it has, fix
             // things up by removing the next-to-last point in the output
             // sequence until convexity is restored.
-            output.push_back(input.front());
-            input.erase(input.begin());
+            output.push_back(input[ii]);
 
             while (output.size() >= 3)
             {
@@ -262,8 +387,6 @@ private:
         // this information to the building routine as the first
         // parameter, which is either -1 or 1.
 
-        /// @note  This destroys 'mLowerPartitionPoints' and
-        ///        'mUpperPartitionPoints
         std::vector<RowCol> lowerHull;
         buildHalfHull(1, mLowerPartitionPoints, lowerHull);
 
@@ -300,7 +423,253 @@ private:
     std::vector<RowCol>  mLowerPartitionPoints;
     std::vector<RowCol>  mUpperPartitionPoints;
 };
+
+namespace detail
+{
+/*!
+ *  \class PartialHulls
+ *  \brief Reduces each chunk of the input to the vertices of its convex
+ *         hull, for runChunks()
+ *
+ *  Points that are not vertices of a chunk's hull cannot be vertices of
+ *  the hull of all of the chunks.
+ */
+template <typename T>
+class PartialHulls
+{
+public:
+    PartialHulls(const types::RowCol<T>* points,
+                 std::vector<std::vector<types::RowCol<T> > >& vertices,
+                 std::vector<std::string>& errors) :
+        mPoints(points),
+        mVertices(vertices),
+        mErrors(errors)
+    {
+    }
+
+    void operator()(size_t chunk, size_t start, size_t end) const
+    {
+        // Nothing may escape a thread, so failures are handed back
+        std::vector<types::RowCol<T> >& vertices = mVertices[chunk];
+        try
+        {
+            vertices.clear();
+            if (end - start < 2)
+            {
+                vertices.assign(mPoints + start, mPoints + end);
+                return;
+            }
+
+            ConvexHull<T>(std::vector<types::RowCol<T> >(
+                                  mPoints + start, mPoints + end),
+                          vertices);
+            vertices.pop_back();
+        }
+        catch (const except::Exception& ex)
+        {
+            mErrors[chunk] = ex.getMessage();
+        }
+        catch (const std::exception& ex)
+        {
+            mErrors[chunk] = ex.what();
+        }
+    }
+
+private:
+    const types::RowCol<T>* const mPoints;
+    std::vector<std::vector<types::RowCol<T> > >& mVertices;
+    std::vector<std::string>& mErrors;
+};
+
+/*!
+ *  Splits the points into one chunk per thread, computes the hull of each
+ *  chunk on its own thread, and appends every chunk's hull vertices to
+ *  'candidates'.  The hull of 'candidates' is the hull of the points.
+ *
+ *  \param points Input points
+ *  \param numPoints Number of input points
+ *  \param numThreads Number of threads to use
+ *  \param candidates [output] Possible hull vertices are appended
+ */
+template <typename T>
+void appendPartialHulls(const types::RowCol<T>* points,
+                        size_t numPoints,
+                        size_t numThreads,
+                        std::vector<types::RowCol<T> >& candidates)
+{
+    const size_t numChunks = getNumChunks(numPoints, numThreads,
+                                          MIN_HULL_POINTS_PER_THREAD);
+    if (numChunks == 1)
+    {
+        cullInteriorPoints(points, numPoints, candidates);
+        return;
+    }
+
+    std::vector<std::vector<types::RowCol<T> > > vertices(numChunks);
+    std::vector<std::string> errors(numChunks);
+    runChunks(numPoints, numChunks,
+              PartialHulls<T>(points, vertices, errors));
+
+    for (size_t ii = 0; ii < numChunks; ++ii)
+    {
+        if (!errors[ii].empty())
+        {
+            throw except::Exception(Ctxt(errors[ii]));
+        }
+        candidates.insert(candidates.end(),
+                          vertices[ii].begin(),
+                          vertices[ii].end());
+    }
+}
+}
+
+/*!
+ *  Computes the same convex hull as ConvexHull, splitting the points
+ *  among several threads.  Each thread reduces its share of the points to
+ *  the vertices of their hull, and the hull of those vertices is the
+ *  result.
+ *
+ *  \param points Input points
+ *  \param convexHull [output] Convex hull points, with the first point
+ *                    repeated at the end
+ *  \param numThreads Number of threads to use.  Fewer are used when there
+ *                    are not detail::MIN_HULL_POINTS_PER_THREAD points for
+ *                    each.
+ */
+template <typename T>
+void convexHull(const std::vector<types::RowCol<T> >& points,
+                std::vector<types::RowCol<T> >& convexHull,
+                size_t numThreads = 1)
+{
+    if (points.size() < 2)
+    {
+        throw except::Exception(Ctxt(
+            "convexHull error: must use at least 2 input points but " +
+            str::toString(points.size()) + " were used"));
+    }
+
+    std::vector<types::RowCol<T> > candidates;
+    detail::appendPartialHulls(&points[0], points.size(), numThreads,
+                               candidates);
+    ConvexHull<T>(candidates, convexHull);
+}
+
+/*!
+ *  \class IncrementalConvexHull
+ *  \brief Maintains the convex hull of all of the points added so far
+ *
+ *  Only the current hull vertices are kept.  Adding a batch of B points
+ *  to a hull with H vertices culls the batch (see
+ *  detail::cullInteriorPoints()) and then rebuilds the hull from the
+ *  survivors and the H vertices, so points should be added in batches
+ *  rather than one at a time.
+ *
+ *  The hull is the one ConvexHull would compute from all of the points.
+ */
+template <typename T>
+class IncrementalConvexHull
+{
+public:
+    typedef types::RowCol<T> RowCol;
+
+    IncrementalConvexHull() :
+        mNumPoints(0)
+    {
+        // Enforce (at compile time) that T is a signed type
+        MustBeSignedType<std::numeric_limits<T>::is_signed>::confirm();
+    }
+
+    /*!
+     *  Adds a batch of points to the hull
+     *
+     *  \param points Points to add
+     *  \param numThreads Number of threads to use, as in convexHull()
+     */
+    void add(const std::vector<RowCol>& points, size_t numThreads = 1)
+    {
+        if (!points.empty())
+        {
+            add(&points[0], points.size(), numThreads);
+        }
+    }
+
+    /*!
+     *  Adds a batch of points to the hull
+     *
+     *  \param points Points to add
+     *  \param numPoints Number of points to add
+     *  \param numThreads Number of threads to use, as in convexHull()
+     */
+    void add(const RowCol* points, size_t numPoints, size_t numThreads = 1)
+    {
+        if (numPoints == 0)
+        {
+            return;
+        }
+
+        std::vector<RowCol> candidates(mVertices);
+        detail::appendPartialHulls(points, numPoints, numThreads,
+                                   candidates);
+        mNumPoints += numPoints;
+
+        if (candidates.size() < 2)
+        {
+            mVertices.swap(candidates);
+            return;
+        }
+
+        ConvexHull<T>(candidates, mVertices);
+        mVertices.pop_back();
+    }
+
+    //! \returns the number of points added since construction or clear()
+    size_t getNumPoints() const
+    {
+        return mNumPoints;
+    }
+
+    /*!
+     *  \returns the vertices of the current hull, without the first point
+     *           repeated at the end
+     */
+    const std::vector<RowCol>& getVertices() const
+    {
+        return mVertices;
+    }
+
+    /*!
+     *  Gets the current hull in the form ConvexHull produces
+     *
+     *  \param convexHull [output] Convex hull points, with the first point
+     *                    repeated at the end
+     *
+     *  \throws except::Exception if fewer than 2 points have been added
+     */
+    void getHull(std::vector<RowCol>& convexHull) const
+    {
+        if (mNumPoints < 2)
+        {
+            throw except::Exception(Ctxt(
+                "IncrementalConvexHull error: must add at least 2 points "
+                "but " + str::toString(mNumPoints) + " were added"));
+        }
+
+        convexHull.reserve(mVertices.size() + 1);
+        convexHull.assign(mVertices.begin(), mVertices.end());
+        convexHull.push_back(mVertices.front());
+    }
+
+    //! Forgets every point added so far
+    void clear()
+    {
+        mVertices.clear();
+        mNumPoints = 0;
+    }
+
+private:
+    std::vector<RowCol> mVertices;
+    size_t mNumPoints;
+};
 }
 
 #endif
-
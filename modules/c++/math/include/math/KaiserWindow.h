@@ -0,0 +1,118 @@
+/* =========================================================================
+ * This file is part of math-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * math-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_KAISER_WINDOW_H__
+#define __MATH_KAISER_WINDOW_H__
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <sys/Mutex.h>
+#include <mem/SharedPtr.h>
+
+namespace math
+{
+/*!
+ * Computes a Kaiser window
+ *
+ *     w[n] = I0(beta * sqrt(1 - (2n / (length - 1) - 1)^2)) / I0(beta)
+ *
+ * for n in [0, length), with I0 from the batch besselIOrderZero().  A
+ * window of length 1 is {1}.
+ *
+ * \param length Number of taps
+ * \param beta Shape parameter
+ * \param[out] window Holds the 'length' taps
+ */
+void kaiserWindow(size_t length, double beta, double* window);
+
+/*!
+ * \class KaiserWindowCache
+ * \brief Hands out Kaiser windows, computing each (length, beta) once
+ *
+ * The least recently requested windows are dropped once there are more
+ * than the maximum number of them.  Windows are shared, so one that has
+ * been dropped stays valid for as long as a caller holds it.
+ *
+ * All methods are thread-safe.
+ */
+class KaiserWindowCache
+{
+public:
+    typedef mem::SharedPtr<const std::vector<double> > Window;
+
+    //! Number of windows the cache holds by default
+    static const size_t DEFAULT_MAX_NUM_WINDOWS = 16;
+
+    /*!
+     * \param maxNumWindows Most windows to hold at once.  Must be at
+     *                      least 1.
+     */
+    explicit KaiserWindowCache(
+            size_t maxNumWindows = DEFAULT_MAX_NUM_WINDOWS);
+
+    /*!
+     * \param length Number of taps
+     * \param beta Shape parameter
+     *
+     * \returns the window from kaiserWindow(), computing it if it is not
+     *          in the cache
+     *
+     * \throws except::Exception if beta is NaN
+     */
+    Window get(size_t length, double beta);
+
+    //! \returns the number of windows in the cache
+    size_t size() const;
+
+    //! Drops every window from the cache
+    void clear();
+
+private:
+    typedef std::pair<size_t, double> Key;
+    typedef std::list<std::pair<Key, Window> > List;
+
+    KaiserWindowCache(const KaiserWindowCache& );
+    KaiserWindowCache& operator=(const KaiserWindowCache& );
+
+    const size_t mMaxNumWindows;
+
+    // Most recently requested first
+    List mWindows;
+    std::map<Key, List::iterator> mLookup;
+    mutable sys::Mutex mMutex;
+};
+
+/*!
+ * \param length Number of taps
+ * \param beta Shape parameter
+ *
+ * \returns the window from kaiserWindow(), from a process-wide
+ *          KaiserWindowCache
+ */
+KaiserWindowCache::Window getKaiserWindow(size_t length, double beta);
+}
+
+#endif
@@ -0,0 +1,218 @@
+/* =========================================================================
+ * This file is part of math-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2015, MDA Information Systems LLC
+ *
+ * math-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_QUANTIZE_H__
+#define __MATH_QUANTIZE_H__
+
+#include <stddef.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <math/detail/RunChunks.h>
+
+namespace math
+{
+namespace detail
+{
+//! Fewer values than this per thread aren't worth starting a thread for
+const size_t MIN_QUANTIZE_VALUES_PER_THREAD = 65536;
+
+/*!
+ *  The type quantize() does its arithmetic in.  It must represent every
+ *  value of the output type exactly, so float is only used for float
+ *  input and 8 and 16 bit output.
+ */
+template <typename InT, typename OutT>
+struct QuantizeWorkType
+{
+    typedef double Type;
+};
+
+template <>
+struct QuantizeWorkType<float, sys::Int8_T>
+{
+    typedef float Type;
+};
+
+template <>
+struct QuantizeWorkType<float, sys::Uint8_T>
+{
+    typedef float Type;
+};
+
+template <>
+struct QuantizeWorkType<float, sys::Int16_T>
+{
+    typedef float Type;
+};
+
+template <>
+struct QuantizeWorkType<float, sys::Uint16_T>
+{
+    typedef float Type;
+};
+
+/*!
+ *  What roundAndSaturate() adds before truncating.  math::round() does
+ *  the add in double, which is exact for float values; in float,
+ *  0.49999997f + 0.5f rounds up to 1.  Adding the float just below one
+ *  half instead gives math::round()'s answer for every float: halfway
+ *  cases still round up to the next integer, and nothing below them
+ *  reaches it.
+ */
+template <typename WorkT>
+inline WorkT roundingHalf()
+{
+    return static_cast<WorkT>(0.5);
+}
+
+template <>
+inline float roundingHalf<float>()
+{
+    return 0.49999997f;
+}
+
+/*!
+ *  Rounds half away from zero, as math::round() does, and saturates to
+ *  OutT's range.  NaN gives OutT's minimum.
+ *
+ *  Rounding comes first because compilers won't vectorize arithmetic on
+ *  the result of a floating point comparison.  It is exact wherever the
+ *  result isn't saturated, since OutT's range is well within WorkT's
+ *  integers.
+ */
+template <typename WorkT, typename OutT>
+inline OutT roundAndSaturate(WorkT value)
+{
+    const WorkT low = static_cast<WorkT>(std::numeric_limits<OutT>::min());
+    const WorkT high = static_cast<WorkT>(std::numeric_limits<OutT>::max());
+    const WorkT rounded = value + std::copysign(roundingHalf<WorkT>(), value);
+    WorkT clamped = (rounded > low) ? rounded : low;
+    clamped = (clamped < high) ? clamped : high;
+    return static_cast<OutT>(clamped);
+}
+
+template <typename InT, typename OutT>
+void quantize(const InT* in,
+              size_t size,
+              OutT* out,
+              double scale,
+              double offset,
+              OutT nanValue)
+{
+    typedef typename QuantizeWorkType<InT, OutT>::Type WorkT;
+    const WorkT workScale = static_cast<WorkT>(scale);
+    const WorkT workOffset = static_cast<WorkT>(offset);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        const WorkT value = static_cast<WorkT>(in[ii]) * workScale +
+                workOffset;
+        const OutT converted = roundAndSaturate<WorkT, OutT>(value);
+        out[ii] = (value == value) ? converted : nanValue;
+    }
+}
+
+/*!
+ *  \class QuantizeChunk
+ *  \brief Quantizes one chunk of the values, for runChunks()
+ */
+template <typename InT, typename OutT>
+class QuantizeChunk
+{
+public:
+    QuantizeChunk(const InT* in,
+                  OutT* out,
+                  double scale,
+                  double offset,
+                  OutT nanValue) :
+        mIn(in),
+        mOut(out),
+        mScale(scale),
+        mOffset(offset),
+        mNanValue(nanValue)
+    {
+    }
+
+    void operator()(size_t /*chunk*/, size_t start, size_t end) const
+    {
+        quantize(mIn + start, end - start, mOut + start, mScale, mOffset,
+                 mNanValue);
+    }
+
+private:
+    const InT* const mIn;
+    OutT* const mOut;
+    const double mScale;
+    const double mOffset;
+    const OutT mNanValue;
+};
+}
+
+/*!
+ *  Converts floating point values to integers in one pass,
+ *
+ *      out[ii] = saturate(round(in[ii] * scale + offset))
+ *
+ *  rounding halfway cases away from zero, as math::round() does, and
+ *  saturating to the range of OutT.  NaN values become nanValue.  This
+ *  gives the same answer as calling math::round(), clamping and
+ *  math::isNaN() for each value, but the loop vectorizes.
+ *
+ *  The arithmetic is done in float for float input and 8 or 16 bit
+ *  output, and in double otherwise.
+ *
+ *  \param in Input values (float or double)
+ *  \param size Number of values
+ *  \param out [output] size values, of an 8, 16 or 32 bit integer type
+ *  \param scale Scale factor applied first
+ *  \param offset Offset added after scaling
+ *  \param nanValue Output for NaN input, itself rounded and saturated
+ *  \param numThreads Number of threads to use.  Fewer are used when there
+ *                    are not detail::MIN_QUANTIZE_VALUES_PER_THREAD values
+ *                    for each thread.
+ */
+template <typename InT, typename OutT>
+void quantize(const InT* in,
+              size_t size,
+              OutT* out,
+              double scale = 1.0,
+              double offset = 0.0,
+              double nanValue = 0.0,
+              size_t numThreads = 1)
+{
+    typedef typename detail::QuantizeWorkType<InT, OutT>::Type WorkT;
+    const OutT nanOut = detail::roundAndSaturate<WorkT, OutT>(
+            static_cast<WorkT>(nanValue));
+
+    detail::runChunks(size,
+                      detail::getNumChunks(
+                              size, numThreads,
+                              detail::MIN_QUANTIZE_VALUES_PER_THREAD),
+                      detail::QuantizeChunk<InT, OutT>(
+                              in, out, scale, offset, nanOut));
+}
+}
+
+#endif
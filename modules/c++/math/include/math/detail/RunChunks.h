@@ -0,0 +1,137 @@
+/* =========================================================================
+ * This file is part of math-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2015, MDA Information Systems LLC
+ *
+ * math-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MATH_DETAIL_RUN_CHUNKS_H__
+#define __MATH_DETAIL_RUN_CHUNKS_H__
+
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+#include <sys/Runnable.h>
+#include <sys/Thread.h>
+
+namespace math
+{
+namespace detail
+{
+/*!
+ *  The number of chunks to split 'size' elements into: one per thread,
+ *  but no more than leave each chunk 'minPerChunk' elements, and at least
+ *  one.
+ *
+ *  math can't use mt, which depends on it, so this and runChunks() stand
+ *  in for mt::runBalanced1D.
+ */
+inline size_t getNumChunks(size_t size, size_t numThreads, size_t minPerChunk)
+{
+    return std::max<size_t>(std::min(numThreads, size / minPerChunk), 1);
+}
+
+/*!
+ *  \class ChunkRunnable
+ *  \brief Runs one chunk of runChunks() on its own thread
+ */
+template <typename OpT>
+class ChunkRunnable : public sys::Runnable
+{
+public:
+    ChunkRunnable(const OpT& op, size_t chunk, size_t start, size_t end) :
+        mOp(op),
+        mChunk(chunk),
+        mStart(start),
+        mEnd(end)
+    {
+    }
+
+    virtual void run()
+    {
+        mOp(mChunk, mStart, mEnd);
+    }
+
+private:
+    const OpT& mOp;
+    const size_t mChunk;
+    const size_t mStart;
+    const size_t mEnd;
+};
+
+/*!
+ *  Splits [0, size) into 'numChunks' contiguous chunks and calls
+ *  op(chunk, start, end) for each.  The calling thread runs the first
+ *  chunk and a new thread runs each of the others; all of them have
+ *  finished when this returns, even if the calling thread's chunk
+ *  throws.
+ *
+ *  Exceptions can't leave the other threads, so an op that can fail
+ *  should catch and hand back its errors by chunk.
+ *
+ *  \param size Number of elements
+ *  \param numChunks Number of chunks, usually from getNumChunks()
+ *  \param op Functor with a const operator()(size_t, size_t, size_t)
+ */
+template <typename OpT>
+void runChunks(size_t size, size_t numChunks, const OpT& op)
+{
+    if (numChunks <= 1)
+    {
+        op(0, 0, size);
+        return;
+    }
+
+    std::vector<sys::Thread*> threads;
+    threads.reserve(numChunks - 1);
+
+    const size_t chunkSize = size / numChunks;
+    try
+    {
+        for (size_t ii = 1; ii < numChunks; ++ii)
+        {
+            const size_t start = ii * chunkSize;
+            const size_t end =
+                    (ii + 1 == numChunks) ? size : start + chunkSize;
+            threads.push_back(new sys::Thread(
+                    new ChunkRunnable<OpT>(op, ii, start, end)));
+            threads.back()->start();
+        }
+        op(0, 0, chunkSize);
+    }
+    catch (...)
+    {
+        for (size_t ii = 0; ii < threads.size(); ++ii)
+        {
+            threads[ii]->join();
+            delete threads[ii];
+        }
+        throw;
+    }
+
+    for (size_t ii = 0; ii < threads.size(); ++ii)
+    {
+        threads[ii]->join();
+        delete threads[ii];
+    }
+}
+}
+}
+
+#endif
@@ -20,11 +20,195 @@
  *
  */
 
+#include <string.h>
 #include <cmath>
 #include <limits>
 
+#include <sys/Conf.h>
 #include <math/Bessel.h>
 
+namespace
+{
+// exp(x) overflows a little below this, and exp(x) / 2 does not
+const double MAX_EXP_ARGUMENT = 710.0;
+
+// ln(2) split so that k * LN2_HI is exact for the k we need
+const double LN2_HI = 6.93147180369123816490e-01;
+const double LN2_LO = 1.90821492927058770002e-10;
+const double LOG2_E = 1.44269504088896338700e+00;
+
+// Adding 1.5 * 2^52 rounds a double of magnitude below 2^51 to an integer,
+// which then sits in the low bits of the sum
+const double ROUND_TO_INT = 6755399441055744.0;
+const sys::Int64_T ROUND_TO_INT_BITS = 0x4338000000000000LL;
+
+/*
+ * exp(x) / 2 for 0 <= x <= MAX_EXP_ARGUMENT, within 2 ulp
+ *
+ * x = k * ln(2) + r with |r| <= ln(2) / 2, exp(r) comes from its Taylor
+ * series to degree 12, and 2^(k - 1) is built directly from its bits.
+ * Halving keeps 2^(k - 1) representable for every x in range.  There are
+ * no branches or calls, so loops over this vectorize.
+ */
+inline double halfExp(double x)
+{
+    const double shifted = x * LOG2_E + ROUND_TO_INT;
+    const double k = shifted - ROUND_TO_INT;
+    const double r = (x - k * LN2_HI) - k * LN2_LO;
+
+    double p = 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    sys::Int64_T bits;
+    memcpy(&bits, &shifted, sizeof(bits));
+    bits = (bits - ROUND_TO_INT_BITS + 1022) << 52;
+    double scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+/*
+ * 1 / sqrt(x) for finite x > 0, within 2 ulp
+ *
+ * std::sqrt() may set errno, which keeps loops that call it from being
+ * vectorized.  This refines the well-known bit-shift estimate, good to
+ * about 5 bits, with four Newton steps.
+ */
+inline double reciprocalSqrt(double x)
+{
+    sys::Int64_T bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5FE6EB50C7B537A9LL - (bits >> 1);
+    double y;
+    memcpy(&y, &bits, sizeof(y));
+
+    const double halfX = 0.5 * x;
+    y *= 1.5 - halfX * y * y;
+    y *= 1.5 - halfX * y * y;
+    y *= 1.5 - halfX * y * y;
+    y *= 1.5 - halfX * y * y;
+    return y;
+}
+
+/*
+ * 1 if the sign bit of 'value' is set, otherwise 0
+ *
+ * With the default -ftrapping-math, compilers won't evaluate floating point
+ * math that the source only does on one side of a branch, and they turn
+ * comparisons back into branches where they can.  So the kernels below
+ * build their masks from bits and blend with them arithmetically.
+ */
+inline double isNegative(double value)
+{
+    sys::Uint64_T bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = (0 - (bits >> 63)) & 0x3FF0000000000000ULL;
+    double mask;
+    memcpy(&mask, &bits, sizeof(mask));
+    return mask;
+}
+
+// Picks 'ifTrue' where 'mask' is 1 and 'ifFalse' where it is 0.  Both must
+// be finite.
+inline double blend(double mask, double ifTrue, double ifFalse)
+{
+    return ifTrue * mask + ifFalse * (1.0 - mask);
+}
+
+// exp(ax) / sqrt(ax) for ax >= 3.75, given 1 / sqrt(ax).  Doubling first
+// makes this infinite wherever exp(ax) overflows, as it is in the scalar
+// functions.
+inline double expOverSqrt(double ax, double reciprocalSqrtAx)
+{
+    const double inRange = isNegative(ax - MAX_EXP_ARGUMENT);
+    return halfExp(blend(inRange, ax, MAX_EXP_ARGUMENT)) * 2.0 *
+            reciprocalSqrtAx;
+}
+
+/*
+ * The scalar besselIOrderZero() without branches
+ *
+ * Each branch's polynomial is evaluated with ax clamped to its side of
+ * 3.75, so both stay finite, and the right one is blended in.
+ */
+inline double besselIOrderZeroKernel(double x)
+{
+    const double ax = std::abs(x);
+    const double isSmall = isNegative(ax - 3.75);
+
+    double y = blend(isSmall, ax, 3.75) * (1.0 / 3.75);
+    y *= y;
+    const double small = 1.0 + y * (3.5156229 +
+        y * (3.0899424 +
+            y * (1.2067492 +
+                y * (0.2659732 +
+                    y * (0.360768e-1 +
+                        y * (0.45813e-2))))));
+
+    const double axLarge = blend(isSmall, 3.75, ax);
+    const double reciprocalSqrtAx = reciprocalSqrt(axLarge);
+    y = 3.75 * reciprocalSqrtAx * reciprocalSqrtAx;
+    const double large = expOverSqrt(axLarge, reciprocalSqrtAx) *
+        (0.39894228 +
+            y * (0.1328592e-1 +
+                y * (0.225319e-2 +
+                    y * (-0.157565e-2 +
+                        y * (0.916281e-2 +
+                            y * (-0.2057706e-1 +
+                                y * (0.2635537e-1 +
+                                    y * (-0.1647633e-1 +
+                                        y * (0.392377e-2)))))))));
+
+    return blend(isSmall, small, large);
+}
+
+// The scalar besselIOrderOne() without branches, as above
+inline double besselIOrderOneKernel(double x)
+{
+    const double ax = std::abs(x);
+    const double isSmall = isNegative(ax - 3.75);
+
+    const double axSmall = blend(isSmall, ax, 3.75);
+    double y = axSmall * (1.0 / 3.75);
+    y *= y;
+    const double small = axSmall * (0.5 +
+        y * (0.87890594 +
+            y * (0.51498869 +
+                y * (0.15084934 +
+                    y * (0.2658733e-1 +
+                        y * (0.301532e-2 +
+                            y * (0.32411e-3)))))));
+
+    const double axLarge = blend(isSmall, 3.75, ax);
+    const double reciprocalSqrtAx = reciprocalSqrt(axLarge);
+    y = 3.75 * reciprocalSqrtAx * reciprocalSqrtAx;
+    double large = 0.2282967e-1 +
+        y * (-0.2895312e-1 +
+            y * (0.1787654e-1 -
+                y * 0.420059e-2));
+    large = 0.39894228 +
+        y * (-0.3988024e-1 +
+            y * (-0.362018e-2 +
+                y * (0.163801e-2 +
+                    y * (-0.1031555e-1 +
+                        y * large))));
+    large *= expOverSqrt(axLarge, reciprocalSqrtAx);
+
+    return blend(isSmall, small, large) * (1.0 - 2.0 * isNegative(x));
+}
+}
+
 namespace math
 {
 /*!
@@ -170,5 +354,40 @@ double besselIOrderN(size_t order, double x)
     ans *= besselIOrderZero(x) / bi;
     return x < 0 && (order & 1) ? -ans : ans;
 }
+
+void besselI(size_t order, const double* x, size_t size, double* out)
+{
+    switch (order)
+    {
+        case 0:
+            besselIOrderZero(x, size, out);
+            break;
+
+        case 1:
+            besselIOrderOne(x, size, out);
+            break;
+
+        default:
+            for (size_t ii = 0; ii < size; ++ii)
+            {
+                out[ii] = besselIOrderN(order, x[ii]);
+            }
+    }
+}
+
+void besselIOrderZero(const double* x, size_t size, double* out)
+{
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        out[ii] = besselIOrderZeroKernel(x[ii]);
+    }
 }
 
+void besselIOrderOne(const double* x, size_t size, double* out)
+{
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        out[ii] = besselIOrderOneKernel(x[ii]);
+    }
+}
+}
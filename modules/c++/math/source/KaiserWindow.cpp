@@ -0,0 +1,154 @@
+/* =========================================================================
+ * This file is part of math-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * math-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <math/Bessel.h>
+#include <math/KaiserWindow.h>
+
+namespace
+{
+// Holds a mutex for as long as it is in scope.  This is
+// mt::CriticalSection, which math can't use because mt depends on math.
+class ScopedLock
+{
+public:
+    explicit ScopedLock(sys::Mutex& mutex) :
+        mMutex(mutex)
+    {
+        mMutex.lock();
+    }
+
+    ~ScopedLock()
+    {
+        mMutex.unlock();
+    }
+
+private:
+    ScopedLock(const ScopedLock& );
+    ScopedLock& operator=(const ScopedLock& );
+
+    sys::Mutex& mMutex;
+};
+}
+
+namespace math
+{
+void kaiserWindow(size_t length, double beta, double* window)
+{
+    if (length == 0)
+    {
+        return;
+    }
+    if (length == 1)
+    {
+        window[0] = 1.0;
+        return;
+    }
+
+    // Fill in the arguments to I0 and evaluate them all in place
+    const double step = 2.0 / (length - 1);
+    for (size_t ii = 0; ii < length; ++ii)
+    {
+        const double t = ii * step - 1.0;
+        window[ii] = beta * std::sqrt(std::max(1.0 - t * t, 0.0));
+    }
+    besselIOrderZero(window, length, window);
+
+    // Use the batch function for I0(beta) as well, so the center tap of an
+    // odd length window is exactly 1
+    double scale;
+    besselIOrderZero(&beta, 1, &scale);
+    scale = 1.0 / scale;
+    for (size_t ii = 0; ii < length; ++ii)
+    {
+        window[ii] *= scale;
+    }
+}
+
+KaiserWindowCache::KaiserWindowCache(size_t maxNumWindows) :
+    mMaxNumWindows(maxNumWindows)
+{
+    if (mMaxNumWindows == 0)
+    {
+        throw except::Exception(Ctxt(
+                "KaiserWindowCache must be able to hold at least 1 window"));
+    }
+}
+
+KaiserWindowCache::Window KaiserWindowCache::get(size_t length, double beta)
+{
+    if (beta != beta)
+    {
+        throw except::Exception(Ctxt(
+                "Kaiser window beta must not be NaN"));
+    }
+
+    const Key key(length, beta);
+    ScopedLock lock(mMutex);
+
+    std::map<Key, List::iterator>::iterator found = mLookup.find(key);
+    if (found != mLookup.end())
+    {
+        mWindows.splice(mWindows.begin(), mWindows, found->second);
+        return found->second->second;
+    }
+
+    mem::SharedPtr<std::vector<double> > window(
+            new std::vector<double>(length));
+    if (length > 0)
+    {
+        kaiserWindow(length, beta, &(*window)[0]);
+    }
+
+    mWindows.push_front(std::make_pair(key, Window(window)));
+    mLookup[key] = mWindows.begin();
+    if (mWindows.size() > mMaxNumWindows)
+    {
+        mLookup.erase(mWindows.back().first);
+        mWindows.pop_back();
+    }
+    return mWindows.front().second;
+}
+
+size_t KaiserWindowCache::size() const
+{
+    ScopedLock lock(mMutex);
+    return mWindows.size();
+}
+
+void KaiserWindowCache::clear()
+{
+    ScopedLock lock(mMutex);
+    mLookup.clear();
+    mWindows.clear();
+}
+
+KaiserWindowCache::Window getKaiserWindow(size_t length, double beta)
+{
+    static KaiserWindowCache cache;
+    return cache.get(length, beta);
+}
+}
@@ -0,0 +1,139 @@
+/* =========================================================================
+ * This file is part of math-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * math-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Compares the scalar and batch modified Bessel functions of orders 0 and
+    1 over the arguments of a Kaiser window, then times building that
+    window directly and fetching it from the cache.
+
+    usage: besselBenchmark [size] [beta]
+        size: number of window taps (default 4000000)
+        beta: Kaiser window shape parameter (default 8.6)
+
+    Throughput is reported in millions of values per second.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <math/Bessel.h>
+#include <math/KaiserWindow.h>
+#include <str/Convert.h>
+
+namespace
+{
+void report(const std::string& name, size_t size, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(1) << size / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t size =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 4000000;
+        const double beta = (argc > 2) ? str::toType<double>(argv[2]) : 8.6;
+
+        std::vector<double> x(size);
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            const double t = 2.0 * ii / (size - 1) - 1.0;
+            x[ii] = beta * std::sqrt(std::max(1.0 - t * t, 0.0));
+        }
+        std::vector<double> scalar(size);
+        std::vector<double> batch(size);
+
+        std::cout << size << " values (million values/s)\n\n";
+
+        sys::RealTimeStopWatch watch;
+        watch.start();
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            scalar[ii] = math::besselIOrderZero(x[ii]);
+        }
+        report("besselIOrderZero", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::besselIOrderZero(&x[0], size, &batch[0]);
+        report("besselIOrderZero batch", size, watch.stop());
+
+        double maxError = 0.0;
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            maxError = std::max(maxError,
+                                std::abs(batch[ii] / scalar[ii] - 1.0));
+        }
+
+        watch.clear();
+        watch.start();
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            scalar[ii] = math::besselIOrderOne(x[ii]);
+        }
+        report("besselIOrderOne", size, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::besselIOrderOne(&x[0], size, &batch[0]);
+        report("besselIOrderOne batch", size, watch.stop());
+
+        for (size_t ii = 0; ii < size; ++ii)
+        {
+            if (scalar[ii] != 0.0)
+            {
+                maxError = std::max(maxError,
+                                    std::abs(batch[ii] / scalar[ii] - 1.0));
+            }
+        }
+
+        watch.clear();
+        watch.start();
+        math::kaiserWindow(size, beta, &batch[0]);
+        report("kaiserWindow", size, watch.stop());
+
+        math::getKaiserWindow(size, beta);
+        watch.clear();
+        watch.start();
+        const size_t numCached = math::getKaiserWindow(size, beta)->size();
+        report("getKaiserWindow cached", numCached, watch.stop());
+
+        std::cout << "\nmax relative difference " << std::scientific
+                  << std::setprecision(2) << maxError << std::endl;
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
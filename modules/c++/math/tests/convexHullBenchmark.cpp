@@ -0,0 +1,114 @@
+/* =========================================================================
+ * This file is part of math-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2017, MDA Information Systems LLC
+ *
+ * math-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Times the convex hull of random points, as the projected corners of
+    many pixels would be, computed by ConvexHull, by convexHull() on
+    several threads, and by IncrementalConvexHull fed in batches.
+
+    usage: convexHullBenchmark [numPoints] [numThreads] [batchSize]
+        numPoints: number of points (default 4000000)
+        numThreads: threads used by convexHull() (default 4)
+        batchSize: points per IncrementalConvexHull::add() (default 65536)
+
+    Throughput is reported in millions of points per second.
+*/
+
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <math/ConvexHull.h>
+#include <str/Convert.h>
+
+namespace
+{
+typedef types::RowCol<double> RowCol;
+
+void report(const std::string& name, size_t size, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(1) << size / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t numPoints =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 4000000;
+        const size_t numThreads =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 4;
+        const size_t batchSize =
+                (argc > 3) ? str::toType<size_t>(argv[3]) : 65536;
+
+        // A sheared, rotated square of pixel corners
+        std::vector<RowCol> points(numPoints);
+        for (size_t ii = 0; ii < numPoints; ++ii)
+        {
+            const double row = 1000.0 * rand() / RAND_MAX;
+            const double col = 1000.0 * rand() / RAND_MAX;
+            points[ii] = RowCol(0.8 * row + 0.3 * col, 0.6 * col - 0.2 * row);
+        }
+
+        std::cout << numPoints << " points (million points/s)\n\n";
+
+        sys::RealTimeStopWatch watch;
+        watch.start();
+        std::vector<RowCol> hull;
+        math::ConvexHull<double>(points, hull);
+        report("ConvexHull", numPoints, watch.stop());
+        const size_t numVertices = hull.size();
+
+        watch.clear();
+        watch.start();
+        math::convexHull(points, hull, numThreads);
+        report("convexHull " + str::toString(numThreads) + " threads",
+               numPoints, watch.stop());
+
+        watch.clear();
+        watch.start();
+        math::IncrementalConvexHull<double> incremental;
+        for (size_t ii = 0; ii < numPoints; ii += batchSize)
+        {
+            incremental.add(&points[ii], std::min(batchSize, numPoints - ii));
+        }
+        incremental.getHull(hull);
+        report("IncrementalConvexHull", numPoints, watch.stop());
+
+        std::cout << "\n" << numVertices << " and " << hull.size()
+                  << " hull points\n";
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+/* =========================================================================
+ * This file is part of math-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2015, MDA Information Systems LLC
+ *
+ * math-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Compares converting floating point values to integers one at a time,
+    with math::round(), clamping and math::isNaN(), against
+    math::quantize().
+
+    usage: quantizeBenchmark [size] [numThreads]
+        size: number of values (default 10000000)
+        numThreads: threads for math::quantize() (default 1)
+
+    Throughput is reported in millions of values per second.
+*/
+
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <math/Quantize.h>
+#include <math/Round.h>
+#include <math/Utilities.h>
+#include <str/Convert.h>
+
+namespace
+{
+void report(const std::string& name, size_t size, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(1) << size / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+
+template <typename InT, typename OutT>
+void benchmark(const std::string& name,
+               const std::vector<InT>& in,
+               size_t numThreads)
+{
+    const size_t size = in.size();
+    const InT low = static_cast<InT>(std::numeric_limits<OutT>::min());
+    const InT high = static_cast<InT>(std::numeric_limits<OutT>::max());
+    const InT scale = static_cast<InT>(0.5);
+    std::vector<OutT> out(size);
+
+    sys::RealTimeStopWatch watch;
+    watch.start();
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        const InT value = in[ii] * scale;
+        out[ii] = math::isNaN(value) ? 0 : static_cast<OutT>(
+                std::min(std::max(math::round(value), low), high));
+    }
+    report(name + " per value", size, watch.stop());
+
+    watch.clear();
+    watch.start();
+    math::quantize(&in[0], size, &out[0], 0.5, 0.0, 0.0, numThreads);
+    report(name + " quantize", size, watch.stop());
+}
+
+template <typename InT>
+std::vector<InT> values(size_t size)
+{
+    std::vector<InT> values(size);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        values[ii] = static_cast<InT>(100000.0 * rand() / RAND_MAX - 50000.0);
+    }
+    values[size / 2] = std::numeric_limits<InT>::quiet_NaN();
+    return values;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t size =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 10000000;
+        const size_t numThreads =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 1;
+
+        std::cout << size << " values, " << numThreads
+                  << " thread(s) (million values/s)\n\n";
+
+        const std::vector<float> floats = values<float>(size);
+        benchmark<float, sys::Uint8_T>("float to uint8", floats, numThreads);
+        benchmark<float, sys::Int16_T>("float to int16", floats, numThreads);
+        benchmark<float, sys::Int32_T>("float to int32", floats, numThreads);
+
+        const std::vector<double> doubles = values<double>(size);
+        benchmark<double, sys::Uint16_T>("double to uint16", doubles,
+                                         numThreads);
+        benchmark<double, sys::Uint32_T>("double to uint32", doubles,
+                                         numThreads);
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -20,6 +20,10 @@
  *
  */
 
+#include <cmath>
+#include <limits>
+#include <vector>
+
 #include <TestCase.h>
 #include <math/Bessel.h>
 
@@ -45,6 +49,46 @@ TEST_CASE(orderFive)
     TEST_ASSERT_ALMOST_EQ(math::besselI(5, 0), 0);
     TEST_ASSERT_ALMOST_EQ(math::besselI(5, 1), 2.71463156e-4);
 }
+
+TEST_CASE(batch)
+{
+    std::vector<double> x;
+    for (double value = -750.0; value <= 750.0; value += 0.0371)
+    {
+        x.push_back(value);
+    }
+    x.push_back(0.0);
+    x.push_back(3.75);
+    x.push_back(-3.75);
+
+    for (size_t order = 0; order <= 5; order += 1)
+    {
+        std::vector<double> values(x.size());
+        math::besselI(order, &x[0], x.size(), &values[0]);
+        for (size_t ii = 0; ii < x.size(); ++ii)
+        {
+            const double expected = math::besselI(order, x[ii]);
+            if (std::abs(expected) == std::numeric_limits<double>::infinity())
+            {
+                TEST_ASSERT_EQ(values[ii], expected);
+            }
+            else
+            {
+                TEST_ASSERT_LESSER_EQ(std::abs(values[ii] - expected),
+                                      2e-15 * std::abs(expected));
+            }
+        }
+
+        // In place
+        std::vector<double> inPlace(x);
+        math::besselI(order, &inPlace[0], inPlace.size(), &inPlace[0]);
+        TEST_ASSERT_TRUE(inPlace == values);
+    }
+
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    math::besselIOrderZero(&nan, 1, &nan);
+    TEST_ASSERT_TRUE(nan != nan);
+}
 }
 
 int main(int /*argc*/, char** /*argv*/)
@@ -52,6 +96,7 @@ int main(int /*argc*/, char** /*argv*/)
     TEST_CHECK(orderZero);
     TEST_CHECK(orderOne);
     TEST_CHECK(orderFive);
+    TEST_CHECK(batch);
     return 0;
 }
 
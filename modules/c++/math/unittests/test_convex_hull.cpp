@@ -20,12 +20,68 @@
  *
  */
 
+#include <stdlib.h>
+#include <vector>
+
 #include <math/ConvexHull.h>
 #include <sys/Conf.h>
 #include "TestCase.h"
 
 namespace
 {
+typedef types::RowCol<sys::Int64_T> RowCol;
+
+// Points on a small grid, so there are plenty of duplicate and collinear
+// points, in a disk so that the hull has many vertices
+std::vector<RowCol> randomPoints(size_t numPoints)
+{
+    std::vector<RowCol> points;
+    while (points.size() < numPoints)
+    {
+        const RowCol point(rand() % 201 - 100, rand() % 201 - 100);
+        if (point.row * point.row + point.col * point.col <= 10000)
+        {
+            points.push_back(point);
+        }
+    }
+    return points;
+}
+
+void checkEqual(const std::string& testName,
+                const std::vector<RowCol>& hull,
+                const std::vector<RowCol>& expectedHull)
+{
+    TEST_ASSERT_EQ(hull.size(), expectedHull.size());
+    for (size_t ii = 0; ii < hull.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(hull[ii].row, expectedHull[ii].row);
+        TEST_ASSERT_EQ(hull[ii].col, expectedHull[ii].col);
+    }
+}
+
+// Every turn along the hull is a strict left turn, and no point is outside
+// of it
+void checkHull(const std::string& testName,
+               const std::vector<RowCol>& points,
+               const std::vector<RowCol>& hull)
+{
+    TEST_ASSERT_GREATER_EQ(hull.size(), 4);
+    TEST_ASSERT_TRUE(hull.front() == hull.back());
+    const size_t numVertices = hull.size() - 1;
+    for (size_t ii = 0; ii < numVertices; ++ii)
+    {
+        const RowCol& start = hull[ii];
+        const RowCol& end = hull[ii + 1];
+        const RowCol& next = hull[(ii + 2) % numVertices];
+        TEST_ASSERT_GREATER(math::detail::cross(start, end, next), 0);
+        for (size_t jj = 0; jj < points.size(); ++jj)
+        {
+            TEST_ASSERT_GREATER_EQ(
+                    math::detail::cross(start, end, points[jj]), 0);
+        }
+    }
+}
+
 TEST_CASE(testConvexHull)
 {
     // Add in all the points
@@ -76,10 +132,120 @@ TEST_CASE(testConvexHull)
         TEST_ASSERT_EQ(convexHull[ii].col, expectedConvexHull[ii].col);
     }
 }
+
+TEST_CASE(testCullInteriorPoints)
+{
+    srand(1);
+    const std::vector<RowCol> points = randomPoints(10000);
+    std::vector<RowCol> survivors;
+    math::detail::cullInteriorPoints(&points[0], points.size(), survivors);
+    TEST_ASSERT_LESSER(survivors.size(), points.size() / 2);
+
+    std::vector<RowCol> expectedHull;
+    math::ConvexHull<sys::Int64_T>(points, expectedHull);
+    for (size_t ii = 0; ii < expectedHull.size(); ++ii)
+    {
+        TEST_ASSERT_TRUE(std::find(survivors.begin(), survivors.end(),
+                                   expectedHull[ii]) != survivors.end());
+    }
+
+    // Collinear points enclose nothing
+    std::vector<RowCol> line;
+    for (sys::Int64_T ii = 0; ii < 10; ++ii)
+    {
+        line.push_back(RowCol(2 * ii, ii));
+    }
+    survivors.clear();
+    math::detail::cullInteriorPoints(&line[0], line.size(), survivors);
+    TEST_ASSERT_EQ(survivors.size(), line.size());
+}
+
+TEST_CASE(testParallelConvexHull)
+{
+    srand(2);
+    for (size_t numPoints = 10; numPoints <= 100000; numPoints *= 10)
+    {
+        const std::vector<RowCol> points = randomPoints(numPoints);
+        std::vector<RowCol> expectedHull;
+        math::ConvexHull<sys::Int64_T>(points, expectedHull);
+        checkHull(testName, points, expectedHull);
+
+        for (size_t numThreads = 1; numThreads <= 16; numThreads *= 4)
+        {
+            std::vector<RowCol> hull;
+            math::convexHull(points, hull, numThreads);
+            checkEqual(testName, hull, expectedHull);
+        }
+    }
+
+    std::vector<RowCol> hull;
+    TEST_EXCEPTION(math::convexHull(std::vector<RowCol>(1), hull, 4));
+}
+
+TEST_CASE(testIncrementalConvexHull)
+{
+    srand(3);
+    const std::vector<RowCol> points = randomPoints(50000);
+    math::IncrementalConvexHull<sys::Int64_T> incremental;
+
+    std::vector<RowCol> hull;
+    TEST_EXCEPTION(incremental.getHull(hull));
+    incremental.add(&points[0], 1);
+    TEST_EXCEPTION(incremental.getHull(hull));
+
+    size_t numAdded = 1;
+    for (size_t batchSize = 1; numAdded < points.size(); batchSize *= 3)
+    {
+        batchSize = std::min(batchSize, points.size() - numAdded);
+        incremental.add(&points[numAdded], batchSize, 2);
+        numAdded += batchSize;
+        TEST_ASSERT_EQ(incremental.getNumPoints(), numAdded);
+
+        std::vector<RowCol> expectedHull;
+        math::ConvexHull<sys::Int64_T>(
+                std::vector<RowCol>(points.begin(),
+                                    points.begin() + numAdded),
+                expectedHull);
+        incremental.getHull(hull);
+        checkEqual(testName, hull, expectedHull);
+        TEST_ASSERT_EQ(incremental.getVertices().size(), hull.size() - 1);
+    }
+
+    incremental.clear();
+    TEST_ASSERT_EQ(incremental.getNumPoints(), 0);
+    TEST_EXCEPTION(incremental.getHull(hull));
+}
+
+TEST_CASE(testDoubleConvexHull)
+{
+    srand(4);
+    std::vector<types::RowCol<double> > points(20000);
+    for (size_t ii = 0; ii < points.size(); ++ii)
+    {
+        points[ii].row = 2.0 * rand() / RAND_MAX - 1.0;
+        points[ii].col = 3.0 * rand() / RAND_MAX - 1.5;
+    }
+
+    std::vector<types::RowCol<double> > expectedHull;
+    math::ConvexHull<double>(points, expectedHull);
+
+    std::vector<types::RowCol<double> > hull;
+    math::convexHull(points, hull, 3);
+    TEST_ASSERT_EQ(hull.size(), expectedHull.size());
+    for (size_t ii = 0; ii < hull.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(hull[ii].row, expectedHull[ii].row);
+        TEST_ASSERT_EQ(hull[ii].col, expectedHull[ii].col);
+    }
+}
 }
 
 int main(int argc, char** argv)
 {
     TEST_CHECK(testConvexHull);
+    TEST_CHECK(testCullInteriorPoints);
+    TEST_CHECK(testParallelConvexHull);
+    TEST_CHECK(testIncrementalConvexHull);
+    TEST_CHECK(testDoubleConvexHull);
     return 0;
 }
@@ -0,0 +1,112 @@
+/* =========================================================================
+ * This file is part of math-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * math-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <TestCase.h>
+#include <math/Bessel.h>
+#include <math/KaiserWindow.h>
+
+namespace
+{
+TEST_CASE(window)
+{
+    const double beta = 8.6;
+    for (size_t length = 2; length <= 65; length += 7)
+    {
+        std::vector<double> window(length);
+        math::kaiserWindow(length, beta, &window[0]);
+        for (size_t ii = 0; ii < length; ++ii)
+        {
+            const double t = 2.0 * ii / (length - 1) - 1.0;
+            const double expected =
+                    math::besselIOrderZero(beta * std::sqrt(1.0 - t * t)) /
+                    math::besselIOrderZero(beta);
+            TEST_ASSERT_ALMOST_EQ_EPS(window[ii], expected, 1e-14);
+            TEST_ASSERT_ALMOST_EQ_EPS(window[ii], window[length - 1 - ii],
+                                      1e-14);
+        }
+        if (length % 2 == 1)
+        {
+            TEST_ASSERT_EQ(window[length / 2], 1.0);
+        }
+    }
+
+    double single = 0.0;
+    math::kaiserWindow(1, beta, &single);
+    TEST_ASSERT_EQ(single, 1.0);
+
+    // beta = 0 is rectangular
+    std::vector<double> rectangular(10);
+    math::kaiserWindow(rectangular.size(), 0.0, &rectangular[0]);
+    for (size_t ii = 0; ii < rectangular.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(rectangular[ii], 1.0);
+    }
+}
+
+TEST_CASE(cache)
+{
+    math::KaiserWindowCache cache(2);
+    const math::KaiserWindowCache::Window first = cache.get(33, 5.0);
+    TEST_ASSERT_EQ(first->size(), 33);
+    std::vector<double> expected(33);
+    math::kaiserWindow(33, 5.0, &expected[0]);
+    TEST_ASSERT_TRUE(*first == expected);
+
+    // Hits share the window
+    TEST_ASSERT_TRUE(cache.get(33, 5.0) == first);
+    TEST_ASSERT_EQ(cache.size(), 1);
+
+    // Different length or beta is a different window
+    const math::KaiserWindowCache::Window second = cache.get(33, 6.0);
+    TEST_ASSERT_TRUE(second != first);
+    TEST_ASSERT_EQ(cache.size(), 2);
+
+    // (33, 5) was used more recently than (33, 6), so (33, 6) is dropped
+    TEST_ASSERT_TRUE(cache.get(33, 5.0) == first);
+    cache.get(17, 5.0);
+    TEST_ASSERT_EQ(cache.size(), 2);
+    TEST_ASSERT_TRUE(cache.get(33, 5.0) == first);
+    TEST_ASSERT_TRUE(cache.get(33, 6.0) != second);
+    TEST_ASSERT_EQ(second->size(), 33);
+
+    TEST_ASSERT_EQ(cache.get(0, 5.0)->size(), 0);
+    TEST_EXCEPTION(cache.get(33, std::numeric_limits<double>::quiet_NaN()));
+    TEST_EXCEPTION(math::KaiserWindowCache(0));
+
+    cache.clear();
+    TEST_ASSERT_EQ(cache.size(), 0);
+
+    TEST_ASSERT_TRUE(math::getKaiserWindow(64, 3.0) ==
+                     math::getKaiserWindow(64, 3.0));
+}
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    TEST_CHECK(window);
+    TEST_CHECK(cache);
+    return 0;
+}
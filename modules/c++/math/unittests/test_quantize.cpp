@@ -0,0 +1,171 @@
+/* =========================================================================
+ * This file is part of math-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2015, MDA Information Systems LLC
+ *
+ * math-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <limits>
+#include <vector>
+
+#include <TestCase.h>
+#include <math/Quantize.h>
+#include <math/Round.h>
+#include <math/Utilities.h>
+
+namespace
+{
+// Enough values for several threads
+const size_t SIZE = 300000;
+
+// Halfway cases and the floats just below them, values just outside the
+// integer types' ranges, infinities and NaN, followed by random values
+template <typename InT>
+std::vector<InT> values()
+{
+    const InT specials[] = {
+        0, -0.0, 0.5, -0.5, 1.5, -1.5, 2.5, -2.5, 0.49, -0.49,
+        0.49999997f, -0.49999997f, 1.4999999f, -1.4999999f,
+        126.5, 127.5, -128.5, -129, 254.5, 255.5, 256,
+        32766.5, 32767.5, -32768.5, 65535.5, 65536,
+        2147483647.0, 2147483648.0, -2147483649.0, 4294967295.0,
+        4294967296.0, 1e30, -1e30,
+        std::numeric_limits<InT>::infinity(),
+        -std::numeric_limits<InT>::infinity(),
+        std::numeric_limits<InT>::quiet_NaN() };
+    std::vector<InT> values(specials,
+                            specials + sizeof(specials) / sizeof(specials[0]));
+    while (values.size() < SIZE)
+    {
+        values.push_back(static_cast<InT>(
+                100000.0 * rand() / RAND_MAX - 50000.0));
+    }
+    return values;
+}
+
+// Per value, with the scalar functions
+template <typename InT, typename OutT>
+OutT expected(InT in, double scale, double offset, double nanValue)
+{
+    typedef typename math::detail::QuantizeWorkType<InT, OutT>::Type WorkT;
+    WorkT value = static_cast<WorkT>(in) * static_cast<WorkT>(scale) +
+            static_cast<WorkT>(offset);
+    if (math::isNaN(value))
+    {
+        value = static_cast<WorkT>(nanValue);
+    }
+    value = math::round(value);
+    value = std::max(value,
+                     static_cast<WorkT>(std::numeric_limits<OutT>::min()));
+    value = std::min(value,
+                     static_cast<WorkT>(std::numeric_limits<OutT>::max()));
+    return static_cast<OutT>(value);
+}
+
+template <typename InT, typename OutT>
+void checkQuantize(const std::string& testName)
+{
+    const std::vector<InT> in = values<InT>();
+    const double scales[] = { 1.0, 0.01, -3.0 };
+    const double offsets[] = { 0.0, 127.5, -1000.0 };
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+        {
+            std::vector<OutT> out(SIZE);
+            math::quantize(&in[0], SIZE, &out[0], scales[ii], offsets[ii],
+                           -7.0, numThreads);
+            for (size_t jj = 0; jj < SIZE; ++jj)
+            {
+                TEST_ASSERT_EQ(static_cast<double>(out[jj]),
+                               static_cast<double>(expected<InT, OutT>(
+                                       in[jj], scales[ii], offsets[ii],
+                                       -7.0)));
+            }
+        }
+    }
+}
+
+template <typename InT>
+void checkQuantizeAll(const std::string& testName)
+{
+    checkQuantize<InT, sys::Int8_T>(testName);
+    checkQuantize<InT, sys::Uint8_T>(testName);
+    checkQuantize<InT, sys::Int16_T>(testName);
+    checkQuantize<InT, sys::Uint16_T>(testName);
+    checkQuantize<InT, sys::Int32_T>(testName);
+    checkQuantize<InT, sys::Uint32_T>(testName);
+}
+
+TEST_CASE(testQuantizeFloat)
+{
+    srand(1);
+    checkQuantizeAll<float>(testName);
+}
+
+TEST_CASE(testQuantizeDouble)
+{
+    srand(2);
+    checkQuantizeAll<double>(testName);
+}
+
+TEST_CASE(testQuantizeDefaults)
+{
+    const float in[] = { -1.5f, -0.5f, 0.4f, 0.5f, 300.0f,
+                         std::numeric_limits<float>::quiet_NaN(),
+                         0.49999997f, -0.49999997f };
+    sys::Uint8_T out[8];
+    math::quantize(in, 8, out);
+    TEST_ASSERT_EQ(out[0], 0);
+    TEST_ASSERT_EQ(out[1], 0);
+    TEST_ASSERT_EQ(out[2], 0);
+    TEST_ASSERT_EQ(out[3], 1);
+    TEST_ASSERT_EQ(out[4], 255);
+    TEST_ASSERT_EQ(out[5], 0);
+    TEST_ASSERT_EQ(out[6], 0);
+    TEST_ASSERT_EQ(out[7], 0);
+
+    sys::Int16_T signedOut[8];
+    math::quantize(in, 8, signedOut, 2.0, 0.0, 1e6);
+    TEST_ASSERT_EQ(signedOut[0], -3);
+    TEST_ASSERT_EQ(signedOut[1], -1);
+    TEST_ASSERT_EQ(signedOut[2], 1);
+    TEST_ASSERT_EQ(signedOut[3], 1);
+    TEST_ASSERT_EQ(signedOut[4], 600);
+    TEST_ASSERT_EQ(signedOut[5], 32767);
+    TEST_ASSERT_EQ(signedOut[6], 1);
+    TEST_ASSERT_EQ(signedOut[7], -1);
+
+    // Just below one half rounds down
+    math::quantize(in + 6, 2, signedOut);
+    TEST_ASSERT_EQ(signedOut[0], 0);
+    TEST_ASSERT_EQ(signedOut[1], 0);
+
+    // Nothing to do
+    math::quantize(in, 0, out, 1.0, 0.0, 0.0, 4);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testQuantizeFloat);
+    TEST_CHECK(testQuantizeDouble);
+    TEST_CHECK(testQuantizeDefaults);
+    return 0;
+}
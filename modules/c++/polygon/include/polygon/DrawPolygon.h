@@ -25,13 +25,211 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <sstream>
 
+#include <sys/Conf.h>
+#include <except/Exception.h>
+#include <mt/BalancedRunnable1D.h>
 #include <types/RowCol.h>
 
-#include <polygon/Intersections.h>
+#include <polygon/ScanlineRasterizer.h>
 
 namespace polygon
 {
+namespace detail
+{
+// Rows and columns in each tile drawPolygons() draws
+const size_t DRAW_TILE_SIZE = 256;
+
+/*!
+ * Colors columns [colBegin, colEnd) of a row: those in the intersections,
+ * or when inverting, those not in them
+ */
+template <typename IntersectionT, typename OutT>
+void drawRow(const std::vector<IntersectionT>& intersections,
+             size_t colBegin,
+             size_t colEnd,
+             OutT color,
+             bool invert,
+             OutT* rowOut)
+{
+    size_t col = colBegin;
+    for (size_t pair = 0; pair < intersections.size(); ++pair)
+    {
+        const size_t first = std::max(intersections[pair].first, colBegin);
+        const size_t end = std::min(intersections[pair].last + 1, colEnd);
+        if (invert)
+        {
+            // Fill the gap before this intersection
+            if (first > col)
+            {
+                std::fill(rowOut + col, rowOut + std::min(first, colEnd),
+                          color);
+            }
+            col = std::max(col, end);
+        }
+        else if (end > first)
+        {
+            std::fill(rowOut + first, rowOut + end, color);
+        }
+    }
+
+    if (invert && col < colEnd)
+    {
+        std::fill(rowOut + col, rowOut + colEnd, color);
+    }
+}
+
+/*!
+ * Finds the tiles [firstTile, endTile) that a polygon's bounding box
+ * touches.  A polygon with no points, or entirely off the image, touches
+ * none.
+ */
+template <typename PointT>
+void findTiles(const std::vector<types::RowCol<PointT> >& points,
+               size_t numRows,
+               size_t numCols,
+               types::RowCol<sys::SSize_T> offset,
+               size_t tileSize,
+               types::RowCol<size_t>& firstTile,
+               types::RowCol<size_t>& endTile)
+{
+    firstTile = endTile = types::RowCol<size_t>(0, 0);
+    if (points.empty())
+    {
+        return;
+    }
+
+    double minRow = static_cast<double>(points[0].row);
+    double maxRow = minRow;
+    double minCol = static_cast<double>(points[0].col);
+    double maxCol = minCol;
+    for (size_t ii = 1; ii < points.size(); ++ii)
+    {
+        minRow = std::min(minRow, static_cast<double>(points[ii].row));
+        maxRow = std::max(maxRow, static_cast<double>(points[ii].row));
+        minCol = std::min(minCol, static_cast<double>(points[ii].col));
+        maxCol = std::max(maxCol, static_cast<double>(points[ii].col));
+    }
+
+    // Round outwards.  Vertices moved off scan lines move by much less
+    // than a row, so this still holds them.
+    minRow = std::floor(minRow - offset.row);
+    maxRow = std::ceil(maxRow - offset.row);
+    minCol = std::floor(minCol - offset.col);
+    maxCol = std::ceil(maxCol - offset.col);
+    if (maxRow < 0 || minRow > numRows - 1.0 ||
+        maxCol < 0 || minCol > numCols - 1.0)
+    {
+        return;
+    }
+
+    firstTile.row = static_cast<size_t>(std::max(minRow, 0.0)) / tileSize;
+    firstTile.col = static_cast<size_t>(std::max(minCol, 0.0)) / tileSize;
+    endTile.row = static_cast<size_t>(std::min(maxRow, numRows - 1.0)) /
+            tileSize + 1;
+    endTile.col = static_cast<size_t>(std::min(maxCol, numCols - 1.0)) /
+            tileSize + 1;
+}
+
+/*!
+ * Draws one tile of drawPolygons()
+ */
+template <typename PointT, typename OutT>
+class DrawTile
+{
+public:
+    DrawTile(const std::vector<std::vector<types::RowCol<PointT> > >& polygons,
+             const std::vector<OutT>& colors,
+             size_t numRows,
+             size_t numCols,
+             OutT* out,
+             bool invert,
+             types::RowCol<sys::SSize_T> offset,
+             size_t tileSize,
+             size_t numTileCols,
+             const std::vector<size_t>& tileOffsets,
+             const std::vector<size_t>& tilePolygons) :
+        mPolygons(polygons),
+        mColors(colors),
+        mDims(numRows, numCols),
+        mOut(out),
+        mInvert(invert),
+        mOffset(offset),
+        mTileSize(tileSize),
+        mNumTileCols(numTileCols),
+        mTileOffsets(tileOffsets),
+        mTilePolygons(tilePolygons)
+    {
+    }
+
+    void operator()(size_t tile) const
+    {
+        const size_t rowBegin = (tile / mNumTileCols) * mTileSize;
+        const size_t rowEnd = std::min(rowBegin + mTileSize, mDims.row);
+        const size_t colBegin = (tile % mNumTileCols) * mTileSize;
+        const size_t colEnd = std::min(colBegin + mTileSize, mDims.col);
+
+        // This tile's bin is mTilePolygons[binBegin, binEnd)
+        const size_t binBegin = mTileOffsets[tile];
+        const size_t binEnd = mTileOffsets[tile + 1];
+        size_t bin = binBegin;
+
+        if (mInvert)
+        {
+            // Find the last polygon with points that isn't in this bin.
+            // The bin is sorted, so its tail holds the polygons after it.
+            bin = binEnd;
+            for (size_t ii = mPolygons.size(); ii > 0; --ii)
+            {
+                const size_t polygon = ii - 1;
+                if (bin != binBegin && mTilePolygons[bin - 1] == polygon)
+                {
+                    --bin;
+                }
+                else if (!mPolygons[polygon].empty())
+                {
+                    for (size_t row = rowBegin; row < rowEnd; ++row)
+                    {
+                        std::fill(mOut + row * mDims.col + colBegin,
+                                  mOut + row * mDims.col + colEnd,
+                                  mColors[polygon]);
+                    }
+                    break;
+                }
+            }
+        }
+
+        std::vector<typename Intersections<PointT>::Intersection>
+                intersectionsVec;
+        for (; bin != binEnd; ++bin)
+        {
+            const size_t polygon = mTilePolygons[bin];
+            ScanlineRasterizer<PointT> rasterizer(mPolygons[polygon], mDims,
+                                                  mOffset);
+            for (size_t row = rowBegin; row < rowEnd; ++row)
+            {
+                rasterizer.get(row, intersectionsVec);
+                drawRow(intersectionsVec, colBegin, colEnd,
+                        mColors[polygon], mInvert, mOut + row * mDims.col);
+            }
+        }
+    }
+
+private:
+    const std::vector<std::vector<types::RowCol<PointT> > >& mPolygons;
+    const std::vector<OutT>& mColors;
+    const types::RowCol<size_t> mDims;
+    OutT* const mOut;
+    const bool mInvert;
+    const types::RowCol<sys::SSize_T> mOffset;
+    const size_t mTileSize;
+    const size_t mNumTileCols;
+    const std::vector<size_t>& mTileOffsets;
+    const std::vector<size_t>& mTilePolygons;
+};
+}
+
 /*!
  * This function will "color in" a polygon in an image/buffer
  *
@@ -54,7 +252,7 @@ namespace polygon
  * positive col value shifts the polygon left (equiv. the frame shifts right).
  * Defaults to no offset.
  *
- * See Intersections class for additional details
+ * See Intersections and ScanlineRasterizer classes for additional details
 */
 template <typename PointT, typename OutT>
 void drawPolygon(const std::vector<types::RowCol<PointT> >& points,
@@ -72,8 +270,8 @@ void drawPolygon(const std::vector<types::RowCol<PointT> >& points,
         return;
     }
 
-    // We need to get all scanline intersections of polygon edges
-    const Intersections<PointT> intersections(
+    // Work down the rows, finding where each crosses the polygon's edges
+    ScanlineRasterizer<PointT> rasterizer(
             points,
             types::RowCol<size_t>(numRows, numCols),
             offset);
@@ -82,38 +280,123 @@ void drawPolygon(const std::vector<types::RowCol<PointT> >& points,
     std::vector<typename Intersections<PointT>::Intersection> intersectionsVec;
     for (size_t row = 0, rowIdx = 0; row < numRows; ++row, rowIdx += numCols)
     {
-        intersections.get(row, intersectionsVec);
-        if (intersectionsVec.empty())
+        rasterizer.get(row, intersectionsVec);
+        detail::drawRow(intersectionsVec, 0, numCols, color, invert,
+                        out + rowIdx);
+    }
+}
+
+/*!
+ * Draws many polygons into an image/buffer, as calling drawPolygon() on
+ * each in turn would, but much faster when they are small relative to
+ * the image.
+ *
+ * The image is split into tiles, and each polygon is binned into the
+ * tiles its bounding box touches.  Each tile is then drawn by one thread,
+ * with only the polygons in its bin, in order, so later polygons still
+ * paint over earlier ones.  When inverting, a tile outside a polygon's
+ * bounding box is entirely outside it, so the tile is first filled with
+ * the color of the last such polygon and only the polygons after that
+ * are drawn.
+ *
+ * \param polygons The polygons to draw, in order
+ * \param colors The color of each polygon
+ * \param numRows Number of rows in the output image/buffer
+ * \param numCols Number of columns in the output image/buffer
+ * \param out Pointer to start of output image/buffer
+ * \param invert As for drawPolygon()
+ * \param offset Number of rows and cols to offset all polygons, as for
+ * drawPolygon()
+ * \param numThreads Number of threads to draw tiles with
+ * \param tileSize Number of rows and columns in each tile
+ *
+ * \throws except::Exception if there isn't one color per polygon
+ */
+template <typename PointT, typename OutT>
+void drawPolygons(
+        const std::vector<std::vector<types::RowCol<PointT> > >& polygons,
+        const std::vector<OutT>& colors,
+        size_t numRows,
+        size_t numCols,
+        OutT* out,
+        bool invert = false,
+        types::RowCol<sys::SSize_T> offset =
+                types::RowCol<sys::SSize_T>(0, 0),
+        size_t numThreads = 1,
+        size_t tileSize = detail::DRAW_TILE_SIZE)
+{
+    if (colors.size() != polygons.size())
+    {
+        std::ostringstream ostr;
+        ostr << "Got " << polygons.size() << " polygons but "
+             << colors.size() << " colors";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    if (numRows == 0 || numCols == 0)
+    {
+        return;
+    }
+
+    tileSize = std::max<size_t>(tileSize, 1);
+    const size_t numTileRows = (numRows + tileSize - 1) / tileSize;
+    const size_t numTileCols = (numCols + tileSize - 1) / tileSize;
+    const size_t numTiles = numTileRows * numTileCols;
+
+    // Find the tiles each polygon's bounding box touches.  Counting them
+    // first lets the bins share one array, with polygons in order.
+    std::vector<types::RowCol<size_t> > firstTile(polygons.size());
+    std::vector<types::RowCol<size_t> > endTile(polygons.size());
+    std::vector<size_t> tileOffsets(numTiles + 1, 0);
+    for (size_t ii = 0; ii < polygons.size(); ++ii)
+    {
+        detail::findTiles(polygons[ii], numRows, numCols, offset, tileSize,
+                          firstTile[ii], endTile[ii]);
+        for (size_t tileRow = firstTile[ii].row; tileRow < endTile[ii].row;
+             ++tileRow)
         {
-            if (invert)
+            for (size_t tileCol = firstTile[ii].col;
+                 tileCol < endTile[ii].col;
+                 ++tileCol)
             {
-                std::fill_n(out + rowIdx, numCols, color);
+                ++tileOffsets[tileRow * numTileCols + tileCol + 1];
             }
         }
-        else
+    }
+    for (size_t tile = 0; tile < numTiles; ++tile)
+    {
+        tileOffsets[tile + 1] += tileOffsets[tile];
+    }
+
+    std::vector<size_t> tilePolygons(tileOffsets.back());
+    std::vector<size_t> nextIdx(tileOffsets.begin(), tileOffsets.end() - 1);
+    for (size_t ii = 0; ii < polygons.size(); ++ii)
+    {
+        for (size_t tileRow = firstTile[ii].row; tileRow < endTile[ii].row;
+             ++tileRow)
         {
-            for (size_t pair = 0; pair < intersectionsVec.size(); ++pair)
+            for (size_t tileCol = firstTile[ii].col;
+                 tileCol < endTile[ii].col;
+                 ++tileCol)
             {
-                const typename Intersections<PointT>::Intersection&
-                        intersection = intersectionsVec[pair];
-
-                if (invert)
-                {
-                    std::fill_n(out + rowIdx, intersection.first, color);
-
-                    std::fill_n(out + rowIdx + intersection.last + 1,
-                                numCols - intersection.last - 1,
-                                color);
-                }
-                else
-                {
-                    std::fill_n(out + rowIdx + intersection.first,
-                                intersection.length(),
-                                color);
-                }
+                tilePolygons[nextIdx[tileRow * numTileCols + tileCol]++] = ii;
             }
         }
     }
+
+    const detail::DrawTile<PointT, OutT> op(
+            polygons, colors, numRows, numCols, out, invert, offset,
+            tileSize, numTileCols, tileOffsets, tilePolygons);
+    if (numThreads > 1)
+    {
+        mt::runBalanced1D(numTiles, numThreads, op);
+    }
+    else
+    {
+        for (size_t tile = 0; tile < numTiles; ++tile)
+        {
+            op(tile);
+        }
+    }
 }
 }
 
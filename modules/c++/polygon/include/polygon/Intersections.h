@@ -25,11 +25,153 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
 #include <types/RowCol.h>
 
 namespace polygon
 {
+/*!
+ * How to decide whether a span between two crossings of a scan line is
+ * inside a polygon whose rings overlap or self-intersect
+ */
+enum FillRule
+{
+    //! Inside if it's crossed an odd number of times.  Holes are holes
+    //! regardless of the direction of their rings.
+    FILL_EVEN_ODD = 0,
+
+    //! Inside if the rings wind around it a nonzero number of times.  A
+    //! hole must run the opposite direction from the ring around it.
+    FILL_NONZERO
+};
+
+namespace detail
+{
+/*!
+ * Applies offset to the points of a ring, and moves any point lying
+ * exactly on a scan line slightly off of it
+ */
+template <typename PointT>
+void shiftRing(const std::vector<types::RowCol<PointT> >& points,
+               types::RowCol<sys::SSize_T> offset,
+               std::vector<types::RowCol<PointT> >& shiftedPoints)
+{
+    shiftedPoints = points;
+    for (size_t ii = 0; ii < shiftedPoints.size(); ++ii)
+    {
+        // Get the polygon points with respect to the offset
+        shiftedPoints[ii].row -= offset.row;
+        shiftedPoints[ii].col -= offset.col;
+
+        // TODO: The original implementation did this (plus subtracted 0.5
+        //       from each row and col which we're not doing here).
+        //       Without this small delta, if you have points that are
+        //       right on a row, we skip drawing some rows
+        //       (test_draw_polygon will illustrate this). I wonder if we
+        //       could tweak the sl0 and sl1 logic to avoid this.
+        PointT& rowPoint(shiftedPoints[ii].row);
+        if (std::floor(rowPoint) == rowPoint)
+        {
+            // Add small amount to move it off the scan line
+            rowPoint += 0.0001;
+        }
+    }
+}
+
+/*!
+ * Rounds the span between crossings first and last to columns, clamped to
+ * [0, numCols), and adds it to intersections
+ */
+template <typename IntersectionT>
+void addIntersection(double first, double last, size_t numCols,
+                     std::vector<IntersectionT>& intersections)
+{
+    // If the pair of intersections lies outside of the image,
+    // there is no intersection for this pair.
+    const double lastCol = numCols - 1;
+    if ((first < 0.0 && last < 0.0) ||
+        (first > lastCol && last > lastCol))
+    {
+        return;
+    }
+
+    // Clamp the intersections to the image boundary
+    first = std::max(0.0, std::min(lastCol, first));
+    last = std::max(0.0, std::min(lastCol, last));
+
+    IntersectionT intersection;
+    intersection.first = static_cast<size_t>(std::ceil(first));
+    intersection.last = static_cast<size_t>(std::floor(last));
+
+    if(intersection.last > intersection.first)
+    {
+        intersections.push_back(intersection);
+    }
+    else
+    {
+        if (first < last)
+        {
+            // This happens when first = 55.01, last = 55.99
+            // Then intersection.first = 56, intersection.last = 55
+            // We should count 55 as an intersection
+            intersection.first = intersection.last;
+            intersections.push_back(intersection);
+        }
+    }
+}
+
+/*!
+ * Adds the intersections between a row's sorted crossings.  directions
+ * holds +1 or -1 per crossing for FILL_NONZERO, and is NULL for
+ * FILL_EVEN_ODD.  A row with an odd number of crossings has none.
+ */
+template <typename PointT, typename IntersectionT>
+void getIntersections(const std::vector<PointT>& crossings,
+                      const std::vector<signed char>* directions,
+                      size_t numCols,
+                      std::vector<IntersectionT>& intersections)
+{
+    if (crossings.empty() || crossings.size() % 2 != 0)
+    {
+        // No intersections on this row
+        return;
+    }
+
+    if (directions)
+    {
+        // A span runs from where the winding number leaves zero to
+        // where it returns to it
+        int winding = 0;
+        double first = 0.0;
+        for (size_t idx = 0; idx < crossings.size(); ++idx)
+        {
+            if (winding == 0)
+            {
+                first = static_cast<double>(crossings[idx]);
+            }
+            winding += (*directions)[idx];
+            if (winding == 0)
+            {
+                addIntersection(first,
+                                static_cast<double>(crossings[idx]),
+                                numCols,
+                                intersections);
+            }
+        }
+        return;
+    }
+
+    const size_t numPairs = crossings.size() / 2;
+    for (size_t pair = 0, idx = 0; pair < numPairs; ++pair)
+    {
+        const double first = static_cast<double>(crossings[idx++]);
+        const double last = static_cast<double>(crossings[idx++]);
+        addIntersection(first, last, numCols, intersections);
+    }
+}
+}
+
 /*!
  * \class Intersections
  * \brief Given a list of points, draws lines between them to create a
@@ -45,6 +187,9 @@ namespace polygon
  * directly on a scanline.  Since the fill algorithm is conservative,
  * horizontal-top-edges will typically not be filled in.  For instance, a
  * square will have 1 pixel of its top edge missing.
+ *
+ * The polygon may have several rings (e.g. islands and holes), in which
+ * case the FillRule decides which spans between crossings are inside.
  */
 template <typename PointT>
 class Intersections
@@ -83,14 +228,37 @@ public:
                   const types::RowCol<size_t>& dims,
                   types::RowCol<sys::SSize_T> offset =
                           types::RowCol<sys::SSize_T>(0, 0)) :
-        mDims(dims)
+        mDims(dims),
+        mFillRule(FILL_EVEN_ODD)
     {
         if (!points.empty())
         {
-            computeIntersections(points, dims, offset);
+            computeIntersections(
+                    std::vector<std::vector<types::RowCol<PointT> > >(
+                            1, points),
+                    dims, offset);
         }
     }
 
+    /*!
+     * \param rings List of rings, each a list of points.  Each ring is
+     * closed, as with a single polygon.
+     * \param dims Dimensions to compute the polygon over
+     * \param fillRule How to treat overlapping rings
+     * \param offset Offset to apply to all input points, as above
+     */
+    Intersections(
+            const std::vector<std::vector<types::RowCol<PointT> > >& rings,
+            const types::RowCol<size_t>& dims,
+            FillRule fillRule = FILL_EVEN_ODD,
+            types::RowCol<sys::SSize_T> offset =
+                    types::RowCol<sys::SSize_T>(0, 0)) :
+        mDims(dims),
+        mFillRule(fillRule)
+    {
+        computeIntersections(rings, dims, offset);
+    }
+
     /*!
      * \param row Row to get intersections for
      * \param[out] intersections Polygon intersections for this row.  If the
@@ -108,52 +276,11 @@ public:
             return;
         }
 
-        const std::vector<PointT>& interRow(mIntersections[row]);
-        if (interRow.empty() || interRow.size() % 2 != 0)
-        {
-            // No intersections on this row
-            return;
-        }
-
-        const size_t numPairs = interRow.size() / 2;
-        for (size_t pair = 0, idx = 0; pair < numPairs; ++pair)
-        {
-            double first = static_cast<double>(interRow[idx++]);
-            double last = static_cast<double>(interRow[idx++]);
-
-            // If the pair of intersections lies outside of the image,
-            // there is no intersection for this pair.
-            const double lastCol = mDims.col - 1;
-            if ((first < 0.0 && last < 0.0) ||
-                (first > lastCol && last > lastCol))
-            {
-                continue;
-            }
-
-            // Clamp the intersections to the image boundary
-            first = std::max(0.0, std::min(lastCol, first));
-            last = std::max(0.0, std::min(lastCol, last));
-
-            Intersection intersection;
-            intersection.first = static_cast<size_t>(std::ceil(first));
-            intersection.last = static_cast<size_t>(std::floor(last));
-
-            if(intersection.last > intersection.first)
-            {
-                intersections.push_back(intersection);
-            }
-            else
-            {
-                if (first < last)
-                {
-                    // This happens when first = 55.01, last = 55.99
-                    // Then intersection.first = 56, intersection.last = 55
-                    // We should count 55 as an intersection
-                    intersection.first = intersection.last;
-                    intersections.push_back(intersection);
-                }
-            }
-        }
+        detail::getIntersections(
+                mIntersections[row],
+                (mFillRule == FILL_NONZERO) ? &mDirections[row] : NULL,
+                mDims.col,
+                intersections);
     }
 
 private:
@@ -167,33 +294,68 @@ private:
     }
 
     void computeIntersections(
-            const std::vector<types::RowCol<PointT> >& points,
+            const std::vector<std::vector<types::RowCol<PointT> > >& rings,
             const types::RowCol<size_t>& dims,
             types::RowCol<sys::SSize_T> offset)
     {
-        std::vector<types::RowCol<PointT> > shiftedPoints(points);
-        for (size_t ii = 0; ii < shiftedPoints.size(); ++ii)
+        // We need to get all scanline intersections of polygon edges
+        mIntersections.resize(dims.row);
+        if (mFillRule == FILL_NONZERO)
+        {
+            mDirections.resize(dims.row);
+        }
+
+        for (size_t ring = 0; ring < rings.size(); ++ring)
+        {
+            addRing(rings[ring], dims, offset);
+        }
+
+        // We're going to need these sorted eventually - might as well do it
+        // now
+        std::vector<std::pair<PointT, signed char> > crossings;
+        for (size_t row = 0; row < mIntersections.size(); ++row)
         {
-            // Get the polygon points with respect to the offset
-            shiftedPoints[ii].row -= offset.row;
-            shiftedPoints[ii].col -= offset.col;
-
-            // TODO: The original implementation did this (plus subtracted 0.5
-            //       from each row and col which we're not doing here).
-            //       Without this small delta, if you have points that are
-            //       right on a row, we skip drawing some rows
-            //       (test_draw_polygon will illustrate this). I wonder if we
-            //       could tweak the sl0 and sl1 logic to avoid this.
-            PointT& rowPoint(shiftedPoints[ii].row);
-            if (std::floor(rowPoint) == rowPoint)
+            std::vector<PointT>& interRow(mIntersections[row]);
+            if (interRow.size() % 2 != 0)
             {
-                // Add small amount to move it off the scan line
-                rowPoint += 0.0001;
+                continue;
+            }
+
+            if (mFillRule == FILL_NONZERO)
+            {
+                // The directions have to move with the crossings
+                std::vector<signed char>& directions(mDirections[row]);
+                crossings.resize(interRow.size());
+                for (size_t idx = 0; idx < interRow.size(); ++idx)
+                {
+                    crossings[idx] = std::make_pair(interRow[idx],
+                                                    directions[idx]);
+                }
+                std::sort(crossings.begin(), crossings.end());
+                for (size_t idx = 0; idx < interRow.size(); ++idx)
+                {
+                    interRow[idx] = crossings[idx].first;
+                    directions[idx] = crossings[idx].second;
+                }
+            }
+            else
+            {
+                std::sort(interRow.begin(), interRow.end());
             }
         }
+    }
 
-        // We need to get all scanline intersections of polygon edges
-        mIntersections.resize(dims.row);
+    void addRing(const std::vector<types::RowCol<PointT> >& points,
+                 const types::RowCol<size_t>& dims,
+                 types::RowCol<sys::SSize_T> offset)
+    {
+        if (points.empty())
+        {
+            return;
+        }
+
+        std::vector<types::RowCol<PointT> > shiftedPoints;
+        detail::shiftRing(points, offset, shiftedPoints);
 
         const sys::SSize_T lastRow = static_cast<sys::SSize_T>(dims.row) - 1;
 
@@ -212,6 +374,9 @@ private:
                 continue;
             }
 
+            // +1 for an edge running down the rows, -1 for up
+            const signed char direction = (r1 > r0) ? 1 : -1;
+
             // Make sure r0 < r1
             orderPoints(r0, c0, r1, c1);
 
@@ -259,24 +424,21 @@ private:
                 const PointT delt = row - r0;
                 const PointT sli = c0 + delt * dcdr;
                 mIntersections[row].push_back(sli);
-            }
-        }
-
-        // We're going to need these sorted eventually - might as well do it
-        // now
-        for (size_t row = 0; row < mIntersections.size(); ++row)
-        {
-            std::vector<PointT>& interRow(mIntersections[row]);
-            if (interRow.size() % 2 == 0)
-            {
-                std::sort(interRow.begin(), interRow.end());
+                if (mFillRule == FILL_NONZERO)
+                {
+                    mDirections[row].push_back(direction);
+                }
             }
         }
     }
 
 private:
     const types::RowCol<size_t> mDims;
+    const FillRule mFillRule;
     std::vector<std::vector<PointT> > mIntersections;
+
+    // Per crossing in mIntersections, +1 or -1 (only for FILL_NONZERO)
+    std::vector<std::vector<signed char> > mDirections;
 };
 }
 
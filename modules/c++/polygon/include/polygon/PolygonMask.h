@@ -35,6 +35,9 @@ namespace polygon
  * \class PolygonMask
  * \brief Acts as a mask for a convex polygon without actually allocating a
  * bool buffer to draw it.
+ *
+ * Only one range is kept per row, so polygons are replaced by their convex
+ * hull.  Use SpanMask for concave or multi-part polygons.
  */
 class PolygonMask
 {
@@ -46,6 +49,17 @@ public:
         MARK_USING_POINTS
     };
 
+    //! How the pixels of a raster mask are stored
+    enum MaskFormatsEnum
+    {
+        //! One byte per pixel; nonzero means a valid pixel
+        BYTE_MASK = 0,
+
+        //! One bit per pixel, most significant bit first, with each row
+        //! starting on a new byte; a set bit means a valid pixel
+        BIT_PACKED_MASK
+    };
+
     /*!
      * Use this for a polygon that should always report true or false
      *
@@ -65,9 +79,25 @@ public:
      * constructor.
      * \param dims Dimensions the polygon should be considered over.  Pixels
      * outside of these dimensions will get reported as outside the polygon.
+     * \param numThreads Number of threads to scan the rows with
      */
     PolygonMask(const bool* mask,
-                const types::RowCol<size_t>& dims);
+                const types::RowCol<size_t>& dims,
+                size_t numThreads = 1);
+
+    /*!
+     * As above, for a mask stored as bytes or bits (e.g. a classification
+     * raster)
+     *
+     * \param mask An existing polygon mask, in the given format
+     * \param dims Dimensions of the mask
+     * \param format How the mask is stored
+     * \param numThreads Number of threads to scan the rows with
+     */
+    PolygonMask(const sys::Uint8_T* mask,
+                const types::RowCol<size_t>& dims,
+                MaskFormatsEnum format = BYTE_MASK,
+                size_t numThreads = 1);
 
     /*!
      * \param points Vector specifying the convex polygon.
@@ -136,6 +166,12 @@ public:
         return mMarkMode;
     }
 
+    //! \return The dimensions the polygon is considered over
+    const types::RowCol<size_t>& getDims() const
+    {
+        return mDims;
+    }
+
     /*!
      * \return The number of masked pixels in the specified dimensions
      */
@@ -150,6 +186,10 @@ public:
     }
 
 private:
+    void findRanges(const sys::Uint8_T* mask,
+                    MaskFormatsEnum format,
+                    size_t numThreads);
+
     void checkForAllTrueOrFalseRanges();
 
 private:
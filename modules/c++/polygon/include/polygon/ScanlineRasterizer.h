@@ -0,0 +1,386 @@
+/* =========================================================================
+ * This file is part of polygon-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * polygon-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __POLYGON_SCANLINE_RASTERIZER_H__
+#define __POLYGON_SCANLINE_RASTERIZER_H__
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <sys/Conf.h>
+#include <types/RowCol.h>
+
+#include <polygon/Intersections.h>
+
+namespace polygon
+{
+/*!
+ * \class ScanlineRasterizer
+ * \brief Reports the same intersections as Intersections, but works down
+ * the rows with an active edge table rather than storing every row's
+ * crossings up front.
+ *
+ * The polygon's edges are sorted by their top row once.  Moving down the
+ * image, edges are added to the active list as the scan line reaches
+ * them and dropped once it passes them, so only the crossings of the
+ * current row are ever held.  Memory is proportional to the number of
+ * edges, not rows, which matters for tall images.  Rows are cheapest to
+ * ask for in increasing order; asking for an earlier row starts over.
+ *
+ * It can also report how much of each pixel of a row the polygon covers,
+ * for anti-aliasing.
+ *
+ * \tparam PointT Data type of points.  Must be a floating type (float/double)
+ * to work properly
+ */
+template <typename PointT>
+class ScanlineRasterizer
+{
+public:
+    typedef typename Intersections<PointT>::Intersection Intersection;
+
+    /*!
+     * \param points List of points
+     * \param dims Dimensions to compute the polygon over
+     * \param offset Offset to apply to all input points, as for
+     * Intersections.  Defaults to no offset.
+     */
+    ScanlineRasterizer(const std::vector<types::RowCol<PointT> >& points,
+                       const types::RowCol<size_t>& dims,
+                       types::RowCol<sys::SSize_T> offset =
+                               types::RowCol<sys::SSize_T>(0, 0)) :
+        mDims(dims),
+        mFillRule(FILL_EVEN_ODD)
+    {
+        addRing(points, offset);
+        std::sort(mEdges.begin(), mEdges.end());
+        reset();
+    }
+
+    /*!
+     * \param rings List of rings, each a list of points
+     * \param dims Dimensions to compute the polygon over
+     * \param fillRule How to treat overlapping rings
+     * \param offset Offset to apply to all input points
+     */
+    ScanlineRasterizer(
+            const std::vector<std::vector<types::RowCol<PointT> > >& rings,
+            const types::RowCol<size_t>& dims,
+            FillRule fillRule = FILL_EVEN_ODD,
+            types::RowCol<sys::SSize_T> offset =
+                    types::RowCol<sys::SSize_T>(0, 0)) :
+        mDims(dims),
+        mFillRule(fillRule)
+    {
+        for (size_t ring = 0; ring < rings.size(); ++ring)
+        {
+            addRing(rings[ring], offset);
+        }
+        std::sort(mEdges.begin(), mEdges.end());
+        reset();
+    }
+
+    //! \return The dimensions the polygon is computed over
+    const types::RowCol<size_t>& getDims() const
+    {
+        return mDims;
+    }
+
+    //! Starts over from the first row
+    void reset()
+    {
+        mNextEdge = 0;
+        mActive.clear();
+        mRow = 0;
+    }
+
+    /*!
+     * \param row Row to get intersections for
+     * \param[out] intersections Polygon intersections for this row, exactly
+     * as Intersections::get() gives them
+     */
+    void get(size_t row, std::vector<Intersection>& intersections)
+    {
+        intersections.clear();
+        if (row >= mDims.row)
+        {
+            return;
+        }
+        moveTo(row);
+
+        // Scan line row crosses the edges that span it
+        const PointT scanRow =
+                static_cast<PointT>(static_cast<sys::SSize_T>(row));
+        mCrossings.clear();
+        for (size_t ii = 0; ii < mActive.size(); ++ii)
+        {
+            const Edge& edge(mActive[ii]);
+            if (edge.r0 <= scanRow && scanRow <= edge.r1)
+            {
+                const PointT delt = scanRow - edge.r0;
+                mCrossings.push_back(std::make_pair(edge.c0 + delt * edge.dcdr,
+                                                    edge.direction));
+            }
+        }
+
+        sortCrossings();
+        detail::getIntersections(
+                mCols,
+                (mFillRule == FILL_NONZERO) ? &mDirections : NULL,
+                mDims.col,
+                intersections);
+    }
+
+    /*!
+     * Computes the fraction of each pixel of a row inside the polygon.
+     * Pixel (row, col) is the unit square centered on (row, col).  The
+     * area is found exactly across each sub-row and sampled at numSubRows
+     * evenly spaced sub-rows down the pixel.  This uses the same polygon
+     * as get(), so vertices exactly on a row are moved off it by the same
+     * tiny amount.
+     *
+     * \param row Row to compute
+     * \param[out] coverage dims.col values from 0 to 1
+     * \param numSubRows Number of sub-rows to sample per row
+     */
+    template <typename CoverageT>
+    void getCoverage(size_t row, CoverageT* coverage, size_t numSubRows = 4)
+    {
+        std::fill_n(coverage, mDims.col, CoverageT(0));
+        if (row >= mDims.row)
+        {
+            return;
+        }
+        moveTo(row);
+
+        numSubRows = std::max<size_t>(numSubRows, 1);
+        const double weight = 1.0 / numSubRows;
+        for (size_t sub = 0; sub < numSubRows; ++sub)
+        {
+            // Edges are half open, [r0, r1), so a vertex shared by two
+            // edges is crossed once
+            const PointT subRow = static_cast<PointT>(
+                    row - 0.5 + (sub + 0.5) * weight);
+            mCrossings.clear();
+            for (size_t ii = 0; ii < mActive.size(); ++ii)
+            {
+                const Edge& edge(mActive[ii]);
+                if (edge.r0 <= subRow && subRow < edge.r1)
+                {
+                    mCrossings.push_back(std::make_pair(
+                            edge.c0 + (subRow - edge.r0) * edge.dcdr,
+                            edge.direction));
+                }
+            }
+            sortCrossings();
+            if (mCols.size() % 2 != 0)
+            {
+                continue;
+            }
+
+            if (mFillRule == FILL_NONZERO)
+            {
+                int winding = 0;
+                double first = 0.0;
+                for (size_t idx = 0; idx < mCols.size(); ++idx)
+                {
+                    if (winding == 0)
+                    {
+                        first = mCols[idx];
+                    }
+                    winding += mDirections[idx];
+                    if (winding == 0)
+                    {
+                        addCoverage(first, mCols[idx], weight, coverage);
+                    }
+                }
+            }
+            else
+            {
+                for (size_t idx = 0; idx < mCols.size(); idx += 2)
+                {
+                    addCoverage(mCols[idx], mCols[idx + 1], weight,
+                                coverage);
+                }
+            }
+        }
+    }
+
+private:
+    struct Edge
+    {
+        // Top (r0 < r1) and bottom of the edge
+        PointT r0;
+        PointT c0;
+        PointT r1;
+
+        // Rate of change of column with row
+        PointT dcdr;
+
+        // +1 for an edge running down the rows, -1 for up
+        signed char direction;
+
+        bool operator<(const Edge& rhs) const
+        {
+            return r0 < rhs.r0;
+        }
+    };
+
+    void addRing(const std::vector<types::RowCol<PointT> >& points,
+                 types::RowCol<sys::SSize_T> offset)
+    {
+        if (points.empty())
+        {
+            return;
+        }
+
+        std::vector<types::RowCol<PointT> > shiftedPoints;
+        detail::shiftRing(points, offset, shiftedPoints);
+
+        for (size_t ii = 0; ii < shiftedPoints.size(); ++ii)
+        {
+            const size_t prev = (ii == 0) ? shiftedPoints.size() - 1 : ii - 1;
+            PointT r0(shiftedPoints[prev].row);
+            PointT c0(shiftedPoints[prev].col);
+            PointT r1(shiftedPoints[ii].row);
+            PointT c1(shiftedPoints[ii].col);
+
+            // Skip horizontal lines
+            if (r1 == r0)
+            {
+                continue;
+            }
+
+            Edge edge;
+            edge.direction = (r1 > r0) ? 1 : -1;
+            if (r0 > r1)
+            {
+                std::swap(r0, r1);
+                std::swap(c0, c1);
+            }
+            edge.r0 = r0;
+            edge.c0 = c0;
+            edge.r1 = r1;
+            edge.dcdr = (c1 - c0) / (r1 - r0);
+            mEdges.push_back(edge);
+        }
+    }
+
+    // Brings the active edges up to date for row, i.e. those reaching
+    // into [row - 0.5, row + 0.5]
+    void moveTo(size_t row)
+    {
+        if (row < mRow)
+        {
+            reset();
+        }
+        mRow = row;
+
+        const double top = row - 0.5;
+        const double bottom = row + 0.5;
+        for (size_t ii = 0; ii < mActive.size(); )
+        {
+            if (mActive[ii].r1 < top)
+            {
+                mActive[ii] = mActive.back();
+                mActive.pop_back();
+            }
+            else
+            {
+                ++ii;
+            }
+        }
+        for (; mNextEdge < mEdges.size() && mEdges[mNextEdge].r0 <= bottom;
+             ++mNextEdge)
+        {
+            if (mEdges[mNextEdge].r1 >= top)
+            {
+                mActive.push_back(mEdges[mNextEdge]);
+            }
+        }
+    }
+
+    // Sorts mCrossings by column into mCols and mDirections
+    void sortCrossings()
+    {
+        std::sort(mCrossings.begin(), mCrossings.end());
+        mCols.resize(mCrossings.size());
+        mDirections.resize(mCrossings.size());
+        for (size_t idx = 0; idx < mCrossings.size(); ++idx)
+        {
+            mCols[idx] = mCrossings[idx].first;
+            mDirections[idx] = mCrossings[idx].second;
+        }
+    }
+
+    // Adds weight times the length of [first, last) in each pixel to
+    // coverage
+    template <typename CoverageT>
+    void addCoverage(double first, double last, double weight,
+                     CoverageT* coverage) const
+    {
+        first = std::max(first, -0.5);
+        last = std::min(last, mDims.col - 0.5);
+        if (!(last > first))
+        {
+            return;
+        }
+
+        const size_t col0 = static_cast<size_t>(first + 0.5);
+        const size_t col1 = std::min(static_cast<size_t>(last + 0.5),
+                                     mDims.col - 1);
+        if (col0 == col1)
+        {
+            coverage[col0] += static_cast<CoverageT>((last - first) * weight);
+            return;
+        }
+
+        coverage[col0] += static_cast<CoverageT>((col0 + 0.5 - first) * weight);
+        for (size_t col = col0 + 1; col < col1; ++col)
+        {
+            coverage[col] += static_cast<CoverageT>(weight);
+        }
+        coverage[col1] += static_cast<CoverageT>((last - (col1 - 0.5)) * weight);
+    }
+
+private:
+    const types::RowCol<size_t> mDims;
+    const FillRule mFillRule;
+
+    // Every edge, sorted by r0
+    std::vector<Edge> mEdges;
+
+    // The first edge of mEdges not yet reached, and the edges reaching
+    // the current row
+    size_t mNextEdge;
+    std::vector<Edge> mActive;
+    size_t mRow;
+
+    // Scratch space for a row's crossings
+    std::vector<std::pair<PointT, signed char> > mCrossings;
+    std::vector<PointT> mCols;
+    std::vector<signed char> mDirections;
+};
+}
+
+#endif
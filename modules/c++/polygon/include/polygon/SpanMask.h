@@ -0,0 +1,239 @@
+/* =========================================================================
+ * This file is part of polygon-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * polygon-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __POLYGON_SPAN_MASK_H__
+#define __POLYGON_SPAN_MASK_H__
+
+#include <vector>
+
+#include <sys/Conf.h>
+#include <types/RowCol.h>
+#include <types/Range.h>
+
+#include <polygon/ScanlineRasterizer.h>
+#include <polygon/PolygonMask.h>
+
+namespace polygon
+{
+/*!
+ * \class SpanMask
+ * \brief A run-length mask: any number of column spans per row
+ *
+ * Unlike PolygonMask, which keeps one range per row and so needs a convex
+ * polygon, this holds every span inside a concave or multi-part polygon,
+ * including ones with holes.  The spans of all rows are stored in one
+ * array, row after row, with the offset of each row's first span in
+ * another.  Within a row, spans are sorted, and neither overlap nor touch.
+ *
+ * Kernels can walk the spans directly:
+ *
+ * \code
+    for (size_t row = 0; row < mask.getDims().row; ++row)
+    {
+        for (const types::Range* span = mask.beginSpans(row);
+             span != mask.endSpans(row);
+             ++span)
+        {
+            process(row, span->mStartElement, span->mNumElements);
+        }
+    }
+ * \endcode
+ */
+class SpanMask
+{
+public:
+    /*!
+     * An empty mask
+     *
+     * \param dims Dimensions the mask is over
+     */
+    explicit SpanMask(const types::RowCol<size_t>& dims =
+                              types::RowCol<size_t>(0, 0));
+
+    /*!
+     * \param points The polygon.  It need not be convex.
+     * \param dims Dimensions the polygon should be considered over.  Pixels
+     * outside of these dimensions will get reported as outside the polygon.
+     * \param fillRule How to treat a self-intersecting polygon
+     * \param offset Number of rows and cols to offset polygon, as for
+     * PolygonMask.  Defaults to no offset.
+     */
+    SpanMask(const std::vector<types::RowCol<double> >& points,
+             const types::RowCol<size_t>& dims,
+             FillRule fillRule = FILL_EVEN_ODD,
+             types::RowCol<sys::SSize_T> offset =
+                     types::RowCol<sys::SSize_T>(0, 0));
+
+    /*!
+     * \param rings The rings of the polygon, e.g. an outer boundary and
+     * the holes in it, or several separate parts
+     * \param dims Dimensions the polygon should be considered over
+     * \param fillRule Which areas the rings enclose
+     * \param offset Number of rows and cols to offset polygon
+     */
+    SpanMask(const std::vector<std::vector<types::RowCol<double> > >& rings,
+             const types::RowCol<size_t>& dims,
+             FillRule fillRule = FILL_EVEN_ODD,
+             types::RowCol<sys::SSize_T> offset =
+                     types::RowCol<sys::SSize_T>(0, 0));
+
+    /*!
+     * \param mask An existing mask where true means a valid pixel.  Unlike
+     * PolygonMask, this keeps every run of true pixels.
+     * \param dims Dimensions of mask
+     */
+    SpanMask(const bool* mask,
+             const types::RowCol<size_t>& dims);
+
+    //! \param mask A PolygonMask to convert
+    explicit SpanMask(const PolygonMask& mask);
+
+    //! \return The dimensions of the mask
+    const types::RowCol<size_t>& getDims() const
+    {
+        return mDims;
+    }
+
+    //! \return The total number of spans
+    size_t getNumSpans() const
+    {
+        return mSpans.size();
+    }
+
+    //! \return The number of spans on row
+    size_t getNumSpans(size_t row) const
+    {
+        return endSpans(row) - beginSpans(row);
+    }
+
+    //! \return The first span on row
+    const types::Range* beginSpans(size_t row) const
+    {
+        return mSpans.empty() ? NULL :
+                &mSpans[0] + mRowOffsets[std::min(row, mDims.row)];
+    }
+
+    //! \return One past the last span on row
+    const types::Range* endSpans(size_t row) const
+    {
+        return mSpans.empty() ? NULL :
+                &mSpans[0] + mRowOffsets[std::min(row + 1, mDims.row)];
+    }
+
+    /*!
+     * Calls op(row, span) for every span, in order
+     *
+     * \param op Functor taking a size_t row and a const types::Range&
+     */
+    template <typename OpT>
+    void forEachSpan(OpT& op) const
+    {
+        for (size_t row = 0, idx = 0; row < mDims.row; ++row)
+        {
+            for (const size_t end = mRowOffsets[row + 1]; idx < end; ++idx)
+            {
+                op(row, mSpans[idx]);
+            }
+        }
+    }
+
+    /*!
+     * \param row Row to query
+     * \param col Column to query
+     *
+     * \return True if the point is inside the polygon, false otherwise
+     */
+    bool isInPolygon(size_t row, size_t col) const;
+
+    /*!
+     * \param point Point to query
+     *
+     * \return True if the point is inside the polygon, false otherwise
+     */
+    bool isInPolygon(const types::RowCol<size_t>& point) const
+    {
+        return isInPolygon(point.row, point.col);
+    }
+
+    //! \return The number of pixels inside the polygon
+    size_t getNumMaskedPixels() const;
+
+    //! \return The number of pixels outside the polygon
+    size_t getNumUnmaskedPixels() const
+    {
+        return mDims.area() - getNumMaskedPixels();
+    }
+
+    /*!
+     * \return The pixels in either this mask or rhs
+     *
+     * \throws Exception if the dimensions differ
+     */
+    SpanMask unite(const SpanMask& rhs) const;
+
+    /*!
+     * \return The pixels in both this mask and rhs
+     *
+     * \throws Exception if the dimensions differ
+     */
+    SpanMask intersect(const SpanMask& rhs) const;
+
+    /*!
+     * \return The pixels in this mask but not rhs
+     *
+     * \throws Exception if the dimensions differ
+     */
+    SpanMask subtract(const SpanMask& rhs) const;
+
+    bool operator==(const SpanMask& rhs) const;
+
+    bool operator!=(const SpanMask& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+private:
+    void addIntersections(ScanlineRasterizer<double>& rasterizer);
+
+    // Appends a span to the current (last) row, merging it into the
+    // previous span if they overlap or touch
+    void addSpan(size_t rowStart, const types::Range& span);
+
+    // Closes out the current row
+    void endRow()
+    {
+        mRowOffsets.push_back(mSpans.size());
+    }
+
+    template <typename OpT>
+    SpanMask combine(const SpanMask& rhs, OpT op) const;
+
+private:
+    types::RowCol<size_t> mDims;
+
+    // mDims.row + 1 offsets into mSpans; row r has
+    // [mRowOffsets[r], mRowOffsets[r + 1])
+    std::vector<size_t> mRowOffsets;
+    std::vector<types::Range> mSpans;
+};
+}
+
+#endif
@@ -19,75 +19,220 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <string.h>
 #include <sstream>
 #include <limits>
 
 #include <sys/Conf.h>
 #include <except/Exception.h>
 #include <math/ConvexHull.h>
+#include <mt/BalancedRunnable1D.h>
 
-#include <polygon/Intersections.h>
+#include <polygon/ScanlineRasterizer.h>
 
 #include <polygon/PolygonMask.h>
 
-namespace polygon
+namespace
 {
-PolygonMask::PolygonMask(MarkModesEnum markMode,
-                         const types::RowCol<size_t>& dims) :
-    mMarkMode(markMode),
-    mDims(dims)
+/*
+ * Masks are mostly runs of zeros, so these skip over them a word rather
+ * than a byte at a time
+ */
+typedef sys::Uint64_T Word;
+
+// \return The index of the first nonzero byte in [0, size), or size if
+// there isn't one
+size_t findFirstSet(const sys::Uint8_T* bytes, size_t size)
 {
-    if (mMarkMode != MARK_ALL_TRUE && mMarkMode != MARK_ALL_FALSE)
+    size_t idx = 0;
+    for (Word word; idx + sizeof(Word) <= size; idx += sizeof(Word))
     {
-        throw except::Exception(Ctxt("Invalid mark mode"));
+        ::memcpy(&word, bytes + idx, sizeof(Word));
+        if (word != 0)
+        {
+            break;
+        }
+    }
+    for (; idx < size; ++idx)
+    {
+        if (bytes[idx] != 0)
+        {
+            return idx;
+        }
     }
+    return size;
 }
 
-PolygonMask::PolygonMask(const bool* mask,
-                         const types::RowCol<size_t>& dims) :
-    mMarkMode(MARK_USING_POINTS),
-    mRanges(new types::Range[dims.row]),
-    mDims(dims)
+// \return The index of the last nonzero byte in [0, size), or size if
+// there isn't one
+size_t findLastSet(const sys::Uint8_T* bytes, size_t size)
+{
+    size_t end = size;
+    for (Word word; end >= sizeof(Word); end -= sizeof(Word))
+    {
+        ::memcpy(&word, bytes + end - sizeof(Word), sizeof(Word));
+        if (word != 0)
+        {
+            break;
+        }
+    }
+    while (end > 0)
+    {
+        if (bytes[--end] != 0)
+        {
+            return end;
+        }
+    }
+    return size;
+}
+
+// \return The position of the first (most significant) set bit of a
+// nonzero byte
+size_t firstBit(sys::Uint8_T byte)
+{
+    size_t bit = 0;
+    while (!(byte & (0x80 >> bit)))
+    {
+        ++bit;
+    }
+    return bit;
+}
+
+// \return The position of the last (least significant) set bit of a
+// nonzero byte
+size_t lastBit(sys::Uint8_T byte)
+{
+    size_t bit = 7;
+    while (!(byte & (0x80 >> bit)))
+    {
+        --bit;
+    }
+    return bit;
+}
+
+// Sets the range of each row of a mask to span its first to last
+// valid pixel
+class FindRange
 {
-    // TODO: Could thread this but if we really care about performance,
-    //       shouldn't be using this constructor anyway
+public:
+    FindRange(const sys::Uint8_T* mask,
+              size_t numCols,
+              bool bitPacked,
+              types::Range* ranges) :
+        mMask(mask),
+        mNumCols(numCols),
+        mBitPacked(bitPacked),
+        mRowStride(bitPacked ? (numCols + 7) / 8 : numCols),
+        mRanges(ranges)
+    {
+    }
+
+    void operator()(size_t row) const
+    {
+        const sys::Uint8_T* const rowMask = mMask + row * mRowStride;
+        size_t first;
+        size_t last;
+        const bool found = mBitPacked ?
+                findBits(rowMask, first, last) :
+                findBytes(rowMask, first, last);
+
+        mRanges[row] = found ? types::Range(first, last - first + 1) :
+                               types::Range();
+    }
 
-    for (size_t row = 0, rowIdx = 0; row < dims.row; ++row, rowIdx += dims.col)
+private:
+    bool findBytes(const sys::Uint8_T* rowMask,
+                   size_t& first,
+                   size_t& last) const
     {
-        // Find the first valid col in this row, searching left to right
-        size_t start(std::numeric_limits<size_t>::max());
-        for (size_t col = 0; col < dims.col; ++col)
+        first = findFirstSet(rowMask, mNumCols);
+        if (first == mNumCols)
         {
-            if (mask[rowIdx + col])
-            {
-                start = col;
-                break;
-            }
+            return false;
         }
+        last = first + findLastSet(rowMask + first, mNumCols - first);
+        return true;
+    }
+
+    bool findBits(const sys::Uint8_T* rowMask,
+                  size_t& first,
+                  size_t& last) const
+    {
+        // The bits of a partial last byte past the last column are
+        // padding, so are ignored
+        const size_t numFullBytes = mNumCols / 8;
+        const size_t numTailBits = mNumCols % 8;
+        const sys::Uint8_T tail = numTailBits ?
+                (rowMask[numFullBytes] & (0xFF << (8 - numTailBits))) : 0;
 
-        if (start == std::numeric_limits<size_t>::max())
+        const size_t firstByte = findFirstSet(rowMask, numFullBytes);
+        if (firstByte < numFullBytes)
         {
-            // There were no valid pixels in this entire row
-            mRanges[row] = types::Range();
+            first = firstByte * 8 + firstBit(rowMask[firstByte]);
+        }
+        else if (tail != 0)
+        {
+            first = numFullBytes * 8 + firstBit(tail);
         }
         else
         {
-            // Find the last valid col in this row, searching right to left
-            size_t last(start);
-            for (size_t col = dims.col - 1; ; --col)
-            {
-                if (mask[rowIdx + col])
-                {
-                    last = col;
-                    break;
-                }
-            }
+            return false;
+        }
 
-            mRanges[row] = types::Range(start, last - start + 1);
+        if (tail != 0)
+        {
+            last = numFullBytes * 8 + lastBit(tail);
         }
+        else
+        {
+            const size_t lastByte =
+                    firstByte + findLastSet(rowMask + firstByte,
+                                            numFullBytes - firstByte);
+            last = lastByte * 8 + lastBit(rowMask[lastByte]);
+        }
+        return true;
     }
 
-    checkForAllTrueOrFalseRanges();
+    const sys::Uint8_T* const mMask;
+    const size_t mNumCols;
+    const bool mBitPacked;
+    const size_t mRowStride;
+    types::Range* const mRanges;
+};
+}
+
+namespace polygon
+{
+PolygonMask::PolygonMask(MarkModesEnum markMode,
+                         const types::RowCol<size_t>& dims) :
+    mMarkMode(markMode),
+    mDims(dims)
+{
+    if (mMarkMode != MARK_ALL_TRUE && mMarkMode != MARK_ALL_FALSE)
+    {
+        throw except::Exception(Ctxt("Invalid mark mode"));
+    }
+}
+
+PolygonMask::PolygonMask(const bool* mask,
+                         const types::RowCol<size_t>& dims,
+                         size_t numThreads) :
+    mMarkMode(MARK_USING_POINTS),
+    mDims(dims)
+{
+    // A bool is a byte that's 0 or 1
+    findRanges(reinterpret_cast<const sys::Uint8_T*>(mask), BYTE_MASK,
+               numThreads);
+}
+
+PolygonMask::PolygonMask(const sys::Uint8_T* mask,
+                         const types::RowCol<size_t>& dims,
+                         MaskFormatsEnum format,
+                         size_t numThreads) :
+    mMarkMode(MARK_USING_POINTS),
+    mDims(dims)
+{
+    findRanges(mask, format, numThreads);
 }
 
 PolygonMask::PolygonMask(const std::vector<types::RowCol<double> >& points,
@@ -110,15 +255,15 @@ PolygonMask::PolygonMask(const std::vector<types::RowCol<double> >& points,
         std::vector<types::RowCol<double> > convexHullPoints;
         math::ConvexHull<double> convexHull(rawPoints, convexHullPoints);
             
-        const Intersections<double>
-                intersections(convexHullPoints, mDims, offset);
+        ScanlineRasterizer<double>
+                rasterizer(convexHullPoints, mDims, offset);
         mRanges.reset(new types::Range[mDims.row]);
 
         std::vector<Intersections<double>::Intersection> intersectionsVec;
         for (size_t row = 0; row < mDims.row; ++row)
         {
             // We know we have a convex polygon
-            intersections.get(row, intersectionsVec);
+            rasterizer.get(row, intersectionsVec);
             if (intersectionsVec.empty())
             {
                 mRanges[row] = types::Range(); // Empty range
@@ -144,6 +289,33 @@ PolygonMask::PolygonMask(const std::vector<types::RowCol<double> >& points,
     }
 }
 
+void PolygonMask::findRanges(const sys::Uint8_T* mask,
+                             MaskFormatsEnum format,
+                             size_t numThreads)
+{
+    if (format != BYTE_MASK && format != BIT_PACKED_MASK)
+    {
+        throw except::Exception(Ctxt("Invalid mask format"));
+    }
+
+    mRanges.reset(new types::Range[mDims.row]);
+    const FindRange op(mask, mDims.col, format == BIT_PACKED_MASK,
+                       mRanges.get());
+    if (numThreads > 1)
+    {
+        mt::runBalanced1D(mDims.row, numThreads, op);
+    }
+    else
+    {
+        for (size_t row = 0; row < mDims.row; ++row)
+        {
+            op(row);
+        }
+    }
+
+    checkForAllTrueOrFalseRanges();
+}
+
 void PolygonMask::checkForAllTrueOrFalseRanges()
 {
     bool allRangesAreEmpty = true;
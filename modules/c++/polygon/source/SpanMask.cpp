@@ -0,0 +1,300 @@
+/* =========================================================================
+ * This file is part of polygon-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * polygon-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include <except/Exception.h>
+
+#include <polygon/SpanMask.h>
+
+namespace
+{
+// Whether a pixel in one, the other, or both masks is in the result
+struct Union
+{
+    bool operator()(bool inLhs, bool inRhs) const
+    {
+        return inLhs || inRhs;
+    }
+};
+
+struct Intersection
+{
+    bool operator()(bool inLhs, bool inRhs) const
+    {
+        return inLhs && inRhs;
+    }
+};
+
+struct Difference
+{
+    bool operator()(bool inLhs, bool inRhs) const
+    {
+        return inLhs && !inRhs;
+    }
+};
+
+// The idx'th boundary of a row's spans: even for where span idx / 2
+// starts, odd for where it ends.  Past the last span, max(size_t).
+size_t boundary(const types::Range* spans, size_t numSpans, size_t idx)
+{
+    if (idx >= 2 * numSpans)
+    {
+        return std::numeric_limits<size_t>::max();
+    }
+    const types::Range& span(spans[idx / 2]);
+    return (idx % 2 == 0) ? span.mStartElement : span.endElement();
+}
+
+// Orders a span by its start, for binary search
+bool startsBefore(size_t col, const types::Range& span)
+{
+    return col < span.mStartElement;
+}
+}
+
+namespace polygon
+{
+SpanMask::SpanMask(const types::RowCol<size_t>& dims) :
+    mDims(dims),
+    mRowOffsets(dims.row + 1, 0)
+{
+}
+
+SpanMask::SpanMask(const std::vector<types::RowCol<double> >& points,
+                   const types::RowCol<size_t>& dims,
+                   FillRule fillRule,
+                   types::RowCol<sys::SSize_T> offset) :
+    mDims(dims)
+{
+    ScanlineRasterizer<double> rasterizer(
+            std::vector<std::vector<types::RowCol<double> > >(1, points),
+            dims, fillRule, offset);
+    addIntersections(rasterizer);
+}
+
+SpanMask::SpanMask(
+        const std::vector<std::vector<types::RowCol<double> > >& rings,
+        const types::RowCol<size_t>& dims,
+        FillRule fillRule,
+        types::RowCol<sys::SSize_T> offset) :
+    mDims(dims)
+{
+    ScanlineRasterizer<double> rasterizer(rings, dims, fillRule, offset);
+    addIntersections(rasterizer);
+}
+
+SpanMask::SpanMask(const bool* mask,
+                   const types::RowCol<size_t>& dims) :
+    mDims(dims)
+{
+    mRowOffsets.reserve(dims.row + 1);
+    mRowOffsets.push_back(0);
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        const bool* const rowMask = mask + row * dims.col;
+        for (size_t col = 0; col < dims.col; )
+        {
+            // Find the start of the next run, then its end
+            while (col < dims.col && !rowMask[col])
+            {
+                ++col;
+            }
+            const size_t start = col;
+            while (col < dims.col && rowMask[col])
+            {
+                ++col;
+            }
+            if (col > start)
+            {
+                mSpans.push_back(types::Range(start, col - start));
+            }
+        }
+        endRow();
+    }
+}
+
+SpanMask::SpanMask(const PolygonMask& mask) :
+    mDims(mask.getDims())
+{
+    mRowOffsets.reserve(mDims.row + 1);
+    mRowOffsets.push_back(0);
+    for (size_t row = 0; row < mDims.row; ++row)
+    {
+        const types::Range range = mask.getRange(row);
+        if (!range.empty())
+        {
+            mSpans.push_back(range);
+        }
+        endRow();
+    }
+}
+
+void SpanMask::addIntersections(ScanlineRasterizer<double>& rasterizer)
+{
+    mRowOffsets.reserve(mDims.row + 1);
+    mRowOffsets.push_back(0);
+
+    std::vector<ScanlineRasterizer<double>::Intersection> intersectionsVec;
+    for (size_t row = 0; row < mDims.row; ++row)
+    {
+        const size_t rowStart = mSpans.size();
+        rasterizer.get(row, intersectionsVec);
+        for (size_t ii = 0; ii < intersectionsVec.size(); ++ii)
+        {
+            addSpan(rowStart, types::Range(intersectionsVec[ii].first,
+                                           intersectionsVec[ii].length()));
+        }
+        endRow();
+    }
+}
+
+void SpanMask::addSpan(size_t rowStart, const types::Range& span)
+{
+    // Spans arrive sorted by start, so only the last one can overlap
+    if (mSpans.size() > rowStart &&
+        span.mStartElement <= mSpans.back().endElement())
+    {
+        types::Range& last(mSpans.back());
+        last.mNumElements = std::max(last.endElement(), span.endElement()) -
+                last.mStartElement;
+    }
+    else
+    {
+        mSpans.push_back(span);
+    }
+}
+
+bool SpanMask::isInPolygon(size_t row, size_t col) const
+{
+    if (row >= mDims.row || col >= mDims.col)
+    {
+        return false;
+    }
+
+    // Find the last span starting at or before col
+    const types::Range* const begin = beginSpans(row);
+    const types::Range* const span =
+            std::upper_bound(begin, endSpans(row), col, startsBefore);
+    return span != begin && (span - 1)->contains(col);
+}
+
+size_t SpanMask::getNumMaskedPixels() const
+{
+    size_t numMaskedPixels(0);
+    for (size_t ii = 0; ii < mSpans.size(); ++ii)
+    {
+        numMaskedPixels += mSpans[ii].mNumElements;
+    }
+    return numMaskedPixels;
+}
+
+template <typename OpT>
+SpanMask SpanMask::combine(const SpanMask& rhs, OpT op) const
+{
+    if (mDims.row != rhs.mDims.row || mDims.col != rhs.mDims.col)
+    {
+        std::ostringstream ostr;
+        ostr << "Mask dimensions differ: " << mDims.row << " x "
+             << mDims.col << " vs. " << rhs.mDims.row << " x "
+             << rhs.mDims.col;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    // An empty mask already has the first row's offset
+    SpanMask result;
+    result.mDims = mDims;
+    result.mRowOffsets.reserve(mDims.row + 1);
+    result.mSpans.reserve(std::max(mSpans.size(), rhs.mSpans.size()));
+
+    for (size_t row = 0; row < mDims.row; ++row)
+    {
+        // Walk the boundaries of both rows' spans in order, tracking
+        // whether we're in each and emitting a span wherever op says the
+        // result changes
+        const types::Range* const lhsSpans = beginSpans(row);
+        const size_t numLhs = getNumSpans(row);
+        const types::Range* const rhsSpans = rhs.beginSpans(row);
+        const size_t numRhs = rhs.getNumSpans(row);
+
+        bool inLhs = false;
+        bool inRhs = false;
+        bool inResult = false;
+        size_t start = 0;
+        for (size_t lhsIdx = 0, rhsIdx = 0;
+             lhsIdx < 2 * numLhs || rhsIdx < 2 * numRhs; )
+        {
+            const size_t lhsCol = boundary(lhsSpans, numLhs, lhsIdx);
+            const size_t rhsCol = boundary(rhsSpans, numRhs, rhsIdx);
+            const size_t col = std::min(lhsCol, rhsCol);
+            if (lhsCol == col)
+            {
+                inLhs = !inLhs;
+                ++lhsIdx;
+            }
+            if (rhsCol == col)
+            {
+                inRhs = !inRhs;
+                ++rhsIdx;
+            }
+
+            const bool nowInResult = op(inLhs, inRhs);
+            if (nowInResult && !inResult)
+            {
+                start = col;
+            }
+            else if (!nowInResult && inResult)
+            {
+                result.mSpans.push_back(types::Range(start, col - start));
+            }
+            inResult = nowInResult;
+        }
+        result.endRow();
+    }
+
+    return result;
+}
+
+SpanMask SpanMask::unite(const SpanMask& rhs) const
+{
+    return combine(rhs, Union());
+}
+
+SpanMask SpanMask::intersect(const SpanMask& rhs) const
+{
+    return combine(rhs, Intersection());
+}
+
+SpanMask SpanMask::subtract(const SpanMask& rhs) const
+{
+    return combine(rhs, Difference());
+}
+
+bool SpanMask::operator==(const SpanMask& rhs) const
+{
+    return mDims.row == rhs.mDims.row &&
+           mDims.col == rhs.mDims.col &&
+           mRowOffsets == rhs.mRowOffsets &&
+           mSpans == rhs.mSpans;
+}
+}
@@ -0,0 +1,139 @@
+/* =========================================================================
+ * This file is part of polygon-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * polygon-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+/* Users guide
+
+    Burns increasing numbers of small random polygons into a label image,
+    one drawPolygon() call per polygon and then with one drawPolygons()
+    call, on one thread and on several.
+
+    usage: test_draw_polygons_benchmark [size [maxPolygons [threads]]]
+        size: rows and columns of the image (default 8192)
+        maxPolygons: the most polygons to draw; the counts go up by 10x
+                     from 100 (default 10000)
+        threads: number of threads (default 4)
+
+    Times are reported in milliseconds.
+*/
+
+#include <stdlib.h>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <polygon/DrawPolygon.h>
+#include <str/Convert.h>
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t size =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 8192;
+        const size_t maxPolygons =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 10000;
+        const size_t numThreads =
+                (argc > 3) ? str::toType<size_t>(argv[3]) : 4;
+
+        std::vector<sys::Uint16_T> single(size * size);
+        std::vector<sys::Uint16_T> batched(size * size);
+
+        std::cout << size << " x " << size << " image (ms)\n\n"
+                  << std::setw(10) << "polygons"
+                  << std::setw(14) << "drawPolygon"
+                  << std::setw(14) << "drawPolygons"
+                  << std::setw(14) << (str::toString(numThreads) +
+                                       " threads")
+                  << std::endl;
+
+        for (size_t numPolygons = 100; numPolygons <= maxPolygons;
+             numPolygons *= 10)
+        {
+            // Quadrilaterals up to 40 pixels across
+            std::vector<std::vector<types::RowCol<double> > > polygons(
+                    numPolygons);
+            std::vector<sys::Uint16_T> colors(numPolygons);
+            for (size_t ii = 0; ii < numPolygons; ++ii)
+            {
+                const double row = static_cast<double>(size) * rand() /
+                        RAND_MAX;
+                const double col = static_cast<double>(size) * rand() /
+                        RAND_MAX;
+                for (size_t jj = 0; jj < 4; ++jj)
+                {
+                    const double radius = 5.0 + 15.0 * rand() / RAND_MAX;
+                    const double angle = M_PI / 2 * jj;
+                    polygons[ii].push_back(types::RowCol<double>(
+                            row + radius * std::sin(angle),
+                            col + radius * std::cos(angle)));
+                }
+                colors[ii] = static_cast<sys::Uint16_T>(ii % 65535 + 1);
+            }
+
+            std::fill(single.begin(), single.end(), 0);
+            sys::RealTimeStopWatch watch;
+            watch.start();
+            for (size_t ii = 0; ii < numPolygons; ++ii)
+            {
+                polygon::drawPolygon(polygons[ii], size, size, colors[ii],
+                                     &single[0]);
+            }
+            const double singleMillis = watch.stop();
+
+            std::fill(batched.begin(), batched.end(), 0);
+            watch.clear();
+            watch.start();
+            polygon::drawPolygons(polygons, colors, size, size, &batched[0]);
+            const double batchedMillis = watch.stop();
+
+            std::fill(batched.begin(), batched.end(), 0);
+            watch.clear();
+            watch.start();
+            polygon::drawPolygons(polygons, colors, size, size, &batched[0],
+                                  false, types::RowCol<sys::SSize_T>(0, 0),
+                                  numThreads);
+            const double threadedMillis = watch.stop();
+
+            std::cout << std::setw(10) << numPolygons << std::fixed
+                      << std::setprecision(1)
+                      << std::setw(14) << singleMillis
+                      << std::setw(14) << batchedMillis
+                      << std::setw(14) << threadedMillis << std::endl;
+
+            if (single != batched)
+            {
+                std::cerr << "Images differ\n";
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+    }
+
+    return 1;
+}
@@ -0,0 +1,181 @@
+/* =========================================================================
+ * This file is part of polygon-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * polygon-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+/* Users guide
+
+    Times building a PolygonMask from a raster mask: the byte at a time
+    scan it used to do, then the word at a time scan over bool, byte and
+    bit-packed masks, on one thread and on several.
+
+    usage: test_polygon_mask_benchmark [size [threads]]
+        size: rows and columns of the mask (default 30000)
+        threads: number of threads (default 4)
+
+    Throughput is reported in millions of pixels per second.
+*/
+
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <mem/ScopedArray.h>
+#include <polygon/DrawPolygon.h>
+#include <polygon/PolygonMask.h>
+#include <str/Convert.h>
+
+namespace
+{
+void report(const std::string& name, size_t numPixels, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(1) << numPixels / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+
+// What PolygonMask(const bool*, dims) used to do, for comparison
+size_t scanBytes(const bool* mask, const types::RowCol<size_t>& dims)
+{
+    size_t numMasked = 0;
+    for (size_t row = 0, rowIdx = 0; row < dims.row; ++row, rowIdx += dims.col)
+    {
+        size_t start(std::numeric_limits<size_t>::max());
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            if (mask[rowIdx + col])
+            {
+                start = col;
+                break;
+            }
+        }
+        if (start != std::numeric_limits<size_t>::max())
+        {
+            for (size_t col = dims.col - 1; ; --col)
+            {
+                if (mask[rowIdx + col])
+                {
+                    numMasked += col - start + 1;
+                    break;
+                }
+            }
+        }
+    }
+    return numMasked;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t size =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 30000;
+        const size_t numThreads =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 4;
+        const types::RowCol<size_t> dims(size, size);
+
+        // A diamond touching the middle of each side, so most rows are
+        // mostly empty on both ends
+        std::vector<types::RowCol<double> > points;
+        points.push_back(types::RowCol<double>(0.5, size / 2.0));
+        points.push_back(types::RowCol<double>(size / 2.0, size - 0.5));
+        points.push_back(types::RowCol<double>(size - 0.5, size / 2.0));
+        points.push_back(types::RowCol<double>(size / 2.0, 0.5));
+
+        const mem::ScopedArray<bool> mask(new bool[dims.area()]);
+        std::fill_n(mask.get(), dims.area(), false);
+        polygon::drawPolygon(points, dims.row, dims.col, true, mask.get());
+        const sys::Uint8_T* const bytes =
+                reinterpret_cast<const sys::Uint8_T*>(mask.get());
+
+        const size_t bitStride = (dims.col + 7) / 8;
+        std::vector<sys::Uint8_T> bits(dims.row * bitStride, 0);
+        for (size_t row = 0; row < dims.row; ++row)
+        {
+            for (size_t col = 0; col < dims.col; ++col)
+            {
+                if (mask[row * dims.col + col])
+                {
+                    bits[row * bitStride + col / 8] |= 0x80 >> (col % 8);
+                }
+            }
+        }
+
+        std::cout << dims.row << " x " << dims.col
+                  << " mask (million pixels/s)\n\n";
+
+        sys::RealTimeStopWatch watch;
+        watch.start();
+        const size_t numMasked = scanBytes(mask.get(), dims);
+        report("byte at a time", dims.area(), watch.stop());
+
+        watch.clear();
+        watch.start();
+        const polygon::PolygonMask fromBool(mask.get(), dims);
+        report("bool", dims.area(), watch.stop());
+
+        watch.clear();
+        watch.start();
+        const polygon::PolygonMask fromBytes(bytes, dims);
+        report("bytes", dims.area(), watch.stop());
+
+        watch.clear();
+        watch.start();
+        const polygon::PolygonMask fromBits(
+                &bits[0], dims, polygon::PolygonMask::BIT_PACKED_MASK);
+        report("bits", dims.area(), watch.stop());
+
+        const std::string threads = ", " + str::toString(numThreads) +
+                " threads";
+        watch.clear();
+        watch.start();
+        const polygon::PolygonMask fromBytesThreaded(
+                bytes, dims, polygon::PolygonMask::BYTE_MASK, numThreads);
+        report("bytes" + threads, dims.area(), watch.stop());
+
+        watch.clear();
+        watch.start();
+        const polygon::PolygonMask fromBitsThreaded(
+                &bits[0], dims, polygon::PolygonMask::BIT_PACKED_MASK,
+                numThreads);
+        report("bits" + threads, dims.area(), watch.stop());
+
+        if (fromBool.getNumMaskedPixels() != numMasked ||
+            fromBytes.getNumMaskedPixels() != numMasked ||
+            fromBits.getNumMaskedPixels() != numMasked ||
+            fromBytesThreaded.getNumMaskedPixels() != numMasked ||
+            fromBitsThreaded.getNumMaskedPixels() != numMasked)
+        {
+            std::cerr << "Masks differ\n";
+            return 1;
+        }
+
+        return 0;
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+    }
+
+    return 1;
+}
@@ -0,0 +1,135 @@
+/* =========================================================================
+ * This file is part of polygon-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * polygon-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+/* Users guide
+
+    Times finding the intersections of every row of a tall, narrow image
+    with a polygon, using Intersections (which stores every row's
+    crossings) and ScanlineRasterizer (which keeps only the active edges),
+    then the anti-aliased coverage of every pixel.
+
+    usage: test_rasterizer_benchmark [rows [cols]]
+        rows: number of rows (default 4000000)
+        cols: number of columns (default 1000)
+
+    Throughput is reported in millions of rows per second.
+*/
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <polygon/Intersections.h>
+#include <polygon/ScanlineRasterizer.h>
+#include <str/Convert.h>
+
+namespace
+{
+void report(const std::string& name, size_t numRows, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(1) << numRows / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t numRows =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 4000000;
+        const size_t numCols =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 1000;
+        const types::RowCol<size_t> dims(numRows, numCols);
+
+        // A zig-zag down the image, so most rows cross four edges
+        std::vector<types::RowCol<double> > points;
+        const size_t numZigs = 50;
+        for (size_t ii = 0; ii <= numZigs; ++ii)
+        {
+            points.push_back(types::RowCol<double>(
+                    ii * (numRows - 1.0) / numZigs + 0.5,
+                    (ii % 2) ? numCols * 0.4 : numCols * 0.1));
+        }
+        for (size_t ii = 0; ii <= numZigs; ++ii)
+        {
+            points.push_back(types::RowCol<double>(
+                    (numZigs - ii) * (numRows - 1.0) / numZigs + 0.5,
+                    (ii % 2) ? numCols * 0.9 : numCols * 0.6));
+        }
+
+        std::cout << numRows << " x " << numCols
+                  << " image (million rows/s)\n\n";
+
+        std::vector<polygon::Intersections<double>::Intersection>
+                intersectionsVec;
+        size_t total = 0;
+
+        sys::RealTimeStopWatch watch;
+        watch.start();
+        {
+            const polygon::Intersections<double> intersections(points, dims);
+            for (size_t row = 0; row < numRows; ++row)
+            {
+                intersections.get(row, intersectionsVec);
+                total += intersectionsVec.size();
+            }
+        }
+        report("Intersections", numRows, watch.stop());
+
+        watch.clear();
+        watch.start();
+        polygon::ScanlineRasterizer<double> rasterizer(points, dims);
+        for (size_t row = 0; row < numRows; ++row)
+        {
+            rasterizer.get(row, intersectionsVec);
+            total -= intersectionsVec.size();
+        }
+        report("ScanlineRasterizer", numRows, watch.stop());
+
+        std::vector<float> coverage(numCols);
+        const size_t numCoverageRows = std::min<size_t>(numRows, 100000);
+        rasterizer.reset();
+        watch.clear();
+        watch.start();
+        for (size_t row = 0; row < numCoverageRows; ++row)
+        {
+            rasterizer.getCoverage(row, &coverage[0]);
+        }
+        report("ScanlineRasterizer coverage", numCoverageRows, watch.stop());
+
+        if (total != 0)
+        {
+            std::cerr << "Intersections differ\n";
+            return 1;
+        }
+        return 0;
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+    }
+
+    return 1;
+}
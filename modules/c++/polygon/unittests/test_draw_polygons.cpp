@@ -0,0 +1,176 @@
+/* =========================================================================
+ * This file is part of polygon-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * polygon-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <sstream>
+#include <vector>
+
+#include "TestCase.h"
+
+#include <polygon/DrawPolygon.h>
+#include <polygon/SpanMask.h>
+
+namespace
+{
+typedef std::vector<types::RowCol<double> > Ring;
+
+double random(double low, double high)
+{
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+// Small random polygons scattered over (and a little off) the image,
+// with some concave ones, one with no points, and one off the image
+std::vector<Ring> randomPolygons(size_t numPolygons,
+                                 const types::RowCol<size_t>& dims)
+{
+    std::vector<Ring> polygons(numPolygons);
+    for (size_t ii = 0; ii < numPolygons; ++ii)
+    {
+        if (ii == numPolygons / 3)
+        {
+            continue;
+        }
+
+        const double row = (ii == numPolygons / 2) ?
+                -100.0 : random(-10.0, dims.row + 10.0);
+        const double col = random(-10.0, dims.col + 10.0);
+        const size_t numPoints = 3 + ii % 5;
+        for (size_t jj = 0; jj < numPoints; ++jj)
+        {
+            // Every other point pulled in makes a star, which is concave
+            const double radius = random(2.0, 30.0) * ((jj % 2) ? 0.4 : 1.0);
+            const double angle = 2 * M_PI * jj / numPoints;
+            polygons[ii].push_back(types::RowCol<double>(
+                    row + radius * std::sin(angle),
+                    col + radius * std::cos(angle)));
+        }
+    }
+    return polygons;
+}
+
+TEST_CASE(testMatchesDrawPolygon)
+{
+    const types::RowCol<size_t> dims(123, 170);
+    const types::RowCol<sys::SSize_T> offset(3, -5);
+    srand(1);
+    const std::vector<Ring> polygons = randomPolygons(60, dims);
+    std::vector<int> colors(polygons.size());
+    for (size_t ii = 0; ii < colors.size(); ++ii)
+    {
+        colors[ii] = static_cast<int>(ii + 1);
+    }
+
+    for (int invert = 0; invert < 2; ++invert)
+    {
+        std::vector<int> expected(dims.area(), 0);
+        for (size_t ii = 0; ii < polygons.size(); ++ii)
+        {
+            polygon::drawPolygon(polygons[ii], dims.row, dims.col,
+                                 colors[ii], &expected[0], invert != 0,
+                                 offset);
+        }
+
+        for (size_t numThreads = 1; numThreads <= 3; numThreads += 2)
+        {
+            for (size_t tileSize = 7; tileSize <= 256; tileSize *= 6)
+            {
+                std::vector<int> actual(dims.area(), 0);
+                polygon::drawPolygons(polygons, colors, dims.row, dims.col,
+                                      &actual[0], invert != 0, offset,
+                                      numThreads, tileSize);
+
+                for (size_t idx = 0; idx < dims.area(); ++idx)
+                {
+                    std::ostringstream ostr;
+                    ostr << "invert = " << invert << ", threads = "
+                         << numThreads << ", tile size = " << tileSize
+                         << ", row = " << idx / dims.col
+                         << ", col = " << idx % dims.col;
+                    TEST_ASSERT_EQ_MSG(ostr.str(), actual[idx], expected[idx]);
+                }
+            }
+        }
+    }
+
+    std::vector<int> out(dims.area());
+    TEST_EXCEPTION(polygon::drawPolygons(
+            polygons, std::vector<int>(1, 1), dims.row, dims.col, &out[0]));
+}
+
+TEST_CASE(testInvertConcave)
+{
+    // A U, so rows 30 - 60 cross it twice.  Inverting should color
+    // exactly the pixels outside it, including those in the notch.
+    Ring points;
+    points.push_back(types::RowCol<double>(10.5, 10.5));
+    points.push_back(types::RowCol<double>(10.5, 30.5));
+    points.push_back(types::RowCol<double>(60.5, 30.5));
+    points.push_back(types::RowCol<double>(60.5, 70.5));
+    points.push_back(types::RowCol<double>(10.5, 70.5));
+    points.push_back(types::RowCol<double>(10.5, 90.5));
+    points.push_back(types::RowCol<double>(90.5, 90.5));
+    points.push_back(types::RowCol<double>(90.5, 10.5));
+
+    const types::RowCol<size_t> dims(100, 120);
+    std::vector<unsigned char> out(dims.area(), 0);
+    polygon::drawPolygon(points, dims.row, dims.col,
+                         static_cast<unsigned char>(1), &out[0], true);
+
+    const polygon::SpanMask mask(points, dims);
+    for (size_t row = 0, idx = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col, ++idx)
+        {
+            std::ostringstream ostr;
+            ostr << "row = " << row << ", col = " << col;
+            TEST_ASSERT_EQ_MSG(ostr.str(), out[idx] == 1,
+                               !mask.isInPolygon(row, col));
+
+            // The same pixels, spelled out: the arms span columns 11 - 30
+            // and 71 - 90 of rows 11 - 60, and the base all of 11 - 90 in
+            // rows 61 - 90.
+            const bool inArm = row >= 11 && row <= 60 &&
+                    ((col >= 11 && col <= 30) || (col >= 71 && col <= 90));
+            const bool inBase = row >= 61 && row <= 90 &&
+                    col >= 11 && col <= 90;
+            TEST_ASSERT_EQ_MSG(ostr.str(), out[idx] == 1,
+                               !(inArm || inBase));
+        }
+    }
+
+    // Not inverting colors the complement
+    std::vector<unsigned char> filled(dims.area(), 0);
+    polygon::drawPolygon(points, dims.row, dims.col,
+                         static_cast<unsigned char>(1), &filled[0]);
+    for (size_t idx = 0; idx < dims.area(); ++idx)
+    {
+        TEST_ASSERT_EQ(filled[idx] + out[idx], 1);
+    }
+}
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    TEST_CHECK(testMatchesDrawPolygon);
+    TEST_CHECK(testInvertConcave);
+    return 0;
+}
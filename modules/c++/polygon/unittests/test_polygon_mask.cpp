@@ -21,6 +21,7 @@
  */
 #include <limits>
 #include <sstream>
+#include <vector>
 
 #include "TestCase.h"
 
@@ -282,6 +283,107 @@ TEST_CASE(testWithNarrowPassthrough)
     TEST_ASSERT_TRUE(mask.getRange(4).empty());
     TEST_ASSERT_TRUE(mask.getRange(5).empty());
 }
+
+void checkRange(const std::string& testName,
+                const std::string& msg,
+                const types::Range& range,
+                const types::Range& expected)
+{
+    TEST_ASSERT_EQ_MSG(msg, range.mStartElement, expected.mStartElement);
+    TEST_ASSERT_EQ_MSG(msg, range.mNumElements, expected.mNumElements);
+}
+
+TEST_CASE(testWithByteAndBitMasks)
+{
+    // Odd widths leave padding bits in the last byte of each bit-packed
+    // row, which must be ignored
+    for (size_t numCols = 75; numCols <= 80; numCols += 5)
+    {
+        const types::RowCol<size_t> dims(100, numCols);
+        const size_t bitStride = (numCols + 7) / 8;
+        std::vector<bool> mask(dims.area(), false);
+        std::vector<sys::Uint8_T> bytes(dims.area(), 0);
+        std::vector<sys::Uint8_T> bits(dims.row * bitStride, 0xFF);
+
+        // Row r has pixels r % numCols and (3 * r) % numCols set, so every
+        // pair of first and last columns turns up, including only one
+        // pixel and pixels near word and byte boundaries.  Every 10th row
+        // is empty.
+        for (size_t row = 0; row < dims.row; ++row)
+        {
+            std::fill_n(&bits[row * bitStride], numCols / 8, 0);
+            if (numCols % 8)
+            {
+                // Set only the padding bits
+                bits[row * bitStride + numCols / 8] =
+                        static_cast<sys::Uint8_T>(0xFF >> (numCols % 8));
+            }
+            if (row % 10 == 0)
+            {
+                continue;
+            }
+
+            const size_t cols[] = { row % numCols, (3 * row) % numCols };
+            for (size_t ii = 0; ii < 2; ++ii)
+            {
+                mask[row * numCols + cols[ii]] = true;
+                bytes[row * numCols + cols[ii]] = 0x40;
+                bits[row * bitStride + cols[ii] / 8] |=
+                        static_cast<sys::Uint8_T>(0x80 >> (cols[ii] % 8));
+            }
+        }
+        const mem::ScopedArray<bool> boolMask(new bool[dims.area()]);
+        std::copy(mask.begin(), mask.end(), boolMask.get());
+
+        for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+        {
+            const polygon::PolygonMask fromBool(
+                    boolMask.get(), dims, numThreads);
+            const polygon::PolygonMask fromBytes(
+                    &bytes[0], dims, polygon::PolygonMask::BYTE_MASK,
+                    numThreads);
+            const polygon::PolygonMask fromBits(
+                    &bits[0], dims, polygon::PolygonMask::BIT_PACKED_MASK,
+                    numThreads);
+
+            for (size_t row = 0; row < dims.row; ++row)
+            {
+                types::Range expected;
+                if (row % 10 != 0)
+                {
+                    const size_t col0 = row % numCols;
+                    const size_t col1 = (3 * row) % numCols;
+                    expected = types::Range(std::min(col0, col1),
+                                            std::max(col0, col1) -
+                                                    std::min(col0, col1) + 1);
+                }
+
+                std::ostringstream ostr;
+                ostr << "numCols = " << numCols << ", row = " << row;
+                checkRange(testName, ostr.str(),
+                           fromBool.getRange(row), expected);
+                checkRange(testName, ostr.str(),
+                           fromBytes.getRange(row), expected);
+                checkRange(testName, ostr.str(),
+                           fromBits.getRange(row), expected);
+            }
+        }
+    }
+
+    // A full mask
+    const types::RowCol<size_t> dims(10, 13);
+    const std::vector<sys::Uint8_T> full(dims.area(), 1);
+    TEST_ASSERT_EQ(polygon::PolygonMask(&full[0], dims).getMarkMode(),
+                   polygon::PolygonMask::MARK_ALL_TRUE);
+    const std::vector<sys::Uint8_T> fullBits(dims.row * 2, 0xFF);
+    TEST_ASSERT_EQ(polygon::PolygonMask(
+                           &fullBits[0], dims,
+                           polygon::PolygonMask::BIT_PACKED_MASK).getMarkMode(),
+                   polygon::PolygonMask::MARK_ALL_TRUE);
+    const std::vector<sys::Uint8_T> empty(dims.area(), 0);
+    TEST_ASSERT_EQ(polygon::PolygonMask(&empty[0], dims).getMarkMode(),
+                   polygon::PolygonMask::MARK_ALL_FALSE);
+}
 }
 
 int main(int /*argc*/, char** /*argv*/)
@@ -295,5 +397,6 @@ int main(int /*argc*/, char** /*argv*/)
     TEST_CHECK(testWithPartialCutBotomLeft);
     TEST_CHECK(testWithPartialCutTopRight);
     TEST_CHECK(testWithNarrowPassthrough);
+    TEST_CHECK(testWithByteAndBitMasks);
     return 0;
 }
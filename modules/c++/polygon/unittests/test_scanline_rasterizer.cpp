@@ -0,0 +1,216 @@
+/* =========================================================================
+ * This file is part of polygon-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * polygon-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+#include "TestCase.h"
+
+#include <polygon/Intersections.h>
+#include <polygon/ScanlineRasterizer.h>
+
+namespace
+{
+typedef std::vector<types::RowCol<double> > Ring;
+typedef polygon::Intersections<double>::Intersection Intersection;
+
+Ring square(double top, double left, double size, bool clockwise = true)
+{
+    Ring ring;
+    ring.push_back(types::RowCol<double>(top, left));
+    if (clockwise)
+    {
+        ring.push_back(types::RowCol<double>(top, left + size));
+        ring.push_back(types::RowCol<double>(top + size, left + size));
+        ring.push_back(types::RowCol<double>(top + size, left));
+    }
+    else
+    {
+        ring.push_back(types::RowCol<double>(top + size, left));
+        ring.push_back(types::RowCol<double>(top + size, left + size));
+        ring.push_back(types::RowCol<double>(top, left + size));
+    }
+    return ring;
+}
+
+// Checks that every row of rasterizer matches intersections, going down
+// the rows and then back up
+void checkMatches(const std::string& testName,
+                  const polygon::Intersections<double>& intersections,
+                  polygon::ScanlineRasterizer<double>& rasterizer)
+{
+    const size_t numRows = rasterizer.getDims().row;
+    std::vector<Intersection> expected;
+    std::vector<Intersection> actual;
+    for (size_t ii = 0; ii < 2 * numRows + 2; ++ii)
+    {
+        const size_t row = (ii <= numRows) ? ii : 2 * numRows + 1 - ii;
+        intersections.get(row, expected);
+        rasterizer.get(row, actual);
+
+        std::ostringstream ostr;
+        ostr << "row = " << row;
+        TEST_ASSERT_EQ_MSG(ostr.str(), actual.size(), expected.size());
+        for (size_t jj = 0; jj < expected.size(); ++jj)
+        {
+            TEST_ASSERT_EQ_MSG(ostr.str(), actual[jj].first,
+                               expected[jj].first);
+            TEST_ASSERT_EQ_MSG(ostr.str(), actual[jj].last,
+                               expected[jj].last);
+        }
+    }
+}
+
+TEST_CASE(testMatchesIntersections)
+{
+    Ring points;
+    points.push_back(types::RowCol<double>(400, 100));
+    points.push_back(types::RowCol<double>(100, 310));
+    points.push_back(types::RowCol<double>(270, 590));
+    points.push_back(types::RowCol<double>(445, 576));
+    points.push_back(types::RowCol<double>(600, 350));
+    const types::RowCol<sys::SSize_T> offset(50, 75);
+    const types::RowCol<size_t> dims(1000, 800);
+    {
+        const polygon::Intersections<double> intersections(
+                points, dims, offset);
+        polygon::ScanlineRasterizer<double> rasterizer(points, dims, offset);
+        checkMatches(testName, intersections, rasterizer);
+    }
+
+    // Concave, partly off the image, with vertices on scan lines
+    points.clear();
+    points.push_back(types::RowCol<double>(-20, 10));
+    points.push_back(types::RowCol<double>(60, 150));
+    points.push_back(types::RowCol<double>(30, 60.5));
+    points.push_back(types::RowCol<double>(90.25, -40));
+    points.push_back(types::RowCol<double>(120, 120));
+    points.push_back(types::RowCol<double>(10, 180));
+    const types::RowCol<size_t> smallDims(100, 160);
+    {
+        const polygon::Intersections<double> intersections(points,
+                                                           smallDims);
+        polygon::ScanlineRasterizer<double> rasterizer(points, smallDims);
+        checkMatches(testName, intersections, rasterizer);
+    }
+
+    // Rings, under both fill rules
+    std::vector<Ring> rings;
+    rings.push_back(points);
+    rings.push_back(square(20.5, 20.5, 40));
+    rings.push_back(square(30.5, 30.5, 10, false));
+    for (int rule = 0; rule < 2; ++rule)
+    {
+        const polygon::FillRule fillRule =
+                static_cast<polygon::FillRule>(rule);
+        const polygon::Intersections<double> intersections(
+                rings, smallDims, fillRule);
+        polygon::ScanlineRasterizer<double> rasterizer(
+                rings, smallDims, fillRule);
+        checkMatches(testName, intersections, rasterizer);
+    }
+
+    // Nothing
+    polygon::ScanlineRasterizer<double> empty(Ring(), smallDims);
+    std::vector<Intersection> actual;
+    empty.get(10, actual);
+    TEST_ASSERT_TRUE(actual.empty());
+}
+
+TEST_CASE(testCoverage)
+{
+    // Edges a quarter of the way into pixels
+    const types::RowCol<size_t> dims(30, 30);
+    polygon::ScanlineRasterizer<double> rasterizer(
+            square(10.25, 10.25, 10.5), dims);
+    std::vector<double> coverage(dims.col);
+
+    rasterizer.getCoverage(9, &coverage[0]);
+    TEST_ASSERT_ALMOST_EQ(coverage[15], 0.0);
+
+    rasterizer.getCoverage(10, &coverage[0]);
+    TEST_ASSERT_ALMOST_EQ(coverage[9], 0.0);
+    TEST_ASSERT_ALMOST_EQ(coverage[10], 0.0625);
+    TEST_ASSERT_ALMOST_EQ(coverage[11], 0.25);
+    TEST_ASSERT_ALMOST_EQ(coverage[20], 0.25);
+    TEST_ASSERT_ALMOST_EQ(coverage[21], 0.0625);
+    TEST_ASSERT_ALMOST_EQ(coverage[22], 0.0);
+
+    rasterizer.getCoverage(15, &coverage[0]);
+    TEST_ASSERT_ALMOST_EQ(coverage[10], 0.25);
+    TEST_ASSERT_ALMOST_EQ(coverage[15], 1.0);
+    TEST_ASSERT_ALMOST_EQ(coverage[21], 0.25);
+
+    rasterizer.getCoverage(21, &coverage[0]);
+    TEST_ASSERT_ALMOST_EQ(coverage[15], 0.25);
+
+    // The total is the area of the polygon, here a triangle running off
+    // the left of the image
+    Ring triangle;
+    triangle.push_back(types::RowCol<double>(2.3, -5.1));
+    triangle.push_back(types::RowCol<double>(27.6, 12.2));
+    triangle.push_back(types::RowCol<double>(8.9, 26.7));
+    polygon::ScanlineRasterizer<double> triangleRasterizer(triangle, dims);
+    std::vector<float> floatCoverage(dims.col);
+    double total = 0.0;
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        triangleRasterizer.getCoverage(row, &floatCoverage[0], 64);
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            TEST_ASSERT_GREATER_EQ(floatCoverage[col], 0.0f);
+            TEST_ASSERT_LESSER_EQ(floatCoverage[col], 1.0001f);
+            total += floatCoverage[col];
+        }
+    }
+
+    // Clip the triangle at col -0.5, the left edge of the image
+    const double r0 = 2.3, c0 = -5.1, r1 = 27.6, c1 = 12.2, r2 = 8.9,
+            c2 = 26.7;
+    const double area = std::abs((r1 - r0) * (c2 - c0) -
+                                 (r2 - r0) * (c1 - c0)) / 2.0;
+    const double t01 = (-0.5 - c0) / (c1 - c0);
+    const double t02 = (-0.5 - c0) / (c2 - c0);
+    const double clipped = t01 * t02 * area;
+    TEST_ASSERT_ALMOST_EQ_EPS(total, area - clipped, 0.05);
+
+    // Even-odd holes get nothing
+    std::vector<Ring> rings;
+    rings.push_back(square(4.5, 4.5, 20));
+    rings.push_back(square(9.5, 9.5, 10));
+    polygon::ScanlineRasterizer<double> holeRasterizer(rings, dims);
+    holeRasterizer.getCoverage(14, &coverage[0]);
+    TEST_ASSERT_ALMOST_EQ(coverage[4], 0.0);
+    TEST_ASSERT_ALMOST_EQ(coverage[5], 1.0);
+    TEST_ASSERT_ALMOST_EQ(coverage[9], 1.0);
+    TEST_ASSERT_ALMOST_EQ(coverage[10], 0.0);
+    TEST_ASSERT_ALMOST_EQ(coverage[19], 0.0);
+    TEST_ASSERT_ALMOST_EQ(coverage[20], 1.0);
+}
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    TEST_CHECK(testMatchesIntersections);
+    TEST_CHECK(testCoverage);
+    return 0;
+}
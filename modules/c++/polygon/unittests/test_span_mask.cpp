@@ -0,0 +1,256 @@
+/* =========================================================================
+ * This file is part of polygon-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * polygon-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <sstream>
+#include <vector>
+
+#include "TestCase.h"
+
+#include <mem/ScopedArray.h>
+
+#include <polygon/DrawPolygon.h>
+#include <polygon/SpanMask.h>
+
+namespace
+{
+typedef std::vector<types::RowCol<double> > Ring;
+
+Ring square(double top, double left, double size, bool clockwise = true)
+{
+    Ring ring;
+    ring.push_back(types::RowCol<double>(top, left));
+    if (clockwise)
+    {
+        ring.push_back(types::RowCol<double>(top, left + size));
+        ring.push_back(types::RowCol<double>(top + size, left + size));
+        ring.push_back(types::RowCol<double>(top + size, left));
+    }
+    else
+    {
+        ring.push_back(types::RowCol<double>(top + size, left));
+        ring.push_back(types::RowCol<double>(top + size, left + size));
+        ring.push_back(types::RowCol<double>(top, left + size));
+    }
+    return ring;
+}
+
+// Checks that every pixel of mask matches raster
+void checkMatches(const std::string& testName,
+                  const polygon::SpanMask& mask,
+                  const bool* raster)
+{
+    const types::RowCol<size_t>& dims(mask.getDims());
+    size_t numMasked = 0;
+    for (size_t row = 0, idx = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col, ++idx)
+        {
+            std::ostringstream ostr;
+            ostr << "row = " << row << ", col = " << col;
+            TEST_ASSERT_EQ_MSG(ostr.str(),
+                               raster[idx], mask.isInPolygon(row, col));
+            numMasked += raster[idx] ? 1 : 0;
+        }
+    }
+    TEST_ASSERT_EQ(mask.getNumMaskedPixels(), numMasked);
+    TEST_ASSERT_TRUE(mask == polygon::SpanMask(raster, dims));
+}
+
+struct CountPixels
+{
+    CountPixels() : mCount(0)
+    {
+    }
+
+    void operator()(size_t , const types::Range& span)
+    {
+        mCount += span.mNumElements;
+    }
+
+    size_t mCount;
+};
+
+TEST_CASE(testConcave)
+{
+    // A U: rows 30 - 60 have two spans
+    Ring points;
+    points.push_back(types::RowCol<double>(10.5, 10.5));
+    points.push_back(types::RowCol<double>(10.5, 30.5));
+    points.push_back(types::RowCol<double>(60.5, 30.5));
+    points.push_back(types::RowCol<double>(60.5, 70.5));
+    points.push_back(types::RowCol<double>(10.5, 70.5));
+    points.push_back(types::RowCol<double>(10.5, 90.5));
+    points.push_back(types::RowCol<double>(90.5, 90.5));
+    points.push_back(types::RowCol<double>(90.5, 10.5));
+
+    const types::RowCol<size_t> dims(100, 120);
+    const mem::ScopedArray<bool> raster(new bool[dims.area()]);
+    std::fill_n(raster.get(), dims.area(), false);
+    polygon::drawPolygon(points, dims.row, dims.col, true, raster.get());
+
+    const polygon::SpanMask mask(points, dims);
+    checkMatches(testName, mask, raster.get());
+
+    TEST_ASSERT_EQ(mask.getNumSpans(40), 2);
+    TEST_ASSERT_EQ(mask.beginSpans(40)[0].mStartElement, 11);
+    TEST_ASSERT_EQ(mask.beginSpans(40)[0].mNumElements, 20);
+    TEST_ASSERT_EQ(mask.beginSpans(40)[1].mStartElement, 71);
+    TEST_ASSERT_EQ(mask.beginSpans(40)[1].mNumElements, 20);
+    TEST_ASSERT_EQ(mask.getNumSpans(80), 1);
+    TEST_ASSERT_EQ(mask.getNumSpans(5), 0);
+    TEST_ASSERT_EQ(mask.getNumSpans(dims.row), 0);
+    TEST_ASSERT(!mask.isInPolygon(dims.row, 50));
+
+    // The hull-based mask has to fill in the notch
+    const polygon::PolygonMask hullMask(points, dims);
+    TEST_ASSERT(hullMask.isInPolygon(40, 50));
+    TEST_ASSERT(!mask.isInPolygon(40, 50));
+
+    CountPixels count;
+    mask.forEachSpan(count);
+    TEST_ASSERT_EQ(count.mCount, mask.getNumMaskedPixels());
+}
+
+TEST_CASE(testRings)
+{
+    const types::RowCol<size_t> dims(50, 60);
+
+    // Two parts
+    std::vector<Ring> rings;
+    rings.push_back(square(5.5, 5.5, 10));
+    rings.push_back(square(5.5, 30.5, 10));
+    const polygon::SpanMask parts(rings, dims);
+    TEST_ASSERT_EQ(parts.getNumMaskedPixels(), 200);
+    TEST_ASSERT_EQ(parts.getNumSpans(10), 2);
+    TEST_ASSERT(parts.isInPolygon(10, 10));
+    TEST_ASSERT(!parts.isInPolygon(10, 20));
+    TEST_ASSERT(parts.isInPolygon(10, 35));
+
+    // A hole in the same direction is only a hole for even-odd
+    rings.clear();
+    rings.push_back(square(10.5, 10.5, 30));
+    rings.push_back(square(20.5, 20.5, 10));
+    const polygon::SpanMask evenOdd(rings, dims, polygon::FILL_EVEN_ODD);
+    TEST_ASSERT_EQ(evenOdd.getNumMaskedPixels(), 800);
+    TEST_ASSERT(!evenOdd.isInPolygon(25, 25));
+    TEST_ASSERT(evenOdd.isInPolygon(25, 15));
+
+    const polygon::SpanMask nonzero(rings, dims, polygon::FILL_NONZERO);
+    TEST_ASSERT_EQ(nonzero.getNumMaskedPixels(), 900);
+    TEST_ASSERT(nonzero.isInPolygon(25, 25));
+
+    // Reversed, it's a hole either way
+    rings[1] = square(20.5, 20.5, 10, false);
+    TEST_ASSERT_TRUE(polygon::SpanMask(rings, dims, polygon::FILL_NONZERO) ==
+                     evenOdd);
+
+    // An island in the hole
+    rings.push_back(square(23.5, 23.5, 4));
+    const polygon::SpanMask island(rings, dims);
+    TEST_ASSERT_EQ(island.getNumMaskedPixels(), 816);
+    TEST_ASSERT_EQ(island.getNumSpans(25), 3);
+    TEST_ASSERT(island.isInPolygon(25, 25));
+}
+
+TEST_CASE(testFromPolygonMask)
+{
+    Ring points;
+    points.push_back(types::RowCol<double>(400, 100));
+    points.push_back(types::RowCol<double>(100, 310));
+    points.push_back(types::RowCol<double>(270, 590));
+    points.push_back(types::RowCol<double>(445, 576));
+    points.push_back(types::RowCol<double>(600, 350));
+    const types::RowCol<sys::SSize_T> offset(50, 75);
+    const types::RowCol<size_t> dims(1000, 800);
+
+    // For a convex polygon, all three agree
+    const polygon::PolygonMask polygonMask(points, dims, offset);
+    const polygon::SpanMask fromPolygonMask(polygonMask);
+    const polygon::SpanMask mask(points, dims, polygon::FILL_EVEN_ODD,
+                                 offset);
+    TEST_ASSERT_TRUE(mask == fromPolygonMask);
+    TEST_ASSERT_EQ(mask.getNumSpans(), 500);
+    TEST_ASSERT_EQ(mask.getNumMaskedPixels(),
+                   polygonMask.getNumMaskedPixels());
+
+    const polygon::SpanMask allTrue(polygon::PolygonMask(
+            polygon::PolygonMask::MARK_ALL_TRUE, dims));
+    TEST_ASSERT_EQ(allTrue.getNumMaskedPixels(), dims.area());
+}
+
+TEST_CASE(testSetOperations)
+{
+    // Random runs, so spans start and end at every combination of places
+    // relative to each other
+    const types::RowCol<size_t> dims(40, 100);
+    std::vector<bool> lhs(dims.area());
+    std::vector<bool> rhs(dims.area());
+    srand(1);
+    for (size_t idx = 0; idx < dims.area(); ++idx)
+    {
+        lhs[idx] = (idx % dims.col == 0 || rand() % 4 == 0) ?
+                (rand() % 2 == 0) : (idx > 0 && lhs[idx - 1]);
+        rhs[idx] = (idx % dims.col == 0 || rand() % 4 == 0) ?
+                (rand() % 2 == 0) : (idx > 0 && rhs[idx - 1]);
+    }
+
+    const mem::ScopedArray<bool> lhsRaster(new bool[dims.area()]);
+    const mem::ScopedArray<bool> rhsRaster(new bool[dims.area()]);
+    const mem::ScopedArray<bool> unionRaster(new bool[dims.area()]);
+    const mem::ScopedArray<bool> intersectionRaster(new bool[dims.area()]);
+    const mem::ScopedArray<bool> differenceRaster(new bool[dims.area()]);
+    for (size_t idx = 0; idx < dims.area(); ++idx)
+    {
+        lhsRaster[idx] = lhs[idx];
+        rhsRaster[idx] = rhs[idx];
+        unionRaster[idx] = lhs[idx] || rhs[idx];
+        intersectionRaster[idx] = lhs[idx] && rhs[idx];
+        differenceRaster[idx] = lhs[idx] && !rhs[idx];
+    }
+
+    const polygon::SpanMask lhsMask(lhsRaster.get(), dims);
+    const polygon::SpanMask rhsMask(rhsRaster.get(), dims);
+    checkMatches(testName, lhsMask, lhsRaster.get());
+    checkMatches(testName, lhsMask.unite(rhsMask), unionRaster.get());
+    checkMatches(testName, lhsMask.intersect(rhsMask),
+                 intersectionRaster.get());
+    checkMatches(testName, lhsMask.subtract(rhsMask),
+                 differenceRaster.get());
+
+    const polygon::SpanMask empty(dims);
+    TEST_ASSERT_TRUE(lhsMask.unite(empty) == lhsMask);
+    TEST_ASSERT_TRUE(lhsMask.intersect(empty) == empty);
+    TEST_ASSERT_TRUE(lhsMask.subtract(lhsMask) == empty);
+
+    TEST_EXCEPTION(lhsMask.unite(
+            polygon::SpanMask(types::RowCol<size_t>(40, 99))));
+}
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    TEST_CHECK(testConcave);
+    TEST_CHECK(testRings);
+    TEST_CHECK(testFromPolygonMask);
+    TEST_CHECK(testSetOperations);
+    return 0;
+}
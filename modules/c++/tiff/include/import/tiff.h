@@ -34,6 +34,7 @@
 #include "tiff/FileReader.h"
 #include "tiff/ImageWriter.h"
 #include "tiff/FileWriter.h"
+#include "tiff/Overviews.h"
 #include "tiff/Utils.h"
 
 #endif
@@ -0,0 +1,231 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __TIFF_CODEC_H__
+#define __TIFF_CODEC_H__
+
+#include <vector>
+#include <import/sys.h>
+
+namespace tiff
+{
+
+/**
+ *********************************************************************
+ * @class Codec
+ * @brief Compresses and decompresses a single strip or tile.
+ *
+ * Every strip or tile in a TIFF image is compressed independently,
+ * so a codec works on one complete chunk at a time.  Codecs hold no
+ * state between calls, and may be used from multiple threads at once.
+ *********************************************************************/
+class Codec
+{
+public:
+    //! Destructor
+    virtual ~Codec()
+    {
+    }
+
+    /**
+     *****************************************************************
+     * Decompresses a strip or tile.  If the compressed data runs out
+     * before the output is full, the remainder of the output is
+     * zero-filled, as other TIFF readers do.
+     *
+     * @param input
+     *   the compressed data
+     * @param inputSize
+     *   the number of bytes of compressed data
+     * @param output
+     *   the buffer to decompress into
+     * @param outputSize
+     *   the number of bytes the strip or tile holds uncompressed
+     *****************************************************************/
+    virtual void decode(const unsigned char *input, size_t inputSize,
+                        unsigned char *output, size_t outputSize) const = 0;
+
+    /**
+     *****************************************************************
+     * Compresses a strip or tile.
+     *
+     * @param input
+     *   the uncompressed data
+     * @param inputSize
+     *   the number of bytes of uncompressed data
+     * @param rowSize
+     *   the number of bytes in a row of the strip or tile.  Some
+     *   schemes must not compress across rows.
+     * @param output
+     *   the vector to append the compressed data to
+     *****************************************************************/
+    virtual void encode(const unsigned char *input, size_t inputSize,
+                        size_t rowSize,
+                        std::vector<unsigned char>& output) const = 0;
+};
+
+/**
+ *********************************************************************
+ * @class DeflateCodec
+ * @brief Deflate (zlib) compression, TIFF compression types 8 and
+ * 32946.  Only available when the tiff module is built with zlib.
+ *********************************************************************/
+class DeflateCodec : public Codec
+{
+public:
+    void decode(const unsigned char *input, size_t inputSize,
+                unsigned char *output, size_t outputSize) const;
+
+    void encode(const unsigned char *input, size_t inputSize,
+                size_t rowSize, std::vector<unsigned char>& output) const;
+};
+
+/**
+ *********************************************************************
+ * @class LZWCodec
+ * @brief LZW compression, TIFF compression type 5.  Codes are packed
+ * most significant bit first and widen one code early, as in
+ * Revision 6.0 of the TIFF specification.
+ *********************************************************************/
+class LZWCodec : public Codec
+{
+public:
+    void decode(const unsigned char *input, size_t inputSize,
+                unsigned char *output, size_t outputSize) const;
+
+    void encode(const unsigned char *input, size_t inputSize,
+                size_t rowSize, std::vector<unsigned char>& output) const;
+};
+
+/**
+ *********************************************************************
+ * @class PackBitsCodec
+ * @brief Macintosh PackBits run-length compression, TIFF compression
+ * type 32773.
+ *********************************************************************/
+class PackBitsCodec : public Codec
+{
+public:
+    void decode(const unsigned char *input, size_t inputSize,
+                unsigned char *output, size_t outputSize) const;
+
+    void encode(const unsigned char *input, size_t inputSize,
+                size_t rowSize, std::vector<unsigned char>& output) const;
+};
+
+/**
+ *********************************************************************
+ * @class JPEGCodec
+ * @brief JPEG compression, TIFF compression type 7, as revised by
+ * TIFF Technical Note 2.  Only available when the tiff module is
+ * built with the jpeg module.
+ *
+ * Each strip or tile is a JPEG stream of its own, which may leave out
+ * the tables held by the JPEGTables tag.  YCbCr images are converted
+ * from RGB when written and back to RGB when read, as libtiff does in
+ * its RGB color mode.  Every other photometric interpretation stores
+ * its samples without color conversion.  Only 8-bit samples are
+ * supported.
+ *********************************************************************/
+class JPEGCodec : public Codec
+{
+public:
+    /**
+     *****************************************************************
+     * Constructor
+     *
+     * @param photometric
+     *   the image's PhotometricInterpretation
+     * @param numBands
+     *   the number of samples in each pixel
+     * @param tables
+     *   the contents of the JPEGTables tag, if any
+     * @param quality
+     *   the quality to compress with, 1 through 100
+     *****************************************************************/
+    JPEGCodec(unsigned short photometric, size_t numBands,
+              const std::vector<unsigned char>& tables =
+                      std::vector<unsigned char>(),
+              int quality = 75);
+
+    void decode(const unsigned char *input, size_t inputSize,
+                unsigned char *output, size_t outputSize) const;
+
+    void encode(const unsigned char *input, size_t inputSize,
+                size_t rowSize, std::vector<unsigned char>& output) const;
+
+private:
+    unsigned short mPhotometric;
+    size_t mNumBands;
+    std::vector<unsigned char> mTables;
+    int mQuality;
+};
+
+/**
+ *****************************************************************
+ * Returns the codec for the specified TIFF compression type.
+ *
+ * @param compression
+ *   the value of the Compression tag, see
+ *   tiff::Const::CompressionType
+ * @return
+ *   a shared codec instance, or NULL for uncompressed data
+ * @throw except::Exception
+ *   if the compression type is not supported.  JPEG depends on the
+ *   image, so it is not shared; create a tiff::JPEGCodec instead.
+ *****************************************************************/
+const tiff::Codec *getCodec(unsigned short compression);
+
+/**
+ *****************************************************************
+ * Applies the horizontal differencing predictor (Predictor = 2) to
+ * a strip or tile in place.  Each sample is replaced by its
+ * difference from the same sample in the previous pixel of the row.
+ *
+ * @param buffer
+ *   the strip or tile, in native byte order
+ * @param width
+ *   the number of pixels in a row
+ * @param length
+ *   the number of rows
+ * @param samplesPerPixel
+ *   the number of samples in each pixel
+ * @param sampleSize
+ *   the size of a sample in bytes: 1, 2, 4 or 8
+ *****************************************************************/
+void applyHorizontalPredictor(unsigned char *buffer, size_t width,
+                              size_t length, size_t samplesPerPixel,
+                              size_t sampleSize);
+
+/**
+ *****************************************************************
+ * Reverses applyHorizontalPredictor() in place.  The parameters are
+ * the same.
+ *****************************************************************/
+void undoHorizontalPredictor(unsigned char *buffer, size_t width,
+                             size_t length, size_t samplesPerPixel,
+                             size_t sampleSize);
+
+} // End namespace.
+
+#endif // __TIFF_CODEC_H__
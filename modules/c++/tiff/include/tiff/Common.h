@@ -82,10 +82,53 @@ public:
             SRATIONAL,
             FLOAT,
             DOUBLE,
+            IFD,
+            LONG8 = 16,
+            SLONG8,
+            IFD8,
             MAX
         };
     };
 
+    /**
+     *****************************************************************
+     * @class Tag
+     * @brief Contains the identifiers of the tags the library reads
+     * and writes itself.
+     *
+     * Looking an entry up by identifier, rather than by name, avoids
+     * resolving the name through the KnownTagsRegistry.
+     *****************************************************************/
+    class Tag
+    {
+    public:
+        enum
+        {
+            NEW_SUBFILE_TYPE = 254,
+            IMAGE_WIDTH = 256,
+            IMAGE_LENGTH,
+            BITS_PER_SAMPLE,
+            COMPRESSION,
+            PHOTOMETRIC_INTERPRETATION = 262,
+            STRIP_OFFSETS = 273,
+            SAMPLES_PER_PIXEL = 277,
+            ROWS_PER_STRIP,
+            STRIP_BYTE_COUNTS,
+            X_RESOLUTION = 282,
+            Y_RESOLUTION,
+            PLANAR_CONFIGURATION,
+            RESOLUTION_UNIT = 296,
+            PREDICTOR = 317,
+            COLOR_MAP = 320,
+            TILE_WIDTH = 322,
+            TILE_LENGTH,
+            TILE_OFFSETS,
+            TILE_BYTE_COUNTS,
+            SAMPLE_FORMAT = 339,
+            JPEG_TABLES = 347
+        };
+    };
+
     /**
      *****************************************************************
      * @class Type
@@ -118,7 +161,9 @@ public:
             BLACK_IS_ZERO,
             RGB,
             COLORMAP,
-            TRANSPARENCY_MASK
+            TRANSPARENCY_MASK,
+            SEPARATED,
+            YCBCR
         };
     };
 
@@ -143,7 +188,25 @@ public:
             DEFLATE,
             JBIG_BW,
             JBIG_COLOR,
-            PACK_BITS = 32773
+            PACK_BITS = 32773,
+            DEFLATE_PKZIP = 32946
+        };
+    };
+
+
+    /*
+     * Predictor
+     * http://www.awaresystems.be/imaging/tiff/tifftags/predictor.html
+     */
+
+    class PredictorType
+    {
+    public:
+        enum
+        {
+            NONE = 1,
+            HORIZONTAL_DIFFERENCING,
+            FLOATING_POINT
         };
     };
 
@@ -155,11 +218,12 @@ public:
      * @param type
      *   The TIFF type to return the size of
      * @return
-     *   The size of the specified TIFF type
+     *   The size of the specified TIFF type, or 0 if the type is
+     *   not known
      *****************************************************************/
     static short sizeOf(unsigned short type)
     {
-        return mTypeSizes[type];
+        return type < Type::MAX ? mTypeSizes[type] : 0;
     }
 
 private:
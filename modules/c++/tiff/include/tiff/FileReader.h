@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 #include <import/io.h>
+#include <sys/Mutex.h>
 
 #include "tiff/Header.h"
 #include "tiff/ImageReader.h"
@@ -41,6 +42,12 @@ namespace tiff
  * Reads a TIFF file and all images within that file.  Has functions
  * to access a specific image within the file, and to read data from
  * a specific image in the file.
+ *
+ * Opening a file only records where each image's IFD starts; an IFD
+ * is parsed the first time its image is accessed.  Images may be
+ * accessed and read from several threads at once.  The IFD offsets
+ * can also be kept in an index file next to the TIFF file, so that
+ * reopening a file with many images does not walk the IFD chain.
  *********************************************************************/
 class FileReader
 {
@@ -66,6 +73,21 @@ public:
         openFile(fileName);
     }
 
+    /**
+     *****************************************************************
+     * Constructor.  Opens the specified file as a TIFF file, using
+     * an index file for its image offsets.
+     *
+     * @param fileName
+     *   the file to open and parse as a TIFF file
+     * @param indexFileName
+     *   the index file to read, or write (see openFile())
+     *****************************************************************/
+    FileReader(const std::string& fileName, const std::string& indexFileName)
+    {
+        openFile(fileName, indexFileName);
+    }
+
     //! Destructor
     ~FileReader()
     {
@@ -74,17 +96,48 @@ public:
 
     /**
      *****************************************************************
-     * Processes the TIFF file.  Reads the TIFF header, and every
-     * IFD the file has, creating a new ImageReader for each.
+     * Processes the TIFF file.  Reads the TIFF header, and walks the
+     * chain of IFDs to find where each image starts.  The IFDs
+     * themselves are parsed when their images are first accessed.
      *****************************************************************/
     void openFile(const std::string& fileName);
 
+    /**
+     *****************************************************************
+     * Processes the TIFF file, reading its image offsets from an
+     * index file when the index matches the TIFF file.  Otherwise
+     * the IFD chain is walked and the index file is (re)written; an
+     * index that can't be written is skipped.
+     *
+     * @param fileName
+     *   the file to open and parse as a TIFF file
+     * @param indexFileName
+     *   the index file to read the image offsets from, or write
+     *   them to
+     *****************************************************************/
+    void openFile(const std::string& fileName,
+                  const std::string& indexFileName);
+
+    /**
+     *****************************************************************
+     * Writes the offset of each image in the open file to an index
+     * file, which a later openFile() can read instead of walking the
+     * IFD chain.  The index records the size and modification time
+     * of the TIFF file, so that a stale index is not used.
+     *
+     * @param indexFileName
+     *   the index file to write
+     *****************************************************************/
+    void writeIndex(const std::string& indexFileName) const;
+
     //! Closes the TIFF file and clears out member data.
     void close();
 
     /**
      *****************************************************************
-     * Retrieves an ImageReader pointer to the specified image.
+     * Retrieves an ImageReader pointer to the specified image,
+     * parsing its IFD if this is the first access.  This may be
+     * called from several threads at once.
      *
      * @param index
      *   the numeric index of the image to retrieve
@@ -128,20 +181,56 @@ public:
      *****************************************************************/
     sys::Uint32_T getImageCount() const
     {
-        return mImages.size();
+        return static_cast<sys::Uint32_T>(mImageOffsets.size());
     }
 
-    
+    /**
+     *****************************************************************
+     * Returns the TIFF file header.
+     *
+     * @return
+     *   the TIFF file header
+     *****************************************************************/
+    const tiff::Header& getHeader() const
+    {
+        return mHeader;
+    }
+
+
 private:
 
+    //! Walks the IFD chain, recording the offset of each IFD.
+    void scanImageOffsets();
+
+    /**
+     *****************************************************************
+     * Reads the image offsets from an index file.
+     *
+     * @param indexFileName
+     *   the index file to read
+     * @return
+     *   false if the index file is missing, unreadable, or does not
+     *   match the open file
+     *****************************************************************/
+    bool readIndex(const std::string& indexFileName);
+
     //! The input stream to use to read the TIFF file
-    io::FileInputStream mInput;
+    mutable io::FileInputStream mInput;
+
+    //! Serializes positioned reads on mInput across all images
+    mutable sys::Mutex mInputMutex;
+
+    //! The name of the open file
+    std::string mFileName;
 
     //! The TIFF file header
     tiff::Header mHeader;
 
-    //! The images within the TIFF file
-    std::vector<tiff::ImageReader *> mImages;
+    //! The offset of each image's IFD
+    std::vector<sys::Uint64_T> mImageOffsets;
+
+    //! The images within the TIFF file, NULL until first accessed
+    mutable std::vector<tiff::ImageReader *> mImages;
 
     //! Whether to reverse bytes while reading.
     bool mReverseBytes;
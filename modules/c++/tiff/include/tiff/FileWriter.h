@@ -23,11 +23,13 @@
 #ifndef __TIFF_FILE_WRITER_H__
 #define __TIFF_FILE_WRITER_H__
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <import/io.h>
 #include "tiff/Header.h"
 #include "tiff/ImageWriter.h"
+#include "tiff/Overviews.h"
 
 namespace tiff
 {
@@ -45,9 +47,28 @@ class FileWriter
 {
 public:
 
+    /**
+     * The on-disk format of the file.  CLASSIC uses 4-byte offsets and
+     * is limited to 4 GB, BIGTIFF uses 8-byte offsets, and AUTO writes
+     * classic TIFF unless the first image would exceed the classic
+     * limit, in which case the file is promoted to BigTIFF.
+     */
+    enum FileFormat { CLASSIC, BIGTIFF, AUTO };
+
+    /**
+     * The placement of the IFDs and image data written by
+     * writePyramid().  SEQUENTIAL writes each level's data followed by
+     * its IFD, full resolution first.  CLOUD_OPTIMIZED writes every
+     * IFD right after the header, followed by the tiles of the
+     * smallest overview through to the full resolution image, so that
+     * a reader can find any level with a single read at the front of
+     * the file and fetch coarse levels before fine ones.
+     */
+    enum Layout { SEQUENTIAL, CLOUD_OPTIMIZED };
+
     //! Constructor
     FileWriter() :
-        mIFDOffset(0)
+        mIFDOffset(0), mFileFormat(AUTO), mLayout(SEQUENTIAL)
     {
     }
 
@@ -59,7 +80,7 @@ public:
      *   the file to open for writing
      *****************************************************************/
     FileWriter(const std::string& fileName) :
-        mIFDOffset(0)
+        mIFDOffset(0), mFileFormat(AUTO), mLayout(SEQUENTIAL)
     {
         openFile(fileName);
     }
@@ -116,6 +137,83 @@ public:
      *****************************************************************/
     void writeHeader();
 
+    /**
+     *****************************************************************
+     * Sets the format of the file.  Must be called before the
+     * header is written.  The default is AUTO.
+     *
+     * @param format
+     *   the format to write the file in
+     *****************************************************************/
+    void setFileFormat(const FileFormat format)
+    {
+        mFileFormat = format;
+    }
+
+    /**
+     *****************************************************************
+     * Retrieves the requested format of the file.
+     *
+     * @return
+     *   the format of the file, CLASSIC, BIGTIFF or AUTO
+     *****************************************************************/
+    FileFormat getFileFormat() const
+    {
+        return mFileFormat;
+    }
+
+    /**
+     *****************************************************************
+     * Sets the layout used by writePyramid().  The default is
+     * SEQUENTIAL.
+     *
+     * @param layout
+     *   the layout to write pyramids in
+     *****************************************************************/
+    void setLayout(const Layout layout)
+    {
+        mLayout = layout;
+    }
+
+    /**
+     *****************************************************************
+     * Retrieves the layout used by writePyramid().
+     *
+     * @return
+     *   the layout, SEQUENTIAL or CLOUD_OPTIMIZED
+     *****************************************************************/
+    Layout getLayout() const
+    {
+        return mLayout;
+    }
+
+    /**
+     *****************************************************************
+     * Writes an image along with a pyramid of reduced resolution
+     * overviews, each half the size of the one before.  The image
+     * must be the last one added, with its IFD filled in and no data
+     * written yet.  Every overview is written as a further image in
+     * the file, flagged as reduced resolution in NewSubfileType and
+     * otherwise described by a copy of the image's IFD.  Overviews
+     * are tiled; the CLOUD_OPTIMIZED layout tiles the full resolution
+     * image as well, and requires that its IFD hold no strip or tile
+     * layout tags.  The full resolution image is written by the
+     * ImageWriter that addImage() returned, which stays valid.
+     *
+     * @param buffer
+     *   the full resolution image, in raster format
+     * @param numOverviews
+     *   the number of overviews to write
+     * @param kernel
+     *   the filter to create the overviews with
+     * @param numThreads
+     *   the number of threads to create and compress the levels with
+     *****************************************************************/
+    void writePyramid(const unsigned char *buffer,
+                      size_t numOverviews,
+                      OverviewKernel::Type kernel = OverviewKernel::AVERAGE,
+                      size_t numThreads = 1);
+
 
 private:
     // Noncopyable
@@ -123,8 +221,46 @@ private:
     const FileWriter& operator=(const FileWriter& );
 
 private:
+    /**
+     *****************************************************************
+     * Creates a writer for one level of a pyramid, described by a
+     * copy of the image's IFD.
+     *
+     * @param image
+     *   the full resolution image
+     * @param width
+     *   the width of the level
+     * @param length
+     *   the length of the level
+     * @param overview
+     *   whether the level is a reduced resolution overview
+     * @return
+     *   the writer for the level
+     *****************************************************************/
+    std::auto_ptr<tiff::ImageWriter> createLevel(tiff::ImageWriter& image,
+                                                 size_t width,
+                                                 size_t length,
+                                                 bool overview);
+
+    /**
+     *****************************************************************
+     * Makes sure the file can address the specified number of bytes
+     * beyond the current position, promoting an automatically
+     * formatted file to BigTIFF if nothing has been written to it yet.
+     *
+     * @param numBytes
+     *   the estimated number of bytes still to be written
+     *****************************************************************/
+    void reserveFileSize(sys::Uint64_T numBytes);
+
     //! The position to write the offset to the first IFD to
-    sys::Uint32_T mIFDOffset;
+    sys::Uint64_T mIFDOffset;
+
+    //! The requested format of the file
+    FileFormat mFileFormat;
+
+    //! The layout of pyramids
+    Layout mLayout;
 
     //! The output stream
     io::FileOutputStream mOutput;
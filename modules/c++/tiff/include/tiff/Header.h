@@ -39,21 +39,30 @@ class Header : public io::Serializable
 public:
     enum ByteOrder { MM, II };
 
+    //! The version identifier of a classic TIFF file
+    static const unsigned short CLASSIC_ID = 42;
+
+    //! The version identifier of a BigTIFF file
+    static const unsigned short BIGTIFF_ID = 43;
+
+    //! The largest file offset a classic TIFF file can address
+    static const sys::Uint64_T CLASSIC_MAX_OFFSET = 0xFFFFFFFFu;
+
     /**
      *****************************************************************
      * Constructor.  Allows the user to set the values in the header
      * and also provides resonable defaults.
      *
      * @param id
-     *   the TIFF identifier, always "42"
+     *   the TIFF identifier, "42" for classic TIFF or "43" for BigTIFF
      * @param byteOrder
      *   the byte order of the file "MM" for Big Endian, "II" 
      *   for Little Endian
      * @param ifdOffset
      *   the offset to the first IFD
      *****************************************************************/
-    Header(const unsigned short id = 42, const char byteOrder[2] = "  ",
-            const sys::Uint32_T ifdOffset = 8) :
+    Header(const unsigned short id = CLASSIC_ID, const char byteOrder[2] = "  ",
+            const sys::Uint64_T ifdOffset = 8) :
         mId(id), mIFDOffset(ifdOffset)
     {
         bool isBigEndian = sys::isBigEndianSystem();
@@ -124,11 +133,64 @@ public:
      * @return
      *   the IFD offset
      *****************************************************************/
-    sys::Uint32_T getIFDOffset() const
+    sys::Uint64_T getIFDOffset() const
     {
         return mIFDOffset;
     }
 
+    /**
+     *****************************************************************
+     * Retrieves the file position of the first IFD offset within the
+     * header.  This is where the offset is written once the position
+     * of the first IFD is known.
+     *
+     * @return
+     *   the file position of the first IFD offset
+     *****************************************************************/
+    sys::Uint64_T getIFDOffsetPosition() const
+    {
+        return isBigTIFF() ? 8 : 4;
+    }
+
+    /**
+     *****************************************************************
+     * Returns whether the header describes a BigTIFF (version 43)
+     * file, which uses 8-byte offsets throughout.
+     *
+     * @return
+     *   true if this is a BigTIFF header
+     *****************************************************************/
+    bool isBigTIFF() const
+    {
+        return mId == BIGTIFF_ID;
+    }
+
+    /**
+     *****************************************************************
+     * Switches the header between the classic and BigTIFF formats.
+     * The first IFD offset is reset to immediately follow the header.
+     *
+     * @param bigTIFF
+     *   true to write a BigTIFF header, false for classic TIFF
+     *****************************************************************/
+    void setBigTIFF(bool bigTIFF)
+    {
+        mId = bigTIFF ? BIGTIFF_ID : CLASSIC_ID;
+        mIFDOffset = size();
+    }
+
+    /**
+     *****************************************************************
+     * Returns the size in bytes of the header as it appears on disk.
+     *
+     * @return
+     *   16 for BigTIFF, 8 for classic TIFF
+     *****************************************************************/
+    sys::Uint64_T size() const
+    {
+        return isBigTIFF() ? 16 : 8;
+    }
+
     ByteOrder getByteOrder() const
     {
         if (mByteOrder[0] == 'M' && mByteOrder[1] == 'M')
@@ -151,7 +213,7 @@ private:
     unsigned short mId;
 
     //! The IFD offset
-    sys::Uint32_T mIFDOffset;
+    sys::Uint64_T mIFDOffset;
     
     bool mDifferentByteOrdering;
     
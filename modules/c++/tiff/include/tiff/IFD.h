@@ -23,8 +23,9 @@
 #ifndef __TIFF_IFD_H__
 #define __TIFF_IFD_H__
 
-#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include <import/io.h>
 #include <import/except.h>
 
@@ -44,12 +45,18 @@ namespace tiff
  * entry in it further defines the image it is associated with.
  * Contains functions for adding new entries to the IFD or adding
  * values to a specific IFD entry.
+ *
+ * The entries are kept in a flat array sorted by tag, which is the
+ * order they are written in.  An IFD holds a few dozen entries at
+ * most, so finding one by tag (see tiff::Const::Tag) is a short
+ * binary search over contiguous memory.  Finding one by name first
+ * resolves the name through the KnownTagsRegistry.
  *********************************************************************/
 class IFD : public io::Serializable
 {
 public:
-    //! The IFDType
-    typedef std::map<unsigned short, tiff::IFDEntry *> IFDType;
+    //! The IFDType, sorted by tag
+    typedef std::vector<tiff::IFDEntry *> IFDType;
 
     //! Constructor
     IFD() :
@@ -60,7 +67,7 @@ public:
     //! Deconstructor
     ~IFD()
     {
-        for (sys::Uint32_T i = 0; i < mIFD.size(); ++i)
+        for (size_t i = 0; i < mIFD.size(); ++i)
             delete mIFD[i];
     }
 
@@ -126,6 +133,30 @@ public:
      *****************************************************************/
     void addEntry(const tiff::IFDEntry *entry);
 
+    /**
+     *****************************************************************
+     * Adds an empty IFDEntry with the specified tag to the IFD, using
+     * the name and type the KnownTagsRegistry has for it, and returns
+     * it.  Replaces any entry with the same tag.
+     *
+     * @param tag
+     *   the tag of the IFDEntry to add (see tiff::Const::Tag)
+     * @return
+     *   the added IFDEntry, which the IFD owns
+     *****************************************************************/
+    tiff::IFDEntry *addEntry(unsigned short tag);
+
+    /**
+     *****************************************************************
+     * Adds a copy of the specified IFDEntry to the IFD, including
+     * copies of each of its values, so that the IFD shares nothing
+     * with the original.  Replaces any entry with the same tag.
+     *
+     * @param entry
+     *   the IFDEntry to copy into the IFD
+     *****************************************************************/
+    void copyEntry(const tiff::IFDEntry& entry);
+
     /**
      *****************************************************************
      * Adds an IFDEntry with the specified name to the IFD.  Looks 
@@ -155,13 +186,9 @@ public:
             throw except::Exception(Ctxt(FmtX(
                                     "Unable to add IFD Entry: unknown tag [%s]", name.c_str())));
 
-        unsigned short id = mapEntry->getTagID();
-        unsigned short type = mapEntry->getType();
-
-        mIFD[id] = new tiff::IFDEntry;
-        *(mIFD[id]) = *mapEntry;
-        mIFD[id]->addValue(tiff::TypeFactory::create( (unsigned char *)&value,
-                type));
+        std::auto_ptr<tiff::IFDEntry> entry(new tiff::IFDEntry(*mapEntry));
+        entry->appendValues((const unsigned char *)&value, 1);
+        insert(entry);
     }
 
     /**
@@ -181,8 +208,7 @@ public:
         if (!entry)
             throw except::Exception(Ctxt("IFD entry must exist before adding values"));
 
-        entry->addValue(tiff::TypeFactory::create((unsigned char *)&value,
-                entry->getType()));
+        entry->appendValues((const unsigned char *)&value, 1);
     }
 
     /**
@@ -191,8 +217,11 @@ public:
      *
      * @param output
      *   the output stream to write the IFD to
+     * @param bigTIFF
+     *   whether to write the IFD in the BigTIFF layout
      *****************************************************************/
     void serialize(io::OutputStream& output);
+    void serialize(io::OutputStream& output, const bool bigTIFF);
 
     /**
      *****************************************************************
@@ -200,9 +229,33 @@ public:
      *
      * @param input
      *   the input stream to read the IFD from
+     * @param reverseBytes
+     *   whether the file byte order differs from the system's
+     * @param bigTIFF
+     *   whether the IFD uses the BigTIFF layout
      *****************************************************************/
     void deserialize(io::InputStream& input);
     void deserialize(io::InputStream& input, const bool reverseBytes);
+    void deserialize(io::InputStream& input, const bool reverseBytes,
+                     const bool bigTIFF);
+
+    /**
+     *****************************************************************
+     * Reads the complete IFD from the specified input stream, leaving
+     * large arrays in the stream until they are used.
+     *
+     * @param deferSize
+     *   if nonzero, entries whose values exceed this many bytes are
+     *   read on first use (see tiff::IFDEntry::deserialize())
+     *****************************************************************/
+    void deserialize(io::InputStream& input, const bool reverseBytes,
+                     const bool bigTIFF, const sys::Uint64_T deferSize);
+
+    /**
+     *****************************************************************
+     * Reads any values that deserialize() left in the stream.
+     *****************************************************************/
+    void loadValues();
 
     /**
      *****************************************************************
@@ -226,6 +279,31 @@ public:
         return mIFD.size();
     }
 
+    /**
+     *****************************************************************
+     * Returns the tag identifiers of the entries in the IFD, in
+     * ascending order.
+     *
+     * @return
+     *   the tags in the IFD
+     *****************************************************************/
+    std::vector<unsigned short> getTags() const;
+
+    /**
+     *****************************************************************
+     * Returns the number of bytes the IFD occupies when serialized,
+     * including any values stored outside of the entries.
+     *
+     * @param bigTIFF
+     *   whether the IFD will be written in the BigTIFF layout
+     * @return
+     *   the size of the IFD in bytes
+     *****************************************************************/
+    sys::Uint64_T getSerializedSize(const bool bigTIFF)
+    {
+        return finalize(0, bigTIFF);
+    }
+
     /**
      *****************************************************************
      * Calculates the image size in bytes from entries in the IFD and
@@ -234,7 +312,7 @@ public:
      * @return 
      *   the calculated image size in bytes
      *****************************************************************/
-    sys::Uint32_T getImageSize();
+    sys::Uint64_T getImageSize();
 
     /**
      *****************************************************************
@@ -277,13 +355,20 @@ public:
      * @return
      *   the offset to write the next IFD offset to
      *****************************************************************/
-    sys::Uint32_T getNextIFDOffsetPosition()
+    sys::Uint64_T getNextIFDOffsetPosition()
     {
         return mNextIFDOffsetPosition;
     }
 
 private:
 
+    //! Returns the position of the first entry with a tag not less than tag
+    IFDType::iterator lowerBound(unsigned short tag);
+    IFDType::const_iterator lowerBound(unsigned short tag) const;
+
+    //! Adds the entry, deleting any it replaces
+    void insert(std::auto_ptr<tiff::IFDEntry> entry);
+
     /**
      *****************************************************************
      * Finalizes all of the IFD entries.  Calculates the file offsets
@@ -293,17 +378,19 @@ private:
      * @param offset
      *   the file offset that indicates the beginning position of 
      *   the IFD.
+     * @param bigTIFF
+     *   whether the IFD will be written in the BigTIFF layout
      * @return
      *   the highest overflow offset calculated, this marks the
      *   potential beginning of the next image.
      *****************************************************************/
-    sys::Uint32_T finalize(const sys::Uint32_T offset);
+    sys::Uint64_T finalize(const sys::Uint64_T offset, const bool bigTIFF);
 
     //! The IFD entries
     IFDType mIFD;
 
     //! Offset where the next IFD offset can be written to
-    sys::Uint32_T mNextIFDOffsetPosition;
+    sys::Uint64_T mNextIFDOffsetPosition;
 };
 
 } // End namespace.
@@ -44,13 +44,20 @@ namespace tiff
  * includes all of the data associated with an IFD entry.  There are
  * functions for printing out the entry, reading and writing it to a
  * file, and accessing the data.
+ *
+ * The values are stored contiguously in native byte order, so large
+ * arrays such as StripOffsets cost one allocation rather than one per
+ * value.  The tiff::TypeInterface objects returned by operator[] and
+ * getValues() are read-only views, created the first time they are
+ * asked for.
  *********************************************************************/
 class IFDEntry : public io::Serializable
 {
 public:
     //! Constructor
     IFDEntry() :
-        mTag(0), mType(0), mCount(0), mOffset(0)
+        mTag(0), mType(0), mCount(0), mOffset(0), mSource(NULL),
+        mReverseBytes(false)
     {
     }
 
@@ -69,8 +76,9 @@ public:
      *   the number of values for this entry
      *****************************************************************/
     IFDEntry(const unsigned short tag, const unsigned short type,
-            const std::string& name, const sys::Uint32_T count = 0) :
-        mTag(tag), mType(type), mCount(count), mOffset(0), mName(name)
+            const std::string& name, const sys::Uint64_T count = 0) :
+        mTag(tag), mType(type), mCount(count), mOffset(0), mName(name),
+        mSource(NULL), mReverseBytes(false)
     {
     }
 
@@ -87,16 +95,22 @@ public:
      *   the number of values for this entry
      *****************************************************************/
     IFDEntry(const unsigned short tag, const unsigned short type,
-            const sys::Uint32_T count = 0) :
-        mTag(tag), mType(type), mCount(count), mOffset(0)
+            const sys::Uint64_T count = 0) :
+        mTag(tag), mType(type), mCount(count), mOffset(0), mSource(NULL),
+        mReverseBytes(false)
     {
     }
 
+    //! Copy constructor.  Copies the values, but not their views.
+    IFDEntry(const IFDEntry& other);
+
+    //! Assignment operator.  Copies the values, but not their views.
+    IFDEntry& operator=(const IFDEntry& other);
+
     //! Deconstructor
     ~IFDEntry()
     {
-        for (sys::Uint32_T i = 0; i < mValues.size(); ++i)
-            delete mValues[i];
+        clearViews();
     }
 
     /**
@@ -106,11 +120,65 @@ public:
      * @param index
      *   the index that indicates which value to retrieve
      * @return
-     *   the value at the specified index, or NULL
+     *   the value at the specified index, or NULL if the entry holds
+     *   fewer values
      *****************************************************************/
     tiff::TypeInterface *operator[](const sys::Uint32_T index) const
     {
-        return mValues[index];
+        const std::vector<tiff::TypeInterface *>& views = getViews();
+        return index < views.size() ? views[index] : NULL;
+    }
+
+    /**
+     *****************************************************************
+     * Returns the value at the specified index widened to an unsigned
+     * 64-bit integer.  Offsets and byte counts may be stored as
+     * SHORT, LONG or LONG8 depending on the writer, so this is the
+     * preferred way to read them.
+     *
+     * @param index
+     *   the index that indicates which value to retrieve, which must
+     *   be less than getCount()
+     * @return
+     *   the value at the specified index
+     *****************************************************************/
+    sys::Uint64_T getUint64(const size_t index) const;
+
+    /**
+     *****************************************************************
+     * Returns every value widened to an unsigned 64-bit integer, as
+     * getUint64() does for one.
+     *
+     * @param values
+     *   the vector to fill with the values
+     *****************************************************************/
+    void getUint64Values(std::vector<sys::Uint64_T>& values) const;
+
+    /**
+     *****************************************************************
+     * Returns the values packed contiguously, in the entry's type and
+     * native byte order.
+     *
+     * @return
+     *   the packed values
+     *****************************************************************/
+    const std::vector<unsigned char>& getData() const
+    {
+        load();
+        return mData;
+    }
+
+    /**
+     *****************************************************************
+     * Returns whether the values have been read.  Values deferred by
+     * deserialize() are read the first time they are used.
+     *
+     * @return
+     *   false if the values are still waiting to be read
+     *****************************************************************/
+    bool isLoaded() const
+    {
+        return mSource == NULL;
     }
 
     /**
@@ -121,6 +189,7 @@ public:
      *   the output stream to write the entry to
      *****************************************************************/
     void serialize(io::OutputStream& output);
+    void serialize(io::OutputStream& output, const bool bigTIFF);
 
     /**
      *****************************************************************
@@ -128,9 +197,22 @@ public:
      *
      * @param input
      *   the input stream to read the entry from
+     * @param reverseBytes
+     *   whether the file byte order differs from the system's
+     * @param bigTIFF
+     *   whether the entry uses the BigTIFF (20 byte) layout
+     * @param deferSize
+     *   if nonzero, values larger than this many bytes are not read
+     *   until they are first used.  The stream must then outlive the
+     *   entry, and that first use must not race with other reads of
+     *   the stream.
      *****************************************************************/
     void deserialize(io::InputStream& input);
     void deserialize(io::InputStream& input, const bool reverseBytes);
+    void deserialize(io::InputStream& input, const bool reverseBytes,
+                     const bool bigTIFF);
+    void deserialize(io::InputStream& input, const bool reverseBytes,
+                     const bool bigTIFF, const sys::Uint64_T deferSize);
 
     /**
      *****************************************************************
@@ -185,7 +267,7 @@ public:
      * @return
      *  the number of values in the IFD entry.
      *****************************************************************/
-    sys::Uint32_T getCount() const
+    sys::Uint64_T getCount() const
     {
         return mCount;
     }
@@ -197,7 +279,7 @@ public:
      * @return
      *  the value offset
      *****************************************************************/
-    sys::Uint32_T getOffset() const
+    sys::Uint64_T getOffset() const
     {
         return mOffset;
     }
@@ -223,7 +305,7 @@ public:
      *****************************************************************/
     const std::vector<tiff::TypeInterface *>& getValues() const
     {
-        return mValues;
+        return getViews();
     }
 
     /**
@@ -235,21 +317,21 @@ public:
      *****************************************************************/
     std::vector<tiff::TypeInterface *> getValues()
     {
-        return mValues;
+        return getViews();
     }
 
     /**
      *****************************************************************
      * Adds a value to the IFD entry, taking ownership.  IFD Entries
-     * can have multiple values within them.
+     * can have multiple values within them.  The value is copied into
+     * the entry, so later changes to it are not seen.
      *
      * @param value
      *   the tiff::GenericType to add as a value
      *****************************************************************/
     void addValue(tiff::TypeInterface *value)
     {
-        mValues.push_back(value);
-        ++mCount;
+        addValue(std::auto_ptr<tiff::TypeInterface>(value));
     }
 
     /**
@@ -260,12 +342,30 @@ public:
      * @param value
      *   the tiff::GenericType to add as a value
      *****************************************************************/
-    void addValue(std::auto_ptr<tiff::TypeInterface> value)
-    {
-        mValues.push_back(value.get());
-        ++mCount;
-        value.release();
-    }
+    void addValue(std::auto_ptr<tiff::TypeInterface> value);
+
+    /**
+     *****************************************************************
+     * Adds values to the IFD entry from a buffer that holds them in
+     * the entry's type and native byte order.
+     *
+     * @param buffer
+     *   the values to add
+     * @param count
+     *   the number of values in the buffer
+     *****************************************************************/
+    void appendValues(const unsigned char *buffer, const size_t count);
+
+    /**
+     *****************************************************************
+     * Adds an unsigned integral value to the IFD entry, narrowed to
+     * the entry's type (BYTE, SHORT, LONG or LONG8).  Throws if the
+     * entry's type is not unsigned integral.
+     *
+     * @param value
+     *   the value to add
+     *****************************************************************/
+    void addUint64(const sys::Uint64_T value);
 
     /**
      *****************************************************************
@@ -322,23 +422,27 @@ public:
      * @param count
      *   the number of values in the buffer
      *****************************************************************/
-    void parseValues(const unsigned char *buffer, const sys::Uint32_T count);
+    void parseValues(const unsigned char *buffer, const sys::Uint64_T count);
 
     /**
      *****************************************************************
      * Used for outputting the IFD entry to a file.  Calculates
      * a file offset to put data that overflows the size allowed for
-     * an IFD entry value (4 bytes) and sets the value count to be
-     * the number of values that were added to the IFD entry.
+     * an IFD entry value (4 bytes, or 8 bytes for BigTIFF) and sets
+     * the value count to be the number of values that were added to
+     * the IFD entry.
      *
      * @param offset
      *   the next free file offset that the values will can be
      *   written to
+     * @param bigTIFF
+     *   whether the entry will be written in the BigTIFF layout
      * @return
      *   the next free file offset, compensating for the IFD entry's
      *   values being written at the specified input offset
      *****************************************************************/
-    sys::Uint32_T finalize(const sys::Uint32_T offset);
+    sys::Uint64_T finalize(const sys::Uint64_T offset,
+                           const bool bigTIFF = false);
 
     /**
      *****************************************************************
@@ -347,13 +451,32 @@ public:
      * mName of string type, and mValues of vector type (both of which
      * are not in the specification but exist to make life simpler),
      * hence the adjustment.  Returns the size of the IFD entry.
+     * BigTIFF widens the count and value fields to 8 bytes each, for
+     * an entry size of 20 bytes.
+     *
+     * @param bigTIFF
+     *   whether to return the BigTIFF entry size
+     * @return
+     *   the size of an IFD entry (12 or 20 bytes).
+     *****************************************************************/
+    static unsigned short sizeOf(const bool bigTIFF = false)
+    {
+        return bigTIFF ? 20 : 12;
+    }
+
+    /**
+     *****************************************************************
+     * Returns the number of value bytes that fit directly within an
+     * IFD entry, without being moved to an offset.
      *
+     * @param bigTIFF
+     *   whether to return the BigTIFF value field size
      * @return
-     *   the size of an IFD entry (12 bytes).
+     *   the size of the value field (4 or 8 bytes)
      *****************************************************************/
-    static unsigned short sizeOf()
+    static unsigned short valueFieldSize(const bool bigTIFF = false)
     {
-        return 12;
+        return bigTIFF ? 8 : 4;
     }
 
 private:
@@ -370,6 +493,26 @@ private:
      *****************************************************************/
     void parseValues(const unsigned char *buffer);
 
+    //! Reads values that deserialize() deferred, if there are any.
+    void load() const
+    {
+        if (mSource)
+            readDeferred();
+    }
+
+    //! Reads the deferred values from mSource.
+    void readDeferred() const;
+
+    //! Byte swaps packed values of the specified type in place.
+    static void swapValues(unsigned char *buffer, const unsigned short type,
+                           const size_t count);
+
+    //! Returns the views of the values, creating any that are missing.
+    const std::vector<tiff::TypeInterface *>& getViews() const;
+
+    //! Deletes the views of the values.
+    void clearViews();
+
     //! The TIFF tag identifier
     unsigned short mTag;
 
@@ -377,16 +520,25 @@ private:
     unsigned short mType;
 
     //! The number of values in the IFD entry
-    sys::Uint32_T mCount;
+    sys::Uint64_T mCount;
 
     //! The file offset to values for the IFD entry
-    sys::Uint32_T mOffset;
+    sys::Uint64_T mOffset;
 
     //! The name of the IFD entry (i.e. "ImageWidth")
     std::string mName;
 
-    //! The values in this IFD entry
-    std::vector<tiff::TypeInterface *> mValues;
+    //! The values in this IFD entry, packed in native byte order
+    mutable std::vector<unsigned char> mData;
+
+    //! Views of the values, created on demand
+    mutable std::vector<tiff::TypeInterface *> mValues;
+
+    //! The stream deferred values are read from, or NULL once read
+    mutable io::InputStream *mSource;
+
+    //! Whether deferred values must be byte swapped once read
+    bool mReverseBytes;
 };
 
 } // End namespace.
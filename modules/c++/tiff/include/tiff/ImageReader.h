@@ -23,8 +23,14 @@
 #ifndef __TIFF_IMAGE_READER_H__
 #define __TIFF_IMAGE_READER_H__
 
+#include <memory>
+#include <vector>
 #include <import/io.h>
+#include <sys/Mutex.h>
+#include <types/RowCol.h>
 
+#include "tiff/Codec.h"
+#include "tiff/Common.h"
 #include "tiff/IFDEntry.h"
 #include "tiff/IFD.h"
 
@@ -49,11 +55,21 @@ public:
      *
      * @param input
      *   the stream to read the TIFF image from
+     * @param inputMutex
+     *   a mutex guarding the stream, shared by every reader of the
+     *   same stream.  If NULL, the reader uses its own mutex.
      *****************************************************************/
-    ImageReader(io::FileInputStream *input) :
-        mIFD(), mStripByteCounts(NULL), mStripOffsets(NULL), mInput(input),
+    ImageReader(io::FileInputStream *input, sys::Mutex *inputMutex = NULL) :
+        mIFD(), mInput(input),
+                mInputMutex(inputMutex ? inputMutex : &mOwnInputMutex),
                 mNextOffset(0), mBytePosition(0), mStripIndex(0),
-                mElementSize(0), mReverseBytes(false)
+                mElementSize(0), mSampleSize(0), mReverseBytes(false),
+                mBigTIFF(false), mTiled(false), mChunkWidth(0),
+                mChunkLength(0), mChunksAcross(0), mChunksDown(0),
+                mCompression(tiff::Const::CompressionType::NO_COMPRESSION),
+                mPredictor(tiff::Const::PredictorType::NONE),
+                mLayoutLoaded(false),
+                mCachedChunk(static_cast<size_t>(-1))
     {
     }
 
@@ -66,8 +82,13 @@ public:
      *****************************************************************
      * Processes the image from the file.  Reads the image's IFD
      * and stores it for later use.
+     *
+     * @param reverseBytes
+     *   whether the file byte order differs from the system's
+     * @param bigTIFF
+     *   whether the file is a BigTIFF file
      *****************************************************************/
-    void process(const bool reverseBytes = false);
+    void process(const bool reverseBytes = false, const bool bigTIFF = false);
 
     /**
      *****************************************************************
@@ -93,16 +114,90 @@ public:
 
     /**
      *****************************************************************
-     * Returns a pointer to the IFD for this image.
+     * Reads one complete tile into the specified buffer.  The buffer
+     * must hold getTileWidth() * getTileLength() elements; tiles on
+     * the right and bottom edges include their padding.  For stripped
+     * images each strip is treated as a full-width tile, so tileCol
+     * must be 0 and the last strip may be shorter than the others.
      *
-     * @return
-     *   a pointer to the IFD for this image
+     * Compressed tiles are decompressed, and any predictor is undone.
+     * Unlike getData(), this does not depend on any read position, and
+     * it is safe to call from multiple threads at once.
+     *
+     * @param tileRow
+     *   the row of the tile to read, in tiles
+     * @param tileCol
+     *   the column of the tile to read, in tiles
+     * @param buffer
+     *   the buffer to populate with the tile's elements
      *****************************************************************/
-    tiff::IFD* getIFD()
+    void readTile(size_t tileRow, size_t tileCol, unsigned char *buffer);
+
+    /**
+     *****************************************************************
+     * Reads an arbitrary rectangle of the image into the specified
+     * buffer in raster order.  Each tile (or strip) that intersects
+     * the region is read whole, with a single positioned read.  This
+     * is safe to call from multiple threads at once.
+     *
+     * With more than one thread, the tiles are decompressed and byte
+     * swapped in parallel, and each is copied straight into its place
+     * in the buffer.  Only the file reads themselves are serialized.
+     *
+     * @param offset
+     *   the row and column of the upper left corner of the region
+     * @param dims
+     *   the number of rows and columns in the region
+     * @param buffer
+     *   the buffer to populate, which must hold dims.area() elements
+     * @param numThreads
+     *   the number of threads to decode tiles with
+     *****************************************************************/
+    void readRegion(const types::RowCol<size_t>& offset,
+                    const types::RowCol<size_t>& dims,
+                    unsigned char *buffer,
+                    size_t numThreads = 1);
+
+    //! Whether the image is stored in tiles rather than strips.
+    bool isTiled() const
     {
-        return &mIFD;
+        return mTiled;
+    }
+
+    //! The width of a tile in elements, or the image width for strips.
+    size_t getTileWidth() const
+    {
+        return mChunkWidth;
+    }
+
+    //! The length of a tile in rows, or the rows per strip for strips.
+    size_t getTileLength() const
+    {
+        return mChunkLength;
+    }
+
+    //! The number of tiles across the image.
+    size_t getTilesAcross() const
+    {
+        return mChunksAcross;
+    }
+
+    //! The number of tiles down the image.
+    size_t getTilesDown() const
+    {
+        return mChunksDown;
     }
 
+    /**
+     *****************************************************************
+     * Returns a pointer to the IFD for this image.  Large arrays that
+     * process() left in the file are read first.
+     *
+     * @return
+     *   a pointer to the IFD for this image
+     *****************************************************************/
+    tiff::IFD* getIFD();
+
     /**
      *****************************************************************
      * Writes out any GeoTIFF information found in the IFD to the
@@ -122,13 +217,134 @@ public:
      * @return
      *   the next IFD offset
      *****************************************************************/
-    sys::Uint32_T getNextOffset() const
+    sys::Uint64_T getNextOffset() const
     {
         return mNextOffset;
     }
 
 private:
 
+    /**
+     *****************************************************************
+     * Caches the strip or tile layout from the IFD, so that reads do
+     * not need to go back to the IFD.  The offset and byte count
+     * arrays are left in the file until loadLayout() is called.
+     *****************************************************************/
+    void cacheLayout();
+
+    /**
+     *****************************************************************
+     * Reads the offset and byte count arrays, if they have not been
+     * read yet.  The caller must hold the input mutex.
+     *****************************************************************/
+    void loadLayout();
+
+    /**
+     *****************************************************************
+     * Returns the file offset and byte count of a strip or tile,
+     * reading the arrays first if need be.
+     *
+     * @param index
+     *   the index of the strip or tile
+     * @param offset
+     *   set to the file offset of the chunk
+     * @param byteCount
+     *   set to the number of bytes the chunk occupies
+     *****************************************************************/
+    void getChunkLocation(size_t index, sys::Uint64_T& offset,
+                          sys::Uint64_T& byteCount);
+
+    /**
+     *****************************************************************
+     * Returns the codec for the image's compression, or NULL if it
+     * is uncompressed.
+     *
+     * @throw except::Exception
+     *   if the compression type is not supported
+     *****************************************************************/
+    const tiff::Codec *getCodec() const;
+
+    /**
+     *****************************************************************
+     * Reads bytes from an absolute file position.  The seek and read
+     * are done as a single operation while holding the input mutex.
+     *
+     * @param offset
+     *   the file position to read from
+     * @param buffer
+     *   the buffer to read into
+     * @param numBytes
+     *   the number of bytes to read
+     *****************************************************************/
+    void readAt(sys::Uint64_T offset, unsigned char *buffer, size_t numBytes);
+
+    /**
+     *****************************************************************
+     * Reads, decompresses and byte swaps one strip or tile.  The
+     * buffer must hold the tile's uncompressed size.
+     *
+     * @param tileRow
+     *   the row of the tile, in tiles
+     * @param tileCol
+     *   the column of the tile, in tiles
+     * @param buffer
+     *   the buffer to populate with the tile's elements
+     *****************************************************************/
+    void readChunk(size_t tileRow, size_t tileCol, unsigned char *buffer);
+
+    //! Reads a region's tiles on behalf of readRegion().
+    class RegionTileReader;
+
+    /**
+     *****************************************************************
+     * Reads one tile and copies the part that overlaps a region into
+     * the region's buffer.
+     *
+     * @param tileRow
+     *   the row of the tile, in tiles
+     * @param tileCol
+     *   the column of the tile, in tiles
+     * @param offset
+     *   the upper left corner of the region
+     * @param dims
+     *   the size of the region
+     * @param buffer
+     *   the region's buffer
+     * @param scratch
+     *   a buffer large enough to hold a whole tile
+     *****************************************************************/
+    void copyTileToRegion(size_t tileRow, size_t tileCol,
+                          const types::RowCol<size_t>& offset,
+                          const types::RowCol<size_t>& dims,
+                          unsigned char *buffer, unsigned char *scratch);
+
+    /**
+     *****************************************************************
+     * Reads the specified number of elements into the specified
+     * buffer from a compressed image.  Whole strips or tiles are
+     * decompressed, and the most recent one is kept for the next call.
+     *
+     * @param buffer
+     *   the buffer to populate
+     * @param numElementsToRead
+     *   the number of elements to read
+     *****************************************************************/
+    void getCompressedData(unsigned char *buffer,
+                           sys::Uint32_T numElementsToRead);
+
+    /**
+     *****************************************************************
+     * Returns the number of rows of image data in the specified tile
+     * row.  This is less than the tile length only for the last strip
+     * of a stripped image.
+     *
+     * @param tileRow
+     *   the row of the tile, in tiles
+     * @return
+     *   the number of rows stored for tiles in that row
+     *****************************************************************/
+    size_t getRowsInTile(size_t tileRow);
+
     /**
      *****************************************************************
      * Reads the specified number of elements into the specified 
@@ -156,28 +372,73 @@ private:
     //! Contains the IFD for this image.
     tiff::IFD mIFD;
 
-    //! A pointer to the "StripByteCounts" IFDEntry to make reading faster.
-    tiff::IFDEntry *mStripByteCounts;
-
-    //! A pointer to the "StripOffsets" IFDEntry to make reading faster.
-    tiff::IFDEntry *mStripOffsets;
-
     //! Points to the input file stream.
     io::FileInputStream *mInput;
 
+    //! Used when no mutex is shared with other readers of the stream.
+    sys::Mutex mOwnInputMutex;
+
+    //! Guards seeking and reading on the input stream.
+    sys::Mutex *mInputMutex;
+
     //! The offset to the next IFD.
-    sys::Uint32_T mNextOffset;
+    sys::Uint64_T mNextOffset;
 
     //! Used to keep track of the current read position in the file.
-    sys::Uint32_T mBytePosition;
+    sys::Uint64_T mBytePosition;
     
     sys::Uint32_T mStripIndex;
 
     //! The element size of the image.
     unsigned short mElementSize;
 
+    //! The size of a single sample, which is the unit of byte swapping.
+    unsigned short mSampleSize;
+
     //! Whether to reverse bytes when reading.
     bool mReverseBytes;
+
+    //! Whether the image is stored in a BigTIFF file.
+    bool mBigTIFF;
+
+    //! Whether the image is stored in tiles rather than strips.
+    bool mTiled;
+
+    //! The width of a tile (or strip) in elements.
+    size_t mChunkWidth;
+
+    //! The length of a tile (or strip) in rows.
+    size_t mChunkLength;
+
+    //! The number of tiles across the image (1 for strips).
+    size_t mChunksAcross;
+
+    //! The number of tiles (or strips) down the image.
+    size_t mChunksDown;
+
+    //! The file offset of each tile or strip.
+    std::vector<sys::Uint64_T> mChunkOffsets;
+
+    //! The byte count of each tile or strip.
+    std::vector<sys::Uint64_T> mChunkByteCounts;
+
+    //! The compression type, see tiff::Const::CompressionType.
+    unsigned short mCompression;
+
+    //! The predictor, see tiff::Const::PredictorType.
+    unsigned short mPredictor;
+
+    //! Whether mChunkOffsets and mChunkByteCounts have been read.
+    bool mLayoutLoaded;
+
+    //! The JPEG codec, which depends on the image's tables.
+    std::auto_ptr<tiff::JPEGCodec> mJPEGCodec;
+
+    //! The index of the tile held in mChunkBuffer, used by getData().
+    size_t mCachedChunk;
+
+    //! The most recently decompressed tile, used by getData().
+    std::vector<unsigned char> mChunkBuffer;
 };
 
 } // End namespace.
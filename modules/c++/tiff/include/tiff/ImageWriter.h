@@ -23,9 +23,13 @@
 #ifndef __TIFF_IMAGE_WRITER_H__
 #define __TIFF_IMAGE_WRITER_H__
 
+#include <memory>
+#include <vector>
 #include <import/io.h>
 
+#include "tiff/Codec.h"
 #include "tiff/Common.h"
+#include "tiff/Header.h"
 #include "tiff/IFDEntry.h"
 #include "tiff/IFD.h"
 
@@ -60,13 +64,25 @@ public:
      *   the output stream to write the image to
      * @param ifdOffset
      *   the offset to the beginning of the IFD for this image
+     * @param header
+     *   the header of the file being written, which determines
+     *   whether classic TIFF or BigTIFF offsets are written.  If
+     *   NULL, the image is written as classic TIFF.
+     * @param autoFormat
+     *   if true, the header is promoted to BigTIFF when this image
+     *   would not fit within the 4 GB classic TIFF limit.  This is
+     *   only possible for the first image in a file.
      *****************************************************************/
-    ImageWriter(io::FileOutputStream *output, const sys::Uint32_T ifdOffset) :
+    ImageWriter(io::FileOutputStream *output, const sys::Uint64_T ifdOffset,
+                tiff::Header *header = NULL, const bool autoFormat = false) :
         mStripByteCounts(NULL),
                 mTileOffsets(NULL),
-                mOutput(output), mIFDOffset(ifdOffset),
+                mOutput(output), mHeader(header), mIFDOffset(ifdOffset),
                 mIdealChunkSize(CHUNK_SIZE), mBytePosition(0), mElementSize(0),
-                mValidated(false), mFormat(STRIPPED)
+                mValidated(false), mAutoFormat(autoFormat), mFormat(STRIPPED),
+                mCodec(NULL), mPredictor(tiff::Const::PredictorType::NONE),
+                mJPEGQuality(75), mChunkWidth(0), mChunkLength(0),
+                mNumThreads(1)
     {
     }
 
@@ -117,11 +133,60 @@ public:
      * @return
      *   the position to write the next IFD offset to
      *****************************************************************/
-    sys::Uint32_T getNextIFDOffset() const
+    sys::Uint64_T getNextIFDOffset() const
     {
         return mIFDOffset;
     }
 
+    /**
+     *****************************************************************
+     * Sets the position to write the offset to this image's IFD to.
+     * Only needed when the IFDs are not written in the order the
+     * images were created in.
+     *
+     * @param ifdOffset
+     *   the position to write the offset to this image's IFD to
+     *****************************************************************/
+    void setIFDOffset(const sys::Uint64_T ifdOffset)
+    {
+        mIFDOffset = ifdOffset;
+    }
+
+    /**
+     *****************************************************************
+     * Returns the number of bytes this image's IFD, including the
+     * values stored outside of it, will occupy in the file.  The
+     * IFD is validated first, and its size does not change as the
+     * data is written.
+     *
+     * @return
+     *   the size of the IFD in bytes
+     *****************************************************************/
+    sys::Uint64_T getIFDSize();
+
+    /**
+     *****************************************************************
+     * Estimates an upper bound on the number of bytes this image's
+     * uncompressed data and IFD will occupy in the file.
+     *
+     * @return
+     *   the estimated size of the image in bytes
+     *****************************************************************/
+    sys::Uint64_T estimateSize();
+
+    /**
+     *****************************************************************
+     * Returns whether the image is being written with BigTIFF
+     * (8-byte) offsets.
+     *
+     * @return
+     *   true if the image is written as BigTIFF
+     *****************************************************************/
+    bool isBigTIFF() const
+    {
+        return mHeader && mHeader->isBigTIFF();
+    }
+
     /**
      *****************************************************************
      * Sets the ideal tile size.  Used if the image is a tiled image.
@@ -138,6 +203,18 @@ public:
         mIdealChunkSize = size;
     }
 
+    /**
+     *****************************************************************
+     * Retrieves the ideal tile size.
+     *
+     * @return
+     *   the ideal number of bytes in a tile
+     *****************************************************************/
+    sys::Uint32_T getIdealChunkSize() const
+    {
+        return mIdealChunkSize;
+    }
+
     /**
      *****************************************************************
      * Sets the image format to either TILED or STRIPPED.  The 
@@ -151,6 +228,38 @@ public:
         mFormat = format;
     }
 
+    /**
+     *****************************************************************
+     * Sets the number of threads used to compress strips or tiles.
+     * Each thread is given a row of strips or tiles, so the writer
+     * buffers that many rows of chunks before compressing them and
+     * writing them out in order.  Has no effect on uncompressed
+     * images.  The default is 1.
+     *
+     * @param numThreads
+     *   the number of threads to compress with
+     *****************************************************************/
+    void setNumThreads(size_t numThreads)
+    {
+        mNumThreads = numThreads;
+    }
+
+    /**
+     *****************************************************************
+     * Sets the quality JPEG compressed strips or tiles are written
+     * with, 1 (smallest) through 100 (best).  The default is 75.
+     *****************************************************************/
+    void setJPEGQuality(int quality)
+    {
+        mJPEGQuality = quality;
+    }
+
+    //! The quality JPEG compressed strips or tiles are written with
+    int getJPEGQuality() const
+    {
+        return mJPEGQuality;
+    }
+
     /**
      *****************************************************************
      * Retrieves the current image format for the image.
@@ -171,10 +280,56 @@ public:
      * For some tags, there are reasonable defaults that this 
      * function will set, others must be set by the user and this 
      * function will throw an exception indicating the missing tag.
+     *
+     * If the Compression tag names a supported scheme (LZW, Deflate
+     * or PackBits), each strip or tile is compressed as it fills, and
+     * the Predictor tag may request horizontal differencing.
      *****************************************************************/
     void validate();
 
 private:
+    /**
+     *****************************************************************
+     * Estimates the number of bytes the file will occupy once this
+     * image and its IFD have been written, and promotes the file to
+     * BigTIFF if that exceeds the classic TIFF limit.  Throws if the
+     * image cannot be addressed and the format can not be changed.
+     *****************************************************************/
+    void checkFileSize();
+
+    /**
+     *****************************************************************
+     * Computes the tile edge length in elements that best matches
+     * the ideal chunk size.
+     *
+     * @return
+     *   the tile width and length in elements
+     *****************************************************************/
+    sys::Uint32_T computeTileSize();
+
+    /**
+     *****************************************************************
+     * Adds an IFD entry for an offset or byte count tag, typed as
+     * LONG for classic TIFF or LONG8 for BigTIFF.  Values are added
+     * with tiff::IFDEntry::addUint64().
+     *
+     * @param tag
+     *   the tag to add (see tiff::Const::Tag)
+     * @return
+     *   the added entry
+     *****************************************************************/
+    tiff::IFDEntry *addOffsetEntry(unsigned short tag);
+
+    /**
+     *****************************************************************
+     * Adds the offset and byte count entries of a compressed image,
+     * holding zeros until the strips or tiles have been written.
+     *
+     * @param numChunks
+     *   the number of strips or tiles in the image
+     *****************************************************************/
+    void reserveOffsetEntries(size_t numChunks);
+
     /**
      *****************************************************************
      * Adds IFD entries to the IFD that indicate that the image 
@@ -213,6 +368,33 @@ private:
     void putTileData(const unsigned char *buffer,
                      sys::Uint32_T numElementsToWrite);
 
+    //! Compresses the buffered chunks on behalf of flushChunkRows().
+    class ChunkEncoder;
+
+    /**
+     *****************************************************************
+     * Writes data to a file in compressed format.  Data is buffered
+     * until a full window of strips or tiles is available, and then
+     * each is compressed and appended to the file.
+     *
+     * @param buffer
+     *   the buffer to write to the file
+     * @param numElementsToWrite
+     *   the number of elements (not bytes) to write to the file
+     *****************************************************************/
+    void putCompressedData(const unsigned char *buffer,
+                           sys::Uint32_T numElementsToWrite);
+
+    /**
+     *****************************************************************
+     * Compresses and writes the buffered rows of strips or tiles.
+     * After the last row, adds the offset and byte count entries.
+     *
+     * @param numRows
+     *   the number of image rows in the buffer
+     *****************************************************************/
+    void flushChunkRows(size_t numRows);
+
     //! The TIFF IFD for this image
     tiff::IFD mIFD;
 
@@ -234,14 +416,17 @@ private:
     //! A pointer to the output stream
     io::FileOutputStream *mOutput;
 
+    //! The header of the file being written, may be NULL
+    tiff::Header *mHeader;
+
     //! The position to write the next IFD to
-    sys::Uint32_T mIFDOffset;
+    sys::Uint64_T mIFDOffset;
 
     //! The ideal size of a tile
     sys::Uint32_T mIdealChunkSize;
 
     //! Used to determine the position in the image
-    sys::Uint32_T mBytePosition;
+    sys::Uint64_T mBytePosition;
 
     //! The image's element size.  Stored here to prevent frequent IFD access
     unsigned short mElementSize;
@@ -249,8 +434,44 @@ private:
     //! Indicates whether or not the IFD has been validated already
     bool mValidated;
 
+    //! Whether the file may be promoted to BigTIFF by this image
+    bool mAutoFormat;
+
     //! The format of the file, either TILED or STRIPPED
     ImageFormat mFormat;
+
+    //! The codec to compress with, or NULL if uncompressed
+    const tiff::Codec *mCodec;
+
+    //! The predictor to apply before compressing
+    unsigned short mPredictor;
+
+    //! The JPEG codec, which depends on the image, if JPEG compressed
+    std::auto_ptr<tiff::JPEGCodec> mJPEGCodec;
+
+    //! The quality to compress JPEG strips or tiles with
+    int mJPEGQuality;
+
+    //! The width of a strip or tile in elements
+    size_t mChunkWidth;
+
+    //! The length of a strip or tile in rows
+    size_t mChunkLength;
+
+    //! The number of threads to compress with
+    size_t mNumThreads;
+
+    //! Buffers rows of strips or tiles until they can be compressed
+    std::vector<unsigned char> mChunkRow;
+
+    //! The compressed chunks of the current window
+    std::vector<std::vector<unsigned char> > mEncoded;
+
+    //! The file offsets of the compressed strips or tiles written so far
+    std::vector<sys::Uint64_T> mChunkOffsets;
+
+    //! The sizes of the compressed strips or tiles written so far
+    std::vector<sys::Uint64_T> mChunkByteCounts;
 };
 
 } // End namespace.
@@ -0,0 +1,110 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#ifndef __TIFF_OVERVIEWS_H__
+#define __TIFF_OVERVIEWS_H__
+
+#include <cstddef>
+
+namespace tiff
+{
+
+/**
+ *********************************************************************
+ * @class OverviewKernel
+ * @brief The filters available for building reduced resolution
+ * overviews.
+ *
+ * NEAREST keeps the upper left sample of each 2 x 2 block, AVERAGE
+ * takes the mean of the block, and GAUSSIAN applies the separable
+ * [1 3 3 1] / 8 filter centered on the block, which aliases less than
+ * AVERAGE at the cost of a little sharpness.
+ *********************************************************************/
+class OverviewKernel
+{
+public:
+    enum Type
+    {
+        NEAREST,
+        AVERAGE,
+        GAUSSIAN
+    };
+};
+
+/**
+ *****************************************************************
+ * Returns the length of an image dimension after decimating it by
+ * two.  Odd lengths are rounded up.
+ *
+ * @param length
+ *   the number of rows or columns in the source image
+ * @return
+ *   the number of rows or columns in the overview
+ *****************************************************************/
+inline size_t getOverviewLength(size_t length)
+{
+    return (length + 1) / 2;
+}
+
+/**
+ *****************************************************************
+ * Decimates a pixel-interleaved image by two in each direction.
+ * Samples beyond the edges of the source image are clamped to the
+ * last row or column.  Integer samples are rounded to the nearest
+ * value.  Output rows are divided among the threads.
+ *
+ * @param input
+ *   the source image, in raster order
+ * @param numRows
+ *   the number of rows in the source image
+ * @param numCols
+ *   the number of columns in the source image
+ * @param numBands
+ *   the number of samples per pixel
+ * @param bitsPerSample
+ *   the size of each sample: 8, 16 or 32 bits for integer samples,
+ *   32 or 64 bits for floating point ones
+ * @param sampleFormat
+ *   the type of each sample, see tiff::Const::SampleFormatType
+ * @param kernel
+ *   the filter to decimate with
+ * @param output
+ *   the overview, getOverviewLength(numRows) by
+ *   getOverviewLength(numCols) pixels
+ * @param numThreads
+ *   the number of threads to use
+ *****************************************************************/
+void createOverview(const unsigned char *input,
+                    size_t numRows,
+                    size_t numCols,
+                    size_t numBands,
+                    unsigned short bitsPerSample,
+                    unsigned short sampleFormat,
+                    OverviewKernel::Type kernel,
+                    unsigned char *output,
+                    size_t numThreads = 1);
+
+} // End namespace.
+
+#endif // __TIFF_OVERVIEWS_H__
@@ -0,0 +1,579 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "tiff/Codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <import/except.h>
+
+#include "tiff/Common.h"
+#include "tiff/tiff_config.h"
+
+#ifdef TIFF_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef TIFF_HAVE_JPEG
+#include <import/jpeg.h>
+#endif
+
+namespace
+{
+const unsigned int LZW_CLEAR = 256;
+const unsigned int LZW_EOI = 257;
+const unsigned int LZW_FIRST = 258;
+const unsigned int LZW_MIN_BITS = 9;
+const unsigned int LZW_MAX_BITS = 12;
+const unsigned int LZW_TABLE_SIZE = 1 << LZW_MAX_BITS;
+
+//! Packs LZW codes most significant bit first.
+class LZWBitWriter
+{
+public:
+    LZWBitWriter(std::vector<unsigned char>& output) :
+        mOutput(output), mBits(0), mNumBits(0)
+    {
+    }
+
+    void put(unsigned int code, unsigned int width)
+    {
+        mBits = (mBits << width) | code;
+        mNumBits += width;
+        while (mNumBits >= 8)
+        {
+            mNumBits -= 8;
+            mOutput.push_back(static_cast<unsigned char>(mBits >> mNumBits));
+        }
+    }
+
+    void flush()
+    {
+        if (mNumBits)
+        {
+            mOutput.push_back(static_cast<unsigned char>(
+                    mBits << (8 - mNumBits)));
+            mNumBits = 0;
+        }
+    }
+
+private:
+    std::vector<unsigned char>& mOutput;
+    sys::Uint32_T mBits;
+    unsigned int mNumBits;
+};
+
+template <typename T>
+void applyPredictor(T *buffer, size_t width, size_t length,
+                    size_t samplesPerPixel)
+{
+    const size_t rowSize = width * samplesPerPixel;
+    for (size_t row = 0; row < length; ++row)
+    {
+        T *rowBuffer = buffer + row * rowSize;
+        for (size_t ii = rowSize - 1; ii >= samplesPerPixel; --ii)
+            rowBuffer[ii] = static_cast<T>(
+                    rowBuffer[ii] - rowBuffer[ii - samplesPerPixel]);
+    }
+}
+
+template <typename T>
+void undoPredictor(T *buffer, size_t width, size_t length,
+                   size_t samplesPerPixel)
+{
+    const size_t rowSize = width * samplesPerPixel;
+    for (size_t row = 0; row < length; ++row)
+    {
+        T *rowBuffer = buffer + row * rowSize;
+        for (size_t ii = samplesPerPixel; ii < rowSize; ++ii)
+            rowBuffer[ii] = static_cast<T>(
+                    rowBuffer[ii] + rowBuffer[ii - samplesPerPixel]);
+    }
+}
+}
+
+void tiff::DeflateCodec::decode(const unsigned char *input, size_t inputSize,
+                                unsigned char *output,
+                                size_t outputSize) const
+{
+#ifdef TIFF_HAVE_ZLIB
+    z_stream stream;
+    ::memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK)
+        throw except::Exception(Ctxt("Unable to initialize zlib inflate"));
+
+    stream.next_in = const_cast<Bytef *>(input);
+    stream.avail_in = static_cast<uInt>(inputSize);
+    stream.next_out = output;
+    stream.avail_out = static_cast<uInt>(outputSize);
+
+    const int status = inflate(&stream, Z_FINISH);
+    const size_t decoded = outputSize - stream.avail_out;
+    inflateEnd(&stream);
+
+    if (status != Z_STREAM_END && status != Z_BUF_ERROR && status != Z_OK)
+        throw except::Exception(Ctxt(FmtX("Deflate data is corrupt: %d",
+                                          status)));
+
+    ::memset(output + decoded, 0, outputSize - decoded);
+#else
+    throw except::Exception(Ctxt(
+            "Deflate compression requires the tiff module to be built "
+            "with zlib"));
+#endif
+}
+
+void tiff::DeflateCodec::encode(const unsigned char *input, size_t inputSize,
+                                size_t /*rowSize*/,
+                                std::vector<unsigned char>& output) const
+{
+#ifdef TIFF_HAVE_ZLIB
+    const size_t start = output.size();
+    uLongf encodedSize = compressBound(static_cast<uLong>(inputSize));
+    output.resize(start + encodedSize);
+
+    const int status = compress2(&output[start], &encodedSize, input,
+                                 static_cast<uLong>(inputSize),
+                                 Z_DEFAULT_COMPRESSION);
+    if (status != Z_OK)
+        throw except::Exception(Ctxt(FmtX("Deflate compression failed: %d",
+                                          status)));
+    output.resize(start + encodedSize);
+#else
+    throw except::Exception(Ctxt(
+            "Deflate compression requires the tiff module to be built "
+            "with zlib"));
+#endif
+}
+
+void tiff::LZWCodec::decode(const unsigned char *input, size_t inputSize,
+                            unsigned char *output, size_t outputSize) const
+{
+    // Each table entry is stored as its prefix code and final byte, so
+    // strings are written out backwards from their last byte.
+    std::vector<unsigned short> prefix(LZW_TABLE_SIZE);
+    std::vector<unsigned char> suffix(LZW_TABLE_SIZE);
+    std::vector<unsigned short> stringLength(LZW_TABLE_SIZE);
+    for (unsigned int ii = 0; ii < 256; ++ii)
+    {
+        suffix[ii] = static_cast<unsigned char>(ii);
+        stringLength[ii] = 1;
+    }
+
+    unsigned int nextCode = LZW_FIRST;
+    unsigned int width = LZW_MIN_BITS;
+    int oldCode = -1;
+
+    size_t outputPos = 0;
+    sys::Uint32_T bits = 0;
+    unsigned int numBits = 0;
+    size_t inputPos = 0;
+
+    while (outputPos < outputSize)
+    {
+        while (numBits < width && inputPos < inputSize)
+        {
+            bits = (bits << 8) | input[inputPos++];
+            numBits += 8;
+        }
+        if (numBits < width)
+            break;
+
+        numBits -= width;
+        const unsigned int code = (bits >> numBits) & ((1u << width) - 1);
+
+        if (code == LZW_EOI)
+            break;
+
+        if (code == LZW_CLEAR)
+        {
+            nextCode = LZW_FIRST;
+            width = LZW_MIN_BITS;
+            oldCode = -1;
+            continue;
+        }
+
+        if (oldCode == -1)
+        {
+            if (code >= 256)
+                throw except::Exception(Ctxt(FmtX(
+                        "Invalid LZW code %d after a clear code", code)));
+            output[outputPos++] = static_cast<unsigned char>(code);
+            oldCode = static_cast<int>(code);
+            continue;
+        }
+
+        if (code > nextCode || nextCode >= LZW_TABLE_SIZE)
+            throw except::Exception(Ctxt(FmtX("Invalid LZW code %d", code)));
+
+        // The code may be the one about to be added, in which case its
+        // string is the previous string plus that string's first byte.
+        const unsigned int known = (code < nextCode) ? code
+                : static_cast<unsigned int>(oldCode);
+        const size_t length = stringLength[known];
+        const size_t total = length + (code == nextCode ? 1 : 0);
+        const size_t available = std::min(total, outputSize - outputPos);
+
+        unsigned char firstByte = 0;
+        unsigned int walk = known;
+        for (size_t ii = length; ii-- > 0;)
+        {
+            if (ii < available)
+                output[outputPos + ii] = suffix[walk];
+            firstByte = suffix[walk];
+            walk = prefix[walk];
+        }
+        if (code == nextCode && length < available)
+            output[outputPos + length] = firstByte;
+        outputPos += available;
+
+        prefix[nextCode] = static_cast<unsigned short>(oldCode);
+        suffix[nextCode] = firstByte;
+        stringLength[nextCode] = static_cast<unsigned short>(
+                stringLength[oldCode] + 1);
+        ++nextCode;
+        oldCode = static_cast<int>(code);
+
+        if (nextCode >= (1u << width) - 1 && width < LZW_MAX_BITS)
+            ++width;
+    }
+
+    ::memset(output + outputPos, 0, outputSize - outputPos);
+}
+
+void tiff::LZWCodec::encode(const unsigned char *input, size_t inputSize,
+                            size_t /*rowSize*/,
+                            std::vector<unsigned char>& output) const
+{
+    // An open addressed hash table from (prefix code, byte) to code.
+    // Table codes start at 258, so a code of 0 marks an empty slot.
+    const unsigned int hashBits = 13;
+    const size_t hashMask = (1 << hashBits) - 1;
+    std::vector<sys::Uint32_T> keys(hashMask + 1);
+    std::vector<unsigned short> codes(hashMask + 1, 0);
+
+    LZWBitWriter writer(output);
+    unsigned int width = LZW_MIN_BITS;
+    unsigned int nextCode = LZW_FIRST;
+    writer.put(LZW_CLEAR, width);
+
+    if (inputSize == 0)
+    {
+        writer.put(LZW_EOI, width);
+        writer.flush();
+        return;
+    }
+
+    unsigned int current = input[0];
+    for (size_t pos = 1; pos < inputSize; ++pos)
+    {
+        const unsigned char byte = input[pos];
+        const sys::Uint32_T key = (static_cast<sys::Uint32_T>(current) << 8)
+                | byte;
+        size_t slot = (key * 2654435761u) >> (32 - hashBits);
+        while (codes[slot] && keys[slot] != key)
+            slot = (slot + 1) & hashMask;
+
+        if (codes[slot])
+        {
+            current = codes[slot];
+            continue;
+        }
+
+        writer.put(current, width);
+        keys[slot] = key;
+        codes[slot] = static_cast<unsigned short>(nextCode++);
+        current = byte;
+
+        // Clear one code before the table is full, and widen codes as
+        // soon as the next code would not fit.
+        if (nextCode == LZW_TABLE_SIZE - 2)
+        {
+            writer.put(LZW_CLEAR, width);
+            std::fill(codes.begin(), codes.end(), 0);
+            nextCode = LZW_FIRST;
+            width = LZW_MIN_BITS;
+        }
+        else if (nextCode > (1u << width) - 1)
+        {
+            ++width;
+        }
+    }
+
+    // The decoder adds a table entry after the last code too, which
+    // can widen the code that the end of information is written with.
+    writer.put(current, width);
+    ++nextCode;
+    if (nextCode == LZW_TABLE_SIZE - 2)
+    {
+        writer.put(LZW_CLEAR, width);
+        width = LZW_MIN_BITS;
+    }
+    else if (nextCode > (1u << width) - 1)
+    {
+        ++width;
+    }
+    writer.put(LZW_EOI, width);
+    writer.flush();
+}
+
+void tiff::PackBitsCodec::decode(const unsigned char *input,
+                                 size_t inputSize,
+                                 unsigned char *output,
+                                 size_t outputSize) const
+{
+    size_t inputPos = 0;
+    size_t outputPos = 0;
+    while (inputPos < inputSize && outputPos < outputSize)
+    {
+        const int header = static_cast<signed char>(input[inputPos++]);
+        if (header >= 0)
+        {
+            // Copy the next header + 1 bytes literally.
+            size_t count = static_cast<size_t>(header) + 1;
+            count = std::min(count, inputSize - inputPos);
+            count = std::min(count, outputSize - outputPos);
+            ::memcpy(output + outputPos, input + inputPos, count);
+            inputPos += static_cast<size_t>(header) + 1;
+            outputPos += count;
+        }
+        else if (header != -128 && inputPos < inputSize)
+        {
+            // Repeat the next byte 1 - header times.
+            size_t count = static_cast<size_t>(1 - header);
+            count = std::min(count, outputSize - outputPos);
+            ::memset(output + outputPos, input[inputPos++], count);
+            outputPos += count;
+        }
+    }
+
+    ::memset(output + outputPos, 0, outputSize - outputPos);
+}
+
+void tiff::PackBitsCodec::encode(const unsigned char *input,
+                                 size_t inputSize,
+                                 size_t rowSize,
+                                 std::vector<unsigned char>& output) const
+{
+    if (rowSize == 0)
+        rowSize = inputSize;
+
+    for (size_t rowStart = 0; rowStart < inputSize; rowStart += rowSize)
+    {
+        const size_t rowEnd = std::min(rowStart + rowSize, inputSize);
+        size_t pos = rowStart;
+        while (pos < rowEnd)
+        {
+            // Measure the run starting here.
+            size_t run = 1;
+            while (pos + run < rowEnd && run < 128 &&
+                   input[pos + run] == input[pos])
+                ++run;
+
+            if (run >= 3)
+            {
+                output.push_back(static_cast<unsigned char>(1 - run));
+                output.push_back(input[pos]);
+                pos += run;
+                continue;
+            }
+
+            // Gather literals until the next run of three or more.
+            size_t literal = 0;
+            while (pos + literal < rowEnd && literal < 128)
+            {
+                if (pos + literal + 2 < rowEnd &&
+                    input[pos + literal] == input[pos + literal + 1] &&
+                    input[pos + literal] == input[pos + literal + 2])
+                    break;
+                ++literal;
+            }
+
+            output.push_back(static_cast<unsigned char>(literal - 1));
+            output.insert(output.end(), input + pos, input + pos + literal);
+            pos += literal;
+        }
+    }
+}
+
+tiff::JPEGCodec::JPEGCodec(unsigned short photometric, size_t numBands,
+                           const std::vector<unsigned char>& tables,
+                           int quality) :
+    mPhotometric(photometric),
+    mNumBands(numBands),
+    mTables(tables),
+    mQuality(quality)
+{
+}
+
+void tiff::JPEGCodec::decode(const unsigned char *input, size_t inputSize,
+                             unsigned char *output, size_t outputSize) const
+{
+#ifdef TIFF_HAVE_JPEG
+    // A decoder per call keeps the codec safe to share between threads.
+    jpeg::Decoder decoder;
+    if (!mTables.empty())
+        decoder.readTables(mem::BufferView<const sys::ubyte>(
+                &mTables[0], mTables.size()));
+
+    if (mPhotometric == tiff::Const::PhotoInterpType::YCBCR)
+    {
+        decoder.setSourceColorSpace(jpeg::ColorSpace::YCBCR);
+        decoder.setColorSpace(jpeg::ColorSpace::RGB);
+    }
+    else
+    {
+        decoder.setSourceColorSpace(jpeg::ColorSpace::UNKNOWN);
+        decoder.setColorSpace(jpeg::ColorSpace::UNKNOWN);
+    }
+
+    size_t decoded = 0;
+    if (inputSize)
+        decoded = decoder.decode(
+                mem::BufferView<const sys::ubyte>(input, inputSize),
+                mem::BufferView<sys::ubyte>(output, outputSize));
+    ::memset(output + decoded, 0, outputSize - decoded);
+#else
+    throw except::Exception(Ctxt(
+            "JPEG compression requires the tiff module to be built "
+            "with the jpeg module"));
+#endif
+}
+
+void tiff::JPEGCodec::encode(const unsigned char *input, size_t inputSize,
+                             size_t rowSize,
+                             std::vector<unsigned char>& output) const
+{
+#ifdef TIFF_HAVE_JPEG
+    jpeg::Encoder encoder;
+    encoder.setQuality(mQuality);
+    if (mPhotometric == tiff::Const::PhotoInterpType::YCBCR)
+        encoder.setColorSpace(jpeg::ColorSpace::YCBCR);
+    else if (mNumBands == 1)
+        encoder.setColorSpace(jpeg::ColorSpace::GRAYSCALE);
+    else
+        encoder.setColorSpace(jpeg::ColorSpace::UNKNOWN);
+
+    encoder.encode(mem::BufferView<const sys::ubyte>(input, inputSize),
+                   inputSize / rowSize, rowSize / mNumBands, mNumBands,
+                   output);
+#else
+    throw except::Exception(Ctxt(
+            "JPEG compression requires the tiff module to be built "
+            "with the jpeg module"));
+#endif
+}
+
+const tiff::Codec *tiff::getCodec(unsigned short compression)
+{
+    static const tiff::DeflateCodec deflate;
+    static const tiff::LZWCodec lzw;
+    static const tiff::PackBitsCodec packBits;
+
+    switch (compression)
+    {
+    case tiff::Const::CompressionType::NO_COMPRESSION:
+        return NULL;
+    case tiff::Const::CompressionType::LZW:
+        return &lzw;
+    case tiff::Const::CompressionType::PACK_BITS:
+        return &packBits;
+    case tiff::Const::CompressionType::DEFLATE:
+    case tiff::Const::CompressionType::DEFLATE_PKZIP:
+#ifdef TIFF_HAVE_ZLIB
+        return &deflate;
+#endif
+    default:
+        throw except::Exception(Ctxt(FmtX("Unsupported compression type: %d",
+                                          compression)));
+    }
+}
+
+void tiff::applyHorizontalPredictor(unsigned char *buffer, size_t width,
+                                    size_t length, size_t samplesPerPixel,
+                                    size_t sampleSize)
+{
+    if (width < 2)
+        return;
+
+    switch (sampleSize)
+    {
+    case 1:
+        applyPredictor(buffer, width, length, samplesPerPixel);
+        break;
+    case 2:
+        applyPredictor(reinterpret_cast<sys::Uint16_T *>(buffer), width,
+                       length, samplesPerPixel);
+        break;
+    case 4:
+        applyPredictor(reinterpret_cast<sys::Uint32_T *>(buffer), width,
+                       length, samplesPerPixel);
+        break;
+    case 8:
+        applyPredictor(reinterpret_cast<sys::Uint64_T *>(buffer), width,
+                       length, samplesPerPixel);
+        break;
+    default:
+    {
+        std::ostringstream message;
+        message << "Unsupported sample size for the predictor: "
+                << sampleSize;
+        throw except::Exception(Ctxt(message.str()));
+    }
+    }
+}
+
+void tiff::undoHorizontalPredictor(unsigned char *buffer, size_t width,
+                                   size_t length, size_t samplesPerPixel,
+                                   size_t sampleSize)
+{
+    if (width < 2)
+        return;
+
+    switch (sampleSize)
+    {
+    case 1:
+        undoPredictor(buffer, width, length, samplesPerPixel);
+        break;
+    case 2:
+        undoPredictor(reinterpret_cast<sys::Uint16_T *>(buffer), width,
+                      length, samplesPerPixel);
+        break;
+    case 4:
+        undoPredictor(reinterpret_cast<sys::Uint32_T *>(buffer), width,
+                      length, samplesPerPixel);
+        break;
+    case 8:
+        undoPredictor(reinterpret_cast<sys::Uint64_T *>(buffer), width,
+                      length, samplesPerPixel);
+        break;
+    default:
+    {
+        std::ostringstream message;
+        message << "Unsupported sample size for the predictor: "
+                << sampleSize;
+        throw except::Exception(Ctxt(message.str()));
+    }
+    }
+}
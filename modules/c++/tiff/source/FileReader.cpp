@@ -21,17 +21,43 @@
  */
 #include "tiff/FileReader.h"
 
+#include <cstring>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <import/io.h>
 #include <import/except.h>
+#include <import/mt.h>
 
 #include "tiff/ImageReader.h"
 #include "tiff/IFD.h"
 
+namespace
+{
+// Identifies an index file, and the version of its layout.  The magic
+// is followed by the TIFF file's size and modification time, the
+// number of images and the offset of each image's IFD, all as native
+// byte order 64-bit values.
+const char INDEX_MAGIC[8] = { 'T', 'I', 'F', 'F', 'I', 'D', 'X', '1' };
+
+template <typename T>
+T readValue(io::InputStream& input, bool reverseBytes)
+{
+    T value;
+    input.read((sys::byte *)&value, sizeof(value));
+    return reverseBytes ? sys::byteSwap(value) : value;
+}
+}
 
 void tiff::FileReader::openFile(const std::string& fileName)
+{
+    openFile(fileName, "");
+}
+
+void tiff::FileReader::openFile(const std::string& fileName,
+                                const std::string& indexFileName)
 {
     if (mInput.isOpen())
         throw except::Exception(Ctxt("Last file not closed; call close() first."));
@@ -45,29 +71,152 @@ void tiff::FileReader::openFile(const std::string& fileName)
     mInput.create(fileName.c_str());
     if (!mInput.isOpen())
         throw except::Exception(Ctxt("File was not opened"));
+    mFileName = fileName;
+
+    // A file that can't be parsed is closed again, so that another can
+    // be opened.
+    try
+    {
+        // Read TIFF header from input
+        mHeader.deserialize(mInput);
+        mReverseBytes = mHeader.isDifferentByteOrdering();
+
+        if (indexFileName.empty())
+        {
+            scanImageOffsets();
+        }
+        else if (!readIndex(indexFileName))
+        {
+            scanImageOffsets();
 
-    // Read TIFF header from input
-    mHeader.deserialize(mInput);
-    
-    mReverseBytes = mHeader.isDifferentByteOrdering();
-    sys::Uint32_T offset = mHeader.getIFDOffset();
+            // The index only saves the scan next time, so the file is
+            // still usable if it can't be written.
+            try
+            {
+                writeIndex(indexFileName);
+            }
+            catch (const except::Throwable&)
+            {
+            }
+        }
+    }
+    catch (...)
+    {
+        close();
+        throw;
+    }
+
+    mImages.assign(mImageOffsets.size(), NULL);
+}
+
+void tiff::FileReader::scanImageOffsets()
+{
+    const bool bigTIFF = mHeader.isBigTIFF();
+    const sys::Uint64_T entrySize = bigTIFF ? 20 : 12;
+    const sys::Uint64_T countSize = bigTIFF ? 8 : 2;
+
+    // Only the entry count and the next offset of each IFD are read;
+    // the entries are skipped over.
+    std::set<sys::Uint64_T> visited;
+    sys::Uint64_T offset = mHeader.getIFDOffset();
     while (offset != 0)
     {
-        tiff::ImageReader *imageReader = new tiff::ImageReader(&mInput);
+        if (!visited.insert(offset).second)
+        {
+            std::ostringstream message;
+            message << "IFD at offset " << offset << " is linked twice";
+            throw except::Exception(Ctxt(message.str()));
+        }
+        mImageOffsets.push_back(offset);
 
         mInput.seek(offset, io::Seekable::START);
-        imageReader->process(mReverseBytes);
-        mImages.push_back(imageReader);
+        const sys::Uint64_T count = bigTIFF ?
+                readValue<sys::Uint64_T>(mInput, mReverseBytes) :
+                readValue<sys::Uint16_T>(mInput, mReverseBytes);
 
-        offset = imageReader->getNextOffset();
+        mInput.seek(offset + countSize + count * entrySize,
+                    io::Seekable::START);
+        offset = bigTIFF ?
+                readValue<sys::Uint64_T>(mInput, mReverseBytes) :
+                readValue<sys::Uint32_T>(mInput, mReverseBytes);
     }
 }
 
+bool tiff::FileReader::readIndex(const std::string& indexFileName)
+{
+    const sys::OS os;
+    if (!os.exists(indexFileName))
+        return false;
+
+    const sys::Uint64_T headerSize = sizeof(INDEX_MAGIC) + 3 * sizeof(sys::Uint64_T);
+    const sys::Uint64_T indexSize = os.getSize(indexFileName);
+    if (indexSize < headerSize)
+        return false;
+
+    io::FileInputStream input(indexFileName);
+    char magic[sizeof(INDEX_MAGIC)];
+    input.read((sys::byte *)magic, sizeof(magic));
+
+    const sys::Uint64_T fileSize = readValue<sys::Uint64_T>(input, false);
+    const sys::Uint64_T modifiedTime = readValue<sys::Uint64_T>(input, false);
+    const sys::Uint64_T count = readValue<sys::Uint64_T>(input, false);
+    if (std::memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0 ||
+        fileSize != static_cast<sys::Uint64_T>(os.getSize(mFileName)) ||
+        modifiedTime != static_cast<sys::Uint64_T>(
+                os.getLastModifiedTime(mFileName)) ||
+        indexSize != headerSize + count * sizeof(sys::Uint64_T))
+    {
+        return false;
+    }
+
+    std::vector<sys::Uint64_T> offsets(count);
+    if (count > 0)
+    {
+        input.read((sys::byte *)&offsets[0], count * sizeof(sys::Uint64_T));
+    }
+    input.close();
+
+    for (size_t ii = 0; ii < offsets.size(); ++ii)
+    {
+        if (offsets[ii] >= fileSize)
+            return false;
+    }
+
+    mImageOffsets.swap(offsets);
+    return true;
+}
+
+void tiff::FileReader::writeIndex(const std::string& indexFileName) const
+{
+    if (!mInput.isOpen())
+        throw except::Exception(Ctxt("No file is open"));
+
+    const sys::OS os;
+    const sys::Uint64_T header[] =
+    {
+        static_cast<sys::Uint64_T>(os.getSize(mFileName)),
+        static_cast<sys::Uint64_T>(os.getLastModifiedTime(mFileName)),
+        mImageOffsets.size()
+    };
+
+    io::FileOutputStream output(indexFileName);
+    output.write((const sys::byte *)INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    output.write((const sys::byte *)header, sizeof(header));
+    if (!mImageOffsets.empty())
+    {
+        output.write((const sys::byte *)&mImageOffsets[0],
+                     mImageOffsets.size() * sizeof(sys::Uint64_T));
+    }
+    output.close();
+}
+
 void tiff::FileReader::close()
 {
     mHeader = tiff::Header{};
 
     mInput.close();
+    mFileName.clear();
+    mImageOffsets.clear();
 
     std::vector<tiff::ImageReader *>::iterator readIter;
     for (readIter = mImages.begin(); readIter != mImages.end(); ++readIter)
@@ -78,8 +227,25 @@ void tiff::FileReader::close()
 
 tiff::ImageReader *tiff::FileReader::operator[](const sys::Uint32_T index) const
 {
-    if (index >= mImages.size())
-    throw except::Exception(Ctxt(FmtX("Index out of range: %d", index)));
+    if (index >= mImageOffsets.size())
+    {
+        std::ostringstream message;
+        message << "Index out of range: " << index;
+        throw except::Exception(Ctxt(message.str()));
+    }
+
+    // The IFD is parsed under the same lock the images use for their
+    // own reads, as both move the position of mInput.
+    mt::CriticalSection<sys::Mutex> lock(&mInputMutex);
+    if (mImages[index] == NULL)
+    {
+        std::auto_ptr<tiff::ImageReader> imageReader(
+                new tiff::ImageReader(&mInput, &mInputMutex));
+
+        mInput.seek(mImageOffsets[index], io::Seekable::START);
+        imageReader->process(mReverseBytes, mHeader.isBigTIFF());
+        mImages[index] = imageReader.release();
+    }
 
     return mImages[index];
 }
@@ -91,13 +257,13 @@ void tiff::FileReader::print(io::OutputStream &output) const
     output.writeln("");
 
     // Print each subfile's information (each subfile has it's own IFD).
-    for (sys::Uint32_T i = 0; i < mImages.size(); ++i)
+    for (sys::Uint32_T i = 0; i < getImageCount(); ++i)
     {
         std::ostringstream message;
         message << "Sub-File:      " << i + 1 << std::endl;
         output.write(message.str());
 
-        mImages[i]->print(output);
+        (*this)[i]->print(output);
         output.writeln("");
     }
 }
@@ -105,10 +271,5 @@ void tiff::FileReader::print(io::OutputStream &output) const
 void tiff::FileReader::getData(unsigned char *buffer,
         const sys::Uint32_T numElementsToRead, const sys::Uint32_T imageIndex)
 {
-    if (imageIndex >= mImages.size())
-        throw except::Exception(Ctxt(FmtX("Index out of range", imageIndex)));
-
-    mImages[imageIndex]->getData(buffer, numElementsToRead);
+    (*this)[imageIndex]->getData(buffer, numElementsToRead);
 }
-
-
@@ -20,10 +20,44 @@
  *
  */
 #include <string>
+#include <vector>
 #include <import/except.h>
+#include "tiff/GenericType.h"
 #include "tiff/ImageWriter.h"
 #include "tiff/FileWriter.h"
 
+namespace
+{
+// The tags that describe the size and placement of an image, which each
+// level of a pyramid fills in for itself.
+const char* const LEVEL_TAGS[] =
+{
+    "ImageWidth", "ImageLength", "NewSubfileType", "StripOffsets",
+    "RowsPerStrip", "StripByteCounts", "TileWidth", "TileLength",
+    "TileOffsets", "TileByteCounts"
+};
+
+bool isLevelTag(unsigned short tag)
+{
+    for (size_t ii = 0; ii < sizeof(LEVEL_TAGS) / sizeof(LEVEL_TAGS[0]); ++ii)
+    {
+        const tiff::IFDEntry* const entry =
+                tiff::KnownTagsRegistry::getInstance()[LEVEL_TAGS[ii]];
+        if (entry && entry->getTagID() == tag)
+            return true;
+    }
+    return false;
+}
+
+unsigned short getFirstValue(tiff::IFD& ifd, const char* name,
+                             unsigned short defaultValue)
+{
+    tiff::IFDEntry* const entry = ifd[name];
+    return (!entry) ? defaultValue
+            : static_cast<unsigned short>(entry->getUint64(0));
+}
+}
+
 tiff::FileWriter::~FileWriter()
 {
     for (size_t ii = 0; ii < mImages.size(); ++ii)
@@ -95,7 +129,8 @@ tiff::ImageWriter *tiff::FileWriter::addImage()
         mIFDOffset = mImages.back()->getNextIFDOffset();
 
     std::auto_ptr<tiff::ImageWriter>
-        image(new tiff::ImageWriter(&mOutput, mIFDOffset));
+        image(new tiff::ImageWriter(&mOutput, mIFDOffset, &mHeader,
+                                    mFileFormat == AUTO));
     mImages.push_back(image.get());
     tiff::ImageWriter* const writer = image.release();
 
@@ -104,9 +139,216 @@ tiff::ImageWriter *tiff::FileWriter::addImage()
 
 void tiff::FileWriter::writeHeader()
 {
+    mHeader.setBigTIFF(mFileFormat == BIGTIFF);
+    mHeader.serialize(mOutput);
+
+    // Reserve room for the larger BigTIFF header, in case the first
+    // image turns out to be too large for classic TIFF.
+    if (mFileFormat == AUTO)
+    {
+        tiff::Header bigHeader;
+        bigHeader.setBigTIFF(true);
+        const std::vector<sys::byte> padding(
+                static_cast<size_t>(bigHeader.size() - mHeader.size()), 0);
+        mOutput.write(&padding[0], padding.size());
+    }
+
+    // Remember where the actual IFD offset needs to be written.
+    mIFDOffset = mHeader.getIFDOffsetPosition();
+}
+
+std::auto_ptr<tiff::ImageWriter>
+tiff::FileWriter::createLevel(tiff::ImageWriter& image,
+                              size_t width,
+                              size_t length,
+                              bool overview)
+{
+    std::auto_ptr<tiff::ImageWriter>
+        level(new tiff::ImageWriter(&mOutput, 0, &mHeader));
+    level->setImageFormat(tiff::ImageWriter::TILED);
+    level->setIdealChunkSize(image.getIdealChunkSize());
+    level->setJPEGQuality(image.getJPEGQuality());
+
+    tiff::IFD& source = *image.getIFD();
+    tiff::IFD& ifd = *level->getIFD();
+    const std::vector<unsigned short> tags = source.getTags();
+    for (size_t ii = 0; ii < tags.size(); ++ii)
+    {
+        if (!isLevelTag(tags[ii]))
+            ifd.copyEntry(*source[tags[ii]]);
+    }
+
+    ifd.addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                 static_cast<sys::Uint32_T>(width));
+    ifd.addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                 static_cast<sys::Uint32_T>(length));
+
+    // Bit 0 of NewSubfileType marks a reduced resolution image.
+    if (overview)
+        ifd.addEntry("NewSubfileType", static_cast<sys::Uint32_T>(1));
+    else if (source["NewSubfileType"])
+        ifd.copyEntry(*source["NewSubfileType"]);
+
+    return level;
+}
+
+void tiff::FileWriter::reserveFileSize(sys::Uint64_T numBytes)
+{
+    const sys::Off_T current = mOutput.tell();
+    if (mHeader.isBigTIFF() ||
+        current + numBytes <= tiff::Header::CLASSIC_MAX_OFFSET)
+        return;
+
+    // Only the first image can change the format, since an earlier IFD
+    // would already have been written with 4-byte offsets.
+    if (mFileFormat != AUTO || mImages.size() != 1)
+    {
+        throw except::Exception(Ctxt(
+                "Image exceeds the 4 GB classic TIFF limit; write it as "
+                "BigTIFF instead"));
+    }
+
+    mHeader.setBigTIFF(true);
+    mOutput.seek(0, io::Seekable::START);
     mHeader.serialize(mOutput);
+    mOutput.seek(current, io::Seekable::START);
+
+    mIFDOffset = mHeader.getIFDOffsetPosition();
+    mImages.back()->setIFDOffset(mIFDOffset);
+}
 
-    // Have to rewind a few bytes to write out the actual IFD offset.
-    mIFDOffset = mOutput.tell();
-    mIFDOffset -= (int)sizeof(sys::Uint32_T);
+void tiff::FileWriter::writePyramid(const unsigned char *buffer,
+                                    size_t numOverviews,
+                                    OverviewKernel::Type kernel,
+                                    size_t numThreads)
+{
+    if (mImages.empty())
+        throw except::Exception(Ctxt("No image to write a pyramid for"));
+
+    tiff::ImageWriter& image = *mImages.back();
+    if (mLayout == CLOUD_OPTIMIZED)
+        image.setImageFormat(tiff::ImageWriter::TILED);
+
+    tiff::IFD& ifd = *image.getIFD();
+    std::vector<size_t> widths(1, ifd.getImageWidth());
+    std::vector<size_t> lengths(1, ifd.getImageLength());
+    if (widths[0] == 0 || lengths[0] == 0)
+        throw except::Exception(Ctxt(
+                "ImageWidth and ImageLength must be defined"));
+
+    // Each overview is made from the level above it.
+    const size_t numBands = ifd.getNumBands();
+    const size_t elementSize = ifd.getElementSize();
+    const unsigned short bitsPerSample =
+            getFirstValue(ifd, tiff::KnownTags::BITS_PER_SAMPLE, 8);
+    const unsigned short sampleFormat =
+            getFirstValue(ifd, tiff::KnownTags::SAMPLE_FORMAT,
+                          tiff::Const::SampleFormatType::UNSIGNED_INT);
+
+    std::vector<std::vector<unsigned char> > overviews(numOverviews);
+    std::vector<const unsigned char *> levels(1, buffer);
+    for (size_t ii = 0; ii < numOverviews; ++ii)
+    {
+        widths.push_back(tiff::getOverviewLength(widths.back()));
+        lengths.push_back(tiff::getOverviewLength(lengths.back()));
+        overviews[ii].resize(widths.back() * lengths.back() * elementSize);
+        tiff::createOverview(levels.back(), lengths[ii], widths[ii],
+                             numBands, bitsPerSample, sampleFormat, kernel,
+                             &overviews[ii][0], numThreads);
+        levels.push_back(&overviews[ii][0]);
+    }
+
+    // Settle the format before any offsets are written.
+    sys::Uint64_T estimatedSize = image.estimateSize();
+    for (size_t ii = 1; ii < levels.size(); ++ii)
+    {
+        estimatedSize += createLevel(image, widths[ii], lengths[ii],
+                                     true)->estimateSize();
+    }
+    reserveFileSize(estimatedSize);
+
+    if (mLayout == SEQUENTIAL)
+    {
+        image.setNumThreads(numThreads);
+        image.putData(buffer, static_cast<sys::Uint32_T>(
+                widths[0] * lengths[0]));
+        image.writeIFD();
+
+        for (size_t ii = 1; ii < levels.size(); ++ii)
+        {
+            std::auto_ptr<tiff::ImageWriter> level =
+                    createLevel(image, widths[ii], lengths[ii], true);
+            level->setIFDOffset(mImages.back()->getNextIFDOffset());
+            level->setNumThreads(numThreads);
+            level->putData(levels[ii], static_cast<sys::Uint32_T>(
+                    widths[ii] * lengths[ii]));
+            level->writeIFD();
+            mImages.push_back(level.release());
+        }
+        return;
+    }
+
+    // The IFDs go ahead of the data, so room is left for them first.
+    // Their sizes depend only on which entries they hold and how many
+    // values each has, so they can be found before the data is written.
+    // The image can't be validated this early, since its tile offsets
+    // would be taken from here, so a copy stands in for it.  The copy
+    // only matches if the image has no layout tags of its own.
+    const std::vector<unsigned short> tags = ifd.getTags();
+    for (size_t ii = 0; ii < tags.size(); ++ii)
+    {
+        if (isLevelTag(tags[ii]) &&
+            tags[ii] != tiff::Const::Tag::IMAGE_WIDTH &&
+            tags[ii] != tiff::Const::Tag::IMAGE_LENGTH &&
+            tags[ii] != tiff::Const::Tag::NEW_SUBFILE_TYPE)
+        {
+            throw except::Exception(Ctxt(
+                    "A cloud optimized image must not define its own "
+                    "strip or tile layout"));
+        }
+    }
+
+    sys::Uint64_T ifdSize = 0;
+    for (size_t ii = 0; ii < levels.size(); ++ii)
+    {
+        ifdSize += createLevel(image, widths[ii], lengths[ii],
+                               ii > 0)->getIFDSize();
+    }
+    const sys::Off_T ifdStart = mOutput.tell();
+    const std::vector<sys::byte> padding(static_cast<size_t>(ifdSize), 0);
+    mOutput.write(&padding[0], padding.size());
+
+    // The image writes the full resolution level itself, so the pointer
+    // addImage() returned stays valid.  The overviews follow it.
+    const size_t firstLevel = mImages.size() - 1;
+    image.setNumThreads(numThreads);
+    for (size_t ii = 1; ii < levels.size(); ++ii)
+    {
+        std::auto_ptr<tiff::ImageWriter> level =
+                createLevel(image, widths[ii], lengths[ii], true);
+        level->setNumThreads(numThreads);
+        mImages.push_back(level.release());
+    }
+
+    // Write the smallest overview first, so a reader streaming the file
+    // gets a complete coarse picture as early as possible.
+    for (size_t ii = levels.size(); ii-- > 0; )
+    {
+        mImages[firstLevel + ii]->putData(levels[ii],
+                static_cast<sys::Uint32_T>(widths[ii] * lengths[ii]));
+    }
+    const sys::Off_T dataEnd = mOutput.tell();
+
+    // Chain the IFDs in order of decreasing resolution.
+    mOutput.seek(ifdStart, io::Seekable::START);
+    for (size_t ii = 0; ii < levels.size(); ++ii)
+    {
+        if (ii > 0)
+        {
+            mImages[firstLevel + ii]->setIFDOffset(
+                    mImages[firstLevel + ii - 1]->getNextIFDOffset());
+        }
+        mImages[firstLevel + ii]->writeIFD();
+    }
+    mOutput.seek(dataEnd, io::Seekable::START);
 }
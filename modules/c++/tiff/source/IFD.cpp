@@ -27,6 +27,7 @@
 #include "tiff/IFDEntry.h"
 #include "tiff/KnownTags.h"
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <import/io.h>
@@ -39,19 +40,49 @@ tiff::IFDEntry *tiff::IFD::operator[](const char *name)
     return (*this)[mapEntry->getTagID()];
 }
 
+namespace
+{
+bool tagLess(const tiff::IFDEntry *entry, unsigned short tag)
+{
+    return entry->getTagID() < tag;
+}
+}
+
+tiff::IFD::IFDType::iterator tiff::IFD::lowerBound(unsigned short tag)
+{
+    return std::lower_bound(mIFD.begin(), mIFD.end(), tag, tagLess);
+}
+
+tiff::IFD::IFDType::const_iterator
+tiff::IFD::lowerBound(unsigned short tag) const
+{
+    return std::lower_bound(mIFD.begin(), mIFD.end(), tag, tagLess);
+}
+
+void tiff::IFD::insert(std::auto_ptr<tiff::IFDEntry> entry)
+{
+    IFDType::iterator pos = lowerBound(entry->getTagID());
+    if (pos != mIFD.end() && (*pos)->getTagID() == entry->getTagID())
+    {
+        delete *pos;
+        *pos = entry.release();
+    }
+    else
+    {
+        mIFD.insert(pos, entry.get());
+        entry.release();
+    }
+}
+
 tiff::IFDEntry *tiff::IFD::operator[](unsigned short tag)
 {
-    // Ensures that the key exists.  Without this check, the defined
-    // behavior for the [] operator is to create an entry if it does
-    // not exist.  This is to make sure that the map doesn't get full
-    // of invalid key/value pairs if you're just trying to verify whether
-    // a key already exists of not.
-    return exists(tag) ? mIFD[tag] : NULL;
+    IFDType::iterator pos = lowerBound(tag);
+    return (pos != mIFD.end() && (*pos)->getTagID() == tag) ? *pos : NULL;
 }
 
 bool tiff::IFD::exists(unsigned short tag)
 {
-    return mIFD.find(tag) != mIFD.end();
+    return (*this)[tag] != NULL;
 }
 
 bool tiff::IFD::exists(const char *name)
@@ -64,9 +95,41 @@ bool tiff::IFD::exists(const char *name)
 
 void tiff::IFD::addEntry(const tiff::IFDEntry *entry)
 {
-    unsigned short id = entry->getTagID();
-    mIFD[id] = new tiff::IFDEntry;
-    *(mIFD[id]) = *entry;
+    insert(std::auto_ptr<tiff::IFDEntry>(new tiff::IFDEntry(*entry)));
+}
+
+tiff::IFDEntry *tiff::IFD::addEntry(unsigned short tag)
+{
+    tiff::IFDEntry *mapEntry = tiff::KnownTagsRegistry::getInstance()[tag];
+    if (!mapEntry)
+        throw except::Exception(Ctxt(FmtX(
+                "Unable to add IFD Entry: unknown tag [%d]", tag)));
+
+    tiff::IFDEntry *entry = new tiff::IFDEntry(*mapEntry);
+    insert(std::auto_ptr<tiff::IFDEntry>(entry));
+    return entry;
+}
+
+void tiff::IFD::copyEntry(const tiff::IFDEntry& entry)
+{
+    std::auto_ptr<tiff::IFDEntry> copy(new tiff::IFDEntry(
+            entry.getTagID(), entry.getType(), entry.getName()));
+
+    const std::vector<unsigned char>& data = entry.getData();
+    const size_t elementSize = tiff::Const::sizeOf(entry.getType());
+    if (elementSize && !data.empty())
+        copy->appendValues(&data[0], data.size() / elementSize);
+
+    insert(copy);
+}
+
+std::vector<unsigned short> tiff::IFD::getTags() const
+{
+    std::vector<unsigned short> tags;
+    tags.reserve(mIFD.size());
+    for (IFDType::const_iterator i = mIFD.begin(); i != mIFD.end(); ++i)
+        tags.push_back((*i)->getTagID());
+    return tags;
 }
 
 void tiff::IFD::addEntry(const std::string& name)
@@ -77,33 +140,67 @@ void tiff::IFD::addEntry(const std::string& name)
         throw except::Exception(Ctxt(FmtX(
                                 "Unable to add IFD Entry: unknown tag [%s]", name.c_str())));
 
-    unsigned short id = mapEntry->getTagID();
-
-    mIFD[id] = new tiff::IFDEntry;
-    *(mIFD[id]) = *mapEntry;
+    insert(std::auto_ptr<tiff::IFDEntry>(new tiff::IFDEntry(*mapEntry)));
 }
 
 void tiff::IFD::deserialize(io::InputStream& input)
 {
-    deserialize(input, false);
+    deserialize(input, false, false, 0);
 }
 
 void tiff::IFD::deserialize(io::InputStream& input, const bool reverseBytes)
 {
-    unsigned short ifdEntryCount;
-    input.read((sys::byte *)&ifdEntryCount, sizeof(ifdEntryCount));
-    if (reverseBytes)
-        ifdEntryCount = sys::byteSwap(ifdEntryCount);
+    deserialize(input, reverseBytes, false, 0);
+}
+
+void tiff::IFD::deserialize(io::InputStream& input, const bool reverseBytes,
+                            const bool bigTIFF)
+{
+    deserialize(input, reverseBytes, bigTIFF, 0);
+}
+
+void tiff::IFD::deserialize(io::InputStream& input, const bool reverseBytes,
+                            const bool bigTIFF,
+                            const sys::Uint64_T deferSize)
+{
+    sys::Uint64_T ifdEntryCount;
+    if (bigTIFF)
+    {
+        input.read((sys::byte *)&ifdEntryCount, sizeof(ifdEntryCount));
+        if (reverseBytes)
+            ifdEntryCount = sys::byteSwap(ifdEntryCount);
+    }
+    else
+    {
+        unsigned short count;
+        input.read((sys::byte *)&count, sizeof(count));
+        if (reverseBytes)
+            count = sys::byteSwap(count);
+        ifdEntryCount = count;
+    }
 
-    for (unsigned short i = 0; i < ifdEntryCount; i++)
+    // Writers are required to sort the entries, so this only appends.
+    mIFD.reserve(mIFD.size() + static_cast<size_t>(ifdEntryCount));
+    for (sys::Uint64_T i = 0; i < ifdEntryCount; i++)
     {
-        tiff::IFDEntry *entry = new tiff::IFDEntry();
-        entry->deserialize(input, reverseBytes);
-        mIFD[entry->getTagID()] = entry;
+        std::auto_ptr<tiff::IFDEntry> entry(new tiff::IFDEntry());
+        entry->deserialize(input, reverseBytes, bigTIFF, deferSize);
+        if (mIFD.empty() || mIFD.back()->getTagID() < entry->getTagID())
+        {
+            mIFD.push_back(entry.get());
+            entry.release();
+        }
+        else
+            insert(entry);
     }
 }
 
 void tiff::IFD::serialize(io::OutputStream& output)
+{
+    serialize(output, false);
+}
+
+void tiff::IFD::serialize(io::OutputStream& output, const bool bigTIFF)
 {
     io::Seekable *seekable =
             dynamic_cast<io::Seekable *>(&output);
@@ -113,17 +210,24 @@ void tiff::IFD::serialize(io::OutputStream& output)
     // Makes sure all data offsets are defined for each entry.
     // Keep the offset just past the end of the IFD.  This offset
     // is where the next potential image could be written.
-    sys::Uint32_T endOffset = finalize(seekable->tell());
+    sys::Uint64_T endOffset = finalize(seekable->tell(), bigTIFF);
 
     // Write out IFD entry count.
-    unsigned short ifdEntryCount = mIFD.size();
-    output.write((sys::byte *)&ifdEntryCount, sizeof(ifdEntryCount));
+    if (bigTIFF)
+    {
+        const sys::Uint64_T ifdEntryCount = mIFD.size();
+        output.write((sys::byte *)&ifdEntryCount, sizeof(ifdEntryCount));
+    }
+    else
+    {
+        const unsigned short ifdEntryCount = mIFD.size();
+        output.write((sys::byte *)&ifdEntryCount, sizeof(ifdEntryCount));
+    }
 
     // Write out each IFD entry.
     for (IFDType::const_iterator i = mIFD.begin(); i != mIFD.end(); ++i)
     {
-        tiff::IFDEntry *entry = i->second;
-        entry->serialize(output);
+        (*i)->serialize(output, bigTIFF);
     }
 
     // Remember the current position in case there is another IFD after
@@ -131,13 +235,20 @@ void tiff::IFD::serialize(io::OutputStream& output)
     mNextIFDOffsetPosition = seekable->tell();
 
     // Write out the default next IFD location.
-    sys::Uint32_T nextOffset = 0;
-    output.write((sys::byte *)&nextOffset, sizeof(sys::Uint32_T));
+    const sys::Uint64_T nextOffset = 0;
+    output.write((sys::byte *)&nextOffset,
+                 tiff::IFDEntry::valueFieldSize(bigTIFF));
 
     // Seek the end of the IFD, the next image can begin here.
     seekable->seek(endOffset, io::Seekable::START);
 }
 
+void tiff::IFD::loadValues()
+{
+    for (IFDType::iterator i = mIFD.begin(); i != mIFD.end(); ++i)
+        (*i)->getData();
+}
+
 void tiff::IFD::print(io::OutputStream& output) const
 {
     sys::Uint32_T x = 1;
@@ -148,39 +259,33 @@ void tiff::IFD::print(io::OutputStream& output) const
         message << "Entry Number:        " << x << std::endl;
         output.write(message.str());
 
-        i->second->print(output);
+        (*i)->print(output);
         output.writeln("");
     }
 }
 
 sys::Uint32_T tiff::IFD::getImageWidth()
 {
-    tiff::IFDEntry *imageWidth = (*this)[tiff::KnownTags::IMAGE_WIDTH];
+    tiff::IFDEntry *imageWidth = (*this)[tiff::Const::Tag::IMAGE_WIDTH];
     if (!imageWidth)
         return 0;
 
-    if (imageWidth->getType() == tiff::Const::Type::LONG)
-        return *(tiff::GenericType<sys::Uint32_T> *)(*imageWidth)[0];
-
-    return *(tiff::GenericType<unsigned short> *)(*imageWidth)[0];
+    return static_cast<sys::Uint32_T>(imageWidth->getUint64(0));
 }
 
 sys::Uint32_T tiff::IFD::getImageLength()
 {
-    tiff::IFDEntry *imageLength = (*this)[tiff::KnownTags::IMAGE_LENGTH];
+    tiff::IFDEntry *imageLength = (*this)[tiff::Const::Tag::IMAGE_LENGTH];
     if (!imageLength)
         return 0;
 
-    if (imageLength->getType() == tiff::Const::Type::LONG)
-        return *(tiff::GenericType<sys::Uint32_T> *)(*imageLength)[0];
-
-    return *(tiff::GenericType<unsigned short> *)(*imageLength)[0];
+    return static_cast<sys::Uint32_T>(imageLength->getUint64(0));
 }
 
-sys::Uint32_T tiff::IFD::getImageSize()
+sys::Uint64_T tiff::IFD::getImageSize()
 {
-    sys::Uint32_T width = getImageWidth();
-    sys::Uint32_T length = getImageLength();
+    const sys::Uint64_T width = getImageWidth();
+    const sys::Uint64_T length = getImageLength();
     unsigned short elementSize = getElementSize();
 
     return width * length * elementSize;
@@ -190,11 +295,12 @@ unsigned short tiff::IFD::getNumBands()
 {
     unsigned short numBands = 1;
     
-    tiff::IFDEntry *samplesPerPixel = (*this)[tiff::KnownTags::SAMPLES_PER_PIXEL];
-    tiff::IFDEntry *bitsPerSample = (*this)[tiff::KnownTags::BITS_PER_SAMPLE];
+    tiff::IFDEntry *samplesPerPixel =
+            (*this)[tiff::Const::Tag::SAMPLES_PER_PIXEL];
+    tiff::IFDEntry *bitsPerSample = (*this)[tiff::Const::Tag::BITS_PER_SAMPLE];
     
     if (samplesPerPixel)
-        numBands = *(::tiff::GenericType<unsigned short> *)(*samplesPerPixel)[0];
+        numBands = static_cast<unsigned short>(samplesPerPixel->getUint64(0));
     else if (bitsPerSample)
         numBands = bitsPerSample->getCount();
     
@@ -203,28 +309,32 @@ unsigned short tiff::IFD::getNumBands()
 
 unsigned short tiff::IFD::getElementSize()
 {
-    tiff::IFDEntry *bitsPerSample = (*this)[tiff::KnownTags::BITS_PER_SAMPLE];
+    tiff::IFDEntry *bitsPerSample = (*this)[tiff::Const::Tag::BITS_PER_SAMPLE];
     unsigned short bytesPerSample = (!bitsPerSample) ? 1
-            : *(tiff::GenericType<unsigned short> *)(*bitsPerSample)[0] >> 3;
+            : static_cast<unsigned short>(bitsPerSample->getUint64(0) >> 3);
 
     return bytesPerSample * getNumBands();
 }
 
-sys::Uint32_T tiff::IFD::finalize(const sys::Uint32_T offset)
+sys::Uint64_T tiff::IFD::finalize(const sys::Uint64_T offset,
+                                  const bool bigTIFF)
 {
     // Find the beginning offset to extra IFD data.  The IFD length is
     // the size of an IFD entry multiplied by the number of entries, plus
-    // 4 bytes to hold the offset to the next IFD, and 2 bytes to hold the
-    // IFD entry count.
-    sys::Uint32_T dataOffset = offset + sizeof(short) + (mIFD.size()
-            * tiff::IFDEntry::sizeOf()) + sizeof(sys::Uint32_T);
+    // the offset to the next IFD and the IFD entry count.  These are 4
+    // and 2 bytes respectively, or 8 bytes each for BigTIFF.
+    const sys::Uint64_T countSize = bigTIFF ? sizeof(sys::Uint64_T)
+                                            : sizeof(unsigned short);
+    sys::Uint64_T dataOffset = offset + countSize + (mIFD.size()
+            * tiff::IFDEntry::sizeOf(bigTIFF))
+            + tiff::IFDEntry::valueFieldSize(bigTIFF);
 
     for (IFDType::iterator i = mIFD.begin(); i != mIFD.end(); ++i)
     {
         // Send in the current offset.  If the value size of the IFD entry
         // requires that data be placed outside the IFD entry, the offset that
         // is returned will be adjusted to compensate for that data.
-        dataOffset = i->second->finalize(dataOffset);
+        dataOffset = (*i)->finalize(dataOffset, bigTIFF);
     }
 
     return dataOffset;
@@ -33,119 +33,186 @@
 #include "tiff/IFDEntry.h"
 
 
+tiff::IFDEntry::IFDEntry(const tiff::IFDEntry& other) :
+    mTag(other.mTag), mType(other.mType), mCount(other.mCount),
+    mOffset(other.mOffset), mName(other.mName), mData(other.mData),
+    mSource(other.mSource), mReverseBytes(other.mReverseBytes)
+{
+}
+
+tiff::IFDEntry& tiff::IFDEntry::operator=(const tiff::IFDEntry& other)
+{
+    if (this != &other)
+    {
+        clearViews();
+        mTag = other.mTag;
+        mType = other.mType;
+        mCount = other.mCount;
+        mOffset = other.mOffset;
+        mName = other.mName;
+        mData = other.mData;
+        mSource = other.mSource;
+        mReverseBytes = other.mReverseBytes;
+    }
+    return *this;
+}
+
 void tiff::IFDEntry::serialize(io::OutputStream& output)
+{
+    serialize(output, false);
+}
+
+void tiff::IFDEntry::serialize(io::OutputStream& output, const bool bigTIFF)
 {
     io::Seekable *seekable =
             dynamic_cast<io::Seekable *>(&output);
     if (seekable == NULL)
         throw except::Exception(Ctxt("Can only serialize IFDEntry to seekable stream"));
 
+    load();
+
     output.write((sys::byte *)&mTag, sizeof(mTag));
     output.write((sys::byte *)&mType, sizeof(mType));
-    output.write((sys::byte *)&mCount, sizeof(mCount));
+    if (bigTIFF)
+    {
+        output.write((sys::byte *)&mCount, sizeof(mCount));
+    }
+    else
+    {
+        const sys::Uint32_T count = static_cast<sys::Uint32_T>(mCount);
+        output.write((sys::byte *)&count, sizeof(count));
+    }
 
-    sys::Uint32_T size = mCount * tiff::Const::sizeOf(mType);
+    const unsigned short fieldSize = valueFieldSize(bigTIFF);
 
-    if (size > 4)
+    if (mData.size() > fieldSize)
     {
         // Keep the current position and jump to the write position.
-        sys::Uint32_T current = seekable->tell();
+        const sys::Off_T current = seekable->tell();
         seekable->seek(mOffset, io::Seekable::START);
 
         // Write the values out at the current cursor position
-        for (sys::Uint32_T i = 0; i < mValues.size(); ++i)
-            output.write((sys::byte *)mValues[i]->data(),
-                    mValues[i]->size());
+        output.write((sys::byte *)&mData[0], mData.size());
 
         // Reset the cursor
         seekable->seek(current, io::Seekable::START);
 
         // Write out the data offset.
-        output.write((sys::byte *)&mOffset, sizeof(mOffset));
+        if (bigTIFF)
+        {
+            output.write((sys::byte *)&mOffset, sizeof(mOffset));
+        }
+        else
+        {
+            const sys::Uint32_T offset = static_cast<sys::Uint32_T>(mOffset);
+            output.write((sys::byte *)&offset, sizeof(offset));
+        }
     }
     else
     {
-        for (sys::Uint32_T i = 0; i < mCount; ++i)
-        {
-            // The value must take up four bytes.  If the number of bytes is
-            // less than four, duplicate the value until you hit 4 bytes in length.
-            unsigned short iterations = (4 / mCount) / mValues[i]->size();
-
-            for (int j = 0; j < iterations; ++j)
-                output.write((sys::byte *)mValues[i]->data(),
-                        mValues[i]->size());
-        }
+        // The values are left-justified within the value field, and
+        // the remainder of the field is zero-padded.
+        sys::byte field[8] = { 0 };
+        if (!mData.empty())
+            memcpy(field, &mData[0], mData.size());
+        output.write(field, fieldSize);
     }
 }
 
 void tiff::IFDEntry::deserialize(io::InputStream& input)
 {
-    deserialize(input, false);
+    deserialize(input, false, false, 0);
 }
 
 void tiff::IFDEntry::deserialize(io::InputStream& input, const bool reverseBytes)
+{
+    deserialize(input, reverseBytes, false, 0);
+}
+
+void tiff::IFDEntry::deserialize(io::InputStream& input,
+                                 const bool reverseBytes,
+                                 const bool bigTIFF)
+{
+    deserialize(input, reverseBytes, bigTIFF, 0);
+}
+
+void tiff::IFDEntry::deserialize(io::InputStream& input,
+                                 const bool reverseBytes,
+                                 const bool bigTIFF,
+                                 const sys::Uint64_T deferSize)
 {
     io::Seekable *seekable =
             dynamic_cast<io::Seekable*>(&input);
     if (seekable == NULL)
         throw except::Exception(Ctxt("Can only deserialize IFDEntry from seekable stream"));
 
+    const unsigned short fieldSize = valueFieldSize(bigTIFF);
+    sys::byte field[8] = { 0 };
+
+    clearViews();
+    mData.clear();
+    mSource = NULL;
+    mReverseBytes = reverseBytes;
+
     input.read((char *)&mTag, sizeof(mTag));
     input.read((char *)&mType, sizeof(mType));
-    input.read((char *)&mCount, sizeof(mCount));
-    input.read((char *)&mOffset, sizeof(mOffset));
+    if (bigTIFF)
+    {
+        input.read((char *)&mCount, sizeof(mCount));
+    }
+    else
+    {
+        sys::Uint32_T count;
+        input.read((char *)&count, sizeof(count));
+        if (reverseBytes)
+            count = sys::byteSwap(count);
+        mCount = count;
+    }
+    input.read(field, fieldSize);
 
     if (reverseBytes)
     {
         mTag = sys::byteSwap(mTag);
         mType =  sys::byteSwap(mType);
-        mCount = sys::byteSwap(mCount);
-        mOffset = sys::byteSwap(mOffset);
+        if (bigTIFF)
+            mCount = sys::byteSwap(mCount);
     }
 
-    sys::Uint32_T size = mCount * tiff::Const::sizeOf(mType);
+    const unsigned short elementSize = tiff::Const::sizeOf(mType);
+    if (elementSize == 0)
+        throw except::Exception(Ctxt(FmtX("Unsupported TIFF type %d for tag %d",
+                                          mType, mTag)));
 
-    if (size > 4)
-    {
-        // Keep the current position and jump to the read position.
-        sys::Uint32_T current = seekable->tell();
-        seekable->seek(mOffset, io::Seekable::START);
-
-        // Read in the value(s);
-        sys::byte *buffer = new sys::byte[size];
+    const sys::Uint64_T size = mCount * elementSize;
 
-        input.read(buffer, size);
-        if (reverseBytes)
+    if (size > fieldSize)
+    {
+        if (bigTIFF)
         {
-            sys::Uint32_T elementSize = tiff::Const::sizeOf(mType);
-            sys::Uint32_T numElements = mCount;
-            if (mType == tiff::Const::Type::RATIONAL && mType
-                    == tiff::Const::Type::SRATIONAL)
-            {
-                elementSize = tiff::Const::sizeOf(mType) / 2;
-                numElements = mCount * 2;
-            }
-            if (elementSize > 1)
-                sys::byteSwap(buffer, elementSize, numElements);
+            memcpy(&mOffset, field, sizeof(mOffset));
+            if (reverseBytes)
+                mOffset = sys::byteSwap(mOffset);
+        }
+        else
+        {
+            sys::Uint32_T offset;
+            memcpy(&offset, field, sizeof(offset));
+            if (reverseBytes)
+                offset = sys::byteSwap(offset);
+            mOffset = offset;
         }
 
-        parseValues((const unsigned char *)buffer);
-        delete[] buffer;
-
-        // Reset the cursor position.
-        seekable->seek(current, io::Seekable::START);
+        // Large arrays may be left in the file until they are needed.
+        mSource = &input;
+        if (deferSize == 0 || size <= deferSize)
+            readDeferred();
     }
     else
     {
+        mOffset = 0;
+        mData.assign(field, field + static_cast<size_t>(size));
         if (reverseBytes)
-        {
-            // Re-reverse because a value may be less than 4 bytes.
-            mOffset = sys::byteSwap(mOffset);
-            unsigned short elementSize = tiff::Const::sizeOf(mType);
-            sys::byteSwap((sys::byte*)&mOffset, elementSize, sizeof(mOffset)
-              / elementSize);
-        }
-        parseValues((unsigned char *)&mOffset);
+            swapValues(&mData[0], mType, static_cast<size_t>(mCount));
     }
 
     //try to retrieve the name as well
@@ -153,6 +220,131 @@ void tiff::IFDEntry::deserialize(io::InputStream& input, const bool reverseBytes
     mName = mapEntry ? mapEntry->getName() : "";
 }
 
+void tiff::IFDEntry::readDeferred() const
+{
+    io::Seekable *seekable = dynamic_cast<io::Seekable*>(mSource);
+
+    // Keep the current position and jump to the read position.
+    const sys::Off_T current = seekable->tell();
+    seekable->seek(mOffset, io::Seekable::START);
+
+    // Read in the value(s);
+    mData.resize(static_cast<size_t>(mCount * tiff::Const::sizeOf(mType)));
+    mSource->read((sys::byte *)&mData[0], mData.size());
+    if (mReverseBytes)
+        swapValues(&mData[0], mType, static_cast<size_t>(mCount));
+
+    // Reset the cursor position.
+    seekable->seek(current, io::Seekable::START);
+    mSource = NULL;
+}
+
+void tiff::IFDEntry::swapValues(unsigned char *buffer,
+                                const unsigned short type,
+                                const size_t count)
+{
+    // Rationals are pairs of 4-byte values, and must be swapped as such.
+    size_t swapSize = tiff::Const::sizeOf(type);
+    size_t numSwaps = count;
+    if (type == tiff::Const::Type::RATIONAL ||
+        type == tiff::Const::Type::SRATIONAL)
+    {
+        swapSize /= 2;
+        numSwaps *= 2;
+    }
+
+    if (swapSize > 1 && numSwaps)
+        sys::byteSwap((sys::byte *)buffer, static_cast<unsigned short>(
+                swapSize), numSwaps);
+}
+
+sys::Uint64_T tiff::IFDEntry::getUint64(const size_t index) const
+{
+    load();
+    if (index >= mCount)
+    {
+        std::ostringstream message;
+        message << "Index " << index << " is past the " << mCount
+                << " values of tag " << mTag;
+        throw except::Exception(Ctxt(message.str()));
+    }
+    const unsigned char* const data =
+            &mData[index * tiff::Const::sizeOf(mType)];
+    switch (mType)
+    {
+    case tiff::Const::Type::BYTE:
+    case tiff::Const::Type::UNDEFINED:
+        return *data;
+    case tiff::Const::Type::SHORT:
+    {
+        unsigned short value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    case tiff::Const::Type::LONG:
+    case tiff::Const::Type::IFD:
+    {
+        sys::Uint32_T value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    case tiff::Const::Type::LONG8:
+    case tiff::Const::Type::IFD8:
+    {
+        sys::Uint64_T value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    default:
+        throw except::Exception(Ctxt(FmtX(
+                "Tag %d is not an unsigned integral type", mTag)));
+    }
+}
+
+void tiff::IFDEntry::getUint64Values(std::vector<sys::Uint64_T>& values) const
+{
+    load();
+    const size_t elementSize = tiff::Const::sizeOf(mType);
+    const size_t numValues = elementSize ? mData.size() / elementSize : 0;
+    values.resize(numValues);
+    for (size_t ii = 0; ii < numValues; ++ii)
+        values[ii] = getUint64(ii);
+}
+
+void tiff::IFDEntry::addUint64(const sys::Uint64_T value)
+{
+    switch (mType)
+    {
+    case tiff::Const::Type::BYTE:
+    case tiff::Const::Type::UNDEFINED:
+    {
+        const unsigned char narrowed = static_cast<unsigned char>(value);
+        appendValues(&narrowed, 1);
+        break;
+    }
+    case tiff::Const::Type::SHORT:
+    {
+        const unsigned short narrowed = static_cast<unsigned short>(value);
+        appendValues((const unsigned char *)&narrowed, 1);
+        break;
+    }
+    case tiff::Const::Type::LONG:
+    case tiff::Const::Type::IFD:
+    {
+        const sys::Uint32_T narrowed = static_cast<sys::Uint32_T>(value);
+        appendValues((const unsigned char *)&narrowed, 1);
+        break;
+    }
+    case tiff::Const::Type::LONG8:
+    case tiff::Const::Type::IFD8:
+        appendValues((const unsigned char *)&value, 1);
+        break;
+    default:
+        throw except::Exception(Ctxt(FmtX(
+                "Tag %d is not an unsigned integral type", mTag)));
+    }
+}
+
 void tiff::IFDEntry::print(io::OutputStream& output) const
 {
     std::ostringstream message;
@@ -162,13 +354,14 @@ void tiff::IFDEntry::print(io::OutputStream& output) const
     message << "Number of Elements:  " << mCount << std::endl;
 
     // Print the offset if one exists
-    if (mCount * tiff::Const::sizeOf(mType) > 4)
+    if (mOffset)
         message << "Offset:              " << mOffset << std::endl;
 
     message << "Value(s):            ";
-    for (sys::Uint32_T i = 0; i < mCount; ++i)
+    const std::vector<tiff::TypeInterface *>& values = getViews();
+    for (size_t i = 0; i < values.size(); ++i)
     {
-        message << mValues[i]->toString();
+        message << values[i]->toString();
         if (mType != tiff::Const::Type::ASCII)
             message << " ";
     }
@@ -178,7 +371,7 @@ void tiff::IFDEntry::print(io::OutputStream& output) const
 }
 
 void tiff::IFDEntry::parseValues(const unsigned char *buffer,
-        const sys::Uint32_T count)
+        const sys::Uint64_T count)
 {
     mCount = count;
     parseValues(buffer);
@@ -193,6 +386,29 @@ void tiff::IFDEntry::addValue(double value)
                                        tiff::Const::Type::DOUBLE));
 }
 
+void tiff::IFDEntry::addValue(std::auto_ptr<tiff::TypeInterface> value)
+{
+    load();
+    const size_t elementSize = tiff::Const::sizeOf(mType);
+    const bool viewed = !elementSize
+            || mValues.size() == mData.size() / elementSize;
+    mData.insert(mData.end(), value->data(), value->data() + value->size());
+    ++mCount;
+
+    // Keep the value itself as the view, if the others exist.
+    if (viewed)
+        mValues.push_back(value.release());
+}
+
+void tiff::IFDEntry::appendValues(const unsigned char *buffer,
+                                  const size_t count)
+{
+    load();
+    mData.insert(mData.end(), buffer,
+                 buffer + count * tiff::Const::sizeOf(mType));
+    mCount += count;
+}
+
 void tiff::IFDEntry::addValues(const char* str, int tiffType)
 {
     const unsigned char* const strPtr =
@@ -208,27 +424,47 @@ void tiff::IFDEntry::addValues(const char* str, int tiffType)
 
 void tiff::IFDEntry::parseValues(const unsigned char *buffer)
 {
-    unsigned char *marker = (unsigned char *)buffer;
-    for (sys::Uint32_T i = 0; i < mCount; i++)
+    load();
+    mData.insert(mData.end(), buffer, buffer
+            + static_cast<size_t>(mCount) * tiff::Const::sizeOf(mType));
+}
+
+const std::vector<tiff::TypeInterface *>& tiff::IFDEntry::getViews() const
+{
+    load();
+    const size_t elementSize = tiff::Const::sizeOf(mType);
+    const size_t numValues = elementSize ? mData.size() / elementSize : 0;
+    if (mValues.size() < numValues)
     {
-        tiff::TypeInterface *nextValue = tiff::TypeFactory::create(marker,
-                mType);
-        mValues.push_back(nextValue);
-        unsigned short size = nextValue->size();
-        marker = marker + size;
+        mValues.reserve(numValues);
+        for (size_t ii = mValues.size(); ii < numValues; ++ii)
+            mValues.push_back(tiff::TypeFactory::create(
+                    &mData[ii * elementSize], mType));
     }
+    return mValues;
+}
+
+void tiff::IFDEntry::clearViews()
+{
+    for (size_t i = 0; i < mValues.size(); ++i)
+        delete mValues[i];
+    mValues.clear();
 }
 
-sys::Uint32_T tiff::IFDEntry::finalize(const sys::Uint32_T offset)
+sys::Uint64_T tiff::IFDEntry::finalize(const sys::Uint64_T offset,
+                                       const bool bigTIFF)
 {
-    mCount = mValues.size();
+    load();
+    const size_t elementSize = tiff::Const::sizeOf(mType);
+    mCount = elementSize ? mData.size() / elementSize : 0;
 
-    sys::Uint32_T size = mCount * tiff::Const::sizeOf(mType);
-    if (size > 4)
+    const sys::Uint64_T size = mData.size();
+    if (size > valueFieldSize(bigTIFF))
     {
         mOffset = offset;
         return offset + size;
     }
 
+    mOffset = 0;
     return offset;
 }
@@ -22,32 +22,452 @@
 
 #include "tiff/ImageReader.h"
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <import/io.h>
 #include <import/except.h>
+#include <import/mt.h>
+#include <mt/BalancedRunnable1D.h>
+#include "tiff/Codec.h"
 #include "tiff/Common.h"
 #include "tiff/GenericType.h"
 #include "tiff/IFDEntry.h"
 
-void tiff::ImageReader::process(const bool reverseBytes)
+namespace
+{
+// Arrays larger than this, which are mostly strip and tile offsets,
+// are left in the file until they are used.
+const sys::Uint64_T DEFER_SIZE = 4096;
+}
+
+void tiff::ImageReader::process(const bool reverseBytes, const bool bigTIFF)
 {
     mReverseBytes = reverseBytes;
+    mBigTIFF = bigTIFF;
 
-    mIFD.deserialize(*mInput, mReverseBytes);
+    mIFD.deserialize(*mInput, mReverseBytes, mBigTIFF, DEFER_SIZE);
 
-    mInput->read((sys::byte *)&mNextOffset, sizeof(mNextOffset));
-    if (mReverseBytes)
-        mNextOffset = sys::byteSwap(mNextOffset);
+    if (mBigTIFF)
+    {
+        mInput->read((sys::byte *)&mNextOffset, sizeof(mNextOffset));
+        if (mReverseBytes)
+            mNextOffset = sys::byteSwap(mNextOffset);
+    }
+    else
+    {
+        sys::Uint32_T nextOffset;
+        mInput->read((sys::byte *)&nextOffset, sizeof(nextOffset));
+        if (mReverseBytes)
+            nextOffset = sys::byteSwap(nextOffset);
+        mNextOffset = nextOffset;
+    }
 
     // Done here to lower the number of calls to it later.
     mElementSize = mIFD.getElementSize();
+    mSampleSize = mElementSize / mIFD.getNumBands();
+
+    tiff::IFDEntry *compression = mIFD[tiff::Const::Tag::COMPRESSION];
+    mCompression = compression ? static_cast<unsigned short>(
+            compression->getUint64(0))
+            : static_cast<unsigned short>(
+                    tiff::Const::CompressionType::NO_COMPRESSION);
+
+    tiff::IFDEntry *predictor = mIFD[tiff::Const::Tag::PREDICTOR];
+    mPredictor = predictor ? static_cast<unsigned short>(
+            predictor->getUint64(0))
+            : static_cast<unsigned short>(tiff::Const::PredictorType::NONE);
+
+    // Unlike the other codecs, JPEG depends on the image, so it is set
+    // up once here rather than shared.
+    mJPEGCodec.reset();
+    if (mCompression == tiff::Const::CompressionType::JPEG)
+    {
+        std::vector<unsigned char> tables;
+        tiff::IFDEntry *jpegTables = mIFD[tiff::Const::Tag::JPEG_TABLES];
+        if (jpegTables)
+            tables = jpegTables->getData();
+
+        tiff::IFDEntry *photometric =
+                mIFD[tiff::Const::Tag::PHOTOMETRIC_INTERPRETATION];
+        mJPEGCodec.reset(new tiff::JPEGCodec(
+                photometric ? static_cast<unsigned short>(
+                        photometric->getUint64(0))
+                        : static_cast<unsigned short>(
+                                tiff::Const::PhotoInterpType::BLACK_IS_ZERO),
+                mIFD.getNumBands(), tables));
+    }
+
+    mCachedChunk = static_cast<size_t>(-1);
+    mChunkBuffer.clear();
+
+    cacheLayout();
+}
+
+void tiff::ImageReader::cacheLayout()
+{
+    mChunkOffsets.clear();
+    mChunkByteCounts.clear();
+    mLayoutLoaded = false;
+
+    tiff::IFDEntry *offsets = NULL;
+    tiff::IFDEntry *byteCounts = NULL;
+
+    const size_t imageWidth = mIFD.getImageWidth();
+    const size_t imageLength = mIFD.getImageLength();
+
+    if (mIFD[tiff::Const::Tag::TILE_OFFSETS])
+    {
+        tiff::IFDEntry *tileWidth = mIFD[tiff::Const::Tag::TILE_WIDTH];
+        tiff::IFDEntry *tileLength = mIFD[tiff::Const::Tag::TILE_LENGTH];
+        byteCounts = mIFD[tiff::Const::Tag::TILE_BYTE_COUNTS];
+        if (!tileWidth || !tileLength || !byteCounts)
+            throw except::Exception(Ctxt("Incomplete TIFF tile layout"));
+
+        mTiled = true;
+        offsets = mIFD[tiff::Const::Tag::TILE_OFFSETS];
+        mChunkWidth = static_cast<size_t>(tileWidth->getUint64(0));
+        mChunkLength = static_cast<size_t>(tileLength->getUint64(0));
+        if (mChunkWidth == 0 || mChunkLength == 0)
+            throw except::Exception(Ctxt("Invalid TIFF tile dimensions"));
+        mChunksAcross = (imageWidth + mChunkWidth - 1) / mChunkWidth;
+    }
+    else if (mIFD[tiff::Const::Tag::STRIP_OFFSETS])
+    {
+        byteCounts = mIFD[tiff::Const::Tag::STRIP_BYTE_COUNTS];
+        if (!byteCounts)
+            throw except::Exception(Ctxt("Missing TIFF strip byte counts"));
+
+        // A missing RowsPerStrip means the whole image is one strip.
+        mTiled = false;
+        offsets = mIFD[tiff::Const::Tag::STRIP_OFFSETS];
+        tiff::IFDEntry *rowsPerStrip = mIFD[tiff::Const::Tag::ROWS_PER_STRIP];
+        mChunkWidth = imageWidth;
+        mChunkLength = rowsPerStrip ? static_cast<size_t>(std::min<
+                sys::Uint64_T>(rowsPerStrip->getUint64(0), imageLength))
+                : imageLength;
+        if (mChunkLength == 0)
+            mChunkLength = imageLength;
+        mChunksAcross = 1;
+    }
+    else
+    {
+        // The IFD may not describe an image at all.
+        mTiled = false;
+        mChunkWidth = mChunkLength = mChunksAcross = mChunksDown = 0;
+        return;
+    }
+
+    mChunksDown = mChunkLength ? (imageLength + mChunkLength - 1)
+            / mChunkLength : 0;
+
+    const size_t numChunks = offsets->getCount();
+    if (byteCounts->getCount() != numChunks)
+    {
+        std::ostringstream message;
+        message << "Mismatched TIFF offset (" << numChunks
+                << ") and byte count (" << byteCounts->getCount()
+                << ") arrays";
+        throw except::Exception(Ctxt(message.str()));
+    }
+}
+
+void tiff::ImageReader::loadLayout()
+{
+    if (mLayoutLoaded)
+        return;
+
+    tiff::IFDEntry *offsets = mIFD[mTiled ? tiff::Const::Tag::TILE_OFFSETS
+                                          : tiff::Const::Tag::STRIP_OFFSETS];
+    tiff::IFDEntry *byteCounts = mIFD[mTiled
+            ? tiff::Const::Tag::TILE_BYTE_COUNTS
+            : tiff::Const::Tag::STRIP_BYTE_COUNTS];
+    if (offsets && byteCounts)
+    {
+        offsets->getUint64Values(mChunkOffsets);
+        byteCounts->getUint64Values(mChunkByteCounts);
+    }
+    mLayoutLoaded = true;
+}
 
-    mStripByteCounts = mIFD["StripByteCounts"];
-    mStripOffsets = mIFD["StripOffsets"];
+void tiff::ImageReader::getChunkLocation(size_t index,
+                                         sys::Uint64_T& offset,
+                                         sys::Uint64_T& byteCount)
+{
+    mt::CriticalSection<sys::Mutex> lock(mInputMutex);
+    loadLayout();
+    if (index >= mChunkOffsets.size())
+        throw except::Exception(Ctxt("Invalid tile offset index"));
+
+    offset = mChunkOffsets[index];
+    byteCount = mChunkByteCounts[index];
+}
+
+tiff::IFD* tiff::ImageReader::getIFD()
+{
+    mt::CriticalSection<sys::Mutex> lock(mInputMutex);
+    mIFD.loadValues();
+    return &mIFD;
+}
+
+void tiff::ImageReader::readAt(sys::Uint64_T offset,
+                               unsigned char *buffer,
+                               size_t numBytes)
+{
+    mt::CriticalSection<sys::Mutex> lock(mInputMutex);
+    mInput->seek(offset, io::Seekable::START);
+    mInput->read((sys::byte *)buffer, numBytes);
+}
+
+size_t tiff::ImageReader::getRowsInTile(size_t tileRow)
+{
+    if (mTiled)
+        return mChunkLength;
+
+    const size_t imageLength = mIFD.getImageLength();
+    return std::min(mChunkLength, imageLength - tileRow * mChunkLength);
+}
+
+const tiff::Codec *tiff::ImageReader::getCodec() const
+{
+    if (mJPEGCodec.get())
+        return mJPEGCodec.get();
+    return tiff::getCodec(mCompression);
+}
+
+void tiff::ImageReader::readChunk(size_t tileRow,
+                                  size_t tileCol,
+                                  unsigned char *buffer)
+{
+    const tiff::Codec *codec = getCodec();
+    if (mPredictor != tiff::Const::PredictorType::NONE &&
+        mPredictor != tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING)
+        throw except::Exception(Ctxt(FmtX("Unsupported predictor: %d",
+                                          mPredictor)));
+
+    const size_t index = tileRow * mChunksAcross + tileCol;
+    sys::Uint64_T offset;
+    sys::Uint64_T byteCount;
+    getChunkLocation(index, offset, byteCount);
+
+    const size_t rows = getRowsInTile(tileRow);
+    const size_t numBytes = mChunkWidth * rows * mElementSize;
+    if (!codec)
+    {
+        if (byteCount < numBytes)
+        {
+            std::ostringstream message;
+            message << "Tile " << index << " holds " << byteCount
+                    << " bytes, expected " << numBytes;
+            throw except::Exception(Ctxt(message.str()));
+        }
+        readAt(offset, buffer, numBytes);
+    }
+    else
+    {
+        std::vector<unsigned char> encoded(static_cast<size_t>(byteCount));
+        if (!encoded.empty())
+            readAt(offset, &encoded[0], encoded.size());
+        codec->decode(encoded.empty() ? NULL : &encoded[0], encoded.size(),
+                      buffer, numBytes);
+    }
+
+    if (mReverseBytes)
+        sys::byteSwap((sys::byte*)buffer, mSampleSize,
+                      numBytes / mSampleSize);
+
+    // The differences are taken between native sample values, so this
+    // must follow the byte swap.
+    if (mPredictor == tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING)
+        tiff::undoHorizontalPredictor(buffer, mChunkWidth, rows,
+                                      mElementSize / mSampleSize,
+                                      mSampleSize);
+}
+
+void tiff::ImageReader::readTile(size_t tileRow,
+                                 size_t tileCol,
+                                 unsigned char *buffer)
+{
+    if (tileRow >= mChunksDown || tileCol >= mChunksAcross)
+    {
+        std::ostringstream message;
+        message << "Tile (" << tileRow << ", " << tileCol
+                << ") is outside of the " << mChunksDown << " x "
+                << mChunksAcross << " tile grid";
+        throw except::Exception(Ctxt(message.str()));
+    }
+
+    readChunk(tileRow, tileCol, buffer);
+}
+
+void tiff::ImageReader::getCompressedData(unsigned char *buffer,
+                                          sys::Uint32_T numElementsToRead)
+{
+    const size_t imageWidth = mIFD.getImageWidth();
+    const size_t imageLength = mIFD.getImageLength();
+    const size_t tileRowBytes = mChunkWidth * mElementSize;
+    mChunkBuffer.resize(tileRowBytes * mChunkLength);
+
+    size_t bufferOffset = 0;
+    while (numElementsToRead)
+    {
+        const size_t position = static_cast<size_t>(
+                mBytePosition / mElementSize);
+        const size_t row = position / imageWidth;
+        const size_t col = position % imageWidth;
+        if (row >= imageLength)
+            throw except::Exception(Ctxt("Read past the end of the image"));
+
+        const size_t tileRow = row / mChunkLength;
+        const size_t tileCol = col / mChunkWidth;
+        const size_t index = tileRow * mChunksAcross + tileCol;
+        if (index != mCachedChunk)
+        {
+            readChunk(tileRow, tileCol, &mChunkBuffer[0]);
+            mCachedChunk = index;
+        }
+
+        // Copy to the end of this row of the tile, or of the image.
+        const size_t colInTile = col - tileCol * mChunkWidth;
+        const size_t available = std::min(mChunkWidth - colInTile,
+                                          imageWidth - col);
+        const size_t numElements = std::min<size_t>(available,
+                                                    numElementsToRead);
+        const size_t numBytes = numElements * mElementSize;
+        ::memcpy(buffer + bufferOffset,
+                 &mChunkBuffer[0] + (row - tileRow * mChunkLength)
+                         * tileRowBytes + colInTile * mElementSize,
+                 numBytes);
+
+        bufferOffset += numBytes;
+        mBytePosition += numBytes;
+        numElementsToRead -= static_cast<sys::Uint32_T>(numElements);
+    }
+}
+
+/**
+ * Reads the tiles of a region, numbered in raster order from the
+ * region's first tile.  Each thread gets its own copy, and so its own
+ * scratch tile.
+ */
+class tiff::ImageReader::RegionTileReader
+{
+public:
+    RegionTileReader(tiff::ImageReader& reader,
+                     const types::RowCol<size_t>& firstTile,
+                     size_t tilesAcross,
+                     const types::RowCol<size_t>& offset,
+                     const types::RowCol<size_t>& dims,
+                     unsigned char *buffer) :
+        mReader(reader),
+        mFirstTile(firstTile),
+        mTilesAcross(tilesAcross),
+        mOffset(offset),
+        mDims(dims),
+        mBuffer(buffer)
+    {
+    }
+
+    void operator()(size_t index) const
+    {
+        mScratch.resize(mReader.mChunkWidth * mReader.mChunkLength
+                * mReader.mElementSize);
+        mReader.copyTileToRegion(mFirstTile.row + index / mTilesAcross,
+                                 mFirstTile.col + index % mTilesAcross,
+                                 mOffset, mDims, mBuffer, &mScratch[0]);
+    }
+
+private:
+    tiff::ImageReader& mReader;
+    const types::RowCol<size_t> mFirstTile;
+    const size_t mTilesAcross;
+    const types::RowCol<size_t> mOffset;
+    const types::RowCol<size_t> mDims;
+    unsigned char * const mBuffer;
+    mutable std::vector<unsigned char> mScratch;
+};
+
+void tiff::ImageReader::copyTileToRegion(size_t tileRow,
+                                         size_t tileCol,
+                                         const types::RowCol<size_t>& offset,
+                                         const types::RowCol<size_t>& dims,
+                                         unsigned char *buffer,
+                                         unsigned char *scratch)
+{
+    const size_t tileTop = tileRow * mChunkLength;
+    const size_t rowStart = std::max(offset.row, tileTop);
+    const size_t rowEnd = std::min(offset.row + dims.row,
+                                   tileTop + mChunkLength);
+
+    const size_t tileLeft = tileCol * mChunkWidth;
+    const size_t colStart = std::max(offset.col, tileLeft);
+    const size_t colEnd = std::min(offset.col + dims.col,
+                                   tileLeft + mChunkWidth);
+
+    readChunk(tileRow, tileCol, scratch);
+
+    const size_t tileRowBytes = mChunkWidth * mElementSize;
+    const size_t regionRowBytes = dims.col * mElementSize;
+    const size_t copyBytes = (colEnd - colStart) * mElementSize;
+    for (size_t row = rowStart; row < rowEnd; ++row)
+    {
+        ::memcpy(buffer + (row - offset.row) * regionRowBytes
+                        + (colStart - offset.col) * mElementSize,
+                 scratch + (row - tileTop) * tileRowBytes
+                        + (colStart - tileLeft) * mElementSize,
+                 copyBytes);
+    }
+}
+
+void tiff::ImageReader::readRegion(const types::RowCol<size_t>& offset,
+                                   const types::RowCol<size_t>& dims,
+                                   unsigned char *buffer,
+                                   size_t numThreads)
+{
+    if (dims.area() == 0)
+        return;
+
+    const size_t imageWidth = mIFD.getImageWidth();
+    const size_t imageLength = mIFD.getImageLength();
+    if (offset.row + dims.row > imageLength ||
+        offset.col + dims.col > imageWidth)
+    {
+        std::ostringstream message;
+        message << "Region [" << offset.row << ":" << offset.row + dims.row
+                << ", " << offset.col << ":" << offset.col + dims.col
+                << "] exceeds the " << imageLength << " x " << imageWidth
+                << " image";
+        throw except::Exception(Ctxt(message.str()));
+    }
+
+    const types::RowCol<size_t> firstTile(offset.row / mChunkLength,
+                                          offset.col / mChunkWidth);
+    const types::RowCol<size_t> lastTile(
+            (offset.row + dims.row - 1) / mChunkLength,
+            (offset.col + dims.col - 1) / mChunkWidth);
+    const size_t tilesAcross = lastTile.col - firstTile.col + 1;
+    const size_t numTiles = (lastTile.row - firstTile.row + 1) * tilesAcross;
+
+    // Every tile fills a disjoint part of the buffer, so the tiles can
+    // be decoded in any order.  Only the file reads are serialized.
+    const RegionTileReader op(*this, firstTile, tilesAcross, offset, dims,
+                              buffer);
+    if (numThreads <= 1 || numTiles == 1)
+    {
+        for (size_t ii = 0; ii < numTiles; ++ii)
+            op(ii);
+    }
+    else
+    {
+        mt::runBalanced1DWithCopies(numTiles,
+                                    std::min(numThreads, numTiles), op);
+    }
 }
 
 void tiff::ImageReader::print(io::OutputStream &output) const
 {
+    // Printing reads any values that are still in the file.
+    mt::CriticalSection<sys::Mutex> lock(mInputMutex);
     mIFD.print(output);
     output.writeln("");
 
@@ -59,18 +479,24 @@ void tiff::ImageReader::print(io::OutputStream &output) const
 void tiff::ImageReader::getData(unsigned char *buffer,
         const sys::Uint32_T numElementsToRead)
 {
-    //see if it is uncompressed
-    tiff::IFDEntry *compression = mIFD["Compression"];
-    if (compression)
     {
-        unsigned short c = *(tiff::GenericType<unsigned short> *)(*compression)[0];
-        if (c != tiff::Const::CompressionType::NO_COMPRESSION)
-            throw except::Exception(Ctxt(FmtX("Unsupported compression type: %d", c)));
+        mt::CriticalSection<sys::Mutex> lock(mInputMutex);
+        loadLayout();
     }
-    
-    if (mIFD["StripOffsets"])
+
+    // Compressed data can only be read a whole strip or tile at a time.
+    if (getCodec() ||
+        mPredictor != tiff::Const::PredictorType::NONE)
+    {
+        if (mChunkOffsets.empty())
+            throw except::Exception(Ctxt("Unsupported TIFF file format"));
+        getCompressedData(buffer, numElementsToRead);
+        return;
+    }
+
+    if (mIFD[tiff::Const::Tag::STRIP_OFFSETS])
         getStripData(buffer, numElementsToRead);
-    else if (mIFD["TileOffsets"])
+    else if (mIFD[tiff::Const::Tag::TILE_OFFSETS])
         getTileData(buffer, numElementsToRead);
     else
         throw except::Exception(Ctxt("Unsupported TIFF file format"));
@@ -82,32 +508,33 @@ void tiff::ImageReader::getData(unsigned char *buffer,
 void tiff::ImageReader::getStripData(unsigned char *buffer,
         sys::Uint32_T numElementsToRead)
 {
-    sys::Uint32_T bufferOffset = 0;
+    sys::Uint64_T bufferOffset = 0;
     
     //figure out how far we are in the current strip
-    sys::Uint32_T stripOffset = 0;
+    sys::Uint64_T stripOffset = 0;
     for (size_t i = 0; i < mStripIndex; ++i)
-        stripOffset += *(tiff::GenericType<sys::Uint32_T> *)(*mStripByteCounts)[i];
-    sys::Uint32_T stripPosition = mBytePosition - stripOffset;
+        stripOffset += mChunkByteCounts[i];
+    sys::Uint64_T stripPosition = mBytePosition - stripOffset;
     
     //how many bytes do we need to read?
-    sys::Uint32_T numBytesToRead = numElementsToRead * mElementSize;
+    sys::Uint64_T numBytesToRead =
+            static_cast<sys::Uint64_T>(numElementsToRead) * mElementSize;
 
     while (numBytesToRead)
     {
-        if (mStripIndex >= mStripOffsets->getCount())
+        if (mStripIndex >= mChunkOffsets.size())
             throw except::Exception(Ctxt("Invalid strip offset index"));
 
-        sys::Uint32_T stripSize = *(tiff::GenericType<sys::Uint32_T> *)(*mStripByteCounts)[mStripIndex];
+        const sys::Uint64_T stripSize = mChunkByteCounts[mStripIndex];
 
         // Calculate what remains to be read in the current strip.
-        sys::Uint32_T remainingBytesInStrip = stripSize - stripPosition;
+        sys::Uint64_T remainingBytesInStrip = stripSize - stripPosition;
 
         // Seek to the strip offset plus the last read position.
-        sys::Uint32_T seekPos = (*(tiff::GenericType<sys::Uint32_T> *)(*mStripOffsets)[mStripIndex]) + stripPosition;
+        sys::Uint64_T seekPos = mChunkOffsets[mStripIndex] + stripPosition;
 
         
-        sys::Uint32_T thisRead = numBytesToRead;
+        sys::Uint64_T thisRead = numBytesToRead;
         
         // If the total number of bytes to read exceeds the bytes remaining
         // in the current strip, just read what can be read from the current strip.
@@ -118,8 +545,7 @@ void tiff::ImageReader::getStripData(unsigned char *buffer,
         }
         
         // Go to the offset, and read.
-        mInput->seek(seekPos, io::Seekable::START);
-        mInput->read((sys::byte *)buffer + bufferOffset, thisRead);
+        readAt(seekPos, buffer + bufferOffset, static_cast<size_t>(thisRead));
 
         // Update the tile position in bytes.
         mBytePosition += thisRead;
@@ -140,26 +566,16 @@ void tiff::ImageReader::getTileData(unsigned char*buffer,
     sys::Uint32_T imageElemWidth = mIFD.getImageWidth();
     sys::Uint32_T imageByteWidth = imageElemWidth * mElementSize;
 
-    // Get the tile width.
-    tiff::IFDEntry *tileWidth = mIFD["TileWidth"];
-    sys::Uint32_T tileElemWidth = 0;
-    if (tileWidth->getType() == tiff::Const::Type::LONG)
-        tileElemWidth = *(tiff::GenericType<sys::Uint32_T> *)(*tileWidth)[0];
-    else
-        tileElemWidth = *(tiff::GenericType<unsigned short> *)(*tileWidth)[0];
+    // Get the tile width and length.
+    const sys::Uint32_T tileElemWidth =
+            static_cast<sys::Uint32_T>(mChunkWidth);
     sys::Uint32_T tileByteWidth = tileElemWidth * mElementSize;
+    const sys::Uint32_T tileElemLength =
+            static_cast<sys::Uint32_T>(mChunkLength);
 
-    // Get the tile length.
-    tiff::IFDEntry *tileLength = mIFD["TileLength"];
-    sys::Uint32_T tileElemLength = 0;
-    if (tileLength->getType() == tiff::Const::Type::LONG)
-        tileElemLength = *(tiff::GenericType<sys::Uint32_T> *)(*tileLength)[0];
-    else
-        tileElemLength = *(tiff::GenericType<unsigned short> *)(*tileLength)[0];
-
-    // Compute the number of tiles wide the image is.
-    sys::Uint32_T tilesAcross = (imageElemWidth + tileElemWidth - 1)
-            / tileElemWidth;
+    // Get the number of tiles wide the image is.
+    const sys::Uint32_T tilesAcross =
+            static_cast<sys::Uint32_T>(mChunksAcross);
 
     // Determine how many bytes were used to pad the right edge.
     sys::Uint32_T widthPadding = (tileByteWidth * tilesAcross) - imageByteWidth;
@@ -170,12 +586,13 @@ void tiff::ImageReader::getTileData(unsigned char*buffer,
         sys::Uint32_T bytesToRead = mElementSize * numElementsToRead;
 
         // Compute the row in image, row in tile, and tile row.
-        sys::Uint32_T row = mBytePosition / imageByteWidth;
+        sys::Uint32_T row = static_cast<sys::Uint32_T>(mBytePosition / imageByteWidth);
         sys::Uint32_T tileRow = row / tileElemLength;
         sys::Uint32_T rowInTile = row % tileElemLength;
 
         // Compute the column in image, column in tile, and tile column.
-        sys::Uint32_T column = mBytePosition - (row * imageByteWidth);
+        sys::Uint32_T column = static_cast<sys::Uint32_T>(
+                mBytePosition - (static_cast<sys::Uint64_T>(row) * imageByteWidth));
         sys::Uint32_T tileColumn = column / tileByteWidth;
         sys::Uint32_T colInTile = column % tileByteWidth;
 
@@ -194,16 +611,16 @@ void tiff::ImageReader::getTileData(unsigned char*buffer,
         if (bytesToRead> remainingBytesThisLine)
             bytesToRead = remainingBytesThisLine;
 
+        if (tileIndex >= mChunkOffsets.size())
+            throw except::Exception(Ctxt("Invalid tile offset index"));
+
         // Seek to the tile offset plus the last read position.
-        tiff::IFDEntry *tileOffsets = mIFD["TileOffsets"];
-        sys::Uint32_T seekPos = (*(tiff::GenericType<sys::Uint32_T> *)(*tileOffsets)[tileIndex]) + (rowInTile * tileByteWidth)
+        sys::Uint64_T seekPos = mChunkOffsets[tileIndex]
+                + (static_cast<sys::Uint64_T>(rowInTile) * tileByteWidth)
                 + colInTile;
 
-        // Go to the offset.
-        mInput->seek(seekPos, io::Seekable::START);
-
-        // Read the data.
-        mInput->read((sys::byte *)buffer + bufferOffset, bytesToRead);
+        // Go to the offset and read the data.
+        readAt(seekPos, buffer + bufferOffset, bytesToRead);
 
         // Update the strip position in bytes.
         mBytePosition += bytesToRead;
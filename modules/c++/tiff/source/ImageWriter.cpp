@@ -22,13 +22,17 @@
 
 #include "tiff/ImageWriter.h"
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <cmath>
 #include <import/except.h>
+#include <mt/BalancedRunnable1D.h>
 
 #include "tiff/Common.h"
 #include "tiff/GenericType.h"
 #include "tiff/IFDEntry.h"
+#include "tiff/KnownTags.h"
 
 const unsigned short tiff::ImageWriter::CHUNK_SIZE = 8192;
 
@@ -37,7 +41,11 @@ void tiff::ImageWriter::putData(const unsigned char *buffer,
 {
     validate();
 
-    if (mFormat == TILED)
+    if (mCodec)
+    {
+        putCompressedData(buffer, numElementsToWrite);
+    }
+    else if (mFormat == TILED)
     {
         putTileData(buffer, numElementsToWrite);
     }
@@ -49,18 +57,28 @@ void tiff::ImageWriter::putData(const unsigned char *buffer,
 
 void tiff::ImageWriter::writeIFD()
 {
+    const bool bigTIFF = isBigTIFF();
+
     // Retain the current file offset.
-    sys::Uint32_T offset = mOutput->tell();
+    const sys::Uint64_T offset = mOutput->tell();
 
     // Seek to the position to write the current offset to.
     mOutput->seek(mIFDOffset, io::Seekable::START);
 
     // Write the current offset.
-    mOutput->write((sys::byte *)&offset, sizeof(offset));
+    if (bigTIFF)
+    {
+        mOutput->write((sys::byte *)&offset, sizeof(offset));
+    }
+    else
+    {
+        const sys::Uint32_T classicOffset = static_cast<sys::Uint32_T>(offset);
+        mOutput->write((sys::byte *)&classicOffset, sizeof(classicOffset));
+    }
 
     // Reseek to the current offset and write out the IFD.
     mOutput->seek(offset, io::Seekable::START);
-    mIFD.serialize(*mOutput);
+    mIFD.serialize(*mOutput, bigTIFF);
 
     // Keep the position in the file that the offset to the next
     // IFD can be written to, in case there is another IFD.
@@ -73,27 +91,45 @@ void tiff::ImageWriter::validate()
         return;
 
     // ImageWidth
-    tiff::IFDEntry *imageWidth = mIFD["ImageWidth"];
+    tiff::IFDEntry *imageWidth = mIFD[tiff::Const::Tag::IMAGE_WIDTH];
     if (!imageWidth)
         throw except::Exception(Ctxt("ImageWidth must be defined"));
 
     // ImageLength
-    tiff::IFDEntry *imageLength = mIFD["ImageLength"];
+    tiff::IFDEntry *imageLength = mIFD[tiff::Const::Tag::IMAGE_LENGTH];
     if (!imageLength)
         throw except::Exception(Ctxt("ImageLength must be defined"));
 
-    // Compression
-    tiff::IFDEntry *compression = mIFD["Compression"];
+    // Compression.  The JPEG codec depends on the bands, so it is set
+    // up once they have been checked.
+    tiff::IFDEntry *compression = mIFD[tiff::Const::Tag::COMPRESSION];
+    bool jpeg = false;
+    mJPEGCodec.reset();
     if (!compression)
         mIFD.addEntry("Compression", (unsigned short) 1);
+    else if (static_cast<unsigned short>(compression->getUint64(0)) ==
+             tiff::Const::CompressionType::JPEG)
+        jpeg = true;
     else
+        mCodec = tiff::getCodec(
+                static_cast<unsigned short>(compression->getUint64(0)));
+
+    // Predictor
+    tiff::IFDEntry *predictor = mIFD[tiff::Const::Tag::PREDICTOR];
+    if (predictor)
     {
-        if (*(tiff::GenericType<unsigned short> *)(*compression)[0] != 1)
-            throw except::Exception(Ctxt("Unsupported compression type"));
+        mPredictor = static_cast<unsigned short>(predictor->getUint64(0));
+        if (mPredictor != tiff::Const::PredictorType::NONE &&
+            mPredictor != tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING)
+            throw except::Exception(Ctxt("Unsupported predictor"));
+        if (mPredictor != tiff::Const::PredictorType::NONE && !mCodec)
+            throw except::Exception(Ctxt(jpeg ?
+                    "JPEG compression does not use a predictor" :
+                    "A predictor requires compression"));
     }
 
     // XResolution
-    tiff::IFDEntry *xResolution = mIFD["XResolution"];
+    tiff::IFDEntry *xResolution = mIFD[tiff::Const::Tag::X_RESOLUTION];
     if (!xResolution)
     {
         mIFD.addEntry("XResolution", tiff::combine(
@@ -101,7 +137,7 @@ void tiff::ImageWriter::validate()
     }
 
     // YResolution
-    tiff::IFDEntry *yResolution = mIFD["YResolution"];
+    tiff::IFDEntry *yResolution = mIFD[tiff::Const::Tag::Y_RESOLUTION];
     if (!yResolution)
     {
         mIFD.addEntry("YResolution", tiff::combine(
@@ -109,21 +145,24 @@ void tiff::ImageWriter::validate()
     }
 
     // ResolutionUnit
-    tiff::IFDEntry *resolutionUnit = mIFD["ResolutionUnit"];
+    tiff::IFDEntry *resolutionUnit =
+            mIFD[tiff::Const::Tag::RESOLUTION_UNIT];
     if (!resolutionUnit)
         mIFD.addEntry("ResolutionUnit", (unsigned short) 2);
 
     // SamplesPerPixel
-    tiff::IFDEntry *samplesPerPixel = mIFD["SamplesPerPixel"];
+    tiff::IFDEntry *samplesPerPixel =
+            mIFD[tiff::Const::Tag::SAMPLES_PER_PIXEL];
     unsigned short spp = (!samplesPerPixel) ? 0
-            : (unsigned short)*(tiff::GenericType<unsigned short> *)(*samplesPerPixel)[0];
+            : static_cast<unsigned short>(samplesPerPixel->getUint64(0));
 
     // PhotometricInterpretation
-    tiff::IFDEntry *photoInterp = mIFD["PhotometricInterpretation"];
+    tiff::IFDEntry *photoInterp =
+            mIFD[tiff::Const::Tag::PHOTOMETRIC_INTERPRETATION];
     if (!photoInterp)
         throw except::Exception(Ctxt("No default for PhotometricInterpretation; it must be defined"));
 
-    switch (*(tiff::GenericType<unsigned short> *)(*photoInterp)[0])
+    switch (static_cast<unsigned short>(photoInterp->getUint64(0)))
     {
     case tiff::Const::PhotoInterpType::BLACK_IS_ZERO:
     case tiff::Const::PhotoInterpType::WHITE_IS_ZERO:
@@ -135,7 +174,7 @@ void tiff::ImageWriter::validate()
         {
             spp = 3;
             mIFD.addEntry("SamplesPerPixel", (unsigned short) spp);
-            samplesPerPixel = mIFD["SamplesPerPixel"];
+            samplesPerPixel = mIFD[tiff::Const::Tag::SAMPLES_PER_PIXEL];
         }
         else
         {
@@ -145,12 +184,29 @@ void tiff::ImageWriter::validate()
 
         break;
 
+    case tiff::Const::PhotoInterpType::YCBCR:
+
+        // Only the JPEG codec converts to and from YCbCr.
+        if (!jpeg)
+            throw except::Exception(Ctxt("YCbCr files must be JPEG compressed"));
+
+        if (!samplesPerPixel)
+        {
+            spp = 3;
+            mIFD.addEntry("SamplesPerPixel", (unsigned short) spp);
+            samplesPerPixel = mIFD[tiff::Const::Tag::SAMPLES_PER_PIXEL];
+        }
+        else if (spp != 3)
+            throw except::Exception(Ctxt("SamplesPerPixel must be 3 for YCbCr files"));
+
+        break;
+
     case tiff::Const::PhotoInterpType::COLORMAP:
 
-        if (!mIFD["ColorMap"])
+        if (!mIFD[tiff::Const::Tag::COLOR_MAP])
             throw except::Exception(Ctxt("Colormap must be defined for ColorMapped files"));
 
-        if (samplesPerPixel && *(tiff::GenericType<unsigned short> *)(*samplesPerPixel)[0] != 1)
+        if (samplesPerPixel && samplesPerPixel->getUint64(0) != 1)
             throw except::Exception(Ctxt("SamplesPerPixel must be 1 for ColorMapped files"));
 
         break;
@@ -159,7 +215,7 @@ void tiff::ImageWriter::validate()
         throw except::Exception(Ctxt("Unsupported PhotometricInterpretation"));
     }
 
-    tiff::IFDEntry *bitsPerSample = mIFD["BitsPerSample"];
+    tiff::IFDEntry *bitsPerSample = mIFD[tiff::Const::Tag::BITS_PER_SAMPLE];
     if (samplesPerPixel)
     {
         for (int i = 0; i < spp; ++i)
@@ -168,29 +224,32 @@ void tiff::ImageWriter::validate()
                 mIFD.addEntry("BitsPerSample", (unsigned short) 8);
             else
             {
-                unsigned short bps = *(tiff::GenericType<unsigned short> *)(*bitsPerSample)[0];
+                unsigned short bps = static_cast<unsigned short>(
+                        bitsPerSample->getUint64(0));
 
-                if (!(*bitsPerSample)[i])
+                if (static_cast<sys::Uint64_T>(i) >= bitsPerSample->getCount())
                     mIFD.addEntryValue("BitsPerSample", (unsigned short) bps);
                 else
                 {
                     unsigned short value =
-                            *(tiff::GenericType<unsigned short> *)(*bitsPerSample)[i];
+                            static_cast<unsigned short>(bitsPerSample->getUint64(i));
                     if (value != 8 && i < 3)
                         throw except::Exception(Ctxt("BitsPerSample values must be 8 for RGB files"));
                 }
             }
 
-            tiff::IFDEntry *sampleFormat = mIFD["SampleFormat"];
+            tiff::IFDEntry *sampleFormat =
+                    mIFD[tiff::Const::Tag::SAMPLE_FORMAT];
             if (sampleFormat)
             {
-                unsigned short format = *(tiff::GenericType<unsigned short> *)(*sampleFormat)[0];
-                if (!(*sampleFormat)[i])
+                unsigned short format = static_cast<unsigned short>(
+                        sampleFormat->getUint64(0));
+                if (static_cast<sys::Uint64_T>(i) >= sampleFormat->getCount())
                     mIFD.addEntryValue("SampleFormat", (unsigned short) format);
                 else
                 {
                     unsigned short value =
-                            *(tiff::GenericType<unsigned short> *)(*sampleFormat)[i];
+                            static_cast<unsigned short>(sampleFormat->getUint64(i));
                     if (value != 1 && i < 3)
                         throw except::Exception(Ctxt("SampleFormat values must be 1 for RGB files"));
                 }
@@ -203,6 +262,19 @@ void tiff::ImageWriter::validate()
 
     mElementSize = mIFD.getElementSize();
 
+    if (jpeg)
+    {
+        if (mElementSize != mIFD.getNumBands())
+            throw except::Exception(Ctxt("JPEG compression requires 8-bit samples"));
+        mJPEGCodec.reset(new tiff::JPEGCodec(
+                static_cast<unsigned short>(photoInterp->getUint64(0)),
+                mIFD.getNumBands(), std::vector<unsigned char>(),
+                mJPEGQuality));
+        mCodec = mJPEGCodec.get();
+    }
+
+    checkFileSize();
+
     if (mFormat == TILED)
         initTiles();
     else
@@ -228,40 +300,121 @@ void tiff::ImageWriter::validate()
     mValidated = true;
 }
 
-void tiff::ImageWriter::initTiles()
+sys::Uint64_T tiff::ImageWriter::estimateSize()
+{
+    // Account for tile padding, the offset and byte count arrays, and
+    // an allowance for the other tags.
+    sys::Uint64_T imageBytes = mIFD.getImageSize();
+    sys::Uint64_T numChunks = mIFD.getImageLength();
+    if (mFormat == TILED)
+    {
+        const sys::Uint64_T tileSize = computeTileSize();
+        const sys::Uint64_T tilesAcross =
+                (mIFD.getImageWidth() + tileSize - 1) / tileSize;
+        const sys::Uint64_T tilesDown =
+                (mIFD.getImageLength() + tileSize - 1) / tileSize;
+        numChunks = tilesAcross * tilesDown;
+        imageBytes = numChunks * tileSize * tileSize * mIFD.getElementSize();
+    }
+
+    return imageBytes + numChunks * 2 * sizeof(sys::Uint32_T) + 65536;
+}
+
+sys::Uint64_T tiff::ImageWriter::getIFDSize()
+{
+    validate();
+    return mIFD.getSerializedSize(isBigTIFF());
+}
+
+void tiff::ImageWriter::checkFileSize()
+{
+    if (isBigTIFF())
+        return;
+
+    const sys::Uint64_T estimatedSize = mOutput->tell() + estimateSize();
+    if (estimatedSize <= tiff::Header::CLASSIC_MAX_OFFSET)
+        return;
+
+    // Only the first image can change the format, since an earlier IFD
+    // would already have been written with 4-byte offsets.
+    if (!mAutoFormat || !mHeader ||
+        mIFDOffset != mHeader->getIFDOffsetPosition())
+    {
+        throw except::Exception(Ctxt(
+                "Image exceeds the 4 GB classic TIFF limit; write it as "
+                "BigTIFF instead"));
+    }
+
+    // Rewrite the header in place.  The FileWriter reserves room for the
+    // larger BigTIFF header when the format is chosen automatically.
+    const sys::Off_T current = mOutput->tell();
+    mHeader->setBigTIFF(true);
+    mOutput->seek(0, io::Seekable::START);
+    mHeader->serialize(*mOutput);
+    mOutput->seek(current, io::Seekable::START);
+
+    mIFDOffset = mHeader->getIFDOffsetPosition();
+}
+
+sys::Uint32_T tiff::ImageWriter::computeTileSize()
 {
     sys::Uint32_T root = (sys::Uint32_T)sqrt((double)mIdealChunkSize
             / (double)mIFD.getElementSize());
     sys::Uint32_T ceiling = (sys::Uint32_T)ceil(((double)root) / 16);
-    sys::Uint32_T tileSize = ceiling * 16;
+    return ceiling * 16;
+}
+
+tiff::IFDEntry *tiff::ImageWriter::addOffsetEntry(unsigned short tag)
+{
+    tiff::IFDEntry *entry = mIFD.addEntry(tag);
+    if (isBigTIFF())
+    {
+        const tiff::IFDEntry wide(tag, tiff::Const::Type::LONG8,
+                                  entry->getName());
+        mIFD.addEntry(&wide);
+        entry = mIFD[tag];
+    }
+    return entry;
+}
+
+void tiff::ImageWriter::initTiles()
+{
+    const sys::Uint32_T tileSize = computeTileSize();
 
     mIFD.addEntry("TileWidth", (sys::Uint32_T) tileSize);
     mIFD.addEntry("TileLength", (sys::Uint32_T) tileSize);
 
-    sys::Uint32_T fileOffset = mOutput->tell();
     sys::Uint32_T tilesAcross = (mIFD.getImageWidth() + tileSize - 1)
             / tileSize;
     sys::Uint32_T tilesDown = (mIFD.getImageLength() + tileSize - 1) / tileSize;
 
+    // Compressed tile offsets are filled in as the tiles are written.
+    mChunkWidth = mChunkLength = tileSize;
+    if (mCodec)
+    {
+        reserveOffsetEntries(tilesAcross * tilesDown);
+        return;
+    }
+
+    sys::Uint64_T fileOffset = mOutput->tell();
+
     unsigned short elementSize = mIFD.getElementSize();
 
-    mIFD.addEntry("TileByteCounts");
-    mIFD.addEntry("TileOffsets");
+    mTileByteCounts = addOffsetEntry(tiff::Const::Tag::TILE_BYTE_COUNTS);
+    mTileOffsets = addOffsetEntry(tiff::Const::Tag::TILE_OFFSETS);
     for (sys::Uint32_T y = 0; y < tilesDown; ++y)
     {
         for (sys::Uint32_T x = 0; x < tilesAcross; ++x)
         {
             sys::Uint32_T byteCount = tileSize * tileSize * elementSize;
-            mIFD.addEntryValue("TileOffsets", (sys::Uint32_T) fileOffset);
-            mIFD.addEntryValue("TileByteCounts", (sys::Uint32_T) byteCount);
+            mTileOffsets->addUint64(fileOffset);
+            mTileByteCounts->addUint64(byteCount);
             fileOffset += byteCount;
         }
     }
 
-    mTileOffsets = mIFD["TileOffsets"];
-    mTileWidth = mIFD["TileWidth"];
-    mTileLength = mIFD["TileLength"];
-    mTileByteCounts = mIFD["TileByteCounts"];
+    mTileWidth = mIFD[tiff::Const::Tag::TILE_WIDTH];
+    mTileLength = mIFD[tiff::Const::Tag::TILE_LENGTH];
 }
 
 void tiff::ImageWriter::initStrips()
@@ -279,6 +432,11 @@ void tiff::ImageWriter::initStrips()
         stripByteCount = bytesPerLine * rowsPerStrip;
     }
 
+    // JPEG strips other than the last must hold whole MCUs, which are
+    // as many as 16 rows tall.
+    if (mJPEGCodec.get())
+        rowsPerStrip = (rowsPerStrip + 15) / 16 * 16;
+
     mIFD.addEntry("RowsPerStrip", rowsPerStrip);
 
     sys::Uint32_T length = mIFD.getImageLength();
@@ -286,29 +444,38 @@ void tiff::ImageWriter::initStrips()
             (sys::Uint32_T)floor(static_cast<double>(length + rowsPerStrip - 1)
                     / static_cast<double>(rowsPerStrip));
 
-    sys::Uint32_T offset = mOutput->tell();
+    // Compressed strip offsets are filled in as the strips are written.
+    mChunkWidth = mIFD.getImageWidth();
+    mChunkLength = rowsPerStrip;
+    if (mCodec)
+    {
+        reserveOffsetEntries(stripsPerImage);
+        return;
+    }
+
+    sys::Uint64_T offset = mOutput->tell();
 
     // Add counts and offsets for all but the last strip.
-    mIFD.addEntry("StripOffsets");
-    mIFD.addEntry("StripByteCounts");
+    tiff::IFDEntry *stripOffsets =
+            addOffsetEntry(tiff::Const::Tag::STRIP_OFFSETS);
+    mStripByteCounts = addOffsetEntry(tiff::Const::Tag::STRIP_BYTE_COUNTS);
     for (sys::Uint32_T i = 0; i < stripsPerImage - 1; ++i)
     {
-        mIFD.addEntryValue("StripOffsets", (sys::Uint32_T) offset);
-        mIFD.addEntryValue("StripByteCounts", (sys::Uint32_T) stripByteCount);
+        stripOffsets->addUint64(offset);
+        mStripByteCounts->addUint64(stripByteCount);
         offset += stripByteCount;
     }
 
     // Add the last offset.
-    mIFD.addEntryValue("StripOffsets", (sys::Uint32_T) offset);
+    stripOffsets->addUint64(offset);
 
     // The last byte count can be less than the previous counts.  This occurs
     // (for example) if RowsPerStrip is even, and ImageLength is odd.
-    sys::Uint32_T remainingBytes = mIFD.getImageSize() - ((stripsPerImage - 1)
-            * stripByteCount);
+    const sys::Uint64_T remainingBytes = mIFD.getImageSize()
+            - (static_cast<sys::Uint64_T>(stripsPerImage - 1) * stripByteCount);
 
     // Add the last byteCount.
-    mIFD.addEntryValue("StripByteCounts", remainingBytes);
-    mStripByteCounts = mIFD["StripByteCounts"];
+    mStripByteCounts->addUint64(remainingBytes);
 }
 
 void tiff::ImageWriter::putTileData(const unsigned char *buffer,
@@ -317,10 +484,12 @@ void tiff::ImageWriter::putTileData(const unsigned char *buffer,
     sys::Uint32_T imageElemWidth = mIFD.getImageWidth();
     sys::Uint32_T imageByteWidth = imageElemWidth * mElementSize;
 
-    sys::Uint32_T tileElemWidth = *(tiff::GenericType<sys::Uint32_T> *)(*mTileWidth)[0];
+    sys::Uint32_T tileElemWidth =
+            static_cast<sys::Uint32_T>(mTileWidth->getUint64(0));
     sys::Uint32_T tileByteWidth = tileElemWidth * mElementSize;
 
-    unsigned short tileElemLength = *(tiff::GenericType<sys::Uint32_T> *)(*mTileLength)[0];
+    sys::Uint32_T tileElemLength =
+            static_cast<sys::Uint32_T>(mTileLength->getUint64(0));
 
     // Compute the number of tiles wide the image is.
     sys::Uint32_T tilesAcross = (imageElemWidth + tileElemWidth - 1)
@@ -328,10 +497,11 @@ void tiff::ImageWriter::putTileData(const unsigned char *buffer,
 
     // Determine how many bytes were used to pad the right edge.
     sys::Uint32_T widthPadding = (tileByteWidth * tilesAcross) - imageByteWidth;
-    sys::Uint32_T globalReadOffset = 0;
-    sys::Uint32_T tempBytePosition = mBytePosition;
-    sys::Uint32_T numBytesToWrite = numElementsToWrite * mElementSize;
-    sys::Uint32_T currentNumBytesRead = 0;
+    sys::Uint64_T globalReadOffset = 0;
+    sys::Uint64_T tempBytePosition = mBytePosition;
+    const sys::Uint64_T numBytesToWrite =
+            static_cast<sys::Uint64_T>(numElementsToWrite) * mElementSize;
+    sys::Uint64_T currentNumBytesRead = 0;
     sys::Uint32_T remainingElementsToWrite = numElementsToWrite;
     while (remainingElementsToWrite)
     {
@@ -344,17 +514,19 @@ void tiff::ImageWriter::putTileData(const unsigned char *buffer,
         }
 
         // Compute the row and tile row.
-        sys::Uint32_T row = tempBytePosition / imageByteWidth;
+        sys::Uint32_T row = static_cast<sys::Uint32_T>(tempBytePosition / imageByteWidth);
         sys::Uint32_T tileRow = row / tileElemLength;
 
         // Compute the column and tile column.
-        sys::Uint32_T column = tempBytePosition - (row * imageByteWidth);
+        sys::Uint32_T column = static_cast<sys::Uint32_T>(tempBytePosition
+                - static_cast<sys::Uint64_T>(row) * imageByteWidth);
         sys::Uint32_T tileColumn = column / tileByteWidth;
 
         // Compute the 1D tile index from the tile row and tile column.
         sys::Uint32_T tileIndex = (tileRow * tilesAcross) + tileColumn;
 
-        sys::Uint32_T tileByteCount = *(tiff::GenericType<sys::Uint32_T> *)(*mTileByteCounts)[tileIndex];
+        sys::Uint32_T tileByteCount = static_cast<sys::Uint32_T>(
+                mTileByteCounts->getUint64(tileIndex));
 
         sys::Uint32_T rowInTile = row % tileElemLength;
         sys::Uint32_T paddedBytes = ((tileColumn + 1) / tilesAcross)
@@ -370,7 +542,7 @@ void tiff::ImageWriter::putTileData(const unsigned char *buffer,
         sys::byte *copyBuffer = new sys::byte[tileByteWidth * tileElemLength];
         memset(copyBuffer, 0, tileByteWidth * tileElemLength);
         sys::Uint32_T copyOffset = 0;
-        sys::Uint32_T readOffset = 0;
+        sys::Uint64_T readOffset = 0;
         sys::Uint32_T tempColumn = column;
         unsigned short iteration = 0;
         while (readOffset < numBytesToWrite)
@@ -391,7 +563,8 @@ void tiff::ImageWriter::putTileData(const unsigned char *buffer,
             }
 
             if (numBytesToCopy > numBytesToWrite - readOffset)
-                numBytesToCopy = numBytesToWrite - readOffset;
+                numBytesToCopy = static_cast<sys::Uint32_T>(
+                        numBytesToWrite - readOffset);
 
             if (paddedBytes)
             {
@@ -409,7 +582,7 @@ void tiff::ImageWriter::putTileData(const unsigned char *buffer,
             currentNumBytesRead += numBytesToCopy;
         }
 
-        sys::Uint32_T seekPos = *(tiff::GenericType<sys::Uint32_T> *)(*mTileOffsets)[tileIndex];
+        sys::Uint64_T seekPos = mTileOffsets->getUint64(tileIndex);
         seekPos += (row % tileElemLength) * tileByteWidth;
         seekPos += (column % tileByteWidth);
         mOutput->seek(seekPos, io::Seekable::START);
@@ -436,7 +609,7 @@ void tiff::ImageWriter::putTileData(const unsigned char *buffer,
 
             for (sys::Uint32_T i = 0; i < tilesAcross; ++i)
             {
-                sys::Uint32_T seekPos = *(tiff::GenericType<sys::Uint32_T> *)(*mTileOffsets)[startIndex + i];
+                sys::Uint64_T seekPos = mTileOffsets->getUint64(startIndex + i);
                 seekPos += paddingStartLine * tileByteWidth;
                 mOutput->seek(seekPos, io::Seekable::START);
                 mOutput->write(padBuffer, paddedLines * tileByteWidth);
@@ -451,9 +624,10 @@ void tiff::ImageWriter::putTileData(const unsigned char *buffer,
         // should probably be found.
         else
         {
-            sys::Uint32_T lastTileIndex = mTileOffsets->getValues().size() - 1;
-            sys::Uint32_T seekPos = *(tiff::GenericType<sys::Uint32_T> *)(*mTileOffsets)[lastTileIndex];
-            seekPos += *(tiff::GenericType<sys::Uint32_T> *)(*mTileByteCounts)[lastTileIndex];
+            sys::Uint32_T lastTileIndex = static_cast<sys::Uint32_T>(
+                    mTileOffsets->getCount() - 1);
+            sys::Uint64_T seekPos = mTileOffsets->getUint64(lastTileIndex);
+            seekPos += mTileByteCounts->getUint64(lastTileIndex);
             mOutput->seek(seekPos, io::Seekable::START);
         }
     }
@@ -462,26 +636,222 @@ void tiff::ImageWriter::putTileData(const unsigned char *buffer,
 void tiff::ImageWriter::putStripData(const unsigned char *buffer,
                                      sys::Uint32_T numElementsToWrite)
 {
-    sys::Uint32_T stripSize = *(tiff::GenericType<sys::Uint32_T> *)(*mStripByteCounts)[0];
-    sys::Uint32_T bufferIndex = 0;
+    const sys::Uint64_T stripSize = mStripByteCounts->getUint64(0);
+    sys::Uint64_T bufferIndex = 0;
 
     while (numElementsToWrite)
     {
-        sys::Uint32_T bytesToWrite = mElementSize * numElementsToWrite;
-        sys::Uint32_T stripIndex = mBytePosition / stripSize;
-        sys::Uint32_T stripPosition = mBytePosition % stripSize;
+        sys::Uint64_T bytesToWrite =
+                static_cast<sys::Uint64_T>(mElementSize) * numElementsToWrite;
+        sys::Uint32_T stripIndex = static_cast<sys::Uint32_T>(mBytePosition / stripSize);
+        sys::Uint64_T stripPosition = mBytePosition % stripSize;
 
         // Calculate what remains to be written in the current strip.
-        sys::Uint32_T remainingBytesInStrip =
-                (*(tiff::GenericType<sys::Uint32_T> *)(*mStripByteCounts)[stripIndex]) - stripPosition;
+        sys::Uint64_T remainingBytesInStrip =
+                mStripByteCounts->getUint64(stripIndex) - stripPosition;
 
         if (bytesToWrite > remainingBytesInStrip)
             bytesToWrite = remainingBytesInStrip;
 
-        mOutput->write((sys::byte *)buffer + bufferIndex, bytesToWrite);
+        mOutput->write((sys::byte *)buffer + bufferIndex,
+                       static_cast<size_t>(bytesToWrite));
         bufferIndex += bytesToWrite;
 
-        numElementsToWrite -= (bytesToWrite / mElementSize);
+        numElementsToWrite -= static_cast<sys::Uint32_T>(bytesToWrite / mElementSize);
         mBytePosition += bytesToWrite;
     }
 }
+
+void tiff::ImageWriter::putCompressedData(const unsigned char *buffer,
+                                         sys::Uint32_T numElementsToWrite)
+{
+    const sys::Uint64_T imageSize = mIFD.getImageSize();
+    const size_t rowBytes = static_cast<size_t>(mIFD.getImageWidth())
+            * mElementSize;
+
+    // Buffer one row of chunks per thread, so that every thread has
+    // work while memory stays bounded.
+    const size_t windowRows = mChunkLength * std::max<size_t>(mNumThreads, 1);
+    const size_t windowBytes = rowBytes * windowRows;
+    mChunkRow.resize(windowBytes);
+
+    sys::Uint64_T numBytesToWrite =
+            static_cast<sys::Uint64_T>(numElementsToWrite) * mElementSize;
+    if (mBytePosition + numBytesToWrite > imageSize)
+        throw except::Exception(Ctxt("Wrote past the end of the image"));
+
+    while (numBytesToWrite)
+    {
+        const size_t position = static_cast<size_t>(mBytePosition
+                % windowBytes);
+        const size_t numBytes = static_cast<size_t>(std::min<sys::Uint64_T>(
+                numBytesToWrite, windowBytes - position));
+        ::memcpy(&mChunkRow[position], buffer, numBytes);
+
+        buffer += numBytes;
+        numBytesToWrite -= numBytes;
+        mBytePosition += numBytes;
+
+        if (position + numBytes == windowBytes)
+            flushChunkRows(windowRows);
+        else if (mBytePosition == imageSize)
+            flushChunkRows((position + numBytes) / rowBytes);
+    }
+}
+
+/**
+ * Compresses the chunks of the buffered window, numbered in raster
+ * order.  Each thread gets its own copy, and so its own scratch chunk.
+ */
+class tiff::ImageWriter::ChunkEncoder
+{
+public:
+    ChunkEncoder(const tiff::ImageWriter& writer,
+                 size_t numRows,
+                 size_t imageWidth,
+                 size_t numBands,
+                 std::vector<std::vector<unsigned char> >& encoded) :
+        mWriter(writer),
+        mNumRows(numRows),
+        mImageWidth(imageWidth),
+        mChunksAcross((imageWidth + writer.mChunkWidth - 1)
+                / writer.mChunkWidth),
+        mNumBands(numBands),
+        mEncoded(encoded)
+    {
+    }
+
+    void operator()(size_t index) const
+    {
+        const size_t elementSize = mWriter.mElementSize;
+        const size_t rowBytes = mImageWidth * elementSize;
+        const size_t chunkRowBytes = mWriter.mChunkWidth * elementSize;
+        const size_t band = index / mChunksAcross;
+        const size_t firstRow = band * mWriter.mChunkLength;
+        const size_t firstCol = (index % mChunksAcross) * mWriter.mChunkWidth;
+        const size_t numRows = std::min(mWriter.mChunkLength,
+                                        mNumRows - firstRow);
+
+        // Tiles are always full size, but the last strip may be shorter.
+        const size_t chunkLength = (mWriter.mFormat == TILED)
+                ? mWriter.mChunkLength : numRows;
+        const size_t copyBytes = std::min(mWriter.mChunkWidth,
+                                          mImageWidth - firstCol)
+                * elementSize;
+
+        mChunk.assign(chunkRowBytes * chunkLength, 0);
+        for (size_t row = 0; row < numRows; ++row)
+        {
+            ::memcpy(&mChunk[row * chunkRowBytes],
+                     &mWriter.mChunkRow[(firstRow + row) * rowBytes
+                                        + firstCol * elementSize],
+                     copyBytes);
+        }
+
+        // JPEG smooths (and subsamples chroma) across block edges, so
+        // pad edge tiles with copies of the edge pixels, not zeros.
+        if (mWriter.mJPEGCodec.get() && numRows)
+        {
+            for (size_t row = 0; row < numRows; ++row)
+            {
+                unsigned char* const rowStart = &mChunk[row * chunkRowBytes];
+                for (size_t pos = copyBytes; pos < chunkRowBytes;
+                        pos += elementSize)
+                {
+                    ::memcpy(rowStart + pos, rowStart + copyBytes
+                            - elementSize, elementSize);
+                }
+            }
+            for (size_t row = numRows; row < chunkLength; ++row)
+            {
+                ::memcpy(&mChunk[row * chunkRowBytes],
+                         &mChunk[(numRows - 1) * chunkRowBytes],
+                         chunkRowBytes);
+            }
+        }
+
+        if (mWriter.mPredictor ==
+                tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING)
+            tiff::applyHorizontalPredictor(&mChunk[0], mWriter.mChunkWidth,
+                                           chunkLength, mNumBands,
+                                           elementSize / mNumBands);
+
+        mEncoded[index].clear();
+        mWriter.mCodec->encode(&mChunk[0], mChunk.size(), chunkRowBytes,
+                               mEncoded[index]);
+    }
+
+private:
+    const tiff::ImageWriter& mWriter;
+    const size_t mNumRows;
+    const size_t mImageWidth;
+    const size_t mChunksAcross;
+    const size_t mNumBands;
+    std::vector<std::vector<unsigned char> >& mEncoded;
+    mutable std::vector<unsigned char> mChunk;
+};
+
+void tiff::ImageWriter::flushChunkRows(size_t numRows)
+{
+    const size_t imageWidth = mIFD.getImageWidth();
+    const size_t chunksAcross = (imageWidth + mChunkWidth - 1) / mChunkWidth;
+    const size_t chunksDown = (numRows + mChunkLength - 1) / mChunkLength;
+    const size_t numChunks = chunksAcross * chunksDown;
+
+    // The chunks are compressed in parallel, then written in order.
+    mEncoded.resize(numChunks);
+    const ChunkEncoder op(*this, numRows, imageWidth, mIFD.getNumBands(),
+                          mEncoded);
+    if (mNumThreads <= 1 || numChunks == 1)
+    {
+        for (size_t ii = 0; ii < numChunks; ++ii)
+            op(ii);
+    }
+    else
+    {
+        mt::runBalanced1DWithCopies(numChunks,
+                                    std::min(mNumThreads, numChunks), op);
+    }
+
+    for (size_t ii = 0; ii < numChunks; ++ii)
+    {
+        const std::vector<unsigned char>& encoded = mEncoded[ii];
+        mChunkOffsets.push_back(mOutput->tell());
+        mChunkByteCounts.push_back(encoded.size());
+        if (!encoded.empty())
+            mOutput->write((sys::byte *)&encoded[0], encoded.size());
+    }
+
+    // Once the image is complete, the offsets are all known.
+    if (mBytePosition != mIFD.getImageSize())
+        return;
+
+    tiff::IFDEntry *offsets = addOffsetEntry((mFormat == TILED)
+            ? tiff::Const::Tag::TILE_OFFSETS
+            : tiff::Const::Tag::STRIP_OFFSETS);
+    tiff::IFDEntry *byteCounts = addOffsetEntry((mFormat == TILED)
+            ? tiff::Const::Tag::TILE_BYTE_COUNTS
+            : tiff::Const::Tag::STRIP_BYTE_COUNTS);
+    for (size_t ii = 0; ii < mChunkOffsets.size(); ++ii)
+    {
+        offsets->addUint64(mChunkOffsets[ii]);
+        byteCounts->addUint64(mChunkByteCounts[ii]);
+    }
+}
+
+void tiff::ImageWriter::reserveOffsetEntries(size_t numChunks)
+{
+    // The placeholders are replaced once the image is complete, but
+    // adding them now fixes the size of the IFD from validation on.
+    tiff::IFDEntry *offsets = addOffsetEntry((mFormat == TILED)
+            ? tiff::Const::Tag::TILE_OFFSETS
+            : tiff::Const::Tag::STRIP_OFFSETS);
+    tiff::IFDEntry *byteCounts = addOffsetEntry((mFormat == TILED)
+            ? tiff::Const::Tag::TILE_BYTE_COUNTS
+            : tiff::Const::Tag::STRIP_BYTE_COUNTS);
+    for (size_t ii = 0; ii < numChunks; ++ii)
+    {
+        offsets->addUint64(0);
+        byteCounts->addUint64(0);
+    }
+}
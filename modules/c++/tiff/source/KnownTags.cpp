@@ -101,6 +101,7 @@ tiff::KnownTags::KnownTags()
     addEntry(340, tiff::Const::Type::UNDEFINED, "SMinSampleValue");
     addEntry(341, tiff::Const::Type::UNDEFINED, "SMaxSampleValue");
     addEntry(342, tiff::Const::Type::SHORT, "TransferRange");
+    addEntry(347, tiff::Const::Type::UNDEFINED, "JPEGTables");
     addEntry(512, tiff::Const::Type::SHORT, "JPEGProc");
     addEntry(513, tiff::Const::Type::LONG, "JPEGInterchangeFormat");
     addEntry(514, tiff::Const::Type::LONG, "JPEGInterchangeFormatLngth");
@@ -153,8 +154,11 @@ void tiff::KnownTags::addEntry(const unsigned short tag,
 
 tiff::IFDEntry *tiff::KnownTags::operator[] (const std::string& nameKey)
 {
-    unsigned short tagKey = mNameMap[nameKey];
-    return (*this)[tagKey];
+    // Unknown names are not added to the map, so that lookups from
+    // several threads do not modify it.
+    std::map<std::string, unsigned short>::const_iterator pos =
+        mNameMap.find(nameKey);
+    return pos != mNameMap.end() ? (*this)[pos->second] : NULL;
 }
 
 tiff::IFDEntry *tiff::KnownTags::operator[] (const unsigned short tagKey)
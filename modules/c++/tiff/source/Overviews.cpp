@@ -0,0 +1,268 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include "tiff/Overviews.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <import/except.h>
+#include <import/sys.h>
+#include <mt/BalancedRunnable1D.h>
+
+#include "tiff/Common.h"
+
+namespace
+{
+const int NEAREST_OFFSETS[] = { 0 };
+const double NEAREST_WEIGHTS[] = { 1.0 };
+const int AVERAGE_OFFSETS[] = { 0, 1 };
+const double AVERAGE_WEIGHTS[] = { 0.5, 0.5 };
+const int GAUSSIAN_OFFSETS[] = { -1, 0, 1, 2 };
+const double GAUSSIAN_WEIGHTS[] = { 0.125, 0.375, 0.375, 0.125 };
+const size_t MAX_TAPS = 4;
+
+template <typename T>
+T toSample(double value)
+{
+    if (!std::numeric_limits<T>::is_integer)
+        return static_cast<T>(value);
+
+    // The kernels have no negative weights, so the result never leaves
+    // the range of its inputs except through rounding.
+    value = std::floor(value + 0.5);
+    value = std::max(value,
+                     static_cast<double>(std::numeric_limits<T>::min()));
+    value = std::min(value,
+                     static_cast<double>(std::numeric_limits<T>::max()));
+    return static_cast<T>(value);
+}
+
+/**
+ * Computes one row of an overview.  The source rows and columns each
+ * output sample depends on are the same for every row, so the column
+ * taps are found once up front.
+ */
+template <typename T>
+class OverviewRowMaker
+{
+public:
+    OverviewRowMaker(const T *input,
+                     size_t numRows,
+                     size_t numCols,
+                     size_t numBands,
+                     tiff::OverviewKernel::Type kernel,
+                     T *output) :
+        mInput(input),
+        mNumRows(numRows),
+        mNumCols(numCols),
+        mNumBands(numBands),
+        mOutput(output),
+        mOutputCols(tiff::getOverviewLength(numCols))
+    {
+        switch (kernel)
+        {
+        case tiff::OverviewKernel::NEAREST:
+            mOffsets = NEAREST_OFFSETS;
+            mWeights = NEAREST_WEIGHTS;
+            mNumTaps = 1;
+            break;
+        case tiff::OverviewKernel::AVERAGE:
+            mOffsets = AVERAGE_OFFSETS;
+            mWeights = AVERAGE_WEIGHTS;
+            mNumTaps = 2;
+            break;
+        case tiff::OverviewKernel::GAUSSIAN:
+            mOffsets = GAUSSIAN_OFFSETS;
+            mWeights = GAUSSIAN_WEIGHTS;
+            mNumTaps = 4;
+            break;
+        default:
+            throw except::Exception(Ctxt("Unsupported overview kernel"));
+        }
+
+        mColumnTaps.resize(mOutputCols * mNumTaps);
+        for (size_t col = 0; col < mOutputCols; ++col)
+        {
+            for (size_t tap = 0; tap < mNumTaps; ++tap)
+            {
+                mColumnTaps[col * mNumTaps + tap] =
+                        clamp(col, tap, mNumCols) * mNumBands;
+            }
+        }
+    }
+
+    void operator()(size_t row) const
+    {
+        const T *rows[MAX_TAPS];
+        for (size_t tap = 0; tap < mNumTaps; ++tap)
+        {
+            rows[tap] = mInput + clamp(row, tap, mNumRows) * mNumCols
+                    * mNumBands;
+        }
+
+        T *out = mOutput + row * mOutputCols * mNumBands;
+        for (size_t col = 0; col < mOutputCols; ++col)
+        {
+            const size_t *columnTaps = &mColumnTaps[col * mNumTaps];
+            for (size_t band = 0; band < mNumBands; ++band)
+            {
+                double sum = 0.0;
+                for (size_t rowTap = 0; rowTap < mNumTaps; ++rowTap)
+                {
+                    const T *in = rows[rowTap] + band;
+                    double rowSum = 0.0;
+                    for (size_t colTap = 0; colTap < mNumTaps; ++colTap)
+                    {
+                        rowSum += mWeights[colTap]
+                                * static_cast<double>(in[columnTaps[colTap]]);
+                    }
+                    sum += mWeights[rowTap] * rowSum;
+                }
+                *out++ = toSample<T>(sum);
+            }
+        }
+    }
+
+private:
+    size_t clamp(size_t index, size_t tap, size_t length) const
+    {
+        const ptrdiff_t source = static_cast<ptrdiff_t>(index * 2)
+                + mOffsets[tap];
+        if (source < 0)
+            return 0;
+        return std::min(static_cast<size_t>(source), length - 1);
+    }
+
+    const T * const mInput;
+    const size_t mNumRows;
+    const size_t mNumCols;
+    const size_t mNumBands;
+    T * const mOutput;
+    const size_t mOutputCols;
+    const int *mOffsets;
+    const double *mWeights;
+    size_t mNumTaps;
+    std::vector<size_t> mColumnTaps;
+};
+
+template <typename T>
+void createOverviewImpl(const unsigned char *input,
+                        size_t numRows,
+                        size_t numCols,
+                        size_t numBands,
+                        tiff::OverviewKernel::Type kernel,
+                        unsigned char *output,
+                        size_t numThreads)
+{
+    const OverviewRowMaker<T> op(reinterpret_cast<const T *>(input),
+                                 numRows, numCols, numBands, kernel,
+                                 reinterpret_cast<T *>(output));
+
+    // Every output row only reads the source, so the rows can be made
+    // in any order.
+    const size_t outputRows = tiff::getOverviewLength(numRows);
+    mt::runBalanced1D(outputRows,
+                      std::max<size_t>(std::min(numThreads, outputRows), 1),
+                      op);
+}
+}
+
+void tiff::createOverview(const unsigned char *input,
+                          size_t numRows,
+                          size_t numCols,
+                          size_t numBands,
+                          unsigned short bitsPerSample,
+                          unsigned short sampleFormat,
+                          tiff::OverviewKernel::Type kernel,
+                          unsigned char *output,
+                          size_t numThreads)
+{
+    if (numRows == 0 || numCols == 0)
+        return;
+
+    switch (sampleFormat)
+    {
+    case tiff::Const::SampleFormatType::UNSIGNED_INT:
+        switch (bitsPerSample)
+        {
+        case 8:
+            createOverviewImpl<sys::Uint8_T>(input, numRows, numCols,
+                                             numBands, kernel, output,
+                                             numThreads);
+            return;
+        case 16:
+            createOverviewImpl<sys::Uint16_T>(input, numRows, numCols,
+                                              numBands, kernel, output,
+                                              numThreads);
+            return;
+        case 32:
+            createOverviewImpl<sys::Uint32_T>(input, numRows, numCols,
+                                              numBands, kernel, output,
+                                              numThreads);
+            return;
+        }
+        break;
+
+    case tiff::Const::SampleFormatType::SIGNED_INT:
+        switch (bitsPerSample)
+        {
+        case 8:
+            createOverviewImpl<sys::Int8_T>(input, numRows, numCols,
+                                            numBands, kernel, output,
+                                            numThreads);
+            return;
+        case 16:
+            createOverviewImpl<sys::Int16_T>(input, numRows, numCols,
+                                             numBands, kernel, output,
+                                             numThreads);
+            return;
+        case 32:
+            createOverviewImpl<sys::Int32_T>(input, numRows, numCols,
+                                             numBands, kernel, output,
+                                             numThreads);
+            return;
+        }
+        break;
+
+    case tiff::Const::SampleFormatType::IEEE_FLOAT:
+        switch (bitsPerSample)
+        {
+        case 32:
+            createOverviewImpl<float>(input, numRows, numCols, numBands,
+                                      kernel, output, numThreads);
+            return;
+        case 64:
+            createOverviewImpl<double>(input, numRows, numCols, numBands,
+                                       kernel, output, numThreads);
+            return;
+        }
+        break;
+    }
+
+    throw except::Exception(Ctxt(FmtX(
+            "Unable to create overviews of %d-bit samples in format %d",
+            bitsPerSample, sampleFormat)));
+}
@@ -137,7 +137,8 @@ tiff::IFD* tiff::Utils::createGeoTiffIFD(tiff::IFD* ifd)
             keyMap.find(keyId);
         const std::string name = (iter == keyMap.end()) ? "" : iter->second;
 
-        tiff::IFDEntry *entry = new tiff::IFDEntry(keyId, entryType, name);
+        std::auto_ptr<tiff::IFDEntry> entry(
+                new tiff::IFDEntry(keyId, entryType, name));
 
         if (tiffTagLoc == 0)
         {
@@ -149,32 +150,27 @@ tiff::IFD* tiff::Utils::createGeoTiffIFD(tiff::IFD* ifd)
 
             entry->addValue(new tiff::GenericType<unsigned short>(valueStr));
         }
-        else if (tiffTagLoc == 34736 && doubleParams)
+        else if ((tiffTagLoc == 34736 && doubleParams) ||
+                 (tiffTagLoc == 34737 && asciiParams))
         {
-            const unsigned short valueOffset =
-                str::toType<unsigned short>(valueStr);
-            for (unsigned short j = 0; j < count; ++j)
+            // The values are copied straight out of the parameter tag.
+            const tiff::IFDEntry* const params =
+                    (tiffTagLoc == 34736) ? doubleParams : asciiParams;
+            const size_t valueOffset = str::toType<unsigned short>(valueStr);
+            if (valueOffset + count > params->getCount())
             {
-                entry->addValue(
-                                new tiff::GenericType<double>(
-                                                              (*doubleParams)[valueOffset
-                                                                      + j]->toString()));
+                throw except::Exception(Ctxt(
+                    "GeoKey " + str::toString(keyId) +
+                    " refers past the end of " + params->getName()));
             }
-        }
-        else if (tiffTagLoc == 34737 && asciiParams)
-        {
-            const unsigned short valueOffset =
-                str::toType<unsigned short>(valueStr);
-            for (unsigned short j = 0; j < count; ++j)
+            if (count)
             {
-                entry->addValue(
-                                new tiff::GenericType<std::string>(
-                                                                   (*asciiParams)[valueOffset
-                                                                           + j]->toString()));
+                entry->appendValues(&params->getData()[valueOffset
+                        * tiff::Const::sizeOf(entryType)], count);
             }
         }
 
-        geoIFD->addEntry(entry);
+        geoIFD->addEntry(entry.get());
     }
 
     return geoIFD;
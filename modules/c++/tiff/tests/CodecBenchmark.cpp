@@ -0,0 +1,223 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/* Users guide
+
+    Measures write and read throughput of each TIFF compression scheme,
+    serially and with the parallel strip/tile pipeline.
+
+    usage: CodecBenchmark [rows] [cols] [threads] [tiled]
+        rows, cols: image size in 16-bit elements (default 4096 x 4096)
+        threads:    threads for the parallel runs (default: all CPUs)
+        tiled:      1 to write tiles, 0 to write strips (default 1)
+
+    Throughput is reported in MB/s of uncompressed image data, along
+    with the compression ratio.
+*/
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/io.h>
+#include <import/sys.h>
+#include <import/tiff.h>
+#include <io/TempFile.h>
+#include <str/Convert.h>
+
+namespace
+{
+struct Scheme
+{
+    const char *name;
+    unsigned short compression;
+    unsigned short predictor;
+};
+
+const Scheme SCHEMES[] =
+{
+    { "none", tiff::Const::CompressionType::NO_COMPRESSION,
+      tiff::Const::PredictorType::NONE },
+    { "packbits", tiff::Const::CompressionType::PACK_BITS,
+      tiff::Const::PredictorType::NONE },
+    { "lzw", tiff::Const::CompressionType::LZW,
+      tiff::Const::PredictorType::NONE },
+    { "lzw+pred", tiff::Const::CompressionType::LZW,
+      tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING },
+    { "deflate", tiff::Const::CompressionType::DEFLATE,
+      tiff::Const::PredictorType::NONE },
+    { "deflate+pred", tiff::Const::CompressionType::DEFLATE,
+      tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING }
+};
+
+// A smooth surface with some noise, loosely like terrain or SAR
+// magnitude data.
+std::vector<unsigned short> makeImage(size_t rows, size_t cols)
+{
+    std::vector<unsigned short> image(rows * cols);
+    sys::Uint32_T state = 1;
+    for (size_t row = 0; row < rows; ++row)
+    {
+        for (size_t col = 0; col < cols; ++col)
+        {
+            state = state * 1103515245 + 12345;
+            image[row * cols + col] = static_cast<unsigned short>(
+                    (row * 7 + col * 3) + ((state >> 16) & 0x3F));
+        }
+    }
+    return image;
+}
+
+double write(const std::string& pathname, const Scheme& scheme,
+             bool tiled, size_t numThreads,
+             const std::vector<unsigned short>& image,
+             size_t rows, size_t cols)
+{
+    sys::RealTimeStopWatch watch;
+    watch.start();
+
+    tiff::FileWriter writer(pathname);
+    writer.writeHeader();
+    tiff::ImageWriter *imageWriter = writer.addImage();
+    imageWriter->setImageFormat(tiled ? tiff::ImageWriter::TILED
+                                      : tiff::ImageWriter::STRIPPED);
+    imageWriter->setIdealChunkSize(256 * 256 * sizeof(unsigned short));
+    imageWriter->setNumThreads(numThreads);
+
+    tiff::IFD *ifd = imageWriter->getIFD();
+    ifd->addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                  static_cast<sys::Uint32_T>(cols));
+    ifd->addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                  static_cast<sys::Uint32_T>(rows));
+    ifd->addEntry(tiff::KnownTags::PHOTOMETRIC_INTERPRETATION,
+                  static_cast<unsigned short>(
+                          tiff::Const::PhotoInterpType::BLACK_IS_ZERO));
+    ifd->addEntry(tiff::KnownTags::BITS_PER_SAMPLE,
+                  static_cast<unsigned short>(16));
+    ifd->addEntry(tiff::KnownTags::COMPRESSION, scheme.compression);
+    if (scheme.predictor != tiff::Const::PredictorType::NONE)
+        ifd->addEntry("Predictor", scheme.predictor);
+
+    imageWriter->putData(reinterpret_cast<const unsigned char *>(&image[0]),
+                         static_cast<sys::Uint32_T>(image.size()));
+    imageWriter->writeIFD();
+    writer.close();
+
+    return watch.stop();
+}
+
+double read(const std::string& pathname, size_t numThreads,
+            std::vector<unsigned short>& image, size_t rows, size_t cols)
+{
+    sys::RealTimeStopWatch watch;
+    watch.start();
+
+    tiff::FileReader reader(pathname);
+    reader[0]->readRegion(types::RowCol<size_t>(0, 0),
+                          types::RowCol<size_t>(rows, cols),
+                          reinterpret_cast<unsigned char *>(&image[0]),
+                          numThreads);
+
+    return watch.stop();
+}
+
+double megabytesPerSecond(size_t numBytes, double millis)
+{
+    return (numBytes / 1048576.0) / (millis / 1000.0);
+}
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const size_t rows = (argc > 1) ? str::toType<size_t>(argv[1]) : 4096;
+        const size_t cols = (argc > 2) ? str::toType<size_t>(argv[2]) : 4096;
+        const size_t numThreads = (argc > 3) ? str::toType<size_t>(argv[3])
+                : sys::OS().getNumCPUs();
+        const bool tiled = (argc > 4) ? str::toType<size_t>(argv[4]) != 0
+                : true;
+
+        const std::vector<unsigned short> image = makeImage(rows, cols);
+        std::vector<unsigned short> readBack(image.size());
+        const size_t numBytes = image.size() * sizeof(unsigned short);
+
+        std::cout << rows << " x " << cols << " uint16, "
+                  << (tiled ? "tiled" : "stripped") << ", "
+                  << numThreads << " threads (MB/s)\n\n"
+                  << std::setw(14) << "scheme"
+                  << std::setw(8) << "ratio"
+                  << std::setw(12) << "write x1"
+                  << std::setw(12) << "write xN"
+                  << std::setw(12) << "read x1"
+                  << std::setw(12) << "read xN" << "\n";
+
+        for (size_t ii = 0; ii < sizeof(SCHEMES) / sizeof(SCHEMES[0]); ++ii)
+        {
+            const Scheme& scheme = SCHEMES[ii];
+            const io::TempFile serialTemp;
+            const io::TempFile temp;
+
+            const double serialWrite = write(serialTemp.pathname(), scheme,
+                                             tiled, 1, image, rows, cols);
+            const double parallelWrite = write(temp.pathname(), scheme,
+                                               tiled, numThreads, image,
+                                               rows, cols);
+            const double fileSize = static_cast<double>(
+                    sys::OS().getSize(temp.pathname()));
+
+            const double serialRead = read(temp.pathname(), 1, readBack,
+                                           rows, cols);
+            const double parallelRead = read(temp.pathname(), numThreads,
+                                             readBack, rows, cols);
+            if (readBack != image)
+                throw except::Exception(Ctxt(FmtX(
+                        "%s did not round trip", scheme.name)));
+
+            std::cout << std::setw(14) << scheme.name
+                      << std::setw(8) << std::setprecision(3)
+                      << numBytes / fileSize
+                      << std::setw(12) << std::setprecision(4)
+                      << megabytesPerSecond(numBytes, serialWrite)
+                      << std::setw(12)
+                      << megabytesPerSecond(numBytes, parallelWrite)
+                      << std::setw(12)
+                      << megabytesPerSecond(numBytes, serialRead)
+                      << std::setw(12)
+                      << megabytesPerSecond(numBytes, parallelRead) << "\n";
+        }
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (...)
+    {
+        std::cerr << "Caught unnamed exception" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
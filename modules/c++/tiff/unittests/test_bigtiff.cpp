@@ -0,0 +1,167 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+#include <import/io.h>
+#include <io/TempFile.h>
+#include <import/tiff.h>
+#include <TestCase.h>
+
+namespace
+{
+void writeImage(const std::string& pathname,
+                tiff::FileWriter::FileFormat format,
+                tiff::ImageWriter::ImageFormat imageFormat,
+                const std::vector<unsigned short>& image,
+                size_t rows,
+                size_t cols)
+{
+    tiff::FileWriter writer(pathname);
+    writer.setFileFormat(format);
+    writer.writeHeader();
+
+    tiff::ImageWriter* const imageWriter = writer.addImage();
+    imageWriter->setImageFormat(imageFormat);
+    imageWriter->setIdealChunkSize(512);
+
+    tiff::IFD* const ifd = imageWriter->getIFD();
+    ifd->addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                  static_cast<sys::Uint32_T>(cols));
+    ifd->addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                  static_cast<sys::Uint32_T>(rows));
+    ifd->addEntry(tiff::KnownTags::PHOTOMETRIC_INTERPRETATION,
+                  static_cast<unsigned short>(
+                          tiff::Const::PhotoInterpType::BLACK_IS_ZERO));
+    ifd->addEntry(tiff::KnownTags::BITS_PER_SAMPLE,
+                  static_cast<unsigned short>(16));
+
+    imageWriter->putData(reinterpret_cast<const unsigned char*>(&image[0]),
+                         static_cast<sys::Uint32_T>(image.size()));
+    imageWriter->writeIFD();
+    writer.close();
+}
+
+std::vector<unsigned short> makeImage(size_t rows, size_t cols)
+{
+    std::vector<unsigned short> image(rows * cols);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<unsigned short>(ii * 7);
+    }
+    return image;
+}
+
+void roundTrip(const std::string& testName,
+               tiff::FileWriter::FileFormat format,
+               tiff::ImageWriter::ImageFormat imageFormat,
+               bool expectBigTIFF)
+{
+    const size_t rows = 37;
+    const size_t cols = 53;
+    const std::vector<unsigned short> image = makeImage(rows, cols);
+
+    const io::TempFile temp;
+    writeImage(temp.pathname(), format, imageFormat, image, rows, cols);
+
+    tiff::FileReader reader(temp.pathname());
+    TEST_ASSERT_EQ(reader.getHeader().isBigTIFF(), expectBigTIFF);
+    TEST_ASSERT_EQ(reader.getImageCount(), 1);
+
+    tiff::IFD* const ifd = reader[0]->getIFD();
+    TEST_ASSERT_EQ(ifd->getImageWidth(), cols);
+    TEST_ASSERT_EQ(ifd->getImageLength(), rows);
+
+    const char* const offsetsTag =
+            imageFormat == tiff::ImageWriter::TILED ? "TileOffsets"
+                                                    : "StripOffsets";
+    TEST_ASSERT_EQ((*ifd)[offsetsTag]->getType(),
+                   expectBigTIFF ? tiff::Const::Type::LONG8
+                                 : tiff::Const::Type::LONG);
+
+    std::vector<unsigned short> readBack(image.size());
+    reader.getData(reinterpret_cast<unsigned char*>(&readBack[0]),
+                   static_cast<sys::Uint32_T>(readBack.size()));
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(readBack[ii], image[ii]);
+    }
+}
+
+TEST_CASE(testClassicStrips)
+{
+    roundTrip(testName, tiff::FileWriter::CLASSIC,
+              tiff::ImageWriter::STRIPPED, false);
+}
+
+TEST_CASE(testAutoStaysClassic)
+{
+    roundTrip(testName, tiff::FileWriter::AUTO,
+              tiff::ImageWriter::STRIPPED, false);
+}
+
+TEST_CASE(testBigTIFFStrips)
+{
+    roundTrip(testName, tiff::FileWriter::BIGTIFF,
+              tiff::ImageWriter::STRIPPED, true);
+}
+
+TEST_CASE(testBigTIFFTiles)
+{
+    roundTrip(testName, tiff::FileWriter::BIGTIFF,
+              tiff::ImageWriter::TILED, true);
+}
+
+TEST_CASE(testBigTIFFHeader)
+{
+    tiff::Header header;
+    TEST_ASSERT_FALSE(header.isBigTIFF());
+    TEST_ASSERT_EQ(header.size(), 8);
+    TEST_ASSERT_EQ(header.getIFDOffsetPosition(), 4);
+
+    header.setBigTIFF(true);
+    TEST_ASSERT_TRUE(header.isBigTIFF());
+    TEST_ASSERT_EQ(header.size(), 16);
+    TEST_ASSERT_EQ(header.getIFDOffsetPosition(), 8);
+    TEST_ASSERT_EQ(header.getIFDOffset(), 16);
+
+    io::ByteStream stream;
+    header.serialize(stream);
+    TEST_ASSERT_EQ(stream.tell(), 16);
+    stream.seek(0, io::Seekable::START);
+
+    tiff::Header readHeader;
+    readHeader.deserialize(stream);
+    TEST_ASSERT_TRUE(readHeader.isBigTIFF());
+    TEST_ASSERT_EQ(readHeader.getIFDOffset(), 16);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testClassicStrips);
+    TEST_CHECK(testAutoStaysClassic);
+    TEST_CHECK(testBigTIFFStrips);
+    TEST_CHECK(testBigTIFFTiles);
+    TEST_CHECK(testBigTIFFHeader);
+    return 0;
+}
@@ -0,0 +1,478 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <vector>
+
+#include <import/io.h>
+#include <io/TempFile.h>
+#include <import/tiff.h>
+#include <tiff/Codec.h>
+#include <tiff/tiff_config.h>
+#include <TestCase.h>
+
+namespace
+{
+const size_t ROWS = 45;
+const size_t COLS = 71;
+
+std::vector<unsigned char> makeBytes(size_t size)
+{
+    // Mix runs, ramps and noise so every codec path is exercised.
+    std::vector<unsigned char> bytes(size);
+    sys::Uint32_T state = 12345;
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        state = state * 1103515245 + 12345;
+        if ((ii / 300) % 3 == 0)
+            bytes[ii] = static_cast<unsigned char>(ii / 50);
+        else if ((ii / 300) % 3 == 1)
+            bytes[ii] = static_cast<unsigned char>(ii);
+        else
+            bytes[ii] = static_cast<unsigned char>(state >> 16);
+    }
+    return bytes;
+}
+
+bool codecRoundTrips(const tiff::Codec& codec,
+                     const std::vector<unsigned char>& input,
+                     size_t rowSize)
+{
+    std::vector<unsigned char> encoded;
+    codec.encode(input.empty() ? NULL : &input[0], input.size(), rowSize,
+                 encoded);
+
+    std::vector<unsigned char> decoded(input.size() + 1, 0xFF);
+    codec.decode(encoded.empty() ? NULL : &encoded[0], encoded.size(),
+                 &decoded[0], input.size());
+    return std::equal(input.begin(), input.end(), decoded.begin()) &&
+           decoded.back() == 0xFF;
+}
+
+void writeImage(const std::string& pathname,
+                tiff::ImageWriter::ImageFormat imageFormat,
+                unsigned short compression,
+                unsigned short predictor,
+                const std::vector<unsigned short>& image,
+                size_t numThreads)
+{
+    tiff::FileWriter writer(pathname);
+    writer.writeHeader();
+
+    tiff::ImageWriter* const imageWriter = writer.addImage();
+    imageWriter->setImageFormat(imageFormat);
+    imageWriter->setIdealChunkSize(512);
+    imageWriter->setNumThreads(numThreads);
+
+    tiff::IFD* const ifd = imageWriter->getIFD();
+    ifd->addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                  static_cast<sys::Uint32_T>(COLS));
+    ifd->addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                  static_cast<sys::Uint32_T>(ROWS));
+    ifd->addEntry(tiff::KnownTags::PHOTOMETRIC_INTERPRETATION,
+                  static_cast<unsigned short>(
+                          tiff::Const::PhotoInterpType::BLACK_IS_ZERO));
+    ifd->addEntry(tiff::KnownTags::BITS_PER_SAMPLE,
+                  static_cast<unsigned short>(16));
+    ifd->addEntry(tiff::KnownTags::COMPRESSION, compression);
+    ifd->addEntry("Predictor", predictor);
+
+    // Write in uneven pieces so that rows of chunks fill part way.
+    const unsigned char* const data =
+            reinterpret_cast<const unsigned char*>(&image[0]);
+    const size_t pieceSize = 997;
+    for (size_t start = 0; start < image.size(); start += pieceSize)
+    {
+        const size_t numElements = std::min(pieceSize, image.size() - start);
+        imageWriter->putData(data + start * sizeof(unsigned short),
+                             static_cast<sys::Uint32_T>(numElements));
+    }
+    imageWriter->writeIFD();
+    writer.close();
+}
+
+void roundTrip(const std::string& testName,
+               tiff::ImageWriter::ImageFormat imageFormat,
+               unsigned short compression,
+               unsigned short predictor,
+               size_t numThreads = 1)
+{
+    std::vector<unsigned short> image(ROWS * COLS);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+        image[ii] = static_cast<unsigned short>((ii % COLS) * 11 + ii / 97);
+
+    const io::TempFile temp;
+    writeImage(temp.pathname(), imageFormat, compression, predictor, image,
+               numThreads);
+
+    tiff::FileReader reader(temp.pathname());
+    tiff::ImageReader& imageReader = *reader[0];
+
+    std::vector<unsigned short> readBack(image.size());
+    imageReader.getData(reinterpret_cast<unsigned char*>(&readBack[0]),
+                        static_cast<sys::Uint32_T>(readBack.size()));
+    TEST_ASSERT_TRUE(readBack == image);
+
+    const types::RowCol<size_t> offset(7, 9);
+    const types::RowCol<size_t> dims(31, 40);
+    std::vector<unsigned short> region(dims.area());
+    imageReader.readRegion(offset, dims,
+                           reinterpret_cast<unsigned char*>(&region[0]),
+                           numThreads);
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            TEST_ASSERT_EQ(region[row * dims.col + col],
+                           image[(offset.row + row) * COLS
+                                 + offset.col + col]);
+        }
+    }
+}
+
+#ifdef TIFF_HAVE_JPEG
+std::vector<unsigned char> makeSmoothImage(size_t numBands)
+{
+    // JPEG is lossy, so compare against smooth ramps it keeps close.
+    std::vector<unsigned char> image(ROWS * COLS * numBands);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        const size_t pixel = ii / numBands;
+        image[ii] = static_cast<unsigned char>(
+                pixel / COLS + pixel % COLS + (ii % numBands) * 40);
+    }
+    return image;
+}
+
+void writeJPEGImage(const std::string& pathname,
+                    tiff::ImageWriter::ImageFormat imageFormat,
+                    unsigned short photometric,
+                    size_t numBands,
+                    const std::vector<unsigned char>& image,
+                    size_t numThreads)
+{
+    tiff::FileWriter writer(pathname);
+    writer.writeHeader();
+
+    tiff::ImageWriter* const imageWriter = writer.addImage();
+    imageWriter->setImageFormat(imageFormat);
+    imageWriter->setIdealChunkSize(1024);
+    imageWriter->setNumThreads(numThreads);
+    imageWriter->setJPEGQuality(90);
+
+    tiff::IFD* const ifd = imageWriter->getIFD();
+    ifd->addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                  static_cast<sys::Uint32_T>(COLS));
+    ifd->addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                  static_cast<sys::Uint32_T>(ROWS));
+    ifd->addEntry(tiff::KnownTags::PHOTOMETRIC_INTERPRETATION, photometric);
+    ifd->addEntry(tiff::KnownTags::SAMPLES_PER_PIXEL,
+                  static_cast<unsigned short>(numBands));
+    ifd->addEntry(tiff::KnownTags::COMPRESSION,
+                  static_cast<unsigned short>(
+                          tiff::Const::CompressionType::JPEG));
+
+    imageWriter->putData(&image[0],
+                         static_cast<sys::Uint32_T>(ROWS * COLS));
+    imageWriter->writeIFD();
+    writer.close();
+}
+
+void jpegRoundTrip(const std::string& testName,
+                   tiff::ImageWriter::ImageFormat imageFormat,
+                   unsigned short photometric,
+                   size_t numBands,
+                   size_t numThreads = 1)
+{
+    const std::vector<unsigned char> image = makeSmoothImage(numBands);
+    const io::TempFile temp;
+    writeJPEGImage(temp.pathname(), imageFormat, photometric, numBands,
+                   image, numThreads);
+
+    tiff::FileReader reader(temp.pathname());
+    tiff::ImageReader& imageReader = *reader[0];
+    if (imageFormat == tiff::ImageWriter::STRIPPED)
+        TEST_ASSERT_EQ(
+                (*imageReader.getIFD())["RowsPerStrip"]->getUint64(0) % 16,
+                static_cast<sys::Uint64_T>(0));
+
+    std::vector<unsigned char> readBack(image.size());
+    imageReader.readRegion(types::RowCol<size_t>(0, 0),
+                           types::RowCol<size_t>(ROWS, COLS),
+                           &readBack[0], numThreads);
+    int maxDifference = 0;
+    for (size_t ii = 0; ii < image.size(); ++ii)
+        maxDifference = std::max(maxDifference,
+                                 std::abs(readBack[ii] - image[ii]));
+    TEST_ASSERT_LESSER_EQ(maxDifference, 8);
+}
+#endif
+
+TEST_CASE(testPackBitsKnownValue)
+{
+    // The example from Apple Technical Note TN1023
+    const unsigned char packed[] =
+    {
+        0xFE, 0xAA, 0x02, 0x80, 0x00, 0x2A, 0xFD, 0xAA, 0x03, 0x80, 0x00,
+        0x2A, 0x22, 0xF7, 0xAA
+    };
+    const unsigned char unpacked[] =
+    {
+        0xAA, 0xAA, 0xAA, 0x80, 0x00, 0x2A, 0xAA, 0xAA, 0xAA, 0xAA, 0x80,
+        0x00, 0x2A, 0x22, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA,
+        0xAA, 0xAA
+    };
+
+    unsigned char output[sizeof(unpacked)];
+    tiff::PackBitsCodec().decode(packed, sizeof(packed), output,
+                                 sizeof(output));
+    TEST_ASSERT_TRUE(std::equal(unpacked, unpacked + sizeof(unpacked),
+                                output));
+}
+
+TEST_CASE(testLZWKnownValue)
+{
+    // The example from section 13 of the TIFF 6.0 specification, coded
+    // as Clear, 7, 258, 8, 8, 258, 6, 6, EndOfInformation.
+    const unsigned char input[] = { 7, 7, 7, 8, 8, 7, 7, 6, 6 };
+    const unsigned char expected[] =
+    {
+        0x80, 0x01, 0xE0, 0x40, 0x80, 0x44, 0x08, 0x0C, 0x06, 0x80, 0x80
+    };
+
+    std::vector<unsigned char> encoded;
+    tiff::LZWCodec().encode(input, sizeof(input), sizeof(input), encoded);
+    TEST_ASSERT_EQ(encoded.size(), sizeof(expected));
+    TEST_ASSERT_TRUE(std::equal(expected, expected + sizeof(expected),
+                                encoded.begin()));
+
+    unsigned char output[sizeof(input)];
+    tiff::LZWCodec().decode(expected, sizeof(expected), output,
+                            sizeof(output));
+    TEST_ASSERT_TRUE(std::equal(input, input + sizeof(input), output));
+}
+
+TEST_CASE(testCodecRoundTrips)
+{
+    // Large enough for LZW to widen its codes and clear its table.
+    const std::vector<unsigned char> bytes = makeBytes(40000);
+    const std::vector<unsigned char> empty;
+
+    const tiff::Codec* const lzw =
+            tiff::getCodec(tiff::Const::CompressionType::LZW);
+    TEST_ASSERT_TRUE(codecRoundTrips(*lzw, bytes, 400));
+    TEST_ASSERT_TRUE(codecRoundTrips(*lzw, empty, 0));
+
+    const tiff::Codec* const packBits =
+            tiff::getCodec(tiff::Const::CompressionType::PACK_BITS);
+    TEST_ASSERT_TRUE(codecRoundTrips(*packBits, bytes, 400));
+    TEST_ASSERT_TRUE(codecRoundTrips(*packBits, bytes, 0));
+
+    const tiff::Codec* const deflate =
+            tiff::getCodec(tiff::Const::CompressionType::DEFLATE);
+    TEST_ASSERT_TRUE(codecRoundTrips(*deflate, bytes, 400));
+
+    TEST_ASSERT_TRUE(tiff::getCodec(
+            tiff::Const::CompressionType::NO_COMPRESSION) == NULL);
+    TEST_THROWS(tiff::getCodec(tiff::Const::CompressionType::CCITT_G4_FAX));
+}
+
+TEST_CASE(testTruncatedDataIsZeroFilled)
+{
+    const std::vector<unsigned char> bytes = makeBytes(1000);
+    std::vector<unsigned char> encoded;
+    tiff::PackBitsCodec().encode(&bytes[0], bytes.size(), 0, encoded);
+
+    std::vector<unsigned char> decoded(bytes.size() + 100, 0xFF);
+    tiff::PackBitsCodec().decode(&encoded[0], encoded.size(), &decoded[0],
+                                 decoded.size());
+    TEST_ASSERT_TRUE(std::equal(bytes.begin(), bytes.end(), decoded.begin()));
+    TEST_ASSERT_EQ(decoded.back(), 0);
+}
+
+TEST_CASE(testHorizontalPredictor)
+{
+    std::vector<sys::Uint16_T> samples(5 * 3 * 2);
+    for (size_t ii = 0; ii < samples.size(); ++ii)
+        samples[ii] = static_cast<sys::Uint16_T>(1000 - ii * ii);
+    const std::vector<sys::Uint16_T> original(samples);
+
+    unsigned char* const buffer =
+            reinterpret_cast<unsigned char*>(&samples[0]);
+    tiff::applyHorizontalPredictor(buffer, 5, 3, 2, sizeof(sys::Uint16_T));
+    TEST_ASSERT_EQ(samples[0], original[0]);
+    TEST_ASSERT_EQ(samples[3], static_cast<sys::Uint16_T>(
+            original[3] - original[1]));
+
+    tiff::undoHorizontalPredictor(buffer, 5, 3, 2, sizeof(sys::Uint16_T));
+    TEST_ASSERT_TRUE(samples == original);
+}
+
+TEST_CASE(testLZWStrips)
+{
+    roundTrip(testName, tiff::ImageWriter::STRIPPED,
+              tiff::Const::CompressionType::LZW,
+              tiff::Const::PredictorType::NONE);
+}
+
+TEST_CASE(testLZWTilesWithPredictor)
+{
+    roundTrip(testName, tiff::ImageWriter::TILED,
+              tiff::Const::CompressionType::LZW,
+              tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING);
+}
+
+TEST_CASE(testDeflateStripsWithPredictor)
+{
+    roundTrip(testName, tiff::ImageWriter::STRIPPED,
+              tiff::Const::CompressionType::DEFLATE,
+              tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING);
+}
+
+TEST_CASE(testDeflateTiles)
+{
+    roundTrip(testName, tiff::ImageWriter::TILED,
+              tiff::Const::CompressionType::DEFLATE,
+              tiff::Const::PredictorType::NONE);
+}
+
+TEST_CASE(testPackBitsTiles)
+{
+    roundTrip(testName, tiff::ImageWriter::TILED,
+              tiff::Const::CompressionType::PACK_BITS,
+              tiff::Const::PredictorType::NONE);
+}
+
+TEST_CASE(testParallelStrips)
+{
+    roundTrip(testName, tiff::ImageWriter::STRIPPED,
+              tiff::Const::CompressionType::DEFLATE,
+              tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING, 3);
+}
+
+TEST_CASE(testParallelTiles)
+{
+    roundTrip(testName, tiff::ImageWriter::TILED,
+              tiff::Const::CompressionType::LZW,
+              tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING, 4);
+}
+
+TEST_CASE(testParallelMatchesSerial)
+{
+    // The window only changes when chunks are compressed, not the file.
+    std::vector<unsigned short> image(ROWS * COLS);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+        image[ii] = static_cast<unsigned short>(ii * ii);
+
+    const io::TempFile serial;
+    const io::TempFile parallel;
+    writeImage(serial.pathname(), tiff::ImageWriter::TILED,
+               tiff::Const::CompressionType::LZW,
+               tiff::Const::PredictorType::NONE, image, 1);
+    writeImage(parallel.pathname(), tiff::ImageWriter::TILED,
+               tiff::Const::CompressionType::LZW,
+               tiff::Const::PredictorType::NONE, image, 3);
+
+    io::FileInputStream serialStream(serial.pathname());
+    io::FileInputStream parallelStream(parallel.pathname());
+    TEST_ASSERT_EQ(serialStream.available(), parallelStream.available());
+    std::vector<sys::byte> serialBytes(serialStream.available());
+    std::vector<sys::byte> parallelBytes(parallelStream.available());
+    serialStream.read(&serialBytes[0], serialBytes.size());
+    parallelStream.read(&parallelBytes[0], parallelBytes.size());
+    TEST_ASSERT_TRUE(serialBytes == parallelBytes);
+}
+}
+
+#ifdef TIFF_HAVE_JPEG
+TEST_CASE(testJPEGGrayTiles)
+{
+    jpegRoundTrip(testName, tiff::ImageWriter::TILED,
+                  tiff::Const::PhotoInterpType::BLACK_IS_ZERO, 1);
+}
+
+TEST_CASE(testJPEGYCbCrStrips)
+{
+    jpegRoundTrip(testName, tiff::ImageWriter::STRIPPED,
+                  tiff::Const::PhotoInterpType::YCBCR, 3, 3);
+}
+
+TEST_CASE(testJPEGRGBTiles)
+{
+    jpegRoundTrip(testName, tiff::ImageWriter::TILED,
+                  tiff::Const::PhotoInterpType::RGB, 3, 2);
+}
+
+TEST_CASE(testJPEGValidation)
+{
+    const io::TempFile temp;
+    tiff::FileWriter writer(temp.pathname());
+    writer.writeHeader();
+    tiff::ImageWriter* const imageWriter = writer.addImage();
+    tiff::IFD* const ifd = imageWriter->getIFD();
+    ifd->addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                  static_cast<sys::Uint32_T>(COLS));
+    ifd->addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                  static_cast<sys::Uint32_T>(ROWS));
+    ifd->addEntry(tiff::KnownTags::PHOTOMETRIC_INTERPRETATION,
+                  static_cast<unsigned short>(
+                          tiff::Const::PhotoInterpType::YCBCR));
+    ifd->addEntry(tiff::KnownTags::BITS_PER_SAMPLE,
+                  static_cast<unsigned short>(8));
+
+    // YCbCr is only written through JPEG, which needs 8-bit samples
+    // and does not take a predictor.
+    TEST_EXCEPTION(imageWriter->validate());
+
+    ifd->addEntry(tiff::KnownTags::COMPRESSION,
+                  static_cast<unsigned short>(
+                          tiff::Const::CompressionType::JPEG));
+    ifd->addEntry("Predictor",
+                  static_cast<unsigned short>(
+                          tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING));
+    TEST_EXCEPTION(imageWriter->validate());
+}
+#endif
+
+int main(int, char**)
+{
+    TEST_CHECK(testPackBitsKnownValue);
+    TEST_CHECK(testLZWKnownValue);
+    TEST_CHECK(testCodecRoundTrips);
+    TEST_CHECK(testTruncatedDataIsZeroFilled);
+    TEST_CHECK(testHorizontalPredictor);
+    TEST_CHECK(testLZWStrips);
+    TEST_CHECK(testLZWTilesWithPredictor);
+    TEST_CHECK(testDeflateStripsWithPredictor);
+    TEST_CHECK(testDeflateTiles);
+    TEST_CHECK(testPackBitsTiles);
+    TEST_CHECK(testParallelStrips);
+    TEST_CHECK(testParallelTiles);
+    TEST_CHECK(testParallelMatchesSerial);
+#ifdef TIFF_HAVE_JPEG
+    TEST_CHECK(testJPEGGrayTiles);
+    TEST_CHECK(testJPEGYCbCrStrips);
+    TEST_CHECK(testJPEGRGBTiles);
+    TEST_CHECK(testJPEGValidation);
+#endif
+    return 0;
+}
@@ -0,0 +1,153 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+#include <import/io.h>
+#include <io/TempFile.h>
+#include <import/tiff.h>
+#include <TestCase.h>
+
+namespace
+{
+TEST_CASE(testEntriesAreSorted)
+{
+    tiff::IFD ifd;
+    ifd.addEntry("TileWidth", static_cast<sys::Uint32_T>(256));
+    ifd.addEntry(tiff::KnownTags::IMAGE_WIDTH, static_cast<sys::Uint32_T>(7));
+    ifd.addEntry(tiff::KnownTags::COMPRESSION, static_cast<unsigned short>(1));
+    ifd.addEntry(tiff::KnownTags::IMAGE_WIDTH, static_cast<sys::Uint32_T>(9));
+
+    const std::vector<unsigned short> tags = ifd.getTags();
+    TEST_ASSERT_EQ(tags.size(), static_cast<size_t>(3));
+    TEST_ASSERT_EQ(tags[0], tiff::Const::Tag::IMAGE_WIDTH);
+    TEST_ASSERT_EQ(tags[1], tiff::Const::Tag::COMPRESSION);
+    TEST_ASSERT_EQ(tags[2], tiff::Const::Tag::TILE_WIDTH);
+
+    // Lookups by tag and by name find the same, replaced, entry.
+    tiff::IFDEntry* const width = ifd[tiff::Const::Tag::IMAGE_WIDTH];
+    TEST_ASSERT(width);
+    TEST_ASSERT_EQ(width, ifd[tiff::KnownTags::IMAGE_WIDTH]);
+    TEST_ASSERT_EQ(width->getUint64(0), static_cast<sys::Uint64_T>(9));
+    TEST_ASSERT_NULL(ifd[tiff::Const::Tag::TILE_LENGTH]);
+    TEST_ASSERT_NULL(ifd["NotATag"]);
+}
+
+TEST_CASE(testPackedValues)
+{
+    tiff::IFD ifd;
+    tiff::IFDEntry* const offsets =
+            ifd.addEntry(tiff::Const::Tag::STRIP_OFFSETS);
+    for (sys::Uint64_T ii = 0; ii < 1000; ++ii)
+        offsets->addUint64(ii * 70000);
+
+    TEST_ASSERT_EQ(offsets->getCount(), static_cast<sys::Uint64_T>(1000));
+    TEST_ASSERT_EQ(offsets->getData().size(),
+                   static_cast<size_t>(1000 * sizeof(sys::Uint32_T)));
+
+    std::vector<sys::Uint64_T> values;
+    offsets->getUint64Values(values);
+    TEST_ASSERT_EQ(values.size(), static_cast<size_t>(1000));
+    TEST_ASSERT_EQ(values[999], static_cast<sys::Uint64_T>(999 * 70000));
+
+    // The views match the packed values, and end with them.
+    TEST_ASSERT_EQ(static_cast<sys::Uint32_T>(
+            *(tiff::GenericType<sys::Uint32_T> *)(*offsets)[3]),
+                   static_cast<sys::Uint32_T>(3 * 70000));
+    TEST_ASSERT_NULL((*offsets)[1000]);
+
+    // Values added once the views exist are seen through them too.
+    offsets->addValue(tiff::TypeFactory::create(
+            reinterpret_cast<const unsigned char*>(&values[1]),
+            tiff::Const::Type::LONG));
+    offsets->addUint64(5);
+    TEST_ASSERT_EQ(offsets->getValues().size(), static_cast<size_t>(1002));
+    TEST_ASSERT_EQ(offsets->getUint64(1000), static_cast<sys::Uint64_T>(70000));
+    TEST_ASSERT_EQ(static_cast<sys::Uint32_T>(
+            *(tiff::GenericType<sys::Uint32_T> *)(*offsets)[1001]),
+                   static_cast<sys::Uint32_T>(5));
+
+    // BitsPerSample is a SHORT, so values are narrowed to two bytes.
+    tiff::IFDEntry* const bitsPerSample =
+            ifd.addEntry(tiff::Const::Tag::BITS_PER_SAMPLE);
+    bitsPerSample->addUint64(8);
+    bitsPerSample->addUint64(16);
+    TEST_ASSERT_EQ(bitsPerSample->getData().size(), static_cast<size_t>(4));
+    TEST_ASSERT_EQ(bitsPerSample->getUint64(1), static_cast<sys::Uint64_T>(16));
+    TEST_EXCEPTION(bitsPerSample->getUint64(2));
+
+    // An empty entry, as a malformed file may hold, has no first value.
+    tiff::IFDEntry* const compression =
+            ifd.addEntry(tiff::Const::Tag::COMPRESSION);
+    TEST_EXCEPTION(compression->getUint64(0));
+}
+
+TEST_CASE(testDeferredArrays)
+{
+    tiff::IFD ifd;
+    ifd.addEntry(tiff::KnownTags::IMAGE_WIDTH, static_cast<sys::Uint32_T>(7));
+    tiff::IFDEntry* const offsets =
+            ifd.addEntry(tiff::Const::Tag::TILE_OFFSETS);
+    for (sys::Uint64_T ii = 0; ii < 5000; ++ii)
+        offsets->addUint64(ii * 3);
+
+    const io::TempFile temp;
+    {
+        io::FileOutputStream output(temp.pathname());
+        ifd.serialize(output);
+    }
+    io::FileInputStream stream(temp.pathname());
+
+    // The small entry is read, but the offsets stay in the stream.
+    tiff::IFD readIFD;
+    readIFD.deserialize(stream, false, false, 1024);
+    const sys::Off_T position = stream.tell();
+
+    tiff::IFDEntry* const readWidth = readIFD[tiff::Const::Tag::IMAGE_WIDTH];
+    tiff::IFDEntry* const readOffsets =
+            readIFD[tiff::Const::Tag::TILE_OFFSETS];
+    TEST_ASSERT(readWidth->isLoaded());
+    TEST_ASSERT(!readOffsets->isLoaded());
+    TEST_ASSERT_EQ(readOffsets->getCount(), static_cast<sys::Uint64_T>(5000));
+
+    TEST_ASSERT_EQ(readOffsets->getUint64(4999),
+                   static_cast<sys::Uint64_T>(4999 * 3));
+    TEST_ASSERT(readOffsets->isLoaded());
+    TEST_ASSERT_EQ(stream.tell(), position);
+
+    // Without a deferral size, everything is read up front.
+    stream.seek(0, io::Seekable::START);
+    tiff::IFD eagerIFD;
+    eagerIFD.deserialize(stream, false, false);
+    TEST_ASSERT(eagerIFD[tiff::Const::Tag::TILE_OFFSETS]->isLoaded());
+    TEST_ASSERT(eagerIFD[tiff::Const::Tag::TILE_OFFSETS]->getData() ==
+                readOffsets->getData());
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testEntriesAreSorted);
+    TEST_CHECK(testPackedValues);
+    TEST_CHECK(testDeferredArrays);
+    return 0;
+}
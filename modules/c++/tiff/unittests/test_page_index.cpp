@@ -0,0 +1,173 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+#include <import/io.h>
+#include <import/sys.h>
+#include <io/TempFile.h>
+#include <import/tiff.h>
+#include <mt/BalancedRunnable1D.h>
+#include <TestCase.h>
+
+namespace
+{
+const size_t ROWS = 9;
+const size_t COLS = 13;
+
+// Writes a stack of pages, each filled with its page number.
+void writePages(const std::string& pathname, size_t numPages)
+{
+    tiff::FileWriter writer(pathname);
+    writer.writeHeader();
+
+    for (size_t page = 0; page < numPages; ++page)
+    {
+        tiff::ImageWriter* const imageWriter = writer.addImage();
+
+        tiff::IFD* const ifd = imageWriter->getIFD();
+        ifd->addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                      static_cast<sys::Uint32_T>(COLS));
+        ifd->addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                      static_cast<sys::Uint32_T>(ROWS));
+        ifd->addEntry(tiff::KnownTags::PHOTOMETRIC_INTERPRETATION,
+                      static_cast<unsigned short>(
+                              tiff::Const::PhotoInterpType::BLACK_IS_ZERO));
+        ifd->addEntry(tiff::KnownTags::BITS_PER_SAMPLE,
+                      static_cast<unsigned short>(16));
+
+        const std::vector<unsigned short> image(
+                ROWS * COLS, static_cast<unsigned short>(page));
+        imageWriter->putData(reinterpret_cast<const unsigned char*>(&image[0]),
+                             static_cast<sys::Uint32_T>(image.size()));
+        imageWriter->writeIFD();
+    }
+    writer.close();
+}
+
+bool pageMatches(tiff::FileReader& reader, size_t page)
+{
+    std::vector<unsigned short> image(ROWS * COLS);
+    reader[static_cast<sys::Uint32_T>(page)]->getData(
+            reinterpret_cast<unsigned char*>(&image[0]),
+            static_cast<sys::Uint32_T>(image.size()));
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        if (image[ii] != page)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct ReadPages
+{
+    ReadPages(tiff::FileReader& reader, std::vector<unsigned char>& matches) :
+        mReader(reader),
+        mMatches(matches)
+    {
+    }
+
+    void operator()(size_t page) const
+    {
+        mMatches[page] = pageMatches(mReader, page);
+    }
+
+    tiff::FileReader& mReader;
+    std::vector<unsigned char>& mMatches;
+};
+
+TEST_CASE(testParallelPages)
+{
+    const size_t numPages = 57;
+    const io::TempFile temp;
+    writePages(temp.pathname(), numPages);
+
+    // Each page is parsed by whichever thread reaches it first.
+    tiff::FileReader reader(temp.pathname());
+    TEST_ASSERT_EQ(reader.getImageCount(),
+                   static_cast<sys::Uint32_T>(numPages));
+
+    std::vector<unsigned char> matches(numPages, 0);
+    mt::runBalanced1D(numPages, 4, ReadPages(reader, matches));
+    for (size_t page = 0; page < numPages; ++page)
+    {
+        TEST_ASSERT_TRUE(matches[page] != 0);
+    }
+    TEST_EXCEPTION(reader[static_cast<sys::Uint32_T>(numPages)]);
+}
+
+TEST_CASE(testIndexFile)
+{
+    const io::TempFile temp;
+    const io::TempFile index;
+    writePages(temp.pathname(), 12);
+
+    // Without an index file, one is written...
+    {
+        tiff::FileReader reader(temp.pathname(), index.pathname());
+        TEST_ASSERT_EQ(reader.getImageCount(), static_cast<sys::Uint32_T>(12));
+    }
+    TEST_ASSERT_TRUE(sys::OS().exists(index.pathname()));
+    TEST_ASSERT_EQ(sys::OS().getSize(index.pathname()),
+                   static_cast<sys::Off_T>(32 + 12 * 8));
+
+    // ...and read back the next time.
+    {
+        tiff::FileReader reader(temp.pathname(), index.pathname());
+        TEST_ASSERT_EQ(reader.getImageCount(), static_cast<sys::Uint32_T>(12));
+        TEST_ASSERT_TRUE(pageMatches(reader, 0));
+        TEST_ASSERT_TRUE(pageMatches(reader, 11));
+    }
+
+    // An index that no longer matches its file is rewritten.
+    writePages(temp.pathname(), 5);
+    {
+        tiff::FileReader reader(temp.pathname(), index.pathname());
+        TEST_ASSERT_EQ(reader.getImageCount(), static_cast<sys::Uint32_T>(5));
+        TEST_ASSERT_TRUE(pageMatches(reader, 4));
+    }
+    TEST_ASSERT_EQ(sys::OS().getSize(index.pathname()),
+                   static_cast<sys::Off_T>(32 + 5 * 8));
+
+    // An index that can't be written doesn't stop the file opening.
+    {
+        tiff::FileReader reader(temp.pathname(),
+                                index.pathname() + "/missing/index");
+        TEST_ASSERT_EQ(reader.getImageCount(), static_cast<sys::Uint32_T>(5));
+    }
+
+    // A file that fails to open leaves the reader free to open another.
+    tiff::FileReader reader;
+    TEST_EXCEPTION(reader.openFile(index.pathname()));
+    reader.openFile(temp.pathname());
+    TEST_ASSERT_EQ(reader.getImageCount(), static_cast<sys::Uint32_T>(5));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testParallelPages);
+    TEST_CHECK(testIndexFile);
+    return 0;
+}
@@ -0,0 +1,272 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <import/io.h>
+#include <import/str.h>
+#include <io/TempFile.h>
+#include <import/tiff.h>
+#include <TestCase.h>
+
+namespace
+{
+const size_t ROWS = 150;
+const size_t COLS = 97;
+const size_t NUM_OVERVIEWS = 3;
+
+std::vector<unsigned short> makeImage()
+{
+    std::vector<unsigned short> image(ROWS * COLS);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+        image[ii] = static_cast<unsigned short>((ii % COLS) * 13 + ii / 89);
+    return image;
+}
+
+std::vector<sys::Uint64_T> getValues(tiff::IFD& ifd, const char* name)
+{
+    std::vector<sys::Uint64_T> values;
+    tiff::IFDEntry* const entry = ifd[name];
+    for (size_t ii = 0; entry && ii < entry->getValues().size(); ++ii)
+    {
+        values.push_back(str::toType<sys::Uint64_T>(
+                entry->getValues()[ii]->toString()));
+    }
+    return values;
+}
+
+void writePyramid(const std::string& pathname,
+                  tiff::FileWriter::Layout layout,
+                  unsigned short compression,
+                  const std::vector<unsigned short>& image,
+                  size_t numThreads = 1,
+                  std::vector<sys::Uint64_T>* tileOffsets = NULL)
+{
+    tiff::FileWriter writer(pathname);
+    writer.setLayout(layout);
+    writer.writeHeader();
+
+    tiff::ImageWriter* const imageWriter = writer.addImage();
+    imageWriter->setIdealChunkSize(512);
+
+    tiff::IFD* const ifd = imageWriter->getIFD();
+    ifd->addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                  static_cast<sys::Uint32_T>(COLS));
+    ifd->addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                  static_cast<sys::Uint32_T>(ROWS));
+    ifd->addEntry(tiff::KnownTags::PHOTOMETRIC_INTERPRETATION,
+                  static_cast<unsigned short>(
+                          tiff::Const::PhotoInterpType::BLACK_IS_ZERO));
+    ifd->addEntry(tiff::KnownTags::BITS_PER_SAMPLE,
+                  static_cast<unsigned short>(16));
+    ifd->addEntry(tiff::KnownTags::COMPRESSION, compression);
+    ifd->addEntry("Orientation", static_cast<unsigned short>(1));
+
+    writer.writePyramid(reinterpret_cast<const unsigned char*>(&image[0]),
+                        NUM_OVERVIEWS, tiff::OverviewKernel::AVERAGE,
+                        numThreads);
+
+    // The image added is still the full resolution level
+    if (tileOffsets)
+        *tileOffsets = getValues(*imageWriter->getIFD(), "TileOffsets");
+    writer.close();
+}
+
+// Reads back every level, checking it against overviews made in memory.
+void checkLevels(const std::string& testName,
+                 tiff::FileReader& reader,
+                 const std::vector<unsigned short>& image)
+{
+    TEST_ASSERT_EQ(reader.getImageCount(), NUM_OVERVIEWS + 1);
+
+    std::vector<unsigned short> expected(image);
+    size_t rows = ROWS;
+    size_t cols = COLS;
+    for (size_t level = 0; level <= NUM_OVERVIEWS; ++level)
+    {
+        if (level > 0)
+        {
+            std::vector<unsigned short> overview(
+                    tiff::getOverviewLength(rows)
+                    * tiff::getOverviewLength(cols));
+            tiff::createOverview(
+                    reinterpret_cast<const unsigned char*>(&expected[0]),
+                    rows, cols, 1, 16,
+                    tiff::Const::SampleFormatType::UNSIGNED_INT,
+                    tiff::OverviewKernel::AVERAGE,
+                    reinterpret_cast<unsigned char*>(&overview[0]));
+            expected.swap(overview);
+            rows = tiff::getOverviewLength(rows);
+            cols = tiff::getOverviewLength(cols);
+        }
+
+        tiff::ImageReader& imageReader = *reader[level];
+        tiff::IFD& ifd = *imageReader.getIFD();
+        TEST_ASSERT_EQ(ifd.getImageLength(), rows);
+        TEST_ASSERT_EQ(ifd.getImageWidth(), cols);
+        TEST_ASSERT_TRUE(ifd["Orientation"] != NULL);
+
+        const std::vector<sys::Uint64_T> subfileType =
+                getValues(ifd, "NewSubfileType");
+        if (level == 0)
+        {
+            TEST_ASSERT_TRUE(subfileType.empty());
+        }
+        else
+        {
+            TEST_ASSERT_EQ(subfileType.size(), static_cast<size_t>(1));
+            TEST_ASSERT_EQ(subfileType[0], static_cast<sys::Uint64_T>(1));
+            TEST_ASSERT_TRUE(imageReader.isTiled());
+        }
+
+        std::vector<unsigned short> readBack(expected.size());
+        imageReader.readRegion(types::RowCol<size_t>(0, 0),
+                               types::RowCol<size_t>(rows, cols),
+                               reinterpret_cast<unsigned char*>(&readBack[0]));
+        TEST_ASSERT_TRUE(readBack == expected);
+    }
+}
+
+TEST_CASE(testOverviewKernels)
+{
+    // A ramp across the columns shows where each kernel samples.
+    const size_t rows = 3;
+    const size_t cols = 6;
+    std::vector<float> image(rows * cols);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+        image[ii] = static_cast<float>((ii % cols) * 8);
+
+    const unsigned char* const input =
+            reinterpret_cast<const unsigned char*>(&image[0]);
+    std::vector<float> overview(2 * 3);
+    unsigned char* const output =
+            reinterpret_cast<unsigned char*>(&overview[0]);
+
+    tiff::createOverview(input, rows, cols, 1, 32,
+                         tiff::Const::SampleFormatType::IEEE_FLOAT,
+                         tiff::OverviewKernel::NEAREST, output);
+    TEST_ASSERT_EQ(overview[0], 0.0f);
+    TEST_ASSERT_EQ(overview[1], 16.0f);
+    TEST_ASSERT_EQ(overview[5], 32.0f);
+
+    tiff::createOverview(input, rows, cols, 1, 32,
+                         tiff::Const::SampleFormatType::IEEE_FLOAT,
+                         tiff::OverviewKernel::AVERAGE, output);
+    TEST_ASSERT_EQ(overview[0], 4.0f);
+    TEST_ASSERT_EQ(overview[1], 20.0f);
+    TEST_ASSERT_EQ(overview[5], 36.0f);
+
+    // The edges are clamped: (0 + 3 * 0 + 3 * 8 + 16) / 8 = 5 and
+    // (24 + 3 * 32 + 3 * 40 + 40) / 8 = 35.
+    tiff::createOverview(input, rows, cols, 1, 32,
+                         tiff::Const::SampleFormatType::IEEE_FLOAT,
+                         tiff::OverviewKernel::GAUSSIAN, output);
+    TEST_ASSERT_EQ(overview[0], 5.0f);
+    TEST_ASSERT_EQ(overview[1], 20.0f);
+    TEST_ASSERT_EQ(overview[2], 35.0f);
+    TEST_ASSERT_EQ(overview[5], 35.0f);
+}
+
+TEST_CASE(testOverviewRounding)
+{
+    // Two bands of signed bytes; the second is averaged across -3 and
+    // -2, which rounds to -2.
+    const signed char image[] = { 1, -3, 2, -2, 1, -3, 2, -2 };
+    signed char overview[2];
+    tiff::createOverview(reinterpret_cast<const unsigned char*>(image), 2, 2,
+                         2, 8, tiff::Const::SampleFormatType::SIGNED_INT,
+                         tiff::OverviewKernel::AVERAGE,
+                         reinterpret_cast<unsigned char*>(overview), 4);
+    TEST_ASSERT_EQ(overview[0], 2);
+    TEST_ASSERT_EQ(overview[1], -2);
+}
+
+TEST_CASE(testSequentialPyramid)
+{
+    const std::vector<unsigned short> image = makeImage();
+    const io::TempFile temp;
+    writePyramid(temp.pathname(), tiff::FileWriter::SEQUENTIAL,
+                 tiff::Const::CompressionType::LZW, image);
+
+    tiff::FileReader reader(temp.pathname());
+    checkLevels(testName, reader, image);
+    TEST_ASSERT_TRUE(!reader[0]->isTiled());
+}
+
+TEST_CASE(testCloudOptimizedPyramid)
+{
+    const std::vector<unsigned short> image = makeImage();
+    const unsigned short compressions[] =
+    {
+        tiff::Const::CompressionType::NO_COMPRESSION,
+        tiff::Const::CompressionType::LZW
+    };
+
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        const io::TempFile temp;
+        std::vector<sys::Uint64_T> tileOffsets;
+        writePyramid(temp.pathname(), tiff::FileWriter::CLOUD_OPTIMIZED,
+                     compressions[ii], image, 3, &tileOffsets);
+
+        tiff::FileReader reader(temp.pathname());
+        checkLevels(testName, reader, image);
+        TEST_ASSERT_TRUE(tileOffsets ==
+                         getValues(*reader[0]->getIFD(), "TileOffsets"));
+
+        // Every IFD comes before any data, and each level's tiles come
+        // after those of the smaller levels.
+        sys::Uint64_T lastIFD = reader.getHeader().getIFDOffset();
+        sys::Uint64_T previousStart = std::numeric_limits<sys::Uint64_T>::max();
+        for (size_t level = 0; level <= NUM_OVERVIEWS; ++level)
+        {
+            tiff::ImageReader& imageReader = *reader[level];
+            TEST_ASSERT_TRUE(imageReader.isTiled());
+            if (imageReader.getNextOffset() != 0)
+                lastIFD = imageReader.getNextOffset();
+
+            const std::vector<sys::Uint64_T> offsets =
+                    getValues(*imageReader.getIFD(), "TileOffsets");
+            const sys::Uint64_T start =
+                    *std::min_element(offsets.begin(), offsets.end());
+            const sys::Uint64_T end =
+                    *std::max_element(offsets.begin(), offsets.end());
+            TEST_ASSERT_TRUE(end < previousStart);
+            previousStart = start;
+        }
+        TEST_ASSERT_TRUE(lastIFD < previousStart);
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testOverviewKernels);
+    TEST_CHECK(testOverviewRounding);
+    TEST_CHECK(testSequentialPyramid);
+    TEST_CHECK(testCloudOptimizedPyramid);
+    return 0;
+}
@@ -0,0 +1,235 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <vector>
+
+#include <import/io.h>
+#include <io/TempFile.h>
+#include <import/tiff.h>
+#include <mt/BalancedRunnable1D.h>
+#include <TestCase.h>
+
+namespace
+{
+const size_t ROWS = 41;
+const size_t COLS = 67;
+
+void writeImage(const std::string& pathname,
+                tiff::ImageWriter::ImageFormat imageFormat,
+                const std::vector<unsigned short>& image)
+{
+    tiff::FileWriter writer(pathname);
+    writer.writeHeader();
+
+    tiff::ImageWriter* const imageWriter = writer.addImage();
+    imageWriter->setImageFormat(imageFormat);
+    imageWriter->setIdealChunkSize(512);
+
+    tiff::IFD* const ifd = imageWriter->getIFD();
+    ifd->addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                  static_cast<sys::Uint32_T>(COLS));
+    ifd->addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                  static_cast<sys::Uint32_T>(ROWS));
+    ifd->addEntry(tiff::KnownTags::PHOTOMETRIC_INTERPRETATION,
+                  static_cast<unsigned short>(
+                          tiff::Const::PhotoInterpType::BLACK_IS_ZERO));
+    ifd->addEntry(tiff::KnownTags::BITS_PER_SAMPLE,
+                  static_cast<unsigned short>(16));
+
+    imageWriter->putData(reinterpret_cast<const unsigned char*>(&image[0]),
+                         static_cast<sys::Uint32_T>(image.size()));
+    imageWriter->writeIFD();
+    writer.close();
+}
+
+std::vector<unsigned short> makeImage()
+{
+    std::vector<unsigned short> image(ROWS * COLS);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<unsigned short>(ii * 3 + 1);
+    }
+    return image;
+}
+
+bool regionMatches(tiff::ImageReader& imageReader,
+                   const std::vector<unsigned short>& image,
+                   const types::RowCol<size_t>& offset,
+                   const types::RowCol<size_t>& dims)
+{
+    std::vector<unsigned short> region(dims.area());
+    imageReader.readRegion(offset, dims,
+                           reinterpret_cast<unsigned char*>(&region[0]));
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            if (region[row * dims.col + col] !=
+                image[(offset.row + row) * COLS + offset.col + col])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+struct ReadRegionRows
+{
+    ReadRegionRows(tiff::ImageReader& imageReader,
+                   const std::vector<unsigned short>& image,
+                   std::vector<unsigned char>& matches) :
+        mImageReader(imageReader),
+        mImage(image),
+        mMatches(matches)
+    {
+    }
+
+    void operator()(size_t row) const
+    {
+        mMatches[row] = regionMatches(mImageReader, mImage,
+                                      types::RowCol<size_t>(row, 5),
+                                      types::RowCol<size_t>(1, COLS - 9));
+    }
+
+    tiff::ImageReader& mImageReader;
+    const std::vector<unsigned short>& mImage;
+    std::vector<unsigned char>& mMatches;
+};
+
+TEST_CASE(testReadTile)
+{
+    const std::vector<unsigned short> image = makeImage();
+    const io::TempFile temp;
+    writeImage(temp.pathname(), tiff::ImageWriter::TILED, image);
+
+    tiff::FileReader reader(temp.pathname());
+    tiff::ImageReader& imageReader = *reader[0];
+    TEST_ASSERT_TRUE(imageReader.isTiled());
+
+    const size_t tileWidth = imageReader.getTileWidth();
+    const size_t tileLength = imageReader.getTileLength();
+    TEST_ASSERT_EQ(imageReader.getTilesAcross(),
+                   (COLS + tileWidth - 1) / tileWidth);
+    TEST_ASSERT_EQ(imageReader.getTilesDown(),
+                   (ROWS + tileLength - 1) / tileLength);
+
+    // Read the tiles out of order; each read must stand on its own.
+    std::vector<unsigned short> tile(tileWidth * tileLength);
+    for (size_t tileRow = imageReader.getTilesDown(); tileRow-- > 0;)
+    {
+        for (size_t tileCol = imageReader.getTilesAcross(); tileCol-- > 0;)
+        {
+            imageReader.readTile(tileRow, tileCol,
+                                 reinterpret_cast<unsigned char*>(&tile[0]));
+            for (size_t row = 0; row < tileLength; ++row)
+            {
+                const size_t imageRow = tileRow * tileLength + row;
+                for (size_t col = 0; col < tileWidth; ++col)
+                {
+                    const size_t imageCol = tileCol * tileWidth + col;
+                    if (imageRow < ROWS && imageCol < COLS)
+                    {
+                        TEST_ASSERT_EQ(tile[row * tileWidth + col],
+                                       image[imageRow * COLS + imageCol]);
+                    }
+                }
+            }
+        }
+    }
+
+    TEST_THROWS(imageReader.readTile(imageReader.getTilesDown(), 0,
+            reinterpret_cast<unsigned char*>(&tile[0])));
+}
+
+TEST_CASE(testReadRegionTiled)
+{
+    const std::vector<unsigned short> image = makeImage();
+    const io::TempFile temp;
+    writeImage(temp.pathname(), tiff::ImageWriter::TILED, image);
+
+    tiff::FileReader reader(temp.pathname());
+    tiff::ImageReader& imageReader = *reader[0];
+
+    TEST_ASSERT_TRUE(regionMatches(imageReader, image,
+                                   types::RowCol<size_t>(0, 0),
+                                   types::RowCol<size_t>(ROWS, COLS)));
+    TEST_ASSERT_TRUE(regionMatches(imageReader, image,
+                                   types::RowCol<size_t>(13, 7),
+                                   types::RowCol<size_t>(19, 41)));
+    TEST_ASSERT_TRUE(regionMatches(imageReader, image,
+                                   types::RowCol<size_t>(ROWS - 1, COLS - 1),
+                                   types::RowCol<size_t>(1, 1)));
+
+    std::vector<unsigned short> region(4);
+    TEST_THROWS(imageReader.readRegion(
+            types::RowCol<size_t>(ROWS - 1, 0),
+            types::RowCol<size_t>(2, 2),
+            reinterpret_cast<unsigned char*>(&region[0])));
+}
+
+TEST_CASE(testReadRegionStripped)
+{
+    const std::vector<unsigned short> image = makeImage();
+    const io::TempFile temp;
+    writeImage(temp.pathname(), tiff::ImageWriter::STRIPPED, image);
+
+    tiff::FileReader reader(temp.pathname());
+    tiff::ImageReader& imageReader = *reader[0];
+    TEST_ASSERT_FALSE(imageReader.isTiled());
+    TEST_ASSERT_EQ(imageReader.getTilesAcross(), 1);
+    TEST_ASSERT_EQ(imageReader.getTileWidth(), COLS);
+
+    TEST_ASSERT_TRUE(regionMatches(imageReader, image,
+                                   types::RowCol<size_t>(0, 0),
+                                   types::RowCol<size_t>(ROWS, COLS)));
+    TEST_ASSERT_TRUE(regionMatches(imageReader, image,
+                                   types::RowCol<size_t>(ROWS - 3, 11),
+                                   types::RowCol<size_t>(3, 20)));
+}
+
+TEST_CASE(testConcurrentReadRegion)
+{
+    const std::vector<unsigned short> image = makeImage();
+    const io::TempFile temp;
+    writeImage(temp.pathname(), tiff::ImageWriter::TILED, image);
+
+    tiff::FileReader reader(temp.pathname());
+    std::vector<unsigned char> matches(ROWS, 0);
+    mt::runBalanced1D(ROWS, 4, ReadRegionRows(*reader[0], image, matches));
+
+    for (size_t row = 0; row < ROWS; ++row)
+    {
+        TEST_ASSERT_TRUE(matches[row] != 0);
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testReadTile);
+    TEST_CHECK(testReadRegionTiled);
+    TEST_CHECK(testReadRegionStripped);
+    TEST_CHECK(testConcurrentReadRegion);
+    return 0;
+}
@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <limits>
+#include <map>
 
 #include <types/Range.h>
 
@@ -43,12 +44,15 @@ namespace types
  *   |-------------------------------------------------------------->
  *   0                                                         max(size_t)
  *
- * Many of the operations are O(N), where N is the number of ranges in the
- * collection. As a result, caution should be taken when using this class
- * that N does not grow large enough to begin having a noticeable impact.
+ * The ranges are held in a balanced binary tree keyed by mStartElement, so
+ * inserting, removing and looking up a range is O(log N), where N is the
+ * number of ranges in the collection, plus the number of ranges that get
+ * merged or split.  Building from sorted ranges, and the set operations
+ * between two lists, walk the ranges in order and are linear.
  *
- * TODO: Take a look at replacing the internals with some interval list
- *       structure.
+ * getRanges() flattens the tree into a new vector, which is O(N).  Code
+ * that interleaves many modifications with queries should use contains()
+ * and friends instead.
  */
 class RangeList
 {
@@ -70,7 +74,8 @@ public:
      *
      * Initial ranges do not need to be disjoint, as insert() will be
      * called for each element in 'ranges', and consequently performing any
-     * merges that need to occur.
+     * merges that need to occur.  If 'ranges' is sorted by mStartElement,
+     * the list is built in O(N).
      *
      * \param ranges Initial ranges
      */
@@ -79,7 +84,8 @@ public:
     /*!
      * Insert a range of size 1 at the given point
      *
-     * O(N) operation, where N is the number of ranges already in the list.
+     * O(log N) operation, where N is the number of ranges already in the
+     * list.
      * If point overlaps/touches existing ranges, they will be merged.
      *
      * \param point The point to insert
@@ -92,7 +98,8 @@ public:
     /*!
      * Insert a range
      *
-     * O(N) operation, where N is the number of ranges already in the list.
+     * O(log N + K) operation, where N is the number of ranges already in the
+     * list and K is the number of ranges merged into 'range'.
      * If range overlaps/touches existing ranges, they will be merged.
      * In set notation, the resulting list will be union(L, range), where
      * L is the the original list of ranges.
@@ -118,8 +125,10 @@ public:
     /*!
      * Insert a vector of ranges.
      *
-     * O(M*N) operation, M is the size of 'ranges', and
-     * N is the number of ranges already in the list.
+     * O(M*log(N)) operation, M is the size of 'ranges', and
+     * N is the number of ranges already in the list.  If 'ranges' is sorted
+     * by mStartElement and M*log(N) exceeds N, the two are merged in
+     * O(M + N) instead.
      *
      * Will merge overlapping/touching ranges.
      *
@@ -130,7 +139,7 @@ public:
     /*!
      * Remove a range of size 1 at the given point
      *
-     * O(N) operation, where N is the number of ranges in the list
+     * O(log N) operation, where N is the number of ranges in the list
      * If point lies inside a range, the range will be split in two.
      *
      * \param point The point to remove
@@ -143,7 +152,8 @@ public:
     /*!
      * Remove a range from the list
      *
-     * O(N) operation, where N is the number of ranges already in the list.
+     * O(log N + K) operation, where N is the number of ranges already in the
+     * list and K is the number of ranges 'range' overlaps.
      * In set notation, the resulting list will be L - intersection(L, range),
      * where L is the original list of ranges.
      *
@@ -168,7 +178,7 @@ public:
     /*!
      * Remove a vector of ranges
      *
-     * O(M*N) operation, M is the size of 'ranges', and
+     * O(M*log(N)) operation, M is the size of 'ranges', and
      * N is the number of ranges in the list.
      *
      * \param ranges Vector of ranges to remove
@@ -180,14 +190,17 @@ public:
      */
     size_t getNumRanges() const
     {
-        return mRangeList.size();
+        return mRanges.size();
     }
 
     /*!
      * \returns the total number elements as the sum(R.mNumElements) for
      *          all ranges R in the list
      */
-    size_t getTotalNumElements() const;
+    size_t getTotalNumElements() const
+    {
+        return mTotalNumElements;
+    }
 
     /*!
      * \returns true if getTotalNumElements() == 0
@@ -197,18 +210,43 @@ public:
         return getTotalNumElements() == 0;
     }
 
+    /*!
+     * O(log N) operation, where N is the number of ranges in the list
+     *
+     * \param point The point to look up
+     *
+     * \returns true if a range in the list contains 'point'
+     */
+    bool contains(size_t point) const;
+
+    /*!
+     * O(log N) operation, where N is the number of ranges in the list
+     *
+     * \param range The range to look up
+     *
+     * \returns true if every element of 'range' is in the list.  An empty
+     *          range is always contained.
+     */
+    bool containsAll(const types::Range& range) const;
+
+    /*!
+     * O(log N) operation, where N is the number of ranges in the list
+     *
+     * \param range The range to look up
+     *
+     * \returns true if any element of 'range' is in the list
+     */
+    bool overlaps(const types::Range& range) const;
+
     /*!
      * Get the vector of ranges that compose the range list
      *
-     * Note that remove()/insert()/expand() will invalidate the
-     * returned reference.
+     * O(N) operation, where N is the number of ranges in the list.  The
+     * vector is a copy, so it isn't affected by later changes to the list.
      *
      * \return the vector of ranges composing the range list
      */
-    const std::vector<types::Range>& getRanges() const
-    {
-        return mRangeList;
-    }
+    std::vector<types::Range> getRanges() const;
 
     /*!
      * Expand all ranges in the list by the given expansion factor, applied
@@ -251,9 +289,50 @@ public:
      */
     RangeList intersect(const RangeList& other) const;
 
+    /*!
+     * Determine a new range list that is the union of the current list and
+     * another RangeList.  Overlapping and touching ranges are merged.
+     *
+     * O(N + M) operation, where N and M are the number of ranges in
+     * the two lists.
+     *
+     * \param other RangeList to unite with
+     * \returns new RangeList that is the union of this and other
+     */
+    RangeList unite(const RangeList& other) const;
+
+    //! Exchanges the contents of this list and 'other'
+    void swap(RangeList& other);
+
+    //! \returns true if both lists hold the same ranges
+    bool operator==(const RangeList& rhs) const
+    {
+        return mRanges == rhs.mRanges;
+    }
+
+    //! \returns false if both lists hold the same ranges
+    bool operator!=(const RangeList& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
 private:
     using List = std::vector<types::Range>;
-    List mRangeList;
+
+    // Start element -> end element (exclusive) of each range
+    using Tree = std::map<size_t, size_t>;
+
+    // Appends [start, end), which must not start before the last range,
+    // merging it into the last range if they touch or overlap
+    void append(size_t start, size_t end);
+
+    void erase(Tree::iterator first, Tree::iterator last);
+
+    // Tracks the ranges, replacing any current ones, from sorted 'ranges'
+    void assignSorted(const List& ranges);
+
+    Tree mRanges;
+    size_t mTotalNumElements = 0;
 };
 }
 
@@ -20,133 +20,165 @@
  *
  */
 #include <algorithm>
+#include <iterator>
 
 #include <types/RangeList.h>
 
 namespace
 {
-std::vector<types::Range>
-difference(const types::Range& orig, const types::Range& overlap)
+bool isSorted(const std::vector<types::Range>& ranges)
 {
-    // If the original range is fully contained by the overlap,
-    // the difference is the empty set
-    if (overlap.containsAll(orig.mStartElement, orig.mNumElements))
+    for (size_t ii = 1; ii < ranges.size(); ++ii)
     {
-        return {};
-    }
-
-    std::vector<types::Range> result;
-
-    // Create left range
-    if (orig.mStartElement < overlap.mStartElement)
-    {
-        result.emplace_back(
-                orig.mStartElement,
-                overlap.mStartElement - orig.mStartElement);
+        if (ranges[ii].mStartElement < ranges[ii - 1].mStartElement)
+        {
+            return false;
+        }
     }
+    return true;
+}
 
-    // Create right range
-    if (orig.endElement() > overlap.endElement())
+size_t log2Ceil(size_t value)
+{
+    size_t bits = 0;
+    while (value > 1)
     {
-        result.emplace_back(
-                overlap.endElement(),
-                orig.endElement() - overlap.endElement());
+        value = (value + 1) / 2;
+        ++bits;
     }
-    return result;
+    return bits;
 }
 }
 
 namespace types
 {
-RangeList::RangeList(const types::Range& range) :
-    mRangeList(0)
+RangeList::RangeList(const types::Range& range)
 {
     insert(range);
 }
 
-RangeList::RangeList(const std::vector<types::Range>& ranges) :
-    mRangeList(0)
+RangeList::RangeList(const std::vector<types::Range>& ranges)
 {
-    for (const auto& inputRange : ranges)
-    {
-        insert(inputRange);
-    }
+    insert(ranges);
 }
 
-size_t RangeList::getTotalNumElements() const
+std::vector<types::Range> RangeList::getRanges() const
 {
-    size_t count = 0;
-    for (const auto& range : mRangeList)
+    List ranges;
+    ranges.reserve(mRanges.size());
+    for (const auto& range : mRanges)
     {
-        count += range.mNumElements;
+        ranges.emplace_back(range.first, range.second - range.first);
     }
-    return count;
+    return ranges;
 }
 
-void RangeList::insert(const std::vector<types::Range>& ranges)
+void RangeList::append(size_t start, size_t end)
 {
-    for (const auto& range : ranges)
+    if (start >= end)
     {
-        insert(range);
+        return;
     }
+
+    if (!mRanges.empty())
+    {
+        size_t& backEnd = mRanges.rbegin()->second;
+        if (start <= backEnd)
+        {
+            if (end > backEnd)
+            {
+                mTotalNumElements += end - backEnd;
+                backEnd = end;
+            }
+            return;
+        }
+    }
+
+    mRanges.emplace_hint(mRanges.end(), start, end);
+    mTotalNumElements += end - start;
 }
 
-void RangeList::insert(const types::Range& range)
+void RangeList::erase(Tree::iterator first, Tree::iterator last)
 {
-    if (range.empty())
+    for (Tree::iterator iter = first; iter != last; ++iter)
     {
-        return;
+        mTotalNumElements -= iter->second - iter->first;
     }
+    mRanges.erase(first, last);
+}
 
-    if (mRangeList.empty())
+void RangeList::assignSorted(const List& ranges)
+{
+    mRanges.clear();
+    mTotalNumElements = 0;
+    for (const auto& range : ranges)
     {
-        mRangeList.push_back(range);
-        return;
+        append(range.mStartElement, range.endElement());
     }
+}
 
-    std::vector<types::Range> newList;
-    newList.reserve(mRangeList.size() + 1);
-
-    // TODO: This can be sped up with a log(N) binary search and an insert
-    //       into the newList from mRangeList
-    size_t ii = 0;
-    for (; ii < mRangeList.size(); ++ii)
+void RangeList::insert(const std::vector<types::Range>& ranges)
+{
+    // Merging sorted input walks both lists once, which beats M tree
+    // insertions unless the input is small next to the list
+    if (ranges.size() * log2Ceil(mRanges.size()) >= mRanges.size() &&
+        isSorted(ranges))
     {
-        if (mRangeList[ii].endElement() < range.mStartElement)
+        RangeList other;
+        other.assignSorted(ranges);
+        if (mRanges.empty())
         {
-            newList.push_back(mRangeList[ii]);
+            swap(other);
         }
         else
         {
-            break;
+            *this = unite(other);
         }
+        return;
     }
 
-    newList.push_back(range);
-
-    for (; ii < mRangeList.size(); ++ii)
+    for (const auto& range : ranges)
     {
-        const types::Range& oldRange = mRangeList[ii];
-        types::Range& backRange = newList.back();
+        insert(range);
+    }
+}
 
-        if (backRange.overlaps(oldRange) || backRange.touches(oldRange))
-        {
-            const size_t start = std::min<size_t>(backRange.mStartElement,
-                                                  oldRange.mStartElement);
+void RangeList::insert(const types::Range& range)
+{
+    if (range.empty())
+    {
+        return;
+    }
 
-            const size_t end = std::max<size_t>(backRange.endElement(),
-                                                oldRange.endElement());
+    size_t start = range.mStartElement;
+    size_t end = range.endElement();
 
-            backRange.mStartElement = start;
-            backRange.mNumElements = end - start;
-        }
-        else
+    // The first range that could touch or overlap is the last one starting
+    // at or before 'start'
+    Tree::iterator first = mRanges.upper_bound(start);
+    if (first != mRanges.begin())
+    {
+        Tree::iterator previous = std::prev(first);
+        if (previous->second >= start)
         {
-            newList.push_back(oldRange);
+            if (previous->second >= end)
+            {
+                return;
+            }
+            first = previous;
+            start = previous->first;
         }
     }
 
-    mRangeList.swap(newList);
+    Tree::iterator last = first;
+    for (; last != mRanges.end() && last->first <= end; ++last)
+    {
+        end = std::max(end, last->second);
+    }
+
+    erase(first, last);
+    mRanges.emplace_hint(last, start, end);
+    mTotalNumElements += end - start;
 }
 
 void RangeList::remove(const std::vector<types::Range>& ranges)
@@ -164,28 +196,71 @@ void RangeList::remove(const types::Range& range)
         return;
     }
 
-    std::vector<types::Range> newList;
-    newList.reserve(mRangeList.size() + 1);
+    const size_t start = range.mStartElement;
+    const size_t end = range.endElement();
+
+    Tree::iterator first = mRanges.upper_bound(start);
+    if (first != mRanges.begin() && std::prev(first)->second > start)
+    {
+        --first;
+    }
+
+    Tree::iterator last = first;
+    for (; last != mRanges.end() && last->first < end; ++last)
+    {
+    }
+
+    if (first == last)
+    {
+        return;
+    }
+
+    // Whatever sticks out either side of 'range' survives
+    const size_t leftStart = first->first;
+    const size_t rightEnd = std::prev(last)->second;
 
-    for (const auto& oldRange : mRangeList)
+    erase(first, last);
+    if (leftStart < start)
     {
-        types::Range overlap;
-        const bool isOverlapping = oldRange.overlaps(range, overlap);
+        mRanges.emplace_hint(last, leftStart, start);
+        mTotalNumElements += start - leftStart;
+    }
+    if (rightEnd > end)
+    {
+        mRanges.emplace_hint(last, end, rightEnd);
+        mTotalNumElements += rightEnd - end;
+    }
+}
 
-        if (isOverlapping)
-        {
-            for (const auto& diff : difference(oldRange, overlap))
-            {
-                newList.push_back(diff);
-            }
-        }
-        else
-        {
-            newList.push_back(oldRange);
-        }
+bool RangeList::contains(size_t point) const
+{
+    Tree::const_iterator iter = mRanges.upper_bound(point);
+    return iter != mRanges.begin() && std::prev(iter)->second > point;
+}
+
+bool RangeList::containsAll(const types::Range& range) const
+{
+    if (range.empty())
+    {
+        return true;
     }
 
-    mRangeList.swap(newList);
+    // Ranges are disjoint and never touch, so one range must hold it all
+    Tree::const_iterator iter = mRanges.upper_bound(range.mStartElement);
+    return iter != mRanges.begin() &&
+            std::prev(iter)->second >= range.endElement();
+}
+
+bool RangeList::overlaps(const types::Range& range) const
+{
+    if (range.empty())
+    {
+        return false;
+    }
+
+    Tree::const_iterator iter = mRanges.lower_bound(range.endElement());
+    return iter != mRanges.begin() &&
+            std::prev(iter)->second > range.mStartElement;
 }
 
 void RangeList::expand(size_t expansion, size_t maxEndElement)
@@ -195,43 +270,40 @@ void RangeList::expand(size_t expansion, size_t maxEndElement)
         return;
     }
 
-    const List oldRanges = getRanges();
-    mRangeList.clear();
-
-    for (const auto& range : oldRanges)
+    // Expanding every range by the same amount keeps them sorted, so only
+    // neighbors can merge
+    RangeList expanded;
+    for (const auto& range : mRanges)
     {
         const size_t start =
-                (range.mStartElement >= expansion) ?
-                range.mStartElement - expansion : 0;
+                (range.first >= expansion) ? range.first - expansion : 0;
 
-        const size_t end =
-                std::min(range.endElement() + expansion, maxEndElement);
+        const size_t end = std::min(range.second + expansion, maxEndElement);
 
-        insert(types::Range(start, end - start));
+        expanded.append(start, end);
     }
+    swap(expanded);
 }
 
 RangeList RangeList::intersect(const RangeList& other) const
 {
     RangeList output;
-    auto iterA = std::begin(getRanges());
-    auto iterB = std::begin(other.getRanges());
-    const auto endIterA = std::end(getRanges());
-    const auto endIterB = std::end(other.getRanges());
+    auto iterA = std::begin(mRanges);
+    auto iterB = std::begin(other.mRanges);
+    const auto endIterA = std::end(mRanges);
+    const auto endIterB = std::end(other.mRanges);
 
     while ((iterA != endIterA) && (iterB != endIterB))
     {
-        const size_t start =
-                std::max<size_t>(iterA->mStartElement, iterB->mStartElement);
-        const size_t end =
-                std::min<size_t>(iterA->endElement(), iterB->endElement());
+        const size_t start = std::max<size_t>(iterA->first, iterB->first);
+        const size_t end = std::min<size_t>(iterA->second, iterB->second);
 
         if (start < end)
         {
-            output.insert(types::Range(start, end - start));
+            output.append(start, end);
         }
 
-        if (iterA->endElement() < iterB->endElement())
+        if (iterA->second < iterB->second)
         {
             ++iterA;
         }
@@ -243,4 +315,36 @@ RangeList RangeList::intersect(const RangeList& other) const
 
     return output;
 }
+
+RangeList RangeList::unite(const RangeList& other) const
+{
+    RangeList output;
+    auto iterA = std::begin(mRanges);
+    auto iterB = std::begin(other.mRanges);
+    const auto endIterA = std::end(mRanges);
+    const auto endIterB = std::end(other.mRanges);
+
+    while ((iterA != endIterA) || (iterB != endIterB))
+    {
+        if (iterB == endIterB ||
+            (iterA != endIterA && iterA->first < iterB->first))
+        {
+            output.append(iterA->first, iterA->second);
+            ++iterA;
+        }
+        else
+        {
+            output.append(iterB->first, iterB->second);
+            ++iterB;
+        }
+    }
+
+    return output;
+}
+
+void RangeList::swap(RangeList& other)
+{
+    mRanges.swap(other.mRanges);
+    std::swap(mTotalNumElements, other.mTotalNumElements);
+}
 }
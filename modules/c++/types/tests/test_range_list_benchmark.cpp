@@ -0,0 +1,137 @@
+/* =========================================================================
+ * This file is part of types-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, Radiant Geospatial Solutions
+ *
+ * types-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Users guide
+
+    Times RangeList bookkeeping of many small ranges: random inserts and
+    removes, point lookups, building from sorted ranges, and the set
+    operations between two large lists.
+
+    usage: test_range_list_benchmark [numRanges]
+        numRanges: number of ranges inserted (default 100000)
+
+    Throughput is reported in millions of ranges per second.
+*/
+
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sys.h>
+#include <str/Convert.h>
+#include <types/RangeList.h>
+
+namespace
+{
+void report(const std::string& name, size_t size, double millis)
+{
+    std::cout << std::setw(28) << name << std::setw(12) << std::fixed
+              << std::setprecision(2) << size / (millis / 1000.0) / 1e6
+              << std::endl;
+}
+
+// Short ranges scattered over ten times as many elements as they cover,
+// so that most of them stay disjoint
+std::vector<types::Range> randomRanges(size_t numRanges)
+{
+    std::vector<types::Range> ranges(numRanges);
+    for (size_t ii = 0; ii < numRanges; ++ii)
+    {
+        const size_t start =
+                static_cast<size_t>(rand()) * RAND_MAX + rand();
+        ranges[ii] = types::Range(start % (numRanges * 100),
+                                  1 + rand() % 10);
+    }
+    return ranges;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t numRanges =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 100000;
+
+        srand(1);
+        const std::vector<types::Range> ranges = randomRanges(numRanges);
+        std::vector<types::Range> sorted = randomRanges(numRanges);
+        std::sort(sorted.begin(), sorted.end());
+
+        std::cout << numRanges << " ranges (million ranges/s)\n\n";
+
+        sys::RealTimeStopWatch watch;
+        watch.start();
+        types::RangeList rangeList;
+        for (size_t ii = 0; ii < ranges.size(); ++ii)
+        {
+            rangeList.insert(ranges[ii]);
+        }
+        report("insert", numRanges, watch.stop());
+
+        watch.clear();
+        watch.start();
+        size_t numContained = 0;
+        for (size_t ii = 0; ii < sorted.size(); ++ii)
+        {
+            numContained += rangeList.contains(sorted[ii].mStartElement);
+        }
+        report("contains", numRanges, watch.stop());
+
+        watch.clear();
+        watch.start();
+        const types::RangeList other(sorted);
+        report("build from sorted", numRanges, watch.stop());
+
+        watch.clear();
+        watch.start();
+        const types::RangeList intersection = rangeList.intersect(other);
+        report("intersect", 2 * numRanges, watch.stop());
+
+        watch.clear();
+        watch.start();
+        const types::RangeList united = rangeList.unite(other);
+        report("unite", 2 * numRanges, watch.stop());
+
+        watch.clear();
+        watch.start();
+        for (size_t ii = 0; ii < sorted.size(); ++ii)
+        {
+            rangeList.remove(sorted[ii]);
+        }
+        report("remove", numRanges, watch.stop());
+
+        std::cout << "\n" << numContained << " points contained, "
+                  << intersection.getNumRanges() << " ranges intersected, "
+                  << united.getNumRanges() << " ranges united, "
+                  << rangeList.getNumRanges() << " ranges left\n";
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -19,6 +19,8 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <stdlib.h>
+#include <algorithm>
 #include <vector>
 
 #include "TestCase.h"
@@ -26,6 +28,57 @@
 
 namespace
 {
+const size_t NUM_ELEMENTS = 300;
+
+types::Range randomRange()
+{
+    const size_t start = rand() % NUM_ELEMENTS;
+    return types::Range(start, rand() % (NUM_ELEMENTS - start) % 20);
+}
+
+// Checks a range list against one flag per element
+void checkMatches(const std::string& testName,
+                  const types::RangeList& rangeList,
+                  const std::vector<bool>& expected)
+{
+    std::vector<bool> actual(expected.size(), false);
+    size_t numElements = 0;
+    const std::vector<types::Range> ranges = rangeList.getRanges();
+    TEST_ASSERT_EQ(ranges.size(), rangeList.getNumRanges());
+    for (size_t ii = 0; ii < ranges.size(); ++ii)
+    {
+        TEST_ASSERT_FALSE(ranges[ii].empty());
+        if (ii > 0)
+        {
+            // Disjoint, sorted and not touching
+            TEST_ASSERT_GREATER(ranges[ii].mStartElement,
+                                ranges[ii - 1].endElement());
+        }
+        for (size_t jj = ranges[ii].mStartElement;
+             jj < ranges[ii].endElement();
+             ++jj)
+        {
+            actual[jj] = true;
+        }
+        numElements += ranges[ii].mNumElements;
+    }
+    TEST_ASSERT_EQ(rangeList.getTotalNumElements(), numElements);
+
+    for (size_t ii = 0; ii < expected.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(actual[ii], expected[ii]);
+        TEST_ASSERT_EQ(rangeList.contains(ii), expected[ii]);
+    }
+}
+
+void set(const types::Range& range, bool value, std::vector<bool>& flags)
+{
+    for (size_t ii = range.mStartElement; ii < range.endElement(); ++ii)
+    {
+        flags[ii] = value;
+    }
+}
+
 TEST_CASE(TestDisjointInsertion)
 {
     types::RangeList RL;
@@ -205,6 +258,104 @@ TEST_CASE(TestIntersection)
     TEST_ASSERT_TRUE(types::Range(31,2) == ranges[4]);
     TEST_ASSERT_TRUE(types::Range(37,1) == ranges[5]);
 }
+
+TEST_CASE(TestRandomInsertRemove)
+{
+    srand(1);
+    types::RangeList RL;
+    std::vector<bool> expected(NUM_ELEMENTS, false);
+    for (size_t trial = 0; trial < 2000; ++trial)
+    {
+        const types::Range range = randomRange();
+        if (rand() % 3 == 0)
+        {
+            RL.remove(range);
+            set(range, false, expected);
+        }
+        else
+        {
+            RL.insert(range);
+            set(range, true, expected);
+        }
+
+        if (trial % 50 == 0)
+        {
+            checkMatches(testName, RL, expected);
+        }
+
+        const types::Range query = randomRange();
+        bool all = true;
+        bool any = false;
+        for (size_t ii = query.mStartElement; ii < query.endElement(); ++ii)
+        {
+            all = all && expected[ii];
+            any = any || expected[ii];
+        }
+        TEST_ASSERT_EQ(RL.containsAll(query), all);
+        TEST_ASSERT_EQ(RL.overlaps(query), any);
+    }
+    checkMatches(testName, RL, expected);
+}
+
+TEST_CASE(TestSetOperations)
+{
+    srand(2);
+    for (size_t trial = 0; trial < 50; ++trial)
+    {
+        std::vector<types::Range> rangesA;
+        std::vector<types::Range> rangesB;
+        std::vector<bool> expectedA(NUM_ELEMENTS, false);
+        std::vector<bool> expectedB(NUM_ELEMENTS, false);
+        for (size_t ii = 0; ii < 20; ++ii)
+        {
+            rangesA.push_back(randomRange());
+            rangesB.push_back(randomRange());
+            set(rangesA.back(), true, expectedA);
+            set(rangesB.back(), true, expectedB);
+        }
+
+        // Bulk build from sorted input matches one insert at a time
+        const types::RangeList A(rangesA);
+        std::sort(rangesB.begin(), rangesB.end());
+        const types::RangeList B(rangesB);
+        checkMatches(testName, A, expectedA);
+        checkMatches(testName, B, expectedB);
+
+        std::vector<bool> expectedUnion(NUM_ELEMENTS);
+        std::vector<bool> expectedIntersection(NUM_ELEMENTS);
+        for (size_t ii = 0; ii < NUM_ELEMENTS; ++ii)
+        {
+            expectedUnion[ii] = expectedA[ii] || expectedB[ii];
+            expectedIntersection[ii] = expectedA[ii] && expectedB[ii];
+        }
+        checkMatches(testName, A.unite(B), expectedUnion);
+        checkMatches(testName, B.unite(A), expectedUnion);
+        checkMatches(testName, A.intersect(B), expectedIntersection);
+
+        types::RangeList C(A);
+        C.insert(rangesB);
+        TEST_ASSERT_TRUE(C == A.unite(B));
+        C.remove(rangesB);
+        TEST_ASSERT_TRUE(C.intersect(B).empty());
+
+        types::RangeList expanded(A);
+        expanded.expand(3, NUM_ELEMENTS - 10);
+        std::vector<bool> expectedExpanded(NUM_ELEMENTS, false);
+        for (const auto& range : A.getRanges())
+        {
+            const size_t start = range.mStartElement >= 3 ?
+                    range.mStartElement - 3 : 0;
+            const size_t end = std::min<size_t>(range.endElement() + 3,
+                                                NUM_ELEMENTS - 10);
+            if (start < end)
+            {
+                set(types::Range(start, end - start), true,
+                    expectedExpanded);
+            }
+        }
+        checkMatches(testName, expanded, expectedExpanded);
+    }
+}
 }
 
 int main(int /*argc*/, char** /*argv*/)
@@ -218,5 +369,7 @@ int main(int /*argc*/, char** /*argv*/)
     TEST_CHECK(TestRemoveMultiRangeOverlap);
     TEST_CHECK(TestExpansion);
     TEST_CHECK(TestIntersection);
+    TEST_CHECK(TestRandomInsertRemove);
+    TEST_CHECK(TestSetOperations);
     return 0;
 }